@@ -44,7 +44,8 @@ namespace {
 
 
 // This class provides helper functions to expand a memcmp library call into an
-// inline expansion.
+// inline expansion.  The result has the type of the call, which
+// TargetLibraryInfo only accepts as memcmp when it is a C int of the target.
 class MemCmpExpansion {
   struct ResultBlock {
     BasicBlock *BB = nullptr;
@@ -220,8 +221,8 @@ void MemCmpExpansion::emitLoadCompareByteBlock(unsigned BlockIndex,
   Value *LoadSrc1 = Builder.CreateLoad(LoadSizeType, Source1);
   Value *LoadSrc2 = Builder.CreateLoad(LoadSizeType, Source2);
 
-  LoadSrc1 = Builder.CreateZExt(LoadSrc1, Type::getInt32Ty(CI->getContext()));
-  LoadSrc2 = Builder.CreateZExt(LoadSrc2, Type::getInt32Ty(CI->getContext()));
+  LoadSrc1 = Builder.CreateZExt(LoadSrc1, CI->getType());
+  LoadSrc2 = Builder.CreateZExt(LoadSrc2, CI->getType());
   Value *Diff = Builder.CreateSub(LoadSrc1, LoadSrc2);
 
   PhiRes->addIncoming(Diff, LoadCmpBlocks[BlockIndex]);
@@ -362,7 +363,7 @@ void MemCmpExpansion::emitLoadCompareBlockMultipleLoads(unsigned BlockIndex,
   // since early exit to ResultBlock was not taken (no difference was found in
   // any of the bytes).
   if (BlockIndex == LoadCmpBlocks.size() - 1) {
-    Value *Zero = ConstantInt::get(Type::getInt32Ty(CI->getContext()), 0);
+    Value *Zero = ConstantInt::get(CI->getType(), 0);
     PhiRes->addIncoming(Zero, LoadCmpBlocks[BlockIndex]);
   }
 }
@@ -447,7 +448,7 @@ void MemCmpExpansion::emitLoadCompareBlock(unsigned BlockIndex) {
   // since early exit to ResultBlock was not taken (no difference was found in
   // any of the bytes).
   if (BlockIndex == LoadCmpBlocks.size() - 1) {
-    Value *Zero = ConstantInt::get(Type::getInt32Ty(CI->getContext()), 0);
+    Value *Zero = ConstantInt::get(CI->getType(), 0);
     PhiRes->addIncoming(Zero, LoadCmpBlocks[BlockIndex]);
   }
 }
@@ -461,12 +462,18 @@ void MemCmpExpansion::emitMemCmpResultBlock() {
   if (IsUsedForZeroCmp) {
     BasicBlock::iterator InsertPt = ResBlock.BB->getFirstInsertionPt();
     Builder.SetInsertPoint(ResBlock.BB, InsertPt);
-    Value *Res = ConstantInt::get(Type::getInt32Ty(CI->getContext()), 1);
+    Value *Res = ConstantInt::get(CI->getType(), 1);
     PhiRes->addIncoming(Res, ResBlock.BB);
     BranchInst *NewBr = BranchInst::Create(EndBlock);
     Builder.Insert(NewBr);
     return;
   }
+  // Single byte blocks branch to EndBlock with the difference themselves,
+  // so nothing reaches the ResultBlock when all the loads are bytes.
+  if (NumLoadsNonOneByte == 0) {
+    ResBlock.BB->eraseFromParent();
+    return;
+  }
   BasicBlock::iterator InsertPt = ResBlock.BB->getFirstInsertionPt();
   Builder.SetInsertPoint(ResBlock.BB, InsertPt);
 
@@ -474,8 +481,8 @@ void MemCmpExpansion::emitMemCmpResultBlock() {
                                   ResBlock.PhiSrc2);
 
   Value *Res =
-      Builder.CreateSelect(Cmp, ConstantInt::get(Builder.getInt32Ty(), -1),
-                           ConstantInt::get(Builder.getInt32Ty(), 1));
+      Builder.CreateSelect(Cmp, ConstantInt::get(CI->getType(), -1),
+                           ConstantInt::get(CI->getType(), 1));
 
   BranchInst *NewBr = BranchInst::Create(EndBlock);
   Builder.Insert(NewBr);
@@ -494,7 +501,7 @@ void MemCmpExpansion::setupResultBlockPHINodes() {
 
 void MemCmpExpansion::setupEndBlockPHINodes() {
   Builder.SetInsertPoint(&EndBlock->front());
-  PhiRes = Builder.CreatePHI(Type::getInt32Ty(CI->getContext()), 2, "phi.res");
+  PhiRes = Builder.CreatePHI(CI->getType(), 2, "phi.res");
 }
 
 Value *MemCmpExpansion::getMemCmpExpansionZeroCase() {
@@ -516,7 +523,7 @@ Value *MemCmpExpansion::getMemCmpEqZeroOneBlock() {
   unsigned LoadIndex = 0;
   Value *Cmp = getCompareLoadPairs(0, LoadIndex);
   assert(LoadIndex == getNumLoads() && "some entries were not consumed");
-  return Builder.CreateZExt(Cmp, Type::getInt32Ty(CI->getContext()));
+  return Builder.CreateZExt(Cmp, CI->getType());
 }
 
 /// A memcmp expansion that only has one block of load and compare can bypass
@@ -545,11 +552,12 @@ Value *MemCmpExpansion::getMemCmpOneBlock() {
     LoadSrc2 = Builder.CreateCall(Bswap, LoadSrc2);
   }
 
-  if (Size < 4) {
-    // The i8 and i16 cases don't need compares. We zext the loaded values and
-    // subtract them to get the suitable negative, zero, or positive i32 result.
-    LoadSrc1 = Builder.CreateZExt(LoadSrc1, Builder.getInt32Ty());
-    LoadSrc2 = Builder.CreateZExt(LoadSrc2, Builder.getInt32Ty());
+  if (Size * 8 < CI->getType()->getPrimitiveSizeInBits()) {
+    // Loads narrower than the result don't need compares. We zext the loaded
+    // values and subtract them to get the suitable negative, zero, or positive
+    // result.
+    LoadSrc1 = Builder.CreateZExt(LoadSrc1, CI->getType());
+    LoadSrc2 = Builder.CreateZExt(LoadSrc2, CI->getType());
     return Builder.CreateSub(LoadSrc1, LoadSrc2);
   }
 
@@ -561,8 +569,8 @@ Value *MemCmpExpansion::getMemCmpOneBlock() {
   // branches before we got there.
   Value *CmpUGT = Builder.CreateICmpUGT(LoadSrc1, LoadSrc2);
   Value *CmpULT = Builder.CreateICmpULT(LoadSrc1, LoadSrc2);
-  Value *ZextUGT = Builder.CreateZExt(CmpUGT, Builder.getInt32Ty());
-  Value *ZextULT = Builder.CreateZExt(CmpULT, Builder.getInt32Ty());
+  Value *ZextUGT = Builder.CreateZExt(CmpUGT, CI->getType());
+  Value *ZextULT = Builder.CreateZExt(CmpULT, CI->getType());
   return Builder.CreateSub(ZextUGT, ZextULT);
 }
 
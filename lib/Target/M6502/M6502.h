@@ -1,4 +1,4 @@
-//===-- M6502.h - Top-level interface for M6502 representation ----*- C++ -*-===//
+//===-- M6502.h - Top-level interface for M6502 representation --*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -20,19 +20,21 @@
 
 namespace llvm {
   class M6502TargetMachine;
-  class ModulePass;
   class FunctionPass;
+  class ModulePass;
 
-  ModulePass *createM6502Os16Pass();
-  ModulePass *createM650216HardFloatPass();
-
-  FunctionPass *createM6502ModuleISelDagPass();
-  FunctionPass *createM6502OptimizePICCallPass();
-  FunctionPass *createM6502DelaySlotFillerPass();
-  FunctionPass *createM6502HazardSchedule();
+  FunctionPass *createM6502AccWidthPass();
+  ModulePass *createM6502ArgRegsPass();
+  FunctionPass *createM6502CountDownLoopsPass();
+  FunctionPass *createM6502InterruptFramePass();
   FunctionPass *createM6502LongBranchPass();
-  FunctionPass *createM6502ConstantIslandPass();
-  FunctionPass *createMicroM6502SizeReductionPass();
+  FunctionPass *createM6502LoopCountersPass();
+  FunctionPass *createM6502PageLayoutPass();
+  FunctionPass *createM6502PeepholePass();
+  FunctionPass *createM6502ZPColoringPass();
+  ModulePass *createM6502ZeroPageAllocPass();
+  ModulePass *createM6502SplitArraysPass();
+  ModulePass *createM6502StaticFramePass();
 } // end namespace llvm;
 
 #endif
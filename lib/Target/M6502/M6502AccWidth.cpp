@@ -0,0 +1,240 @@
+//===- M6502AccWidth.cpp - Place the 65816 accumulator width switches -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The M flag of the 65816 selects whether A and the memory accessed through
+// it are 8 or 16 bits wide, which changes what the same opcode does and how
+// long its immediate operand is.  The expansions of the 16-bit pseudo
+// instructions use the wide forms, the rest of the code the byte wide ones,
+// and each instruction records the width it needs in its TSFlags.  REP #$20
+// and SEP #$20 switch between the widths for three cycles each.
+//
+// Rather than switching around every wide instruction, this pass places as
+// few switches as it can.  A forward data-flow analysis over the CFG finds
+// the widths A may have on entry to each block, starting from 8 bits at the
+// entry of the function, which is also the width calls and returns need.  A
+// block which neither touches A nor memory through it leaves A as it found
+// it.  Within a block, a switch goes just before the first instruction which
+// needs the other width.  Where paths of both widths meet, the block starts
+// in the width it needs first, and the predecessors arriving in the other
+// one switch at their end when the block is their only successor, which
+// takes the switch out of a loop to its preheader, or else the block
+// switches on entry.
+//
+// An interrupt handler may interrupt code of either width, and switches to
+// the one it needs first on entry.  RTI restores the width with P.
+//
+// The asm printer tells the assembler the width of immediate operands,
+// following the TSFlags of the instructions it emits.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502InstrInfo.h"
+#include "M6502Subtarget.h"
+#include "MCTargetDesc/M6502BaseInfo.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-acc-width"
+
+STATISTIC(NumSwitches, "Number of REP and SEP placed");
+STATISTIC(NumHoisted, "Number of switches placed at the end of a predecessor");
+
+namespace {
+
+  class M6502AccWidth : public MachineFunctionPass {
+  public:
+    static char ID;
+
+    M6502AccWidth() : MachineFunctionPass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Accumulator Width";
+    }
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    MachineFunctionProperties getRequiredProperties() const override {
+      return MachineFunctionProperties().set(
+          MachineFunctionProperties::Property::NoVRegs);
+    }
+
+  private:
+    const M6502InstrInfo *TII;
+
+    /// The widths the first and the last instruction of each block which
+    /// depends on the width need, or AccAny if there is none.
+    SmallVector<unsigned, 16> FirstWidths, LastWidths;
+
+    /// The widths A may have on entry to each block, as the union of Acc8
+    /// and Acc16.  AccAny stands for a block not reached yet.
+    SmallVector<unsigned, 16> EntryWidths;
+
+    bool isReached(const MachineBasicBlock &MBB) const;
+    unsigned getEntryWidth(const MachineBasicBlock &MBB) const;
+    unsigned getExitWidth(const MachineBasicBlock &MBB) const;
+    void computeEntryWidths(MachineFunction &MF);
+    void buildSwitch(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                     unsigned Width);
+  };
+
+} // end anonymous namespace
+
+char M6502AccWidth::ID = 0;
+
+/// Return the width MI needs, or AccAny if it does not depend on it.
+static unsigned getWidth(const MachineInstr &MI) {
+  // Inline assembly is written for the width the 6502 has.
+  if (MI.isInlineAsm())
+    return M6502II::Acc8;
+  return M6502II::getAccWidth(MI.getDesc().TSFlags);
+}
+
+bool M6502AccWidth::isReached(const MachineBasicBlock &MBB) const {
+  return EntryWidths[MBB.getNumber()] != M6502II::AccAny;
+}
+
+/// Return the width MBB starts in, which is the one it needs first when
+/// paths of both widths meet.
+unsigned M6502AccWidth::getEntryWidth(const MachineBasicBlock &MBB) const {
+  unsigned Widths = EntryWidths[MBB.getNumber()];
+  if (Widths == M6502II::Acc8 || Widths == M6502II::Acc16)
+    return Widths;
+
+  unsigned First = FirstWidths[MBB.getNumber()];
+  return First != M6502II::AccAny ? First : unsigned(M6502II::Acc8);
+}
+
+unsigned M6502AccWidth::getExitWidth(const MachineBasicBlock &MBB) const {
+  unsigned Last = LastWidths[MBB.getNumber()];
+  return Last != M6502II::AccAny ? Last : getEntryWidth(MBB);
+}
+
+void M6502AccWidth::computeEntryWidths(MachineFunction &MF) {
+  FirstWidths.assign(MF.getNumBlockIDs(), M6502II::AccAny);
+  LastWidths.assign(MF.getNumBlockIDs(), M6502II::AccAny);
+  EntryWidths.assign(MF.getNumBlockIDs(), M6502II::AccAny);
+
+  for (MachineBasicBlock &MBB : MF)
+    for (MachineInstr &MI : MBB) {
+      unsigned Width = getWidth(MI);
+      if (Width == M6502II::AccAny)
+        continue;
+      if (FirstWidths[MBB.getNumber()] == M6502II::AccAny)
+        FirstWidths[MBB.getNumber()] = Width;
+      LastWidths[MBB.getNumber()] = Width;
+    }
+
+  // The sets of widths only grow, so this terminates.
+  EntryWidths[MF.front().getNumber()] =
+      MF.getFunction()->hasFnAttribute("interrupt")
+          ? unsigned(M6502II::Acc8 | M6502II::Acc16)
+          : unsigned(M6502II::Acc8);
+  bool Changed;
+  do {
+    Changed = false;
+    for (MachineBasicBlock &MBB : MF) {
+      unsigned Widths = EntryWidths[MBB.getNumber()];
+      for (const MachineBasicBlock *Pred : MBB.predecessors())
+        if (isReached(*Pred))
+          Widths |= getExitWidth(*Pred);
+      if (Widths != EntryWidths[MBB.getNumber()]) {
+        EntryWidths[MBB.getNumber()] = Widths;
+        Changed = true;
+      }
+    }
+  } while (Changed);
+}
+
+void M6502AccWidth::buildSwitch(MachineBasicBlock &MBB,
+                                MachineBasicBlock::iterator I,
+                                unsigned Width) {
+  DebugLoc DL;
+  if (I != MBB.end())
+    DL = I->getDebugLoc();
+  BuildMI(MBB, I, DL,
+          TII->get(Width == M6502II::Acc16 ? M6502::REP : M6502::SEP))
+    .addImm(0x20);
+  ++NumSwitches;
+}
+
+bool M6502AccWidth::runOnMachineFunction(MachineFunction &MF) {
+  if (!MF.getSubtarget<M6502Subtarget>().is65816())
+    return false;
+
+  TII = static_cast<const M6502InstrInfo *>(MF.getSubtarget().getInstrInfo());
+  computeEntryWidths(MF);
+
+  // An interrupt handler starts in a known width if anything depends on it.
+  bool SwitchAtEntry =
+      MF.getFunction()->hasFnAttribute("interrupt") &&
+      any_of(FirstWidths, [](unsigned W) { return W != M6502II::AccAny; });
+
+  // Decide on the switches at the block boundaries before any is inserted.
+  SmallVector<std::pair<MachineBasicBlock *, unsigned>, 8> EntrySwitches;
+  SmallVector<std::pair<MachineBasicBlock *, unsigned>, 8> ExitSwitches;
+  for (MachineBasicBlock &MBB : MF) {
+    unsigned Width = getEntryWidth(MBB);
+    bool AtEntry =
+        &MBB == &MF.front() && (Width != M6502II::Acc8 || SwitchAtEntry);
+    SmallVector<MachineBasicBlock *, 4> Preds;
+    for (MachineBasicBlock *Pred : MBB.predecessors()) {
+      if (!isReached(*Pred) || getExitWidth(*Pred) == Width)
+        continue;
+      if (Pred->succ_size() != 1)
+        AtEntry = true;
+      Preds.push_back(Pred);
+    }
+
+    if (AtEntry)
+      EntrySwitches.push_back(std::make_pair(&MBB, Width));
+    else
+      for (MachineBasicBlock *Pred : Preds)
+        ExitSwitches.push_back(std::make_pair(Pred, Width));
+  }
+
+  // Switch within each block where an instruction needs the other width.
+  bool Changed = !EntrySwitches.empty() || !ExitSwitches.empty();
+  for (MachineBasicBlock &MBB : MF) {
+    unsigned Width = getEntryWidth(MBB);
+    for (MachineInstr &MI : MBB) {
+      unsigned Needed = getWidth(MI);
+      if (Needed == M6502II::AccAny || Needed == Width)
+        continue;
+      DEBUG(dbgs() << "Switching the width of A before: " << MI);
+      buildSwitch(MBB, MI, Needed);
+      Width = Needed;
+      Changed = true;
+    }
+  }
+
+  // REP and SEP only change M, so they may come before a jump.
+  for (const auto &S : EntrySwitches)
+    buildSwitch(*S.first, S.first->begin(), S.second);
+  for (const auto &S : ExitSwitches) {
+    buildSwitch(*S.first, S.first->getFirstTerminator(), S.second);
+    ++NumHoisted;
+  }
+
+  return Changed;
+}
+
+/// createM6502AccWidthPass - Returns a pass that places the switches of the
+/// accumulator width of the 65816.
+FunctionPass *llvm::createM6502AccWidthPass() { return new M6502AccWidth(); }
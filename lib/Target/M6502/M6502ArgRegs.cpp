@@ -0,0 +1,131 @@
+//===- M6502ArgRegs.cpp - Fit fastcc arguments to their callee ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// fastcc passes every argument in the zero page, since values live there and
+// a byte passed in A, X or Y costs a transfer on both sides of the call.  A
+// byte which the callee uses as an index is the exception: passed in X it
+// indexes a table with abs,X, and passed in Y a pointer with (zp),Y, without
+// being loaded again, and the caller loads it with LDX or LDY instead of
+// copying it to the argument block.
+//
+// This pass looks at how each fastcc function whose callers are all known
+// uses its byte arguments, and gives the first one indexing a global X and
+// the first one indexing a pointer Y.  The choice is recorded as the
+// "m6502-arg-reg" attribute of the argument, which the lowering of both the
+// function and its calls follows.  The other arguments keep the fastcc
+// registers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Argument.h"
+#include "llvm/IR/Attributes.h"
+#include "llvm/IR/CallingConv.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-arg-regs"
+
+STATISTIC(NumArgsInX, "Number of fastcc arguments passed in X");
+STATISTIC(NumArgsInY, "Number of fastcc arguments passed in Y");
+
+namespace {
+
+  class M6502ArgRegs : public ModulePass {
+  public:
+    static char ID;
+
+    M6502ArgRegs() : ModulePass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Argument Registers";
+    }
+
+    bool runOnModule(Module &M) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesAll();
+      ModulePass::getAnalysisUsage(AU);
+    }
+  };
+
+} // end anonymous namespace
+
+char M6502ArgRegs::ID = 0;
+
+/// Return the register which suits Arg as an index, "x" when it is the
+/// index of an element of a global, "y" when it is the index of a byte
+/// after a pointer, or an empty string.
+static StringRef getIndexReg(const Argument &Arg) {
+  StringRef Reg;
+  for (const User *U : Arg.users()) {
+    // Only a zero extended byte can be an index register.
+    const auto *ZExt = dyn_cast<ZExtInst>(U);
+    if (!ZExt || !ZExt->getType()->isIntegerTy(16))
+      continue;
+    for (const User *ZU : ZExt->users()) {
+      const auto *GEP = dyn_cast<GetElementPtrInst>(ZU);
+      if (!GEP || GEP->getPointerOperand() == ZExt)
+        continue;
+      if (isa<GlobalVariable>(GEP->getPointerOperand()->stripPointerCasts()))
+        return "x";
+      Reg = "y";
+    }
+  }
+  return Reg;
+}
+
+bool M6502ArgRegs::runOnModule(Module &M) {
+  if (skipModule(M))
+    return false;
+
+  bool Changed = false;
+  for (Function &F : M) {
+    // Any other caller would pass the arguments in the fastcc registers.
+    if (F.isDeclaration() || !F.hasLocalLinkage() ||
+        F.getCallingConv() != CallingConv::Fast || F.isVarArg() ||
+        F.hasAddressTaken())
+      continue;
+
+    bool UsedX = false, UsedY = false;
+    for (Argument &Arg : F.args()) {
+      if (!Arg.getType()->isIntegerTy(8) || Arg.hasByValAttr())
+        continue;
+      StringRef Reg = getIndexReg(Arg);
+      bool &Used = Reg == "x" ? UsedX : UsedY;
+      if (Reg.empty() || Used)
+        continue;
+
+      DEBUG(dbgs() << "Passing argument " << Arg.getArgNo() << " of "
+                   << F.getName() << " in " << Reg << "\n");
+      F.addParamAttr(Arg.getArgNo(),
+                     Attribute::get(M.getContext(), "m6502-arg-reg", Reg));
+      if (Reg == "x")
+        ++NumArgsInX;
+      else
+        ++NumArgsInY;
+      Used = true;
+      Changed = true;
+    }
+  }
+
+  return Changed;
+}
+
+/// createM6502ArgRegsPass - Returns a pass that chooses the CPU registers
+/// of the arguments of fastcc functions.
+ModulePass *llvm::createM6502ArgRegsPass() { return new M6502ArgRegs(); }
@@ -1,4 +1,4 @@
-//===- M6502AsmPrinter.cpp - M6502 LLVM Assembly Printer --------------------===//
+//===- M6502AsmPrinter.cpp - M6502 LLVM Assembly Printer ------------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -14,21 +14,23 @@
 
 #include "M6502AsmPrinter.h"
 #include "InstPrinter/M6502InstPrinter.h"
-#include "MCTargetDesc/M6502ABIInfo.h"
 #include "MCTargetDesc/M6502BaseInfo.h"
-#include "MCTargetDesc/M6502MCNaCl.h"
+#include "MCTargetDesc/M6502MCExpr.h"
 #include "MCTargetDesc/M6502MCTargetDesc.h"
 #include "M6502.h"
 #include "M6502MCInstLower.h"
 #include "M6502MachineFunction.h"
+#include "M6502RegisterInfo.h"
 #include "M6502Subtarget.h"
 #include "M6502TargetMachine.h"
+#include "M6502TargetObjectFile.h"
 #include "M6502TargetStreamer.h"
-#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
-#include "llvm/ADT/Triple.h"
 #include "llvm/ADT/Twine.h"
-#include "llvm/BinaryFormat/ELF.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineConstantPool.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
@@ -36,38 +38,63 @@
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/MachineOperand.h"
-#include "llvm/IR/Attributes.h"
 #include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
-#include "llvm/IR/Function.h"
-#include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCInst.h"
 #include "llvm/MC/MCInstBuilder.h"
-#include "llvm/MC/MCObjectFileInfo.h"
-#include "llvm/MC/MCSectionELF.h"
 #include "llvm/MC/MCSymbol.h"
-#include "llvm/MC/MCSymbolELF.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetLoweringObjectFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetRegisterInfo.h"
-#include "llvm/Target/TargetSubtargetInfo.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
-#include <map>
+#include <functional>
 #include <memory>
-#include <string>
-#include <vector>
 
 using namespace llvm;
 
 #define DEBUG_TYPE "m6502-asm-printer"
 
+STATISTIC(NumTablesAligned, "Number of tables kept within a page");
+
+static cl::opt<unsigned>
+ZPFrameSize("m6502-zp-frame-size", cl::Hidden,
+            cl::desc("Largest static frame area placed in the zero page "
+                     "(default=64)"),
+            cl::init(64));
+
+static cl::opt<std::string>
+StackReport("m6502-stack-report", cl::Hidden, cl::value_desc("filename"),
+            cl::desc("Write the worst-case depth of the hardware stack from "
+                     "each entry point and interrupt handler as YAML"));
+
+static cl::opt<unsigned>
+StackBudget("m6502-stack-budget", cl::Hidden,
+            cl::desc("Fail if the hardware stack may grow deeper than this "
+                     "many bytes (default=0, no limit)"),
+            cl::init(0));
+
+static cl::opt<bool>
+PageAlignTables("m6502-page-align-tables", cl::Hidden, cl::init(true),
+                cl::desc("Keep arrays read through an index within a page "
+                         "(default=on)"));
+
 M6502TargetStreamer &M6502AsmPrinter::getTargetStreamer() const {
   return static_cast<M6502TargetStreamer &>(*OutStreamer->getTargetStreamer());
 }
@@ -76,351 +103,425 @@ bool M6502AsmPrinter::runOnMachineFunction(MachineFunction &MF) {
   Subtarget = &MF.getSubtarget<M6502Subtarget>();
 
   M6502FI = MF.getInfo<M6502FunctionInfo>();
-  if (Subtarget->inM650216Mode())
-    for (std::map<
-             const char *,
-             const M650216HardFloatInfo::FuncSignature *>::const_iterator
-             it = M6502FI->StubsNeeded.begin();
-         it != M6502FI->StubsNeeded.end(); ++it) {
-      const char *Symbol = it->first;
-      const M650216HardFloatInfo::FuncSignature *Signature = it->second;
-      if (StubsNeeded.find(Symbol) == StubsNeeded.end())
-        StubsNeeded[Symbol] = Signature;
-    }
-  MCP = MF.getConstantPool();
 
-  // In NaCl, all indirect jump targets must be aligned to bundle size.
-  if (Subtarget->isTargetNaCl())
-    NaClAlignIndirectJumpTargets(MF);
+  recordCallGraphNode(MF);
 
-  AsmPrinter::runOnMachineFunction(MF);
+  if (!MF.getConstantPool()->isEmpty())
+    SectionLayoutsUnknown = true;
 
-  emitXRayTable();
+  AsmPrinter::runOnMachineFunction(MF);
 
   return true;
 }
 
-bool M6502AsmPrinter::lowerOperand(const MachineOperand &MO, MCOperand &MCOp) {
-  MCOp = MCInstLowering.LowerOperand(MO);
-  return MCOp.isValid();
+/// Return the bytes MI pushes on the hardware stack, or minus those it pulls.
+static int getPushedBytes(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+  case M6502::PHA:
+  case M6502::PHP:
+  case M6502::PHX:
+  case M6502::PHY:
+    return 1;
+  case M6502::PHAW:
+    return 2;
+  case M6502::PLA:
+  case M6502::PLP:
+  case M6502::PLX:
+  case M6502::PLY:
+    return -1;
+  case M6502::PLAW:
+    return -2;
+  default:
+    return 0;
+  }
 }
 
-#include "M6502GenMCPseudoLowering.inc"
-
-// Lower PseudoReturn/PseudoIndirectBranch/PseudoIndirectBranch64 to JR, JR_MM,
-// JALR, or JALR64 as appropriate for the target.
-void M6502AsmPrinter::emitPseudoIndirectBranch(MCStreamer &OutStreamer,
-                                              const MachineInstr *MI) {
-  bool HasLinkReg = false;
-  bool InMicroM6502Mode = Subtarget->inMicroM6502Mode();
-  MCInst TmpInst0;
+void M6502AsmPrinter::recordCallGraphNode(const MachineFunction &MF) {
+  CallGraphNode &Node = CallGraph[getSymbol(MF.getFunction())];
+  Node.F = MF.getFunction();
 
-  if (Subtarget->hasM650264r6()) {
-    // M650264r6 should use (JALR64 ZERO_64, $rs)
-    TmpInst0.setOpcode(M6502::JALR64);
-    HasLinkReg = true;
-  } else if (Subtarget->hasM650232r6()) {
-    // M650232r6 should use (JALR ZERO, $rs)
-    if (InMicroM6502Mode)
-      TmpInst0.setOpcode(M6502::JRC16_MMR6);
-    else {
-      TmpInst0.setOpcode(M6502::JALR);
-      HasLinkReg = true;
-    }
-  } else if (Subtarget->inMicroM6502Mode())
-    // microM6502 should use (JR_MM $rs)
-    TmpInst0.setOpcode(M6502::JR_MM);
-  else {
-    // Everything else should use (JR $rs)
-    TmpInst0.setOpcode(M6502::JR);
+  if (M6502FI->hasStaticFrame()) {
+    Node.FrameSym = M6502FI->getStaticFrameSymbol();
+    Node.FrameSize = MF.getFrameInfo().getStackSize();
   }
 
-  MCOperand MCOp;
+  // Pushes and pulls balance along every path through the function, so the
+  // first path to reach a block gives the depth of the hardware stack on
+  // entry to it.  Inline assembly is assumed to balance its own.
+  SmallVector<int, 16> EntryDepths(MF.getNumBlockIDs(), -1);
+  SmallVector<const MachineBasicBlock *, 16> Worklist(1, &MF.front());
+  EntryDepths[MF.front().getNumber()] = 0;
+  while (!Worklist.empty()) {
+    const MachineBasicBlock *MBB = Worklist.pop_back_val();
+    int Depth = EntryDepths[MBB->getNumber()];
+    for (const MachineInstr &MI : *MBB) {
+      Depth = std::max(Depth + getPushedBytes(MI), 0);
+      Node.PushDepth = std::max(Node.PushDepth, unsigned(Depth));
+      if (!MI.isCall())
+        continue;
+
+      const MachineOperand &MO = MI.getOperand(0);
+      if (MO.isGlobal()) {
+        Node.Callees.push_back(getSymbol(MO.getGlobal()));
+        Node.CallDepths.push_back(Depth);
+      } else if (MO.isSymbol()) {
+        Node.Callees.push_back(GetExternalSymbolSymbol(MO.getSymbolName()));
+        Node.CallDepths.push_back(Depth);
+      } else {
+        Node.CallsIndirect = true;
+        Node.IndirectCallDepth =
+            std::max(Node.IndirectCallDepth, unsigned(Depth));
+      }
+    }
 
-  if (HasLinkReg) {
-    unsigned ZeroReg = Subtarget->isGP64bit() ? M6502::ZERO_64 : M6502::ZERO;
-    TmpInst0.addOperand(MCOperand::createReg(ZeroReg));
+    for (const MachineBasicBlock *Succ : MBB->successors())
+      if (EntryDepths[Succ->getNumber()] < 0) {
+        EntryDepths[Succ->getNumber()] = Depth;
+        Worklist.push_back(Succ);
+      }
   }
-
-  lowerOperand(MI->getOperand(0), MCOp);
-  TmpInst0.addOperand(MCOp);
-
-  EmitToStreamer(OutStreamer, TmpInst0);
 }
 
-void M6502AsmPrinter::EmitInstruction(const MachineInstr *MI) {
-  M6502TargetStreamer &TS = getTargetStreamer();
-  unsigned Opc = MI->getOpcode();
-  TS.forbidModuleDirective();
-
-  if (MI->isDebugValue()) {
-    SmallString<128> Str;
-    raw_svector_ostream OS(Str);
-
-    PrintDebugValueComment(MI, OS);
+void M6502AsmPrinter::getAddressTaken(
+    SmallVectorImpl<MCSymbol *> &Syms) const {
+  for (auto &Entry : CallGraph)
+    if (Entry.second.F->hasAddressTaken() &&
+        !Entry.second.F->hasFnAttribute("interrupt"))
+      Syms.push_back(Entry.first);
+}
+
+// A frame is placed above the frames of everything the function may call,
+// directly or not, so it overlaps only frames of functions which cannot be
+// active at the same time.  Calls to functions outside the module add
+// nothing, and an indirect call may reach any function whose address is
+// taken.  The frames reached from an interrupt handler are only used on its
+// behalf, and as it may interrupt anything, including another handler, they
+// go above all the others, one handler after the other.
+void M6502AsmPrinter::emitStaticFrames() {
+  if (llvm::none_of(CallGraph, [](const std::pair<MCSymbol *, CallGraphNode> &E) {
+        return E.second.FrameSym;
+      }))
     return;
-  }
 
-  // If we just ended a constant pool, mark it as such.
-  if (InConstantPool && Opc != M6502::CONSTPOOL_ENTRY) {
-    OutStreamer->EmitDataRegion(MCDR_DataRegionEnd);
-    InConstantPool = false;
-  }
-  if (Opc == M6502::CONSTPOOL_ENTRY) {
-    // CONSTPOOL_ENTRY - This instruction represents a floating
-    // constant pool in the function.  The first operand is the ID#
-    // for this instruction, the second is the index into the
-    // MachineConstantPool that this is, the third is the size in
-    // bytes of this constant pool entry.
-    // The required alignment is specified on the basic block holding this MI.
-    //
-    unsigned LabelId = (unsigned)MI->getOperand(0).getImm();
-    unsigned CPIdx = (unsigned)MI->getOperand(1).getIndex();
-
-    // If this is the first entry of the pool, mark it.
-    if (!InConstantPool) {
-      OutStreamer->EmitDataRegion(MCDR_DataRegion);
-      InConstantPool = true;
+  DenseMap<MCSymbol *, uint64_t> End;
+  SmallVector<MCSymbol *, 16> AddressTaken;
+  getAddressTaken(AddressTaken);
+
+  // Ends only grow, and settle after as many rounds as the longest chain of
+  // calls unless a static frame is part of a cycle.  That can only happen
+  // through a call which did not exist when the frames were chosen.
+  bool Changed = true;
+  for (unsigned Round = 0; Changed; ++Round) {
+    if (Round > CallGraph.size())
+      report_fatal_error("recursion through a function with a static frame");
+
+    Changed = false;
+    for (auto &Entry : CallGraph) {
+      CallGraphNode &Node = Entry.second;
+      uint64_t Base = 0;
+      for (MCSymbol *Callee : Node.Callees)
+        Base = std::max(Base, End.lookup(Callee));
+      if (Node.CallsIndirect)
+        for (MCSymbol *Callee : AddressTaken)
+          Base = std::max(Base, End.lookup(Callee));
+
+      uint64_t NewEnd = Base + Node.FrameSize;
+      Node.FrameBase = Base;
+      if (NewEnd != End.lookup(Entry.first)) {
+        End[Entry.first] = NewEnd;
+        Changed = true;
+      }
     }
-
-    OutStreamer->EmitLabel(GetCPISymbol(LabelId));
-
-    const MachineConstantPoolEntry &MCPE = MCP->getConstants()[CPIdx];
-    if (MCPE.isMachineConstantPoolEntry())
-      EmitMachineConstantPoolValue(MCPE.Val.MachineCPVal);
-    else
-      EmitGlobalConstant(MF->getDataLayout(), MCPE.Val.ConstVal);
-    return;
-  }
-
-  switch (Opc) {
-  case M6502::PATCHABLE_FUNCTION_ENTER:
-    LowerPATCHABLE_FUNCTION_ENTER(*MI);
-    return;
-  case M6502::PATCHABLE_FUNCTION_EXIT:
-    LowerPATCHABLE_FUNCTION_EXIT(*MI);
-    return;
-  case M6502::PATCHABLE_TAIL_CALL:
-    LowerPATCHABLE_TAIL_CALL(*MI);
-    return;
   }
 
-  MachineBasicBlock::const_instr_iterator I = MI->getIterator();
-  MachineBasicBlock::const_instr_iterator E = MI->getParent()->instr_end();
-
-  do {
-    // Do any auto-generated pseudo lowerings.
-    if (emitPseudoExpansionLowering(*OutStreamer, &*I))
-      continue;
-
-    if (I->getOpcode() == M6502::PseudoReturn ||
-        I->getOpcode() == M6502::PseudoReturn64 ||
-        I->getOpcode() == M6502::PseudoIndirectBranch ||
-        I->getOpcode() == M6502::PseudoIndirectBranch64 ||
-        I->getOpcode() == M6502::TAILCALLREG ||
-        I->getOpcode() == M6502::TAILCALLREG64) {
-      emitPseudoIndirectBranch(*OutStreamer, &*I);
+  SmallVector<std::pair<MCSymbol *, SmallPtrSet<MCSymbol *, 16>>, 2>
+      Interrupts;
+  SmallPtrSet<MCSymbol *, 16> Interrupting;
+  for (auto &Entry : CallGraph) {
+    if (!Entry.second.F->hasFnAttribute("interrupt"))
       continue;
+    Interrupts.emplace_back(Entry.first, SmallPtrSet<MCSymbol *, 16>());
+    SmallPtrSet<MCSymbol *, 16> &Reached = Interrupts.back().second;
+    SmallVector<MCSymbol *, 16> Worklist(1, Entry.first);
+    while (!Worklist.empty()) {
+      MCSymbol *Sym = Worklist.pop_back_val();
+      auto It = CallGraph.find(Sym);
+      if (It == CallGraph.end() || !Reached.insert(Sym).second)
+        continue;
+      Interrupting.insert(Sym);
+      Worklist.append(It->second.Callees.begin(), It->second.Callees.end());
+      if (It->second.CallsIndirect)
+        Worklist.append(AddressTaken.begin(), AddressTaken.end());
     }
+  }
 
-    // The inM650216Mode() test is not permanent.
-    // Some instructions are marked as pseudo right now which
-    // would make the test fail for the wrong reason but
-    // that will be fixed soon. We need this here because we are
-    // removing another test for this situation downstream in the
-    // callchain.
-    //
-    if (I->isPseudo() && !Subtarget->inM650216Mode()
-        && !isLongBranchPseudo(I->getOpcode()))
-      llvm_unreachable("Pseudo opcode found in EmitInstruction()");
-
-    MCInst TmpInst0;
-    MCInstLowering.Lower(&*I, TmpInst0);
-    EmitToStreamer(*OutStreamer, TmpInst0);
-  } while ((++I != E) && I->isInsideBundle()); // Delay slot check
-}
-
-//===----------------------------------------------------------------------===//
-//
-//  M6502 Asm Directives
-//
-//  -- Frame directive "frame Stackpointer, Stacksize, RARegister"
-//  Describe the stack frame.
-//
-//  -- Mask directives "(f)mask  bitmask, offset"
-//  Tells the assembler which registers are saved and where.
-//  bitmask - contain a little endian bitset indicating which registers are
-//            saved on function prologue (e.g. with a 0x80000000 mask, the
-//            assembler knows the register 31 (RA) is saved at prologue.
-//  offset  - the position before stack pointer subtraction indicating where
-//            the first saved register on prologue is located. (e.g. with a
-//
-//  Consider the following function prologue:
-//
-//    .frame  $fp,48,$ra
-//    .mask   0xc0000000,-8
-//       addiu $sp, $sp, -48
-//       sw $ra, 40($sp)
-//       sw $fp, 36($sp)
-//
-//    With a 0xc0000000 mask, the assembler knows the register 31 (RA) and
-//    30 (FP) are saved at prologue. As the save order on prologue is from
-//    left to right, RA is saved first. A -8 offset means that after the
-//    stack pointer subtration, the first register in the mask (RA) will be
-//    saved at address 48-8=40.
-//
-//===----------------------------------------------------------------------===//
-
-//===----------------------------------------------------------------------===//
-// Mask directives
-//===----------------------------------------------------------------------===//
+  uint64_t Size = 0;
+  for (auto &Entry : CallGraph)
+    if (Entry.second.FrameSym && !Interrupting.count(Entry.first))
+      Size = std::max(Size, End.lookup(Entry.first));
 
-// Create a bitmask with all callee saved registers for CPU or Floating Point
-// registers. For CPU registers consider RA, GP and FP for saving if necessary.
-void M6502AsmPrinter::printSavedRegsBitmask() {
-  // CPU and FPU Saved Registers Bitmasks
-  unsigned CPUBitmask = 0, FPUBitmask = 0;
-  int CPUTopSavedRegOff, FPUTopSavedRegOff;
-
-  // Set the CPU and FPU Bitmasks
-  const MachineFrameInfo &MFI = MF->getFrameInfo();
-  const TargetRegisterInfo *TRI = MF->getSubtarget().getRegisterInfo();
-  const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
-  // size of stack area to which FP callee-saved regs are saved.
-  unsigned CPURegSize = TRI->getRegSizeInBits(M6502::GPR32RegClass) / 8;
-  unsigned FGR32RegSize = TRI->getRegSizeInBits(M6502::FGR32RegClass) / 8;
-  unsigned AFGR64RegSize = TRI->getRegSizeInBits(M6502::AFGR64RegClass) / 8;
-  bool HasAFGR64Reg = false;
-  unsigned CSFPRegsSize = 0;
-
-  for (const auto &I : CSI) {
-    unsigned Reg = I.getReg();
-    unsigned RegNum = TRI->getEncodingValue(Reg);
-
-    // If it's a floating point register, set the FPU Bitmask.
-    // If it's a general purpose register, set the CPU Bitmask.
-    if (M6502::FGR32RegClass.contains(Reg)) {
-      FPUBitmask |= (1 << RegNum);
-      CSFPRegsSize += FGR32RegSize;
-    } else if (M6502::AFGR64RegClass.contains(Reg)) {
-      FPUBitmask |= (3 << RegNum);
-      CSFPRegsSize += AFGR64RegSize;
-      HasAFGR64Reg = true;
-    } else if (M6502::GPR32RegClass.contains(Reg))
-      CPUBitmask |= (1 << RegNum);
+  for (auto &Interrupt : Interrupts) {
+    for (MCSymbol *Sym : Interrupt.second)
+      CallGraph[Sym].FrameBase += Size;
+    Size += End.lookup(Interrupt.first);
   }
 
-  // FP Regs are saved right below where the virtual frame pointer points to.
-  FPUTopSavedRegOff = FPUBitmask ?
-    (HasAFGR64Reg ? -AFGR64RegSize : -FGR32RegSize) : 0;
-
-  // CPU Regs are saved below FP Regs.
-  CPUTopSavedRegOff = CPUBitmask ? -CSFPRegsSize - CPURegSize : 0;
+  SmallVector<CallGraphNode *, 16> Frames;
+  for (auto &Entry : CallGraph)
+    if (Entry.second.FrameSym)
+      Frames.push_back(&Entry.second);
+
+  std::stable_sort(Frames.begin(), Frames.end(),
+                   [](const CallGraphNode *A, const CallGraphNode *B) {
+                     return A->FrameBase < B->FrameBase;
+                   });
+
+  const auto &TLOF =
+      static_cast<const M6502TargetObjectFile &>(getObjFileLowering());
+  OutStreamer->SwitchSection(Size <= ZPFrameSize
+                                 ? TLOF.getZeroPageBSSSection()
+                                 : TLOF.getBSSSection());
+
+  uint64_t Offset = 0;
+  for (const CallGraphNode *Node : Frames) {
+    OutStreamer->EmitZeros(Node->FrameBase - Offset);
+    OutStreamer->EmitLabel(Node->FrameSym);
+    Offset = Node->FrameBase;
+  }
+  OutStreamer->EmitZeros(Size - Offset);
+}
+
+namespace {
+
+  // The most bytes of the hardware stack a function may use below its
+  // return address, with those of its callees.
+  struct StackDepth {
+    unsigned Bytes = 0;
+    // The function may call itself, so its depth has no bound.
+    bool Unbounded = false;
+    // The function calls code outside the module, which is not counted.
+    bool Incomplete = false;
+  };
+
+} // end anonymous namespace
+
+// A call pushes the two bytes of its return address, and an interrupt the
+// three of its return address and P, or four in the native mode of the
+// 65816, which also pushes the program bank.  Nothing may call an entry
+// point but code outside the module, which it is assumed to return to, and
+// an interrupt handler may interrupt anything, including another handler,
+// so the stack may hold the deepest entry point and every handler at once.
+void M6502AsmPrinter::emitStackReport() {
+  if (StackReport.empty() && !StackBudget)
+    return;
 
-  M6502TargetStreamer &TS = getTargetStreamer();
-  // Print CPUBitmask
-  TS.emitMask(CPUBitmask, CPUTopSavedRegOff);
+  SmallVector<MCSymbol *, 16> AddressTaken;
+  getAddressTaken(AddressTaken);
+
+  SmallPtrSet<MCSymbol *, 16> Called, Unknown;
+  for (auto &Entry : CallGraph) {
+    for (MCSymbol *Callee : Entry.second.Callees)
+      if (Callee != Entry.first)
+        Called.insert(Callee);
+    if (Entry.second.CallsIndirect)
+      for (MCSymbol *Callee : AddressTaken)
+        if (Callee != Entry.first)
+          Called.insert(Callee);
+  }
 
-  // Print FPUBitmask
-  TS.emitFMask(FPUBitmask, FPUTopSavedRegOff);
-}
+  DenseMap<MCSymbol *, StackDepth> Depths;
+  SmallPtrSet<MCSymbol *, 16> Active;
+  std::function<StackDepth(MCSymbol *)> getDepth = [&](MCSymbol *Sym) {
+    StackDepth D;
+    auto It = CallGraph.find(Sym);
+    if (It == CallGraph.end()) {
+      Unknown.insert(Sym);
+      D.Incomplete = true;
+      return D;
+    }
+    auto Known = Depths.find(Sym);
+    if (Known != Depths.end())
+      return Known->second;
+    if (!Active.insert(Sym).second) {
+      D.Unbounded = true;
+      return D;
+    }
 
-//===----------------------------------------------------------------------===//
-// Frame and Set directives
-//===----------------------------------------------------------------------===//
+    const CallGraphNode &Node = It->second;
+    D.Bytes = Node.PushDepth;
+    auto addCall = [&](MCSymbol *Callee, unsigned Pushed) {
+      StackDepth CD = getDepth(Callee);
+      D.Bytes = std::max(D.Bytes, Pushed + 2 + CD.Bytes);
+      D.Unbounded |= CD.Unbounded;
+      D.Incomplete |= CD.Incomplete;
+    };
+    for (unsigned I = 0, E = Node.Callees.size(); I != E; ++I)
+      addCall(Node.Callees[I], Node.CallDepths[I]);
+    if (Node.CallsIndirect)
+      for (MCSymbol *Callee : AddressTaken)
+        addCall(Callee, Node.IndirectCallDepth);
+
+    Active.erase(Sym);
+    Depths[Sym] = D;
+    return D;
+  };
+
+  // The depths of the entry points and handlers, with what entering them
+  // pushes.
+  SmallVector<std::pair<MCSymbol *, StackDepth>, 4> Entries, Interrupts;
+  for (auto &Entry : CallGraph) {
+    StackDepth D = getDepth(Entry.first);
+    const Function *F = Entry.second.F;
+    if (F->hasFnAttribute("interrupt")) {
+      const M6502Subtarget *STI =
+          static_cast<const M6502TargetMachine &>(TM).getSubtargetImpl(*F);
+      D.Bytes += STI->is65816() ? 4 : 3;
+      Interrupts.emplace_back(Entry.first, D);
+    } else if (!Called.count(Entry.first)) {
+      D.Bytes += 2;
+      Entries.emplace_back(Entry.first, D);
+    }
+  }
 
-/// Frame Directive
-void M6502AsmPrinter::emitFrameDirective() {
-  const TargetRegisterInfo &RI = *MF->getSubtarget().getRegisterInfo();
+  StackDepth Total, Deepest;
+  for (const auto &E : Entries) {
+    Deepest.Bytes = std::max(Deepest.Bytes, E.second.Bytes);
+    Deepest.Unbounded |= E.second.Unbounded;
+    Deepest.Incomplete |= E.second.Incomplete;
+  }
+  Total = Deepest;
+  for (const auto &E : Interrupts) {
+    Total.Bytes += E.second.Bytes;
+    Total.Unbounded |= E.second.Unbounded;
+    Total.Incomplete |= E.second.Incomplete;
+  }
 
-  unsigned stackReg  = RI.getFrameRegister(*MF);
-  unsigned returnReg = RI.getRARegister();
-  unsigned stackSize = MF->getFrameInfo().getStackSize();
+  if (!StackReport.empty()) {
+    std::error_code EC;
+    raw_fd_ostream OS(StackReport, EC, sys::fs::F_Text);
+    if (EC)
+      report_fatal_error("cannot open stack report '" + StackReport +
+                             "': " + EC.message(),
+                         false);
+
+    auto printDepth = [&](StringRef Indent, const StackDepth &D) {
+      OS << Indent << "depth: " << D.Bytes << '\n';
+      if (D.Unbounded)
+        OS << Indent << "unbounded: true\n";
+      if (D.Incomplete)
+        OS << Indent << "incomplete: true\n";
+    };
+    auto printList = [&](StringRef Key,
+                         ArrayRef<std::pair<MCSymbol *, StackDepth>> List) {
+      OS << Key << ':' << (List.empty() ? " []\n" : "\n");
+      for (const auto &E : List) {
+        OS << "  - name: \"" << yaml::escape(E.first->getName()) << "\"\n";
+        printDepth("    ", E.second);
+      }
+    };
+
+    OS << "---\n";
+    OS << "functions:\n";
+    for (auto &Entry : CallGraph) {
+      OS << "  - name: \"" << yaml::escape(Entry.first->getName()) << "\"\n";
+      OS << "    pushes: " << Entry.second.PushDepth << '\n';
+      printDepth("    ", Depths.lookup(Entry.first));
+    }
+    printList("entry-points", Entries);
+    printList("interrupts", Interrupts);
+    OS << "unknown-callees: [";
+    bool First = true;
+    for (auto &Entry : CallGraph)
+      for (MCSymbol *Callee : Entry.second.Callees)
+        if (Unknown.erase(Callee)) {
+          OS << (First ? " \"" : ", \"") << yaml::escape(Callee->getName())
+             << '"';
+          First = false;
+        }
+    OS << (First ? "]\n" : " ]\n");
+    OS << "worst-case:\n";
+    printDepth("  ", Total);
+    if (StackBudget)
+      OS << "budget: " << StackBudget << '\n';
+    OS << "...\n";
+  }
 
-  getTargetStreamer().emitFrame(stackReg, stackSize, returnReg);
+  if (!StackBudget)
+    return;
+  if (Total.Unbounded)
+    report_fatal_error("the depth of the hardware stack has no bound, as a "
+                       "function may call itself",
+                       false);
+  if (Total.Bytes > StackBudget)
+    report_fatal_error("the hardware stack may grow to " +
+                           Twine(Total.Bytes) + " bytes, over the budget of " +
+                           Twine(StackBudget),
+                       false);
 }
 
-/// Emit Set directives.
-const char *M6502AsmPrinter::getCurrentABIString() const {
-  switch (static_cast<M6502TargetMachine &>(TM).getABI().GetEnumValue()) {
-  case M6502ABIInfo::ABI::O32:  return "abi32";
-  case M6502ABIInfo::ABI::N32:  return "abiN32";
-  case M6502ABIInfo::ABI::N64:  return "abi64";
-  default: llvm_unreachable("Unknown M6502 ABI");
-  }
+bool M6502AsmPrinter::lowerOperand(const MachineOperand &MO, MCOperand &MCOp) {
+  MCOp = MCInstLowering.LowerOperand(MO);
+  return MCOp.isValid();
 }
 
-void M6502AsmPrinter::EmitFunctionEntryLabel() {
-  M6502TargetStreamer &TS = getTargetStreamer();
-
-  // NaCl sandboxing requires that indirect call instructions are masked.
-  // This means that function entry points should be bundle-aligned.
-  if (Subtarget->isTargetNaCl())
-    EmitAlignment(std::max(MF->getAlignment(), M6502_NACL_BUNDLE_ALIGN));
-
-  if (Subtarget->inMicroM6502Mode()) {
-    TS.emitDirectiveSetMicroM6502();
-    TS.setUsesMicroM6502();
-  } else
-    TS.emitDirectiveSetNoMicroM6502();
+// JSRind rs is emitted as:
+//
+//      jsr  $tramp
+//      jmp  $ret
+//  $tramp:
+//      jmp  (rs)
+//  $ret:
+//
+// The callee returns to the JMP following the JSR.
+void M6502AsmPrinter::emitIndirectCall(const MachineInstr *MI) {
+  MCSymbol *Tramp = OutContext.createTempSymbol();
+  MCSymbol *Ret = OutContext.createTempSymbol();
+  MCOperand Target;
 
-  if (Subtarget->inM650216Mode())
-    TS.emitDirectiveSetM650216();
-  else
-    TS.emitDirectiveSetNoM650216();
+  lowerOperand(MI->getOperand(0), Target);
 
-  TS.emitDirectiveEnt(*CurrentFnSym);
-  OutStreamer->EmitLabel(CurrentFnSym);
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M6502::JSR).addExpr(
+                                   MCSymbolRefExpr::create(Tramp, OutContext)));
+  EmitToStreamer(*OutStreamer, MCInstBuilder(M6502::JMP).addExpr(
+                                   MCSymbolRefExpr::create(Ret, OutContext)));
+  OutStreamer->EmitLabel(Tramp);
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(M6502::JMPind).addOperand(Target));
+  OutStreamer->EmitLabel(Ret);
 }
 
-/// EmitFunctionBodyStart - Targets can override this to emit stuff before
-/// the first basic block in the function.
-void M6502AsmPrinter::EmitFunctionBodyStart() {
-  M6502TargetStreamer &TS = getTargetStreamer();
+void M6502AsmPrinter::EmitInstruction(const MachineInstr *MI) {
+  if (MI->isDebugValue())
+    return;
+
+  if (MI->getOpcode() == M6502::JSRind) {
+    emitIndirectCall(MI);
+    return;
+  }
 
-  MCInstLowering.Initialize(&MF->getContext());
+  if (MI->isPseudo())
+    llvm_unreachable("Pseudo opcode found in EmitInstruction()");
 
-  bool IsNakedFunction = MF->getFunction()->hasFnAttribute(Attribute::Naked);
-  if (!IsNakedFunction)
-    emitFrameDirective();
+  // The width of A changes at a REP or SEP, which is where the assembler is
+  // told.  A block laid out after one left in the other width is told again
+  // at its first instruction depending on the width.
+  unsigned Width = M6502II::getAccWidth(MI->getDesc().TSFlags);
+  if (Width != M6502II::AccAny)
+    emitAccWidth(Width == M6502II::Acc16);
 
-  if (!IsNakedFunction)
-    printSavedRegsBitmask();
+  MCInst TmpInst0;
+  MCInstLowering.Lower(MI, TmpInst0);
+  EmitToStreamer(*OutStreamer, TmpInst0);
 
-  if (!Subtarget->inM650216Mode()) {
-    TS.emitDirectiveSetNoReorder();
-    TS.emitDirectiveSetNoMacro();
-    TS.emitDirectiveSetNoAt();
-  }
+  if (MI->getOpcode() == M6502::REP || MI->getOpcode() == M6502::SEP)
+    emitAccWidth(MI->getOpcode() == M6502::REP);
 }
 
-/// EmitFunctionBodyEnd - Targets can override this to emit stuff after
-/// the last basic block in the function.
-void M6502AsmPrinter::EmitFunctionBodyEnd() {
-  M6502TargetStreamer &TS = getTargetStreamer();
-
-  // There are instruction for this macros, but they must
-  // always be at the function end, and we can't emit and
-  // break with BB logic.
-  if (!Subtarget->inM650216Mode()) {
-    TS.emitDirectiveSetAt();
-    TS.emitDirectiveSetMacro();
-    TS.emitDirectiveSetReorder();
+void M6502AsmPrinter::emitAccWidth(bool Wide) {
+  if (Wide != AccWide) {
+    AccWide = Wide;
+    getTargetStreamer().emitAccWidth(Wide);
   }
-  TS.emitDirectiveEnd(CurrentFnSym->getName());
-  // Make sure to terminate any constant pools that were at the end
-  // of the function.
-  if (!InConstantPool)
-    return;
-  InConstantPool = false;
-  OutStreamer->EmitDataRegion(MCDR_DataRegionEnd);
-}
-
-void M6502AsmPrinter::EmitBasicBlockEnd(const MachineBasicBlock &MBB) {
-  AsmPrinter::EmitBasicBlockEnd(MBB);
-  M6502TargetStreamer &TS = getTargetStreamer();
-  if (MBB.empty())
-    TS.emitDirectiveInsn();
 }
 
 /// isBlockOnlyReachableByFallthough - Return true if the basic block has
@@ -428,6 +529,11 @@ void M6502AsmPrinter::EmitBasicBlockEnd(const MachineBasicBlock &MBB) {
 /// the predecessor and this block is a fall-through.
 bool M6502AsmPrinter::isBlockOnlyReachableByFallthrough(const MachineBasicBlock*
                                                        MBB) const {
+  // If this is a landing pad, it isn't a fall through.  If it has no preds,
+  // then nothing falls through to it.
+  if (MBB->isEHPad() || MBB->pred_empty())
+    return false;
+
   // The predecessor has to be immediately before this block.
   const MachineBasicBlock *Pred = *MBB->pred_begin();
 
@@ -437,11 +543,6 @@ bool M6502AsmPrinter::isBlockOnlyReachableByFallthrough(const MachineBasicBlock*
     if (isa<SwitchInst>(bb->getTerminator()))
       return false;
 
-  // If this is a landing pad, it isn't a fall through.  If it has no preds,
-  // then nothing falls through to it.
-  if (MBB->isEHPad() || MBB->pred_empty())
-    return false;
-
   // If there isn't exactly one predecessor, it can't be a fall through.
   MachineBasicBlock::const_pred_iterator PI = MBB->pred_begin(), PI2 = PI;
   ++PI2;
@@ -481,82 +582,22 @@ bool M6502AsmPrinter::PrintAsmOperand(const MachineInstr *MI, unsigned OpNum,
     case 'X': // hex const int
       if ((MO.getType()) != MachineOperand::MO_Immediate)
         return true;
-      O << "0x" << Twine::utohexstr(MO.getImm());
-      return false;
-    case 'x': // hex const int (low 16 bits)
-      if ((MO.getType()) != MachineOperand::MO_Immediate)
-        return true;
-      O << "0x" << Twine::utohexstr(MO.getImm() & 0xffff);
+      O << '$' << Twine::utohexstr(MO.getImm() & 0xffff);
       return false;
     case 'd': // decimal const int
       if ((MO.getType()) != MachineOperand::MO_Immediate)
         return true;
       O << MO.getImm();
       return false;
-    case 'm': // decimal const int minus 1
-      if ((MO.getType()) != MachineOperand::MO_Immediate)
+    case 'L': // Low byte of a register pair
+    case 'H': // High byte of a register pair
+      if (!MO.isReg() || !M6502::ZP16RegClass.contains(MO.getReg()))
         return true;
-      O << MO.getImm() - 1;
+      O << M6502InstPrinter::getRegisterName(
+               Subtarget->getRegisterInfo()->getSubReg(
+                   MO.getReg(),
+                   ExtraCode[0] == 'L' ? M6502::sub_lo : M6502::sub_hi));
       return false;
-    case 'z':
-      // $0 if zero, regular printing otherwise
-      if (MO.getType() == MachineOperand::MO_Immediate && MO.getImm() == 0) {
-        O << "$0";
-        return false;
-      }
-      // If not, call printOperand as normal.
-      break;
-    case 'D': // Second part of a double word register operand
-    case 'L': // Low order register of a double word register operand
-    case 'M': // High order register of a double word register operand
-    {
-      if (OpNum == 0)
-        return true;
-      const MachineOperand &FlagsOP = MI->getOperand(OpNum - 1);
-      if (!FlagsOP.isImm())
-        return true;
-      unsigned Flags = FlagsOP.getImm();
-      unsigned NumVals = InlineAsm::getNumOperandRegisters(Flags);
-      // Number of registers represented by this operand. We are looking
-      // for 2 for 32 bit mode and 1 for 64 bit mode.
-      if (NumVals != 2) {
-        if (Subtarget->isGP64bit() && NumVals == 1 && MO.isReg()) {
-          unsigned Reg = MO.getReg();
-          O << '$' << M6502InstPrinter::getRegisterName(Reg);
-          return false;
-        }
-        return true;
-      }
-
-      unsigned RegOp = OpNum;
-      if (!Subtarget->isGP64bit()){
-        // Endianness reverses which register holds the high or low value
-        // between M and L.
-        switch(ExtraCode[0]) {
-        case 'M':
-          RegOp = (Subtarget->isLittle()) ? OpNum + 1 : OpNum;
-          break;
-        case 'L':
-          RegOp = (Subtarget->isLittle()) ? OpNum : OpNum + 1;
-          break;
-        case 'D': // Always the second part
-          RegOp = OpNum + 1;
-        }
-        if (RegOp >= MI->getNumOperands())
-          return true;
-        const MachineOperand &MO = MI->getOperand(RegOp);
-        if (!MO.isReg())
-          return true;
-        unsigned Reg = MO.getReg();
-        O << '$' << M6502InstPrinter::getRegisterName(Reg);
-        return false;
-      }
-    }
-    case 'w':
-      // Print MSA registers for the 'f' constraint
-      // In LLVM, the 'w' modifier doesn't need to do anything.
-      // We can just call printOperand as normal.
-      break;
     }
   }
 
@@ -573,19 +614,13 @@ bool M6502AsmPrinter::PrintAsmMemoryOperand(const MachineInstr *MI,
   const MachineOperand &OffsetMO = MI->getOperand(OpNum + 1);
   assert(BaseMO.isReg() && "Unexpected base pointer for inline asm memory operand.");
   assert(OffsetMO.isImm() && "Unexpected offset for inline asm memory operand.");
-  int Offset = OffsetMO.getImm();
-
-  // Currently we are expecting either no ExtraCode or 'D'
-  if (ExtraCode) {
-    if (ExtraCode[0] == 'D')
-      Offset += 4;
-    else
-      return true; // Unknown modifier.
-    // FIXME: M = high order bits
-    // FIXME: L = low order bits
-  }
 
-  O << Offset << "($" << M6502InstPrinter::getRegisterName(BaseMO.getReg()) << ")";
+  // The operand is the register pair holding the address, ready to be used
+  // as (rc),y.  There is no way to add an offset to it.
+  if (ExtraCode || OffsetMO.getImm())
+    return true;
+
+  O << M6502InstPrinter::getRegisterName(BaseMO.getReg());
 
   return false;
 }
@@ -593,34 +628,15 @@ bool M6502AsmPrinter::PrintAsmMemoryOperand(const MachineInstr *MI,
 void M6502AsmPrinter::printOperand(const MachineInstr *MI, int opNum,
                                   raw_ostream &O) {
   const MachineOperand &MO = MI->getOperand(opNum);
-  bool closeP = false;
-
-  if (MO.getTargetFlags())
-    closeP = true;
 
   switch(MO.getTargetFlags()) {
-  case M6502II::MO_GPREL:    O << "%gp_rel("; break;
-  case M6502II::MO_GOT_CALL: O << "%call16("; break;
-  case M6502II::MO_GOT:      O << "%got(";    break;
-  case M6502II::MO_ABS_HI:   O << "%hi(";     break;
-  case M6502II::MO_ABS_LO:   O << "%lo(";     break;
-  case M6502II::MO_HIGHER:   O << "%higher("; break;
-  case M6502II::MO_HIGHEST:  O << "%highest(("; break;
-  case M6502II::MO_TLSGD:    O << "%tlsgd(";  break;
-  case M6502II::MO_GOTTPREL: O << "%gottprel("; break;
-  case M6502II::MO_TPREL_HI: O << "%tprel_hi("; break;
-  case M6502II::MO_TPREL_LO: O << "%tprel_lo("; break;
-  case M6502II::MO_GPOFF_HI: O << "%hi(%neg(%gp_rel("; break;
-  case M6502II::MO_GPOFF_LO: O << "%lo(%neg(%gp_rel("; break;
-  case M6502II::MO_GOT_DISP: O << "%got_disp("; break;
-  case M6502II::MO_GOT_PAGE: O << "%got_page("; break;
-  case M6502II::MO_GOT_OFST: O << "%got_ofst("; break;
+  case M6502II::MO_ABS_HI:   O << '>'; break;
+  case M6502II::MO_ABS_LO:   O << '<'; break;
   }
 
   switch (MO.getType()) {
     case MachineOperand::MO_Register:
-      O << '$'
-        << StringRef(M6502InstPrinter::getRegisterName(MO.getReg())).lower();
+      O << M6502InstPrinter::getRegisterName(MO.getReg());
       break;
 
     case MachineOperand::MO_Immediate:
@@ -633,6 +649,12 @@ void M6502AsmPrinter::printOperand(const MachineInstr *MI, int opNum,
 
     case MachineOperand::MO_GlobalAddress:
       getSymbol(MO.getGlobal())->print(O, MAI);
+      if (MO.getOffset())
+        O << '+' << MO.getOffset();
+      break;
+
+    case MachineOperand::MO_ExternalSymbol:
+      GetExternalSymbolSymbol(MO.getSymbolName())->print(O, MAI);
       break;
 
     case MachineOperand::MO_BlockAddress: {
@@ -651,577 +673,170 @@ void M6502AsmPrinter::printOperand(const MachineInstr *MI, int opNum,
     default:
       llvm_unreachable("<unknown operand type>");
   }
-
-  if (closeP) O << ")";
 }
 
-void M6502AsmPrinter::
-printMemOperand(const MachineInstr *MI, int opNum, raw_ostream &O) {
-  // Load/Store memory operands -- imm($reg)
-  // If PIC target the target is loaded as the
-  // pattern lw $25,%call16($28)
-
-  // opNum can be invalid if instruction has reglist as operand.
-  // MemOperand is always last operand of instruction (base + offset).
-  switch (MI->getOpcode()) {
-  default:
-    break;
-  case M6502::SWM32_MM:
-  case M6502::LWM32_MM:
-    opNum = MI->getNumOperands() - 2;
-    break;
+// A byte of the address of a symbol, as in the arrays of low and high
+// bytes, is emitted with the < and > operators, which the assembler turns
+// into one byte fixups.
+const MCExpr *M6502AsmPrinter::lowerConstant(const Constant *CV) {
+  const auto *CE = dyn_cast<ConstantExpr>(CV);
+  if (!CE || !CE->getType()->isIntegerTy(8) ||
+      (CE->getOpcode() != Instruction::Trunc &&
+       CE->getOpcode() != Instruction::PtrToInt))
+    return AsmPrinter::lowerConstant(CV);
+
+  const Constant *Op = CE->getOperand(0);
+  M6502MCExpr::M6502ExprKind Kind = M6502MCExpr::MEK_LO;
+  const auto *Shift = dyn_cast<ConstantExpr>(Op);
+  if (Shift && Shift->getOpcode() == Instruction::LShr &&
+      Shift->getOperand(1) == ConstantInt::get(Shift->getType(), 8)) {
+    Kind = M6502MCExpr::MEK_HI;
+    Op = Shift->getOperand(0);
   }
-
-  printOperand(MI, opNum+1, O);
-  O << "(";
-  printOperand(MI, opNum, O);
-  O << ")";
+  return M6502MCExpr::create(Kind, AsmPrinter::lowerConstant(Op), OutContext);
 }
 
-void M6502AsmPrinter::
-printMemOperandEA(const MachineInstr *MI, int opNum, raw_ostream &O) {
-  // when using stack locations for not load/store instructions
-  // print the same way as all normal 3 operand instructions.
-  printOperand(MI, opNum, O);
-  O << ", ";
-  printOperand(MI, opNum+1, O);
-}
-
-void M6502AsmPrinter::
-printFCCOperand(const MachineInstr *MI, int opNum, raw_ostream &O,
-                const char *Modifier) {
-  const MachineOperand &MO = MI->getOperand(opNum);
-  O << M6502::M6502FCCToString((M6502::CondCode)MO.getImm());
+// A jump table is emitted as the low bytes of its addresses followed by the
+// high bytes, both indexed by X.  Unless optimizing for size, each of the two
+// is aligned to the power of two above its size, so that neither crosses a
+// page, which would cost a cycle.  The high bytes of a table of more than 128
+// entries then start on the next page.
+static unsigned getJumpTableAlignment(const MachineFunction &MF,
+                                      unsigned Entries) {
+  if (MF.getFunction()->optForSize())
+    return 1;
+  return std::min<uint64_t>(PowerOf2Ceil(Entries), 256);
 }
 
-void M6502AsmPrinter::
-printRegisterList(const MachineInstr *MI, int opNum, raw_ostream &O) {
-  for (int i = opNum, e = MI->getNumOperands(); i != e; ++i) {
-    if (i != opNum) O << ", ";
-    printOperand(MI, i, O);
-  }
-}
-
-void M6502AsmPrinter::EmitStartOfAsmFile(Module &M) {
-  M6502TargetStreamer &TS = getTargetStreamer();
-
-  // M6502TargetStreamer has an initialization order problem when emitting an
-  // object file directly (see M6502TargetELFStreamer for full details). Work
-  // around it by re-initializing the PIC state here.
-  TS.setPic(OutContext.getObjectFileInfo()->isPositionIndependent());
-
-  // Compute M6502 architecture attributes based on the default subtarget
-  // that we'd have constructed. Module level directives aren't LTO
-  // clean anyhow.
-  // FIXME: For ifunc related functions we could iterate over and look
-  // for a feature string that doesn't match the default one.
-  const Triple &TT = TM.getTargetTriple();
-  StringRef CPU = TM.getTargetCPU();
-  StringRef FS = TM.getTargetFeatureString();
-  const M6502TargetMachine &MTM = static_cast<const M6502TargetMachine &>(TM);
-  const M6502Subtarget STI(TT, CPU, FS, MTM.isLittleEndian(), MTM, 0);
-
-  bool IsABICalls = STI.isABICalls();
-  const M6502ABIInfo &ABI = MTM.getABI();
-  if (IsABICalls) {
-    TS.emitDirectiveAbiCalls();
-    // FIXME: This condition should be a lot more complicated that it is here.
-    //        Ideally it should test for properties of the ABI and not the ABI
-    //        itself.
-    //        For the moment, I'm only correcting enough to make M6502-IV work.
-    if (!isPositionIndependent() && STI.hasSym32())
-      TS.emitDirectiveOptionPic0();
-  }
-
-  // Tell the assembler which ABI we are using
-  std::string SectionName = std::string(".mdebug.") + getCurrentABIString();
-  OutStreamer->SwitchSection(
-      OutContext.getELFSection(SectionName, ELF::SHT_PROGBITS, 0));
-
-  // NaN: At the moment we only support:
-  // 1. .nan legacy (default)
-  // 2. .nan 2008
-  STI.isNaN2008() ? TS.emitDirectiveNaN2008()
-                  : TS.emitDirectiveNaNLegacy();
-
-  // TODO: handle O64 ABI
-
-  TS.updateABIInfo(STI);
-
-  // We should always emit a '.module fp=...' but binutils 2.24 does not accept
-  // it. We therefore emit it when it contradicts the ABI defaults (-mfpxx or
-  // -mfp64) and omit it otherwise.
-  if (ABI.IsO32() && (STI.isABI_FPXX() || STI.isFP64bit()))
-    TS.emitDirectiveModuleFP();
-
-  // We should always emit a '.module [no]oddspreg' but binutils 2.24 does not
-  // accept it. We therefore emit it when it contradicts the default or an
-  // option has changed the default (i.e. FPXX) and omit it otherwise.
-  if (ABI.IsO32() && (!STI.useOddSPReg() || STI.isABI_FPXX()))
-    TS.emitDirectiveModuleOddSPReg();
+unsigned M6502AsmPrinter::getJumpTableHiOffset(unsigned JTI) const {
+  unsigned Entries = MF->getJumpTableInfo()->getJumpTables()[JTI].MBBs.size();
+  return alignTo(Entries, getJumpTableAlignment(*MF, Entries));
 }
 
-void M6502AsmPrinter::emitInlineAsmStart() const {
-  M6502TargetStreamer &TS = getTargetStreamer();
-
-  // GCC's choice of assembler options for inline assembly code ('at', 'macro'
-  // and 'reorder') is different from LLVM's choice for generated code ('noat',
-  // 'nomacro' and 'noreorder').
-  // In order to maintain compatibility with inline assembly code which depends
-  // on GCC's assembler options being used, we have to switch to those options
-  // for the duration of the inline assembly block and then switch back.
-  TS.emitDirectiveSetPush();
-  TS.emitDirectiveSetAt();
-  TS.emitDirectiveSetMacro();
-  TS.emitDirectiveSetReorder();
-  OutStreamer->AddBlankLine();
-}
+void M6502AsmPrinter::EmitJumpTableInfo() {
+  const MachineJumpTableInfo *MJTI = MF->getJumpTableInfo();
+  if (!MJTI || MJTI->getJumpTables().empty())
+    return;
 
-void M6502AsmPrinter::emitInlineAsmEnd(const MCSubtargetInfo &StartInfo,
-                                      const MCSubtargetInfo *EndInfo) const {
-  OutStreamer->AddBlankLine();
-  getTargetStreamer().emitDirectiveSetPop();
-}
+  const Function *F = MF->getFunction();
+  const TargetLoweringObjectFile &TLOF = getObjFileLowering();
+  if (!TLOF.shouldPutJumpTableInFunctionSection(false, *F))
+    OutStreamer->SwitchSection(TLOF.getSectionForJumpTable(*F, TM));
 
-void M6502AsmPrinter::EmitJal(const MCSubtargetInfo &STI, MCSymbol *Symbol) {
-  MCInst I;
-  I.setOpcode(M6502::JAL);
-  I.addOperand(
-      MCOperand::createExpr(MCSymbolRefExpr::create(Symbol, OutContext)));
-  OutStreamer->EmitInstruction(I, STI);
-}
+  const std::vector<MachineJumpTableEntry> &JT = MJTI->getJumpTables();
+  for (unsigned JTI = 0, E = JT.size(); JTI != E; ++JTI) {
+    const std::vector<MachineBasicBlock *> &JTBBs = JT[JTI].MBBs;
 
-void M6502AsmPrinter::EmitInstrReg(const MCSubtargetInfo &STI, unsigned Opcode,
-                                  unsigned Reg) {
-  MCInst I;
-  I.setOpcode(Opcode);
-  I.addOperand(MCOperand::createReg(Reg));
-  OutStreamer->EmitInstruction(I, STI);
-}
+    // If this jump table was deleted, ignore it.
+    if (JTBBs.empty())
+      continue;
 
-void M6502AsmPrinter::EmitInstrRegReg(const MCSubtargetInfo &STI,
-                                     unsigned Opcode, unsigned Reg1,
-                                     unsigned Reg2) {
-  MCInst I;
-  //
-  // Because of the current td files for M650232, the operands for MTC1
-  // appear backwards from their normal assembly order. It's not a trivial
-  // change to fix this in the td file so we adjust for it here.
-  //
-  if (Opcode == M6502::MTC1) {
-    unsigned Temp = Reg1;
-    Reg1 = Reg2;
-    Reg2 = Temp;
+    unsigned AlignLog2 = Log2_32(getJumpTableAlignment(*MF, JTBBs.size()));
+    EmitAlignment(AlignLog2);
+    OutStreamer->EmitLabel(GetJTISymbol(JTI));
+    for (auto Kind : {M6502MCExpr::MEK_LO, M6502MCExpr::MEK_HI}) {
+      noteSectionData(OutStreamer->getCurrentSectionOnly(), AlignLog2,
+                      JTBBs.size());
+      if (Kind == M6502MCExpr::MEK_HI)
+        EmitAlignment(AlignLog2);
+      for (const MachineBasicBlock *MBB : JTBBs)
+        OutStreamer->EmitValue(
+            M6502MCExpr::create(
+                Kind, MCSymbolRefExpr::create(MBB->getSymbol(), OutContext),
+                OutContext),
+            1);
+    }
   }
-  I.setOpcode(Opcode);
-  I.addOperand(MCOperand::createReg(Reg1));
-  I.addOperand(MCOperand::createReg(Reg2));
-  OutStreamer->EmitInstruction(I, STI);
 }
 
-void M6502AsmPrinter::EmitInstrRegRegReg(const MCSubtargetInfo &STI,
-                                        unsigned Opcode, unsigned Reg1,
-                                        unsigned Reg2, unsigned Reg3) {
-  MCInst I;
-  I.setOpcode(Opcode);
-  I.addOperand(MCOperand::createReg(Reg1));
-  I.addOperand(MCOperand::createReg(Reg2));
-  I.addOperand(MCOperand::createReg(Reg3));
-  OutStreamer->EmitInstruction(I, STI);
+void M6502AsmPrinter::noteSectionData(const MCSection *Section,
+                                      unsigned AlignLog2, uint64_t Size) {
+  SectionLayout &Layout = SectionLayouts[Section];
+  Layout.Size = alignTo(Layout.Size, 1ull << AlignLog2) + Size;
+  Layout.AlignLog2 = std::max(Layout.AlignLog2, AlignLog2);
 }
 
-void M6502AsmPrinter::EmitMovFPIntPair(const MCSubtargetInfo &STI,
-                                      unsigned MovOpc, unsigned Reg1,
-                                      unsigned Reg2, unsigned FPReg1,
-                                      unsigned FPReg2, bool LE) {
-  if (!LE) {
-    unsigned temp = Reg1;
-    Reg1 = Reg2;
-    Reg2 = temp;
+/// Return true if GV is read with a variable index, which is when an indexed
+/// addressing mode is used, by a function which is not optimized for size.
+static bool isIndexedTable(const GlobalVariable &GV) {
+  for (const User *U : GV.users()) {
+    auto *GEP = dyn_cast<GEPOperator>(U);
+    if (!GEP || GEP->hasAllConstantIndices())
+      continue;
+    for (const User *GU : GEP->users())
+      if (auto *LI = dyn_cast<LoadInst>(GU))
+        if (!LI->getFunction()->optForSize())
+          return true;
   }
-  EmitInstrRegReg(STI, MovOpc, Reg1, FPReg1);
-  EmitInstrRegReg(STI, MovOpc, Reg2, FPReg2);
+  return false;
 }
 
-void M6502AsmPrinter::EmitSwapFPIntParams(const MCSubtargetInfo &STI,
-                                         M650216HardFloatInfo::FPParamVariant PV,
-                                         bool LE, bool ToFP) {
-  using namespace M650216HardFloatInfo;
-
-  unsigned MovOpc = ToFP ? M6502::MTC1 : M6502::MFC1;
-  switch (PV) {
-  case FSig:
-    EmitInstrRegReg(STI, MovOpc, M6502::A0, M6502::F12);
-    break;
-  case FFSig:
-    EmitMovFPIntPair(STI, MovOpc, M6502::A0, M6502::A1, M6502::F12, M6502::F14, LE);
-    break;
-  case FDSig:
-    EmitInstrRegReg(STI, MovOpc, M6502::A0, M6502::F12);
-    EmitMovFPIntPair(STI, MovOpc, M6502::A2, M6502::A3, M6502::F14, M6502::F15, LE);
-    break;
-  case DSig:
-    EmitMovFPIntPair(STI, MovOpc, M6502::A0, M6502::A1, M6502::F12, M6502::F13, LE);
-    break;
-  case DDSig:
-    EmitMovFPIntPair(STI, MovOpc, M6502::A0, M6502::A1, M6502::F12, M6502::F13, LE);
-    EmitMovFPIntPair(STI, MovOpc, M6502::A2, M6502::A3, M6502::F14, M6502::F15, LE);
-    break;
-  case DFSig:
-    EmitMovFPIntPair(STI, MovOpc, M6502::A0, M6502::A1, M6502::F12, M6502::F13, LE);
-    EmitInstrRegReg(STI, MovOpc, M6502::A2, M6502::F14);
-    break;
-  case NoSig:
+// An indexed read whose effective address lies in another page than its base
+// costs a cycle.  A table of at most 256 bytes is kept within a page by
+// aligning it to the power of two above its size, but only when it would
+// cross a page where it falls in its section otherwise, as the padding may
+// cost almost as many bytes as the table.  The start of a section is only
+// known to be aligned as much as the most aligned data in it, so the offset
+// of a table is known modulo that alignment.
+void M6502AsmPrinter::EmitGlobalVariable(const GlobalVariable *GV) {
+  // Declarations and special globals are not emitted as data.
+  if (!GV->hasInitializer() || GV->getName().startswith("llvm.")) {
+    AsmPrinter::EmitGlobalVariable(GV);
     return;
   }
-}
 
-void M6502AsmPrinter::EmitSwapFPIntRetval(
-    const MCSubtargetInfo &STI, M650216HardFloatInfo::FPReturnVariant RV,
-    bool LE) {
-  using namespace M650216HardFloatInfo;
-
-  unsigned MovOpc = M6502::MFC1;
-  switch (RV) {
-  case FRet:
-    EmitInstrRegReg(STI, MovOpc, M6502::V0, M6502::F0);
-    break;
-  case DRet:
-    EmitMovFPIntPair(STI, MovOpc, M6502::V0, M6502::V1, M6502::F0, M6502::F1, LE);
-    break;
-  case CFRet:
-    EmitMovFPIntPair(STI, MovOpc, M6502::V0, M6502::V1, M6502::F0, M6502::F1, LE);
-    break;
-  case CDRet:
-    EmitMovFPIntPair(STI, MovOpc, M6502::V0, M6502::V1, M6502::F0, M6502::F1, LE);
-    EmitMovFPIntPair(STI, MovOpc, M6502::A0, M6502::A1, M6502::F2, M6502::F3, LE);
-    break;
-  case NoFPRet:
-    break;
-  }
-}
-
-void M6502AsmPrinter::EmitFPCallStub(
-    const char *Symbol, const M650216HardFloatInfo::FuncSignature *Signature) {
-  using namespace M650216HardFloatInfo;
-
-  MCSymbol *MSymbol = OutContext.getOrCreateSymbol(StringRef(Symbol));
-  bool LE = getDataLayout().isLittleEndian();
-  // Construct a local MCSubtargetInfo here.
-  // This is because the MachineFunction won't exist (but have not yet been
-  // freed) and since we're at the global level we can use the default
-  // constructed subtarget.
-  std::unique_ptr<MCSubtargetInfo> STI(TM.getTarget().createMCSubtargetInfo(
-      TM.getTargetTriple().str(), TM.getTargetCPU(),
-      TM.getTargetFeatureString()));
-
-  //
-  // .global xxxx
-  //
-  OutStreamer->EmitSymbolAttribute(MSymbol, MCSA_Global);
-  const char *RetType;
-  //
-  // make the comment field identifying the return and parameter
-  // types of the floating point stub
-  // # Stub function to call rettype xxxx (params)
-  //
-  switch (Signature->RetSig) {
-  case FRet:
-    RetType = "float";
-    break;
-  case DRet:
-    RetType = "double";
-    break;
-  case CFRet:
-    RetType = "complex";
-    break;
-  case CDRet:
-    RetType = "double complex";
-    break;
-  case NoFPRet:
-    RetType = "";
-    break;
-  }
-  const char *Parms;
-  switch (Signature->ParamSig) {
-  case FSig:
-    Parms = "float";
-    break;
-  case FFSig:
-    Parms = "float, float";
-    break;
-  case FDSig:
-    Parms = "float, double";
-    break;
-  case DSig:
-    Parms = "double";
-    break;
-  case DDSig:
-    Parms = "double, double";
-    break;
-  case DFSig:
-    Parms = "double, float";
-    break;
-  case NoSig:
-    Parms = "";
-    break;
-  }
-  OutStreamer->AddComment("\t# Stub function to call " + Twine(RetType) + " " +
-                          Twine(Symbol) + " (" + Twine(Parms) + ")");
-  //
-  // probably not necessary but we save and restore the current section state
-  //
-  OutStreamer->PushSection();
-  //
-  // .section m650216.call.fpxxxx,"ax",@progbits
-  //
-  MCSectionELF *M = OutContext.getELFSection(
-      ".m650216.call.fp." + std::string(Symbol), ELF::SHT_PROGBITS,
-      ELF::SHF_ALLOC | ELF::SHF_EXECINSTR);
-  OutStreamer->SwitchSection(M, nullptr);
-  //
-  // .align 2
-  //
-  OutStreamer->EmitValueToAlignment(4);
-  M6502TargetStreamer &TS = getTargetStreamer();
-  //
-  // .set nom650216
-  // .set nomicrom6502
-  //
-  TS.emitDirectiveSetNoM650216();
-  TS.emitDirectiveSetNoMicroM6502();
-  //
-  // .ent __call_stub_fp_xxxx
-  // .type  __call_stub_fp_xxxx,@function
-  //  __call_stub_fp_xxxx:
-  //
-  std::string x = "__call_stub_fp_" + std::string(Symbol);
-  MCSymbolELF *Stub =
-      cast<MCSymbolELF>(OutContext.getOrCreateSymbol(StringRef(x)));
-  TS.emitDirectiveEnt(*Stub);
-  MCSymbol *MType =
-      OutContext.getOrCreateSymbol("__call_stub_fp_" + Twine(Symbol));
-  OutStreamer->EmitSymbolAttribute(MType, MCSA_ELF_TypeFunction);
-  OutStreamer->EmitLabel(Stub);
-
-  // Only handle non-pic for now.
-  assert(!isPositionIndependent() &&
-         "should not be here if we are compiling pic");
-  TS.emitDirectiveSetReorder();
-  //
-  // We need to add a M6502MCExpr class to MCTargetDesc to fully implement
-  // stubs without raw text but this current patch is for compiler generated
-  // functions and they all return some value.
-  // The calling sequence for non pic is different in that case and we need
-  // to implement %lo and %hi in order to handle the case of no return value
-  // See the corresponding method in M650216HardFloat for details.
-  //
-  // mov the return address to S2.
-  // we have no stack space to store it and we are about to make another call.
-  // We need to make sure that the enclosing function knows to save S2
-  // This should have already been handled.
-  //
-  // Mov $18, $31
-
-  EmitInstrRegRegReg(*STI, M6502::OR, M6502::S2, M6502::RA, M6502::ZERO);
-
-  EmitSwapFPIntParams(*STI, Signature->ParamSig, LE, true);
-
-  // Jal xxxx
-  //
-  EmitJal(*STI, MSymbol);
-
-  // fix return values
-  EmitSwapFPIntRetval(*STI, Signature->RetSig, LE);
-  //
-  // do the return
-  // if (Signature->RetSig == NoFPRet)
-  //  llvm_unreachable("should not be any stubs here with no return value");
-  // else
-  EmitInstrReg(*STI, M6502::JR, M6502::S2);
-
-  MCSymbol *Tmp = OutContext.createTempSymbol();
-  OutStreamer->EmitLabel(Tmp);
-  const MCSymbolRefExpr *E = MCSymbolRefExpr::create(Stub, OutContext);
-  const MCSymbolRefExpr *T = MCSymbolRefExpr::create(Tmp, OutContext);
-  const MCExpr *T_min_E = MCBinaryExpr::createSub(T, E, OutContext);
-  OutStreamer->emitELFSize(Stub, T_min_E);
-  TS.emitDirectiveEnd(x);
-  OutStreamer->PopSection();
-}
-
-void M6502AsmPrinter::EmitEndOfAsmFile(Module &M) {
-  // Emit needed stubs
-  //
-  for (std::map<
-           const char *,
-           const M650216HardFloatInfo::FuncSignature *>::const_iterator
-           it = StubsNeeded.begin();
-       it != StubsNeeded.end(); ++it) {
-    const char *Symbol = it->first;
-    const M650216HardFloatInfo::FuncSignature *Signature = it->second;
-    EmitFPCallStub(Symbol, Signature);
+  // Common symbols are placed by the linker.
+  SectionKind Kind = TargetLoweringObjectFile::getKindForGlobal(GV, TM);
+  const TargetLoweringObjectFile &TLOF = getObjFileLowering();
+  MCSection *Section =
+      Kind.isCommon() ? nullptr : TLOF.SectionForGlobal(GV, Kind, TM);
+  if (!Section || (Kind.isBSSLocal() && Section == TLOF.getBSSSection())) {
+    AsmPrinter::EmitGlobalVariable(GV);
+    return;
   }
-  // return to the text section
-  OutStreamer->SwitchSection(OutContext.getObjectFileInfo()->getTextSection());
-}
 
-void M6502AsmPrinter::EmitSled(const MachineInstr &MI, SledKind Kind) {
-  const uint8_t NoopsInSledCount = Subtarget->isGP64bit() ? 15 : 11;
-  // For m650232 we want to emit the following pattern:
-  //
-  // .Lxray_sled_N:
-  //   ALIGN
-  //   B .tmpN
-  //   11 NOP instructions (44 bytes)
-  //   ADDIU T9, T9, 52 
-  // .tmpN
-  //
-  // We need the 44 bytes (11 instructions) because at runtime, we'd
-  // be patching over the full 48 bytes (12 instructions) with the following
-  // pattern:
-  //
-  //   ADDIU    SP, SP, -8
-  //   NOP
-  //   SW       RA, 4(SP)
-  //   SW       T9, 0(SP)
-  //   LUI      T9, %hi(__xray_FunctionEntry/Exit)
-  //   ORI      T9, T9, %lo(__xray_FunctionEntry/Exit)
-  //   LUI      T0, %hi(function_id)
-  //   JALR     T9
-  //   ORI      T0, T0, %lo(function_id)
-  //   LW       T9, 0(SP)
-  //   LW       RA, 4(SP)
-  //   ADDIU    SP, SP, 8
-  //
-  // We add 52 bytes to t9 because we want to adjust the function pointer to
-  // the actual start of function i.e. the address just after the noop sled.
-  // We do this because gp displacement relocation is emitted at the start of
-  // of the function i.e after the nop sled and to correctly calculate the
-  // global offset table address, t9 must hold the address of the instruction
-  // containing the gp displacement relocation.
-  // FIXME: Is this correct for the static relocation model?
-  //
-  // For m650264 we want to emit the following pattern:
-  //
-  // .Lxray_sled_N:
-  //   ALIGN
-  //   B .tmpN
-  //   15 NOP instructions (60 bytes)
-  // .tmpN
-  //
-  // We need the 60 bytes (15 instructions) because at runtime, we'd
-  // be patching over the full 64 bytes (16 instructions) with the following
-  // pattern:
-  //
-  //   DADDIU   SP, SP, -16
-  //   NOP
-  //   SD       RA, 8(SP)
-  //   SD       T9, 0(SP)
-  //   LUI      T9, %highest(__xray_FunctionEntry/Exit)
-  //   ORI      T9, T9, %higher(__xray_FunctionEntry/Exit)
-  //   DSLL     T9, T9, 16
-  //   ORI      T9, T9, %hi(__xray_FunctionEntry/Exit)
-  //   DSLL     T9, T9, 16
-  //   ORI      T9, T9, %lo(__xray_FunctionEntry/Exit)
-  //   LUI      T0, %hi(function_id)
-  //   JALR     T9
-  //   ADDIU    T0, T0, %lo(function_id)
-  //   LD       T9, 0(SP)
-  //   LD       RA, 8(SP)
-  //   DADDIU   SP, SP, 16
-  //
-  OutStreamer->EmitCodeAlignment(4);
-  auto CurSled = OutContext.createTempSymbol("xray_sled_", true);
-  OutStreamer->EmitLabel(CurSled);
-  auto Target = OutContext.createTempSymbol();
-
-  // Emit "B .tmpN" instruction, which jumps over the nop sled to the actual
-  // start of function
-  const MCExpr *TargetExpr = MCSymbolRefExpr::create(
-      Target, MCSymbolRefExpr::VariantKind::VK_None, OutContext);
-  EmitToStreamer(*OutStreamer, MCInstBuilder(M6502::BEQ)
-                                   .addReg(M6502::ZERO)
-                                   .addReg(M6502::ZERO)
-                                   .addExpr(TargetExpr));
-
-  for (int8_t I = 0; I < NoopsInSledCount; I++)
-    EmitToStreamer(*OutStreamer, MCInstBuilder(M6502::SLL)
-                                     .addReg(M6502::ZERO)
-                                     .addReg(M6502::ZERO)
-                                     .addImm(0));
-
-  OutStreamer->EmitLabel(Target);
-
-  if (!Subtarget->isGP64bit()) {
-    EmitToStreamer(*OutStreamer,
-                   MCInstBuilder(M6502::ADDiu)
-                       .addReg(M6502::T9)
-                       .addReg(M6502::T9)
-                       .addImm(0x34));
+  // The alignment AsmPrinter::EmitGlobalVariable gives GV.
+  const DataLayout &DL = getDataLayout();
+  uint64_t Size = DL.getTypeAllocSize(GV->getValueType());
+  unsigned AlignLog2 = DL.getPreferredAlignmentLog(GV);
+  if (GV->getAlignment() &&
+      (Log2_32(GV->getAlignment()) > AlignLog2 || GV->hasSection()))
+    AlignLog2 = Log2_32(GV->getAlignment());
+
+  if (PageAlignTables && Size > 1 && Size <= 256 &&
+      GV->getValueType()->isArrayTy() && !GV->hasSection() &&
+      isIndexedTable(*GV)) {
+    const SectionLayout &Layout = SectionLayouts.lookup(Section);
+    uint64_t Offset = alignTo(Layout.Size, 1ull << AlignLog2);
+    unsigned KnownLog2 = SectionLayoutsUnknown
+                             ? AlignLog2
+                             : std::max(Layout.AlignLog2, AlignLog2);
+    uint64_t Known = 1ull << std::min(KnownLog2, 8u);
+    if (Offset % Known + Size > Known) {
+      AlignLog2 = Log2_64_Ceil(Size);
+      DEBUG(dbgs() << "Page layout: aligning table " << GV->getName() << " ("
+                   << Size << " bytes) to " << (1u << AlignLog2) << "\n");
+      OutStreamer->SwitchSection(Section);
+      EmitAlignment(AlignLog2);
+      ++NumTablesAligned;
+    }
   }
 
-  recordSled(CurSled, MI, Kind);
-}
-
-void M6502AsmPrinter::LowerPATCHABLE_FUNCTION_ENTER(const MachineInstr &MI) {
-  EmitSled(MI, SledKind::FUNCTION_ENTER);
-}
-
-void M6502AsmPrinter::LowerPATCHABLE_FUNCTION_EXIT(const MachineInstr &MI) {
-  EmitSled(MI, SledKind::FUNCTION_EXIT);
-}
-
-void M6502AsmPrinter::LowerPATCHABLE_TAIL_CALL(const MachineInstr &MI) {
-  EmitSled(MI, SledKind::TAIL_CALL);
+  noteSectionData(Section, AlignLog2, Size);
+  AsmPrinter::EmitGlobalVariable(GV);
 }
 
-void M6502AsmPrinter::PrintDebugValueComment(const MachineInstr *MI,
-                                           raw_ostream &OS) {
-  // TODO: implement
-}
-
-// Emit .dtprelword or .dtpreldword directive
-// and value for debug thread local expression.
-void M6502AsmPrinter::EmitDebugThreadLocal(const MCExpr *Value,
-                                          unsigned Size) const {
-  switch (Size) {
-  case 4:
-    OutStreamer->EmitDTPRel32Value(Value);
-    break;
-  case 8:
-    OutStreamer->EmitDTPRel64Value(Value);
-    break;
-  default:
-    llvm_unreachable("Unexpected size of expression value.");
-  }
-}
-
-// Align all targets of indirect branches on bundle size.  Used only if target
-// is NaCl.
-void M6502AsmPrinter::NaClAlignIndirectJumpTargets(MachineFunction &MF) {
-  // Align all blocks that are jumped to through jump table.
-  if (MachineJumpTableInfo *JtInfo = MF.getJumpTableInfo()) {
-    const std::vector<MachineJumpTableEntry> &JT = JtInfo->getJumpTables();
-    for (unsigned I = 0; I < JT.size(); ++I) {
-      const std::vector<MachineBasicBlock*> &MBBs = JT[I].MBBs;
-
-      for (unsigned J = 0; J < MBBs.size(); ++J)
-        MBBs[J]->setAlignment(M6502_NACL_BUNDLE_ALIGN);
-    }
-  }
+void M6502AsmPrinter::EmitStartOfAsmFile(Module &M) {
+  MCInstLowering.Initialize(&OutContext);
 
-  // If basic block address is taken, block can be target of indirect branch.
-  for (auto &MBB : MF) {
-    if (MBB.hasAddressTaken())
-      MBB.setAlignment(M6502_NACL_BUNDLE_ALIGN);
-  }
+  // Name the zero page registers once for the whole file.
+  getTargetStreamer().emitZPRegisterBank(getM6502ZPRegBase(),
+                                         M6502RegisterInfo::getNumZPRegs());
 }
 
-bool M6502AsmPrinter::isLongBranchPseudo(int Opcode) const {
-  return (Opcode == M6502::LONG_BRANCH_LUi
-          || Opcode == M6502::LONG_BRANCH_ADDiu
-          || Opcode == M6502::LONG_BRANCH_DADDiu);
+void M6502AsmPrinter::EmitEndOfAsmFile(Module &M) {
+  emitStackReport();
+  emitStaticFrames();
 }
 
 // Force static initialization.
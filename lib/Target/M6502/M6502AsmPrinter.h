@@ -14,23 +14,25 @@
 #ifndef LLVM_LIB_TARGET_M6502_M6502ASMPRINTER_H
 #define LLVM_LIB_TARGET_M6502_M6502ASMPRINTER_H
 
-#include "M650216HardFloatInfo.h"
 #include "M6502MCInstLower.h"
 #include "M6502Subtarget.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/Support/Compiler.h"
-#include <algorithm>
-#include <map>
 #include <memory>
 
 namespace llvm {
 
+class Function;
+class GlobalVariable;
 class MCOperand;
+class MCSection;
 class MCSubtargetInfo;
 class MCSymbol;
 class MachineBasicBlock;
-class MachineConstantPool;
 class MachineFunction;
 class MachineInstr;
 class MachineOperand;
@@ -43,79 +45,66 @@ class TargetMachine;
 class LLVM_LIBRARY_VISIBILITY M6502AsmPrinter : public AsmPrinter {
   M6502TargetStreamer &getTargetStreamer() const;
 
-  void EmitInstrWithMacroNoAT(const MachineInstr *MI);
-
-  //===------------------------------------------------------------------===//
-  // XRay implementation
-  //===------------------------------------------------------------------===//
-
-public:
-  // XRay-specific lowering for M6502.
-  void LowerPATCHABLE_FUNCTION_ENTER(const MachineInstr &MI);
-  void LowerPATCHABLE_FUNCTION_EXIT(const MachineInstr &MI);
-  void LowerPATCHABLE_TAIL_CALL(const MachineInstr &MI);
-  // Helper function that emits the XRay sleds we've collected for a particular
-  // function.
-  void EmitXRayTable();
-
-private:
-  /// MCP - Keep a pointer to constantpool entries of the current
-  /// MachineFunction.
-  const MachineConstantPool *MCP = nullptr;
-
-  /// InConstantPool - Maintain state when emitting a sequence of constant
-  /// pool entries so we can properly mark them as data regions.
-  bool InConstantPool = false;
-
-  std::map<const char *, const M650216HardFloatInfo::FuncSignature *>
-      StubsNeeded;
-
-  void EmitSled(const MachineInstr &MI, SledKind Kind);
-
-  // tblgen'erated function.
-  bool emitPseudoExpansionLowering(MCStreamer &OutStreamer,
-                                   const MachineInstr *MI);
-
-  // Emit PseudoReturn, PseudoReturn64, PseudoIndirectBranch,
-  // and PseudoIndirectBranch64 as a JR, JR_MM, JALR, or JALR64 as appropriate
-  // for the target.
-  void emitPseudoIndirectBranch(MCStreamer &OutStreamer,
-                                const MachineInstr *MI);
-
   // lowerOperand - Convert a MachineOperand into the equivalent MCOperand.
   bool lowerOperand(const MachineOperand &MO, MCOperand &MCOp);
 
-  void emitInlineAsmStart() const override;
-
-  void emitInlineAsmEnd(const MCSubtargetInfo &StartInfo,
-                        const MCSubtargetInfo *EndInfo) const override;
-
-  void EmitJal(const MCSubtargetInfo &STI, MCSymbol *Symbol);
-
-  void EmitInstrReg(const MCSubtargetInfo &STI, unsigned Opcode, unsigned Reg);
-
-  void EmitInstrRegReg(const MCSubtargetInfo &STI, unsigned Opcode,
-                       unsigned Reg1, unsigned Reg2);
-
-  void EmitInstrRegRegReg(const MCSubtargetInfo &STI, unsigned Opcode,
-                          unsigned Reg1, unsigned Reg2, unsigned Reg3);
-
-  void EmitMovFPIntPair(const MCSubtargetInfo &STI, unsigned MovOpc,
-                        unsigned Reg1, unsigned Reg2, unsigned FPReg1,
-                        unsigned FPReg2, bool LE);
-
-  void EmitSwapFPIntParams(const MCSubtargetInfo &STI,
-                           M650216HardFloatInfo::FPParamVariant, bool LE,
-                           bool ToFP);
-
-  void EmitSwapFPIntRetval(const MCSubtargetInfo &STI,
-                           M650216HardFloatInfo::FPReturnVariant, bool LE);
-
-  void EmitFPCallStub(const char *, const M650216HardFloatInfo::FuncSignature *);
-
-  void NaClAlignIndirectJumpTargets(MachineFunction &MF);
-
-  bool isLongBranchPseudo(int Opcode) const;
+  // There is no indirect JSR.  Emit a JSR to a local JMP (ind) trampoline
+  // instead.
+  void emitIndirectCall(const MachineInstr *MI);
+
+  // The calls made by a function, its frame if the frame is static, and
+  // what it pushes on the hardware stack.
+  struct CallGraphNode {
+    const Function *F = nullptr;
+    MCSymbol *FrameSym = nullptr;
+    uint64_t FrameSize = 0;
+    uint64_t FrameBase = 0;
+    bool CallsIndirect = false;
+    SmallVector<MCSymbol *, 4> Callees;
+    // The most bytes the function itself has pushed at any point, and the
+    // bytes it has pushed at each call in Callees and at its indirect calls.
+    unsigned PushDepth = 0;
+    unsigned IndirectCallDepth = 0;
+    SmallVector<unsigned, 4> CallDepths;
+  };
+
+  // Call graph of the module, collected while functions are emitted.
+  MapVector<MCSymbol *, CallGraphNode> CallGraph;
+
+  void recordCallGraphNode(const MachineFunction &MF);
+
+  // The functions an indirect call may reach.
+  void getAddressTaken(SmallVectorImpl<MCSymbol *> &Syms) const;
+
+  // Overlay the static frames of functions which are never active at the
+  // same time and emit the area holding them.
+  void emitStaticFrames();
+
+  // Compute the worst-case depth of the hardware stack from each entry point
+  // and interrupt handler, write the report and check it against the budget.
+  void emitStackReport();
+
+  // The bytes emitted so far to a data section, and the alignment its start
+  // is known to have, which tell whether a table would cross a page.
+  struct SectionLayout {
+    uint64_t Size = 0;
+    unsigned AlignLog2 = 0;
+  };
+  DenseMap<const MCSection *, SectionLayout> SectionLayouts;
+
+  // Whether a constant pool was emitted, whose placement is not tracked.
+  bool SectionLayoutsUnknown = false;
+
+  void noteSectionData(const MCSection *Section, unsigned AlignLog2,
+                       uint64_t Size);
+
+  // Whether the assembler was last told that A is 16 bits wide, on the
+  // 65816.
+  bool AccWide = false;
+
+  // Tell the assembler the width of the immediate operands of the
+  // instructions using A, unless it already assumes it.
+  void emitAccWidth(bool Wide);
 
 public:
   const M6502Subtarget *Subtarget;
@@ -130,22 +119,7 @@ public:
 
   bool runOnMachineFunction(MachineFunction &MF) override;
 
-  void EmitConstantPool() override {
-    bool UsingConstantPools =
-      (Subtarget->inM650216Mode() && Subtarget->useConstantIslands());
-    if (!UsingConstantPools)
-      AsmPrinter::EmitConstantPool();
-    // we emit constant pools customly!
-  }
-
   void EmitInstruction(const MachineInstr *MI) override;
-  void printSavedRegsBitmask();
-  void emitFrameDirective();
-  const char *getCurrentABIString() const;
-  void EmitFunctionEntryLabel() override;
-  void EmitFunctionBodyStart() override;
-  void EmitFunctionBodyEnd() override;
-  void EmitBasicBlockEnd(const MachineBasicBlock &MBB) override;
   bool isBlockOnlyReachableByFallthrough(
                                    const MachineBasicBlock* MBB) const override;
   bool PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
@@ -155,15 +129,13 @@ public:
                              unsigned AsmVariant, const char *ExtraCode,
                              raw_ostream &O) override;
   void printOperand(const MachineInstr *MI, int opNum, raw_ostream &O);
-  void printMemOperand(const MachineInstr *MI, int opNum, raw_ostream &O);
-  void printMemOperandEA(const MachineInstr *MI, int opNum, raw_ostream &O);
-  void printFCCOperand(const MachineInstr *MI, int opNum, raw_ostream &O,
-                       const char *Modifier = nullptr);
-  void printRegisterList(const MachineInstr *MI, int opNum, raw_ostream &O);
+  const MCExpr *lowerConstant(const Constant *CV) override;
+  void EmitJumpTableInfo() override;
+  void EmitGlobalVariable(const GlobalVariable *GV) override;
+  // The offset of the high bytes of jump table JTI from its label.
+  unsigned getJumpTableHiOffset(unsigned JTI) const;
   void EmitStartOfAsmFile(Module &M) override;
   void EmitEndOfAsmFile(Module &M) override;
-  void PrintDebugValueComment(const MachineInstr *MI, raw_ostream &OS);
-  void EmitDebugThreadLocal(const MCExpr *Value, unsigned Size) const override;
 };
 
 } // end namespace llvm
@@ -0,0 +1,143 @@
+//===- M6502CallGraph.cpp - Whole program M6502 call graph ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// An interrupt handler starts a call chain of its own, which may begin in
+// the middle of any other.  A function reachable from a handler is only
+// ever active once at a time if nothing outside the functions the handler
+// reaches calls it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502CallGraph.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+
+using namespace llvm;
+
+M6502CallGraph::M6502CallGraph(Module &M) : M(M) {
+  SmallVector<Function *, 16> AddressTaken;
+  for (Function &F : M)
+    if (!F.isDeclaration() && F.hasAddressTaken() &&
+        !F.hasFnAttribute("interrupt"))
+      AddressTaken.push_back(&F);
+
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    SmallPtrSet<Function *, 8> Seen;
+    CalleeList &List = Callees[&F];
+    auto AddCallee = [&](Function *Callee) {
+      if (Callee && !Callee->isDeclaration() && Seen.insert(Callee).second)
+        List.push_back(Callee);
+    };
+
+    for (Instruction &I : instructions(F)) {
+      if (isa<MemSetInst>(&I)) {
+        AddCallee(M.getFunction("memset"));
+        continue;
+      }
+      if (isa<MemCpyInst>(&I)) {
+        AddCallee(M.getFunction("memcpy"));
+        continue;
+      }
+      if (isa<MemMoveInst>(&I)) {
+        AddCallee(M.getFunction("memmove"));
+        continue;
+      }
+
+      CallSite CS(&I);
+      if (!CS || isa<IntrinsicInst>(&I))
+        continue;
+
+      if (Function *Callee = dyn_cast<Function>(
+              CS.getCalledValue()->stripPointerCasts())) {
+        AddCallee(Callee);
+        continue;
+      }
+
+      for (Function *Callee : AddressTaken)
+        AddCallee(Callee);
+    }
+  }
+}
+
+bool M6502CallGraph::isRecursive(Function *F) const {
+  auto Entry = Callees.find(F);
+  if (Entry == Callees.end())
+    return false;
+
+  SmallPtrSet<Function *, 32> Visited;
+  SmallVector<Function *, 32> Worklist(Entry->second.begin(),
+                                       Entry->second.end());
+
+  while (!Worklist.empty()) {
+    Function *G = Worklist.pop_back_val();
+    if (G == F)
+      return true;
+    if (!Visited.insert(G).second)
+      continue;
+
+    auto It = Callees.find(G);
+    if (It != Callees.end())
+      Worklist.append(It->second.begin(), It->second.end());
+  }
+
+  return false;
+}
+
+void M6502CallGraph::findSharedWithInterrupts(
+    SmallPtrSetImpl<Function *> &Shared) const {
+  DenseMap<Function *, CalleeList> Callers;
+  for (const auto &Entry : Callees)
+    for (Function *Callee : Entry.second)
+      Callers[Callee].push_back(Entry.first);
+
+  for (Function &H : M) {
+    if (H.isDeclaration() || !H.hasFnAttribute("interrupt"))
+      continue;
+
+    SmallPtrSet<Function *, 32> Reached;
+    SmallVector<Function *, 32> Worklist(1, &H);
+    while (!Worklist.empty()) {
+      Function *G = Worklist.pop_back_val();
+      if (!Reached.insert(G).second)
+        continue;
+      auto It = Callees.find(G);
+      if (It != Callees.end())
+        Worklist.append(It->second.begin(), It->second.end());
+    }
+
+    // Drop the functions called from outside what is left until none is, so
+    // that the rest are only ever called on behalf of the handler.
+    SmallPtrSet<Function *, 32> Own(Reached.begin(), Reached.end());
+    bool Changed;
+    do {
+      Changed = false;
+      for (Function *G : Reached) {
+        if (G == &H || !Own.count(G))
+          continue;
+        if (G->hasAddressTaken() ||
+            any_of(Callers.lookup(G),
+                   [&](Function *Caller) { return !Own.count(Caller); })) {
+          Own.erase(G);
+          Changed = true;
+        }
+      }
+    } while (Changed);
+
+    for (Function *G : Reached)
+      if (!Own.count(G))
+        Shared.insert(G);
+  }
+}
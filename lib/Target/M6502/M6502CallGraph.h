@@ -0,0 +1,52 @@
+//===-- M6502CallGraph.h - Whole program M6502 call graph -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The calls between the functions of a module, taken to be the whole
+// program, as seen by the passes which give a function a single copy of its
+// locals: the static frame analysis and the zero page allocator.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M6502_M6502CALLGRAPH_H
+#define LLVM_LIB_TARGET_M6502_M6502CALLGRAPH_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace llvm {
+class Function;
+class Module;
+
+  /// M6502CallGraph - The functions each function defined in a module may
+  /// call.  An indirect call may reach any function whose address is taken,
+  /// and a memory intrinsic calls the library function of the same name when
+  /// it is defined here.  Functions in other modules are assumed not to call
+  /// back into this one, and interrupt handlers are never called, not even
+  /// indirectly.
+  class M6502CallGraph {
+    typedef SmallVector<Function *, 8> CalleeList;
+
+    Module &M;
+    DenseMap<Function *, CalleeList> Callees;
+
+  public:
+    explicit M6502CallGraph(Module &M);
+
+    /// Return true if F can call itself.
+    bool isRecursive(Function *F) const;
+
+    /// Add to Shared the functions an interrupt handler reaches which may
+    /// also be active in the code the handler interrupts.  Their locals
+    /// need a fresh copy for each activation.
+    void findSharedWithInterrupts(SmallPtrSetImpl<Function *> &Shared) const;
+  };
+} // end namespace llvm
+
+#endif
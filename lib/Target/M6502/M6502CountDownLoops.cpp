@@ -0,0 +1,421 @@
+//===- M6502CountDownLoops.cpp - Count loops down to zero in a byte -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Comparing the induction variable of a loop with its bound takes a load, a
+// compare and a subtract with carry for every byte, while a byte counter
+// going down to zero only needs a DEC and a BNE, as DEC sets Z.
+//
+// This pass gives the innermost loops of at most 256 iterations such a
+// counter, which replaces the exit test, when their induction variable is
+// not used for anything else.  When it only indexes arrays, and the order of
+// the iterations does not matter, the index becomes the counter less one,
+// which the abs,X addressing mode takes with the base of the array moved
+// down a byte.  The order does not matter when the arrays are distinct
+// global variables, each indexed by the induction variable only, and the
+// only values carried from one iteration to the next are integer sums,
+// products and bitwise reductions.
+//
+// The other induction variables are narrowed to a byte when their values
+// all fit in one, so that they can index an array with abs,X too.
+//
+// The pass runs before loop strength reduction, which the TTI asks to keep
+// the number of instructions down first.  M6502LoopCounters later keeps the
+// counter in X or Y where the loop leaves one of them to it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-count-down-loops"
+
+STATISTIC(NumCountDown, "Number of loops given a byte counter");
+STATISTIC(NumReversed, "Number of loops run in reverse order");
+STATISTIC(NumNarrowed, "Number of induction variables narrowed to a byte");
+
+static cl::opt<bool>
+CountDownLoops("m6502-count-down-loops", cl::Hidden, cl::init(true),
+               cl::desc("Count short loops down to zero in a byte "
+                        "(default=on)"));
+
+namespace {
+
+  class M6502CountDownLoops : public FunctionPass {
+  public:
+    static char ID;
+
+    M6502CountDownLoops() : FunctionPass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Count Down Loops";
+    }
+
+    bool runOnFunction(Function &F) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.addRequiredID(LoopSimplifyID);
+      AU.addRequired<LoopInfoWrapperPass>();
+      AU.addRequired<ScalarEvolutionWrapperPass>();
+      AU.addPreservedID(LoopSimplifyID);
+      AU.addPreserved<LoopInfoWrapperPass>();
+      AU.setPreservesCFG();
+    }
+
+  private:
+    LoopInfo *LI;
+    ScalarEvolution *SE;
+
+    bool isReversible(Loop *L, PHINode *IV, Instruction *Inc, uint64_t Last,
+                      SmallVectorImpl<Use *> &IndexUses);
+    void countDown(Loop *L, const SCEV *BackedgeTakenCount,
+                   ArrayRef<Use *> IndexUses, int64_t Start);
+    bool narrow(Loop *L, PHINode *IV, Instruction *Inc);
+    bool optimizeLoop(Loop *L);
+  };
+
+} // end anonymous namespace
+
+char M6502CountDownLoops::ID = 0;
+
+/// Return true if the header phi PN carries a reduction which gives the same
+/// result whatever the order of the iterations.
+static bool isReduction(Loop *L, PHINode *PN) {
+  auto *Op = dyn_cast<BinaryOperator>(
+      PN->getIncomingValueForBlock(L->getLoopLatch()));
+  if (!Op || !PN->getType()->isIntegerTy() || !PN->hasOneUse() ||
+      *PN->user_begin() != Op || !L->contains(Op))
+    return false;
+
+  switch (Op->getOpcode()) {
+  case Instruction::Add:
+  case Instruction::Mul:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+    break;
+  default:
+    return false;
+  }
+
+  // Only the final value may be used besides the phi.
+  for (User *U : Op->users())
+    if (U != PN && L->contains(cast<Instruction>(U)))
+      return false;
+  return true;
+}
+
+/// Return true if V, which takes values up to Last, never wraps once zero
+/// or sign extended.
+static bool fitsIn(const Value *V, uint64_t Last, bool Signed) {
+  unsigned Bits = V->getType()->getIntegerBitWidth();
+  return Bits >= 64 || Last < (UINT64_C(1) << (Signed ? Bits - 1 : Bits));
+}
+
+/// Return true if the iterations of L may run in any order.  The uses of
+/// the induction variable IV, besides its increment Inc, must all be the
+/// indices of arrays, and are returned in IndexUses.  The last value of IV is
+/// Last, which must not wrap in the indices.
+bool M6502CountDownLoops::isReversible(Loop *L, PHINode *IV, Instruction *Inc,
+                                       uint64_t Last,
+                                       SmallVectorImpl<Use *> &IndexUses) {
+  // The global variable each load and store accesses, and the type.
+  DenseMap<const Instruction *, const GlobalVariable *> Accesses;
+  DenseMap<const GlobalVariable *, Type *> AccessTypes;
+
+  SmallVector<Value *, 4> Worklist(1, IV);
+  while (!Worklist.empty()) {
+    Value *V = Worklist.pop_back_val();
+    for (Use &U : V->uses()) {
+      auto *UI = cast<Instruction>(U.getUser());
+      if (UI == Inc)
+        continue;
+      if (!L->contains(UI))
+        return false;
+      if (isa<ZExtInst>(UI) || isa<SExtInst>(UI)) {
+        if (!fitsIn(V, Last, isa<SExtInst>(UI)))
+          return false;
+        Worklist.push_back(UI);
+        continue;
+      }
+
+      // The GEP sign extends its indices.
+      auto *GEP = dyn_cast<GetElementPtrInst>(UI);
+      if (!GEP || !GEP->isInBounds() || GEP->getNumIndices() != 2 ||
+          U.getOperandNo() != 2 || !fitsIn(V, Last, /*Signed=*/true))
+        return false;
+      auto *First = dyn_cast<ConstantInt>(GEP->getOperand(1));
+      if (!First || !First->isZero())
+        return false;
+      auto *GV = dyn_cast<GlobalVariable>(
+          GEP->getPointerOperand()->stripPointerCasts());
+      if (!GV)
+        return false;
+
+      for (User *MemU : GEP->users()) {
+        Type *Ty;
+        if (auto *LI = dyn_cast<LoadInst>(MemU)) {
+          if (!LI->isSimple())
+            return false;
+          Ty = LI->getType();
+        } else if (auto *SI = dyn_cast<StoreInst>(MemU)) {
+          if (!SI->isSimple() || SI->getPointerOperand() != GEP)
+            return false;
+          Ty = SI->getValueOperand()->getType();
+        } else {
+          return false;
+        }
+        Type *&GVTy = AccessTypes[GV];
+        if (GVTy && GVTy != Ty)
+          return false;
+        GVTy = Ty;
+        Accesses[cast<Instruction>(MemU)] = GV;
+      }
+      IndexUses.push_back(&U);
+    }
+  }
+
+  // Every value carried from one iteration to the next, or used after the
+  // loop, must be a reduction.
+  SmallPtrSet<const Value *, 4> Reductions;
+  for (PHINode &PN : L->getHeader()->phis()) {
+    if (&PN == IV)
+      continue;
+    if (!isReduction(L, &PN))
+      return false;
+    Reductions.insert(PN.getIncomingValueForBlock(L->getLoopLatch()));
+  }
+
+  // Every access must be one of those.
+  for (BasicBlock *BB : L->blocks())
+    for (Instruction &I : *BB) {
+      if (I.mayReadOrWriteMemory() && !Accesses.count(&I))
+        return false;
+      if (&I == IV || &I == Inc || Reductions.count(&I))
+        continue;
+      for (User *U : I.users())
+        if (!L->contains(cast<Instruction>(U)))
+          return false;
+    }
+
+  // Two accesses to the same array with the same index may depend on each
+  // other within an iteration only.  Arrays of different global variables
+  // never overlap.
+  return true;
+}
+
+/// Give L a byte counter going down from its trip count to zero, which
+/// controls the exit branch.  The indices in IndexUses, which counted up
+/// from Start, become the counter plus Start less one.
+void M6502CountDownLoops::countDown(Loop *L, const SCEV *BackedgeTakenCount,
+                                    ArrayRef<Use *> IndexUses,
+                                    int64_t Start) {
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Latch = L->getLoopLatch();
+  BasicBlock *Preheader = L->getLoopPreheader();
+  auto *BI = cast<BranchInst>(Latch->getTerminator());
+  Type *Int8Ty = Type::getInt8Ty(Header->getContext());
+
+  // A trip count of 256 is 0, which the counter reaches after 256 DECs.
+  const SCEV *TripCount = SE->getTruncateOrZeroExtend(
+      SE->getAddExpr(BackedgeTakenCount,
+                     SE->getOne(BackedgeTakenCount->getType())),
+      Int8Ty);
+  SCEVExpander Expander(*SE, Header->getModule()->getDataLayout(),
+                        "m6502.count");
+  Value *Count = Expander.expandCodeFor(TripCount, Int8Ty,
+                                        Preheader->getTerminator());
+
+  PHINode *Counter =
+      PHINode::Create(Int8Ty, 2, "count", &*Header->getFirstInsertionPt());
+  IRBuilder<> Builder(BI);
+  Value *Next = Builder.CreateSub(Counter, ConstantInt::get(Int8Ty, 1),
+                                  "count.next");
+  Counter->addIncoming(Count, Preheader);
+  Counter->addIncoming(Next, Latch);
+
+  Value *Zero = ConstantInt::get(Int8Ty, 0);
+  auto *OldCond = cast<Instruction>(BI->getCondition());
+  BI->setCondition(BI->getSuccessor(0) == Header
+                       ? Builder.CreateICmpNE(Next, Zero)
+                       : Builder.CreateICmpEQ(Next, Zero));
+  RecursivelyDeleteTriviallyDeadInstructions(OldCond);
+
+  DenseMap<Type *, Value *> Indices;
+  Builder.SetInsertPoint(&*Header->getFirstInsertionPt());
+  for (Use *U : IndexUses) {
+    Type *Ty = U->get()->getType();
+    Value *&Index = Indices[Ty];
+    if (!Index)
+      Index = Builder.CreateAdd(Builder.CreateZExt(Counter, Ty),
+                                ConstantInt::get(Ty, Start - 1), "index");
+    Value *Old = U->get();
+    U->set(Index);
+    RecursivelyDeleteTriviallyDeadInstructions(Old);
+  }
+}
+
+/// Replace the induction variable IV, of increment Inc, by a byte one, if
+/// all its values fit.
+bool M6502CountDownLoops::narrow(Loop *L, PHINode *IV, Instruction *Inc) {
+  if (Inc->getOpcode() != Instruction::Add || Inc->getOperand(0) != IV)
+    return false;
+  auto *Step = dyn_cast<ConstantInt>(Inc->getOperand(1));
+  if (!Step || !IV->getType()->isIntegerTy() ||
+      IV->getType()->getIntegerBitWidth() <= 8 ||
+      SE->getUnsignedRange(SE->getSCEV(IV)).getUnsignedMax().ugt(255) ||
+      SE->getUnsignedRange(SE->getSCEV(Inc)).getUnsignedMax().ugt(255))
+    return false;
+
+  DEBUG(dbgs() << "Narrowing " << *IV << '\n');
+  SE->forgetLoop(L);
+
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Preheader = L->getLoopPreheader();
+  Type *Int8Ty = Type::getInt8Ty(Header->getContext());
+
+  IRBuilder<> Builder(Preheader->getTerminator());
+  Value *Start = Builder.CreateTrunc(IV->getIncomingValueForBlock(Preheader),
+                                     Int8Ty);
+  PHINode *NewIV = PHINode::Create(Int8Ty, 2, IV->getName() + ".byte", IV);
+  Builder.SetInsertPoint(Inc);
+  Value *NewInc = Builder.CreateAdd(
+      NewIV, ConstantInt::get(Int8Ty, Step->getZExtValue() & 0xff),
+      Inc->getName() + ".byte", /*HasNUW=*/!Step->isNegative());
+  NewIV->addIncoming(Start, Preheader);
+  NewIV->addIncoming(NewInc, L->getLoopLatch());
+
+  Value *IncWide = Builder.CreateZExt(NewInc, Inc->getType());
+  Inc->replaceAllUsesWith(IncWide);
+  Builder.SetInsertPoint(&*Header->getFirstInsertionPt());
+  IV->replaceAllUsesWith(Builder.CreateZExt(NewIV, IV->getType()));
+  IV->eraseFromParent();
+  Inc->eraseFromParent();
+  return true;
+}
+
+bool M6502CountDownLoops::optimizeLoop(Loop *L) {
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!L->getLoopPreheader() || !Latch || L->getExitingBlock() != Latch)
+    return false;
+  auto *BI = dyn_cast<BranchInst>(Latch->getTerminator());
+  if (!BI || !BI->isConditional())
+    return false;
+  auto *Cmp = dyn_cast<ICmpInst>(BI->getCondition());
+  if (!Cmp || !Cmp->hasOneUse())
+    return false;
+
+  // Find the induction variable of the exit test.
+  PHINode *IV = nullptr;
+  Instruction *Inc = nullptr;
+  const SCEVAddRecExpr *AR = nullptr;
+  for (PHINode &PN : Header->phis()) {
+    auto *Next = dyn_cast<Instruction>(PN.getIncomingValueForBlock(Latch));
+    if (!Next || (Cmp->getOperand(0) != &PN && Cmp->getOperand(0) != Next &&
+                  Cmp->getOperand(1) != &PN && Cmp->getOperand(1) != Next))
+      continue;
+    AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(&PN));
+    if (AR && AR->getLoop() == L && AR->isAffine()) {
+      IV = &PN;
+      Inc = Next;
+      break;
+    }
+  }
+  if (!IV)
+    return false;
+
+  bool IncUsedElsewhere = any_of(Inc->users(), [&](const User *U) {
+    return U != IV && U != Cmp;
+  });
+
+  // The guard of the loop often bounds the count better than its range.
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  const auto *MaxBTCConst =
+      dyn_cast<SCEVConstant>(SE->getMaxBackedgeTakenCount(L));
+  if (!isa<SCEVCouldNotCompute>(BTC) && MaxBTCConst &&
+      MaxBTCConst->getAPInt().ule(255) && !IncUsedElsewhere) {
+    uint64_t MaxBTC = MaxBTCConst->getAPInt().getZExtValue();
+    SmallVector<Use *, 4> IndexUses;
+    const auto *Start = dyn_cast<SCEVConstant>(AR->getStart());
+    const auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+    bool CountOnly = all_of(IV->users(), [&](const User *U) {
+      return U == Inc || U == Cmp;
+    });
+    // The counter of a loop of 256 iterations starts at 0, which cannot be
+    // turned back into an index.
+    if (CountOnly ||
+        (Start && Step && Step->getValue()->isOne() && MaxBTC < 255 &&
+         !Start->getAPInt().isNegative() &&
+         Start->getAPInt().getActiveBits() <= 16 &&
+         isReversible(L, IV, Inc,
+                      Start->getAPInt().getZExtValue() + MaxBTC,
+                      IndexUses))) {
+      DEBUG(dbgs() << "Counting down " << *L);
+      SE->forgetLoop(L);
+      countDown(L, BTC, IndexUses,
+                Start ? Start->getValue()->getSExtValue() : 0);
+      RecursivelyDeleteDeadPHINode(IV);
+      ++NumCountDown;
+      if (!IndexUses.empty())
+        ++NumReversed;
+      return true;
+    }
+  }
+
+  if (!narrow(L, IV, Inc))
+    return false;
+  ++NumNarrowed;
+  return true;
+}
+
+bool M6502CountDownLoops::runOnFunction(Function &F) {
+  if (!CountDownLoops || skipFunction(F))
+    return false;
+
+  LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+
+  SmallVector<Loop *, 8> Worklist(LI->begin(), LI->end());
+  bool Changed = false;
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.pop_back_val();
+    if (L->empty())
+      Changed |= optimizeLoop(L);
+    else
+      Worklist.append(L->begin(), L->end());
+  }
+  return Changed;
+}
+
+/// createM6502CountDownLoopsPass - Returns a pass that counts short loops
+/// down to zero in a byte.
+FunctionPass *llvm::createM6502CountDownLoopsPass() {
+  return new M6502CountDownLoops();
+}
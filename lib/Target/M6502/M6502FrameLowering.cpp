@@ -1,4 +1,4 @@
-//===-- M6502FrameLowering.cpp - M6502 Frame Information --------------------===//
+//===-- M6502FrameLowering.cpp - M6502 Frame Information ------------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -33,44 +33,38 @@ using namespace llvm;
 // Stack Frame Processing methods
 // +----------------------------+
 //
-// The stack is allocated decrementing the stack pointer on
-// the first instruction of a function prologue. Once decremented,
-// all stack references are done thought a positive offset
-// from the stack/frame pointer, so the stack is considering
-// to grow up! Otherwise terrible hacks would have to be made
-// to get this stack ABI compliant :)
+// The hardware stack of the 6502 is a single page and only holds return
+// addresses and bytes pushed with PHA/PHP.  Frames live on a software stack
+// addressed through the zero page register pair RC0, which is decremented by
+// the stack size in the function prologue.  All stack references are done
+// through a positive offset from the stack/frame pointer, which becomes the
+// Y index of a (zp),Y access.
 //
-//  The stack frame required by the ABI (after call):
+//  The stack frame (after call):
 //  Offset
 //
 //  0                 ----------
-//  4                 Args to pass
-//  .                 saved $GP  (used in PIC)
+//  .                 Args to pass
 //  .                 Alloca allocations
 //  .                 Local Area
-//  .                 CPU "Callee Saved" Registers
+//  .                 "Callee Saved" zero page registers
 //  .                 saved FP
-//  .                 saved RA
-//  .                 FPU "Callee Saved" Registers
 //  StackSize         -----------
 //
 // Offset - offset from sp after stack allocation on function prologue
 //
-// The sp is the stack pointer subtracted/added from the stack size
-// at the Prologue/Epilogue
-//
 // References to the previous stack (to obtain arguments) are done
-// with offsets that exceeds the stack size: (stacksize+(4*(num_arg-1))
+// with offsets that exceeds the stack size: (stacksize+arg_offset)
 //
 // Examples:
 // - reference to the actual stack frame
 //   for any local area var there is smt like : FI >= 0, StackOffset: 4
-//     sw REGX, 4(SP)
+//     ldy #4 ; lda (sp),y
 //
 // - reference to previous stack frame
-//   suppose there's a load to the 5th arguments : FI < 0, StackOffset: 16.
+//   suppose there's a load of a stack argument : FI < 0, StackOffset: 2.
 //   The emitted instruction will be something like:
-//     lw REGX, 16+StackSize(SP)
+//     ldy #2+StackSize ; lda (sp),y
 //
 // Since the total stack size is unknown on LowerFormalArguments, all
 // stack references (ObjectOffset) created to reference the function
@@ -81,9 +75,6 @@ using namespace llvm;
 //===----------------------------------------------------------------------===//
 
 const M6502FrameLowering *M6502FrameLowering::create(const M6502Subtarget &ST) {
-  if (ST.inM650216Mode())
-    return llvm::createM650216FrameLowering(ST);
-
   return llvm::createM6502SEFrameLowering(ST);
 }
 
@@ -123,11 +114,10 @@ uint64_t M6502FrameLowering::estimateStackSize(const MachineFunction &MF) const
     if (MFI.getObjectOffset(I) > 0)
       Size += MFI.getObjectSize(I);
 
-  // Conservatively assume all callee-saved registers will be saved.
-  for (const MCPhysReg *R = TRI.getCalleeSavedRegs(&MF); *R; ++R) {
-    unsigned RegSize = TRI.getSpillSize(*TRI.getMinimalPhysRegClass(*R));
-    Size = alignTo(Size + RegSize, RegSize);
-  }
+  // Conservatively assume all callee-saved registers will be saved.  Spill
+  // slots are byte aligned.
+  for (const MCPhysReg *R = TRI.getCalleeSavedRegs(&MF); *R; ++R)
+    Size += TRI.getSpillSize(*TRI.getMinimalPhysRegClass(*R));
 
   // Get the size of the rest of the frame objects and any possible reserved
   // call frame, accounting for alignment.
@@ -138,7 +128,7 @@ uint64_t M6502FrameLowering::estimateStackSize(const MachineFunction &MF) const
 MachineBasicBlock::iterator M6502FrameLowering::
 eliminateCallFramePseudoInstr(MachineFunction &MF, MachineBasicBlock &MBB,
                               MachineBasicBlock::iterator I) const {
-  unsigned SP = STI.getABI().IsN64() ? M6502::SP_64 : M6502::SP;
+  unsigned SP = STI.getABI().GetStackPtr();
 
   if (!hasReservedCallFrame(MF)) {
     int64_t Amount = I->getOperand(0).getImm();
@@ -1,4 +1,4 @@
-//===-- M6502FrameLowering.h - Define frame lowering for M6502 ----*- C++ -*-===//
+//===-- M6502FrameLowering.h - Define frame lowering for M6502 --*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -46,7 +46,6 @@ protected:
 };
 
 /// Create M6502FrameLowering objects.
-const M6502FrameLowering *createM650216FrameLowering(const M6502Subtarget &ST);
 const M6502FrameLowering *createM6502SEFrameLowering(const M6502Subtarget &ST);
 
 } // End llvm namespace
@@ -1,4 +1,4 @@
-//===---- M6502ISelDAGToDAG.h - A Dag to Dag Inst Selector for M6502 --------===//
+//===---- M6502ISelDAGToDAG.h - A Dag to Dag Inst Selector for M6502 ------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -42,8 +42,6 @@ public:
   bool runOnMachineFunction(MachineFunction &MF) override;
 
 protected:
-  SDNode *getGlobalBaseReg();
-
   /// Keep a pointer to the M6502Subtarget around so that we can make the right
   /// decision when generating code for different targets.
   const M6502Subtarget *Subtarget;
@@ -53,76 +51,24 @@ private:
   #include "M6502GenDAGISel.inc"
 
   // Complex Pattern.
-  /// (reg + imm).
+  /// (reg + uimm8), the base of an (zp),Y access.
   virtual bool selectAddrRegImm(SDValue Addr, SDValue &Base,
                                 SDValue &Offset) const;
 
-  /// Fall back on this function if all else fails.
-  virtual bool selectAddrDefault(SDValue Addr, SDValue &Base,
-                                 SDValue &Offset) const;
-
-  /// Match integer address pattern.
-  virtual bool selectIntAddr(SDValue Addr, SDValue &Base,
-                             SDValue &Offset) const;
-
-  virtual bool selectIntAddr11MM(SDValue Addr, SDValue &Base,
-                                 SDValue &Offset) const;
-
-  virtual bool selectIntAddr12MM(SDValue Addr, SDValue &Base,
-                               SDValue &Offset) const;
-
-  virtual bool selectIntAddr16MM(SDValue Addr, SDValue &Base,
-                                 SDValue &Offset) const;
-
-  virtual bool selectIntAddrLSL2MM(SDValue Addr, SDValue &Base,
-                                   SDValue &Offset) const;
-
-  /// Match addr+simm10 and addr
-  virtual bool selectIntAddrSImm10(SDValue Addr, SDValue &Base,
-                                   SDValue &Offset) const;
-
-  virtual bool selectIntAddrSImm10Lsl1(SDValue Addr, SDValue &Base,
-                                       SDValue &Offset) const;
-
-  virtual bool selectIntAddrSImm10Lsl2(SDValue Addr, SDValue &Base,
-                                       SDValue &Offset) const;
-
-  virtual bool selectIntAddrSImm10Lsl3(SDValue Addr, SDValue &Base,
-                                       SDValue &Offset) const;
-
-  virtual bool selectAddr16(SDValue Addr, SDValue &Base, SDValue &Offset);
-  virtual bool selectAddr16SP(SDValue Addr, SDValue &Base, SDValue &Offset);
-
-  /// \brief Select constant vector splats.
-  virtual bool selectVSplat(SDNode *N, APInt &Imm,
-                            unsigned MinSizeInBits) const;
-  /// \brief Select constant vector splats whose value fits in a uimm1.
-  virtual bool selectVSplatUimm1(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value fits in a uimm2.
-  virtual bool selectVSplatUimm2(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value fits in a uimm3.
-  virtual bool selectVSplatUimm3(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value fits in a uimm4.
-  virtual bool selectVSplatUimm4(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value fits in a uimm5.
-  virtual bool selectVSplatUimm5(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value fits in a uimm6.
-  virtual bool selectVSplatUimm6(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value fits in a uimm8.
-  virtual bool selectVSplatUimm8(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value fits in a simm5.
-  virtual bool selectVSplatSimm5(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value is a power of 2.
-  virtual bool selectVSplatUimmPow2(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value is the inverse of a
-  /// power of 2.
-  virtual bool selectVSplatUimmInvPow2(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value is a run of set bits
-  /// ending at the most significant bit
-  virtual bool selectVSplatMaskL(SDValue N, SDValue &Imm) const;
-  /// \brief Select constant vector splats whose value is a run of set bits
-  /// starting at bit zero.
-  virtual bool selectVSplatMaskR(SDValue N, SDValue &Imm) const;
+  /// (frameindex + uimm8).
+  virtual bool selectAddrFrameIndex(SDValue Addr, SDValue &Base,
+                                    SDValue &Offset) const;
+
+  /// Match an address known at link time.
+  virtual bool selectAddrAbs(SDValue Addr, SDValue &Base) const;
+
+  /// Match an address known at link time plus an unsigned byte index.
+  virtual bool selectAddrAbsIdx(SDValue Addr, SDValue &Base,
+                                SDValue &Index) const;
+
+  /// Match a base address plus an unsigned byte index.
+  virtual bool selectAddrRegIdx(SDValue Addr, SDValue &Base,
+                                SDValue &Index) const;
 
   void Select(SDNode *N) override;
 
@@ -133,8 +79,6 @@ private:
     return CurDAG->getTargetConstant(Imm, SDLoc(Node), Node->getValueType(0));
   }
 
-  virtual void processFunctionAfterISel(MachineFunction &MF) = 0;
-
   bool SelectInlineAsmMemoryOperand(const SDValue &Op,
                                     unsigned ConstraintID,
                                     std::vector<SDValue> &OutOps) override;
@@ -1,4 +1,4 @@
-//===- M6502ISelLowering.cpp - M6502 DAG Lowering Implementation ------------===//
+//===- M6502ISelLowering.cpp - M6502 DAG Lowering Implementation ----------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -13,24 +13,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "M6502ISelLowering.h"
-#include "InstPrinter/M6502InstPrinter.h"
 #include "MCTargetDesc/M6502BaseInfo.h"
 #include "MCTargetDesc/M6502MCTargetDesc.h"
-#include "M6502CCState.h"
 #include "M6502InstrInfo.h"
 #include "M6502MachineFunction.h"
 #include "M6502RegisterInfo.h"
 #include "M6502Subtarget.h"
 #include "M6502TargetMachine.h"
-#include "M6502TargetObjectFile.h"
-#include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
-#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/CodeGen/CallingConvLower.h"
-#include "llvm/CodeGen/FunctionLoweringInfo.h"
 #include "llvm/CodeGen/ISDOpcodes.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
@@ -39,40 +35,27 @@
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/MachineMemOperand.h"
-#include "llvm/CodeGen/MachineOperand.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/MachineValueType.h"
 #include "llvm/CodeGen/RuntimeLibcalls.h"
 #include "llvm/CodeGen/SelectionDAG.h"
 #include "llvm/CodeGen/SelectionDAGNodes.h"
-#include "llvm/CodeGen/TargetFrameLowering.h"
 #include "llvm/CodeGen/TargetInstrInfo.h"
 #include "llvm/CodeGen/ValueTypes.h"
 #include "llvm/IR/CallingConv.h"
-#include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DebugLoc.h"
-#include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalValue.h"
-#include "llvm/IR/Type.h"
-#include "llvm/IR/Value.h"
-#include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/Support/Casting.h"
-#include "llvm/Support/CodeGen.h"
-#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Target/TargetMachine.h"
-#include "llvm/Target/TargetOptions.h"
 #include "llvm/Target/TargetRegisterInfo.h"
-#include <algorithm>
 #include <cassert>
-#include <cctype>
 #include <cstdint>
 #include <deque>
-#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -80,84 +63,11 @@ using namespace llvm;
 
 #define DEBUG_TYPE "m6502-lower"
 
-STATISTIC(NumTailCalls, "Number of tail calls");
-
-static cl::opt<bool>
-LargeGOT("m6502-mxgot", cl::Hidden,
-         cl::desc("M6502: Enable GOT larger than 64k."), cl::init(false));
-
-static cl::opt<bool>
-NoZeroDivCheck("m6502-mno-check-zero-division", cl::Hidden,
-               cl::desc("M6502: Don't trap on integer division by zero."),
-               cl::init(false));
-
-static const MCPhysReg M650264DPRegs[8] = {
-  M6502::D12_64, M6502::D13_64, M6502::D14_64, M6502::D15_64,
-  M6502::D16_64, M6502::D17_64, M6502::D18_64, M6502::D19_64
-};
-
-// If I is a shifted mask, set the size (Size) and the first bit of the
-// mask (Pos), and return true.
-// For example, if I is 0x003ff800, (Pos, Size) = (11, 11).
-static bool isShiftedMask(uint64_t I, uint64_t &Pos, uint64_t &Size) {
-  if (!isShiftedMask_64(I))
-    return false;
-
-  Size = countPopulation(I);
-  Pos = countTrailingZeros(I);
-  return true;
-}
-
-// The M6502 MSA ABI passes vector arguments in the integer register set.
-// The number of integer registers used is dependant on the ABI used.
-MVT M6502TargetLowering::getRegisterTypeForCallingConv(MVT VT) const {
-  if (VT.isVector() && Subtarget.hasMSA())
-    return Subtarget.isABI_O32() ? MVT::i32 : MVT::i64;
-  return M6502TargetLowering::getRegisterType(VT);
-}
-
-MVT M6502TargetLowering::getRegisterTypeForCallingConv(LLVMContext &Context,
-                                                      EVT VT) const {
-  if (VT.isVector()) {
-      if (Subtarget.isABI_O32()) {
-        return MVT::i32;
-      } else {
-        return (VT.getSizeInBits() == 32) ? MVT::i32 : MVT::i64;
-      }
-  }
-  return M6502TargetLowering::getRegisterType(Context, VT);
-}
-
-unsigned M6502TargetLowering::getNumRegistersForCallingConv(LLVMContext &Context,
-                                                           EVT VT) const {
-  if (VT.isVector())
-    return std::max((VT.getSizeInBits() / (Subtarget.isABI_O32() ? 32 : 64)),
-                    1U);
-  return M6502TargetLowering::getNumRegisters(Context, VT);
-}
-
-unsigned M6502TargetLowering::getVectorTypeBreakdownForCallingConv(
-    LLVMContext &Context, EVT VT, EVT &IntermediateVT,
-    unsigned &NumIntermediates, MVT &RegisterVT) const {
-  // Break down vector types to either 2 i64s or 4 i32s.
-  RegisterVT = getRegisterTypeForCallingConv(Context, VT) ;
-  IntermediateVT = RegisterVT;
-  NumIntermediates = VT.getSizeInBits() < RegisterVT.getSizeInBits()
-                         ? VT.getVectorNumElements()
-                         : VT.getSizeInBits() / RegisterVT.getSizeInBits();
-
-  return NumIntermediates;
-}
-
-SDValue M6502TargetLowering::getGlobalReg(SelectionDAG &DAG, EVT Ty) const {
-  M6502FunctionInfo *FI = DAG.getMachineFunction().getInfo<M6502FunctionInfo>();
-  return DAG.getRegister(FI->getGlobalBaseReg(), Ty);
-}
-
 SDValue M6502TargetLowering::getTargetNode(GlobalAddressSDNode *N, EVT Ty,
                                           SelectionDAG &DAG,
                                           unsigned Flag) const {
-  return DAG.getTargetGlobalAddress(N->getGlobal(), SDLoc(N), Ty, 0, Flag);
+  return DAG.getTargetGlobalAddress(N->getGlobal(), SDLoc(N), Ty,
+                                    N->getOffset(), Flag);
 }
 
 SDValue M6502TargetLowering::getTargetNode(ExternalSymbolSDNode *N, EVT Ty,
@@ -189,119 +99,13 @@ const char *M6502TargetLowering::getTargetNodeName(unsigned Opcode) const {
   switch ((M6502ISD::NodeType)Opcode) {
   case M6502ISD::FIRST_NUMBER:      break;
   case M6502ISD::JmpLink:           return "M6502ISD::JmpLink";
-  case M6502ISD::TailCall:          return "M6502ISD::TailCall";
-  case M6502ISD::Highest:           return "M6502ISD::Highest";
-  case M6502ISD::Higher:            return "M6502ISD::Higher";
-  case M6502ISD::Hi:                return "M6502ISD::Hi";
-  case M6502ISD::Lo:                return "M6502ISD::Lo";
-  case M6502ISD::GotHi:             return "M6502ISD::GotHi";
-  case M6502ISD::GPRel:             return "M6502ISD::GPRel";
-  case M6502ISD::ThreadPointer:     return "M6502ISD::ThreadPointer";
   case M6502ISD::Ret:               return "M6502ISD::Ret";
-  case M6502ISD::ERet:              return "M6502ISD::ERet";
-  case M6502ISD::EH_RETURN:         return "M6502ISD::EH_RETURN";
-  case M6502ISD::FPBrcond:          return "M6502ISD::FPBrcond";
-  case M6502ISD::FPCmp:             return "M6502ISD::FPCmp";
-  case M6502ISD::FSELECT:           return "M6502ISD::FSELECT";
-  case M6502ISD::MTC1_D64:          return "M6502ISD::MTC1_D64";
-  case M6502ISD::CMovFP_T:          return "M6502ISD::CMovFP_T";
-  case M6502ISD::CMovFP_F:          return "M6502ISD::CMovFP_F";
-  case M6502ISD::TruncIntFP:        return "M6502ISD::TruncIntFP";
-  case M6502ISD::MFHI:              return "M6502ISD::MFHI";
-  case M6502ISD::MFLO:              return "M6502ISD::MFLO";
-  case M6502ISD::MTLOHI:            return "M6502ISD::MTLOHI";
-  case M6502ISD::Mult:              return "M6502ISD::Mult";
-  case M6502ISD::Multu:             return "M6502ISD::Multu";
-  case M6502ISD::MAdd:              return "M6502ISD::MAdd";
-  case M6502ISD::MAddu:             return "M6502ISD::MAddu";
-  case M6502ISD::MSub:              return "M6502ISD::MSub";
-  case M6502ISD::MSubu:             return "M6502ISD::MSubu";
-  case M6502ISD::DivRem:            return "M6502ISD::DivRem";
-  case M6502ISD::DivRemU:           return "M6502ISD::DivRemU";
-  case M6502ISD::DivRem16:          return "M6502ISD::DivRem16";
-  case M6502ISD::DivRemU16:         return "M6502ISD::DivRemU16";
-  case M6502ISD::BuildPairF64:      return "M6502ISD::BuildPairF64";
-  case M6502ISD::ExtractElementF64: return "M6502ISD::ExtractElementF64";
+  case M6502ISD::IRet:              return "M6502ISD::IRet";
   case M6502ISD::Wrapper:           return "M6502ISD::Wrapper";
-  case M6502ISD::DynAlloc:          return "M6502ISD::DynAlloc";
-  case M6502ISD::Sync:              return "M6502ISD::Sync";
-  case M6502ISD::Ext:               return "M6502ISD::Ext";
-  case M6502ISD::Ins:               return "M6502ISD::Ins";
-  case M6502ISD::CIns:              return "M6502ISD::CIns";
-  case M6502ISD::LWL:               return "M6502ISD::LWL";
-  case M6502ISD::LWR:               return "M6502ISD::LWR";
-  case M6502ISD::SWL:               return "M6502ISD::SWL";
-  case M6502ISD::SWR:               return "M6502ISD::SWR";
-  case M6502ISD::LDL:               return "M6502ISD::LDL";
-  case M6502ISD::LDR:               return "M6502ISD::LDR";
-  case M6502ISD::SDL:               return "M6502ISD::SDL";
-  case M6502ISD::SDR:               return "M6502ISD::SDR";
-  case M6502ISD::EXTP:              return "M6502ISD::EXTP";
-  case M6502ISD::EXTPDP:            return "M6502ISD::EXTPDP";
-  case M6502ISD::EXTR_S_H:          return "M6502ISD::EXTR_S_H";
-  case M6502ISD::EXTR_W:            return "M6502ISD::EXTR_W";
-  case M6502ISD::EXTR_R_W:          return "M6502ISD::EXTR_R_W";
-  case M6502ISD::EXTR_RS_W:         return "M6502ISD::EXTR_RS_W";
-  case M6502ISD::SHILO:             return "M6502ISD::SHILO";
-  case M6502ISD::MTHLIP:            return "M6502ISD::MTHLIP";
-  case M6502ISD::MULSAQ_S_W_PH:     return "M6502ISD::MULSAQ_S_W_PH";
-  case M6502ISD::MAQ_S_W_PHL:       return "M6502ISD::MAQ_S_W_PHL";
-  case M6502ISD::MAQ_S_W_PHR:       return "M6502ISD::MAQ_S_W_PHR";
-  case M6502ISD::MAQ_SA_W_PHL:      return "M6502ISD::MAQ_SA_W_PHL";
-  case M6502ISD::MAQ_SA_W_PHR:      return "M6502ISD::MAQ_SA_W_PHR";
-  case M6502ISD::DPAU_H_QBL:        return "M6502ISD::DPAU_H_QBL";
-  case M6502ISD::DPAU_H_QBR:        return "M6502ISD::DPAU_H_QBR";
-  case M6502ISD::DPSU_H_QBL:        return "M6502ISD::DPSU_H_QBL";
-  case M6502ISD::DPSU_H_QBR:        return "M6502ISD::DPSU_H_QBR";
-  case M6502ISD::DPAQ_S_W_PH:       return "M6502ISD::DPAQ_S_W_PH";
-  case M6502ISD::DPSQ_S_W_PH:       return "M6502ISD::DPSQ_S_W_PH";
-  case M6502ISD::DPAQ_SA_L_W:       return "M6502ISD::DPAQ_SA_L_W";
-  case M6502ISD::DPSQ_SA_L_W:       return "M6502ISD::DPSQ_SA_L_W";
-  case M6502ISD::DPA_W_PH:          return "M6502ISD::DPA_W_PH";
-  case M6502ISD::DPS_W_PH:          return "M6502ISD::DPS_W_PH";
-  case M6502ISD::DPAQX_S_W_PH:      return "M6502ISD::DPAQX_S_W_PH";
-  case M6502ISD::DPAQX_SA_W_PH:     return "M6502ISD::DPAQX_SA_W_PH";
-  case M6502ISD::DPAX_W_PH:         return "M6502ISD::DPAX_W_PH";
-  case M6502ISD::DPSX_W_PH:         return "M6502ISD::DPSX_W_PH";
-  case M6502ISD::DPSQX_S_W_PH:      return "M6502ISD::DPSQX_S_W_PH";
-  case M6502ISD::DPSQX_SA_W_PH:     return "M6502ISD::DPSQX_SA_W_PH";
-  case M6502ISD::MULSA_W_PH:        return "M6502ISD::MULSA_W_PH";
-  case M6502ISD::MULT:              return "M6502ISD::MULT";
-  case M6502ISD::MULTU:             return "M6502ISD::MULTU";
-  case M6502ISD::MADD_DSP:          return "M6502ISD::MADD_DSP";
-  case M6502ISD::MADDU_DSP:         return "M6502ISD::MADDU_DSP";
-  case M6502ISD::MSUB_DSP:          return "M6502ISD::MSUB_DSP";
-  case M6502ISD::MSUBU_DSP:         return "M6502ISD::MSUBU_DSP";
-  case M6502ISD::SHLL_DSP:          return "M6502ISD::SHLL_DSP";
-  case M6502ISD::SHRA_DSP:          return "M6502ISD::SHRA_DSP";
-  case M6502ISD::SHRL_DSP:          return "M6502ISD::SHRL_DSP";
-  case M6502ISD::SETCC_DSP:         return "M6502ISD::SETCC_DSP";
-  case M6502ISD::SELECT_CC_DSP:     return "M6502ISD::SELECT_CC_DSP";
-  case M6502ISD::VALL_ZERO:         return "M6502ISD::VALL_ZERO";
-  case M6502ISD::VANY_ZERO:         return "M6502ISD::VANY_ZERO";
-  case M6502ISD::VALL_NONZERO:      return "M6502ISD::VALL_NONZERO";
-  case M6502ISD::VANY_NONZERO:      return "M6502ISD::VANY_NONZERO";
-  case M6502ISD::VCEQ:              return "M6502ISD::VCEQ";
-  case M6502ISD::VCLE_S:            return "M6502ISD::VCLE_S";
-  case M6502ISD::VCLE_U:            return "M6502ISD::VCLE_U";
-  case M6502ISD::VCLT_S:            return "M6502ISD::VCLT_S";
-  case M6502ISD::VCLT_U:            return "M6502ISD::VCLT_U";
-  case M6502ISD::VSMAX:             return "M6502ISD::VSMAX";
-  case M6502ISD::VSMIN:             return "M6502ISD::VSMIN";
-  case M6502ISD::VUMAX:             return "M6502ISD::VUMAX";
-  case M6502ISD::VUMIN:             return "M6502ISD::VUMIN";
-  case M6502ISD::VEXTRACT_SEXT_ELT: return "M6502ISD::VEXTRACT_SEXT_ELT";
-  case M6502ISD::VEXTRACT_ZEXT_ELT: return "M6502ISD::VEXTRACT_ZEXT_ELT";
-  case M6502ISD::VNOR:              return "M6502ISD::VNOR";
-  case M6502ISD::VSHF:              return "M6502ISD::VSHF";
-  case M6502ISD::SHF:               return "M6502ISD::SHF";
-  case M6502ISD::ILVEV:             return "M6502ISD::ILVEV";
-  case M6502ISD::ILVOD:             return "M6502ISD::ILVOD";
-  case M6502ISD::ILVL:              return "M6502ISD::ILVL";
-  case M6502ISD::ILVR:              return "M6502ISD::ILVR";
-  case M6502ISD::PCKEV:             return "M6502ISD::PCKEV";
-  case M6502ISD::PCKOD:             return "M6502ISD::PCKOD";
-  case M6502ISD::INSVE:             return "M6502ISD::INSVE";
+  case M6502ISD::BrCC:              return "M6502ISD::BrCC";
+  case M6502ISD::SelectCC:          return "M6502ISD::SelectCC";
+  case M6502ISD::MemCpy:            return "M6502ISD::MemCpy";
+  case M6502ISD::MemSet:            return "M6502ISD::MemSet";
   }
   return nullptr;
 }
@@ -309,15 +113,8 @@ const char *M6502TargetLowering::getTargetNodeName(unsigned Opcode) const {
 M6502TargetLowering::M6502TargetLowering(const M6502TargetMachine &TM,
                                        const M6502Subtarget &STI)
     : TargetLowering(TM), Subtarget(STI), ABI(TM.getABI()) {
-  // M6502 does not have i1 type, so use i32 for
-  // setcc operations results (slt, sgt, ...).
+  // Comparisons produce 0 or 1 in a byte register.
   setBooleanContents(ZeroOrOneBooleanContent);
-  setBooleanVectorContents(ZeroOrNegativeOneBooleanContent);
-  // The cmp.cond.fmt instruction in M650232r6/M650264r6 uses 0 and -1 like MSA
-  // does. Integer booleans still use 0 and 1.
-  if (Subtarget.hasM650232r6())
-    setBooleanContents(ZeroOrOneBooleanContent,
-                       ZeroOrNegativeOneBooleanContent);
 
   // Load extented operations for i1 types must be promoted
   for (MVT VT : MVT::integer_valuetypes()) {
@@ -326,925 +123,411 @@ M6502TargetLowering::M6502TargetLowering(const M6502TargetMachine &TM,
     setLoadExtAction(ISD::SEXTLOAD, VT, MVT::i1,  Promote);
   }
 
-  // M6502 doesn't have extending float->double load/store.  Set LoadExtAction
-  // for f32, f16
-  for (MVT VT : MVT::fp_valuetypes()) {
-    setLoadExtAction(ISD::EXTLOAD, VT, MVT::f32, Expand);
-    setLoadExtAction(ISD::EXTLOAD, VT, MVT::f16, Expand);
-  }
-
-  // Set LoadExtAction for f16 vectors to Expand
-  for (MVT VT : MVT::fp_vector_valuetypes()) {
-    MVT F16VT = MVT::getVectorVT(MVT::f16, VT.getVectorNumElements());
-    if (F16VT.isValid())
-      setLoadExtAction(ISD::EXTLOAD, VT, F16VT, Expand);
-  }
-
-  setTruncStoreAction(MVT::f32, MVT::f16, Expand);
-  setTruncStoreAction(MVT::f64, MVT::f16, Expand);
-
-  setTruncStoreAction(MVT::f64, MVT::f32, Expand);
-
-  // Used by legalize types to correctly generate the setcc result.
-  // Without this, every float setcc comes with a AND/OR with the result,
-  // we don't want this, since the fpcmp result goes to a flag register,
-  // which is used implicitly by brcond and select operations.
-  AddPromotedToType(ISD::SETCC, MVT::i1, MVT::i32);
-
-  // M6502 Custom Operations
-  setOperationAction(ISD::BR_JT,              MVT::Other, Expand);
-  setOperationAction(ISD::GlobalAddress,      MVT::i32,   Custom);
-  setOperationAction(ISD::BlockAddress,       MVT::i32,   Custom);
-  setOperationAction(ISD::GlobalTLSAddress,   MVT::i32,   Custom);
-  setOperationAction(ISD::JumpTable,          MVT::i32,   Custom);
-  setOperationAction(ISD::ConstantPool,       MVT::i32,   Custom);
-  setOperationAction(ISD::SELECT,             MVT::f32,   Custom);
-  setOperationAction(ISD::SELECT,             MVT::f64,   Custom);
-  setOperationAction(ISD::SELECT,             MVT::i32,   Custom);
-  setOperationAction(ISD::SETCC,              MVT::f32,   Custom);
-  setOperationAction(ISD::SETCC,              MVT::f64,   Custom);
-  setOperationAction(ISD::BRCOND,             MVT::Other, Custom);
-  setOperationAction(ISD::FCOPYSIGN,          MVT::f32,   Custom);
-  setOperationAction(ISD::FCOPYSIGN,          MVT::f64,   Custom);
-  setOperationAction(ISD::FP_TO_SINT,         MVT::i32,   Custom);
-
-  if (Subtarget.isGP64bit()) {
-    setOperationAction(ISD::GlobalAddress,      MVT::i64,   Custom);
-    setOperationAction(ISD::BlockAddress,       MVT::i64,   Custom);
-    setOperationAction(ISD::GlobalTLSAddress,   MVT::i64,   Custom);
-    setOperationAction(ISD::JumpTable,          MVT::i64,   Custom);
-    setOperationAction(ISD::ConstantPool,       MVT::i64,   Custom);
-    setOperationAction(ISD::SELECT,             MVT::i64,   Custom);
-    setOperationAction(ISD::LOAD,               MVT::i64,   Custom);
-    setOperationAction(ISD::STORE,              MVT::i64,   Custom);
-    setOperationAction(ISD::FP_TO_SINT,         MVT::i64,   Custom);
-    setOperationAction(ISD::SHL_PARTS,          MVT::i64,   Custom);
-    setOperationAction(ISD::SRA_PARTS,          MVT::i64,   Custom);
-    setOperationAction(ISD::SRL_PARTS,          MVT::i64,   Custom);
-  }
-
-  if (!Subtarget.isGP64bit()) {
-    setOperationAction(ISD::SHL_PARTS,          MVT::i32,   Custom);
-    setOperationAction(ISD::SRA_PARTS,          MVT::i32,   Custom);
-    setOperationAction(ISD::SRL_PARTS,          MVT::i32,   Custom);
-  }
-
-  setOperationAction(ISD::EH_DWARF_CFA,         MVT::i32,   Custom);
-  if (Subtarget.isGP64bit())
-    setOperationAction(ISD::EH_DWARF_CFA,       MVT::i64,   Custom);
-
-  setOperationAction(ISD::SDIV, MVT::i32, Expand);
-  setOperationAction(ISD::SREM, MVT::i32, Expand);
-  setOperationAction(ISD::UDIV, MVT::i32, Expand);
-  setOperationAction(ISD::UREM, MVT::i32, Expand);
-  setOperationAction(ISD::SDIV, MVT::i64, Expand);
-  setOperationAction(ISD::SREM, MVT::i64, Expand);
-  setOperationAction(ISD::UDIV, MVT::i64, Expand);
-  setOperationAction(ISD::UREM, MVT::i64, Expand);
-
-  if (!(Subtarget.hasDSP() && Subtarget.hasM650232r2())) {
-    setOperationAction(ISD::ADDC, MVT::i32, Expand);
-    setOperationAction(ISD::ADDE, MVT::i32, Expand);
-  }
-
-  setOperationAction(ISD::ADDC, MVT::i64, Expand);
-  setOperationAction(ISD::ADDE, MVT::i64, Expand);
-  setOperationAction(ISD::SUBC, MVT::i32, Expand);
-  setOperationAction(ISD::SUBE, MVT::i32, Expand);
-  setOperationAction(ISD::SUBC, MVT::i64, Expand);
-  setOperationAction(ISD::SUBE, MVT::i64, Expand);
-
-  // Operations not directly supported by M6502.
-  setOperationAction(ISD::BR_CC,             MVT::f32,   Expand);
-  setOperationAction(ISD::BR_CC,             MVT::f64,   Expand);
-  setOperationAction(ISD::BR_CC,             MVT::i32,   Expand);
-  setOperationAction(ISD::BR_CC,             MVT::i64,   Expand);
-  setOperationAction(ISD::SELECT_CC,         MVT::i32,   Expand);
-  setOperationAction(ISD::SELECT_CC,         MVT::i64,   Expand);
-  setOperationAction(ISD::SELECT_CC,         MVT::f32,   Expand);
-  setOperationAction(ISD::SELECT_CC,         MVT::f64,   Expand);
-  setOperationAction(ISD::UINT_TO_FP,        MVT::i32,   Expand);
-  setOperationAction(ISD::UINT_TO_FP,        MVT::i64,   Expand);
-  setOperationAction(ISD::FP_TO_UINT,        MVT::i32,   Expand);
-  setOperationAction(ISD::FP_TO_UINT,        MVT::i64,   Expand);
-  setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i1,    Expand);
-  if (Subtarget.hasCnM6502()) {
-    setOperationAction(ISD::CTPOP,           MVT::i32,   Legal);
-    setOperationAction(ISD::CTPOP,           MVT::i64,   Legal);
-  } else {
-    setOperationAction(ISD::CTPOP,           MVT::i32,   Expand);
-    setOperationAction(ISD::CTPOP,           MVT::i64,   Expand);
-  }
-  setOperationAction(ISD::CTTZ,              MVT::i32,   Expand);
-  setOperationAction(ISD::CTTZ,              MVT::i64,   Expand);
-  setOperationAction(ISD::ROTL,              MVT::i32,   Expand);
-  setOperationAction(ISD::ROTL,              MVT::i64,   Expand);
-  setOperationAction(ISD::DYNAMIC_STACKALLOC, MVT::i32,  Expand);
-  setOperationAction(ISD::DYNAMIC_STACKALLOC, MVT::i64,  Expand);
-
-  if (!Subtarget.hasM650232r2())
-    setOperationAction(ISD::ROTR, MVT::i32,   Expand);
-
-  if (!Subtarget.hasM650264r2())
-    setOperationAction(ISD::ROTR, MVT::i64,   Expand);
-
-  setOperationAction(ISD::FSIN,              MVT::f32,   Expand);
-  setOperationAction(ISD::FSIN,              MVT::f64,   Expand);
-  setOperationAction(ISD::FCOS,              MVT::f32,   Expand);
-  setOperationAction(ISD::FCOS,              MVT::f64,   Expand);
-  setOperationAction(ISD::FSINCOS,           MVT::f32,   Expand);
-  setOperationAction(ISD::FSINCOS,           MVT::f64,   Expand);
-  setOperationAction(ISD::FPOW,              MVT::f32,   Expand);
-  setOperationAction(ISD::FPOW,              MVT::f64,   Expand);
-  setOperationAction(ISD::FLOG,              MVT::f32,   Expand);
-  setOperationAction(ISD::FLOG2,             MVT::f32,   Expand);
-  setOperationAction(ISD::FLOG10,            MVT::f32,   Expand);
-  setOperationAction(ISD::FEXP,              MVT::f32,   Expand);
-  setOperationAction(ISD::FMA,               MVT::f32,   Expand);
-  setOperationAction(ISD::FMA,               MVT::f64,   Expand);
-  setOperationAction(ISD::FREM,              MVT::f32,   Expand);
-  setOperationAction(ISD::FREM,              MVT::f64,   Expand);
-
-  // Lower f16 conversion operations into library calls
-  setOperationAction(ISD::FP16_TO_FP,        MVT::f32,   Expand);
-  setOperationAction(ISD::FP_TO_FP16,        MVT::f32,   Expand);
-  setOperationAction(ISD::FP16_TO_FP,        MVT::f64,   Expand);
-  setOperationAction(ISD::FP_TO_FP16,        MVT::f64,   Expand);
-
-  setOperationAction(ISD::EH_RETURN, MVT::Other, Custom);
-
-  setOperationAction(ISD::VASTART,           MVT::Other, Custom);
-  setOperationAction(ISD::VAARG,             MVT::Other, Custom);
-  setOperationAction(ISD::VACOPY,            MVT::Other, Expand);
-  setOperationAction(ISD::VAEND,             MVT::Other, Expand);
-
-  // Use the default for now
-  setOperationAction(ISD::STACKSAVE,         MVT::Other, Expand);
-  setOperationAction(ISD::STACKRESTORE,      MVT::Other, Expand);
-
-  if (!Subtarget.isGP64bit()) {
-    setOperationAction(ISD::ATOMIC_LOAD,     MVT::i64,   Expand);
-    setOperationAction(ISD::ATOMIC_STORE,    MVT::i64,   Expand);
-  }
-
-  if (!Subtarget.hasM650232r2()) {
-    setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i8,  Expand);
-    setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i16, Expand);
-  }
-
-  // M650216 lacks M650232's clz and clo instructions.
-  if (!Subtarget.hasM650232() || Subtarget.inM650216Mode())
-    setOperationAction(ISD::CTLZ, MVT::i32, Expand);
-  if (!Subtarget.hasM650264())
-    setOperationAction(ISD::CTLZ, MVT::i64, Expand);
-
-  if (!Subtarget.hasM650232r2())
-    setOperationAction(ISD::BSWAP, MVT::i32, Expand);
-  if (!Subtarget.hasM650264r2())
-    setOperationAction(ISD::BSWAP, MVT::i64, Expand);
-
-  if (Subtarget.isGP64bit()) {
-    setLoadExtAction(ISD::SEXTLOAD, MVT::i64, MVT::i32, Custom);
-    setLoadExtAction(ISD::ZEXTLOAD, MVT::i64, MVT::i32, Custom);
-    setLoadExtAction(ISD::EXTLOAD, MVT::i64, MVT::i32, Custom);
-    setTruncStoreAction(MVT::i64, MVT::i32, Custom);
-  }
-
-  setOperationAction(ISD::TRAP, MVT::Other, Legal);
-
-  setTargetDAGCombine(ISD::SDIVREM);
-  setTargetDAGCombine(ISD::UDIVREM);
-  setTargetDAGCombine(ISD::SELECT);
-  setTargetDAGCombine(ISD::AND);
-  setTargetDAGCombine(ISD::OR);
-  setTargetDAGCombine(ISD::ADD);
-  setTargetDAGCombine(ISD::SUB);
-  setTargetDAGCombine(ISD::AssertZext);
-  setTargetDAGCombine(ISD::SHL);
-
-  if (ABI.IsO32()) {
-    // These libcalls are not available in 32-bit.
-    setLibcallName(RTLIB::SHL_I128, nullptr);
-    setLibcallName(RTLIB::SRL_I128, nullptr);
-    setLibcallName(RTLIB::SRA_I128, nullptr);
-  }
-
-  setMinFunctionAlignment(Subtarget.isGP64bit() ? 3 : 2);
-
-  // The arguments on the stack are defined in terms of 4-byte slots on O32
-  // and 8-byte slots on N32/N64.
-  setMinStackArgumentAlignment((ABI.IsN32() || ABI.IsN64()) ? 8 : 4);
-
-  setStackPointerRegisterToSaveRestore(ABI.IsN64() ? M6502::SP_64 : M6502::SP);
-
-  MaxStoresPerMemcpy = 16;
-
-  isMicroM6502 = Subtarget.inMicroM6502Mode();
+  // Bytes are loaded one at a time, so there are no extending loads or
+  // truncating stores.
+  setLoadExtAction(ISD::EXTLOAD,  MVT::i16, MVT::i8, Expand);
+  setLoadExtAction(ISD::ZEXTLOAD, MVT::i16, MVT::i8, Expand);
+  setLoadExtAction(ISD::SEXTLOAD, MVT::i16, MVT::i8, Expand);
+  setTruncStoreAction(MVT::i16, MVT::i8, Expand);
+
+  // Addresses are always absolute.
+  setOperationAction(ISD::GlobalAddress,      MVT::i16,   Custom);
+  setOperationAction(ISD::ExternalSymbol,     MVT::i16,   Custom);
+  setOperationAction(ISD::BlockAddress,       MVT::i16,   Custom);
+  setOperationAction(ISD::ConstantPool,       MVT::i16,   Custom);
+  setOperationAction(ISD::JumpTable,          MVT::i16,   Custom);
+
+  // Comparisons are folded into the branch or select using them.
+  setOperationAction(ISD::BR_CC,              MVT::i8,    Custom);
+  setOperationAction(ISD::BR_CC,              MVT::i16,   Custom);
+  setOperationAction(ISD::BRCOND,             MVT::Other, Expand);
+  setOperationAction(ISD::BR_JT,              MVT::Other, Custom);
+  for (MVT VT : {MVT::i8, MVT::i16}) {
+    setOperationAction(ISD::SETCC,            VT,         Expand);
+    setOperationAction(ISD::SELECT,           VT,         Expand);
+    setOperationAction(ISD::SELECT_CC,        VT,         Custom);
+  }
+
+  // Wider values are split into pairs chained through the carry flag.  Bytes
+  // are never split off a pair, so there is no byte sized carry chain.
+  setOperationAction(ISD::ADDC,               MVT::i8,    Expand);
+  setOperationAction(ISD::ADDE,               MVT::i8,    Expand);
+  setOperationAction(ISD::SUBC,               MVT::i8,    Expand);
+  setOperationAction(ISD::SUBE,               MVT::i8,    Expand);
+
+  // A variable shift of a split value is a loop over every byte; leave it to
+  // the runtime library rather than expanding it inline.
+  setOperationAction(ISD::SHL_PARTS,          MVT::i16,   Expand);
+  setOperationAction(ISD::SRA_PARTS,          MVT::i16,   Expand);
+  setOperationAction(ISD::SRL_PARTS,          MVT::i16,   Expand);
+
+  // The 6502 has no multiplier or divider.
+  for (MVT VT : {MVT::i8, MVT::i16}) {
+    setOperationAction(ISD::MUL,              VT,         LibCall);
+    setOperationAction(ISD::SDIV,             VT,         LibCall);
+    setOperationAction(ISD::UDIV,             VT,         LibCall);
+    setOperationAction(ISD::SREM,             VT,         LibCall);
+    setOperationAction(ISD::UREM,             VT,         LibCall);
+    setOperationAction(ISD::MULHS,            VT,         Expand);
+    setOperationAction(ISD::MULHU,            VT,         Expand);
+    setOperationAction(ISD::SMUL_LOHI,        VT,         Expand);
+    setOperationAction(ISD::UMUL_LOHI,        VT,         Expand);
+    setOperationAction(ISD::SDIVREM,          VT,         Expand);
+    setOperationAction(ISD::UDIVREM,          VT,         Expand);
+    setOperationAction(ISD::ROTL,             VT,         Expand);
+    setOperationAction(ISD::ROTR,             VT,         Expand);
+    setOperationAction(ISD::BSWAP,            VT,         Expand);
+    setOperationAction(ISD::CTPOP,            VT,         Expand);
+    setOperationAction(ISD::CTLZ,             VT,         Expand);
+    setOperationAction(ISD::CTTZ,             VT,         Expand);
+    setOperationAction(ISD::CTLZ_ZERO_UNDEF,  VT,         Expand);
+    setOperationAction(ISD::CTTZ_ZERO_UNDEF,  VT,         Expand);
+    setOperationAction(ISD::SIGN_EXTEND_INREG, VT,        Expand);
+  }
+
+  // Multiplies and divides by a constant are shifts and adds where those
+  // cost less than the libcall.
+  setTargetDAGCombine(ISD::MUL);
+  setTargetDAGCombine(ISD::SDIV);
+  setTargetDAGCombine(ISD::UDIV);
+  setTargetDAGCombine(ISD::SREM);
+  setTargetDAGCombine(ISD::UREM);
+
+  setOperationAction(ISD::VASTART,            MVT::Other, Custom);
+  setOperationAction(ISD::VAARG,              MVT::Other, Expand);
+  setOperationAction(ISD::VACOPY,             MVT::Other, Expand);
+  setOperationAction(ISD::VAEND,              MVT::Other, Expand);
+  setOperationAction(ISD::FRAMEADDR,          MVT::i16,   Custom);
+
+  setOperationAction(ISD::STACKSAVE,          MVT::Other, Expand);
+  setOperationAction(ISD::STACKRESTORE,       MVT::Other, Expand);
+  setOperationAction(ISD::DYNAMIC_STACKALLOC, MVT::i16,   Expand);
+
+  setOperationAction(ISD::ATOMIC_FENCE,       MVT::Other, Expand);
+
+  // A jump table costs a range check, two abs,X loads and an indirect JMP,
+  // about as many cycles as a tree of compares over eight cases.  It holds
+  // at most 256 entries so that a byte indexes it.
+  setMinimumJumpTableEntries(8);
+  setMaximumJumpTableSize(256);
+
+  // Every block copy and fill of a constant size is emitted by emitBlockOp,
+  // which does the short ones byte by byte without the loads grouped apart
+  // from the stores.
+  MaxStoresPerMemcpy = MaxStoresPerMemcpyOptSize = 0;
+  MaxStoresPerMemset = MaxStoresPerMemsetOptSize = 0;
+
+  setMinFunctionAlignment(0);
+  setMinStackArgumentAlignment(1);
+
+  setStackPointerRegisterToSaveRestore(ABI.GetStackPtr());
 }
 
 const M6502TargetLowering *M6502TargetLowering::create(const M6502TargetMachine &TM,
                                                      const M6502Subtarget &STI) {
-  if (STI.inM650216Mode())
-    return createM650216TargetLowering(TM, STI);
-
   return createM6502SETargetLowering(TM, STI);
 }
 
-// Create a fast isel object.
-FastISel *
-M6502TargetLowering::createFastISel(FunctionLoweringInfo &funcInfo,
-                                  const TargetLibraryInfo *libInfo) const {
-  const M6502TargetMachine &TM =
-      static_cast<const M6502TargetMachine &>(funcInfo.MF->getTarget());
-
-  // We support only the standard encoding [M650232,M650232R5] ISAs.
-  bool UseFastISel = TM.Options.EnableFastISel && Subtarget.hasM650232() &&
-                     !Subtarget.hasM650232r6() && !Subtarget.inM650216Mode() &&
-                     !Subtarget.inMicroM6502Mode();
-
-  // Disable if either of the following is true:
-  // We do not generate PIC, the ABI is not O32, LargeGOT is being used.
-  if (!TM.isPositionIndependent() || !TM.getABI().IsO32() || LargeGOT)
-    UseFastISel = false;
-
-  return UseFastISel ? M6502::createFastISel(funcInfo, libInfo) : nullptr;
-}
-
 EVT M6502TargetLowering::getSetCCResultType(const DataLayout &, LLVMContext &,
                                            EVT VT) const {
-  if (!VT.isVector())
-    return MVT::i32;
-  return VT.changeVectorElementTypeToInteger();
+  return MVT::i8;
 }
 
-static SDValue performDivRemCombine(SDNode *N, SelectionDAG &DAG,
-                                    TargetLowering::DAGCombinerInfo &DCI,
-                                    const M6502Subtarget &Subtarget) {
-  if (DCI.isBeforeLegalizeOps())
-    return SDValue();
-
-  EVT Ty = N->getValueType(0);
-  unsigned LO = (Ty == MVT::i32) ? M6502::LO0 : M6502::LO0_64;
-  unsigned HI = (Ty == MVT::i32) ? M6502::HI0 : M6502::HI0_64;
-  unsigned Opc = N->getOpcode() == ISD::SDIVREM ? M6502ISD::DivRem16 :
-                                                  M6502ISD::DivRemU16;
-  SDLoc DL(N);
-
-  SDValue DivRem = DAG.getNode(Opc, DL, MVT::Glue,
-                               N->getOperand(0), N->getOperand(1));
-  SDValue InChain = DAG.getEntryNode();
-  SDValue InGlue = DivRem;
-
-  // insert MFLO
-  if (N->hasAnyUseOfValue(0)) {
-    SDValue CopyFromLo = DAG.getCopyFromReg(InChain, DL, LO, Ty,
-                                            InGlue);
-    DAG.ReplaceAllUsesOfValueWith(SDValue(N, 0), CopyFromLo);
-    InChain = CopyFromLo.getValue(1);
-    InGlue = CopyFromLo.getValue(2);
-  }
-
-  // insert MFHI
-  if (N->hasAnyUseOfValue(1)) {
-    SDValue CopyFromHi = DAG.getCopyFromReg(InChain, DL,
-                                            HI, Ty, InGlue);
-    DAG.ReplaceAllUsesOfValueWith(SDValue(N, 1), CopyFromHi);
+SDValue M6502TargetLowering::
+LowerOperation(SDValue Op, SelectionDAG &DAG) const
+{
+  switch (Op.getOpcode())
+  {
+  case ISD::BR_CC:              return lowerBR_CC(Op, DAG);
+  case ISD::BR_JT:              return lowerBR_JT(Op, DAG);
+  case ISD::SELECT_CC:          return lowerSELECT_CC(Op, DAG);
+  case ISD::ConstantPool:       return lowerConstantPool(Op, DAG);
+  case ISD::GlobalAddress:      return lowerGlobalAddress(Op, DAG);
+  case ISD::BlockAddress:       return lowerBlockAddress(Op, DAG);
+  case ISD::ExternalSymbol:     return lowerExternalSymbol(Op, DAG);
+  case ISD::JumpTable:          return lowerJumpTable(Op, DAG);
+  case ISD::VASTART:            return lowerVASTART(Op, DAG);
+  case ISD::FRAMEADDR:          return lowerFRAMEADDR(Op, DAG);
   }
-
   return SDValue();
 }
 
-static M6502::CondCode condCodeToFCC(ISD::CondCode CC) {
-  switch (CC) {
-  default: llvm_unreachable("Unknown fp condition code!");
-  case ISD::SETEQ:
-  case ISD::SETOEQ: return M6502::FCOND_OEQ;
-  case ISD::SETUNE: return M6502::FCOND_UNE;
-  case ISD::SETLT:
-  case ISD::SETOLT: return M6502::FCOND_OLT;
-  case ISD::SETGT:
-  case ISD::SETOGT: return M6502::FCOND_OGT;
-  case ISD::SETLE:
-  case ISD::SETOLE: return M6502::FCOND_OLE;
-  case ISD::SETGE:
-  case ISD::SETOGE: return M6502::FCOND_OGE;
-  case ISD::SETULT: return M6502::FCOND_ULT;
-  case ISD::SETULE: return M6502::FCOND_ULE;
-  case ISD::SETUGT: return M6502::FCOND_UGT;
-  case ISD::SETUGE: return M6502::FCOND_UGE;
-  case ISD::SETUO:  return M6502::FCOND_UN;
-  case ISD::SETO:   return M6502::FCOND_OR;
-  case ISD::SETNE:
-  case ISD::SETONE: return M6502::FCOND_ONE;
-  case ISD::SETUEQ: return M6502::FCOND_UEQ;
-  }
-}
-
-/// This function returns true if the floating point conditional branches and
-/// conditional moves which use condition code CC should be inverted.
-static bool invertFPCondCodeUser(M6502::CondCode CC) {
-  if (CC >= M6502::FCOND_F && CC <= M6502::FCOND_NGT)
-    return false;
-
-  assert((CC >= M6502::FCOND_T && CC <= M6502::FCOND_GT) &&
-         "Illegal Condition Code");
-
-  return true;
-}
-
-// Creates and returns an FPCmp node from a setcc node.
-// Returns Op if setcc is not a floating point comparison.
-static SDValue createFPCmp(SelectionDAG &DAG, const SDValue &Op) {
-  // must be a SETCC node
-  if (Op.getOpcode() != ISD::SETCC)
-    return Op;
-
-  SDValue LHS = Op.getOperand(0);
-
-  if (!LHS.getValueType().isFloatingPoint())
-    return Op;
-
-  SDValue RHS = Op.getOperand(1);
-  SDLoc DL(Op);
-
-  // Assume the 3rd operand is a CondCodeSDNode. Add code to check the type of
-  // node if necessary.
-  ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(2))->get();
-
-  return DAG.getNode(M6502ISD::FPCmp, DL, MVT::Glue, LHS, RHS,
-                     DAG.getConstant(condCodeToFCC(CC), DL, MVT::i32));
-}
-
-// Creates and returns a CMovFPT/F node.
-static SDValue createCMovFP(SelectionDAG &DAG, SDValue Cond, SDValue True,
-                            SDValue False, const SDLoc &DL) {
-  ConstantSDNode *CC = cast<ConstantSDNode>(Cond.getOperand(2));
-  bool invert = invertFPCondCodeUser((M6502::CondCode)CC->getSExtValue());
-  SDValue FCC0 = DAG.getRegister(M6502::FCC0, MVT::i32);
-
-  return DAG.getNode((invert ? M6502ISD::CMovFP_F : M6502ISD::CMovFP_T), DL,
-                     True.getValueType(), True, FCC0, False, Cond);
-}
-
-static SDValue performSELECTCombine(SDNode *N, SelectionDAG &DAG,
-                                    TargetLowering::DAGCombinerInfo &DCI,
-                                    const M6502Subtarget &Subtarget) {
-  if (DCI.isBeforeLegalizeOps())
-    return SDValue();
-
-  SDValue SetCC = N->getOperand(0);
-
-  if ((SetCC.getOpcode() != ISD::SETCC) ||
-      !SetCC.getOperand(0).getValueType().isInteger())
-    return SDValue();
-
-  SDValue False = N->getOperand(2);
-  EVT FalseTy = False.getValueType();
-
-  if (!FalseTy.isInteger())
-    return SDValue();
-
-  ConstantSDNode *FalseC = dyn_cast<ConstantSDNode>(False);
-
-  // If the RHS (False) is 0, we swap the order of the operands
-  // of ISD::SELECT (obviously also inverting the condition) so that we can
-  // take advantage of conditional moves using the $0 register.
-  // Example:
-  //   return (a != 0) ? x : 0;
-  //     load $reg, x
-  //     movz $reg, $0, a
-  if (!FalseC)
-    return SDValue();
-
-  const SDLoc DL(N);
-
-  if (!FalseC->getZExtValue()) {
-    ISD::CondCode CC = cast<CondCodeSDNode>(SetCC.getOperand(2))->get();
-    SDValue True = N->getOperand(1);
-
-    SetCC = DAG.getSetCC(DL, SetCC.getValueType(), SetCC.getOperand(0),
-                         SetCC.getOperand(1), ISD::getSetCCInverse(CC, true));
-
-    return DAG.getNode(ISD::SELECT, DL, FalseTy, SetCC, False, True);
-  }
+//===----------------------------------------------------------------------===//
+//  Multiplication and division by constants
+//===----------------------------------------------------------------------===//
 
-  // If both operands are integer constants there's a possibility that we
-  // can do some interesting optimizations.
-  SDValue True = N->getOperand(1);
-  ConstantSDNode *TrueC = dyn_cast<ConstantSDNode>(True);
+// The estimated cycles of the shifts and adds a constant multiply is made
+// of, from the expansion of the shift and add pseudos, and of the libcalls,
+// which shift and add once for each bit of an operand.
+static unsigned getShiftCost(unsigned Bits, unsigned Amt) {
+  if (!Amt)
+    return 0;
+  if (Bits == 8)
+    return 6 + 2 * Amt;
+  if (Amt >= 8)
+    return 11 + 2 * (Amt - 8);
+  return 12 + 7 * Amt;
+}
+
+static unsigned getAddCost(unsigned Bits) { return Bits == 8 ? 11 : 20; }
+
+static unsigned getLibCallCost(unsigned Bits, bool IsDiv) {
+  return (Bits == 8 ? 200 : 400) + (IsDiv ? 50 : 0);
+}
+
+namespace {
+
+/// A multiply by a constant as a sum of the shifts of the other operand by
+/// the positions of the non-zero digits of the constant in signed binary.
+/// The shifts are either done one after the other on the sum so far, from
+/// the top digit down, or each from the operand, which is cheaper when the
+/// shifts move whole bytes.
+struct ConstantMul {
+  struct Digit {
+    unsigned Shift;
+    bool Neg;
+  };
+  SmallVector<Digit, 8> Digits; // From the bottom digit up.
+  unsigned Bits;
+  bool Chained;
+  unsigned Cost;
+
+  ConstantMul(uint64_t C, unsigned Bits) : Bits(Bits) {
+    // The non-adjacent form has the fewest non-zero digits.  A digit past
+    // the top bit is a multiple of the width and drops out.
+    C &= maskTrailingOnes<uint64_t>(Bits);
+    for (unsigned Shift = 0; C && Shift < Bits; ++Shift, C >>= 1) {
+      if (!(C & 1))
+        continue;
+      bool Neg = (C & 3) == 3;
+      Digits.push_back({Shift, Neg});
+      C += Neg ? 1 : -1;
+    }
 
-  if (!TrueC || !True.getValueType().isInteger())
-    return SDValue();
+    unsigned AddCost = getAddCost(Bits);
+    unsigned Adds = Digits.empty() ? 0 : Digits.size() - 1;
+
+    // The chain starts from the top digit, negated if it is negative, and
+    // shifts by the gap to each digit below it.
+    unsigned ChainCost = Adds * AddCost;
+    if (!Digits.empty()) {
+      if (Digits.back().Neg)
+        ChainCost += AddCost;
+      for (unsigned I = Digits.size() - 1; I != 0; --I)
+        ChainCost +=
+            getShiftCost(Bits, Digits[I].Shift - Digits[I - 1].Shift);
+      ChainCost += getShiftCost(Bits, Digits.front().Shift);
+    }
 
-  // We'll also ignore MVT::i64 operands as this optimizations proves
-  // to be ineffective because of the required sign extensions as the result
-  // of a SETCC operator is always MVT::i32 for non-vector types.
-  if (True.getValueType() == MVT::i64)
-    return SDValue();
+    // The sum of separate shifts starts from a positive digit.
+    unsigned SumCost = Adds * AddCost;
+    for (const Digit &D : Digits)
+      SumCost += getShiftCost(Bits, D.Shift);
+    if (none_of(Digits, [](const Digit &D) { return !D.Neg; }))
+      SumCost += AddCost;
+
+    Chained = ChainCost < SumCost;
+    Cost = Chained ? ChainCost : SumCost;
+  }
+
+  SDValue build(SelectionDAG &DAG, const SDLoc &DL, SDValue X) const {
+    EVT VT = X.getValueType();
+    SDValue Zero = DAG.getConstant(0, DL, VT);
+    if (Digits.empty())
+      return Zero;
+
+    auto shift = [&](SDValue V, unsigned Amt) {
+      return Amt ? DAG.getNode(ISD::SHL, DL, VT, V,
+                               DAG.getConstant(Amt, DL, MVT::i8))
+                 : V;
+    };
+    auto accumulate = [&](SDValue Acc, SDValue V, bool Neg) {
+      if (!Acc)
+        Acc = Zero;
+      return DAG.getNode(Neg ? ISD::SUB : ISD::ADD, DL, VT, Acc, V);
+    };
+
+    SDValue Acc;
+    if (Chained) {
+      Acc = Digits.back().Neg ? accumulate(Acc, X, true) : X;
+      for (unsigned I = Digits.size() - 1; I != 0; --I)
+        Acc = accumulate(shift(Acc, Digits[I].Shift - Digits[I - 1].Shift), X,
+                         Digits[I - 1].Neg);
+      return shift(Acc, Digits.front().Shift);
+    }
 
-  int64_t Diff = TrueC->getSExtValue() - FalseC->getSExtValue();
-
-  // 1)  (a < x) ? y : y-1
-  //  slti $reg1, a, x
-  //  addiu $reg2, $reg1, y-1
-  if (Diff == 1)
-    return DAG.getNode(ISD::ADD, DL, SetCC.getValueType(), SetCC, False);
-
-  // 2)  (a < x) ? y-1 : y
-  //  slti $reg1, a, x
-  //  xor $reg1, $reg1, 1
-  //  addiu $reg2, $reg1, y-1
-  if (Diff == -1) {
-    ISD::CondCode CC = cast<CondCodeSDNode>(SetCC.getOperand(2))->get();
-    SetCC = DAG.getSetCC(DL, SetCC.getValueType(), SetCC.getOperand(0),
-                         SetCC.getOperand(1), ISD::getSetCCInverse(CC, true));
-    return DAG.getNode(ISD::ADD, DL, SetCC.getValueType(), SetCC, True);
+    auto First = find_if(Digits, [](const Digit &D) { return !D.Neg; });
+    if (First != Digits.end())
+      Acc = shift(X, First->Shift);
+    for (auto I = Digits.begin(), E = Digits.end(); I != E; ++I)
+      if (I != First)
+        Acc = accumulate(Acc, shift(X, I->Shift), I->Neg);
+    return Acc;
   }
+};
 
-  // Couldn't optimize.
-  return SDValue();
-}
-
-static SDValue performCMovFPCombine(SDNode *N, SelectionDAG &DAG,
-                                    TargetLowering::DAGCombinerInfo &DCI,
-                                    const M6502Subtarget &Subtarget) {
-  if (DCI.isBeforeLegalizeOps())
-    return SDValue();
-
-  SDValue ValueIfTrue = N->getOperand(0), ValueIfFalse = N->getOperand(2);
-
-  ConstantSDNode *FalseC = dyn_cast<ConstantSDNode>(ValueIfFalse);
-  if (!FalseC || FalseC->getZExtValue())
-    return SDValue();
-
-  // Since RHS (False) is 0, we swap the order of the True/False operands
-  // (obviously also inverting the condition) so that we can
-  // take advantage of conditional moves using the $0 register.
-  // Example:
-  //   return (a != 0) ? x : 0;
-  //     load $reg, x
-  //     movz $reg, $0, a
-  unsigned Opc = (N->getOpcode() == M6502ISD::CMovFP_T) ? M6502ISD::CMovFP_F :
-                                                         M6502ISD::CMovFP_T;
-
-  SDValue FCC = N->getOperand(1), Glue = N->getOperand(3);
-  return DAG.getNode(Opc, SDLoc(N), ValueIfFalse.getValueType(),
-                     ValueIfFalse, FCC, ValueIfTrue, Glue);
-}
-
-static SDValue performANDCombine(SDNode *N, SelectionDAG &DAG,
-                                 TargetLowering::DAGCombinerInfo &DCI,
-                                 const M6502Subtarget &Subtarget) {
-  if (DCI.isBeforeLegalizeOps() || !Subtarget.hasExtractInsert())
-    return SDValue();
-
-  SDValue FirstOperand = N->getOperand(0);
-  unsigned FirstOperandOpc = FirstOperand.getOpcode();
-  SDValue Mask = N->getOperand(1);
-  EVT ValTy = N->getValueType(0);
-  SDLoc DL(N);
-
-  uint64_t Pos = 0, SMPos, SMSize;
-  ConstantSDNode *CN;
-  SDValue NewOperand;
-  unsigned Opc;
-
-  // Op's second operand must be a shifted mask.
-  if (!(CN = dyn_cast<ConstantSDNode>(Mask)) ||
-      !isShiftedMask(CN->getZExtValue(), SMPos, SMSize))
-    return SDValue();
-
-  if (FirstOperandOpc == ISD::SRA || FirstOperandOpc == ISD::SRL) {
-    // Pattern match EXT.
-    //  $dst = and ((sra or srl) $src , pos), (2**size - 1)
-    //  => ext $dst, $src, pos, size
-
-    // The second operand of the shift must be an immediate.
-    if (!(CN = dyn_cast<ConstantSDNode>(FirstOperand.getOperand(1))))
-      return SDValue();
-
-    Pos = CN->getZExtValue();
-
-    // Return if the shifted mask does not start at bit 0 or the sum of its size
-    // and Pos exceeds the word's size.
-    if (SMPos != 0 || Pos + SMSize > ValTy.getSizeInBits())
-      return SDValue();
-
-    Opc = M6502ISD::Ext;
-    NewOperand = FirstOperand.getOperand(0);
-  } else if (FirstOperandOpc == ISD::SHL && Subtarget.hasCnM6502()) {
-    // Pattern match CINS.
-    //  $dst = and (shl $src , pos), mask
-    //  => cins $dst, $src, pos, size
-    // mask is a shifted mask with consecutive 1's, pos = shift amount,
-    // size = population count.
-
-    // The second operand of the shift must be an immediate.
-    if (!(CN = dyn_cast<ConstantSDNode>(FirstOperand.getOperand(1))))
-      return SDValue();
-
-    Pos = CN->getZExtValue();
-
-    if (SMPos != Pos || Pos >= ValTy.getSizeInBits() || SMSize >= 32 ||
-        Pos + SMSize > ValTy.getSizeInBits())
-      return SDValue();
-
-    NewOperand = FirstOperand.getOperand(0);
-    // SMSize is 'location' (position) in this case, not size.
-    SMSize--;
-    Opc = M6502ISD::CIns;
-  } else {
-    // Pattern match EXT.
-    //  $dst = and $src, (2**size - 1) , if size > 16
-    //  => ext $dst, $src, pos, size , pos = 0
-
-    // If the mask is <= 0xffff, andi can be used instead.
-    if (CN->getZExtValue() <= 0xffff)
-      return SDValue();
-
-    // Return if the mask doesn't start at position 0.
-    if (SMPos)
-      return SDValue();
-
-    Opc = M6502ISD::Ext;
-    NewOperand = FirstOperand;
+/// A divide of a byte by a constant as a multiply by a fixed point
+/// reciprocal in a pair, keeping the high byte shifted right by the rest of
+/// the fraction bits.  The quotient of a negative dividend rounds towards
+/// minus infinity and is moved up by one.  An unsigned reciprocal of nine
+/// bits is multiplied without its top bit, which is added back to the high
+/// byte T of the product as ((X - T) / 2 + T) shifted right one bit less.
+struct ConstantDiv {
+  unsigned Divisor;
+  bool Signed;
+  unsigned Shift = 0;
+  bool AddBack = false;
+  Optional<ConstantMul> Mul;
+  unsigned Cost = ~0U;
+
+  ConstantDiv(unsigned Divisor, bool Signed)
+      : Divisor(Divisor), Signed(Signed) {
+    // Every dividend is tried with each reciprocal, rounded up, that fits a
+    // pair, and the cheapest exact one is kept.
+    for (unsigned P = 8; P < 16; ++P) {
+      uint64_t M = ((uint64_t(1) << P) + Divisor - 1) / Divisor;
+      bool Wide = !Signed && M >= 0x100;
+      if (Wide && P < 9)
+        continue;
+      if (Wide)
+        M -= 0x100;
+      if (!isExact(M, P, Wide))
+        continue;
+      ConstantMul CM(M, 16);
+      unsigned C = CM.Cost + getShiftCost(8, P - (Wide ? 9 : 8));
+      if (Signed)
+        C += getShiftCost(8, 1) + getAddCost(8);
+      if (Wide)
+        C += 2 * getAddCost(8) + getShiftCost(8, 1);
+      if (C < Cost) {
+        Cost = C;
+        Shift = P;
+        AddBack = Wide;
+        Mul = CM;
+      }
+    }
   }
-  return DAG.getNode(Opc, DL, ValTy, NewOperand,
-                     DAG.getConstant(Pos, DL, MVT::i32),
-                     DAG.getConstant(SMSize, DL, MVT::i32));
-}
-
-static SDValue performORCombine(SDNode *N, SelectionDAG &DAG,
-                                TargetLowering::DAGCombinerInfo &DCI,
-                                const M6502Subtarget &Subtarget) {
-  // Pattern match INS.
-  //  $dst = or (and $src1 , mask0), (and (shl $src, pos), mask1),
-  //  where mask1 = (2**size - 1) << pos, mask0 = ~mask1
-  //  => ins $dst, $src, size, pos, $src1
-  if (DCI.isBeforeLegalizeOps() || !Subtarget.hasExtractInsert())
-    return SDValue();
 
-  SDValue And0 = N->getOperand(0), And1 = N->getOperand(1);
-  uint64_t SMPos0, SMSize0, SMPos1, SMSize1;
-  ConstantSDNode *CN, *CN1;
-
-  // See if Op's first operand matches (and $src1 , mask0).
-  if (And0.getOpcode() != ISD::AND)
-    return SDValue();
-
-  if (!(CN = dyn_cast<ConstantSDNode>(And0.getOperand(1))) ||
-      !isShiftedMask(~CN->getSExtValue(), SMPos0, SMSize0))
-    return SDValue();
-
-  // See if Op's second operand matches (and (shl $src, pos), mask1).
-  if (And1.getOpcode() == ISD::AND &&
-      And1.getOperand(0).getOpcode() == ISD::SHL) {
-
-    if (!(CN = dyn_cast<ConstantSDNode>(And1.getOperand(1))) ||
-        !isShiftedMask(CN->getZExtValue(), SMPos1, SMSize1))
-      return SDValue();
-
-    // The shift masks must have the same position and size.
-    if (SMPos0 != SMPos1 || SMSize0 != SMSize1)
-      return SDValue();
-
-    SDValue Shl = And1.getOperand(0);
-
-    if (!(CN = dyn_cast<ConstantSDNode>(Shl.getOperand(1))))
-      return SDValue();
-
-    unsigned Shamt = CN->getZExtValue();
-
-    // Return if the shift amount and the first bit position of mask are not the
-    // same.
-    EVT ValTy = N->getValueType(0);
-    if ((Shamt != SMPos0) || (SMPos0 + SMSize0 > ValTy.getSizeInBits()))
-      return SDValue();
-
-    SDLoc DL(N);
-    return DAG.getNode(M6502ISD::Ins, DL, ValTy, Shl.getOperand(0),
-                       DAG.getConstant(SMPos0, DL, MVT::i32),
-                       DAG.getConstant(SMSize0, DL, MVT::i32),
-                       And0.getOperand(0));
-  } else {
-    // Pattern match DINS.
-    //  $dst = or (and $src, mask0), mask1
-    //  where mask0 = ((1 << SMSize0) -1) << SMPos0
-    //  => dins $dst, $src, pos, size
-    if (~CN->getSExtValue() == ((((int64_t)1 << SMSize0) - 1) << SMPos0) &&
-        ((SMSize0 + SMPos0 <= 64 && Subtarget.hasM650264r2()) ||
-         (SMSize0 + SMPos0 <= 32))) {
-      // Check if AND instruction has constant as argument
-      bool isConstCase = And1.getOpcode() != ISD::AND;
-      if (And1.getOpcode() == ISD::AND) {
-        if (!(CN1 = dyn_cast<ConstantSDNode>(And1->getOperand(1))))
-          return SDValue();
+  bool isExact(uint64_t M, unsigned P, bool Wide) const {
+    int64_t Lo = Signed ? -128 : 0, Hi = Signed ? 127 : 255;
+    for (int64_t X = Lo; X <= Hi; ++X) {
+      int64_t Prod = X * int64_t(M);
+      if (Signed ? !isInt<16>(Prod) : !isUInt<16>(Prod))
+        return false;
+      // Shifts of negative values round towards minus infinity.
+      int64_t Q;
+      if (Wide) {
+        int64_t T = Prod >> 8;
+        Q = (((X - T) >> 1) + T) >> (P - 9);
       } else {
-        if (!(CN1 = dyn_cast<ConstantSDNode>(N->getOperand(1))))
-          return SDValue();
-      }
-      // Don't generate INS if constant OR operand doesn't fit into bits
-      // cleared by constant AND operand.
-      if (CN->getSExtValue() & CN1->getSExtValue())
-        return SDValue();
-
-      SDLoc DL(N);
-      EVT ValTy = N->getOperand(0)->getValueType(0);
-      SDValue Const1;
-      SDValue SrlX;
-      if (!isConstCase) {
-        Const1 = DAG.getConstant(SMPos0, DL, MVT::i32);
-        SrlX = DAG.getNode(ISD::SRL, DL, And1->getValueType(0), And1, Const1);
+        Q = Prod >= 0 ? Prod >> P : -((-Prod + (int64_t(1) << P) - 1) >> P);
       }
-      return DAG.getNode(
-          M6502ISD::Ins, DL, N->getValueType(0),
-          isConstCase
-              ? DAG.getConstant(CN1->getSExtValue() >> SMPos0, DL, ValTy)
-              : SrlX,
-          DAG.getConstant(SMPos0, DL, MVT::i32),
-          DAG.getConstant(ValTy.getSizeInBits() / 8 < 8 ? SMSize0 & 31
-                                                        : SMSize0,
-                          DL, MVT::i32),
-          And0->getOperand(0));
-
+      if (X < 0)
+        ++Q;
+      if (Q != X / int64_t(Divisor))
+        return false;
     }
-    return SDValue();
-  }
-}
-
-static SDValue performMADD_MSUBCombine(SDNode *ROOTNode, SelectionDAG &CurDAG,
-                                       const M6502Subtarget &Subtarget) {
-  // ROOTNode must have a multiplication as an operand for the match to be
-  // successful.
-  if (ROOTNode->getOperand(0).getOpcode() != ISD::MUL &&
-      ROOTNode->getOperand(1).getOpcode() != ISD::MUL)
-    return SDValue();
-
-  // We don't handle vector types here.
-  if (ROOTNode->getValueType(0).isVector())
-    return SDValue();
-
-  // For M650264, madd / msub instructions are inefficent to use with 64 bit
-  // arithmetic. E.g.
-  // (add (mul a b) c) =>
-  //   let res = (madd (mthi (drotr c 32))x(mtlo c) a b) in
-  //   M650264:   (or (dsll (mfhi res) 32) (dsrl (dsll (mflo res) 32) 32)
-  //   or
-  //   M650264R2: (dins (mflo res) (mfhi res) 32 32)
-  //
-  // The overhead of setting up the Hi/Lo registers and reassembling the
-  // result makes this a dubious optimzation for M650264. The core of the
-  // problem is that Hi/Lo contain the upper and lower 32 bits of the
-  // operand and result.
-  //
-  // It requires a chain of 4 add/mul for M650264R2 to get better code
-  // density than doing it naively, 5 for M650264. Additionally, using
-  // madd/msub on M650264 requires the operands actually be 32 bit sign
-  // extended operands, not true 64 bit values.
-  //
-  // FIXME: For the moment, disable this completely for M650264.
-  if (Subtarget.hasM650264())
-    return SDValue();
-
-  SDValue Mult = ROOTNode->getOperand(0).getOpcode() == ISD::MUL
-                     ? ROOTNode->getOperand(0)
-                     : ROOTNode->getOperand(1);
-
-  SDValue AddOperand = ROOTNode->getOperand(0).getOpcode() == ISD::MUL
-                     ? ROOTNode->getOperand(1)
-                     : ROOTNode->getOperand(0);
-
-  // Transform this to a MADD only if the user of this node is the add.
-  // If there are other users of the mul, this function returns here.
-  if (!Mult.hasOneUse())
-    return SDValue();
-
-  // maddu and madd are unusual instructions in that on M650264 bits 63..31
-  // must be in canonical form, i.e. sign extended. For M650232, the operands
-  // of the multiply must have 32 or more sign bits, otherwise we cannot
-  // perform this optimization. We have to check this here as we're performing
-  // this optimization pre-legalization.
-  SDValue MultLHS = Mult->getOperand(0);
-  SDValue MultRHS = Mult->getOperand(1);
-
-  bool IsSigned = MultLHS->getOpcode() == ISD::SIGN_EXTEND &&
-                  MultRHS->getOpcode() == ISD::SIGN_EXTEND;
-  bool IsUnsigned = MultLHS->getOpcode() == ISD::ZERO_EXTEND &&
-                    MultRHS->getOpcode() == ISD::ZERO_EXTEND;
-
-  if (!IsSigned && !IsUnsigned)
-    return SDValue();
-
-  // Initialize accumulator.
-  SDLoc DL(ROOTNode);
-  SDValue TopHalf;
-  SDValue BottomHalf;
-  BottomHalf = CurDAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, AddOperand,
-                              CurDAG.getIntPtrConstant(0, DL));
-
-  TopHalf = CurDAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i32, AddOperand,
-                           CurDAG.getIntPtrConstant(1, DL));
-  SDValue ACCIn = CurDAG.getNode(M6502ISD::MTLOHI, DL, MVT::Untyped,
-                                  BottomHalf,
-                                  TopHalf);
-
-  // Create M6502MAdd(u) / M6502MSub(u) node.
-  bool IsAdd = ROOTNode->getOpcode() == ISD::ADD;
-  unsigned Opcode = IsAdd ? (IsUnsigned ? M6502ISD::MAddu : M6502ISD::MAdd)
-                          : (IsUnsigned ? M6502ISD::MSubu : M6502ISD::MSub);
-  SDValue MAddOps[3] = {
-      CurDAG.getNode(ISD::TRUNCATE, DL, MVT::i32, Mult->getOperand(0)),
-      CurDAG.getNode(ISD::TRUNCATE, DL, MVT::i32, Mult->getOperand(1)), ACCIn};
-  EVT VTs[2] = {MVT::i32, MVT::i32};
-  SDValue MAdd = CurDAG.getNode(Opcode, DL, VTs, MAddOps);
-
-  SDValue ResLo = CurDAG.getNode(M6502ISD::MFLO, DL, MVT::i32, MAdd);
-  SDValue ResHi = CurDAG.getNode(M6502ISD::MFHI, DL, MVT::i32, MAdd);
-  SDValue Combined =
-      CurDAG.getNode(ISD::BUILD_PAIR, DL, MVT::i64, ResLo, ResHi);
-  return Combined;
-}
-
-static SDValue performSUBCombine(SDNode *N, SelectionDAG &DAG,
-                                 TargetLowering::DAGCombinerInfo &DCI,
-                                 const M6502Subtarget &Subtarget) {
-  // (sub v0 (mul v1, v2)) => (msub v1, v2, v0)
-  if (DCI.isBeforeLegalizeOps()) {
-    if (Subtarget.hasM650232() && !Subtarget.hasM650232r6() &&
-        !Subtarget.inM650216Mode() && N->getValueType(0) == MVT::i64)
-      return performMADD_MSUBCombine(N, DAG, Subtarget);
-
-    return SDValue();
+    return true;
   }
 
-  return SDValue();
-}
-
-static SDValue performADDCombine(SDNode *N, SelectionDAG &DAG,
-                                 TargetLowering::DAGCombinerInfo &DCI,
-                                 const M6502Subtarget &Subtarget) {
-  // (add v0 (mul v1, v2)) => (madd v1, v2, v0)
-  if (DCI.isBeforeLegalizeOps()) {
-    if (Subtarget.hasM650232() && !Subtarget.hasM650232r6() &&
-        !Subtarget.inM650216Mode() && N->getValueType(0) == MVT::i64)
-      return performMADD_MSUBCombine(N, DAG, Subtarget);
-
-    return SDValue();
+  SDValue build(SelectionDAG &DAG, const SDLoc &DL, SDValue X) const {
+    unsigned ShiftOpc = Signed ? ISD::SRA : ISD::SRL;
+    auto shiftRight = [&](SDValue V, unsigned Amt) {
+      return Amt ? DAG.getNode(ShiftOpc, DL, MVT::i8, V,
+                               DAG.getConstant(Amt, DL, MVT::i8))
+                 : V;
+    };
+
+    SDValue Prod = Mul->build(
+        DAG, DL,
+        DAG.getNode(Signed ? ISD::SIGN_EXTEND : ISD::ZERO_EXTEND, DL, MVT::i16,
+                    X));
+    SDValue Q = DAG.getNode(
+        ISD::TRUNCATE, DL, MVT::i8,
+        DAG.getNode(ShiftOpc, DL, MVT::i16, Prod,
+                    DAG.getConstant(8, DL, MVT::i8)));
+    if (AddBack) {
+      SDValue Half = shiftRight(DAG.getNode(ISD::SUB, DL, MVT::i8, X, Q), 1);
+      Q = DAG.getNode(ISD::ADD, DL, MVT::i8, Half, Q);
+      return shiftRight(Q, Shift - 9);
+    }
+    Q = shiftRight(Q, Shift - 8);
+    if (Signed)
+      Q = DAG.getNode(ISD::SUB, DL, MVT::i8, Q,
+                      DAG.getNode(ISD::SRA, DL, MVT::i8, X,
+                                  DAG.getConstant(7, DL, MVT::i8)));
+    return Q;
   }
+};
 
-  // (add v0, (add v1, abs_lo(tjt))) => (add (add v0, v1), abs_lo(tjt))
-  SDValue Add = N->getOperand(1);
+} // end anonymous namespace
 
-  if (Add.getOpcode() != ISD::ADD)
+static SDValue performMULCombine(SDNode *N, SelectionDAG &DAG) {
+  EVT VT = N->getValueType(0);
+  auto *C = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if ((VT != MVT::i8 && VT != MVT::i16) || !C)
     return SDValue();
 
-  SDValue Lo = Add.getOperand(1);
+  // When optimizing for size, only a sequence about as short as setting up
+  // the call is kept.
+  unsigned Bits = VT.getSizeInBits();
+  unsigned MaxCost = getLibCallCost(Bits, false);
+  if (DAG.getMachineFunction().getFunction()->optForSize())
+    MaxCost = 3 * getAddCost(Bits);
 
-  if ((Lo.getOpcode() != M6502ISD::Lo) ||
-      (Lo.getOperand(0).getOpcode() != ISD::TargetJumpTable))
+  ConstantMul Mul(C->getZExtValue(), Bits);
+  if (Mul.Cost > MaxCost)
     return SDValue();
-
-  EVT ValTy = N->getValueType(0);
-  SDLoc DL(N);
-
-  SDValue Add1 = DAG.getNode(ISD::ADD, DL, ValTy, N->getOperand(0),
-                             Add.getOperand(0));
-  return DAG.getNode(ISD::ADD, DL, ValTy, Add1, Lo);
+  return Mul.build(DAG, SDLoc(N), N->getOperand(0));
 }
 
-static SDValue performSHLCombine(SDNode *N, SelectionDAG &DAG,
-                                 TargetLowering::DAGCombinerInfo &DCI,
-                                 const M6502Subtarget &Subtarget) {
-  // Pattern match CINS.
-  //  $dst = shl (and $src , imm), pos
-  //  => cins $dst, $src, pos, size
-
-  if (DCI.isBeforeLegalizeOps() || !Subtarget.hasCnM6502())
-    return SDValue();
-
-  SDValue FirstOperand = N->getOperand(0);
-  unsigned FirstOperandOpc = FirstOperand.getOpcode();
-  SDValue SecondOperand = N->getOperand(1);
-  EVT ValTy = N->getValueType(0);
-  SDLoc DL(N);
-
-  uint64_t Pos = 0, SMPos, SMSize;
-  ConstantSDNode *CN;
-  SDValue NewOperand;
-
-  // The second operand of the shift must be an immediate.
-  if (!(CN = dyn_cast<ConstantSDNode>(SecondOperand)))
-    return SDValue();
-
-  Pos = CN->getZExtValue();
-
-  if (Pos >= ValTy.getSizeInBits())
+// Only bytes are divided inline: the reciprocal of a divisor of a pair
+// needs a 32 bit product.  Powers of two have already been turned into
+// shifts.
+static SDValue performDivRemCombine(SDNode *N, SelectionDAG &DAG) {
+  auto *C = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (N->getValueType(0) != MVT::i8 || !C ||
+      DAG.getMachineFunction().getFunction()->optForSize())
     return SDValue();
 
-  if (FirstOperandOpc != ISD::AND)
-    return SDValue();
-
-  // AND's second operand must be a shifted mask.
-  if (!(CN = dyn_cast<ConstantSDNode>(FirstOperand.getOperand(1))) ||
-      !isShiftedMask(CN->getZExtValue(), SMPos, SMSize))
+  unsigned Opc = N->getOpcode();
+  bool Signed = Opc == ISD::SDIV || Opc == ISD::SREM;
+  bool IsRem = Opc == ISD::SREM || Opc == ISD::UREM;
+  int64_t Divisor = Signed ? C->getSExtValue() : C->getZExtValue();
+  uint64_t AbsDivisor = std::abs(Divisor);
+  if (AbsDivisor < 2 || isPowerOf2_64(AbsDivisor))
     return SDValue();
 
-  // Return if the shifted mask does not start at bit 0 or the sum of its size
-  // and Pos exceeds the word's size.
-  if (SMPos != 0 || SMSize > 32 || Pos + SMSize > ValTy.getSizeInBits())
+  // The remainder takes the sign of the dividend, whatever the sign of the
+  // divisor.
+  ConstantDiv Div(AbsDivisor, Signed);
+  ConstantMul Mul(AbsDivisor, 8);
+  if (!Div.Mul ||
+      Div.Cost + (IsRem ? Mul.Cost + getAddCost(8) : 0) >
+          getLibCallCost(8, true))
     return SDValue();
 
-  NewOperand = FirstOperand.getOperand(0);
-  // SMSize is 'location' (position) in this case, not size.
-  SMSize--;
-
-  return DAG.getNode(M6502ISD::CIns, DL, ValTy, NewOperand,
-                     DAG.getConstant(Pos, DL, MVT::i32),
-                     DAG.getConstant(SMSize, DL, MVT::i32));
-}
-
-SDValue  M6502TargetLowering::PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI)
-  const {
-  SelectionDAG &DAG = DCI.DAG;
-  unsigned Opc = N->getOpcode();
-
-  switch (Opc) {
-  default: break;
-  case ISD::SDIVREM:
-  case ISD::UDIVREM:
-    return performDivRemCombine(N, DAG, DCI, Subtarget);
-  case ISD::SELECT:
-    return performSELECTCombine(N, DAG, DCI, Subtarget);
-  case M6502ISD::CMovFP_F:
-  case M6502ISD::CMovFP_T:
-    return performCMovFPCombine(N, DAG, DCI, Subtarget);
-  case ISD::AND:
-    return performANDCombine(N, DAG, DCI, Subtarget);
-  case ISD::OR:
-    return performORCombine(N, DAG, DCI, Subtarget);
-  case ISD::ADD:
-    return performADDCombine(N, DAG, DCI, Subtarget);
-  case ISD::SHL:
-    return performSHLCombine(N, DAG, DCI, Subtarget);
-  case ISD::SUB:
-    return performSUBCombine(N, DAG, DCI, Subtarget);
-  }
-
-  return SDValue();
-}
-
-bool M6502TargetLowering::isCheapToSpeculateCttz() const {
-  return Subtarget.hasM650232();
-}
-
-bool M6502TargetLowering::isCheapToSpeculateCtlz() const {
-  return Subtarget.hasM650232();
-}
-
-void
-M6502TargetLowering::LowerOperationWrapper(SDNode *N,
-                                          SmallVectorImpl<SDValue> &Results,
-                                          SelectionDAG &DAG) const {
-  SDValue Res = LowerOperation(SDValue(N, 0), DAG);
-
-  for (unsigned I = 0, E = Res->getNumValues(); I != E; ++I)
-    Results.push_back(Res.getValue(I));
-}
-
-void
-M6502TargetLowering::ReplaceNodeResults(SDNode *N,
-                                       SmallVectorImpl<SDValue> &Results,
-                                       SelectionDAG &DAG) const {
-  return LowerOperationWrapper(N, Results, DAG);
-}
-
-SDValue M6502TargetLowering::
-LowerOperation(SDValue Op, SelectionDAG &DAG) const
-{
-  switch (Op.getOpcode())
-  {
-  case ISD::BRCOND:             return lowerBRCOND(Op, DAG);
-  case ISD::ConstantPool:       return lowerConstantPool(Op, DAG);
-  case ISD::GlobalAddress:      return lowerGlobalAddress(Op, DAG);
-  case ISD::BlockAddress:       return lowerBlockAddress(Op, DAG);
-  case ISD::GlobalTLSAddress:   return lowerGlobalTLSAddress(Op, DAG);
-  case ISD::JumpTable:          return lowerJumpTable(Op, DAG);
-  case ISD::SELECT:             return lowerSELECT(Op, DAG);
-  case ISD::SETCC:              return lowerSETCC(Op, DAG);
-  case ISD::VASTART:            return lowerVASTART(Op, DAG);
-  case ISD::VAARG:              return lowerVAARG(Op, DAG);
-  case ISD::FCOPYSIGN:          return lowerFCOPYSIGN(Op, DAG);
-  case ISD::FRAMEADDR:          return lowerFRAMEADDR(Op, DAG);
-  case ISD::RETURNADDR:         return lowerRETURNADDR(Op, DAG);
-  case ISD::EH_RETURN:          return lowerEH_RETURN(Op, DAG);
-  case ISD::ATOMIC_FENCE:       return lowerATOMIC_FENCE(Op, DAG);
-  case ISD::SHL_PARTS:          return lowerShiftLeftParts(Op, DAG);
-  case ISD::SRA_PARTS:          return lowerShiftRightParts(Op, DAG, true);
-  case ISD::SRL_PARTS:          return lowerShiftRightParts(Op, DAG, false);
-  case ISD::LOAD:               return lowerLOAD(Op, DAG);
-  case ISD::STORE:              return lowerSTORE(Op, DAG);
-  case ISD::EH_DWARF_CFA:       return lowerEH_DWARF_CFA(Op, DAG);
-  case ISD::FP_TO_SINT:         return lowerFP_TO_SINT(Op, DAG);
+  SDLoc DL(N);
+  SDValue X = N->getOperand(0);
+  SDValue Q = Div.build(DAG, DL, X);
+  if (IsRem)
+    return DAG.getNode(ISD::SUB, DL, MVT::i8, X, Mul.build(DAG, DL, Q));
+  if (Divisor < 0)
+    return DAG.getNode(ISD::SUB, DL, MVT::i8, DAG.getConstant(0, DL, MVT::i8),
+                       Q);
+  return Q;
+}
+
+SDValue M6502TargetLowering::PerformDAGCombine(SDNode *N,
+                                               DAGCombinerInfo &DCI) const {
+  switch (N->getOpcode()) {
+  case ISD::MUL:
+    return performMULCombine(N, DCI.DAG);
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM:
+    return performDivRemCombine(N, DCI.DAG);
   }
   return SDValue();
 }
@@ -1264,928 +547,670 @@ addLiveIn(MachineFunction &MF, unsigned PReg, const TargetRegisterClass *RC)
   return VReg;
 }
 
-static MachineBasicBlock *insertDivByZeroTrap(MachineInstr &MI,
-                                              MachineBasicBlock &MBB,
-                                              const TargetInstrInfo &TII,
-                                              bool Is64Bit, bool IsMicroM6502) {
-  if (NoZeroDivCheck)
-    return &MBB;
-
-  // Insert instruction "teq $divisor_reg, $zero, 7".
-  MachineBasicBlock::iterator I(MI);
-  MachineInstrBuilder MIB;
-  MachineOperand &Divisor = MI.getOperand(2);
-  MIB = BuildMI(MBB, std::next(I), MI.getDebugLoc(),
-                TII.get(IsMicroM6502 ? M6502::TEQ_MM : M6502::TEQ))
-            .addReg(Divisor.getReg(), getKillRegState(Divisor.isKill()))
-            .addReg(M6502::ZERO)
-            .addImm(7);
-
-  // Use the 32-bit sub-register if this is a 64-bit division.
-  if (Is64Bit)
-    MIB->getOperand(0).setSubReg(M6502::sub_32);
-
-  // Clear Divisor's kill flag.
-  Divisor.setIsKill(false);
-
-  // We would normally delete the original instruction here but in this case
-  // we only needed to inject an additional instruction rather than replace it.
-
-  return &MBB;
-}
-
 MachineBasicBlock *
 M6502TargetLowering::EmitInstrWithCustomInserter(MachineInstr &MI,
                                                 MachineBasicBlock *BB) const {
   switch (MI.getOpcode()) {
   default:
     llvm_unreachable("Unexpected instr type to insert");
-  case M6502::ATOMIC_LOAD_ADD_I8:
-    return emitAtomicBinaryPartword(MI, BB, 1, M6502::ADDu);
-  case M6502::ATOMIC_LOAD_ADD_I16:
-    return emitAtomicBinaryPartword(MI, BB, 2, M6502::ADDu);
-  case M6502::ATOMIC_LOAD_ADD_I32:
-    return emitAtomicBinary(MI, BB, 4, M6502::ADDu);
-  case M6502::ATOMIC_LOAD_ADD_I64:
-    return emitAtomicBinary(MI, BB, 8, M6502::DADDu);
-
-  case M6502::ATOMIC_LOAD_AND_I8:
-    return emitAtomicBinaryPartword(MI, BB, 1, M6502::AND);
-  case M6502::ATOMIC_LOAD_AND_I16:
-    return emitAtomicBinaryPartword(MI, BB, 2, M6502::AND);
-  case M6502::ATOMIC_LOAD_AND_I32:
-    return emitAtomicBinary(MI, BB, 4, M6502::AND);
-  case M6502::ATOMIC_LOAD_AND_I64:
-    return emitAtomicBinary(MI, BB, 8, M6502::AND64);
-
-  case M6502::ATOMIC_LOAD_OR_I8:
-    return emitAtomicBinaryPartword(MI, BB, 1, M6502::OR);
-  case M6502::ATOMIC_LOAD_OR_I16:
-    return emitAtomicBinaryPartword(MI, BB, 2, M6502::OR);
-  case M6502::ATOMIC_LOAD_OR_I32:
-    return emitAtomicBinary(MI, BB, 4, M6502::OR);
-  case M6502::ATOMIC_LOAD_OR_I64:
-    return emitAtomicBinary(MI, BB, 8, M6502::OR64);
-
-  case M6502::ATOMIC_LOAD_XOR_I8:
-    return emitAtomicBinaryPartword(MI, BB, 1, M6502::XOR);
-  case M6502::ATOMIC_LOAD_XOR_I16:
-    return emitAtomicBinaryPartword(MI, BB, 2, M6502::XOR);
-  case M6502::ATOMIC_LOAD_XOR_I32:
-    return emitAtomicBinary(MI, BB, 4, M6502::XOR);
-  case M6502::ATOMIC_LOAD_XOR_I64:
-    return emitAtomicBinary(MI, BB, 8, M6502::XOR64);
-
-  case M6502::ATOMIC_LOAD_NAND_I8:
-    return emitAtomicBinaryPartword(MI, BB, 1, 0, true);
-  case M6502::ATOMIC_LOAD_NAND_I16:
-    return emitAtomicBinaryPartword(MI, BB, 2, 0, true);
-  case M6502::ATOMIC_LOAD_NAND_I32:
-    return emitAtomicBinary(MI, BB, 4, 0, true);
-  case M6502::ATOMIC_LOAD_NAND_I64:
-    return emitAtomicBinary(MI, BB, 8, 0, true);
-
-  case M6502::ATOMIC_LOAD_SUB_I8:
-    return emitAtomicBinaryPartword(MI, BB, 1, M6502::SUBu);
-  case M6502::ATOMIC_LOAD_SUB_I16:
-    return emitAtomicBinaryPartword(MI, BB, 2, M6502::SUBu);
-  case M6502::ATOMIC_LOAD_SUB_I32:
-    return emitAtomicBinary(MI, BB, 4, M6502::SUBu);
-  case M6502::ATOMIC_LOAD_SUB_I64:
-    return emitAtomicBinary(MI, BB, 8, M6502::DSUBu);
-
-  case M6502::ATOMIC_SWAP_I8:
-    return emitAtomicBinaryPartword(MI, BB, 1, 0);
-  case M6502::ATOMIC_SWAP_I16:
-    return emitAtomicBinaryPartword(MI, BB, 2, 0);
-  case M6502::ATOMIC_SWAP_I32:
-    return emitAtomicBinary(MI, BB, 4, 0);
-  case M6502::ATOMIC_SWAP_I64:
-    return emitAtomicBinary(MI, BB, 8, 0);
-
-  case M6502::ATOMIC_CMP_SWAP_I8:
-    return emitAtomicCmpSwapPartword(MI, BB, 1);
-  case M6502::ATOMIC_CMP_SWAP_I16:
-    return emitAtomicCmpSwapPartword(MI, BB, 2);
-  case M6502::ATOMIC_CMP_SWAP_I32:
-    return emitAtomicCmpSwap(MI, BB, 4);
-  case M6502::ATOMIC_CMP_SWAP_I64:
-    return emitAtomicCmpSwap(MI, BB, 8);
-  case M6502::PseudoSDIV:
-  case M6502::PseudoUDIV:
-  case M6502::DIV:
-  case M6502::DIVU:
-  case M6502::MOD:
-  case M6502::MODU:
-    return insertDivByZeroTrap(MI, *BB, *Subtarget.getInstrInfo(), false,
-                               false);
-  case M6502::SDIV_MM_Pseudo:
-  case M6502::UDIV_MM_Pseudo:
-  case M6502::SDIV_MM:
-  case M6502::UDIV_MM:
-  case M6502::DIV_MMR6:
-  case M6502::DIVU_MMR6:
-  case M6502::MOD_MMR6:
-  case M6502::MODU_MMR6:
-    return insertDivByZeroTrap(MI, *BB, *Subtarget.getInstrInfo(), false, true);
-  case M6502::PseudoDSDIV:
-  case M6502::PseudoDUDIV:
-  case M6502::DDIV:
-  case M6502::DDIVU:
-  case M6502::DMOD:
-  case M6502::DMODU:
-    return insertDivByZeroTrap(MI, *BB, *Subtarget.getInstrInfo(), true, false);
-  case M6502::DDIV_MM64R6:
-  case M6502::DDIVU_MM64R6:
-  case M6502::DMOD_MM64R6:
-  case M6502::DMODU_MM64R6:
-    return insertDivByZeroTrap(MI, *BB, *Subtarget.getInstrInfo(), true, true);
-
-  case M6502::PseudoSELECT_I:
-  case M6502::PseudoSELECT_I64:
-  case M6502::PseudoSELECT_S:
-  case M6502::PseudoSELECT_D32:
-  case M6502::PseudoSELECT_D64:
-    return emitPseudoSELECT(MI, BB, false, M6502::BNE);
-  case M6502::PseudoSELECTFP_F_I:
-  case M6502::PseudoSELECTFP_F_I64:
-  case M6502::PseudoSELECTFP_F_S:
-  case M6502::PseudoSELECTFP_F_D32:
-  case M6502::PseudoSELECTFP_F_D64:
-    return emitPseudoSELECT(MI, BB, true, M6502::BC1F);
-  case M6502::PseudoSELECTFP_T_I:
-  case M6502::PseudoSELECTFP_T_I64:
-  case M6502::PseudoSELECTFP_T_S:
-  case M6502::PseudoSELECTFP_T_D32:
-  case M6502::PseudoSELECTFP_T_D64:
-    return emitPseudoSELECT(MI, BB, true, M6502::BC1T);
-  }
-}
-
-// This function also handles M6502::ATOMIC_SWAP_I32 (when BinOpcode == 0), and
-// M6502::ATOMIC_LOAD_NAND_I32 (when Nand == true)
-MachineBasicBlock *M6502TargetLowering::emitAtomicBinary(MachineInstr &MI,
-                                                        MachineBasicBlock *BB,
-                                                        unsigned Size,
-                                                        unsigned BinOpcode,
-                                                        bool Nand) const {
-  assert((Size == 4 || Size == 8) && "Unsupported size for EmitAtomicBinary.");
-
-  MachineFunction *MF = BB->getParent();
-  MachineRegisterInfo &RegInfo = MF->getRegInfo();
-  const TargetRegisterClass *RC = getRegClassFor(MVT::getIntegerVT(Size * 8));
+  case M6502::Select8:
+  case M6502::Select16:
+  case M6502::Select8W:
+  case M6502::Select16W:
+    return emitSelect(MI, BB);
+  case M6502::SHL8rr:
+  case M6502::SRL8rr:
+  case M6502::SRA8rr:
+  case M6502::SHL16rr:
+  case M6502::SRL16rr:
+  case M6502::SRA16rr:
+    return emitShift(MI, BB);
+  case M6502::MEMCPY:
+  case M6502::MEMSET:
+    return emitBlockOp(MI, BB);
+  }
+}
+
+MachineBasicBlock *M6502TargetLowering::emitSelect(MachineInstr &MI,
+                                                  MachineBasicBlock *BB) const {
   const TargetInstrInfo *TII = Subtarget.getInstrInfo();
-  const bool ArePtrs64bit = ABI.ArePtrs64bit();
   DebugLoc DL = MI.getDebugLoc();
-  unsigned LL, SC, AND, NOR, ZERO, BEQ;
-
-  if (Size == 4) {
-    if (isMicroM6502) {
-      LL = M6502::LL_MM;
-      SC = M6502::SC_MM;
-    } else {
-      LL = Subtarget.hasM650232r6()
-               ? (ArePtrs64bit ? M6502::LL64_R6 : M6502::LL_R6)
-               : (ArePtrs64bit ? M6502::LL64 : M6502::LL);
-      SC = Subtarget.hasM650232r6()
-               ? (ArePtrs64bit ? M6502::SC64_R6 : M6502::SC_R6)
-               : (ArePtrs64bit ? M6502::SC64 : M6502::SC);
-    }
-
-    AND = M6502::AND;
-    NOR = M6502::NOR;
-    ZERO = M6502::ZERO;
-    BEQ = M6502::BEQ;
-  } else {
-    LL = Subtarget.hasM650264r6() ? M6502::LLD_R6 : M6502::LLD;
-    SC = Subtarget.hasM650264r6() ? M6502::SCD_R6 : M6502::SCD;
-    AND = M6502::AND64;
-    NOR = M6502::NOR64;
-    ZERO = M6502::ZERO_64;
-    BEQ = M6502::BEQ64;
-  }
-
-  unsigned OldVal = MI.getOperand(0).getReg();
-  unsigned Ptr = MI.getOperand(1).getReg();
-  unsigned Incr = MI.getOperand(2).getReg();
 
-  unsigned StoreVal = RegInfo.createVirtualRegister(RC);
-  unsigned AndRes = RegInfo.createVirtualRegister(RC);
-  unsigned Success = RegInfo.createVirtualRegister(RC);
-
-  // insert new blocks after the current block
+  // To "insert" a SELECT instruction, we actually have to insert the
+  // diamond control-flow pattern.  The incoming instruction knows the
+  // destination vreg to set, the operands and condition code of the
+  // comparison, and the true/false values to select between.
   const BasicBlock *LLVM_BB = BB->getBasicBlock();
-  MachineBasicBlock *loopMBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *exitMBB = MF->CreateMachineBasicBlock(LLVM_BB);
   MachineFunction::iterator It = ++BB->getIterator();
-  MF->insert(It, loopMBB);
-  MF->insert(It, exitMBB);
-
-  // Transfer the remainder of BB and its successor edges to exitMBB.
-  exitMBB->splice(exitMBB->begin(), BB,
-                  std::next(MachineBasicBlock::iterator(MI)), BB->end());
-  exitMBB->transferSuccessorsAndUpdatePHIs(BB);
 
   //  thisMBB:
-  //    ...
-  //    fallthrough --> loopMBB
-  BB->addSuccessor(loopMBB);
-  loopMBB->addSuccessor(loopMBB);
-  loopMBB->addSuccessor(exitMBB);
-
-  //  loopMBB:
-  //    ll oldval, 0(ptr)
-  //    <binop> storeval, oldval, incr
-  //    sc success, storeval, 0(ptr)
-  //    beq success, $0, loopMBB
-  BB = loopMBB;
-  BuildMI(BB, DL, TII->get(LL), OldVal).addReg(Ptr).addImm(0);
-  if (Nand) {
-    //  and andres, oldval, incr
-    //  nor storeval, $0, andres
-    BuildMI(BB, DL, TII->get(AND), AndRes).addReg(OldVal).addReg(Incr);
-    BuildMI(BB, DL, TII->get(NOR), StoreVal).addReg(ZERO).addReg(AndRes);
-  } else if (BinOpcode) {
-    //  <binop> storeval, oldval, incr
-    BuildMI(BB, DL, TII->get(BinOpcode), StoreVal).addReg(OldVal).addReg(Incr);
-  } else {
-    StoreVal = Incr;
-  }
-  BuildMI(BB, DL, TII->get(SC), Success).addReg(StoreVal).addReg(Ptr).addImm(0);
-  BuildMI(BB, DL, TII->get(BEQ)).addReg(Success).addReg(ZERO).addMBB(loopMBB);
+  //  ...
+  //   TrueVal = ...
+  //   BR8rr lhs, rhs, cc, sinkMBB
+  //   fallthrough --> copy0MBB
+  MachineBasicBlock *thisMBB  = BB;
+  MachineFunction *F = BB->getParent();
+  MachineBasicBlock *copy0MBB = F->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *sinkMBB  = F->CreateMachineBasicBlock(LLVM_BB);
+  F->insert(It, copy0MBB);
+  F->insert(It, sinkMBB);
 
-  MI.eraseFromParent(); // The instruction is gone now.
+  // Transfer the remainder of BB and its successor edges to sinkMBB.
+  sinkMBB->splice(sinkMBB->begin(), BB,
+                  std::next(MachineBasicBlock::iterator(MI)), BB->end());
+  sinkMBB->transferSuccessorsAndUpdatePHIs(BB);
 
-  return exitMBB;
-}
+  // Next, add the true and fallthrough blocks as its successors.
+  BB->addSuccessor(copy0MBB);
+  BB->addSuccessor(sinkMBB);
 
-MachineBasicBlock *M6502TargetLowering::emitSignExtendToI32InReg(
-    MachineInstr &MI, MachineBasicBlock *BB, unsigned Size, unsigned DstReg,
-    unsigned SrcReg) const {
-  const TargetInstrInfo *TII = Subtarget.getInstrInfo();
-  const DebugLoc &DL = MI.getDebugLoc();
+  bool IsWide = MI.getOpcode() == M6502::Select8W ||
+                MI.getOpcode() == M6502::Select16W;
+  BuildMI(BB, DL, TII->get(IsWide ? M6502::BR16rr : M6502::BR8rr))
+      .addReg(MI.getOperand(3).getReg())
+      .addReg(MI.getOperand(4).getReg())
+      .addImm(MI.getOperand(5).getImm())
+      .addMBB(sinkMBB);
 
-  if (Subtarget.hasM650232r2() && Size == 1) {
-    BuildMI(BB, DL, TII->get(M6502::SEB), DstReg).addReg(SrcReg);
-    return BB;
-  }
+  //  copy0MBB:
+  //   %FalseValue = ...
+  //   # fallthrough to sinkMBB
+  BB = copy0MBB;
 
-  if (Subtarget.hasM650232r2() && Size == 2) {
-    BuildMI(BB, DL, TII->get(M6502::SEH), DstReg).addReg(SrcReg);
-    return BB;
-  }
+  // Update machine-CFG edges
+  BB->addSuccessor(sinkMBB);
 
-  MachineFunction *MF = BB->getParent();
-  MachineRegisterInfo &RegInfo = MF->getRegInfo();
-  const TargetRegisterClass *RC = getRegClassFor(MVT::i32);
-  unsigned ScrReg = RegInfo.createVirtualRegister(RC);
+  //  sinkMBB:
+  //   %Result = phi [ %TrueValue, thisMBB ], [ %FalseValue, copy0MBB ]
+  //  ...
+  BB = sinkMBB;
 
-  assert(Size < 32);
-  int64_t ShiftImm = 32 - (Size * 8);
+  BuildMI(*BB, BB->begin(), DL, TII->get(M6502::PHI), MI.getOperand(0).getReg())
+      .addReg(MI.getOperand(1).getReg())
+      .addMBB(thisMBB)
+      .addReg(MI.getOperand(2).getReg())
+      .addMBB(copy0MBB);
 
-  BuildMI(BB, DL, TII->get(M6502::SLL), ScrReg).addReg(SrcReg).addImm(ShiftImm);
-  BuildMI(BB, DL, TII->get(M6502::SRA), DstReg).addReg(ScrReg).addImm(ShiftImm);
+  MI.eraseFromParent(); // The pseudo instruction is gone now.
 
   return BB;
 }
 
-MachineBasicBlock *M6502TargetLowering::emitAtomicBinaryPartword(
-    MachineInstr &MI, MachineBasicBlock *BB, unsigned Size, unsigned BinOpcode,
-    bool Nand) const {
-  assert((Size == 1 || Size == 2) &&
-         "Unsupported size for EmitAtomicBinaryPartial.");
-
-  MachineFunction *MF = BB->getParent();
-  MachineRegisterInfo &RegInfo = MF->getRegInfo();
-  const TargetRegisterClass *RC = getRegClassFor(MVT::i32);
-  const bool ArePtrs64bit = ABI.ArePtrs64bit();
-  const TargetRegisterClass *RCp =
-    getRegClassFor(ArePtrs64bit ? MVT::i64 : MVT::i32);
+MachineBasicBlock *M6502TargetLowering::emitShift(MachineInstr &MI,
+                                                 MachineBasicBlock *BB) const {
   const TargetInstrInfo *TII = Subtarget.getInstrInfo();
+  MachineRegisterInfo &MRI = BB->getParent()->getRegInfo();
   DebugLoc DL = MI.getDebugLoc();
+  unsigned Opc;
 
-  unsigned Dest = MI.getOperand(0).getReg();
-  unsigned Ptr = MI.getOperand(1).getReg();
-  unsigned Incr = MI.getOperand(2).getReg();
-
-  unsigned AlignedAddr = RegInfo.createVirtualRegister(RCp);
-  unsigned ShiftAmt = RegInfo.createVirtualRegister(RC);
-  unsigned Mask = RegInfo.createVirtualRegister(RC);
-  unsigned Mask2 = RegInfo.createVirtualRegister(RC);
-  unsigned NewVal = RegInfo.createVirtualRegister(RC);
-  unsigned OldVal = RegInfo.createVirtualRegister(RC);
-  unsigned Incr2 = RegInfo.createVirtualRegister(RC);
-  unsigned MaskLSB2 = RegInfo.createVirtualRegister(RCp);
-  unsigned PtrLSB2 = RegInfo.createVirtualRegister(RC);
-  unsigned MaskUpper = RegInfo.createVirtualRegister(RC);
-  unsigned AndRes = RegInfo.createVirtualRegister(RC);
-  unsigned BinOpRes = RegInfo.createVirtualRegister(RC);
-  unsigned MaskedOldVal0 = RegInfo.createVirtualRegister(RC);
-  unsigned StoreVal = RegInfo.createVirtualRegister(RC);
-  unsigned MaskedOldVal1 = RegInfo.createVirtualRegister(RC);
-  unsigned SrlRes = RegInfo.createVirtualRegister(RC);
-  unsigned Success = RegInfo.createVirtualRegister(RC);
-
-  unsigned LL, SC;
-  if (isMicroM6502) {
-    LL = M6502::LL_MM;
-    SC = M6502::SC_MM;
-  } else {
-    LL = Subtarget.hasM650232r6() ? (ArePtrs64bit ? M6502::LL64_R6 : M6502::LL_R6)
-                                 : (ArePtrs64bit ? M6502::LL64 : M6502::LL);
-    SC = Subtarget.hasM650232r6() ? (ArePtrs64bit ? M6502::SC64_R6 : M6502::SC_R6)
-                                 : (ArePtrs64bit ? M6502::SC64 : M6502::SC);
+  switch (MI.getOpcode()) {
+  default: llvm_unreachable("Unexpected shift!");
+  case M6502::SHL8rr:  Opc = M6502::SHL8ri;  break;
+  case M6502::SRL8rr:  Opc = M6502::SRL8ri;  break;
+  case M6502::SRA8rr:  Opc = M6502::SRA8ri;  break;
+  case M6502::SHL16rr: Opc = M6502::SHL16ri; break;
+  case M6502::SRL16rr: Opc = M6502::SRL16ri; break;
+  case M6502::SRA16rr: Opc = M6502::SRA16ri; break;
   }
 
-  // insert new blocks after the current block
+  // There is no shift by a variable amount, so shift by one bit in a loop
+  // counting the amount down to zero.
+  //
+  //  thisMBB:
+  //   BR8ri amt, 0, eq, exitMBB
+  //  loopMBB:
+  //   val = phi [src, thisMBB], [val2, loopMBB]
+  //   cnt = phi [amt, thisMBB], [cnt2, loopMBB]
+  //   val2 = shift val, 1
+  //   cnt2 = DEC8 cnt
+  //   BR8ri cnt2, 0, ne, loopMBB
+  //  exitMBB:
+  //   dst = phi [src, thisMBB], [val2, loopMBB]
   const BasicBlock *LLVM_BB = BB->getBasicBlock();
-  MachineBasicBlock *loopMBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *sinkMBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *exitMBB = MF->CreateMachineBasicBlock(LLVM_BB);
   MachineFunction::iterator It = ++BB->getIterator();
-  MF->insert(It, loopMBB);
-  MF->insert(It, sinkMBB);
-  MF->insert(It, exitMBB);
+  MachineFunction *F = BB->getParent();
+  MachineBasicBlock *thisMBB = BB;
+  MachineBasicBlock *loopMBB = F->CreateMachineBasicBlock(LLVM_BB);
+  MachineBasicBlock *exitMBB = F->CreateMachineBasicBlock(LLVM_BB);
+  F->insert(It, loopMBB);
+  F->insert(It, exitMBB);
 
-  // Transfer the remainder of BB and its successor edges to exitMBB.
   exitMBB->splice(exitMBB->begin(), BB,
                   std::next(MachineBasicBlock::iterator(MI)), BB->end());
   exitMBB->transferSuccessorsAndUpdatePHIs(BB);
 
   BB->addSuccessor(loopMBB);
+  BB->addSuccessor(exitMBB);
   loopMBB->addSuccessor(loopMBB);
-  loopMBB->addSuccessor(sinkMBB);
-  sinkMBB->addSuccessor(exitMBB);
-
-  //  thisMBB:
-  //    addiu   masklsb2,$0,-4                # 0xfffffffc
-  //    and     alignedaddr,ptr,masklsb2
-  //    andi    ptrlsb2,ptr,3
-  //    sll     shiftamt,ptrlsb2,3
-  //    ori     maskupper,$0,255               # 0xff
-  //    sll     mask,maskupper,shiftamt
-  //    nor     mask2,$0,mask
-  //    sll     incr2,incr,shiftamt
-
-  int64_t MaskImm = (Size == 1) ? 255 : 65535;
-  BuildMI(BB, DL, TII->get(ABI.GetPtrAddiuOp()), MaskLSB2)
-    .addReg(ABI.GetNullPtr()).addImm(-4);
-  BuildMI(BB, DL, TII->get(ABI.GetPtrAndOp()), AlignedAddr)
-    .addReg(Ptr).addReg(MaskLSB2);
-  BuildMI(BB, DL, TII->get(M6502::ANDi), PtrLSB2)
-      .addReg(Ptr, 0, ArePtrs64bit ? M6502::sub_32 : 0).addImm(3);
-  if (Subtarget.isLittle()) {
-    BuildMI(BB, DL, TII->get(M6502::SLL), ShiftAmt).addReg(PtrLSB2).addImm(3);
-  } else {
-    unsigned Off = RegInfo.createVirtualRegister(RC);
-    BuildMI(BB, DL, TII->get(M6502::XORi), Off)
-      .addReg(PtrLSB2).addImm((Size == 1) ? 3 : 2);
-    BuildMI(BB, DL, TII->get(M6502::SLL), ShiftAmt).addReg(Off).addImm(3);
-  }
-  BuildMI(BB, DL, TII->get(M6502::ORi), MaskUpper)
-    .addReg(M6502::ZERO).addImm(MaskImm);
-  BuildMI(BB, DL, TII->get(M6502::SLLV), Mask)
-    .addReg(MaskUpper).addReg(ShiftAmt);
-  BuildMI(BB, DL, TII->get(M6502::NOR), Mask2).addReg(M6502::ZERO).addReg(Mask);
-  BuildMI(BB, DL, TII->get(M6502::SLLV), Incr2).addReg(Incr).addReg(ShiftAmt);
-
-  // atomic.load.binop
-  // loopMBB:
-  //   ll      oldval,0(alignedaddr)
-  //   binop   binopres,oldval,incr2
-  //   and     newval,binopres,mask
-  //   and     maskedoldval0,oldval,mask2
-  //   or      storeval,maskedoldval0,newval
-  //   sc      success,storeval,0(alignedaddr)
-  //   beq     success,$0,loopMBB
-
-  // atomic.swap
-  // loopMBB:
-  //   ll      oldval,0(alignedaddr)
-  //   and     newval,incr2,mask
-  //   and     maskedoldval0,oldval,mask2
-  //   or      storeval,maskedoldval0,newval
-  //   sc      success,storeval,0(alignedaddr)
-  //   beq     success,$0,loopMBB
-
-  BB = loopMBB;
-  BuildMI(BB, DL, TII->get(LL), OldVal).addReg(AlignedAddr).addImm(0);
-  if (Nand) {
-    //  and andres, oldval, incr2
-    //  nor binopres, $0, andres
-    //  and newval, binopres, mask
-    BuildMI(BB, DL, TII->get(M6502::AND), AndRes).addReg(OldVal).addReg(Incr2);
-    BuildMI(BB, DL, TII->get(M6502::NOR), BinOpRes)
-      .addReg(M6502::ZERO).addReg(AndRes);
-    BuildMI(BB, DL, TII->get(M6502::AND), NewVal).addReg(BinOpRes).addReg(Mask);
-  } else if (BinOpcode) {
-    //  <binop> binopres, oldval, incr2
-    //  and newval, binopres, mask
-    BuildMI(BB, DL, TII->get(BinOpcode), BinOpRes).addReg(OldVal).addReg(Incr2);
-    BuildMI(BB, DL, TII->get(M6502::AND), NewVal).addReg(BinOpRes).addReg(Mask);
-  } else { // atomic.swap
-    //  and newval, incr2, mask
-    BuildMI(BB, DL, TII->get(M6502::AND), NewVal).addReg(Incr2).addReg(Mask);
-  }
-
-  BuildMI(BB, DL, TII->get(M6502::AND), MaskedOldVal0)
-    .addReg(OldVal).addReg(Mask2);
-  BuildMI(BB, DL, TII->get(M6502::OR), StoreVal)
-    .addReg(MaskedOldVal0).addReg(NewVal);
-  BuildMI(BB, DL, TII->get(SC), Success)
-    .addReg(StoreVal).addReg(AlignedAddr).addImm(0);
-  BuildMI(BB, DL, TII->get(M6502::BEQ))
-    .addReg(Success).addReg(M6502::ZERO).addMBB(loopMBB);
-
-  //  sinkMBB:
-  //    and     maskedoldval1,oldval,mask
-  //    srl     srlres,maskedoldval1,shiftamt
-  //    sign_extend dest,srlres
-  BB = sinkMBB;
+  loopMBB->addSuccessor(exitMBB);
 
-  BuildMI(BB, DL, TII->get(M6502::AND), MaskedOldVal1)
-    .addReg(OldVal).addReg(Mask);
-  BuildMI(BB, DL, TII->get(M6502::SRLV), SrlRes)
-      .addReg(MaskedOldVal1).addReg(ShiftAmt);
-  BB = emitSignExtendToI32InReg(MI, BB, Size, Dest, SrlRes);
+  unsigned DstReg = MI.getOperand(0).getReg();
+  unsigned SrcReg = MI.getOperand(1).getReg();
+  unsigned AmtReg = MI.getOperand(2).getReg();
+  const TargetRegisterClass *RC = MRI.getRegClass(DstReg);
+  unsigned ValReg = MRI.createVirtualRegister(RC);
+  unsigned Val2Reg = MRI.createVirtualRegister(RC);
+  unsigned CntReg = MRI.createVirtualRegister(&M6502::ZP8RegClass);
+  unsigned Cnt2Reg = MRI.createVirtualRegister(&M6502::ZP8RegClass);
+
+  BuildMI(thisMBB, DL, TII->get(M6502::BR8ri))
+      .addReg(AmtReg)
+      .addImm(0)
+      .addImm(M6502CC::COND_EQ)
+      .addMBB(exitMBB);
+
+  BuildMI(loopMBB, DL, TII->get(M6502::PHI), ValReg)
+      .addReg(SrcReg)
+      .addMBB(thisMBB)
+      .addReg(Val2Reg)
+      .addMBB(loopMBB);
+  BuildMI(loopMBB, DL, TII->get(M6502::PHI), CntReg)
+      .addReg(AmtReg)
+      .addMBB(thisMBB)
+      .addReg(Cnt2Reg)
+      .addMBB(loopMBB);
+  BuildMI(loopMBB, DL, TII->get(Opc), Val2Reg).addReg(ValReg).addImm(1);
+  BuildMI(loopMBB, DL, TII->get(M6502::DEC8), Cnt2Reg).addReg(CntReg);
+  BuildMI(loopMBB, DL, TII->get(M6502::BR8ri))
+      .addReg(Cnt2Reg)
+      .addImm(0)
+      .addImm(M6502CC::COND_NE)
+      .addMBB(loopMBB);
+
+  BuildMI(*exitMBB, exitMBB->begin(), DL, TII->get(M6502::PHI), DstReg)
+      .addReg(SrcReg)
+      .addMBB(thisMBB)
+      .addReg(Val2Reg)
+      .addMBB(loopMBB);
 
-  MI.eraseFromParent(); // The instruction is gone now.
+  MI.eraseFromParent(); // The pseudo instruction is gone now.
 
   return exitMBB;
 }
 
-MachineBasicBlock *M6502TargetLowering::emitAtomicCmpSwap(MachineInstr &MI,
-                                                         MachineBasicBlock *BB,
-                                                         unsigned Size) const {
-  assert((Size == 4 || Size == 8) && "Unsupported size for EmitAtomicCmpSwap.");
-
-  MachineFunction *MF = BB->getParent();
-  MachineRegisterInfo &RegInfo = MF->getRegInfo();
-  const TargetRegisterClass *RC = getRegClassFor(MVT::getIntegerVT(Size * 8));
-  const TargetInstrInfo *TII = Subtarget.getInstrInfo();
-  const bool ArePtrs64bit = ABI.ArePtrs64bit();
-  DebugLoc DL = MI.getDebugLoc();
-  unsigned LL, SC, ZERO, BNE, BEQ;
-
-  if (Size == 4) {
-    if (isMicroM6502) {
-      LL = M6502::LL_MM;
-      SC = M6502::SC_MM;
-    } else {
-      LL = Subtarget.hasM650232r6()
-               ? (ArePtrs64bit ? M6502::LL64_R6 : M6502::LL_R6)
-               : (ArePtrs64bit ? M6502::LL64 : M6502::LL);
-      SC = Subtarget.hasM650232r6()
-               ? (ArePtrs64bit ? M6502::SC64_R6 : M6502::SC_R6)
-               : (ArePtrs64bit ? M6502::SC64 : M6502::SC);
-    }
+namespace {
 
-    ZERO = M6502::ZERO;
-    BNE = M6502::BNE;
-    BEQ = M6502::BEQ;
-  } else {
-    LL = Subtarget.hasM650264r6() ? M6502::LLD_R6 : M6502::LLD;
-    SC = Subtarget.hasM650264r6() ? M6502::SCD_R6 : M6502::SCD;
-    ZERO = M6502::ZERO_64;
-    BNE = M6502::BNE64;
-    BEQ = M6502::BEQ64;
-  }
+  /// The address of an operand of a block copy or fill: a constant one,
+  /// which is indexed by X, or a register pair, through which Y indexes.
+  struct BlockAddr {
+    const MachineOperand *Abs;
+    unsigned Reg;
+  };
 
-  unsigned Dest = MI.getOperand(0).getReg();
-  unsigned Ptr = MI.getOperand(1).getReg();
-  unsigned OldVal = MI.getOperand(2).getReg();
-  unsigned NewVal = MI.getOperand(3).getReg();
+} // end anonymous namespace
 
-  unsigned Success = RegInfo.createVirtualRegister(RC);
+/// Return the constant address Reg is loaded with, if it can be accessed as
+/// Size bytes with abs,X or zp,X from one byte before it, or null.
+static const MachineOperand *getBlockAbsAddr(const MachineRegisterInfo &MRI,
+                                             unsigned Reg, unsigned Size) {
+  const MachineInstr *Def = MRI.getVRegDef(Reg);
+  if (!Def || (Def->getOpcode() != M6502::LDaddr16 &&
+               Def->getOpcode() != M6502::LDimm16))
+    return nullptr;
 
-  // insert new blocks after the current block
-  const BasicBlock *LLVM_BB = BB->getBasicBlock();
-  MachineBasicBlock *loop1MBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *loop2MBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *exitMBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineFunction::iterator It = ++BB->getIterator();
-  MF->insert(It, loop1MBB);
-  MF->insert(It, loop2MBB);
-  MF->insert(It, exitMBB);
+  // An index from the byte before the address must not wrap in the zero
+  // page when the address is just above it.
+  const MachineOperand &MO = Def->getOperand(1);
+  if (MO.isImm())
+    return MO.getImm() > 0x100 || MO.getImm() + Size <= 0x100 ? &MO
+                                                              : nullptr;
+  return MO.isGlobal() || MO.isSymbol() || MO.isCPI() ? &MO : nullptr;
+}
 
-  // Transfer the remainder of BB and its successor edges to exitMBB.
-  exitMBB->splice(exitMBB->begin(), BB,
-                  std::next(MachineBasicBlock::iterator(MI)), BB->end());
-  exitMBB->transferSuccessorsAndUpdatePHIs(BB);
+static MachineOperand getOffsetAddr(const MachineOperand &MO, int64_t Offset) {
+  MachineOperand Addr = MO;
 
-  //  thisMBB:
-  //    ...
-  //    fallthrough --> loop1MBB
-  BB->addSuccessor(loop1MBB);
-  loop1MBB->addSuccessor(exitMBB);
-  loop1MBB->addSuccessor(loop2MBB);
-  loop2MBB->addSuccessor(loop1MBB);
-  loop2MBB->addSuccessor(exitMBB);
-
-  // loop1MBB:
-  //   ll dest, 0(ptr)
-  //   bne dest, oldval, exitMBB
-  BB = loop1MBB;
-  BuildMI(BB, DL, TII->get(LL), Dest).addReg(Ptr).addImm(0);
-  BuildMI(BB, DL, TII->get(BNE))
-    .addReg(Dest).addReg(OldVal).addMBB(exitMBB);
-
-  // loop2MBB:
-  //   sc success, newval, 0(ptr)
-  //   beq success, $0, loop1MBB
-  BB = loop2MBB;
-  BuildMI(BB, DL, TII->get(SC), Success)
-    .addReg(NewVal).addReg(Ptr).addImm(0);
-  BuildMI(BB, DL, TII->get(BEQ))
-    .addReg(Success).addReg(ZERO).addMBB(loop1MBB);
-
-  MI.eraseFromParent(); // The instruction is gone now.
+  if (MO.isImm())
+    Addr.setImm((MO.getImm() + Offset) & 0xffff);
+  else
+    Addr.setOffset(MO.getOffset() + Offset);
+  return Addr;
+}
+
+/// Emit the copy of the byte at Src + Offset + Idx to Dst + Offset + Idx at
+/// the end of MBB, or the store of Val when Src is null.  Offset must be 0
+/// for the register addresses.
+static void emitBlockByte(MachineBasicBlock *MBB, const DebugLoc &DL,
+                          const TargetInstrInfo *TII, MachineRegisterInfo &MRI,
+                          const BlockAddr &Dst, const BlockAddr *Src,
+                          unsigned Val, unsigned Idx, int64_t Offset) {
+  if (Src) {
+    Val = MRI.createVirtualRegister(&M6502::ZP8RegClass);
+    if (Src->Abs)
+      BuildMI(MBB, DL, TII->get(M6502::LD8absx), Val)
+          .add(getOffsetAddr(*Src->Abs, Offset))
+          .addReg(Idx);
+    else
+      BuildMI(MBB, DL, TII->get(M6502::LD8idx), Val)
+          .addReg(Src->Reg)
+          .addReg(Idx);
+  }
 
-  return exitMBB;
+  if (Dst.Abs)
+    BuildMI(MBB, DL, TII->get(M6502::ST8absx))
+        .addReg(Val)
+        .add(getOffsetAddr(*Dst.Abs, Offset))
+        .addReg(Idx);
+  else
+    BuildMI(MBB, DL, TII->get(M6502::ST8idx))
+        .addReg(Val)
+        .addReg(Dst.Reg)
+        .addReg(Idx);
 }
 
-MachineBasicBlock *M6502TargetLowering::emitAtomicCmpSwapPartword(
-    MachineInstr &MI, MachineBasicBlock *BB, unsigned Size) const {
-  assert((Size == 1 || Size == 2) &&
-      "Unsupported size for EmitAtomicCmpSwapPartial.");
-
-  MachineFunction *MF = BB->getParent();
-  MachineRegisterInfo &RegInfo = MF->getRegInfo();
-  const TargetRegisterClass *RC = getRegClassFor(MVT::i32);
-  const bool ArePtrs64bit = ABI.ArePtrs64bit();
-  const TargetRegisterClass *RCp =
-    getRegClassFor(ArePtrs64bit ? MVT::i64 : MVT::i32);
+/// The number of pages copied or filled by a single abs,X loop, with a load
+/// and store for each page.
+static const unsigned MaxBlockAbsPages = 4;
+
+/// The largest block copied or filled by a load and store for each byte
+/// rather than a loop, which costs more than twice as many cycles a byte.
+static const unsigned MaxBlockUnrolled = 8;
+static const unsigned MaxBlockUnrolledOptSize = 2;
+
+MachineBasicBlock *M6502TargetLowering::emitBlockOp(
+    MachineInstr &MI, MachineBasicBlock *BB) const {
   const TargetInstrInfo *TII = Subtarget.getInstrInfo();
+  MachineFunction *F = BB->getParent();
+  MachineRegisterInfo &MRI = F->getRegInfo();
   DebugLoc DL = MI.getDebugLoc();
 
-  unsigned Dest = MI.getOperand(0).getReg();
-  unsigned Ptr = MI.getOperand(1).getReg();
-  unsigned CmpVal = MI.getOperand(2).getReg();
-  unsigned NewVal = MI.getOperand(3).getReg();
-
-  unsigned AlignedAddr = RegInfo.createVirtualRegister(RCp);
-  unsigned ShiftAmt = RegInfo.createVirtualRegister(RC);
-  unsigned Mask = RegInfo.createVirtualRegister(RC);
-  unsigned Mask2 = RegInfo.createVirtualRegister(RC);
-  unsigned ShiftedCmpVal = RegInfo.createVirtualRegister(RC);
-  unsigned OldVal = RegInfo.createVirtualRegister(RC);
-  unsigned MaskedOldVal0 = RegInfo.createVirtualRegister(RC);
-  unsigned ShiftedNewVal = RegInfo.createVirtualRegister(RC);
-  unsigned MaskLSB2 = RegInfo.createVirtualRegister(RCp);
-  unsigned PtrLSB2 = RegInfo.createVirtualRegister(RC);
-  unsigned MaskUpper = RegInfo.createVirtualRegister(RC);
-  unsigned MaskedCmpVal = RegInfo.createVirtualRegister(RC);
-  unsigned MaskedNewVal = RegInfo.createVirtualRegister(RC);
-  unsigned MaskedOldVal1 = RegInfo.createVirtualRegister(RC);
-  unsigned StoreVal = RegInfo.createVirtualRegister(RC);
-  unsigned SrlRes = RegInfo.createVirtualRegister(RC);
-  unsigned Success = RegInfo.createVirtualRegister(RC);
-  unsigned LL, SC;
-
-  if (isMicroM6502) {
-    LL = M6502::LL_MM;
-    SC = M6502::SC_MM;
-  } else {
-    LL = Subtarget.hasM650232r6() ? (ArePtrs64bit ? M6502::LL64_R6 : M6502::LL_R6)
-                                 : (ArePtrs64bit ? M6502::LL64 : M6502::LL);
-    SC = Subtarget.hasM650232r6() ? (ArePtrs64bit ? M6502::SC64_R6 : M6502::SC_R6)
-                                 : (ArePtrs64bit ? M6502::SC64 : M6502::SC);
+  bool IsSet = MI.getOpcode() == M6502::MEMSET;
+  unsigned Size = MI.getOperand(2).getImm();
+  unsigned Pages = Size >> 8, Rest = Size & 0xff;
+  BlockAddr Dst = {getBlockAbsAddr(MRI, MI.getOperand(0).getReg(), Size),
+                   MI.getOperand(0).getReg()};
+  BlockAddr Src = {nullptr, 0};
+  unsigned Val = 0;
+  if (IsSet)
+    Val = MI.getOperand(1).getReg();
+  else
+    Src = {getBlockAbsAddr(MRI, MI.getOperand(1).getReg(), Size),
+           MI.getOperand(1).getReg()};
+
+  // The loads of the constant addresses are dead once they are folded.
+  auto eraseDeadAddrs = [&]() {
+    for (const BlockAddr *Addr : {&Dst, &Src})
+      if (Addr->Abs && MRI.use_nodbg_empty(Addr->Reg))
+        if (MachineInstr *Def = MRI.getVRegDef(Addr->Reg))
+          Def->eraseFromParent();
+  };
+
+  // A short block is done byte by byte, with absolute or (zp),Y addressing.
+  if (Size <= (F->getFunction()->optForSize() ? MaxBlockUnrolledOptSize
+                                               : MaxBlockUnrolled)) {
+    for (unsigned Byte = 0; Byte != Size; ++Byte) {
+      unsigned ByteVal = Val;
+      if (!IsSet) {
+        ByteVal = MRI.createVirtualRegister(&M6502::ZP8RegClass);
+        if (Src.Abs)
+          BuildMI(*BB, MI, DL, TII->get(M6502::LD8abs), ByteVal)
+              .add(getOffsetAddr(*Src.Abs, Byte));
+        else
+          BuildMI(*BB, MI, DL, TII->get(M6502::LD8), ByteVal)
+              .addReg(Src.Reg)
+              .addImm(Byte);
+      }
+      if (Dst.Abs)
+        BuildMI(*BB, MI, DL, TII->get(M6502::ST8abs))
+            .addReg(ByteVal)
+            .add(getOffsetAddr(*Dst.Abs, Byte));
+      else
+        BuildMI(*BB, MI, DL, TII->get(M6502::ST8))
+            .addReg(ByteVal)
+            .addReg(Dst.Reg)
+            .addImm(Byte);
+    }
+    MI.eraseFromParent();
+    eraseDeadAddrs();
+    return BB;
   }
 
-  // insert new blocks after the current block
-  const BasicBlock *LLVM_BB = BB->getBasicBlock();
-  MachineBasicBlock *loop1MBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *loop2MBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *sinkMBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *exitMBB = MF->CreateMachineBasicBlock(LLVM_BB);
-  MachineFunction::iterator It = ++BB->getIterator();
-  MF->insert(It, loop1MBB);
-  MF->insert(It, loop2MBB);
-  MF->insert(It, sinkMBB);
-  MF->insert(It, exitMBB);
+  // Whole pages are done by a loop counting a byte index up from 0 until it
+  // wraps, and the rest by one counting down to 0, which addresses the
+  // operands from the byte before them.  A constant address is indexed by
+  // X, with the address of each page in its own load or store.  A register
+  // pair is indexed by Y, and moved to the next page by an outer loop, so
+  // both operands use one when either does.
+  //
+  //  thisMBB:
+  //   zero = LDimm8 0
+  //  pageMBB:
+  //   idx = phi [zero, thisMBB], [idx2, pageMBB]
+  //   LD8absx src + 256 * p, idx; ST8absx dst + 256 * p, idx  (each page p)
+  //   idx2 = INC8 idx
+  //   BR8ri idx2, 0, ne, pageMBB
+  //  restMBB:
+  //   cnt = phi [rest, pageMBB], [cnt2, restMBB]
+  //   LD8absx src + 256 * pages - 1, cnt; ST8absx dst + 256 * pages - 1, cnt
+  //   cnt2 = DEC8 cnt
+  //   BR8ri cnt2, 0, ne, restMBB
+  //  exitMBB:
+  if (Pages && (!Dst.Abs || (!IsSet && !Src.Abs) ||
+                Pages > MaxBlockAbsPages))
+    Dst.Abs = Src.Abs = nullptr;
 
-  // Transfer the remainder of BB and its successor edges to exitMBB.
+  const BasicBlock *LLVM_BB = BB->getBasicBlock();
+  MachineBasicBlock *exitMBB = F->CreateMachineBasicBlock(LLVM_BB);
+  F->insert(++BB->getIterator(), exitMBB);
   exitMBB->splice(exitMBB->begin(), BB,
                   std::next(MachineBasicBlock::iterator(MI)), BB->end());
   exitMBB->transferSuccessorsAndUpdatePHIs(BB);
 
-  BB->addSuccessor(loop1MBB);
-  loop1MBB->addSuccessor(sinkMBB);
-  loop1MBB->addSuccessor(loop2MBB);
-  loop2MBB->addSuccessor(loop1MBB);
-  loop2MBB->addSuccessor(sinkMBB);
-  sinkMBB->addSuccessor(exitMBB);
-
-  // FIXME: computation of newval2 can be moved to loop2MBB.
-  //  thisMBB:
-  //    addiu   masklsb2,$0,-4                # 0xfffffffc
-  //    and     alignedaddr,ptr,masklsb2
-  //    andi    ptrlsb2,ptr,3
-  //    xori    ptrlsb2,ptrlsb2,3              # Only for BE
-  //    sll     shiftamt,ptrlsb2,3
-  //    ori     maskupper,$0,255               # 0xff
-  //    sll     mask,maskupper,shiftamt
-  //    nor     mask2,$0,mask
-  //    andi    maskedcmpval,cmpval,255
-  //    sll     shiftedcmpval,maskedcmpval,shiftamt
-  //    andi    maskednewval,newval,255
-  //    sll     shiftednewval,maskednewval,shiftamt
-  int64_t MaskImm = (Size == 1) ? 255 : 65535;
-  BuildMI(BB, DL, TII->get(ArePtrs64bit ? M6502::DADDiu : M6502::ADDiu), MaskLSB2)
-    .addReg(ABI.GetNullPtr()).addImm(-4);
-  BuildMI(BB, DL, TII->get(ArePtrs64bit ? M6502::AND64 : M6502::AND), AlignedAddr)
-    .addReg(Ptr).addReg(MaskLSB2);
-  BuildMI(BB, DL, TII->get(M6502::ANDi), PtrLSB2)
-      .addReg(Ptr, 0, ArePtrs64bit ? M6502::sub_32 : 0).addImm(3);
-  if (Subtarget.isLittle()) {
-    BuildMI(BB, DL, TII->get(M6502::SLL), ShiftAmt).addReg(PtrLSB2).addImm(3);
-  } else {
-    unsigned Off = RegInfo.createVirtualRegister(RC);
-    BuildMI(BB, DL, TII->get(M6502::XORi), Off)
-      .addReg(PtrLSB2).addImm((Size == 1) ? 3 : 2);
-    BuildMI(BB, DL, TII->get(M6502::SLL), ShiftAmt).addReg(Off).addImm(3);
-  }
-  BuildMI(BB, DL, TII->get(M6502::ORi), MaskUpper)
-    .addReg(M6502::ZERO).addImm(MaskImm);
-  BuildMI(BB, DL, TII->get(M6502::SLLV), Mask)
-    .addReg(MaskUpper).addReg(ShiftAmt);
-  BuildMI(BB, DL, TII->get(M6502::NOR), Mask2).addReg(M6502::ZERO).addReg(Mask);
-  BuildMI(BB, DL, TII->get(M6502::ANDi), MaskedCmpVal)
-    .addReg(CmpVal).addImm(MaskImm);
-  BuildMI(BB, DL, TII->get(M6502::SLLV), ShiftedCmpVal)
-    .addReg(MaskedCmpVal).addReg(ShiftAmt);
-  BuildMI(BB, DL, TII->get(M6502::ANDi), MaskedNewVal)
-    .addReg(NewVal).addImm(MaskImm);
-  BuildMI(BB, DL, TII->get(M6502::SLLV), ShiftedNewVal)
-    .addReg(MaskedNewVal).addReg(ShiftAmt);
-
-  //  loop1MBB:
-  //    ll      oldval,0(alginedaddr)
-  //    and     maskedoldval0,oldval,mask
-  //    bne     maskedoldval0,shiftedcmpval,sinkMBB
-  BB = loop1MBB;
-  BuildMI(BB, DL, TII->get(LL), OldVal).addReg(AlignedAddr).addImm(0);
-  BuildMI(BB, DL, TII->get(M6502::AND), MaskedOldVal0)
-    .addReg(OldVal).addReg(Mask);
-  BuildMI(BB, DL, TII->get(M6502::BNE))
-    .addReg(MaskedOldVal0).addReg(ShiftedCmpVal).addMBB(sinkMBB);
-
-  //  loop2MBB:
-  //    and     maskedoldval1,oldval,mask2
-  //    or      storeval,maskedoldval1,shiftednewval
-  //    sc      success,storeval,0(alignedaddr)
-  //    beq     success,$0,loop1MBB
-  BB = loop2MBB;
-  BuildMI(BB, DL, TII->get(M6502::AND), MaskedOldVal1)
-    .addReg(OldVal).addReg(Mask2);
-  BuildMI(BB, DL, TII->get(M6502::OR), StoreVal)
-    .addReg(MaskedOldVal1).addReg(ShiftedNewVal);
-  BuildMI(BB, DL, TII->get(SC), Success)
-      .addReg(StoreVal).addReg(AlignedAddr).addImm(0);
-  BuildMI(BB, DL, TII->get(M6502::BEQ))
-      .addReg(Success).addReg(M6502::ZERO).addMBB(loop1MBB);
-
-  //  sinkMBB:
-  //    srl     srlres,maskedoldval0,shiftamt
-  //    sign_extend dest,srlres
-  BB = sinkMBB;
-
-  BuildMI(BB, DL, TII->get(M6502::SRLV), SrlRes)
-      .addReg(MaskedOldVal0).addReg(ShiftAmt);
-  BB = emitSignExtendToI32InReg(MI, BB, Size, Dest, SrlRes);
+  MachineBasicBlock *PrevMBB = BB;
+  auto createBlock = [&]() {
+    MachineBasicBlock *MBB = F->CreateMachineBasicBlock(LLVM_BB);
+    F->insert(exitMBB->getIterator(), MBB);
+    return MBB;
+  };
+  auto createReg = [&](const TargetRegisterClass *RC) {
+    return MRI.createVirtualRegister(RC);
+  };
+  auto buildConst8 = [&](MachineBasicBlock *MBB, unsigned Imm) {
+    unsigned Reg = createReg(&M6502::ZP8RegClass);
+    BuildMI(MBB, DL, TII->get(M6502::LDimm8), Reg).addImm(Imm);
+    return Reg;
+  };
+  auto buildAdd16 = [&](MachineBasicBlock *MBB, unsigned Reg, int Imm) {
+    unsigned Sum = createReg(&M6502::ZP16RegClass);
+    if (Imm < 0)
+      BuildMI(MBB, DL, TII->get(M6502::SUB16ri), Sum).addReg(Reg).addImm(-Imm);
+    else
+      BuildMI(MBB, DL, TII->get(M6502::ADD16ri), Sum).addReg(Reg).addImm(Imm);
+    return Sum;
+  };
+  // Emit a loop of 256 iterations over Dst and Src.
+  auto buildPageLoop = [&](MachineBasicBlock *PredMBB, BlockAddr &PageDst,
+                           BlockAddr &PageSrc, unsigned NumPages) {
+    unsigned Zero = buildConst8(PredMBB, 0);
+    MachineBasicBlock *LoopMBB = createBlock();
+    PredMBB->addSuccessor(LoopMBB);
+    LoopMBB->addSuccessor(LoopMBB);
+
+    unsigned Idx = createReg(&M6502::ZP8RegClass);
+    unsigned Idx2 = createReg(&M6502::ZP8RegClass);
+    BuildMI(LoopMBB, DL, TII->get(M6502::PHI), Idx)
+        .addReg(Zero)
+        .addMBB(PredMBB)
+        .addReg(Idx2)
+        .addMBB(LoopMBB);
+    for (unsigned Page = 0; Page != NumPages; ++Page)
+      emitBlockByte(LoopMBB, DL, TII, MRI, PageDst, IsSet ? nullptr : &PageSrc,
+                    Val, Idx, Page * 256);
+    BuildMI(LoopMBB, DL, TII->get(M6502::INC8), Idx2).addReg(Idx);
+    BuildMI(LoopMBB, DL, TII->get(M6502::BR8ri))
+        .addReg(Idx2)
+        .addImm(0)
+        .addImm(M6502CC::COND_NE)
+        .addMBB(LoopMBB);
+    return LoopMBB;
+  };
+
+  // The rest is addressed from the byte before it, which is worked out for
+  // the register pairs before the page loops move them.
+  BlockAddr RestDst = Dst, RestSrc = Src;
+  int64_t RestOffset = int64_t(Pages) * 256 - 1;
+  if (Rest) {
+    if (!Dst.Abs)
+      RestDst.Reg = buildAdd16(BB, Dst.Reg, RestOffset);
+    if (!IsSet && !Src.Abs)
+      RestSrc.Reg = buildAdd16(BB, Src.Reg, RestOffset);
+  }
+
+  if (Pages == 1 || (Pages && Dst.Abs)) {
+    PrevMBB = buildPageLoop(PrevMBB, Dst, Src, Pages);
+  } else if (Pages) {
+    //  outerMBB:
+    //   dst = phi [dst0, thisMBB], [dst2, latchMBB]   (and src)
+    //   pages = phi [pages0, thisMBB], [pages2, latchMBB]
+    //  pageMBB: as above, with (dst),Y and (src),Y
+    //  latchMBB:
+    //   dst2 = ADD16ri dst, 256                        (and src)
+    //   pages2 = DEC8 pages
+    //   BR8ri pages2, 0, ne, outerMBB
+    unsigned Count = buildConst8(PrevMBB, Pages);
+    MachineBasicBlock *OuterMBB = createBlock();
+    PrevMBB->addSuccessor(OuterMBB);
+
+    BlockAddr PageDst = {nullptr, createReg(&M6502::ZP16RegClass)};
+    BlockAddr PageSrc = {nullptr, IsSet ? 0 : createReg(&M6502::ZP16RegClass)};
+    MachineBasicBlock *PageMBB = buildPageLoop(OuterMBB, PageDst, PageSrc, 1);
+    MachineBasicBlock *LatchMBB = createBlock();
+    PageMBB->addSuccessor(LatchMBB);
+    LatchMBB->addSuccessor(OuterMBB);
+
+    unsigned PageCount = createReg(&M6502::ZP8RegClass);
+    unsigned NextCount = createReg(&M6502::ZP8RegClass);
+    BuildMI(*OuterMBB, OuterMBB->begin(), DL, TII->get(M6502::PHI), PageCount)
+        .addReg(Count)
+        .addMBB(PrevMBB)
+        .addReg(NextCount)
+        .addMBB(LatchMBB);
+    BuildMI(*OuterMBB, OuterMBB->begin(), DL, TII->get(M6502::PHI),
+            PageDst.Reg)
+        .addReg(Dst.Reg)
+        .addMBB(PrevMBB)
+        .addReg(buildAdd16(LatchMBB, PageDst.Reg, 256))
+        .addMBB(LatchMBB);
+    if (!IsSet)
+      BuildMI(*OuterMBB, OuterMBB->begin(), DL, TII->get(M6502::PHI),
+              PageSrc.Reg)
+          .addReg(Src.Reg)
+          .addMBB(PrevMBB)
+          .addReg(buildAdd16(LatchMBB, PageSrc.Reg, 256))
+          .addMBB(LatchMBB);
+
+    BuildMI(LatchMBB, DL, TII->get(M6502::DEC8), NextCount).addReg(PageCount);
+    BuildMI(LatchMBB, DL, TII->get(M6502::BR8ri))
+        .addReg(NextCount)
+        .addImm(0)
+        .addImm(M6502CC::COND_NE)
+        .addMBB(OuterMBB);
+    PrevMBB = LatchMBB;
+  }
+
+  if (Rest) {
+    unsigned Count = buildConst8(BB, Rest);
+    MachineBasicBlock *LoopMBB = createBlock();
+    PrevMBB->addSuccessor(LoopMBB);
+    LoopMBB->addSuccessor(LoopMBB);
+
+    unsigned Cnt = createReg(&M6502::ZP8RegClass);
+    unsigned Cnt2 = createReg(&M6502::ZP8RegClass);
+    BuildMI(LoopMBB, DL, TII->get(M6502::PHI), Cnt)
+        .addReg(Count)
+        .addMBB(PrevMBB)
+        .addReg(Cnt2)
+        .addMBB(LoopMBB);
+    emitBlockByte(LoopMBB, DL, TII, MRI, RestDst, IsSet ? nullptr : &RestSrc,
+                  Val, Cnt, RestDst.Abs ? RestOffset : 0);
+    BuildMI(LoopMBB, DL, TII->get(M6502::DEC8), Cnt2).addReg(Cnt);
+    BuildMI(LoopMBB, DL, TII->get(M6502::BR8ri))
+        .addReg(Cnt2)
+        .addImm(0)
+        .addImm(M6502CC::COND_NE)
+        .addMBB(LoopMBB);
+    PrevMBB = LoopMBB;
+  }
+  PrevMBB->addSuccessor(exitMBB);
 
-  MI.eraseFromParent(); // The instruction is gone now.
+  MI.eraseFromParent(); // The pseudo instruction is gone now.
+  eraseDeadAddrs();
 
   return exitMBB;
 }
 
-SDValue M6502TargetLowering::lowerBRCOND(SDValue Op, SelectionDAG &DAG) const {
-  // The first operand is the chain, the second is the condition, the third is
-  // the block to branch to if the condition is true.
-  SDValue Chain = Op.getOperand(0);
-  SDValue Dest = Op.getOperand(2);
-  SDLoc DL(Op);
+//===----------------------------------------------------------------------===//
+//  Misc Lower Operation implementation
+//===----------------------------------------------------------------------===//
 
-  assert(!Subtarget.hasM650232r6() && !Subtarget.hasM650264r6());
-  SDValue CondRes = createFPCmp(DAG, Op.getOperand(1));
-
-  // Return if flag is not set by a floating point comparison.
-  if (CondRes.getOpcode() != M6502ISD::FPCmp)
-    return Op;
-
-  SDValue CCNode  = CondRes.getOperand(2);
-  M6502::CondCode CC =
-    (M6502::CondCode)cast<ConstantSDNode>(CCNode)->getZExtValue();
-  unsigned Opc = invertFPCondCodeUser(CC) ? M6502::BRANCH_F : M6502::BRANCH_T;
-  SDValue BrCode = DAG.getConstant(Opc, DL, MVT::i32);
-  SDValue FCC0 = DAG.getRegister(M6502::FCC0, MVT::i32);
-  return DAG.getNode(M6502ISD::FPBrcond, DL, Op.getValueType(), Chain, BrCode,
-                     FCC0, Dest, CondRes);
-}
+// The 6502 compares by subtracting, so after a CMP the carry flag holds the
+// result of an unsigned comparison and the zero flag the result of an
+// equality test.  Greater-than and less-or-equal are handled by swapping the
+// operands, and signed comparisons by flipping the sign bits so that they
+// order like unsigned values.  Pairs are compared with a CMP/SBC chain, or
+// for equality by merging the differences of both bytes.
+M6502CC::CondCode
+M6502TargetLowering::getM6502CC(ISD::CondCode CC, SDValue &LHS, SDValue &RHS,
+                                const SDLoc &DL, SelectionDAG &DAG) const {
+  EVT VT = LHS.getValueType();
+  unsigned Bits = VT.getSizeInBits();
+
+  // Keep constants on the right where they can become immediates.
+  if (isa<ConstantSDNode>(LHS) && !isa<ConstantSDNode>(RHS)) {
+    std::swap(LHS, RHS);
+    CC = ISD::getSetCCSwappedOperands(CC);
+  }
+
+  // A sign test only needs the N flag of the most significant byte.
+  if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(RHS)) {
+    bool IsNeg = (CC == ISD::SETLT && C->isNullValue()) ||
+                 (CC == ISD::SETLE && C->isAllOnesValue());
+    bool IsPos = (CC == ISD::SETGE && C->isNullValue()) ||
+                 (CC == ISD::SETGT && C->isAllOnesValue());
+    if (IsNeg || IsPos) {
+      if (Bits > 8)
+        LHS = DAG.getNode(ISD::TRUNCATE, DL, MVT::i8,
+                          DAG.getNode(ISD::SRL, DL, VT, LHS,
+                                      DAG.getConstant(Bits - 8, DL, MVT::i8)));
+      RHS = DAG.getConstant(0, DL, MVT::i8);
+      return IsNeg ? M6502CC::COND_MI : M6502CC::COND_PL;
+    }
+  }
 
-SDValue M6502TargetLowering::
-lowerSELECT(SDValue Op, SelectionDAG &DAG) const
-{
-  assert(!Subtarget.hasM650232r6() && !Subtarget.hasM650264r6());
-  SDValue Cond = createFPCmp(DAG, Op.getOperand(0));
+  if (ISD::isSignedIntSetCC(CC)) {
+    SDValue Bias = DAG.getConstant(APInt::getSignMask(Bits), DL, VT);
+    LHS = DAG.getNode(ISD::XOR, DL, LHS.getValueType(), LHS, Bias);
+    RHS = DAG.getNode(ISD::XOR, DL, RHS.getValueType(), RHS, Bias);
+    switch (CC) {
+    default: llvm_unreachable("Unknown signed condition code!");
+    case ISD::SETLT: CC = ISD::SETULT; break;
+    case ISD::SETLE: CC = ISD::SETULE; break;
+    case ISD::SETGT: CC = ISD::SETUGT; break;
+    case ISD::SETGE: CC = ISD::SETUGE; break;
+    }
+  }
 
-  // Return if flag is not set by a floating point comparison.
-  if (Cond.getOpcode() != M6502ISD::FPCmp)
-    return Op;
+  // x > c is x >= c + 1 and x <= c is x < c + 1, which saves the swap.
+  if (CC == ISD::SETUGT || CC == ISD::SETULE) {
+    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(RHS)) {
+      if (!C->isAllOnesValue()) {
+        RHS = DAG.getConstant(C->getAPIntValue() + 1, DL, VT);
+        CC = CC == ISD::SETUGT ? ISD::SETUGE : ISD::SETULT;
+      }
+    }
+  }
 
-  return createCMovFP(DAG, Cond, Op.getOperand(1), Op.getOperand(2),
-                      SDLoc(Op));
+  switch (CC) {
+  default: llvm_unreachable("Unknown condition code!");
+  case ISD::SETEQ:  return M6502CC::COND_EQ;
+  case ISD::SETNE:  return M6502CC::COND_NE;
+  case ISD::SETULT: return M6502CC::COND_LT;
+  case ISD::SETUGE: return M6502CC::COND_GE;
+  case ISD::SETUGT:
+    std::swap(LHS, RHS);
+    return M6502CC::COND_LT;
+  case ISD::SETULE:
+    std::swap(LHS, RHS);
+    return M6502CC::COND_GE;
+  }
 }
 
-SDValue M6502TargetLowering::lowerSETCC(SDValue Op, SelectionDAG &DAG) const {
-  assert(!Subtarget.hasM650232r6() && !Subtarget.hasM650264r6());
-  SDValue Cond = createFPCmp(DAG, Op);
+SDValue M6502TargetLowering::lowerBR_CC(SDValue Op, SelectionDAG &DAG) const {
+  SDValue Chain = Op.getOperand(0);
+  ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(1))->get();
+  SDValue LHS = Op.getOperand(2);
+  SDValue RHS = Op.getOperand(3);
+  SDValue Dest = Op.getOperand(4);
+  SDLoc DL(Op);
 
-  assert(Cond.getOpcode() == M6502ISD::FPCmp &&
-         "Floating point operand expected.");
+  M6502CC::CondCode M6502CC = getM6502CC(CC, LHS, RHS, DL, DAG);
+  return DAG.getNode(M6502ISD::BrCC, DL, MVT::Other, Chain, Dest,
+                     DAG.getTargetConstant(M6502CC, DL, MVT::i8), LHS, RHS);
+}
 
+SDValue M6502TargetLowering::lowerSELECT_CC(SDValue Op,
+                                            SelectionDAG &DAG) const {
+  SDValue LHS = Op.getOperand(0);
+  SDValue RHS = Op.getOperand(1);
+  SDValue TrueV = Op.getOperand(2);
+  SDValue FalseV = Op.getOperand(3);
+  ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(4))->get();
   SDLoc DL(Op);
-  SDValue True  = DAG.getConstant(1, DL, MVT::i32);
-  SDValue False = DAG.getConstant(0, DL, MVT::i32);
 
-  return createCMovFP(DAG, Cond, True, False, DL);
+  M6502CC::CondCode M6502CC = getM6502CC(CC, LHS, RHS, DL, DAG);
+  return DAG.getNode(M6502ISD::SelectCC, DL, Op.getValueType(), TrueV, FalseV,
+                     LHS, RHS, DAG.getTargetConstant(M6502CC, DL, MVT::i8));
 }
 
 SDValue M6502TargetLowering::lowerGlobalAddress(SDValue Op,
                                                SelectionDAG &DAG) const {
-  EVT Ty = Op.getValueType();
   GlobalAddressSDNode *N = cast<GlobalAddressSDNode>(Op);
-  const GlobalValue *GV = N->getGlobal();
-
-  if (!isPositionIndependent()) {
-    const M6502TargetObjectFile *TLOF =
-        static_cast<const M6502TargetObjectFile *>(
-            getTargetMachine().getObjFileLowering());
-    const GlobalObject *GO = GV->getBaseObject();
-    if (GO && TLOF->IsGlobalInSmallSection(GO, getTargetMachine()))
-      // %gp_rel relocation
-      return getAddrGPRel(N, SDLoc(N), Ty, DAG, ABI.IsN64());
-
-                                 // %hi/%lo relocation
-    return Subtarget.hasSym32() ? getAddrNonPIC(N, SDLoc(N), Ty, DAG)
-                                 // %highest/%higher/%hi/%lo relocation
-                                 : getAddrNonPICSym64(N, SDLoc(N), Ty, DAG);
-  }
-
-  // Every other architecture would use shouldAssumeDSOLocal in here, but
-  // m6502 is special.
-  // * In PIC code m6502 requires got loads even for local statics!
-  // * To save on got entries, for local statics the got entry contains the
-  //   page and an additional add instruction takes care of the low bits.
-  // * It is legal to access a hidden symbol with a non hidden undefined,
-  //   so one cannot guarantee that all access to a hidden symbol will know
-  //   it is hidden.
-  // * M6502 linkers don't support creating a page and a full got entry for
-  //   the same symbol.
-  // * Given all that, we have to use a full got entry for hidden symbols :-(
-  if (GV->hasLocalLinkage())
-    return getAddrLocal(N, SDLoc(N), Ty, DAG, ABI.IsN32() || ABI.IsN64());
-
-  if (LargeGOT)
-    return getAddrGlobalLargeGOT(
-        N, SDLoc(N), Ty, DAG, M6502II::MO_GOT_HI16, M6502II::MO_GOT_LO16,
-        DAG.getEntryNode(),
-        MachinePointerInfo::getGOT(DAG.getMachineFunction()));
-
-  return getAddrGlobal(
-      N, SDLoc(N), Ty, DAG,
-      (ABI.IsN32() || ABI.IsN64()) ? M6502II::MO_GOT_DISP : M6502II::MO_GOT,
-      DAG.getEntryNode(), MachinePointerInfo::getGOT(DAG.getMachineFunction()));
+  return getAddr(N, SDLoc(N), Op.getValueType(), DAG);
 }
 
 SDValue M6502TargetLowering::lowerBlockAddress(SDValue Op,
                                               SelectionDAG &DAG) const {
   BlockAddressSDNode *N = cast<BlockAddressSDNode>(Op);
-  EVT Ty = Op.getValueType();
-
-  if (!isPositionIndependent())
-    return Subtarget.hasSym32() ? getAddrNonPIC(N, SDLoc(N), Ty, DAG)
-                                : getAddrNonPICSym64(N, SDLoc(N), Ty, DAG);
-
-  return getAddrLocal(N, SDLoc(N), Ty, DAG, ABI.IsN32() || ABI.IsN64());
+  return getAddr(N, SDLoc(N), Op.getValueType(), DAG);
 }
 
-SDValue M6502TargetLowering::
-lowerGlobalTLSAddress(SDValue Op, SelectionDAG &DAG) const
-{
-  // If the relocation model is PIC, use the General Dynamic TLS Model or
-  // Local Dynamic TLS model, otherwise use the Initial Exec or
-  // Local Exec TLS Model.
-
-  GlobalAddressSDNode *GA = cast<GlobalAddressSDNode>(Op);
-  if (DAG.getTarget().Options.EmulatedTLS)
-    return LowerToTLSEmulatedModel(GA, DAG);
-
-  SDLoc DL(GA);
-  const GlobalValue *GV = GA->getGlobal();
-  EVT PtrVT = getPointerTy(DAG.getDataLayout());
-
-  TLSModel::Model model = getTargetMachine().getTLSModel(GV);
-
-  if (model == TLSModel::GeneralDynamic || model == TLSModel::LocalDynamic) {
-    // General Dynamic and Local Dynamic TLS Model.
-    unsigned Flag = (model == TLSModel::LocalDynamic) ? M6502II::MO_TLSLDM
-                                                      : M6502II::MO_TLSGD;
-
-    SDValue TGA = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0, Flag);
-    SDValue Argument = DAG.getNode(M6502ISD::Wrapper, DL, PtrVT,
-                                   getGlobalReg(DAG, PtrVT), TGA);
-    unsigned PtrSize = PtrVT.getSizeInBits();
-    IntegerType *PtrTy = Type::getIntNTy(*DAG.getContext(), PtrSize);
-
-    SDValue TlsGetAddr = DAG.getExternalSymbol("__tls_get_addr", PtrVT);
-
-    ArgListTy Args;
-    ArgListEntry Entry;
-    Entry.Node = Argument;
-    Entry.Ty = PtrTy;
-    Args.push_back(Entry);
-
-    TargetLowering::CallLoweringInfo CLI(DAG);
-    CLI.setDebugLoc(DL)
-        .setChain(DAG.getEntryNode())
-        .setLibCallee(CallingConv::C, PtrTy, TlsGetAddr, std::move(Args));
-    std::pair<SDValue, SDValue> CallResult = LowerCallTo(CLI);
-
-    SDValue Ret = CallResult.first;
-
-    if (model != TLSModel::LocalDynamic)
-      return Ret;
-
-    SDValue TGAHi = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
-                                               M6502II::MO_DTPREL_HI);
-    SDValue Hi = DAG.getNode(M6502ISD::Hi, DL, PtrVT, TGAHi);
-    SDValue TGALo = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
-                                               M6502II::MO_DTPREL_LO);
-    SDValue Lo = DAG.getNode(M6502ISD::Lo, DL, PtrVT, TGALo);
-    SDValue Add = DAG.getNode(ISD::ADD, DL, PtrVT, Hi, Ret);
-    return DAG.getNode(ISD::ADD, DL, PtrVT, Add, Lo);
-  }
-
-  SDValue Offset;
-  if (model == TLSModel::InitialExec) {
-    // Initial Exec TLS Model
-    SDValue TGA = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
-                                             M6502II::MO_GOTTPREL);
-    TGA = DAG.getNode(M6502ISD::Wrapper, DL, PtrVT, getGlobalReg(DAG, PtrVT),
-                      TGA);
-    Offset =
-        DAG.getLoad(PtrVT, DL, DAG.getEntryNode(), TGA, MachinePointerInfo());
-  } else {
-    // Local Exec TLS Model
-    assert(model == TLSModel::LocalExec);
-    SDValue TGAHi = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
-                                               M6502II::MO_TPREL_HI);
-    SDValue TGALo = DAG.getTargetGlobalAddress(GV, DL, PtrVT, 0,
-                                               M6502II::MO_TPREL_LO);
-    SDValue Hi = DAG.getNode(M6502ISD::Hi, DL, PtrVT, TGAHi);
-    SDValue Lo = DAG.getNode(M6502ISD::Lo, DL, PtrVT, TGALo);
-    Offset = DAG.getNode(ISD::ADD, DL, PtrVT, Hi, Lo);
-  }
-
-  SDValue ThreadPointer = DAG.getNode(M6502ISD::ThreadPointer, DL, PtrVT);
-  return DAG.getNode(ISD::ADD, DL, PtrVT, ThreadPointer, Offset);
+SDValue M6502TargetLowering::lowerExternalSymbol(SDValue Op,
+                                                SelectionDAG &DAG) const {
+  ExternalSymbolSDNode *N = cast<ExternalSymbolSDNode>(Op);
+  return getAddr(N, SDLoc(N), Op.getValueType(), DAG);
 }
 
 SDValue M6502TargetLowering::
 lowerJumpTable(SDValue Op, SelectionDAG &DAG) const
 {
   JumpTableSDNode *N = cast<JumpTableSDNode>(Op);
-  EVT Ty = Op.getValueType();
-
-  if (!isPositionIndependent())
-    return Subtarget.hasSym32() ? getAddrNonPIC(N, SDLoc(N), Ty, DAG)
-                                : getAddrNonPICSym64(N, SDLoc(N), Ty, DAG);
+  return getAddr(N, SDLoc(N), Op.getValueType(), DAG);
+}
 
-  return getAddrLocal(N, SDLoc(N), Ty, DAG, ABI.IsN32() || ABI.IsN64());
+// A jump table is emitted as a table of the low bytes of the addresses
+// followed by one of the high bytes, so the index is a byte used as is for
+// both rather than doubled and added to the address of the table:
+//   ldx idx ; lda jt,x ; sta rc ; lda jt+n,x ; sta rc+1 ; jmp (rc)
+SDValue M6502TargetLowering::lowerBR_JT(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Chain = Op.getOperand(0);
+  SDValue Table = Op.getOperand(1);
+  if (Table.getOpcode() == M6502ISD::Wrapper)
+    Table = Table.getOperand(0);
+  int JTI = cast<JumpTableSDNode>(Table)->getIndex();
+
+  // The index has been checked against the size of the table.
+  SDValue Index = DAG.getNode(
+      ISD::ZERO_EXTEND, DL, MVT::i16,
+      DAG.getNode(ISD::TRUNCATE, DL, MVT::i8, Op.getOperand(2)));
+  MachinePointerInfo PtrInfo =
+      MachinePointerInfo::getJumpTable(DAG.getMachineFunction());
+
+  SDValue Bytes[2], Chains[2];
+  for (unsigned High = 0; High != 2; ++High) {
+    SDValue Addr = DAG.getNode(
+        M6502ISD::Wrapper, DL, MVT::i16,
+        DAG.getTargetJumpTable(JTI, MVT::i16,
+                               High ? M6502II::MO_JT_HI : M6502II::MO_NO_FLAG));
+    Addr = DAG.getNode(ISD::ADD, DL, MVT::i16, Addr, Index);
+    SDValue Byte = DAG.getLoad(MVT::i8, DL, Chain, Addr, PtrInfo);
+    Bytes[High] = DAG.getNode(ISD::ZERO_EXTEND, DL, MVT::i16, Byte);
+    Chains[High] = Byte.getValue(1);
+  }
+
+  SDValue Dest = DAG.getNode(
+      ISD::OR, DL, MVT::i16, Bytes[0],
+      DAG.getNode(ISD::SHL, DL, MVT::i16, Bytes[1],
+                  DAG.getConstant(8, DL, MVT::i8)));
+  Chain = DAG.getNode(ISD::TokenFactor, DL, MVT::Other, Chains);
+  return DAG.getNode(ISD::BRIND, DL, MVT::Other, Chain, Dest);
 }
 
 SDValue M6502TargetLowering::
 lowerConstantPool(SDValue Op, SelectionDAG &DAG) const
 {
   ConstantPoolSDNode *N = cast<ConstantPoolSDNode>(Op);
-  EVT Ty = Op.getValueType();
-
-  if (!isPositionIndependent()) {
-    const M6502TargetObjectFile *TLOF =
-        static_cast<const M6502TargetObjectFile *>(
-            getTargetMachine().getObjFileLowering());
-
-    if (TLOF->IsConstantInSmallSection(DAG.getDataLayout(), N->getConstVal(),
-                                       getTargetMachine()))
-      // %gp_rel relocation
-      return getAddrGPRel(N, SDLoc(N), Ty, DAG, ABI.IsN64());
-
-    return Subtarget.hasSym32() ? getAddrNonPIC(N, SDLoc(N), Ty, DAG)
-                                : getAddrNonPICSym64(N, SDLoc(N), Ty, DAG);
-  }
-
- return getAddrLocal(N, SDLoc(N), Ty, DAG, ABI.IsN32() || ABI.IsN64());
+  return getAddr(N, SDLoc(N), Op.getValueType(), DAG);
 }
 
 SDValue M6502TargetLowering::lowerVASTART(SDValue Op, SelectionDAG &DAG) const {
@@ -2203,169 +1228,6 @@ SDValue M6502TargetLowering::lowerVASTART(SDValue Op, SelectionDAG &DAG) const {
                       MachinePointerInfo(SV));
 }
 
-SDValue M6502TargetLowering::lowerVAARG(SDValue Op, SelectionDAG &DAG) const {
-  SDNode *Node = Op.getNode();
-  EVT VT = Node->getValueType(0);
-  SDValue Chain = Node->getOperand(0);
-  SDValue VAListPtr = Node->getOperand(1);
-  unsigned Align = Node->getConstantOperandVal(3);
-  const Value *SV = cast<SrcValueSDNode>(Node->getOperand(2))->getValue();
-  SDLoc DL(Node);
-  unsigned ArgSlotSizeInBytes = (ABI.IsN32() || ABI.IsN64()) ? 8 : 4;
-
-  SDValue VAListLoad = DAG.getLoad(getPointerTy(DAG.getDataLayout()), DL, Chain,
-                                   VAListPtr, MachinePointerInfo(SV));
-  SDValue VAList = VAListLoad;
-
-  // Re-align the pointer if necessary.
-  // It should only ever be necessary for 64-bit types on O32 since the minimum
-  // argument alignment is the same as the maximum type alignment for N32/N64.
-  //
-  // FIXME: We currently align too often. The code generator doesn't notice
-  //        when the pointer is still aligned from the last va_arg (or pair of
-  //        va_args for the i64 on O32 case).
-  if (Align > getMinStackArgumentAlignment()) {
-    assert(((Align & (Align-1)) == 0) && "Expected Align to be a power of 2");
-
-    VAList = DAG.getNode(ISD::ADD, DL, VAList.getValueType(), VAList,
-                         DAG.getConstant(Align - 1, DL, VAList.getValueType()));
-
-    VAList = DAG.getNode(ISD::AND, DL, VAList.getValueType(), VAList,
-                         DAG.getConstant(-(int64_t)Align, DL,
-                                         VAList.getValueType()));
-  }
-
-  // Increment the pointer, VAList, to the next vaarg.
-  auto &TD = DAG.getDataLayout();
-  unsigned ArgSizeInBytes =
-      TD.getTypeAllocSize(VT.getTypeForEVT(*DAG.getContext()));
-  SDValue Tmp3 =
-      DAG.getNode(ISD::ADD, DL, VAList.getValueType(), VAList,
-                  DAG.getConstant(alignTo(ArgSizeInBytes, ArgSlotSizeInBytes),
-                                  DL, VAList.getValueType()));
-  // Store the incremented VAList to the legalized pointer
-  Chain = DAG.getStore(VAListLoad.getValue(1), DL, Tmp3, VAListPtr,
-                       MachinePointerInfo(SV));
-
-  // In big-endian mode we must adjust the pointer when the load size is smaller
-  // than the argument slot size. We must also reduce the known alignment to
-  // match. For example in the N64 ABI, we must add 4 bytes to the offset to get
-  // the correct half of the slot, and reduce the alignment from 8 (slot
-  // alignment) down to 4 (type alignment).
-  if (!Subtarget.isLittle() && ArgSizeInBytes < ArgSlotSizeInBytes) {
-    unsigned Adjustment = ArgSlotSizeInBytes - ArgSizeInBytes;
-    VAList = DAG.getNode(ISD::ADD, DL, VAListPtr.getValueType(), VAList,
-                         DAG.getIntPtrConstant(Adjustment, DL));
-  }
-  // Load the actual argument out of the pointer VAList
-  return DAG.getLoad(VT, DL, Chain, VAList, MachinePointerInfo());
-}
-
-static SDValue lowerFCOPYSIGN32(SDValue Op, SelectionDAG &DAG,
-                                bool HasExtractInsert) {
-  EVT TyX = Op.getOperand(0).getValueType();
-  EVT TyY = Op.getOperand(1).getValueType();
-  SDLoc DL(Op);
-  SDValue Const1 = DAG.getConstant(1, DL, MVT::i32);
-  SDValue Const31 = DAG.getConstant(31, DL, MVT::i32);
-  SDValue Res;
-
-  // If operand is of type f64, extract the upper 32-bit. Otherwise, bitcast it
-  // to i32.
-  SDValue X = (TyX == MVT::f32) ?
-    DAG.getNode(ISD::BITCAST, DL, MVT::i32, Op.getOperand(0)) :
-    DAG.getNode(M6502ISD::ExtractElementF64, DL, MVT::i32, Op.getOperand(0),
-                Const1);
-  SDValue Y = (TyY == MVT::f32) ?
-    DAG.getNode(ISD::BITCAST, DL, MVT::i32, Op.getOperand(1)) :
-    DAG.getNode(M6502ISD::ExtractElementF64, DL, MVT::i32, Op.getOperand(1),
-                Const1);
-
-  if (HasExtractInsert) {
-    // ext  E, Y, 31, 1  ; extract bit31 of Y
-    // ins  X, E, 31, 1  ; insert extracted bit at bit31 of X
-    SDValue E = DAG.getNode(M6502ISD::Ext, DL, MVT::i32, Y, Const31, Const1);
-    Res = DAG.getNode(M6502ISD::Ins, DL, MVT::i32, E, Const31, Const1, X);
-  } else {
-    // sll SllX, X, 1
-    // srl SrlX, SllX, 1
-    // srl SrlY, Y, 31
-    // sll SllY, SrlX, 31
-    // or  Or, SrlX, SllY
-    SDValue SllX = DAG.getNode(ISD::SHL, DL, MVT::i32, X, Const1);
-    SDValue SrlX = DAG.getNode(ISD::SRL, DL, MVT::i32, SllX, Const1);
-    SDValue SrlY = DAG.getNode(ISD::SRL, DL, MVT::i32, Y, Const31);
-    SDValue SllY = DAG.getNode(ISD::SHL, DL, MVT::i32, SrlY, Const31);
-    Res = DAG.getNode(ISD::OR, DL, MVT::i32, SrlX, SllY);
-  }
-
-  if (TyX == MVT::f32)
-    return DAG.getNode(ISD::BITCAST, DL, Op.getOperand(0).getValueType(), Res);
-
-  SDValue LowX = DAG.getNode(M6502ISD::ExtractElementF64, DL, MVT::i32,
-                             Op.getOperand(0),
-                             DAG.getConstant(0, DL, MVT::i32));
-  return DAG.getNode(M6502ISD::BuildPairF64, DL, MVT::f64, LowX, Res);
-}
-
-static SDValue lowerFCOPYSIGN64(SDValue Op, SelectionDAG &DAG,
-                                bool HasExtractInsert) {
-  unsigned WidthX = Op.getOperand(0).getValueSizeInBits();
-  unsigned WidthY = Op.getOperand(1).getValueSizeInBits();
-  EVT TyX = MVT::getIntegerVT(WidthX), TyY = MVT::getIntegerVT(WidthY);
-  SDLoc DL(Op);
-  SDValue Const1 = DAG.getConstant(1, DL, MVT::i32);
-
-  // Bitcast to integer nodes.
-  SDValue X = DAG.getNode(ISD::BITCAST, DL, TyX, Op.getOperand(0));
-  SDValue Y = DAG.getNode(ISD::BITCAST, DL, TyY, Op.getOperand(1));
-
-  if (HasExtractInsert) {
-    // ext  E, Y, width(Y) - 1, 1  ; extract bit width(Y)-1 of Y
-    // ins  X, E, width(X) - 1, 1  ; insert extracted bit at bit width(X)-1 of X
-    SDValue E = DAG.getNode(M6502ISD::Ext, DL, TyY, Y,
-                            DAG.getConstant(WidthY - 1, DL, MVT::i32), Const1);
-
-    if (WidthX > WidthY)
-      E = DAG.getNode(ISD::ZERO_EXTEND, DL, TyX, E);
-    else if (WidthY > WidthX)
-      E = DAG.getNode(ISD::TRUNCATE, DL, TyX, E);
-
-    SDValue I = DAG.getNode(M6502ISD::Ins, DL, TyX, E,
-                            DAG.getConstant(WidthX - 1, DL, MVT::i32), Const1,
-                            X);
-    return DAG.getNode(ISD::BITCAST, DL, Op.getOperand(0).getValueType(), I);
-  }
-
-  // (d)sll SllX, X, 1
-  // (d)srl SrlX, SllX, 1
-  // (d)srl SrlY, Y, width(Y)-1
-  // (d)sll SllY, SrlX, width(Y)-1
-  // or     Or, SrlX, SllY
-  SDValue SllX = DAG.getNode(ISD::SHL, DL, TyX, X, Const1);
-  SDValue SrlX = DAG.getNode(ISD::SRL, DL, TyX, SllX, Const1);
-  SDValue SrlY = DAG.getNode(ISD::SRL, DL, TyY, Y,
-                             DAG.getConstant(WidthY - 1, DL, MVT::i32));
-
-  if (WidthX > WidthY)
-    SrlY = DAG.getNode(ISD::ZERO_EXTEND, DL, TyX, SrlY);
-  else if (WidthY > WidthX)
-    SrlY = DAG.getNode(ISD::TRUNCATE, DL, TyX, SrlY);
-
-  SDValue SllY = DAG.getNode(ISD::SHL, DL, TyX, SrlY,
-                             DAG.getConstant(WidthX - 1, DL, MVT::i32));
-  SDValue Or = DAG.getNode(ISD::OR, DL, TyX, SrlX, SllY);
-  return DAG.getNode(ISD::BITCAST, DL, Op.getOperand(0).getValueType(), Or);
-}
-
-SDValue
-M6502TargetLowering::lowerFCOPYSIGN(SDValue Op, SelectionDAG &DAG) const {
-  if (Subtarget.isGP64bit())
-    return lowerFCOPYSIGN64(Op, DAG, Subtarget.hasExtractInsert());
-
-  return lowerFCOPYSIGN32(Op, DAG, Subtarget.hasExtractInsert());
-}
-
 SDValue M6502TargetLowering::
 lowerFRAMEADDR(SDValue Op, SelectionDAG &DAG) const {
   // check the depth
@@ -2376,523 +1238,95 @@ lowerFRAMEADDR(SDValue Op, SelectionDAG &DAG) const {
   MFI.setFrameAddressIsTaken(true);
   EVT VT = Op.getValueType();
   SDLoc DL(Op);
-  SDValue FrameAddr = DAG.getCopyFromReg(
-      DAG.getEntryNode(), DL, ABI.IsN64() ? M6502::FP_64 : M6502::FP, VT);
+  SDValue FrameAddr = DAG.getCopyFromReg(DAG.getEntryNode(), DL,
+                                         ABI.GetFramePtr(), VT);
   return FrameAddr;
 }
 
-SDValue M6502TargetLowering::lowerRETURNADDR(SDValue Op,
-                                            SelectionDAG &DAG) const {
-  if (verifyReturnAddressArgumentIsConstant(Op, DAG))
-    return SDValue();
-
-  // check the depth
-  assert((cast<ConstantSDNode>(Op.getOperand(0))->getZExtValue() == 0) &&
-         "Return address can be determined only for current frame.");
-
-  MachineFunction &MF = DAG.getMachineFunction();
-  MachineFrameInfo &MFI = MF.getFrameInfo();
-  MVT VT = Op.getSimpleValueType();
-  unsigned RA = ABI.IsN64() ? M6502::RA_64 : M6502::RA;
-  MFI.setReturnAddressIsTaken(true);
-
-  // Return RA, which contains the return address. Mark it an implicit live-in.
-  unsigned Reg = MF.addLiveIn(RA, getRegClassFor(VT));
-  return DAG.getCopyFromReg(DAG.getEntryNode(), SDLoc(Op), Reg, VT);
-}
-
-// An EH_RETURN is the result of lowering llvm.eh.return which in turn is
-// generated from __builtin_eh_return (offset, handler)
-// The effect of this is to adjust the stack pointer by "offset"
-// and then branch to "handler".
-SDValue M6502TargetLowering::lowerEH_RETURN(SDValue Op, SelectionDAG &DAG)
-                                                                     const {
-  MachineFunction &MF = DAG.getMachineFunction();
-  M6502FunctionInfo *M6502FI = MF.getInfo<M6502FunctionInfo>();
-
-  M6502FI->setCallsEhReturn();
-  SDValue Chain     = Op.getOperand(0);
-  SDValue Offset    = Op.getOperand(1);
-  SDValue Handler   = Op.getOperand(2);
-  SDLoc DL(Op);
-  EVT Ty = ABI.IsN64() ? MVT::i64 : MVT::i32;
-
-  // Store stack offset in V1, store jump target in V0. Glue CopyToReg and
-  // EH_RETURN nodes, so that instructions are emitted back-to-back.
-  unsigned OffsetReg = ABI.IsN64() ? M6502::V1_64 : M6502::V1;
-  unsigned AddrReg = ABI.IsN64() ? M6502::V0_64 : M6502::V0;
-  Chain = DAG.getCopyToReg(Chain, DL, OffsetReg, Offset, SDValue());
-  Chain = DAG.getCopyToReg(Chain, DL, AddrReg, Handler, Chain.getValue(1));
-  return DAG.getNode(M6502ISD::EH_RETURN, DL, MVT::Other, Chain,
-                     DAG.getRegister(OffsetReg, Ty),
-                     DAG.getRegister(AddrReg, getPointerTy(MF.getDataLayout())),
-                     Chain.getValue(1));
-}
-
-SDValue M6502TargetLowering::lowerATOMIC_FENCE(SDValue Op,
-                                              SelectionDAG &DAG) const {
-  // FIXME: Need pseudo-fence for 'singlethread' fences
-  // FIXME: Set SType for weaker fences where supported/appropriate.
-  unsigned SType = 0;
-  SDLoc DL(Op);
-  return DAG.getNode(M6502ISD::Sync, DL, MVT::Other, Op.getOperand(0),
-                     DAG.getConstant(SType, DL, MVT::i32));
-}
-
-SDValue M6502TargetLowering::lowerShiftLeftParts(SDValue Op,
-                                                SelectionDAG &DAG) const {
-  SDLoc DL(Op);
-  MVT VT = Subtarget.isGP64bit() ? MVT::i64 : MVT::i32;
-
-  SDValue Lo = Op.getOperand(0), Hi = Op.getOperand(1);
-  SDValue Shamt = Op.getOperand(2);
-  // if shamt < (VT.bits):
-  //  lo = (shl lo, shamt)
-  //  hi = (or (shl hi, shamt) (srl (srl lo, 1), ~shamt))
-  // else:
-  //  lo = 0
-  //  hi = (shl lo, shamt[4:0])
-  SDValue Not = DAG.getNode(ISD::XOR, DL, MVT::i32, Shamt,
-                            DAG.getConstant(-1, DL, MVT::i32));
-  SDValue ShiftRight1Lo = DAG.getNode(ISD::SRL, DL, VT, Lo,
-                                      DAG.getConstant(1, DL, VT));
-  SDValue ShiftRightLo = DAG.getNode(ISD::SRL, DL, VT, ShiftRight1Lo, Not);
-  SDValue ShiftLeftHi = DAG.getNode(ISD::SHL, DL, VT, Hi, Shamt);
-  SDValue Or = DAG.getNode(ISD::OR, DL, VT, ShiftLeftHi, ShiftRightLo);
-  SDValue ShiftLeftLo = DAG.getNode(ISD::SHL, DL, VT, Lo, Shamt);
-  SDValue Cond = DAG.getNode(ISD::AND, DL, MVT::i32, Shamt,
-                             DAG.getConstant(VT.getSizeInBits(), DL, MVT::i32));
-  Lo = DAG.getNode(ISD::SELECT, DL, VT, Cond,
-                   DAG.getConstant(0, DL, VT), ShiftLeftLo);
-  Hi = DAG.getNode(ISD::SELECT, DL, VT, Cond, ShiftLeftLo, Or);
-
-  SDValue Ops[2] = {Lo, Hi};
-  return DAG.getMergeValues(Ops, DL);
-}
-
-SDValue M6502TargetLowering::lowerShiftRightParts(SDValue Op, SelectionDAG &DAG,
-                                                 bool IsSRA) const {
-  SDLoc DL(Op);
-  SDValue Lo = Op.getOperand(0), Hi = Op.getOperand(1);
-  SDValue Shamt = Op.getOperand(2);
-  MVT VT = Subtarget.isGP64bit() ? MVT::i64 : MVT::i32;
-
-  // if shamt < (VT.bits):
-  //  lo = (or (shl (shl hi, 1), ~shamt) (srl lo, shamt))
-  //  if isSRA:
-  //    hi = (sra hi, shamt)
-  //  else:
-  //    hi = (srl hi, shamt)
-  // else:
-  //  if isSRA:
-  //   lo = (sra hi, shamt[4:0])
-  //   hi = (sra hi, 31)
-  //  else:
-  //   lo = (srl hi, shamt[4:0])
-  //   hi = 0
-  SDValue Not = DAG.getNode(ISD::XOR, DL, MVT::i32, Shamt,
-                            DAG.getConstant(-1, DL, MVT::i32));
-  SDValue ShiftLeft1Hi = DAG.getNode(ISD::SHL, DL, VT, Hi,
-                                     DAG.getConstant(1, DL, VT));
-  SDValue ShiftLeftHi = DAG.getNode(ISD::SHL, DL, VT, ShiftLeft1Hi, Not);
-  SDValue ShiftRightLo = DAG.getNode(ISD::SRL, DL, VT, Lo, Shamt);
-  SDValue Or = DAG.getNode(ISD::OR, DL, VT, ShiftLeftHi, ShiftRightLo);
-  SDValue ShiftRightHi = DAG.getNode(IsSRA ? ISD::SRA : ISD::SRL,
-                                     DL, VT, Hi, Shamt);
-  SDValue Cond = DAG.getNode(ISD::AND, DL, MVT::i32, Shamt,
-                             DAG.getConstant(VT.getSizeInBits(), DL, MVT::i32));
-  SDValue Ext = DAG.getNode(ISD::SRA, DL, VT, Hi,
-                            DAG.getConstant(VT.getSizeInBits() - 1, DL, VT));
-  Lo = DAG.getNode(ISD::SELECT, DL, VT, Cond, ShiftRightHi, Or);
-  Hi = DAG.getNode(ISD::SELECT, DL, VT, Cond,
-                   IsSRA ? Ext : DAG.getConstant(0, DL, VT), ShiftRightHi);
-
-  SDValue Ops[2] = {Lo, Hi};
-  return DAG.getMergeValues(Ops, DL);
-}
-
-static SDValue createLoadLR(unsigned Opc, SelectionDAG &DAG, LoadSDNode *LD,
-                            SDValue Chain, SDValue Src, unsigned Offset) {
-  SDValue Ptr = LD->getBasePtr();
-  EVT VT = LD->getValueType(0), MemVT = LD->getMemoryVT();
-  EVT BasePtrVT = Ptr.getValueType();
-  SDLoc DL(LD);
-  SDVTList VTList = DAG.getVTList(VT, MVT::Other);
-
-  if (Offset)
-    Ptr = DAG.getNode(ISD::ADD, DL, BasePtrVT, Ptr,
-                      DAG.getConstant(Offset, DL, BasePtrVT));
-
-  SDValue Ops[] = { Chain, Ptr, Src };
-  return DAG.getMemIntrinsicNode(Opc, DL, VTList, Ops, MemVT,
-                                 LD->getMemOperand());
-}
-
-// Expand an unaligned 32 or 64-bit integer load node.
-SDValue M6502TargetLowering::lowerLOAD(SDValue Op, SelectionDAG &DAG) const {
-  LoadSDNode *LD = cast<LoadSDNode>(Op);
-  EVT MemVT = LD->getMemoryVT();
-
-  if (Subtarget.systemSupportsUnalignedAccess())
-    return Op;
-
-  // Return if load is aligned or if MemVT is neither i32 nor i64.
-  if ((LD->getAlignment() >= MemVT.getSizeInBits() / 8) ||
-      ((MemVT != MVT::i32) && (MemVT != MVT::i64)))
-    return SDValue();
-
-  bool IsLittle = Subtarget.isLittle();
-  EVT VT = Op.getValueType();
-  ISD::LoadExtType ExtType = LD->getExtensionType();
-  SDValue Chain = LD->getChain(), Undef = DAG.getUNDEF(VT);
-
-  assert((VT == MVT::i32) || (VT == MVT::i64));
-
-  // Expand
-  //  (set dst, (i64 (load baseptr)))
-  // to
-  //  (set tmp, (ldl (add baseptr, 7), undef))
-  //  (set dst, (ldr baseptr, tmp))
-  if ((VT == MVT::i64) && (ExtType == ISD::NON_EXTLOAD)) {
-    SDValue LDL = createLoadLR(M6502ISD::LDL, DAG, LD, Chain, Undef,
-                               IsLittle ? 7 : 0);
-    return createLoadLR(M6502ISD::LDR, DAG, LD, LDL.getValue(1), LDL,
-                        IsLittle ? 0 : 7);
-  }
-
-  SDValue LWL = createLoadLR(M6502ISD::LWL, DAG, LD, Chain, Undef,
-                             IsLittle ? 3 : 0);
-  SDValue LWR = createLoadLR(M6502ISD::LWR, DAG, LD, LWL.getValue(1), LWL,
-                             IsLittle ? 0 : 3);
-
-  // Expand
-  //  (set dst, (i32 (load baseptr))) or
-  //  (set dst, (i64 (sextload baseptr))) or
-  //  (set dst, (i64 (extload baseptr)))
-  // to
-  //  (set tmp, (lwl (add baseptr, 3), undef))
-  //  (set dst, (lwr baseptr, tmp))
-  if ((VT == MVT::i32) || (ExtType == ISD::SEXTLOAD) ||
-      (ExtType == ISD::EXTLOAD))
-    return LWR;
-
-  assert((VT == MVT::i64) && (ExtType == ISD::ZEXTLOAD));
-
-  // Expand
-  //  (set dst, (i64 (zextload baseptr)))
-  // to
-  //  (set tmp0, (lwl (add baseptr, 3), undef))
-  //  (set tmp1, (lwr baseptr, tmp0))
-  //  (set tmp2, (shl tmp1, 32))
-  //  (set dst, (srl tmp2, 32))
-  SDLoc DL(LD);
-  SDValue Const32 = DAG.getConstant(32, DL, MVT::i32);
-  SDValue SLL = DAG.getNode(ISD::SHL, DL, MVT::i64, LWR, Const32);
-  SDValue SRL = DAG.getNode(ISD::SRL, DL, MVT::i64, SLL, Const32);
-  SDValue Ops[] = { SRL, LWR.getValue(1) };
-  return DAG.getMergeValues(Ops, DL);
-}
-
-static SDValue createStoreLR(unsigned Opc, SelectionDAG &DAG, StoreSDNode *SD,
-                             SDValue Chain, unsigned Offset) {
-  SDValue Ptr = SD->getBasePtr(), Value = SD->getValue();
-  EVT MemVT = SD->getMemoryVT(), BasePtrVT = Ptr.getValueType();
-  SDLoc DL(SD);
-  SDVTList VTList = DAG.getVTList(MVT::Other);
-
-  if (Offset)
-    Ptr = DAG.getNode(ISD::ADD, DL, BasePtrVT, Ptr,
-                      DAG.getConstant(Offset, DL, BasePtrVT));
-
-  SDValue Ops[] = { Chain, Value, Ptr };
-  return DAG.getMemIntrinsicNode(Opc, DL, VTList, Ops, MemVT,
-                                 SD->getMemOperand());
-}
-
-// Expand an unaligned 32 or 64-bit integer store node.
-static SDValue lowerUnalignedIntStore(StoreSDNode *SD, SelectionDAG &DAG,
-                                      bool IsLittle) {
-  SDValue Value = SD->getValue(), Chain = SD->getChain();
-  EVT VT = Value.getValueType();
-
-  // Expand
-  //  (store val, baseptr) or
-  //  (truncstore val, baseptr)
-  // to
-  //  (swl val, (add baseptr, 3))
-  //  (swr val, baseptr)
-  if ((VT == MVT::i32) || SD->isTruncatingStore()) {
-    SDValue SWL = createStoreLR(M6502ISD::SWL, DAG, SD, Chain,
-                                IsLittle ? 3 : 0);
-    return createStoreLR(M6502ISD::SWR, DAG, SD, SWL, IsLittle ? 0 : 3);
-  }
-
-  assert(VT == MVT::i64);
-
-  // Expand
-  //  (store val, baseptr)
-  // to
-  //  (sdl val, (add baseptr, 7))
-  //  (sdr val, baseptr)
-  SDValue SDL = createStoreLR(M6502ISD::SDL, DAG, SD, Chain, IsLittle ? 7 : 0);
-  return createStoreLR(M6502ISD::SDR, DAG, SD, SDL, IsLittle ? 0 : 7);
-}
-
-// Lower (store (fp_to_sint $fp) $ptr) to (store (TruncIntFP $fp), $ptr).
-static SDValue lowerFP_TO_SINT_STORE(StoreSDNode *SD, SelectionDAG &DAG) {
-  SDValue Val = SD->getValue();
-
-  if (Val.getOpcode() != ISD::FP_TO_SINT)
-    return SDValue();
-
-  EVT FPTy = EVT::getFloatingPointVT(Val.getValueSizeInBits());
-  SDValue Tr = DAG.getNode(M6502ISD::TruncIntFP, SDLoc(Val), FPTy,
-                           Val.getOperand(0));
-  return DAG.getStore(SD->getChain(), SDLoc(SD), Tr, SD->getBasePtr(),
-                      SD->getPointerInfo(), SD->getAlignment(),
-                      SD->getMemOperand()->getFlags());
-}
-
-SDValue M6502TargetLowering::lowerSTORE(SDValue Op, SelectionDAG &DAG) const {
-  StoreSDNode *SD = cast<StoreSDNode>(Op);
-  EVT MemVT = SD->getMemoryVT();
-
-  // Lower unaligned integer stores.
-  if (!Subtarget.systemSupportsUnalignedAccess() &&
-      (SD->getAlignment() < MemVT.getSizeInBits() / 8) &&
-      ((MemVT == MVT::i32) || (MemVT == MVT::i64)))
-    return lowerUnalignedIntStore(SD, DAG, Subtarget.isLittle());
-
-  return lowerFP_TO_SINT_STORE(SD, DAG);
-}
-
-SDValue M6502TargetLowering::lowerEH_DWARF_CFA(SDValue Op,
-                                              SelectionDAG &DAG) const {
-
-  // Return a fixed StackObject with offset 0 which points to the old stack
-  // pointer.
-  MachineFrameInfo &MFI = DAG.getMachineFunction().getFrameInfo();
-  EVT ValTy = Op->getValueType(0);
-  int FI = MFI.CreateFixedObject(Op.getValueSizeInBits() / 8, 0, false);
-  return DAG.getFrameIndex(FI, ValTy);
-}
-
-SDValue M6502TargetLowering::lowerFP_TO_SINT(SDValue Op,
-                                            SelectionDAG &DAG) const {
-  EVT FPTy = EVT::getFloatingPointVT(Op.getValueSizeInBits());
-  SDValue Trunc = DAG.getNode(M6502ISD::TruncIntFP, SDLoc(Op), FPTy,
-                              Op.getOperand(0));
-  return DAG.getNode(ISD::BITCAST, SDLoc(Op), Op.getValueType(), Trunc);
-}
-
 //===----------------------------------------------------------------------===//
 //                      Calling Convention Implementation
 //===----------------------------------------------------------------------===//
 
-//===----------------------------------------------------------------------===//
-// TODO: Implement a generic logic using tblgen that can support this.
-// M6502 O32 ABI rules:
-// ---
-// i32 - Passed in A0, A1, A2, A3 and stack
-// f32 - Only passed in f32 registers if no int reg has been used yet to hold
-//       an argument. Otherwise, passed in A1, A2, A3 and stack.
-// f64 - Only passed in two aliased f32 registers if no int reg has been used
-//       yet to hold an argument. Otherwise, use A2, A3 and stack. If A1 is
-//       not used, it must be shadowed. If only A3 is available, shadow it and
-//       go to stack.
-// vXiX - Received as scalarized i32s, passed in A0 - A3 and the stack.
-// vXf32 - Passed in either a pair of registers {A0, A1}, {A2, A3} or {A0 - A3}
-//         with the remainder spilled to the stack.
-// vXf64 - Passed in either {A0, A1, A2, A3} or {A2, A3} and in both cases
-//         spilling the remainder to the stack.
-//
-//  For vararg functions, all arguments are passed in A0, A1, A2, A3 and stack.
-//===----------------------------------------------------------------------===//
-
-static bool CC_M6502O32(unsigned ValNo, MVT ValVT, MVT LocVT,
-                       CCValAssign::LocInfo LocInfo, ISD::ArgFlagsTy ArgFlags,
-                       CCState &State, ArrayRef<MCPhysReg> F64Regs) {
-  const M6502Subtarget &Subtarget = static_cast<const M6502Subtarget &>(
-      State.getMachineFunction().getSubtarget());
-
-  static const MCPhysReg IntRegs[] = { M6502::A0, M6502::A1, M6502::A2, M6502::A3 };
-
-  const M6502CCState * M6502State = static_cast<M6502CCState *>(&State);
-
-  static const MCPhysReg F32Regs[] = { M6502::F12, M6502::F14 };
-
-  static const MCPhysReg FloatVectorIntRegs[] = { M6502::A0, M6502::A2 };
-
-  // Do not process byval args here.
-  if (ArgFlags.isByVal())
-    return true;
-
-  // Promote i8 and i16
-  if (ArgFlags.isInReg() && !Subtarget.isLittle()) {
-    if (LocVT == MVT::i8 || LocVT == MVT::i16 || LocVT == MVT::i32) {
-      LocVT = MVT::i32;
-      if (ArgFlags.isSExt())
-        LocInfo = CCValAssign::SExtUpper;
-      else if (ArgFlags.isZExt())
-        LocInfo = CCValAssign::ZExtUpper;
-      else
-        LocInfo = CCValAssign::AExtUpper;
+namespace {
+
+  /// The CCState of a fastcc function, or of a call to one, which also knows
+  /// the CPU registers M6502ArgRegs gave its byte arguments.
+  class M6502CCState : public CCState {
+    SmallVector<unsigned, 8> ArgRegs;
+
+    template <typename ArgTy>
+    void findArgRegs(const Function *F, ArrayRef<ArgTy> Args) {
+      if (!F || F->getCallingConv() != CallingConv::Fast)
+        return;
+      for (const ArgTy &Arg : Args) {
+        unsigned Reg = 0;
+        if (Arg.OrigArgIndex < F->arg_size())
+          Reg = StringSwitch<unsigned>(
+                    F->getAttributes()
+                        .getParamAttr(Arg.OrigArgIndex, "m6502-arg-reg")
+                        .getValueAsString())
+                    .Case("x", M6502::X)
+                    .Case("y", M6502::Y)
+                    .Default(0);
+        ArgRegs.push_back(Reg);
+      }
     }
-  }
 
-  // Promote i8 and i16
-  if (LocVT == MVT::i8 || LocVT == MVT::i16) {
-    LocVT = MVT::i32;
-    if (ArgFlags.isSExt())
-      LocInfo = CCValAssign::SExt;
-    else if (ArgFlags.isZExt())
-      LocInfo = CCValAssign::ZExt;
-    else
-      LocInfo = CCValAssign::AExt;
-  }
-
-  unsigned Reg;
-
-  // f32 and f64 are allocated in A0, A1, A2, A3 when either of the following
-  // is true: function is vararg, argument is 3rd or higher, there is previous
-  // argument which is not f32 or f64.
-  bool AllocateFloatsInIntReg = State.isVarArg() || ValNo > 1 ||
-                                State.getFirstUnallocated(F32Regs) != ValNo;
-  unsigned OrigAlign = ArgFlags.getOrigAlign();
-  bool isI64 = (ValVT == MVT::i32 && OrigAlign == 8);
-  bool isVectorFloat = M6502State->WasOriginalArgVectorFloat(ValNo);
-
-  // The M6502 vector ABI for floats passes them in a pair of registers
-  if (ValVT == MVT::i32 && isVectorFloat) {
-    // This is the start of an vector that was scalarized into an unknown number
-    // of components. It doesn't matter how many there are. Allocate one of the
-    // notional 8 byte aligned registers which map onto the argument stack, and
-    // shadow the register lost to alignment requirements.
-    if (ArgFlags.isSplit()) {
-      Reg = State.AllocateReg(FloatVectorIntRegs);
-      if (Reg == M6502::A2)
-        State.AllocateReg(M6502::A1);
-      else if (Reg == 0)
-        State.AllocateReg(M6502::A3);
-    } else {
-      // If we're an intermediate component of the split, we can just attempt to
-      // allocate a register directly.
-      Reg = State.AllocateReg(IntRegs);
-    }
-  } else if (ValVT == MVT::i32 || (ValVT == MVT::f32 && AllocateFloatsInIntReg)) {
-    Reg = State.AllocateReg(IntRegs);
-    // If this is the first part of an i64 arg,
-    // the allocated register must be either A0 or A2.
-    if (isI64 && (Reg == M6502::A1 || Reg == M6502::A3))
-      Reg = State.AllocateReg(IntRegs);
-    LocVT = MVT::i32;
-  } else if (ValVT == MVT::f64 && AllocateFloatsInIntReg) {
-    // Allocate int register and shadow next int register. If first
-    // available register is M6502::A1 or M6502::A3, shadow it too.
-    Reg = State.AllocateReg(IntRegs);
-    if (Reg == M6502::A1 || Reg == M6502::A3)
-      Reg = State.AllocateReg(IntRegs);
-    State.AllocateReg(IntRegs);
-    LocVT = MVT::i32;
-  } else if (ValVT.isFloatingPoint() && !AllocateFloatsInIntReg) {
-    // we are guaranteed to find an available float register
-    if (ValVT == MVT::f32) {
-      Reg = State.AllocateReg(F32Regs);
-      // Shadow int register
-      State.AllocateReg(IntRegs);
-    } else {
-      Reg = State.AllocateReg(F64Regs);
-      // Shadow int registers
-      unsigned Reg2 = State.AllocateReg(IntRegs);
-      if (Reg2 == M6502::A1 || Reg2 == M6502::A3)
-        State.AllocateReg(IntRegs);
-      State.AllocateReg(IntRegs);
+  public:
+    M6502CCState(CallingConv::ID CC, bool IsVarArg, MachineFunction &MF,
+                 SmallVectorImpl<CCValAssign> &Locs, LLVMContext &C,
+                 const Function *Callee, ArrayRef<ISD::OutputArg> Outs)
+        : CCState(CC, IsVarArg, MF, Locs, C) {
+      findArgRegs(Callee, Outs);
     }
-  } else
-    llvm_unreachable("Cannot handle this ValVT.");
 
-  if (!Reg) {
-    unsigned Offset = State.AllocateStack(ValVT.getSizeInBits() >> 3,
-                                          OrigAlign);
-    State.addLoc(CCValAssign::getMem(ValNo, ValVT, Offset, LocVT, LocInfo));
-  } else
-    State.addLoc(CCValAssign::getReg(ValNo, ValVT, Reg, LocVT, LocInfo));
-
-  return false;
-}
+    M6502CCState(CallingConv::ID CC, bool IsVarArg, MachineFunction &MF,
+                 SmallVectorImpl<CCValAssign> &Locs, LLVMContext &C,
+                 ArrayRef<ISD::InputArg> Ins)
+        : CCState(CC, IsVarArg, MF, Locs, C) {
+      findArgRegs(MF.getFunction(), Ins);
+    }
 
-static bool CC_M6502O32_FP32(unsigned ValNo, MVT ValVT,
-                            MVT LocVT, CCValAssign::LocInfo LocInfo,
-                            ISD::ArgFlagsTy ArgFlags, CCState &State) {
-  static const MCPhysReg F64Regs[] = { M6502::D6, M6502::D7 };
+    /// Return the CPU register of the argument ValNo, or 0.
+    unsigned getArgReg(unsigned ValNo) const {
+      return ValNo < ArgRegs.size() ? ArgRegs[ValNo] : 0;
+    }
+  };
 
-  return CC_M6502O32(ValNo, ValVT, LocVT, LocInfo, ArgFlags, State, F64Regs);
-}
+} // end anonymous namespace
 
-static bool CC_M6502O32_FP64(unsigned ValNo, MVT ValVT,
-                            MVT LocVT, CCValAssign::LocInfo LocInfo,
+/// Pass a byte argument of a fastcc function in the CPU register chosen for
+/// it, if any.
+static bool CC_M6502_ArgReg(unsigned ValNo, MVT ValVT, MVT LocVT,
+                            CCValAssign::LocInfo LocInfo,
                             ISD::ArgFlagsTy ArgFlags, CCState &State) {
-  static const MCPhysReg F64Regs[] = { M6502::D12_64, M6502::D14_64 };
-
-  return CC_M6502O32(ValNo, ValVT, LocVT, LocInfo, ArgFlags, State, F64Regs);
+  unsigned Reg = static_cast<M6502CCState &>(State).getArgReg(ValNo);
+  if (!Reg || !State.AllocateReg(Reg))
+    return false;
+  State.addLoc(CCValAssign::getReg(ValNo, ValVT, Reg, LocVT, LocInfo));
+  return true;
 }
 
-static bool CC_M6502O32(unsigned ValNo, MVT ValVT, MVT LocVT,
-                       CCValAssign::LocInfo LocInfo, ISD::ArgFlagsTy ArgFlags,
-                       CCState &State) LLVM_ATTRIBUTE_UNUSED;
-
 #include "M6502GenCallingConv.inc"
 
 //===----------------------------------------------------------------------===//
 //                  Call Calling Convention Implementation
 //===----------------------------------------------------------------------===//
 
-// Return next O32 integer argument register.
-static unsigned getNextIntArgReg(unsigned Reg) {
-  assert((Reg == M6502::A0) || (Reg == M6502::A2));
-  return (Reg == M6502::A0) ? M6502::A1 : M6502::A3;
-}
-
 SDValue M6502TargetLowering::passArgOnStack(SDValue StackPtr, unsigned Offset,
                                            SDValue Chain, SDValue Arg,
-                                           const SDLoc &DL, bool IsTailCall,
+                                           const SDLoc &DL,
                                            SelectionDAG &DAG) const {
-  if (!IsTailCall) {
-    SDValue PtrOff =
-        DAG.getNode(ISD::ADD, DL, getPointerTy(DAG.getDataLayout()), StackPtr,
-                    DAG.getIntPtrConstant(Offset, DL));
-    return DAG.getStore(Chain, DL, Arg, PtrOff, MachinePointerInfo());
-  }
-
-  MachineFrameInfo &MFI = DAG.getMachineFunction().getFrameInfo();
-  int FI = MFI.CreateFixedObject(Arg.getValueSizeInBits() / 8, Offset, false);
-  SDValue FIN = DAG.getFrameIndex(FI, getPointerTy(DAG.getDataLayout()));
-  return DAG.getStore(Chain, DL, Arg, FIN, MachinePointerInfo(),
-                      /* Alignment = */ 0, MachineMemOperand::MOVolatile);
+  SDValue PtrOff =
+      DAG.getNode(ISD::ADD, DL, getPointerTy(DAG.getDataLayout()), StackPtr,
+                  DAG.getIntPtrConstant(Offset, DL));
+  return DAG.getStore(Chain, DL, Arg, PtrOff, MachinePointerInfo());
 }
 
 void M6502TargetLowering::
-getOpndList(SmallVectorImpl<SDValue> &Ops,
-            std::deque<std::pair<unsigned, SDValue>> &RegsToPass,
-            bool IsPICCall, bool GlobalOrExternal, bool InternalLinkage,
-            bool IsCallReloc, CallLoweringInfo &CLI, SDValue Callee,
-            SDValue Chain) const {
-  // Insert node "GP copy globalreg" before call to function.
-  //
-  // R_M6502_CALL* operators (emitted when non-internal functions are called
-  // in PIC mode) allow symbols to be resolved via lazy binding.
-  // The lazy binding stub requires GP to point to the GOT.
-  // Note that we don't need GP to point to the GOT for indirect calls
-  // (when R_M6502_CALL* is not used for the call) because M6502 linker generates
-  // lazy binding stub for a function only when R_M6502_CALL* are the only relocs
-  // used for the function (that is, M6502 linker doesn't generate lazy binding
-  // stub for a function whose address is taken in the program).
-  if (IsPICCall && !InternalLinkage && IsCallReloc) {
-    unsigned GPReg = ABI.IsN64() ? M6502::GP_64 : M6502::GP;
-    EVT Ty = ABI.IsN64() ? MVT::i64 : MVT::i32;
-    RegsToPass.push_back(std::make_pair(GPReg, getGlobalReg(CLI.DAG, Ty)));
-  }
-
+getOpndList(SmallVectorImpl<SDValue> &Ops,
+            std::deque<std::pair<unsigned, SDValue>> &RegsToPass,
+            CallLoweringInfo &CLI, SDValue Callee, SDValue Chain) const {
   // Build a sequence of copy-to-reg nodes chained together with token
   // chain and flag operands which copy the outgoing args into registers.
   // The InFlag in necessary since all emitted instructions must be
@@ -2905,6 +1339,9 @@ getOpndList(SmallVectorImpl<SDValue> &Ops,
     InFlag = Chain.getValue(1);
   }
 
+  Ops[0] = Chain;
+  Ops.push_back(Callee);
+
   // Add argument registers to the end of the list so that they are
   // known live into the call.
   for (unsigned i = 0, e = RegsToPass.size(); i != e; ++i)
@@ -2916,15 +1353,6 @@ getOpndList(SmallVectorImpl<SDValue> &Ops,
   const uint32_t *Mask =
       TRI->getCallPreservedMask(CLI.DAG.getMachineFunction(), CLI.CallConv);
   assert(Mask && "Missing call preserved mask for calling convention");
-  if (Subtarget.inM650216HardFloat()) {
-    if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(CLI.Callee)) {
-      StringRef Sym = G->getGlobal()->getName();
-      Function *F = G->getGlobal()->getParent()->getFunction(Sym);
-      if (F && F->hasFnAttribute("__M650216RetHelper")) {
-        Mask = M6502RegisterInfo::getM650216RetHelperMask();
-      }
-    }
-  }
   Ops.push_back(CLI.DAG.getRegisterMask(Mask));
 
   if (InFlag.getNode())
@@ -2948,92 +1376,60 @@ M6502TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   bool IsVarArg                         = CLI.IsVarArg;
 
   MachineFunction &MF = DAG.getMachineFunction();
-  MachineFrameInfo &MFI = MF.getFrameInfo();
-  const TargetFrameLowering *TFL = Subtarget.getFrameLowering();
-  M6502FunctionInfo *FuncInfo = MF.getInfo<M6502FunctionInfo>();
-  bool IsPIC = isPositionIndependent();
+  EVT PtrVT = getPointerTy(DAG.getDataLayout());
 
   // Analyze operands of the call, assigning locations to each operand.
+  const Function *CalleeFn = nullptr;
+  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee))
+    CalleeFn = dyn_cast<Function>(G->getGlobal());
   SmallVector<CCValAssign, 16> ArgLocs;
-  M6502CCState CCInfo(
-      CallConv, IsVarArg, DAG.getMachineFunction(), ArgLocs, *DAG.getContext(),
-      M6502CCState::getSpecialCallingConvForCallee(Callee.getNode(), Subtarget));
-
-  // Allocate the reserved argument area. It seems strange to do this from the
-  // caller side but removing it breaks the frame size calculation.
-  CCInfo.AllocateStack(ABI.GetCalleeAllocdArgSizeInBytes(CallConv), 1);
-
-  const ExternalSymbolSDNode *ES =
-      dyn_cast_or_null<const ExternalSymbolSDNode>(Callee.getNode());
-  CCInfo.AnalyzeCallOperands(Outs, CC_M6502, CLI.getArgs(),
-                             ES ? ES->getSymbol() : nullptr);
+  M6502CCState CCInfo(CallConv, IsVarArg, MF, ArgLocs, *DAG.getContext(),
+                      CalleeFn, Outs);
+  CCInfo.AnalyzeCallOperands(Outs, CC_M6502);
 
   // Get a count of how many bytes are to be pushed on the stack.
   unsigned NextStackOffset = CCInfo.getNextStackOffset();
 
-  // Check if it's really possible to do a tail call. Restrict it to functions
-  // that are part of this compilation unit.
-  bool InternalLinkage = false;
-  if (IsTailCall) {
+  // The return address lives on the hardware stack, out of reach of the
+  // callee's epilogue, so calls are never turned into jumps.
+  if (IsTailCall)
     IsTailCall = isEligibleForTailCallOptimization(
         CCInfo, NextStackOffset, *MF.getInfo<M6502FunctionInfo>());
-     if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee)) {
-      InternalLinkage = G->getGlobal()->hasInternalLinkage();
-      IsTailCall &= (InternalLinkage || G->getGlobal()->hasLocalLinkage() ||
-                     G->getGlobal()->hasPrivateLinkage() ||
-                     G->getGlobal()->hasHiddenVisibility() ||
-                     G->getGlobal()->hasProtectedVisibility());
-     }
-  }
   if (!IsTailCall && CLI.CS && CLI.CS.isMustTailCall())
     report_fatal_error("failed to perform tail call elimination on a call "
                        "site marked musttail");
 
-  if (IsTailCall)
-    ++NumTailCalls;
-
   // Chain is the output chain of the last Load/Store or CopyToReg node.
-  // ByValChain is the output chain of the last Memcpy node created for copying
-  // byval arguments to the stack.
-  unsigned StackAlignment = TFL->getStackAlignment();
-  NextStackOffset = alignTo(NextStackOffset, StackAlignment);
   SDValue NextStackOffsetVal = DAG.getIntPtrConstant(NextStackOffset, DL, true);
-
-  if (!IsTailCall)
-    Chain = DAG.getCALLSEQ_START(Chain, NextStackOffset, 0, DL);
+  Chain = DAG.getCALLSEQ_START(Chain, NextStackOffset, 0, DL);
 
   SDValue StackPtr =
-      DAG.getCopyFromReg(Chain, DL, ABI.IsN64() ? M6502::SP_64 : M6502::SP,
-                         getPointerTy(DAG.getDataLayout()));
+      DAG.getCopyFromReg(Chain, DL, ABI.GetStackPtr(), PtrVT);
 
   std::deque<std::pair<unsigned, SDValue>> RegsToPass;
+  static const unsigned CPUArgRegs[] = {M6502::A, M6502::X, M6502::Y};
+  SDValue CPUArgs[array_lengthof(CPUArgRegs)];
   SmallVector<SDValue, 8> MemOpChains;
 
-  CCInfo.rewindByValRegsInfo();
-
   // Walk the register/memloc assignments, inserting copies/loads.
   for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
     SDValue Arg = OutVals[i];
     CCValAssign &VA = ArgLocs[i];
-    MVT ValVT = VA.getValVT(), LocVT = VA.getLocVT();
+    MVT LocVT = VA.getLocVT();
     ISD::ArgFlagsTy Flags = Outs[i].Flags;
-    bool UseUpperBits = false;
 
-    // ByVal Arg.
+    // ByVal Arg.  The outgoing argument area is at the bottom of the caller's
+    // frame, so the aggregate is simply copied there.
     if (Flags.isByVal()) {
-      unsigned FirstByValReg, LastByValReg;
-      unsigned ByValIdx = CCInfo.getInRegsParamsProcessed();
-      CCInfo.getInRegsParamInfo(ByValIdx, FirstByValReg, LastByValReg);
-
-      assert(Flags.getByValSize() &&
-             "ByVal args of size 0 should have been ignored by front-end.");
-      assert(ByValIdx < CCInfo.getInRegsParamsCount());
-      assert(!IsTailCall &&
-             "Do not tail-call optimize if there is a byval argument.");
-      passByValArg(Chain, DL, RegsToPass, MemOpChains, StackPtr, MFI, DAG, Arg,
-                   FirstByValReg, LastByValReg, Flags, Subtarget.isLittle(),
-                   VA);
-      CCInfo.nextInRegsParam();
+      assert(VA.isMemLoc() && "byval arguments are passed on the stack");
+      SDValue Dst = DAG.getNode(ISD::ADD, DL, PtrVT, StackPtr,
+                                DAG.getIntPtrConstant(VA.getLocMemOffset(),
+                                                      DL));
+      SDValue SizeNode = DAG.getConstant(Flags.getByValSize(), DL, PtrVT);
+      MemOpChains.push_back(DAG.getMemcpy(
+          Chain, DL, Dst, Arg, SizeNode, Flags.getByValAlign(),
+          /*isVolatile=*/false, /*AlwaysInline=*/false, /*isTailCall=*/false,
+          MachinePointerInfo(), MachinePointerInfo()));
       continue;
     }
 
@@ -3042,61 +1438,30 @@ M6502TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
     default:
       llvm_unreachable("Unknown loc info!");
     case CCValAssign::Full:
-      if (VA.isRegLoc()) {
-        if ((ValVT == MVT::f32 && LocVT == MVT::i32) ||
-            (ValVT == MVT::f64 && LocVT == MVT::i64) ||
-            (ValVT == MVT::i64 && LocVT == MVT::f64))
-          Arg = DAG.getNode(ISD::BITCAST, DL, LocVT, Arg);
-        else if (ValVT == MVT::f64 && LocVT == MVT::i32) {
-          SDValue Lo = DAG.getNode(M6502ISD::ExtractElementF64, DL, MVT::i32,
-                                   Arg, DAG.getConstant(0, DL, MVT::i32));
-          SDValue Hi = DAG.getNode(M6502ISD::ExtractElementF64, DL, MVT::i32,
-                                   Arg, DAG.getConstant(1, DL, MVT::i32));
-          if (!Subtarget.isLittle())
-            std::swap(Lo, Hi);
-          unsigned LocRegLo = VA.getLocReg();
-          unsigned LocRegHigh = getNextIntArgReg(LocRegLo);
-          RegsToPass.push_back(std::make_pair(LocRegLo, Lo));
-          RegsToPass.push_back(std::make_pair(LocRegHigh, Hi));
-          continue;
-        }
-      }
       break;
     case CCValAssign::BCvt:
       Arg = DAG.getNode(ISD::BITCAST, DL, LocVT, Arg);
       break;
-    case CCValAssign::SExtUpper:
-      UseUpperBits = true;
-      LLVM_FALLTHROUGH;
     case CCValAssign::SExt:
       Arg = DAG.getNode(ISD::SIGN_EXTEND, DL, LocVT, Arg);
       break;
-    case CCValAssign::ZExtUpper:
-      UseUpperBits = true;
-      LLVM_FALLTHROUGH;
     case CCValAssign::ZExt:
       Arg = DAG.getNode(ISD::ZERO_EXTEND, DL, LocVT, Arg);
       break;
-    case CCValAssign::AExtUpper:
-      UseUpperBits = true;
-      LLVM_FALLTHROUGH;
     case CCValAssign::AExt:
       Arg = DAG.getNode(ISD::ANY_EXTEND, DL, LocVT, Arg);
       break;
     }
 
-    if (UseUpperBits) {
-      unsigned ValSizeInBits = Outs[i].ArgVT.getSizeInBits();
-      unsigned LocSizeInBits = VA.getLocVT().getSizeInBits();
-      Arg = DAG.getNode(
-          ISD::SHL, DL, VA.getLocVT(), Arg,
-          DAG.getConstant(LocSizeInBits - ValSizeInBits, DL, VA.getLocVT()));
-    }
-
     // Arguments that can be passed on register must be kept at
-    // RegsToPass vector
+    // RegsToPass vector, except those passed in A, X and Y which become
+    // operands of the call.
     if (VA.isRegLoc()) {
-      RegsToPass.push_back(std::make_pair(VA.getLocReg(), Arg));
+      const unsigned *CPUReg = find(CPUArgRegs, VA.getLocReg());
+      if (CPUReg != std::end(CPUArgRegs))
+        CPUArgs[CPUReg - CPUArgRegs] = Arg;
+      else
+        RegsToPass.push_back(std::make_pair(VA.getLocReg(), Arg));
       continue;
     }
 
@@ -3106,7 +1471,7 @@ M6502TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
     // emit ISD::STORE whichs stores the
     // parameter value to a stack Location
     MemOpChains.push_back(passArgOnStack(StackPtr, VA.getLocMemOffset(),
-                                         Chain, Arg, DL, IsTailCall, DAG));
+                                         Chain, Arg, DL, DAG));
   }
 
   // Transform all store nodes into one single node because all store
@@ -3117,92 +1482,29 @@ M6502TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   // If the callee is a GlobalAddress/ExternalSymbol node (quite common, every
   // direct call is) turn it into a TargetGlobalAddress/TargetExternalSymbol
   // node so that legalize doesn't hack it.
-
-  EVT Ty = Callee.getValueType();
-  bool GlobalOrExternal = false, IsCallReloc = false;
-
-  // The long-calls feature is ignored in case of PIC.
-  // While we do not support -mshared / -mno-shared properly,
-  // ignore long-calls in case of -mabicalls too.
-  if (!Subtarget.isABICalls() && !IsPIC) {
-    // If the function should be called using "long call",
-    // get its address into a register to prevent using
-    // of the `jal` instruction for the direct call.
-    if (auto *N = dyn_cast<ExternalSymbolSDNode>(Callee)) {
-      if (Subtarget.useLongCalls())
-        Callee = Subtarget.hasSym32()
-                     ? getAddrNonPIC(N, SDLoc(N), Ty, DAG)
-                     : getAddrNonPICSym64(N, SDLoc(N), Ty, DAG);
-    } else if (auto *N = dyn_cast<GlobalAddressSDNode>(Callee)) {
-      bool UseLongCalls = Subtarget.useLongCalls();
-      // If the function has long-call/far/near attribute
-      // it overrides command line switch pased to the backend.
-      if (auto *F = dyn_cast<Function>(N->getGlobal())) {
-        if (F->hasFnAttribute("long-call"))
-          UseLongCalls = true;
-        else if (F->hasFnAttribute("short-call"))
-          UseLongCalls = false;
-      }
-      if (UseLongCalls)
-        Callee = Subtarget.hasSym32()
-                     ? getAddrNonPIC(N, SDLoc(N), Ty, DAG)
-                     : getAddrNonPICSym64(N, SDLoc(N), Ty, DAG);
-    }
-  }
-
-  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee)) {
-    if (IsPIC) {
-      const GlobalValue *Val = G->getGlobal();
-      InternalLinkage = Val->hasInternalLinkage();
-
-      if (InternalLinkage)
-        Callee = getAddrLocal(G, DL, Ty, DAG, ABI.IsN32() || ABI.IsN64());
-      else if (LargeGOT) {
-        Callee = getAddrGlobalLargeGOT(G, DL, Ty, DAG, M6502II::MO_CALL_HI16,
-                                       M6502II::MO_CALL_LO16, Chain,
-                                       FuncInfo->callPtrInfo(Val));
-        IsCallReloc = true;
-      } else {
-        Callee = getAddrGlobal(G, DL, Ty, DAG, M6502II::MO_GOT_CALL, Chain,
-                               FuncInfo->callPtrInfo(Val));
-        IsCallReloc = true;
-      }
-    } else
-      Callee = DAG.getTargetGlobalAddress(G->getGlobal(), DL,
-                                          getPointerTy(DAG.getDataLayout()), 0,
-                                          M6502II::MO_NO_FLAG);
-    GlobalOrExternal = true;
-  }
-  else if (ExternalSymbolSDNode *S = dyn_cast<ExternalSymbolSDNode>(Callee)) {
-    const char *Sym = S->getSymbol();
-
-    if (!IsPIC) // static
-      Callee = DAG.getTargetExternalSymbol(
-          Sym, getPointerTy(DAG.getDataLayout()), M6502II::MO_NO_FLAG);
-    else if (LargeGOT) {
-      Callee = getAddrGlobalLargeGOT(S, DL, Ty, DAG, M6502II::MO_CALL_HI16,
-                                     M6502II::MO_CALL_LO16, Chain,
-                                     FuncInfo->callPtrInfo(Sym));
-      IsCallReloc = true;
-    } else { // PIC
-      Callee = getAddrGlobal(S, DL, Ty, DAG, M6502II::MO_GOT_CALL, Chain,
-                             FuncInfo->callPtrInfo(Sym));
-      IsCallReloc = true;
-    }
-
-    GlobalOrExternal = true;
-  }
+  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee))
+    Callee = DAG.getTargetGlobalAddress(G->getGlobal(), DL, PtrVT, 0,
+                                        M6502II::MO_NO_FLAG);
+  else if (ExternalSymbolSDNode *S = dyn_cast<ExternalSymbolSDNode>(Callee))
+    Callee = DAG.getTargetExternalSymbol(S->getSymbol(), PtrVT,
+                                         M6502II::MO_NO_FLAG);
 
   SmallVector<SDValue, 8> Ops(1, Chain);
   SDVTList NodeTys = DAG.getVTList(MVT::Other, MVT::Glue);
 
-  getOpndList(Ops, RegsToPass, IsPIC, GlobalOrExternal, InternalLinkage,
-              IsCallReloc, CLI, Callee, Chain);
-
-  if (IsTailCall) {
-    MF.getFrameInfo().setHasTailCall();
-    return DAG.getNode(M6502ISD::TailCall, DL, MVT::Other, Ops);
-  }
+  getOpndList(Ops, RegsToPass, CLI, Callee, Chain);
+  // The arguments passed in A, X and Y follow the callee, after an immediate
+  // with a bit for each of them, as the other argument registers are
+  // explicit operands too.
+  SmallVector<SDValue, 4> CPUOps(1);
+  unsigned CPUArgMask = 0;
+  for (unsigned Idx = 0; Idx != array_lengthof(CPUArgs); ++Idx)
+    if (CPUArgs[Idx]) {
+      CPUOps.push_back(CPUArgs[Idx]);
+      CPUArgMask |= 1u << Idx;
+    }
+  CPUOps[0] = DAG.getTargetConstant(CPUArgMask, DL, MVT::i8);
+  Ops.insert(Ops.begin() + 2, CPUOps.begin(), CPUOps.end());
 
   Chain = DAG.getNode(M6502ISD::JmpLink, DL, NodeTys, Ops);
   SDValue InFlag = Chain.getValue(1);
@@ -3215,7 +1517,7 @@ M6502TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   // Handle result values, copying them out of physregs into vregs that we
   // return.
   return LowerCallResult(Chain, InFlag, CallConv, IsVarArg, Ins, DL, DAG,
-                         InVals, CLI);
+                         InVals);
 }
 
 /// LowerCallResult - Lower the result values of a call into the
@@ -3223,38 +1525,23 @@ M6502TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
 SDValue M6502TargetLowering::LowerCallResult(
     SDValue Chain, SDValue InFlag, CallingConv::ID CallConv, bool IsVarArg,
     const SmallVectorImpl<ISD::InputArg> &Ins, const SDLoc &DL,
-    SelectionDAG &DAG, SmallVectorImpl<SDValue> &InVals,
-    TargetLowering::CallLoweringInfo &CLI) const {
+    SelectionDAG &DAG, SmallVectorImpl<SDValue> &InVals) const {
   // Assign locations to each value returned by this call.
   SmallVector<CCValAssign, 16> RVLocs;
-  M6502CCState CCInfo(CallConv, IsVarArg, DAG.getMachineFunction(), RVLocs,
-                     *DAG.getContext());
-
-  const ExternalSymbolSDNode *ES =
-      dyn_cast_or_null<const ExternalSymbolSDNode>(CLI.Callee.getNode());
-  CCInfo.AnalyzeCallResult(Ins, RetCC_M6502, CLI.RetTy,
-                           ES ? ES->getSymbol() : nullptr);
+  CCState CCInfo(CallConv, IsVarArg, DAG.getMachineFunction(), RVLocs,
+                 *DAG.getContext());
+  CCInfo.AnalyzeCallResult(Ins, RetCC_M6502);
 
   // Copy all of the result registers out of their specified physreg.
   for (unsigned i = 0; i != RVLocs.size(); ++i) {
     CCValAssign &VA = RVLocs[i];
     assert(VA.isRegLoc() && "Can only return in registers!");
 
-    SDValue Val = DAG.getCopyFromReg(Chain, DL, RVLocs[i].getLocReg(),
-                                     RVLocs[i].getLocVT(), InFlag);
+    SDValue Val = DAG.getCopyFromReg(Chain, DL, VA.getLocReg(),
+                                     VA.getLocVT(), InFlag);
     Chain = Val.getValue(1);
     InFlag = Val.getValue(2);
 
-    if (VA.isUpperBitsInLoc()) {
-      unsigned ValSizeInBits = Ins[i].ArgVT.getSizeInBits();
-      unsigned LocSizeInBits = VA.getLocVT().getSizeInBits();
-      unsigned Shift =
-          VA.getLocInfo() == CCValAssign::ZExtUpper ? ISD::SRL : ISD::SRA;
-      Val = DAG.getNode(
-          Shift, DL, VA.getLocVT(), Val,
-          DAG.getConstant(LocSizeInBits - ValSizeInBits, DL, VA.getLocVT()));
-    }
-
     switch (VA.getLocInfo()) {
     default:
       llvm_unreachable("Unknown loc info!");
@@ -3264,17 +1551,14 @@ SDValue M6502TargetLowering::LowerCallResult(
       Val = DAG.getNode(ISD::BITCAST, DL, VA.getValVT(), Val);
       break;
     case CCValAssign::AExt:
-    case CCValAssign::AExtUpper:
       Val = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), Val);
       break;
     case CCValAssign::ZExt:
-    case CCValAssign::ZExtUpper:
       Val = DAG.getNode(ISD::AssertZext, DL, VA.getLocVT(), Val,
                         DAG.getValueType(VA.getValVT()));
       Val = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), Val);
       break;
     case CCValAssign::SExt:
-    case CCValAssign::SExtUpper:
       Val = DAG.getNode(ISD::AssertSext, DL, VA.getLocVT(), Val,
                         DAG.getValueType(VA.getValVT()));
       Val = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), Val);
@@ -3287,61 +1571,6 @@ SDValue M6502TargetLowering::LowerCallResult(
   return Chain;
 }
 
-static SDValue UnpackFromArgumentSlot(SDValue Val, const CCValAssign &VA,
-                                      EVT ArgVT, const SDLoc &DL,
-                                      SelectionDAG &DAG) {
-  MVT LocVT = VA.getLocVT();
-  EVT ValVT = VA.getValVT();
-
-  // Shift into the upper bits if necessary.
-  switch (VA.getLocInfo()) {
-  default:
-    break;
-  case CCValAssign::AExtUpper:
-  case CCValAssign::SExtUpper:
-  case CCValAssign::ZExtUpper: {
-    unsigned ValSizeInBits = ArgVT.getSizeInBits();
-    unsigned LocSizeInBits = VA.getLocVT().getSizeInBits();
-    unsigned Opcode =
-        VA.getLocInfo() == CCValAssign::ZExtUpper ? ISD::SRL : ISD::SRA;
-    Val = DAG.getNode(
-        Opcode, DL, VA.getLocVT(), Val,
-        DAG.getConstant(LocSizeInBits - ValSizeInBits, DL, VA.getLocVT()));
-    break;
-  }
-  }
-
-  // If this is an value smaller than the argument slot size (32-bit for O32,
-  // 64-bit for N32/N64), it has been promoted in some way to the argument slot
-  // size. Extract the value and insert any appropriate assertions regarding
-  // sign/zero extension.
-  switch (VA.getLocInfo()) {
-  default:
-    llvm_unreachable("Unknown loc info!");
-  case CCValAssign::Full:
-    break;
-  case CCValAssign::AExtUpper:
-  case CCValAssign::AExt:
-    Val = DAG.getNode(ISD::TRUNCATE, DL, ValVT, Val);
-    break;
-  case CCValAssign::SExtUpper:
-  case CCValAssign::SExt:
-    Val = DAG.getNode(ISD::AssertSext, DL, LocVT, Val, DAG.getValueType(ValVT));
-    Val = DAG.getNode(ISD::TRUNCATE, DL, ValVT, Val);
-    break;
-  case CCValAssign::ZExtUpper:
-  case CCValAssign::ZExt:
-    Val = DAG.getNode(ISD::AssertZext, DL, LocVT, Val, DAG.getValueType(ValVT));
-    Val = DAG.getNode(ISD::TRUNCATE, DL, ValVT, Val);
-    break;
-  case CCValAssign::BCvt:
-    Val = DAG.getNode(ISD::BITCAST, DL, ValVT, Val);
-    break;
-  }
-
-  return Val;
-}
-
 //===----------------------------------------------------------------------===//
 //             Formal Arguments Calling Convention Implementation
 //===----------------------------------------------------------------------===//
@@ -3354,6 +1583,7 @@ SDValue M6502TargetLowering::LowerFormalArguments(
   MachineFunction &MF = DAG.getMachineFunction();
   MachineFrameInfo &MFI = MF.getFrameInfo();
   M6502FunctionInfo *M6502FI = MF.getInfo<M6502FunctionInfo>();
+  EVT PtrVT = getPointerTy(DAG.getDataLayout());
 
   M6502FI->setVarArgsFrameIndex(0);
 
@@ -3362,50 +1592,35 @@ SDValue M6502TargetLowering::LowerFormalArguments(
 
   // Assign locations to all of the incoming arguments.
   SmallVector<CCValAssign, 16> ArgLocs;
-  M6502CCState CCInfo(CallConv, IsVarArg, DAG.getMachineFunction(), ArgLocs,
-                     *DAG.getContext());
-  CCInfo.AllocateStack(ABI.GetCalleeAllocdArgSizeInBytes(CallConv), 1);
-  const Function *Func = DAG.getMachineFunction().getFunction();
-  Function::const_arg_iterator FuncArg = Func->arg_begin();
+  M6502CCState CCInfo(CallConv, IsVarArg, MF, ArgLocs, *DAG.getContext(),
+                      Ins);
 
-  if (Func->hasFnAttribute("interrupt") && !Func->arg_empty())
+  if (MF.getFunction()->hasFnAttribute("interrupt") &&
+      !MF.getFunction()->arg_empty())
     report_fatal_error(
         "Functions with the interrupt attribute cannot have arguments!");
 
-  CCInfo.AnalyzeFormalArguments(Ins, CC_M6502_FixedArg);
-  M6502FI->setFormalArgInfo(CCInfo.getNextStackOffset(),
-                           CCInfo.getInRegsParamsCount() > 0);
-
-  unsigned CurArgIdx = 0;
-  CCInfo.rewindByValRegsInfo();
+  CCInfo.AnalyzeFormalArguments(Ins, CC_M6502);
+  M6502FI->setFormalArgInfo(CCInfo.getNextStackOffset(), false);
 
   for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
     CCValAssign &VA = ArgLocs[i];
-    if (Ins[i].isOrigArg()) {
-      std::advance(FuncArg, Ins[i].getOrigArgIndex() - CurArgIdx);
-      CurArgIdx = Ins[i].getOrigArgIndex();
-    }
-    EVT ValVT = VA.getValVT();
     ISD::ArgFlagsTy Flags = Ins[i].Flags;
-    bool IsRegLoc = VA.isRegLoc();
 
+    // The aggregate has been copied to the outgoing argument area by the
+    // caller: its address is that of a fixed stack object.
     if (Flags.isByVal()) {
-      assert(Ins[i].isOrigArg() && "Byval arguments cannot be implicit");
-      unsigned FirstByValReg, LastByValReg;
-      unsigned ByValIdx = CCInfo.getInRegsParamsProcessed();
-      CCInfo.getInRegsParamInfo(ByValIdx, FirstByValReg, LastByValReg);
-
       assert(Flags.getByValSize() &&
              "ByVal args of size 0 should have been ignored by front-end.");
-      assert(ByValIdx < CCInfo.getInRegsParamsCount());
-      copyByValRegs(Chain, DL, OutChains, DAG, Flags, InVals, &*FuncArg,
-                    FirstByValReg, LastByValReg, VA, CCInfo);
-      CCInfo.nextInRegsParam();
+      M6502FI->setFormalArgInfo(CCInfo.getNextStackOffset(), true);
+      int FI = MFI.CreateFixedObject(Flags.getByValSize(),
+                                     VA.getLocMemOffset(), true);
+      InVals.push_back(DAG.getFrameIndex(FI, PtrVT));
       continue;
     }
 
     // Arguments stored on registers
-    if (IsRegLoc) {
+    if (VA.isRegLoc()) {
       MVT RegVT = VA.getLocVT();
       unsigned ArgReg = VA.getLocReg();
       const TargetRegisterClass *RC = getRegClassFor(RegVT);
@@ -3415,38 +1630,22 @@ SDValue M6502TargetLowering::LowerFormalArguments(
       unsigned Reg = addLiveIn(DAG.getMachineFunction(), ArgReg, RC);
       SDValue ArgValue = DAG.getCopyFromReg(Chain, DL, Reg, RegVT);
 
-      ArgValue = UnpackFromArgumentSlot(ArgValue, VA, Ins[i].ArgVT, DL, DAG);
-
-      // Handle floating point arguments passed in integer registers and
-      // long double arguments passed in floating point registers.
-      if ((RegVT == MVT::i32 && ValVT == MVT::f32) ||
-          (RegVT == MVT::i64 && ValVT == MVT::f64) ||
-          (RegVT == MVT::f64 && ValVT == MVT::i64))
-        ArgValue = DAG.getNode(ISD::BITCAST, DL, ValVT, ArgValue);
-      else if (ABI.IsO32() && RegVT == MVT::i32 &&
-               ValVT == MVT::f64) {
-        unsigned Reg2 = addLiveIn(DAG.getMachineFunction(),
-                                  getNextIntArgReg(ArgReg), RC);
-        SDValue ArgValue2 = DAG.getCopyFromReg(Chain, DL, Reg2, RegVT);
-        if (!Subtarget.isLittle())
-          std::swap(ArgValue, ArgValue2);
-        ArgValue = DAG.getNode(M6502ISD::BuildPairF64, DL, MVT::f64,
-                               ArgValue, ArgValue2);
-      }
+      // If this is an 8 bit value, it is really passed promoted to 16 bits.
+      // Insert an assert[sz]ext to capture this, then truncate to the right
+      // size.
+      if (VA.getLocInfo() == CCValAssign::SExt)
+        ArgValue = DAG.getNode(ISD::AssertSext, DL, RegVT, ArgValue,
+                               DAG.getValueType(VA.getValVT()));
+      else if (VA.getLocInfo() == CCValAssign::ZExt)
+        ArgValue = DAG.getNode(ISD::AssertZext, DL, RegVT, ArgValue,
+                               DAG.getValueType(VA.getValVT()));
+      if (VA.getLocInfo() != CCValAssign::Full)
+        ArgValue = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), ArgValue);
 
       InVals.push_back(ArgValue);
     } else { // VA.isRegLoc()
       MVT LocVT = VA.getLocVT();
 
-      if (ABI.IsO32()) {
-        // We ought to be able to use LocVT directly but O32 sets it to i32
-        // when allocating floating point values to integer registers.
-        // This shouldn't influence how we load the value into registers unless
-        // we are targeting softfloat.
-        if (VA.getValVT().isFloatingPoint() && !Subtarget.useSoftFloat())
-          LocVT = VA.getValVT();
-      }
-
       // sanity check
       assert(VA.isMemLoc());
 
@@ -3455,37 +1654,24 @@ SDValue M6502TargetLowering::LowerFormalArguments(
                                      VA.getLocMemOffset(), true);
 
       // Create load nodes to retrieve arguments from the stack
-      SDValue FIN = DAG.getFrameIndex(FI, getPointerTy(DAG.getDataLayout()));
+      SDValue FIN = DAG.getFrameIndex(FI, PtrVT);
       SDValue ArgValue = DAG.getLoad(
           LocVT, DL, Chain, FIN,
           MachinePointerInfo::getFixedStack(DAG.getMachineFunction(), FI));
       OutChains.push_back(ArgValue.getValue(1));
 
-      ArgValue = UnpackFromArgumentSlot(ArgValue, VA, Ins[i].ArgVT, DL, DAG);
+      if (VA.getLocInfo() != CCValAssign::Full)
+        ArgValue = DAG.getNode(ISD::TRUNCATE, DL, VA.getValVT(), ArgValue);
 
       InVals.push_back(ArgValue);
     }
   }
 
-  for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
-    // The m6502 ABIs for returning structs by value requires that we copy
-    // the sret argument into $v0 for the return. Save the argument into
-    // a virtual register so that we can access it from the return points.
-    if (Ins[i].Flags.isSRet()) {
-      unsigned Reg = M6502FI->getSRetReturnReg();
-      if (!Reg) {
-        Reg = MF.getRegInfo().createVirtualRegister(
-            getRegClassFor(ABI.IsN64() ? MVT::i64 : MVT::i32));
-        M6502FI->setSRetReturnReg(Reg);
-      }
-      SDValue Copy = DAG.getCopyToReg(DAG.getEntryNode(), DL, Reg, InVals[i]);
-      Chain = DAG.getNode(ISD::TokenFactor, DL, MVT::Other, Copy, Chain);
-      break;
-    }
-  }
-
+  // Variable arguments are all passed on the stack, right after the fixed
+  // ones.
   if (IsVarArg)
-    writeVarArgRegs(OutChains, Chain, DL, DAG, CCInfo);
+    M6502FI->setVarArgsFrameIndex(
+        MFI.CreateFixedObject(1, CCInfo.getNextStackOffset(), true));
 
   // All stores are grouped in one node to allow the matching between
   // the size of Ins and InVals. This only happens when on varg functions
@@ -3507,31 +1693,10 @@ M6502TargetLowering::CanLowerReturn(CallingConv::ID CallConv,
                                    const SmallVectorImpl<ISD::OutputArg> &Outs,
                                    LLVMContext &Context) const {
   SmallVector<CCValAssign, 16> RVLocs;
-  M6502CCState CCInfo(CallConv, IsVarArg, MF, RVLocs, Context);
+  CCState CCInfo(CallConv, IsVarArg, MF, RVLocs, Context);
   return CCInfo.CheckReturn(Outs, RetCC_M6502);
 }
 
-bool
-M6502TargetLowering::shouldSignExtendTypeInLibCall(EVT Type, bool IsSigned) const {
-  if (Subtarget.hasM65023() && Subtarget.useSoftFloat()) {
-    if (Type == MVT::i32)
-      return true;
-  }
-  return IsSigned;
-}
-
-SDValue
-M6502TargetLowering::LowerInterruptReturn(SmallVectorImpl<SDValue> &RetOps,
-                                         const SDLoc &DL,
-                                         SelectionDAG &DAG) const {
-  MachineFunction &MF = DAG.getMachineFunction();
-  M6502FunctionInfo *M6502FI = MF.getInfo<M6502FunctionInfo>();
-
-  M6502FI->setISR();
-
-  return DAG.getNode(M6502ISD::ERet, DL, MVT::Other, RetOps);
-}
-
 SDValue
 M6502TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallConv,
                                 bool IsVarArg,
@@ -3544,11 +1709,18 @@ M6502TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallConv,
   MachineFunction &MF = DAG.getMachineFunction();
 
   // CCState - Info about the registers and stack slot.
-  M6502CCState CCInfo(CallConv, IsVarArg, MF, RVLocs, *DAG.getContext());
+  CCState CCInfo(CallConv, IsVarArg, MF, RVLocs, *DAG.getContext());
 
   // Analyze return values.
   CCInfo.AnalyzeReturn(Outs, RetCC_M6502);
 
+  // An interrupt handler returns with RTI, which restores P.  Nothing can
+  // receive a value from it.
+  bool IsInterrupt = MF.getFunction()->hasFnAttribute("interrupt");
+  if (IsInterrupt && !RVLocs.empty())
+    report_fatal_error(
+        "Functions with the interrupt attribute cannot return a value!");
+
   SDValue Flag;
   SmallVector<SDValue, 4> RetOps(1, Chain);
 
@@ -3557,7 +1729,6 @@ M6502TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallConv,
     SDValue Val = OutVals[i];
     CCValAssign &VA = RVLocs[i];
     assert(VA.isRegLoc() && "Can only return in registers!");
-    bool UseUpperBits = false;
 
     switch (VA.getLocInfo()) {
     default:
@@ -3567,34 +1738,17 @@ M6502TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallConv,
     case CCValAssign::BCvt:
       Val = DAG.getNode(ISD::BITCAST, DL, VA.getLocVT(), Val);
       break;
-    case CCValAssign::AExtUpper:
-      UseUpperBits = true;
-      LLVM_FALLTHROUGH;
     case CCValAssign::AExt:
       Val = DAG.getNode(ISD::ANY_EXTEND, DL, VA.getLocVT(), Val);
       break;
-    case CCValAssign::ZExtUpper:
-      UseUpperBits = true;
-      LLVM_FALLTHROUGH;
     case CCValAssign::ZExt:
       Val = DAG.getNode(ISD::ZERO_EXTEND, DL, VA.getLocVT(), Val);
       break;
-    case CCValAssign::SExtUpper:
-      UseUpperBits = true;
-      LLVM_FALLTHROUGH;
     case CCValAssign::SExt:
       Val = DAG.getNode(ISD::SIGN_EXTEND, DL, VA.getLocVT(), Val);
       break;
     }
 
-    if (UseUpperBits) {
-      unsigned ValSizeInBits = Outs[i].ArgVT.getSizeInBits();
-      unsigned LocSizeInBits = VA.getLocVT().getSizeInBits();
-      Val = DAG.getNode(
-          ISD::SHL, DL, VA.getLocVT(), Val,
-          DAG.getConstant(LocSizeInBits - ValSizeInBits, DL, VA.getLocVT()));
-    }
-
     Chain = DAG.getCopyToReg(Chain, DL, VA.getLocReg(), Val, Flag);
 
     // Guarantee that all emitted copies are stuck together with flags.
@@ -3602,37 +1756,15 @@ M6502TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallConv,
     RetOps.push_back(DAG.getRegister(VA.getLocReg(), VA.getLocVT()));
   }
 
-  // The m6502 ABIs for returning structs by value requires that we copy
-  // the sret argument into $v0 for the return. We saved the argument into
-  // a virtual register in the entry block, so now we copy the value out
-  // and into $v0.
-  if (MF.getFunction()->hasStructRetAttr()) {
-    M6502FunctionInfo *M6502FI = MF.getInfo<M6502FunctionInfo>();
-    unsigned Reg = M6502FI->getSRetReturnReg();
-
-    if (!Reg)
-      llvm_unreachable("sret virtual register not created in the entry block");
-    SDValue Val =
-        DAG.getCopyFromReg(Chain, DL, Reg, getPointerTy(DAG.getDataLayout()));
-    unsigned V0 = ABI.IsN64() ? M6502::V0_64 : M6502::V0;
-
-    Chain = DAG.getCopyToReg(Chain, DL, V0, Val, Flag);
-    Flag = Chain.getValue(1);
-    RetOps.push_back(DAG.getRegister(V0, getPointerTy(DAG.getDataLayout())));
-  }
-
   RetOps[0] = Chain;  // Update chain.
 
   // Add the flag if we have it.
   if (Flag.getNode())
     RetOps.push_back(Flag);
 
-  // ISRs must use "eret".
-  if (DAG.getMachineFunction().getFunction()->hasFnAttribute("interrupt"))
-    return LowerInterruptReturn(RetOps, DL, DAG);
-
-  // Standard return on M6502 is a "jr $ra"
-  return DAG.getNode(M6502ISD::Ret, DL, MVT::Other, RetOps);
+  // Standard return on M6502 is a "rts"
+  return DAG.getNode(IsInterrupt ? M6502ISD::IRet : M6502ISD::Ret, DL,
+                     MVT::Other, RetOps);
 }
 
 //===----------------------------------------------------------------------===//
@@ -3644,740 +1776,80 @@ M6502TargetLowering::LowerReturn(SDValue Chain, CallingConv::ID CallConv,
 M6502TargetLowering::ConstraintType
 M6502TargetLowering::getConstraintType(StringRef Constraint) const {
   // M6502 specific constraints
-  // GCC config/m6502/constraints.md
+  // GCC config/6502/constraints.md
   //
-  // 'd' : An address register. Equivalent to r
-  //       unless generating M650216 code.
-  // 'y' : Equivalent to r; retained for
-  //       backwards compatibility.
-  // 'c' : A register suitable for use in an indirect
-  //       jump. This will always be $25 for -mabicalls.
-  // 'l' : The lo register. 1 word storage.
-  // 'x' : The hilo register pair. Double word storage.
+  // 'a' : The accumulator.
+  // 'x' : The X index register.
+  // 'y' : The Y index register.
   if (Constraint.size() == 1) {
     switch (Constraint[0]) {
       default : break;
-      case 'd':
-      case 'y':
-      case 'f':
-      case 'c':
-      case 'l':
+      case 'a':
       case 'x':
-        return C_RegisterClass;
-      case 'R':
-        return C_Memory;
+      case 'y':
+        return C_Register;
     }
   }
 
-  if (Constraint == "ZC")
-    return C_Memory;
-
   return TargetLowering::getConstraintType(Constraint);
 }
 
-/// Examine constraint type and operand type and determine a weight value.
-/// This object must already have been set up with the operand type
-/// and the current alternative constraint selected.
-TargetLowering::ConstraintWeight
-M6502TargetLowering::getSingleConstraintMatchWeight(
-    AsmOperandInfo &info, const char *constraint) const {
-  ConstraintWeight weight = CW_Invalid;
-  Value *CallOperandVal = info.CallOperandVal;
-    // If we don't have a value, we can't do a match,
-    // but allow it at the lowest weight.
-  if (!CallOperandVal)
-    return CW_Default;
-  Type *type = CallOperandVal->getType();
-  // Look at the constraint type.
-  switch (*constraint) {
-  default:
-    weight = TargetLowering::getSingleConstraintMatchWeight(info, constraint);
-    break;
-  case 'd':
-  case 'y':
-    if (type->isIntegerTy())
-      weight = CW_Register;
-    break;
-  case 'f': // FPU or MSA register
-    if (Subtarget.hasMSA() && type->isVectorTy() &&
-        cast<VectorType>(type)->getBitWidth() == 128)
-      weight = CW_Register;
-    else if (type->isFloatTy())
-      weight = CW_Register;
-    break;
-  case 'c': // $25 for indirect jumps
-  case 'l': // lo register
-  case 'x': // hilo register pair
-    if (type->isIntegerTy())
-      weight = CW_SpecificReg;
-    break;
-  case 'I': // signed 16 bit immediate
-  case 'J': // integer zero
-  case 'K': // unsigned 16 bit immediate
-  case 'L': // signed 32 bit immediate where lower 16 bits are 0
-  case 'N': // immediate in the range of -65535 to -1 (inclusive)
-  case 'O': // signed 15 bit immediate (+- 16383)
-  case 'P': // immediate in the range of 65535 to 1 (inclusive)
-    if (isa<ConstantInt>(CallOperandVal))
-      weight = CW_Constant;
-    break;
-  case 'R':
-    weight = CW_Memory;
-    break;
-  }
-  return weight;
-}
-
-/// This is a helper function to parse a physical register string and split it
-/// into non-numeric and numeric parts (Prefix and Reg). The first boolean flag
-/// that is returned indicates whether parsing was successful. The second flag
-/// is true if the numeric part exists.
-static std::pair<bool, bool> parsePhysicalReg(StringRef C, StringRef &Prefix,
-                                              unsigned long long &Reg) {
-  if (C.front() != '{' || C.back() != '}')
-    return std::make_pair(false, false);
-
-  // Search for the first numeric character.
-  StringRef::const_iterator I, B = C.begin() + 1, E = C.end() - 1;
-  I = std::find_if(B, E, isdigit);
-
-  Prefix = StringRef(B, I - B);
-
-  // The second flag is set to false if no numeric characters were found.
-  if (I == E)
-    return std::make_pair(true, false);
-
-  // Parse the numeric characters.
-  return std::make_pair(!getAsUnsignedInteger(StringRef(I, E - I), 10, Reg),
-                        true);
-}
-
-std::pair<unsigned, const TargetRegisterClass *> M6502TargetLowering::
-parseRegForInlineAsmConstraint(StringRef C, MVT VT) const {
-  const TargetRegisterInfo *TRI =
-      Subtarget.getRegisterInfo();
-  const TargetRegisterClass *RC;
-  StringRef Prefix;
-  unsigned long long Reg;
-
-  std::pair<bool, bool> R = parsePhysicalReg(C, Prefix, Reg);
-
-  if (!R.first)
-    return std::make_pair(0U, nullptr);
-
-  if ((Prefix == "hi" || Prefix == "lo")) { // Parse hi/lo.
-    // No numeric characters follow "hi" or "lo".
-    if (R.second)
-      return std::make_pair(0U, nullptr);
-
-    RC = TRI->getRegClass(Prefix == "hi" ?
-                          M6502::HI32RegClassID : M6502::LO32RegClassID);
-    return std::make_pair(*(RC->begin()), RC);
-  } else if (Prefix.startswith("$msa")) {
-    // Parse $msa(ir|csr|access|save|modify|request|map|unmap)
-
-    // No numeric characters follow the name.
-    if (R.second)
-      return std::make_pair(0U, nullptr);
-
-    Reg = StringSwitch<unsigned long long>(Prefix)
-              .Case("$msair", M6502::MSAIR)
-              .Case("$msacsr", M6502::MSACSR)
-              .Case("$msaaccess", M6502::MSAAccess)
-              .Case("$msasave", M6502::MSASave)
-              .Case("$msamodify", M6502::MSAModify)
-              .Case("$msarequest", M6502::MSARequest)
-              .Case("$msamap", M6502::MSAMap)
-              .Case("$msaunmap", M6502::MSAUnmap)
-              .Default(0);
-
-    if (!Reg)
-      return std::make_pair(0U, nullptr);
-
-    RC = TRI->getRegClass(M6502::MSACtrlRegClassID);
-    return std::make_pair(Reg, RC);
-  }
-
-  if (!R.second)
-    return std::make_pair(0U, nullptr);
-
-  if (Prefix == "$f") { // Parse $f0-$f31.
-    // If the size of FP registers is 64-bit or Reg is an even number, select
-    // the 64-bit register class. Otherwise, select the 32-bit register class.
-    if (VT == MVT::Other)
-      VT = (Subtarget.isFP64bit() || !(Reg % 2)) ? MVT::f64 : MVT::f32;
-
-    RC = getRegClassFor(VT);
-
-    if (RC == &M6502::AFGR64RegClass) {
-      assert(Reg % 2 == 0);
-      Reg >>= 1;
-    }
-  } else if (Prefix == "$fcc") // Parse $fcc0-$fcc7.
-    RC = TRI->getRegClass(M6502::FCCRegClassID);
-  else if (Prefix == "$w") { // Parse $w0-$w31.
-    RC = getRegClassFor((VT == MVT::Other) ? MVT::v16i8 : VT);
-  } else { // Parse $0-$31.
-    assert(Prefix == "$");
-    RC = getRegClassFor((VT == MVT::Other) ? MVT::i32 : VT);
-  }
-
-  assert(Reg < RC->getNumRegs());
-  return std::make_pair(*(RC->begin() + Reg), RC);
-}
-
-/// Given a register class constraint, like 'r', if this corresponds directly
-/// to an LLVM register class, return a register of 0 and the register class
-/// pointer.
 std::pair<unsigned, const TargetRegisterClass *>
 M6502TargetLowering::getRegForInlineAsmConstraint(const TargetRegisterInfo *TRI,
                                                  StringRef Constraint,
                                                  MVT VT) const {
   if (Constraint.size() == 1) {
     switch (Constraint[0]) {
-    case 'd': // Address register. Same as 'r' unless generating M650216 code.
-    case 'y': // Same as 'r'. Exists for compatibility.
     case 'r':
-      if (VT == MVT::i32 || VT == MVT::i16 || VT == MVT::i8) {
-        if (Subtarget.inM650216Mode())
-          return std::make_pair(0U, &M6502::CPU16RegsRegClass);
-        return std::make_pair(0U, &M6502::GPR32RegClass);
-      }
-      if (VT == MVT::i64 && !Subtarget.isGP64bit())
-        return std::make_pair(0U, &M6502::GPR32RegClass);
-      if (VT == MVT::i64 && Subtarget.isGP64bit())
-        return std::make_pair(0U, &M6502::GPR64RegClass);
-      // This will generate an error message
-      return std::make_pair(0U, nullptr);
-    case 'f': // FPU or MSA register
-      if (VT == MVT::v16i8)
-        return std::make_pair(0U, &M6502::MSA128BRegClass);
-      else if (VT == MVT::v8i16 || VT == MVT::v8f16)
-        return std::make_pair(0U, &M6502::MSA128HRegClass);
-      else if (VT == MVT::v4i32 || VT == MVT::v4f32)
-        return std::make_pair(0U, &M6502::MSA128WRegClass);
-      else if (VT == MVT::v2i64 || VT == MVT::v2f64)
-        return std::make_pair(0U, &M6502::MSA128DRegClass);
-      else if (VT == MVT::f32)
-        return std::make_pair(0U, &M6502::FGR32RegClass);
-      else if ((VT == MVT::f64) && (!Subtarget.isSingleFloat())) {
-        if (Subtarget.isFP64bit())
-          return std::make_pair(0U, &M6502::FGR64RegClass);
-        return std::make_pair(0U, &M6502::AFGR64RegClass);
-      }
-      break;
-    case 'c': // register suitable for indirect jump
-      if (VT == MVT::i32)
-        return std::make_pair((unsigned)M6502::T9, &M6502::GPR32RegClass);
-      assert(VT == MVT::i64 && "Unexpected type.");
-      return std::make_pair((unsigned)M6502::T9_64, &M6502::GPR64RegClass);
-    case 'l': // register suitable for indirect jump
-      if (VT == MVT::i32)
-        return std::make_pair((unsigned)M6502::LO0, &M6502::LO32RegClass);
-      return std::make_pair((unsigned)M6502::LO0_64, &M6502::LO64RegClass);
-    case 'x': // register suitable for indirect jump
-      // Fixme: Not triggering the use of both hi and low
-      // This will generate an error message
-      return std::make_pair(0U, nullptr);
+      if (VT == MVT::i16)
+        return std::make_pair(0U, &M6502::ZP16RegClass);
+      return std::make_pair(0U, &M6502::ZP8RegClass);
+    case 'a':
+      return std::make_pair(unsigned(M6502::A), &M6502::ACCRegClass);
+    case 'x':
+      return std::make_pair(unsigned(M6502::X), &M6502::IDXRegClass);
+    case 'y':
+      return std::make_pair(unsigned(M6502::Y), &M6502::IDXRegClass);
     }
   }
 
-  std::pair<unsigned, const TargetRegisterClass *> R;
-  R = parseRegForInlineAsmConstraint(Constraint, VT);
-
-  if (R.second)
-    return R;
-
   return TargetLowering::getRegForInlineAsmConstraint(TRI, Constraint, VT);
 }
 
-/// LowerAsmOperandForConstraint - Lower the specified operand into the Ops
-/// vector.  If it is invalid, don't add anything to Ops.
-void M6502TargetLowering::LowerAsmOperandForConstraint(SDValue Op,
-                                                     std::string &Constraint,
-                                                     std::vector<SDValue>&Ops,
-                                                     SelectionDAG &DAG) const {
-  SDLoc DL(Op);
-  SDValue Result;
-
-  // Only support length 1 constraints for now.
-  if (Constraint.length() > 1) return;
-
-  char ConstraintLetter = Constraint[0];
-  switch (ConstraintLetter) {
-  default: break; // This will fall through to the generic implementation
-  case 'I': // Signed 16 bit constant
-    // If this fails, the parent routine will give an error
-    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op)) {
-      EVT Type = Op.getValueType();
-      int64_t Val = C->getSExtValue();
-      if (isInt<16>(Val)) {
-        Result = DAG.getTargetConstant(Val, DL, Type);
-        break;
-      }
-    }
-    return;
-  case 'J': // integer zero
-    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op)) {
-      EVT Type = Op.getValueType();
-      int64_t Val = C->getZExtValue();
-      if (Val == 0) {
-        Result = DAG.getTargetConstant(0, DL, Type);
-        break;
-      }
-    }
-    return;
-  case 'K': // unsigned 16 bit immediate
-    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op)) {
-      EVT Type = Op.getValueType();
-      uint64_t Val = (uint64_t)C->getZExtValue();
-      if (isUInt<16>(Val)) {
-        Result = DAG.getTargetConstant(Val, DL, Type);
-        break;
-      }
-    }
-    return;
-  case 'L': // signed 32 bit immediate where lower 16 bits are 0
-    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op)) {
-      EVT Type = Op.getValueType();
-      int64_t Val = C->getSExtValue();
-      if ((isInt<32>(Val)) && ((Val & 0xffff) == 0)){
-        Result = DAG.getTargetConstant(Val, DL, Type);
-        break;
-      }
-    }
-    return;
-  case 'N': // immediate in the range of -65535 to -1 (inclusive)
-    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op)) {
-      EVT Type = Op.getValueType();
-      int64_t Val = C->getSExtValue();
-      if ((Val >= -65535) && (Val <= -1)) {
-        Result = DAG.getTargetConstant(Val, DL, Type);
-        break;
-      }
-    }
-    return;
-  case 'O': // signed 15 bit immediate
-    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op)) {
-      EVT Type = Op.getValueType();
-      int64_t Val = C->getSExtValue();
-      if ((isInt<15>(Val))) {
-        Result = DAG.getTargetConstant(Val, DL, Type);
-        break;
-      }
-    }
-    return;
-  case 'P': // immediate in the range of 1 to 65535 (inclusive)
-    if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op)) {
-      EVT Type = Op.getValueType();
-      int64_t Val = C->getSExtValue();
-      if ((Val <= 65535) && (Val >= 1)) {
-        Result = DAG.getTargetConstant(Val, DL, Type);
-        break;
-      }
-    }
-    return;
-  }
-
-  if (Result.getNode()) {
-    Ops.push_back(Result);
-    return;
-  }
-
-  TargetLowering::LowerAsmOperandForConstraint(Op, Constraint, Ops, DAG);
-}
-
 bool M6502TargetLowering::isLegalAddressingMode(const DataLayout &DL,
                                                const AddrMode &AM, Type *Ty,
                                                unsigned AS, Instruction *I) const {
-  // No global is ever allowed as a base.
+  // An absolute address, possibly with a constant offset.
   if (AM.BaseGV)
-    return false;
+    return !AM.HasBaseReg && !AM.Scale;
 
-  switch (AM.Scale) {
-  case 0: // "r+i" or just "i", depending on HasBaseReg.
-    break;
-  case 1:
-    if (!AM.HasBaseReg) // allow "r+i".
-      break;
-    return false; // disallow "r+r" or "r+r+i".
-  default:
+  // A register pair plus an unsigned byte in Y.
+  if (AM.Scale > 1 || (AM.Scale == 1 && AM.HasBaseReg))
     return false;
-  }
 
-  return true;
+  return AM.BaseOffs >= 0 && AM.BaseOffs <= 255;
 }
 
 bool
 M6502TargetLowering::isOffsetFoldingLegal(const GlobalAddressSDNode *GA) const {
-  // The M6502 target isn't yet aware of offsets.
-  return false;
-}
-
-EVT M6502TargetLowering::getOptimalMemOpType(uint64_t Size, unsigned DstAlign,
-                                            unsigned SrcAlign,
-                                            bool IsMemset, bool ZeroMemset,
-                                            bool MemcpyStrSrc,
-                                            MachineFunction &MF) const {
-  if (Subtarget.hasM650264())
-    return MVT::i64;
-
-  return MVT::i32;
-}
-
-bool M6502TargetLowering::isFPImmLegal(const APFloat &Imm, EVT VT) const {
-  if (VT != MVT::f32 && VT != MVT::f64)
-    return false;
-  if (Imm.isNegZero())
-    return false;
-  return Imm.isZero();
+  // Every address is absolute, and a symbol plus an offset is as cheap as
+  // the symbol alone.
+  return true;
 }
 
 unsigned M6502TargetLowering::getJumpTableEncoding() const {
-
-  // FIXME: For space reasons this should be: EK_GPRel32BlockAddress.
-  if (ABI.IsN64() && isPositionIndependent())
-    return MachineJumpTableInfo::EK_GPRel64BlockAddress;
-
-  return TargetLowering::getJumpTableEncoding();
-}
-
-bool M6502TargetLowering::useSoftFloat() const {
-  return Subtarget.useSoftFloat();
-}
-
-void M6502TargetLowering::copyByValRegs(
-    SDValue Chain, const SDLoc &DL, std::vector<SDValue> &OutChains,
-    SelectionDAG &DAG, const ISD::ArgFlagsTy &Flags,
-    SmallVectorImpl<SDValue> &InVals, const Argument *FuncArg,
-    unsigned FirstReg, unsigned LastReg, const CCValAssign &VA,
-    M6502CCState &State) const {
-  MachineFunction &MF = DAG.getMachineFunction();
-  MachineFrameInfo &MFI = MF.getFrameInfo();
-  unsigned GPRSizeInBytes = Subtarget.getGPRSizeInBytes();
-  unsigned NumRegs = LastReg - FirstReg;
-  unsigned RegAreaSize = NumRegs * GPRSizeInBytes;
-  unsigned FrameObjSize = std::max(Flags.getByValSize(), RegAreaSize);
-  int FrameObjOffset;
-  ArrayRef<MCPhysReg> ByValArgRegs = ABI.GetByValArgRegs();
-
-  if (RegAreaSize)
-    FrameObjOffset =
-        (int)ABI.GetCalleeAllocdArgSizeInBytes(State.getCallingConv()) -
-        (int)((ByValArgRegs.size() - FirstReg) * GPRSizeInBytes);
-  else
-    FrameObjOffset = VA.getLocMemOffset();
-
-  // Create frame object.
-  EVT PtrTy = getPointerTy(DAG.getDataLayout());
-  int FI = MFI.CreateFixedObject(FrameObjSize, FrameObjOffset, true);
-  SDValue FIN = DAG.getFrameIndex(FI, PtrTy);
-  InVals.push_back(FIN);
-
-  if (!NumRegs)
-    return;
-
-  // Copy arg registers.
-  MVT RegTy = MVT::getIntegerVT(GPRSizeInBytes * 8);
-  const TargetRegisterClass *RC = getRegClassFor(RegTy);
-
-  for (unsigned I = 0; I < NumRegs; ++I) {
-    unsigned ArgReg = ByValArgRegs[FirstReg + I];
-    unsigned VReg = addLiveIn(MF, ArgReg, RC);
-    unsigned Offset = I * GPRSizeInBytes;
-    SDValue StorePtr = DAG.getNode(ISD::ADD, DL, PtrTy, FIN,
-                                   DAG.getConstant(Offset, DL, PtrTy));
-    SDValue Store = DAG.getStore(Chain, DL, DAG.getRegister(VReg, RegTy),
-                                 StorePtr, MachinePointerInfo(FuncArg, Offset));
-    OutChains.push_back(Store);
-  }
-}
-
-// Copy byVal arg to registers and stack.
-void M6502TargetLowering::passByValArg(
-    SDValue Chain, const SDLoc &DL,
-    std::deque<std::pair<unsigned, SDValue>> &RegsToPass,
-    SmallVectorImpl<SDValue> &MemOpChains, SDValue StackPtr,
-    MachineFrameInfo &MFI, SelectionDAG &DAG, SDValue Arg, unsigned FirstReg,
-    unsigned LastReg, const ISD::ArgFlagsTy &Flags, bool isLittle,
-    const CCValAssign &VA) const {
-  unsigned ByValSizeInBytes = Flags.getByValSize();
-  unsigned OffsetInBytes = 0; // From beginning of struct
-  unsigned RegSizeInBytes = Subtarget.getGPRSizeInBytes();
-  unsigned Alignment = std::min(Flags.getByValAlign(), RegSizeInBytes);
-  EVT PtrTy = getPointerTy(DAG.getDataLayout()),
-      RegTy = MVT::getIntegerVT(RegSizeInBytes * 8);
-  unsigned NumRegs = LastReg - FirstReg;
-
-  if (NumRegs) {
-    ArrayRef<MCPhysReg> ArgRegs = ABI.GetByValArgRegs();
-    bool LeftoverBytes = (NumRegs * RegSizeInBytes > ByValSizeInBytes);
-    unsigned I = 0;
-
-    // Copy words to registers.
-    for (; I < NumRegs - LeftoverBytes; ++I, OffsetInBytes += RegSizeInBytes) {
-      SDValue LoadPtr = DAG.getNode(ISD::ADD, DL, PtrTy, Arg,
-                                    DAG.getConstant(OffsetInBytes, DL, PtrTy));
-      SDValue LoadVal = DAG.getLoad(RegTy, DL, Chain, LoadPtr,
-                                    MachinePointerInfo(), Alignment);
-      MemOpChains.push_back(LoadVal.getValue(1));
-      unsigned ArgReg = ArgRegs[FirstReg + I];
-      RegsToPass.push_back(std::make_pair(ArgReg, LoadVal));
-    }
-
-    // Return if the struct has been fully copied.
-    if (ByValSizeInBytes == OffsetInBytes)
-      return;
-
-    // Copy the remainder of the byval argument with sub-word loads and shifts.
-    if (LeftoverBytes) {
-      SDValue Val;
-
-      for (unsigned LoadSizeInBytes = RegSizeInBytes / 2, TotalBytesLoaded = 0;
-           OffsetInBytes < ByValSizeInBytes; LoadSizeInBytes /= 2) {
-        unsigned RemainingSizeInBytes = ByValSizeInBytes - OffsetInBytes;
-
-        if (RemainingSizeInBytes < LoadSizeInBytes)
-          continue;
-
-        // Load subword.
-        SDValue LoadPtr = DAG.getNode(ISD::ADD, DL, PtrTy, Arg,
-                                      DAG.getConstant(OffsetInBytes, DL,
-                                                      PtrTy));
-        SDValue LoadVal = DAG.getExtLoad(
-            ISD::ZEXTLOAD, DL, RegTy, Chain, LoadPtr, MachinePointerInfo(),
-            MVT::getIntegerVT(LoadSizeInBytes * 8), Alignment);
-        MemOpChains.push_back(LoadVal.getValue(1));
-
-        // Shift the loaded value.
-        unsigned Shamt;
-
-        if (isLittle)
-          Shamt = TotalBytesLoaded * 8;
-        else
-          Shamt = (RegSizeInBytes - (TotalBytesLoaded + LoadSizeInBytes)) * 8;
-
-        SDValue Shift = DAG.getNode(ISD::SHL, DL, RegTy, LoadVal,
-                                    DAG.getConstant(Shamt, DL, MVT::i32));
-
-        if (Val.getNode())
-          Val = DAG.getNode(ISD::OR, DL, RegTy, Val, Shift);
-        else
-          Val = Shift;
-
-        OffsetInBytes += LoadSizeInBytes;
-        TotalBytesLoaded += LoadSizeInBytes;
-        Alignment = std::min(Alignment, LoadSizeInBytes);
-      }
-
-      unsigned ArgReg = ArgRegs[FirstReg + I];
-      RegsToPass.push_back(std::make_pair(ArgReg, Val));
-      return;
-    }
-  }
-
-  // Copy remainder of byval arg to it with memcpy.
-  unsigned MemCpySize = ByValSizeInBytes - OffsetInBytes;
-  SDValue Src = DAG.getNode(ISD::ADD, DL, PtrTy, Arg,
-                            DAG.getConstant(OffsetInBytes, DL, PtrTy));
-  SDValue Dst = DAG.getNode(ISD::ADD, DL, PtrTy, StackPtr,
-                            DAG.getIntPtrConstant(VA.getLocMemOffset(), DL));
-  Chain = DAG.getMemcpy(Chain, DL, Dst, Src,
-                        DAG.getConstant(MemCpySize, DL, PtrTy),
-                        Alignment, /*isVolatile=*/false, /*AlwaysInline=*/false,
-                        /*isTailCall=*/false,
-                        MachinePointerInfo(), MachinePointerInfo());
-  MemOpChains.push_back(Chain);
-}
-
-void M6502TargetLowering::writeVarArgRegs(std::vector<SDValue> &OutChains,
-                                         SDValue Chain, const SDLoc &DL,
-                                         SelectionDAG &DAG,
-                                         CCState &State) const {
-  ArrayRef<MCPhysReg> ArgRegs = ABI.GetVarArgRegs();
-  unsigned Idx = State.getFirstUnallocated(ArgRegs);
-  unsigned RegSizeInBytes = Subtarget.getGPRSizeInBytes();
-  MVT RegTy = MVT::getIntegerVT(RegSizeInBytes * 8);
-  const TargetRegisterClass *RC = getRegClassFor(RegTy);
-  MachineFunction &MF = DAG.getMachineFunction();
-  MachineFrameInfo &MFI = MF.getFrameInfo();
-  M6502FunctionInfo *M6502FI = MF.getInfo<M6502FunctionInfo>();
-
-  // Offset of the first variable argument from stack pointer.
-  int VaArgOffset;
-
-  if (ArgRegs.size() == Idx)
-    VaArgOffset = alignTo(State.getNextStackOffset(), RegSizeInBytes);
-  else {
-    VaArgOffset =
-        (int)ABI.GetCalleeAllocdArgSizeInBytes(State.getCallingConv()) -
-        (int)(RegSizeInBytes * (ArgRegs.size() - Idx));
-  }
-
-  // Record the frame index of the first variable argument
-  // which is a value necessary to VASTART.
-  int FI = MFI.CreateFixedObject(RegSizeInBytes, VaArgOffset, true);
-  M6502FI->setVarArgsFrameIndex(FI);
-
-  // Copy the integer registers that have not been used for argument passing
-  // to the argument register save area. For O32, the save area is allocated
-  // in the caller's stack frame, while for N32/64, it is allocated in the
-  // callee's stack frame.
-  for (unsigned I = Idx; I < ArgRegs.size();
-       ++I, VaArgOffset += RegSizeInBytes) {
-    unsigned Reg = addLiveIn(MF, ArgRegs[I], RC);
-    SDValue ArgValue = DAG.getCopyFromReg(Chain, DL, Reg, RegTy);
-    FI = MFI.CreateFixedObject(RegSizeInBytes, VaArgOffset, true);
-    SDValue PtrOff = DAG.getFrameIndex(FI, getPointerTy(DAG.getDataLayout()));
-    SDValue Store =
-        DAG.getStore(Chain, DL, ArgValue, PtrOff, MachinePointerInfo());
-    cast<StoreSDNode>(Store.getNode())->getMemOperand()->setValue(
-        (Value *)nullptr);
-    OutChains.push_back(Store);
-  }
-}
-
-void M6502TargetLowering::HandleByVal(CCState *State, unsigned &Size,
-                                     unsigned Align) const {
-  const TargetFrameLowering *TFL = Subtarget.getFrameLowering();
-
-  assert(Size && "Byval argument's size shouldn't be 0.");
-
-  Align = std::min(Align, TFL->getStackAlignment());
-
-  unsigned FirstReg = 0;
-  unsigned NumRegs = 0;
-
-  if (State->getCallingConv() != CallingConv::Fast) {
-    unsigned RegSizeInBytes = Subtarget.getGPRSizeInBytes();
-    ArrayRef<MCPhysReg> IntArgRegs = ABI.GetByValArgRegs();
-    // FIXME: The O32 case actually describes no shadow registers.
-    const MCPhysReg *ShadowRegs =
-        ABI.IsO32() ? IntArgRegs.data() : M650264DPRegs;
-
-    // We used to check the size as well but we can't do that anymore since
-    // CCState::HandleByVal() rounds up the size after calling this function.
-    assert(!(Align % RegSizeInBytes) &&
-           "Byval argument's alignment should be a multiple of"
-           "RegSizeInBytes.");
-
-    FirstReg = State->getFirstUnallocated(IntArgRegs);
-
-    // If Align > RegSizeInBytes, the first arg register must be even.
-    // FIXME: This condition happens to do the right thing but it's not the
-    //        right way to test it. We want to check that the stack frame offset
-    //        of the register is aligned.
-    if ((Align > RegSizeInBytes) && (FirstReg % 2)) {
-      State->AllocateReg(IntArgRegs[FirstReg], ShadowRegs[FirstReg]);
-      ++FirstReg;
-    }
-
-    // Mark the registers allocated.
-    Size = alignTo(Size, RegSizeInBytes);
-    for (unsigned I = FirstReg; Size > 0 && (I < IntArgRegs.size());
-         Size -= RegSizeInBytes, ++I, ++NumRegs)
-      State->AllocateReg(IntArgRegs[I], ShadowRegs[I]);
-  }
-
-  State->addInRegsParamInfo(FirstReg, FirstReg + NumRegs);
-}
-
-MachineBasicBlock *M6502TargetLowering::emitPseudoSELECT(MachineInstr &MI,
-                                                        MachineBasicBlock *BB,
-                                                        bool isFPCmp,
-                                                        unsigned Opc) const {
-  assert(!(Subtarget.hasM65024() || Subtarget.hasM650232()) &&
-         "Subtarget already supports SELECT nodes with the use of"
-         "conditional-move instructions.");
-
-  const TargetInstrInfo *TII =
-      Subtarget.getInstrInfo();
-  DebugLoc DL = MI.getDebugLoc();
-
-  // To "insert" a SELECT instruction, we actually have to insert the
-  // diamond control-flow pattern.  The incoming instruction knows the
-  // destination vreg to set, the condition code register to branch on, the
-  // true/false values to select between, and a branch opcode to use.
-  const BasicBlock *LLVM_BB = BB->getBasicBlock();
-  MachineFunction::iterator It = ++BB->getIterator();
-
-  //  thisMBB:
-  //  ...
-  //   TrueVal = ...
-  //   setcc r1, r2, r3
-  //   bNE   r1, r0, copy1MBB
-  //   fallthrough --> copy0MBB
-  MachineBasicBlock *thisMBB  = BB;
-  MachineFunction *F = BB->getParent();
-  MachineBasicBlock *copy0MBB = F->CreateMachineBasicBlock(LLVM_BB);
-  MachineBasicBlock *sinkMBB  = F->CreateMachineBasicBlock(LLVM_BB);
-  F->insert(It, copy0MBB);
-  F->insert(It, sinkMBB);
-
-  // Transfer the remainder of BB and its successor edges to sinkMBB.
-  sinkMBB->splice(sinkMBB->begin(), BB,
-                  std::next(MachineBasicBlock::iterator(MI)), BB->end());
-  sinkMBB->transferSuccessorsAndUpdatePHIs(BB);
-
-  // Next, add the true and fallthrough blocks as its successors.
-  BB->addSuccessor(copy0MBB);
-  BB->addSuccessor(sinkMBB);
-
-  if (isFPCmp) {
-    // bc1[tf] cc, sinkMBB
-    BuildMI(BB, DL, TII->get(Opc))
-        .addReg(MI.getOperand(1).getReg())
-        .addMBB(sinkMBB);
-  } else {
-    // bne rs, $0, sinkMBB
-    BuildMI(BB, DL, TII->get(Opc))
-        .addReg(MI.getOperand(1).getReg())
-        .addReg(M6502::ZERO)
-        .addMBB(sinkMBB);
-  }
-
-  //  copy0MBB:
-  //   %FalseValue = ...
-  //   # fallthrough to sinkMBB
-  BB = copy0MBB;
-
-  // Update machine-CFG edges
-  BB->addSuccessor(sinkMBB);
-
-  //  sinkMBB:
-  //   %Result = phi [ %TrueValue, thisMBB ], [ %FalseValue, copy0MBB ]
-  //  ...
-  BB = sinkMBB;
-
-  BuildMI(*BB, BB->begin(), DL, TII->get(M6502::PHI), MI.getOperand(0).getReg())
-      .addReg(MI.getOperand(2).getReg())
-      .addMBB(thisMBB)
-      .addReg(MI.getOperand(3).getReg())
-      .addMBB(copy0MBB);
-
-  MI.eraseFromParent(); // The pseudo instruction is gone now.
-
-  return BB;
+  // Jump table entries are 16-bit addresses, which the asm printer splits
+  // into a table of low bytes and one of high bytes.
+  return MachineJumpTableInfo::EK_BlockAddress;
 }
 
-// FIXME? Maybe this could be a TableGen attribute on some registers and
-// this table could be generated automatically from RegInfo.
 unsigned M6502TargetLowering::getRegisterByName(const char* RegName, EVT VT,
                                                SelectionDAG &DAG) const {
-  // Named registers is expected to be fairly rare. For now, just support $28
-  // since the linux kernel uses it.
-  if (Subtarget.isGP64bit()) {
-    unsigned Reg = StringSwitch<unsigned>(RegName)
-                         .Case("$28", M6502::GP_64)
-                         .Default(0);
-    if (Reg)
-      return Reg;
-  } else {
-    unsigned Reg = StringSwitch<unsigned>(RegName)
-                         .Case("$28", M6502::GP)
-                         .Default(0);
-    if (Reg)
-      return Reg;
-  }
+  // Only the software stack pointer makes sense as a named register.
+  unsigned Reg = StringSwitch<unsigned>(RegName)
+                       .Case("sp", ABI.GetStackPtr())
+                       .Default(0);
+  if (Reg)
+    return Reg;
   report_fatal_error("Invalid register name global variable");
 }
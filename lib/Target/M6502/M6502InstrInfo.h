@@ -1,4 +1,4 @@
-//===- M6502InstrInfo.h - M6502 Instruction Information -----------*- C++ -*-===//
+//===- M6502InstrInfo.h - M6502 Instruction Information ---------*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -9,10 +9,6 @@
 //
 // This file contains the M6502 implementation of the TargetInstrInfo class.
 //
-// FIXME: We need to override TargetInstrInfo::getInlineAsmLength method in
-// order for M6502LongBranch pass to work correctly when the code has inline
-// assembly.  The returned value doesn't have to be the asm instruction's exact
-// size in bytes; M6502LongBranch only expects it to be the correct upper bound.
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_LIB_TARGET_M6502_M6502INSTRINFO_H
@@ -83,15 +79,6 @@ public:
                            bool AllowModify,
                            SmallVectorImpl<MachineInstr *> &BranchInstrs) const;
 
-  /// Determine the opcode of a non-delay slot form for a branch if one exists.
-  unsigned getEquivalentCompactForm(const MachineBasicBlock::iterator I) const;
-
-  /// Predicate to determine if an instruction can go in a forbidden slot.
-  bool SafeInForbiddenSlot(const MachineInstr &MI) const;
-
-  /// Predicate to determine if an instruction has a forbidden slot.
-  bool HasForbiddenSlot(const MachineInstr &MI) const;
-
   /// Insert nop instruction when hazard condition is found
   void insertNoop(MachineBasicBlock &MBB,
                   MachineBasicBlock::iterator MI) const override;
@@ -140,18 +127,6 @@ public:
                               MachineBasicBlock &MBB,
                               MachineBasicBlock::iterator I) const = 0;
 
-  /// Create an instruction which has the same operands and memory operands
-  /// as MI but has a new opcode.
-  MachineInstrBuilder genInstrWithNewOpc(unsigned NewOpc,
-                                         MachineBasicBlock::iterator I) const;
-
-  bool findCommutedOpIndices(MachineInstr &MI, unsigned &SrcOpIdx1,
-                             unsigned &SrcOpIdx2) const override;
-
-  /// Perform target specific instruction verification.
-  bool verifyInstruction(const MachineInstr &MI,
-                         StringRef &ErrInfo) const override;
-
   std::pair<unsigned, unsigned>
   decomposeMachineOperandsTargetFlags(unsigned TF) const override;
 
@@ -176,7 +151,6 @@ private:
 };
 
 /// Create M6502InstrInfo objects.
-const M6502InstrInfo *createM650216InstrInfo(const M6502Subtarget &STI);
 const M6502InstrInfo *createM6502SEInstrInfo(const M6502Subtarget &STI);
 
 } // end namespace llvm
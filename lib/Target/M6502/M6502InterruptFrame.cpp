@@ -0,0 +1,254 @@
+//===- M6502InterruptFrame.cpp - Save what an interrupt handler changes ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A function with the "interrupt" attribute is entered through the NMI or
+// IRQ vector at any point of the code it interrupts, and leaves with RTI.  It
+// must give back every register it changes, and nothing more is worth saving
+// when a vertical blank handler has a fixed budget of cycles.  So the
+// handler has no callee-saved registers of its own, and once its code is
+// final this pass pushes exactly the CPU and zero page registers it writes on
+// the hardware stack at its entry and pulls them before each RTI.  A call
+// writes what its register mask says the callee may change, which the
+// interprocedural register usage information narrows down to what the
+// callees in the module really write, transitively.
+//
+// The interrupted code may be halfway through moving the software stack
+// pointer, whose two bytes are written one after the other.  A handler which
+// uses the software stack first lowers the high byte of the pointer, so its
+// frames lie at least 256 bytes below whatever it reads, which is below
+// anything the interrupted code has live.
+//
+// The NMOS 6502 leaves decimal mode as the interrupted code had it, so the
+// handler clears it before any arithmetic.  On the 65816, the accumulator is
+// saved 16 bits wide, as the width the interrupted code was using is unknown.
+//
+// A handler which is also "naked" gets nothing but its RTI.  Its body, in
+// inline assembly, saves what it needs itself, which is the fastest way to
+// write an NMI handler.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502InstrInfo.h"
+#include "M6502Subtarget.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-interrupt-frame"
+
+STATISTIC(NumSavedRegs, "Number of registers saved by interrupt handlers");
+
+namespace {
+
+  class M6502InterruptFrame : public MachineFunctionPass {
+  public:
+    static char ID;
+
+    M6502InterruptFrame() : MachineFunctionPass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Interrupt Frame";
+    }
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    MachineFunctionProperties getRequiredProperties() const override {
+      return MachineFunctionProperties().set(
+          MachineFunctionProperties::Property::NoVRegs);
+    }
+
+  private:
+    const M6502InstrInfo *TII;
+    const TargetRegisterInfo *TRI;
+    const M6502Subtarget *STI;
+
+    bool isWritten(const MachineFunction &MF, unsigned Reg) const;
+    void emitSaves(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                   ArrayRef<unsigned> Saved, bool GuardSP);
+    void emitRestores(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                      ArrayRef<unsigned> Saved, bool GuardSP);
+  };
+
+} // end anonymous namespace
+
+char M6502InterruptFrame::ID = 0;
+
+/// Return true if Reg, or a register overlapping it, may be changed by the
+/// code of MF.  The handler has no incoming values, so a register it only
+/// reads has been written by it first, and any mention of it counts.
+bool M6502InterruptFrame::isWritten(const MachineFunction &MF,
+                                    unsigned Reg) const {
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB) {
+      // The clobbers of inline assembly only name the zero page registers.
+      if (MI.isInlineAsm() &&
+          (Reg == M6502::A || Reg == M6502::X || Reg == M6502::Y))
+        return true;
+      // What a call changes is in its register mask.  Its other register
+      // operands are the arguments, and the definitions every call has.
+      bool IsCall = MI.isCall();
+      for (const MachineOperand &MO : MI.operands()) {
+        if (MO.isRegMask() && MO.clobbersPhysReg(Reg))
+          return true;
+        if (MO.isReg() && MO.getReg() && !IsCall &&
+            TRI->regsOverlap(MO.getReg(), Reg))
+          return true;
+      }
+    }
+  return false;
+}
+
+void M6502InterruptFrame::emitSaves(MachineBasicBlock &MBB,
+                                    MachineBasicBlock::iterator I,
+                                    ArrayRef<unsigned> Saved, bool GuardSP) {
+  DebugLoc DL;
+  for (unsigned Reg : Saved) {
+    switch (Reg) {
+    case M6502::A:
+      BuildMI(MBB, I, DL,
+              TII->get(STI->is65816() ? M6502::PHAW : M6502::PHA));
+      break;
+    case M6502::X:
+      if (STI->hasCMOS()) {
+        BuildMI(MBB, I, DL, TII->get(M6502::PHX));
+      } else {
+        BuildMI(MBB, I, DL, TII->get(M6502::TXA));
+        BuildMI(MBB, I, DL, TII->get(M6502::PHA));
+      }
+      break;
+    case M6502::Y:
+      if (STI->hasCMOS()) {
+        BuildMI(MBB, I, DL, TII->get(M6502::PHY));
+      } else {
+        BuildMI(MBB, I, DL, TII->get(M6502::TYA));
+        BuildMI(MBB, I, DL, TII->get(M6502::PHA));
+      }
+      break;
+    default:
+      BuildMI(MBB, I, DL, TII->get(M6502::LDAzp)).addReg(Reg, RegState::Undef);
+      BuildMI(MBB, I, DL, TII->get(M6502::PHA));
+      break;
+    }
+  }
+
+  // Arithmetic goes through A, so the handler needs binary mode only if it
+  // writes A.
+  if (!Saved.empty() && Saved.front() == M6502::A && STI->hasDecimal() &&
+      !STI->hasCMOS())
+    BuildMI(MBB, I, DL, TII->get(M6502::CLD));
+
+  if (GuardSP)
+    BuildMI(MBB, I, DL, TII->get(M6502::DECzp)).addReg(M6502::RS1)
+      .addReg(M6502::RS1, RegState::ImplicitDefine);
+}
+
+void M6502InterruptFrame::emitRestores(MachineBasicBlock &MBB,
+                                       MachineBasicBlock::iterator I,
+                                       ArrayRef<unsigned> Saved,
+                                       bool GuardSP) {
+  DebugLoc DL = I->getDebugLoc();
+  if (GuardSP)
+    BuildMI(MBB, I, DL, TII->get(M6502::INCzp)).addReg(M6502::RS1)
+      .addReg(M6502::RS1, RegState::ImplicitDefine);
+
+  for (unsigned Reg : reverse(Saved)) {
+    switch (Reg) {
+    case M6502::A:
+      BuildMI(MBB, I, DL,
+              TII->get(STI->is65816() ? M6502::PLAW : M6502::PLA));
+      break;
+    case M6502::X:
+      if (STI->hasCMOS()) {
+        BuildMI(MBB, I, DL, TII->get(M6502::PLX));
+      } else {
+        BuildMI(MBB, I, DL, TII->get(M6502::PLA));
+        BuildMI(MBB, I, DL, TII->get(M6502::TAX));
+      }
+      break;
+    case M6502::Y:
+      if (STI->hasCMOS()) {
+        BuildMI(MBB, I, DL, TII->get(M6502::PLY));
+      } else {
+        BuildMI(MBB, I, DL, TII->get(M6502::PLA));
+        BuildMI(MBB, I, DL, TII->get(M6502::TAY));
+      }
+      break;
+    default:
+      BuildMI(MBB, I, DL, TII->get(M6502::PLA));
+      BuildMI(MBB, I, DL, TII->get(M6502::STAzp)).addReg(Reg, RegState::Undef)
+        .addReg(Reg, RegState::ImplicitDefine);
+      break;
+    }
+  }
+}
+
+bool M6502InterruptFrame::runOnMachineFunction(MachineFunction &MF) {
+  const Function *F = MF.getFunction();
+  if (!F->hasFnAttribute("interrupt") || F->hasFnAttribute(Attribute::Naked))
+    return false;
+
+  STI = &MF.getSubtarget<M6502Subtarget>();
+  TII = static_cast<const M6502InstrInfo *>(STI->getInstrInfo());
+  TRI = STI->getRegisterInfo();
+
+  // The software stack pointer comes back unchanged, but its high byte is
+  // lowered while the handler runs if anything in it may move the pointer.
+  bool GuardSP = isWritten(MF, M6502::RS0) || isWritten(MF, M6502::RS1);
+
+  SmallVector<unsigned, 16> SavedZP;
+  for (unsigned Reg : M6502::ZP8RegClass) {
+    if (Reg == M6502::RS0 || Reg == M6502::RS1 || !isWritten(MF, Reg))
+      continue;
+    DEBUG(dbgs() << "Saving " << TRI->getName(Reg) << " in "
+                 << MF.getName() << "\n");
+    SavedZP.push_back(Reg);
+  }
+
+  // The zero page registers are saved through A, and so are X and Y without
+  // PHX and PHY, so A goes first.
+  bool SaveX = isWritten(MF, M6502::X);
+  bool SaveY = isWritten(MF, M6502::Y);
+  bool SaveA = isWritten(MF, M6502::A) || !SavedZP.empty() ||
+               (!STI->hasCMOS() && (SaveX || SaveY));
+
+  SmallVector<unsigned, 16> Saved;
+  if (SaveA)
+    Saved.push_back(M6502::A);
+  if (SaveX)
+    Saved.push_back(M6502::X);
+  if (SaveY)
+    Saved.push_back(M6502::Y);
+  Saved.append(SavedZP.begin(), SavedZP.end());
+
+  NumSavedRegs += Saved.size();
+  emitSaves(MF.front(), MF.front().begin(), Saved, GuardSP);
+  for (MachineBasicBlock &MBB : MF) {
+    MachineBasicBlock::iterator I = MBB.getLastNonDebugInstr();
+    if (I != MBB.end() && I->getOpcode() == M6502::RTI)
+      emitRestores(MBB, I, Saved, GuardSP);
+  }
+
+  return !Saved.empty() || GuardSP;
+}
+
+/// createM6502InterruptFramePass - Returns a pass that saves and restores
+/// the registers an interrupt handler changes.
+FunctionPass *llvm::createM6502InterruptFramePass() {
+  return new M6502InterruptFrame();
+}
@@ -1,4 +1,4 @@
-//===- M6502LongBranch.cpp - Emit long branches ----------------------------===//
+//===- M6502LongBranch.cpp - Emit long branches ---------------------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -7,21 +7,30 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This pass expands a branch or jump instruction into a long branch if its
-// offset is too large to fit into its immediate field.
+// This pass makes sure that every conditional branch reaches its target.  A
+// 6502 branch takes a signed byte displacement from the next instruction, so
+// its target must be within -128..+127 bytes.  Growing a branch moves the code
+// following it, which can push other branches out of range, so the pass
+// iterates until all of them fit.  The cheapest fix is tried first:
+//
+// - A branch followed by a JMP to a target in range is swapped with it:
+//     bcc far ; jmp near   =>   bcs near ; jmp far
+// - A target block which is only reached by the branch and neither falls
+//   through nor is fallen into is moved next to the branch.
+// - Otherwise the branch is inverted to skip over a JMP to its target:
+//     bcc far              =>   bcs next ; jmp far ; next:
+//   When the block also ends with a JMP, that JMP moves to a new block which
+//   the inverted branch targets.
+//
+// On the 65C02, a JMP to a block in range becomes a BRA, which is one byte
+// shorter.  A BRA later pushed out of range turns back into a JMP for good.
 //
-// FIXME: Fix pc-region jump instructions which cross 256MB segment boundaries.
 //===----------------------------------------------------------------------===//
 
-#include "MCTargetDesc/M6502ABIInfo.h"
-#include "MCTargetDesc/M6502BaseInfo.h"
-#include "MCTargetDesc/M6502MCNaCl.h"
-#include "MCTargetDesc/M6502MCTargetDesc.h"
 #include "M6502.h"
 #include "M6502InstrInfo.h"
-#include "M6502MachineFunction.h"
 #include "M6502Subtarget.h"
-#include "M6502TargetMachine.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
@@ -30,15 +39,10 @@
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
-#include "llvm/CodeGen/MachineOperand.h"
-#include "llvm/IR/DebugLoc.h"
 #include "llvm/Support/CommandLine.h"
-#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/MathExtras.h"
-#include "llvm/Target/TargetMachine.h"
-#include "llvm/Target/TargetSubtargetInfo.h"
-#include <cassert>
-#include <cstdint>
+#include "llvm/Support/raw_ostream.h"
 #include <iterator>
 
 using namespace llvm;
@@ -46,6 +50,9 @@ using namespace llvm;
 #define DEBUG_TYPE "m6502-long-branch"
 
 STATISTIC(LongBranches, "Number of long branches.");
+STATISTIC(SwappedBranches, "Number of branches swapped with a jump.");
+STATISTIC(MovedBlocks, "Number of blocks moved next to their branch.");
+STATISTIC(ShortJumps, "Number of jumps shortened to BRA.");
 
 static cl::opt<bool> SkipLongBranch(
   "skip-m6502-long-branch",
@@ -61,14 +68,9 @@ static cl::opt<bool> ForceLongBranch(
 
 namespace {
 
-  using Iter = MachineBasicBlock::iterator;
-  using ReverseIter = MachineBasicBlock::reverse_iterator;
-
   struct MBBInfo {
     uint64_t Size = 0;
-    uint64_t Address;
-    bool HasLongBranch = false;
-    MachineInstr *Br = nullptr;
+    uint64_t Address = 0;
 
     MBBInfo() = default;
   };
@@ -77,8 +79,7 @@ namespace {
   public:
     static char ID;
 
-    M6502LongBranch()
-        : MachineFunctionPass(ID), ABI(M6502ABIInfo::Unknown()) {}
+    M6502LongBranch() : MachineFunctionPass(ID) {}
 
     StringRef getPassName() const override { return "M6502 Long Branch"; }
 
@@ -90,458 +91,258 @@ namespace {
     }
 
   private:
-    void splitMBB(MachineBasicBlock *MBB);
-    void initMBBInfo();
-    int64_t computeOffset(const MachineInstr *Br);
-    void replaceBranch(MachineBasicBlock &MBB, Iter Br, const DebugLoc &DL,
-                       MachineBasicBlock *MBBOpnd);
-    void expandToLongBranch(MBBInfo &Info);
-
+    const M6502InstrInfo *TII;
     MachineFunction *MF;
     SmallVector<MBBInfo, 16> MBBInfos;
-    bool IsPIC;
-    M6502ABIInfo ABI;
-    unsigned LongBranchSeqSize;
+    SmallPtrSet<MachineBasicBlock *, 8> Moved;
+    SmallPtrSet<MachineInstr *, 8> Grown;
+
+    void computeAddresses();
+    uint64_t getAddress(const MachineInstr &MI) const;
+    bool isInRange(const MachineInstr &Br, const MachineBasicBlock *Dest) const;
+    MachineInstr *findOutOfRangeBranch() const;
+    bool swapWithJump(MachineInstr &Br);
+    bool moveTarget(MachineInstr &Br);
+    void expandToLongBranch(MachineInstr &Br);
+    bool shortenJumps();
   };
 
 } // end anonymous namespace
 
 char M6502LongBranch::ID = 0;
 
-/// Iterate over list of Br's operands and search for a MachineBasicBlock
-/// operand.
-static MachineBasicBlock *getTargetMBB(const MachineInstr &Br) {
-  for (unsigned I = 0, E = Br.getDesc().getNumOperands(); I < E; ++I) {
-    const MachineOperand &MO = Br.getOperand(I);
-
-    if (MO.isMBB())
-      return MO.getMBB();
-  }
-
-  llvm_unreachable("This instruction does not have an MBB operand.");
-}
-
-// Traverse the list of instructions backwards until a non-debug instruction is
-// found or it reaches E.
-static ReverseIter getNonDebugInstr(ReverseIter B, const ReverseIter &E) {
-  for (; B != E; ++B)
-    if (!B->isDebugValue())
-      return B;
-
-  return E;
+static bool isJump(const MachineInstr &MI) {
+  return MI.getOpcode() == M6502::JMP || MI.getOpcode() == M6502::BRA;
 }
 
-// Split MBB if it has two direct jumps/branches.
-void M6502LongBranch::splitMBB(MachineBasicBlock *MBB) {
-  ReverseIter End = MBB->rend();
-  ReverseIter LastBr = getNonDebugInstr(MBB->rbegin(), End);
-
-  // Return if MBB has no branch instructions.
-  if ((LastBr == End) ||
-      (!LastBr->isConditionalBranch() && !LastBr->isUnconditionalBranch()))
-    return;
-
-  ReverseIter FirstBr = getNonDebugInstr(std::next(LastBr), End);
-
-  // MBB has only one branch instruction if FirstBr is not a branch
-  // instruction.
-  if ((FirstBr == End) ||
-      (!FirstBr->isConditionalBranch() && !FirstBr->isUnconditionalBranch()))
-    return;
-
-  assert(!FirstBr->isIndirectBranch() && "Unexpected indirect branch found.");
-
-  // Create a new MBB. Move instructions in MBB to the newly created MBB.
-  MachineBasicBlock *NewMBB =
-    MF->CreateMachineBasicBlock(MBB->getBasicBlock());
-
-  // Insert NewMBB and fix control flow.
-  MachineBasicBlock *Tgt = getTargetMBB(*FirstBr);
-  NewMBB->transferSuccessors(MBB);
-  NewMBB->removeSuccessor(Tgt, true);
-  MBB->addSuccessor(NewMBB);
-  MBB->addSuccessor(Tgt);
-  MF->insert(std::next(MachineFunction::iterator(MBB)), NewMBB);
-
-  NewMBB->splice(NewMBB->end(), MBB, LastBr.getReverse(), MBB->end());
+/// Return the JMP or BRA following the conditional branch Br, if any.
+static MachineInstr *getFollowingJump(MachineInstr &Br) {
+  MachineBasicBlock::iterator I = std::next(Br.getIterator());
+  MachineBasicBlock::iterator E = Br.getParent()->end();
+  while (I != E && I->isDebugValue())
+    ++I;
+  if (I != E && isJump(*I))
+    return &*I;
+  return nullptr;
 }
 
-// Fill MBBInfos.
-void M6502LongBranch::initMBBInfo() {
-  // Split the MBBs if they have two branches. Each basic block should have at
-  // most one branch after this loop is executed.
-  for (auto &MBB : *MF)
-    splitMBB(&MBB);
-
-  MF->RenumberBlocks();
+/// Compute the size and address of every block.  Blocks are numbered in
+/// layout order.  The padding before a block aligned more than the function
+/// is unknown, so the largest one is assumed, which over-estimates the
+/// distance of branches across the block.
+void M6502LongBranch::computeAddresses() {
   MBBInfos.clear();
-  MBBInfos.resize(MF->size());
-
-  const M6502InstrInfo *TII =
-      static_cast<const M6502InstrInfo *>(MF->getSubtarget().getInstrInfo());
-  for (unsigned I = 0, E = MBBInfos.size(); I < E; ++I) {
-    MachineBasicBlock *MBB = MF->getBlockNumbered(I);
-
-    // Compute size of MBB.
-    for (MachineBasicBlock::instr_iterator MI = MBB->instr_begin();
-         MI != MBB->instr_end(); ++MI)
-      MBBInfos[I].Size += TII->getInstSizeInBytes(*MI);
-
-    // Search for MBB's branch instruction.
-    ReverseIter End = MBB->rend();
-    ReverseIter Br = getNonDebugInstr(MBB->rbegin(), End);
+  MBBInfos.resize(MF->getNumBlockIDs());
+
+  unsigned FnAlign = MF->getAlignment();
+  uint64_t Address = 0;
+  for (MachineBasicBlock &MBB : *MF) {
+    unsigned Align = MBB.getAlignment();
+    if (Align <= FnAlign)
+      Address = alignTo(Address, 1u << Align);
+    else
+      Address += (1u << Align) - (1u << FnAlign);
+
+    MBBInfo &Info = MBBInfos[MBB.getNumber()];
+    Info.Address = Address;
+    Info.Size = 0;
+    for (const MachineInstr &MI : MBB)
+      Info.Size += TII->getInstSizeInBytes(MI);
+    Address += Info.Size;
+  }
+}
 
-    if ((Br != End) && !Br->isIndirectBranch() &&
-        (Br->isConditionalBranch() || (Br->isUnconditionalBranch() && IsPIC)))
-      MBBInfos[I].Br = &*Br;
+/// Return the address following MI.
+uint64_t M6502LongBranch::getAddress(const MachineInstr &MI) const {
+  const MachineBasicBlock &MBB = *MI.getParent();
+  uint64_t Address = MBBInfos[MBB.getNumber()].Address;
+  for (const MachineInstr &I : MBB) {
+    Address += TII->getInstSizeInBytes(I);
+    if (&I == &MI)
+      break;
   }
+  return Address;
 }
 
-// Compute offset of branch in number of bytes.
-int64_t M6502LongBranch::computeOffset(const MachineInstr *Br) {
-  int64_t Offset = 0;
-  int ThisMBB = Br->getParent()->getNumber();
-  int TargetMBB = getTargetMBB(*Br)->getNumber();
+bool M6502LongBranch::isInRange(const MachineInstr &Br,
+                                const MachineBasicBlock *Dest) const {
+  int64_t Offset = (int64_t)MBBInfos[Dest->getNumber()].Address -
+                   (int64_t)getAddress(Br);
+  return isInt<8>(Offset);
+}
 
-  // Compute offset of a forward branch.
-  if (ThisMBB < TargetMBB) {
-    for (int N = ThisMBB + 1; N < TargetMBB; ++N)
-      Offset += MBBInfos[N].Size;
+MachineInstr *M6502LongBranch::findOutOfRangeBranch() const {
+  for (MachineBasicBlock &MBB : *MF)
+    for (MachineInstr &MI : MBB.terminators()) {
+      if (!MI.isConditionalBranch() && MI.getOpcode() != M6502::BRA)
+        continue;
+      if (!isInRange(MI, MI.getOperand(0).getMBB()))
+        return &MI;
+    }
+  return nullptr;
+}
 
-    return Offset + 4;
-  }
+/// Turn "bcc far ; jmp near" into "bcs near ; jmp far".
+bool M6502LongBranch::swapWithJump(MachineInstr &Br) {
+  MachineInstr *Jmp = getFollowingJump(Br);
+  if (!Jmp)
+    return false;
 
-  // Compute offset of a backward branch.
-  for (int N = ThisMBB; N >= TargetMBB; --N)
-    Offset += MBBInfos[N].Size;
+  MachineBasicBlock *Far = Br.getOperand(0).getMBB();
+  MachineBasicBlock *Near = Jmp->getOperand(0).getMBB();
+  if (!isInRange(Br, Near))
+    return false;
 
-  return -Offset + 4;
+  DEBUG(dbgs() << "Long branch: swapping with jump in BB#"
+               << Br.getParent()->getNumber() << "\n");
+  Br.setDesc(TII->get(TII->getOppositeBranchOpc(Br.getOpcode())));
+  Br.getOperand(0).setMBB(Near);
+  Jmp->getOperand(0).setMBB(Far);
+  ++SwappedBranches;
+  return true;
 }
 
-// Replace Br with a branch which has the opposite condition code and a
-// MachineBasicBlock operand MBBOpnd.
-void M6502LongBranch::replaceBranch(MachineBasicBlock &MBB, Iter Br,
-                                   const DebugLoc &DL,
-                                   MachineBasicBlock *MBBOpnd) {
-  const M6502InstrInfo *TII = static_cast<const M6502InstrInfo *>(
-      MBB.getParent()->getSubtarget().getInstrInfo());
-  unsigned NewOpc = TII->getOppositeBranchOpc(Br->getOpcode());
-  const MCInstrDesc &NewDesc = TII->get(NewOpc);
-
-  MachineInstrBuilder MIB = BuildMI(MBB, Br, DL, NewDesc);
+/// Move the target of Br next to it, when nothing else depends on where the
+/// target is.
+bool M6502LongBranch::moveTarget(MachineInstr &Br) {
+  MachineBasicBlock *MBB = Br.getParent();
+  MachineBasicBlock *Dest = Br.getOperand(0).getMBB();
+  if (Dest == MBB || Dest == &MF->front() || Moved.count(Dest) ||
+      Dest->pred_size() != 1 || *Dest->pred_begin() != MBB ||
+      Dest->canFallThrough() ||
+      Dest->isEHPad() || Dest->hasAddressTaken())
+    return false;
 
-  for (unsigned I = 0, E = Br->getDesc().getNumOperands(); I < E; ++I) {
-    MachineOperand &MO = Br->getOperand(I);
+  MachineBasicBlock *Prev = &*std::prev(Dest->getIterator());
+  if (Prev->canFallThrough())
+    return false;
 
-    if (!MO.isReg()) {
-      assert(MO.isMBB() && "MBB operand expected.");
+  // The target may go right after the branch when the block ends with a JMP,
+  // or else after the closest block which does not fall through.
+  MachineBasicBlock *After = nullptr;
+  for (auto I = MBB->getIterator(), E = MF->end(); I != E; ++I)
+    if (&*I != Dest && !I->canFallThrough()) {
+      After = &*I;
       break;
     }
+  if (!After || After == Prev)
+    return false;
 
-    MIB.addReg(MO.getReg());
+  Dest->moveAfter(After);
+  MF->RenumberBlocks();
+  computeAddresses();
+  if (!isInRange(Br, Dest)) {
+    Dest->moveAfter(Prev);
+    MF->RenumberBlocks();
+    return false;
   }
 
-  MIB.addMBB(MBBOpnd);
-
-  if (Br->hasDelaySlot()) {
-    // Bundle the instruction in the delay slot to the newly created branch
-    // and erase the original branch.
-    assert(Br->isBundledWithSucc());
-    MachineBasicBlock::instr_iterator II = Br.getInstrIterator();
-    MIBundleBuilder(&*MIB).append((++II)->removeFromBundle());
-  }
-  Br->eraseFromParent();
+  DEBUG(dbgs() << "Long branch: moved BB#" << Dest->getNumber()
+               << " after BB#" << After->getNumber() << "\n");
+  Moved.insert(Dest);
+  ++MovedBlocks;
+  return true;
 }
 
-// Expand branch instructions to long branches.
-// TODO: This function has to be fixed for beqz16 and bnez16, because it
-// currently assumes that all branches have 16-bit offsets, and will produce
-// wrong code if branches whose allowed offsets are [-128, -126, ..., 126]
-// are present.
-void M6502LongBranch::expandToLongBranch(MBBInfo &I) {
-  MachineBasicBlock::iterator Pos;
-  MachineBasicBlock *MBB = I.Br->getParent(), *TgtMBB = getTargetMBB(*I.Br);
-  DebugLoc DL = I.Br->getDebugLoc();
-  const BasicBlock *BB = MBB->getBasicBlock();
-  MachineFunction::iterator FallThroughMBB = ++MachineFunction::iterator(MBB);
-  MachineBasicBlock *LongBrMBB = MF->CreateMachineBasicBlock(BB);
-  const M6502Subtarget &Subtarget =
-      static_cast<const M6502Subtarget &>(MF->getSubtarget());
-  const M6502InstrInfo *TII =
-      static_cast<const M6502InstrInfo *>(Subtarget.getInstrInfo());
-
-  MF->insert(FallThroughMBB, LongBrMBB);
-  MBB->replaceSuccessor(TgtMBB, LongBrMBB);
-
-  if (IsPIC) {
-    MachineBasicBlock *BalTgtMBB = MF->CreateMachineBasicBlock(BB);
-    MF->insert(FallThroughMBB, BalTgtMBB);
-    LongBrMBB->addSuccessor(BalTgtMBB);
-    BalTgtMBB->addSuccessor(TgtMBB);
-
-    // We must select between the M650232r6/M650264r6 BAL (which is a normal
-    // instruction) and the pre-M650232r6/M650264r6 definition (which is an
-    // pseudo-instruction wrapping BGEZAL).
-    unsigned BalOp = Subtarget.hasM650232r6() ? M6502::BAL : M6502::BAL_BR;
-
-    if (!ABI.IsN64()) {
-      // $longbr:
-      //  addiu $sp, $sp, -8
-      //  sw $ra, 0($sp)
-      //  lui $at, %hi($tgt - $baltgt)
-      //  bal $baltgt
-      //  addiu $at, $at, %lo($tgt - $baltgt)
-      // $baltgt:
-      //  addu $at, $ra, $at
-      //  lw $ra, 0($sp)
-      //  jr $at
-      //  addiu $sp, $sp, 8
-      // $fallthrough:
-      //
-
-      Pos = LongBrMBB->begin();
-
-      BuildMI(*LongBrMBB, Pos, DL, TII->get(M6502::ADDiu), M6502::SP)
-        .addReg(M6502::SP).addImm(-8);
-      BuildMI(*LongBrMBB, Pos, DL, TII->get(M6502::SW)).addReg(M6502::RA)
-        .addReg(M6502::SP).addImm(0);
-
-      // LUi and ADDiu instructions create 32-bit offset of the target basic
-      // block from the target of BAL instruction.  We cannot use immediate
-      // value for this offset because it cannot be determined accurately when
-      // the program has inline assembly statements.  We therefore use the
-      // relocation expressions %hi($tgt-$baltgt) and %lo($tgt-$baltgt) which
-      // are resolved during the fixup, so the values will always be correct.
-      //
-      // Since we cannot create %hi($tgt-$baltgt) and %lo($tgt-$baltgt)
-      // expressions at this point (it is possible only at the MC layer),
-      // we replace LUi and ADDiu with pseudo instructions
-      // LONG_BRANCH_LUi and LONG_BRANCH_ADDiu, and add both basic
-      // blocks as operands to these instructions.  When lowering these pseudo
-      // instructions to LUi and ADDiu in the MC layer, we will create
-      // %hi($tgt-$baltgt) and %lo($tgt-$baltgt) expressions and add them as
-      // operands to lowered instructions.
-
-      BuildMI(*LongBrMBB, Pos, DL, TII->get(M6502::LONG_BRANCH_LUi), M6502::AT)
-        .addMBB(TgtMBB).addMBB(BalTgtMBB);
-      MIBundleBuilder(*LongBrMBB, Pos)
-          .append(BuildMI(*MF, DL, TII->get(BalOp)).addMBB(BalTgtMBB))
-          .append(BuildMI(*MF, DL, TII->get(M6502::LONG_BRANCH_ADDiu), M6502::AT)
-                      .addReg(M6502::AT)
-                      .addMBB(TgtMBB)
-                      .addMBB(BalTgtMBB));
-
-      Pos = BalTgtMBB->begin();
-
-      BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::ADDu), M6502::AT)
-        .addReg(M6502::RA).addReg(M6502::AT);
-      BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::LW), M6502::RA)
-        .addReg(M6502::SP).addImm(0);
-
-      // In NaCl, modifying the sp is not allowed in branch delay slot.
-      if (Subtarget.isTargetNaCl())
-        BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::ADDiu), M6502::SP)
-          .addReg(M6502::SP).addImm(8);
-
-      if (Subtarget.hasM650232r6())
-        BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::JALR))
-          .addReg(M6502::ZERO).addReg(M6502::AT);
-      else
-        BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::JR)).addReg(M6502::AT);
-
-      if (Subtarget.isTargetNaCl()) {
-        BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::NOP));
-        // Bundle-align the target of indirect branch JR.
-        TgtMBB->setAlignment(M6502_NACL_BUNDLE_ALIGN);
-      } else
-        BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::ADDiu), M6502::SP)
-          .addReg(M6502::SP).addImm(8);
-
-      BalTgtMBB->rbegin()->bundleWithPred();
-    } else {
-      // $longbr:
-      //  daddiu $sp, $sp, -16
-      //  sd $ra, 0($sp)
-      //  daddiu $at, $zero, %hi($tgt - $baltgt)
-      //  dsll $at, $at, 16
-      //  bal $baltgt
-      //  daddiu $at, $at, %lo($tgt - $baltgt)
-      // $baltgt:
-      //  daddu $at, $ra, $at
-      //  ld $ra, 0($sp)
-      //  jr64 $at
-      //  daddiu $sp, $sp, 16
-      // $fallthrough:
-      //
-
-      // We assume the branch is within-function, and that offset is within
-      // +/- 2GB.  High 32 bits will therefore always be zero.
-
-      // Note that this will work even if the offset is negative, because
-      // of the +1 modification that's added in that case.  For example, if the
-      // offset is -1MB (0xFFFFFFFFFFF00000), the computation for %higher is
-      //
-      // 0xFFFFFFFFFFF00000 + 0x80008000 = 0x000000007FF08000
-      //
-      // and the bits [47:32] are zero.  For %highest
-      //
-      // 0xFFFFFFFFFFF00000 + 0x800080008000 = 0x000080007FF08000
-      //
-      // and the bits [63:48] are zero.
-
-      Pos = LongBrMBB->begin();
-
-      BuildMI(*LongBrMBB, Pos, DL, TII->get(M6502::DADDiu), M6502::SP_64)
-        .addReg(M6502::SP_64).addImm(-16);
-      BuildMI(*LongBrMBB, Pos, DL, TII->get(M6502::SD)).addReg(M6502::RA_64)
-        .addReg(M6502::SP_64).addImm(0);
-      BuildMI(*LongBrMBB, Pos, DL, TII->get(M6502::LONG_BRANCH_DADDiu),
-              M6502::AT_64).addReg(M6502::ZERO_64)
-                          .addMBB(TgtMBB, M6502II::MO_ABS_HI).addMBB(BalTgtMBB);
-      BuildMI(*LongBrMBB, Pos, DL, TII->get(M6502::DSLL), M6502::AT_64)
-        .addReg(M6502::AT_64).addImm(16);
-
-      MIBundleBuilder(*LongBrMBB, Pos)
-          .append(BuildMI(*MF, DL, TII->get(BalOp)).addMBB(BalTgtMBB))
-          .append(
-              BuildMI(*MF, DL, TII->get(M6502::LONG_BRANCH_DADDiu), M6502::AT_64)
-                  .addReg(M6502::AT_64)
-                  .addMBB(TgtMBB, M6502II::MO_ABS_LO)
-                  .addMBB(BalTgtMBB));
-
-      Pos = BalTgtMBB->begin();
-
-      BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::DADDu), M6502::AT_64)
-        .addReg(M6502::RA_64).addReg(M6502::AT_64);
-      BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::LD), M6502::RA_64)
-        .addReg(M6502::SP_64).addImm(0);
-
-      if (Subtarget.hasM650264r6())
-        BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::JALR64))
-          .addReg(M6502::ZERO_64).addReg(M6502::AT_64);
-      else
-        BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::JR64)).addReg(M6502::AT_64);
-
-      BuildMI(*BalTgtMBB, Pos, DL, TII->get(M6502::DADDiu), M6502::SP_64)
-        .addReg(M6502::SP_64).addImm(16);
-      BalTgtMBB->rbegin()->bundleWithPred();
-    }
-
-    assert(LongBrMBB->size() + BalTgtMBB->size() == LongBranchSeqSize);
+/// Turn "bcc far" into "bcs next ; jmp far ; next:".
+void M6502LongBranch::expandToLongBranch(MachineInstr &Br) {
+  MachineBasicBlock *MBB = Br.getParent();
+  MachineBasicBlock *Far = Br.getOperand(0).getMBB();
+  DebugLoc DL = Br.getDebugLoc();
+
+  DEBUG(dbgs() << "Long branch: expanding branch in BB#" << MBB->getNumber()
+               << " to BB#" << Far->getNumber() << "\n");
+
+  // The inverted branch skips over the new JMP, to the layout successor or to
+  // a new block holding the JMP which ended the block.
+  MachineBasicBlock *Next;
+  if (MachineInstr *Jmp = getFollowingJump(Br)) {
+    MachineBasicBlock *Near = Jmp->getOperand(0).getMBB();
+    Next = MF->CreateMachineBasicBlock(MBB->getBasicBlock());
+    MF->insert(std::next(MBB->getIterator()), Next);
+    Jmp->removeFromParent();
+    Next->insert(Next->end(), Jmp);
+    MBB->replaceSuccessor(Near, Next);
+    Next->addSuccessor(Near);
   } else {
-    // $longbr:
-    //  j $tgt
-    //  nop
-    // $fallthrough:
-    //
-    Pos = LongBrMBB->begin();
-    LongBrMBB->addSuccessor(TgtMBB);
-    MIBundleBuilder(*LongBrMBB, Pos)
-      .append(BuildMI(*MF, DL, TII->get(M6502::J)).addMBB(TgtMBB))
-      .append(BuildMI(*MF, DL, TII->get(M6502::NOP)));
-
-    assert(LongBrMBB->size() == LongBranchSeqSize);
+    Next = &*std::next(MBB->getIterator());
   }
 
-  if (I.Br->isUnconditionalBranch()) {
-    // Change branch destination.
-    assert(I.Br->getDesc().getNumOperands() == 1);
-    I.Br->RemoveOperand(0);
-    I.Br->addOperand(MachineOperand::CreateMBB(LongBrMBB));
-  } else
-    // Change branch destination and reverse condition.
-    replaceBranch(*MBB, I.Br, DL, &*FallThroughMBB);
+  Br.setDesc(TII->get(TII->getOppositeBranchOpc(Br.getOpcode())));
+  Br.getOperand(0).setMBB(Next);
+  BuildMI(*MBB, MBB->end(), DL, TII->get(M6502::JMP)).addMBB(Far);
+
+  MF->RenumberBlocks();
+  ++LongBranches;
 }
 
-static void emitGPDisp(MachineFunction &F, const M6502InstrInfo *TII) {
-  MachineBasicBlock &MBB = F.front();
-  MachineBasicBlock::iterator I = MBB.begin();
-  DebugLoc DL = MBB.findDebugLoc(MBB.begin());
-  BuildMI(MBB, I, DL, TII->get(M6502::LUi), M6502::V0)
-    .addExternalSymbol("_gp_disp", M6502II::MO_ABS_HI);
-  BuildMI(MBB, I, DL, TII->get(M6502::ADDiu), M6502::V0)
-    .addReg(M6502::V0).addExternalSymbol("_gp_disp", M6502II::MO_ABS_LO);
-  MBB.removeLiveIn(M6502::V0);
+/// Turn the JMPs to blocks in range into BRAs, except the ones which already
+/// grew back.
+bool M6502LongBranch::shortenJumps() {
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : *MF)
+    for (MachineInstr &MI : MBB.terminators())
+      if (MI.getOpcode() == M6502::JMP && MI.getOperand(0).isMBB() &&
+          !Grown.count(&MI) && isInRange(MI, MI.getOperand(0).getMBB())) {
+        MI.setDesc(TII->get(M6502::BRA));
+        ++ShortJumps;
+        Changed = true;
+      }
+  return Changed;
 }
 
 bool M6502LongBranch::runOnMachineFunction(MachineFunction &F) {
-  const M6502Subtarget &STI =
-      static_cast<const M6502Subtarget &>(F.getSubtarget());
-  const M6502InstrInfo *TII =
-      static_cast<const M6502InstrInfo *>(STI.getInstrInfo());
-
-  const TargetMachine& TM = F.getTarget();
-  IsPIC = TM.isPositionIndependent();
-  ABI = static_cast<const M6502TargetMachine &>(TM).getABI();
-
-  LongBranchSeqSize =
-      !IsPIC ? 2 : (ABI.IsN64() ? 10 : (!STI.isTargetNaCl() ? 9 : 10));
-
-  if (STI.inM650216Mode() || !STI.enableLongBranchPass())
-    return false;
-  if (IsPIC && static_cast<const M6502TargetMachine &>(TM).getABI().IsO32() &&
-      F.getInfo<M6502FunctionInfo>()->globalBaseRegSet())
-    emitGPDisp(F, TII);
-
   if (SkipLongBranch)
-    return true;
+    return false;
 
   MF = &F;
-  initMBBInfo();
-
-  SmallVectorImpl<MBBInfo>::iterator I, E = MBBInfos.end();
-  bool EverMadeChange = false, MadeChange = true;
+  TII = static_cast<const M6502InstrInfo *>(
+      F.getSubtarget<M6502Subtarget>().getInstrInfo());
+  Moved.clear();
+  Grown.clear();
+  MF->RenumberBlocks();
 
-  while (MadeChange) {
-    MadeChange = false;
+  if (ForceLongBranch) {
+    SmallVector<MachineInstr *, 16> Branches;
+    for (MachineBasicBlock &MBB : *MF)
+      for (MachineInstr &MI : MBB.terminators())
+        if (MI.isConditionalBranch())
+          Branches.push_back(&MI);
+    for (MachineInstr *Br : Branches)
+      expandToLongBranch(*Br);
+    return !Branches.empty();
+  }
 
-    for (I = MBBInfos.begin(); I != E; ++I) {
-      // Skip if this MBB doesn't have a branch or the branch has already been
-      // converted to a long branch.
-      if (!I->Br || I->HasLongBranch)
+  // Every step either grows a branch for good, moves a block which is never
+  // moved again, or shortens jumps which grow back at most once, so this
+  // terminates.
+  bool HasBRA = F.getSubtarget<M6502Subtarget>().hasCMOS();
+  bool Changed = false;
+  while (true) {
+    computeAddresses();
+    MachineInstr *Br = findOutOfRangeBranch();
+    if (!Br) {
+      if (HasBRA && shortenJumps()) {
+        Changed = true;
         continue;
-
-      int ShVal = STI.inMicroM6502Mode() ? 2 : 4;
-      int64_t Offset = computeOffset(I->Br) / ShVal;
-
-      if (STI.isTargetNaCl()) {
-        // The offset calculation does not include sandboxing instructions
-        // that will be added later in the MC layer.  Since at this point we
-        // don't know the exact amount of code that "sandboxing" will add, we
-        // conservatively estimate that code will not grow more than 100%.
-        Offset *= 2;
       }
-
-      // Check if offset fits into 16-bit immediate field of branches.
-      if (!ForceLongBranch && isInt<16>(Offset))
-        continue;
-
-      I->HasLongBranch = true;
-      I->Size += LongBranchSeqSize * 4;
-      ++LongBranches;
-      EverMadeChange = MadeChange = true;
+      break;
     }
-  }
-
-  if (!EverMadeChange)
-    return true;
 
-  // Compute basic block addresses.
-  if (IsPIC) {
-    uint64_t Address = 0;
+    Changed = true;
+    if (Br->getOpcode() == M6502::BRA) {
+      Br->setDesc(TII->get(M6502::JMP));
+      Grown.insert(Br);
+      --ShortJumps;
+      continue;
+    }
 
-    for (I = MBBInfos.begin(); I != E; Address += I->Size, ++I)
-      I->Address = Address;
+    if (swapWithJump(*Br) || moveTarget(*Br))
+      continue;
+    expandToLongBranch(*Br);
   }
 
-  // Do the expansion.
-  for (I = MBBInfos.begin(); I != E; ++I)
-    if (I->HasLongBranch)
-      expandToLongBranch(*I);
-
-  MF->RenumberBlocks();
-
-  return true;
+  return Changed;
 }
 
 /// createM6502LongBranchPass - Returns a pass that converts branches to long
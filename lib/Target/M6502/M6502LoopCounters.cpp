@@ -0,0 +1,315 @@
+//===- M6502LoopCounters.cpp - Keep loop counters in X or Y ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The byte counters M6502CountDownLoops gives loops live in a zero page
+// register like any other value, so a loop indexing memory with its counter
+// loads it into X on every iteration and counts down with a DEC of the zero
+// page, which takes five cycles where a DEX takes two.
+//
+// This pass keeps the counter of a loop of a single block in X, or else in
+// Y, for the whole loop.  It applies when the loop reads the register only
+// after loading the counter into it, writes it only with those loads, and
+// changes the counter only with one DEC, and the counter is dead once the
+// loop exits.  The counter is then loaded into the register before the loop,
+// or transferred from A when it was just stored from there, the loads in the
+// loop are deleted and the DEC becomes a DEX or DEY, which sets N and Z the
+// same way.
+//
+// The pass runs after M6502Peephole, which deletes the loads of the counter
+// the exit test of the loop repeats after the DEC.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502InstrInfo.h"
+#include "M6502Subtarget.h"
+#include "MCTargetDesc/M6502BaseInfo.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-loop-counters"
+
+STATISTIC(NumCountersInX, "Number of loop counters kept in X");
+STATISTIC(NumCountersInY, "Number of loop counters kept in Y");
+STATISTIC(NumLoadsDeleted, "Number of counter loads taken out of loops");
+
+namespace {
+
+  /// An index register, with the instructions which load it from the zero
+  /// page, transfer A to it and decrement it.
+  struct IndexReg {
+    unsigned Reg, LoadOpc, TransferOpc, DecOpc;
+  };
+
+  const IndexReg IndexRegs[] = {
+    {M6502::X, M6502::LDXzp, M6502::TAX, M6502::DEX},
+    {M6502::Y, M6502::LDYzp, M6502::TAY, M6502::DEY}
+  };
+
+  class M6502LoopCounters : public MachineFunctionPass {
+  public:
+    static char ID;
+
+    M6502LoopCounters() : MachineFunctionPass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Loop Counters";
+    }
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesCFG();
+      AU.addRequired<MachineLoopInfo>();
+      AU.addPreserved<MachineLoopInfo>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    MachineFunctionProperties getRequiredProperties() const override {
+      return MachineFunctionProperties().set(
+          MachineFunctionProperties::Property::NoVRegs);
+    }
+
+  private:
+    const M6502InstrInfo *TII;
+    const TargetRegisterInfo *TRI;
+
+    bool canKeepIn(MachineBasicBlock &MBB, unsigned Counter,
+                   const IndexReg &IR, unsigned OtherLoadOpc) const;
+    bool runOnLoop(MachineLoop *L);
+  };
+
+} // end anonymous namespace
+
+char M6502LoopCounters::ID = 0;
+
+static bool isOpaque(const MachineInstr &MI) {
+  return MI.isInlineAsm() ||
+         (MI.getDesc().TSFlags & M6502II::FormMask) == M6502II::Pseudo;
+}
+
+static bool isLoadOf(const MachineInstr &MI, unsigned LoadOpc,
+                     unsigned Counter) {
+  return MI.getOpcode() == LoadOpc && MI.getOperand(0).isReg() &&
+         MI.getOperand(0).getReg() == Counter;
+}
+
+/// Return true if N or Z may be read from I on before they are written.
+static bool readsNZ(MachineBasicBlock::iterator I,
+                    MachineBasicBlock::iterator E) {
+  for (; I != E; ++I) {
+    if (isOpaque(*I))
+      return true;
+    uint64_t TSFlags = I->getDesc().TSFlags;
+    if (M6502II::getFlagsUsed(TSFlags) & M6502II::FlagsNZ)
+      return true;
+    if ((M6502II::getFlagsDefined(TSFlags) & M6502II::FlagsNZ) ==
+        M6502II::FlagsNZ)
+      return false;
+  }
+  // The flags may still be read in a successor.
+  return true;
+}
+
+/// Return true if the CPU register Reg may be read on a path from the entry
+/// of MBB before it is written.  The CPU registers are reserved, so they are
+/// not in the live in lists of the blocks.
+static bool isLiveIn(const MachineBasicBlock &MBB, unsigned Reg,
+                     SmallPtrSetImpl<const MachineBasicBlock *> &Visited) {
+  if (!Visited.insert(&MBB).second)
+    return false;
+  for (const MachineInstr &MI : MBB) {
+    if (isOpaque(MI) || MI.readsRegister(Reg))
+      return true;
+    if (MI.isCall() || MI.definesRegister(Reg))
+      return false;
+  }
+  for (const MachineBasicBlock *Succ : MBB.successors())
+    if (isLiveIn(*Succ, Reg, Visited))
+      return true;
+  return false;
+}
+
+/// Return true if the single block loop MBB counting down with Counter can
+/// keep it in the CPU register of IR.  The loads of the counter with
+/// OtherLoadOpc are left to the other index register.
+bool M6502LoopCounters::canKeepIn(MachineBasicBlock &MBB, unsigned Counter,
+                                  const IndexReg &IR,
+                                  unsigned OtherLoadOpc) const {
+  // Whether the register holds the counter in the original loop.
+  bool Holds = false;
+  for (MachineBasicBlock::iterator I = MBB.begin(), E = MBB.end(); I != E;
+       ++I) {
+    MachineInstr &MI = *I;
+    if (isLoadOf(MI, IR.LoadOpc, Counter)) {
+      // The load goes, so nothing may read the N and Z it sets.
+      if (readsNZ(std::next(I), E))
+        return false;
+      Holds = true;
+      continue;
+    }
+    if (isLoadOf(MI, OtherLoadOpc, Counter))
+      continue;
+    if (MI.getOpcode() == M6502::DECzp && MI.getOperand(0).isReg() &&
+        MI.getOperand(0).getReg() == Counter) {
+      Holds = false;
+      continue;
+    }
+    if (MI.readsRegister(IR.Reg) && !Holds)
+      return false;
+    if (MI.definesRegister(IR.Reg) || MI.readsRegister(Counter, TRI) ||
+        MI.modifiesRegister(Counter, TRI))
+      return false;
+  }
+
+  // The register ends the loop holding zero, where it held one before.
+  for (MachineBasicBlock *Exit : MBB.successors()) {
+    SmallPtrSet<const MachineBasicBlock *, 8> Visited;
+    if (Exit != &MBB && isLiveIn(*Exit, IR.Reg, Visited))
+      return false;
+  }
+  return true;
+}
+
+bool M6502LoopCounters::runOnLoop(MachineLoop *L) {
+  if (L->getNumBlocks() != 1)
+    return false;
+  MachineBasicBlock &MBB = *L->getHeader();
+  MachineBasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  // The counter is the zero page register the loop decrements once.
+  unsigned Counter = 0;
+  for (MachineInstr &MI : MBB) {
+    if (isOpaque(MI) || MI.isCall())
+      return false;
+    if (MI.getOpcode() != M6502::DECzp || !MI.getOperand(0).isReg())
+      continue;
+    if (Counter)
+      return false;
+    Counter = MI.getOperand(0).getReg();
+  }
+  if (!Counter)
+    return false;
+
+  // The loop must leave the counter dead behind it, as the zero page
+  // register keeps its value from before the loop.
+  for (MachineBasicBlock *Exit : MBB.successors()) {
+    if (Exit == &MBB)
+      continue;
+    for (MCRegAliasIterator AI(Counter, TRI, true); AI.isValid(); ++AI)
+      if (Exit->isLiveIn(*AI))
+        return false;
+  }
+
+  // The load before the loop sets N and Z.
+  if (readsNZ(MBB.begin(), MBB.end()))
+    return false;
+  for (MachineInstr &MI : Preheader->terminators())
+    if (isOpaque(MI) ||
+        M6502II::getFlagsUsed(MI.getDesc().TSFlags) & M6502II::FlagsNZ)
+      return false;
+
+  // Prefer X, which has more addressing modes.  A loop indexing with both X
+  // and Y keeps the counter in both, and counts down with DEX and DEY, which
+  // still takes less than DEC and the loads.
+  const IndexReg &XReg = IndexRegs[0], &YReg = IndexRegs[1];
+  SmallVector<const IndexReg *, 2> Kept;
+  if (canKeepIn(MBB, Counter, XReg, 0))
+    Kept.push_back(&XReg);
+  else if (canKeepIn(MBB, Counter, YReg, 0))
+    Kept.push_back(&YReg);
+  else if (canKeepIn(MBB, Counter, XReg, YReg.LoadOpc) &&
+           canKeepIn(MBB, Counter, YReg, XReg.LoadOpc))
+    Kept.append({&XReg, &YReg});
+  else
+    return false;
+
+  MachineBasicBlock::iterator InsertPt = Preheader->getFirstTerminator();
+  DebugLoc DL;
+  if (InsertPt != Preheader->end())
+    DL = InsertPt->getDebugLoc();
+  // Nothing reads the counter after it is stored just before the loop any
+  // more, so the value can go from A to the registers instead.
+  MachineBasicBlock::iterator Prev = InsertPt;
+  bool FromA = InsertPt != Preheader->begin() &&
+               (--Prev)->getOpcode() == M6502::STAzp &&
+               Prev->getOperand(0).isReg() &&
+               Prev->getOperand(0).getReg() == Counter;
+  for (const IndexReg *IR : Kept) {
+    DEBUG(dbgs() << "Keeping the counter of BB#" << MBB.getNumber()
+                 << " in " << TRI->getName(IR->Reg) << "\n");
+    if (FromA)
+      BuildMI(*Preheader, InsertPt, Prev->getDebugLoc(),
+              TII->get(IR->TransferOpc));
+    else
+      BuildMI(*Preheader, InsertPt, DL, TII->get(IR->LoadOpc))
+        .addReg(Counter);
+    if (IR->Reg == M6502::X)
+      ++NumCountersInX;
+    else
+      ++NumCountersInY;
+  }
+  if (FromA)
+    Prev->eraseFromParent();
+
+  for (MachineBasicBlock::iterator I = MBB.begin(), E = MBB.end(); I != E;) {
+    MachineInstr &MI = *I++;
+    if (any_of(Kept, [&](const IndexReg *IR) {
+          return isLoadOf(MI, IR->LoadOpc, Counter);
+        })) {
+      MI.eraseFromParent();
+      ++NumLoadsDeleted;
+    } else if (MI.getOpcode() == M6502::DECzp &&
+               MI.getOperand(0).getReg() == Counter) {
+      for (const IndexReg *IR : Kept)
+        BuildMI(MBB, MI, MI.getDebugLoc(), TII->get(IR->DecOpc));
+      MI.eraseFromParent();
+    }
+  }
+  MBB.removeLiveIn(Counter);
+  return true;
+}
+
+bool M6502LoopCounters::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(*MF.getFunction()))
+    return false;
+
+  TII = static_cast<const M6502InstrInfo *>(MF.getSubtarget().getInstrInfo());
+  TRI = MF.getSubtarget().getRegisterInfo();
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+
+  // A loop of a single block is innermost.
+  bool Changed = false;
+  SmallVector<MachineLoop *, 8> Worklist(MLI.begin(), MLI.end());
+  while (!Worklist.empty()) {
+    MachineLoop *L = Worklist.pop_back_val();
+    Worklist.append(L->begin(), L->end());
+    Changed |= runOnLoop(L);
+  }
+  return Changed;
+}
+
+/// createM6502LoopCountersPass - Returns a pass that keeps the counters of
+/// small loops in X or Y.
+FunctionPass *llvm::createM6502LoopCountersPass() {
+  return new M6502LoopCounters();
+}
@@ -1,4 +1,4 @@
-//===- M6502MCInstLower.cpp - Convert M6502 MachineInstr to MCInst ----------===//
+//===- M6502MCInstLower.cpp - Convert M6502 MachineInstr to MCInst --------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -35,10 +35,9 @@ void M6502MCInstLower::Initialize(MCContext *C) {
 
 MCOperand M6502MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
                                               MachineOperandType MOTy,
-                                              unsigned Offset) const {
+                                              int64_t Offset) const {
   MCSymbolRefExpr::VariantKind Kind = MCSymbolRefExpr::VK_None;
   M6502MCExpr::M6502ExprKind TargetKind = M6502MCExpr::MEK_None;
-  bool IsGpOff = false;
   const MCSymbol *Symbol;
 
   switch(MO.getTargetFlags()) {
@@ -46,76 +45,16 @@ MCOperand M6502MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
     llvm_unreachable("Invalid target flag!");
   case M6502II::MO_NO_FLAG:
     break;
-  case M6502II::MO_GPREL:
-    TargetKind = M6502MCExpr::MEK_GPREL;
-    break;
-  case M6502II::MO_GOT_CALL:
-    TargetKind = M6502MCExpr::MEK_GOT_CALL;
-    break;
-  case M6502II::MO_GOT:
-    TargetKind = M6502MCExpr::MEK_GOT;
-    break;
   case M6502II::MO_ABS_HI:
     TargetKind = M6502MCExpr::MEK_HI;
     break;
   case M6502II::MO_ABS_LO:
     TargetKind = M6502MCExpr::MEK_LO;
     break;
-  case M6502II::MO_TLSGD:
-    TargetKind = M6502MCExpr::MEK_TLSGD;
-    break;
-  case M6502II::MO_TLSLDM:
-    TargetKind = M6502MCExpr::MEK_TLSLDM;
-    break;
-  case M6502II::MO_DTPREL_HI:
-    TargetKind = M6502MCExpr::MEK_DTPREL_HI;
-    break;
-  case M6502II::MO_DTPREL_LO:
-    TargetKind = M6502MCExpr::MEK_DTPREL_LO;
-    break;
-  case M6502II::MO_GOTTPREL:
-    TargetKind = M6502MCExpr::MEK_GOTTPREL;
-    break;
-  case M6502II::MO_TPREL_HI:
-    TargetKind = M6502MCExpr::MEK_TPREL_HI;
-    break;
-  case M6502II::MO_TPREL_LO:
-    TargetKind = M6502MCExpr::MEK_TPREL_LO;
-    break;
-  case M6502II::MO_GPOFF_HI:
-    TargetKind = M6502MCExpr::MEK_HI;
-    IsGpOff = true;
-    break;
-  case M6502II::MO_GPOFF_LO:
-    TargetKind = M6502MCExpr::MEK_LO;
-    IsGpOff = true;
-    break;
-  case M6502II::MO_GOT_DISP:
-    TargetKind = M6502MCExpr::MEK_GOT_DISP;
-    break;
-  case M6502II::MO_GOT_HI16:
-    TargetKind = M6502MCExpr::MEK_GOT_HI16;
-    break;
-  case M6502II::MO_GOT_LO16:
-    TargetKind = M6502MCExpr::MEK_GOT_LO16;
-    break;
-  case M6502II::MO_GOT_PAGE:
-    TargetKind = M6502MCExpr::MEK_GOT_PAGE;
-    break;
-  case M6502II::MO_GOT_OFST:
-    TargetKind = M6502MCExpr::MEK_GOT_OFST;
-    break;
-  case M6502II::MO_HIGHER:
-    TargetKind = M6502MCExpr::MEK_HIGHER;
-    break;
-  case M6502II::MO_HIGHEST:
-    TargetKind = M6502MCExpr::MEK_HIGHEST;
-    break;
-  case M6502II::MO_CALL_HI16:
-    TargetKind = M6502MCExpr::MEK_CALL_HI16;
-    break;
-  case M6502II::MO_CALL_LO16:
-    TargetKind = M6502MCExpr::MEK_CALL_LO16;
+  case M6502II::MO_JT_HI:
+    assert(MOTy == MachineOperand::MO_JumpTableIndex &&
+           "High byte table of something other than a jump table");
+    Offset += AsmPrinter.getJumpTableHiOffset(MO.getIndex());
     break;
   }
 
@@ -159,17 +98,14 @@ MCOperand M6502MCInstLower::LowerSymbolOperand(const MachineOperand &MO,
 
   const MCExpr *Expr = MCSymbolRefExpr::create(Symbol, Kind, *Ctx);
 
-  if (Offset) {
-    // Assume offset is never negative.
-    assert(Offset > 0);
-
+  // The offset may be negative, as in the address of an array minus one
+  // which a loop indexes from one.
+  if (Offset)
     Expr = MCBinaryExpr::createAdd(Expr, MCConstantExpr::create(Offset, *Ctx),
                                    *Ctx);
-  }
 
-  if (IsGpOff)
-    Expr = M6502MCExpr::createGpOff(TargetKind, Expr, *Ctx);
-  else if (TargetKind != M6502MCExpr::MEK_None)
+
+  if (TargetKind != M6502MCExpr::MEK_None)
     Expr = M6502MCExpr::create(TargetKind, Expr, *Ctx);
 
   return MCOperand::createExpr(Expr);
@@ -202,72 +138,7 @@ MCOperand M6502MCInstLower::LowerOperand(const MachineOperand &MO,
   return MCOperand();
 }
 
-MCOperand M6502MCInstLower::createSub(MachineBasicBlock *BB1,
-                                     MachineBasicBlock *BB2,
-                                     M6502MCExpr::M6502ExprKind Kind) const {
-  const MCSymbolRefExpr *Sym1 = MCSymbolRefExpr::create(BB1->getSymbol(), *Ctx);
-  const MCSymbolRefExpr *Sym2 = MCSymbolRefExpr::create(BB2->getSymbol(), *Ctx);
-  const MCBinaryExpr *Sub = MCBinaryExpr::createSub(Sym1, Sym2, *Ctx);
-
-  return MCOperand::createExpr(M6502MCExpr::create(Kind, Sub, *Ctx));
-}
-
-void M6502MCInstLower::
-lowerLongBranchLUi(const MachineInstr *MI, MCInst &OutMI) const {
-  OutMI.setOpcode(M6502::LUi);
-
-  // Lower register operand.
-  OutMI.addOperand(LowerOperand(MI->getOperand(0)));
-
-  // Create %hi($tgt-$baltgt).
-  OutMI.addOperand(createSub(MI->getOperand(1).getMBB(),
-                             MI->getOperand(2).getMBB(),
-                             M6502MCExpr::MEK_HI));
-}
-
-void M6502MCInstLower::lowerLongBranchADDiu(
-    const MachineInstr *MI, MCInst &OutMI, int Opcode,
-    M6502MCExpr::M6502ExprKind Kind) const {
-  OutMI.setOpcode(Opcode);
-
-  // Lower two register operands.
-  for (unsigned I = 0, E = 2; I != E; ++I) {
-    const MachineOperand &MO = MI->getOperand(I);
-    OutMI.addOperand(LowerOperand(MO));
-  }
-
-  // Create %lo($tgt-$baltgt) or %hi($tgt-$baltgt).
-  OutMI.addOperand(createSub(MI->getOperand(2).getMBB(),
-                             MI->getOperand(3).getMBB(), Kind));
-}
-
-bool M6502MCInstLower::lowerLongBranch(const MachineInstr *MI,
-                                      MCInst &OutMI) const {
-  switch (MI->getOpcode()) {
-  default:
-    return false;
-  case M6502::LONG_BRANCH_LUi:
-    lowerLongBranchLUi(MI, OutMI);
-    return true;
-  case M6502::LONG_BRANCH_ADDiu:
-    lowerLongBranchADDiu(MI, OutMI, M6502::ADDiu, M6502MCExpr::MEK_LO);
-    return true;
-  case M6502::LONG_BRANCH_DADDiu:
-    unsigned TargetFlags = MI->getOperand(2).getTargetFlags();
-    if (TargetFlags == M6502II::MO_ABS_HI)
-      lowerLongBranchADDiu(MI, OutMI, M6502::DADDiu, M6502MCExpr::MEK_HI);
-    else if (TargetFlags == M6502II::MO_ABS_LO)
-      lowerLongBranchADDiu(MI, OutMI, M6502::DADDiu, M6502MCExpr::MEK_LO);
-    else
-      report_fatal_error("Unexpected flags for LONG_BRANCH_DADDiu");
-    return true;
-  }
-}
-
 void M6502MCInstLower::Lower(const MachineInstr *MI, MCInst &OutMI) const {
-  if (lowerLongBranch(MI, OutMI))
-    return;
-
   OutMI.setOpcode(MI->getOpcode());
 
   for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
@@ -10,13 +10,11 @@
 #ifndef LLVM_LIB_TARGET_M6502_M6502MCINSTLOWER_H
 #define LLVM_LIB_TARGET_M6502_M6502MCINSTLOWER_H
 
-#include "MCTargetDesc/M6502MCExpr.h"
 #include "llvm/CodeGen/MachineOperand.h"
 #include "llvm/Support/Compiler.h"
 
 namespace llvm {
 
-class MachineBasicBlock;
 class MachineInstr;
 class MCContext;
 class MCInst;
@@ -40,13 +38,7 @@ public:
 
 private:
   MCOperand LowerSymbolOperand(const MachineOperand &MO,
-                               MachineOperandType MOTy, unsigned Offset) const;
-  MCOperand createSub(MachineBasicBlock *BB1, MachineBasicBlock *BB2,
-                      M6502MCExpr::M6502ExprKind Kind) const;
-  void lowerLongBranchLUi(const MachineInstr *MI, MCInst &OutMI) const;
-  void lowerLongBranchADDiu(const MachineInstr *MI, MCInst &OutMI, int Opcode,
-                            M6502MCExpr::M6502ExprKind Kind) const;
-  bool lowerLongBranch(const MachineInstr *MI, MCInst &OutMI) const;
+                               MachineOperandType MOTy, int64_t Offset) const;
 };
 
 } // end namespace llvm
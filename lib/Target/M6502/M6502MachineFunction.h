@@ -1,4 +1,4 @@
-//===- M6502MachineFunctionInfo.h - Private data used for M6502 ---*- C++ -*-===//
+//===- M6502MachineFunctionInfo.h - Private data used for M6502 -*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -14,13 +14,13 @@
 #ifndef LLVM_LIB_TARGET_M6502_M6502MACHINEFUNCTION_H
 #define LLVM_LIB_TARGET_M6502_M6502MACHINEFUNCTION_H
 
-#include "M650216HardFloatInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineMemOperand.h"
-#include <map>
 
 namespace llvm {
 
+class MCSymbol;
+
 /// M6502FunctionInfo - This class is derived from MachineFunction private
 /// M6502 target-specific information for each MachineFunction.
 class M6502FunctionInfo : public MachineFunctionInfo {
@@ -32,9 +32,6 @@ public:
   unsigned getSRetReturnReg() const { return SRetReturnReg; }
   void setSRetReturnReg(unsigned Reg) { SRetReturnReg = Reg; }
 
-  bool globalBaseRegSet() const;
-  unsigned getGlobalBaseReg();
-
   int getVarArgsFrameIndex() const { return VarArgsFrameIndex; }
   void setVarArgsFrameIndex(int Index) { VarArgsFrameIndex = Index; }
 
@@ -46,37 +43,32 @@ public:
 
   unsigned getIncomingArgSize() const { return IncomingArgSize; }
 
-  bool callsEhReturn() const { return CallsEhReturn; }
-  void setCallsEhReturn() { CallsEhReturn = true; }
+  /// Return true if the frame of this function lives at a fixed address
+  /// rather than on the software stack.
+  bool hasStaticFrame() const { return StaticFrame; }
+  void setStaticFrame(bool V) { StaticFrame = V; }
 
-  void createEhDataRegsFI();
-  int getEhDataRegFI(unsigned Reg) const { return EhDataRegFI[Reg]; }
-  bool isEhDataRegFI(int FI) const;
+  /// Return the symbol at the start of the static frame, which the asm
+  /// printer defines once the frames of the module have been overlaid.
+  MCSymbol *getStaticFrameSymbol() const;
+
+  /// Return the zero page registers the calls of this function clobber,
+  /// which the register allocator offers first to every value.
+  ArrayRef<MCPhysReg> getCallClobberedRegs() const {
+    return CallClobberedRegs;
+  }
+  void setCallClobberedRegs(ArrayRef<MCPhysReg> Regs) {
+    CallClobberedRegs.assign(Regs.begin(), Regs.end());
+  }
 
   /// Create a MachinePointerInfo that has an ExternalSymbolPseudoSourceValue
-  /// object representing a GOT entry for an external function.
+  /// object representing the call entry of an external function.
   MachinePointerInfo callPtrInfo(const char *ES);
 
-  // Functions with the "interrupt" attribute require special prologues,
-  // epilogues and additional spill slots.
-  bool isISR() const { return IsISR; }
-  void setISR() { IsISR = true; }
-  void createISRRegFI();
-  int getISRRegFI(unsigned Reg) const { return ISRDataRegFI[Reg]; }
-  bool isISRRegFI(int FI) const;
-
   /// Create a MachinePointerInfo that has a GlobalValuePseudoSourceValue object
-  /// representing a GOT entry for a global function.
+  /// representing the call entry of a global function.
   MachinePointerInfo callPtrInfo(const GlobalValue *GV);
 
-  void setSaveS2() { SaveS2 = true; }
-  bool hasSaveS2() const { return SaveS2; }
-
-  int getMoveF64ViaSpillFI(const TargetRegisterClass *RC);
-
-  std::map<const char *, const M650216HardFloatInfo::FuncSignature *>
-  StubsNeeded;
-
 private:
   virtual void anchor();
 
@@ -87,11 +79,6 @@ private:
   /// holds the virtual register into which the sret argument is passed.
   unsigned SRetReturnReg = 0;
 
-  /// GlobalBaseReg - keeps track of the virtual register initialized for
-  /// use as the global base register. This is used for PIC in some PIC
-  /// relocation models.
-  unsigned GlobalBaseReg = 0;
-
   /// VarArgsFrameIndex - FrameIndex for start of varargs area.
   int VarArgsFrameIndex = 0;
 
@@ -101,24 +88,11 @@ private:
   /// Size of incoming argument area.
   unsigned IncomingArgSize;
 
-  /// CallsEhReturn - Whether the function calls llvm.eh.return.
-  bool CallsEhReturn = false;
-
-  /// Frame objects for spilling eh data registers.
-  int EhDataRegFI[4];
-
-  /// ISR - Whether the function is an Interrupt Service Routine.
-  bool IsISR = false;
-
-  /// Frame objects for spilling C0_STATUS, C0_EPC
-  int ISRDataRegFI[2];
-
-  // saveS2
-  bool SaveS2 = false;
+  /// True if the frame has a fixed address.
+  bool StaticFrame = false;
 
-  /// FrameIndex for expanding BuildPairF64 nodes to spill and reload when the
-  /// O32 FPXX ABI is enabled. -1 is used to denote invalid index.
-  int MoveF64ViaSpillFI = -1;
+  /// Zero page registers clobbered by the calls of the function.
+  SmallVector<MCPhysReg, 32> CallClobberedRegs;
 };
 
 } // end namespace llvm
@@ -0,0 +1,300 @@
+//===- M6502PageLayout.cpp - Keep hot code and tables within a page -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// On the 6502 a taken branch whose target lies in another page than the next
+// instruction costs an extra cycle, and so does an indexed read whose
+// effective address lies in another page than its base.  Which accesses pay
+// depends on the final addresses, which makes the cycle count of a loop
+// change whenever unrelated code moves.
+//
+// This pass keeps the hot innermost loops within a page.  The address
+// following the loop counts too, as it is the one a backward branch at the
+// end of the loop is relative to.  A loop of S bytes cannot straddle a page
+// when it starts on a boundary of the next power of two N > S, so the
+// function is given an alignment of at least N, which makes the offset of the
+// loop modulo N known, and the loop header is aligned to N only when the loop
+// would cross an N byte boundary otherwise.  The padding is filled with NOPs.
+//
+// Either alignment may cost up to N - 1 bytes, while a crossing costs a cycle
+// per iteration, so a loop is only aligned when it is expected to run at
+// least N - 1 times per call, and never when optimizing for size.  The pass
+// runs after the long branch pass, so that the sizes it sees are final, and
+// it leaves a loop unaligned rather than push a branch out of range.
+//
+// Tables read through an index are kept within a page by the AsmPrinter,
+// which knows where in their section they are emitted.
+//
+// The branches within loops which may still cross a page are reported as
+// optimization remarks, with -pass-remarks-analysis=m6502-page-layout.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502InstrInfo.h"
+#include "M6502Subtarget.h"
+#include "MCTargetDesc/M6502BaseInfo.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineOptimizationRemarkEmitter.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-page-layout"
+
+STATISTIC(NumLoopsAligned, "Number of loops kept within a page");
+STATISTIC(NumLoopsPadded, "Number of loops moved to the next boundary");
+STATISTIC(NumLoopsUnpadded, "Number of loops left unaligned to keep branches "
+                            "in range");
+STATISTIC(NumPageCrossings, "Number of branches which may cross a page");
+
+static cl::opt<bool>
+PageAlignLoops("m6502-page-align-loops", cl::Hidden, cl::init(true),
+               cl::desc("Keep innermost loops within a page (default=on)"));
+
+namespace {
+
+  const unsigned PageSize = 256;
+  const unsigned PageSizeLog2 = 8;
+
+  class M6502PageLayout : public MachineFunctionPass {
+  public:
+    static char ID;
+
+    M6502PageLayout() : MachineFunctionPass(ID) {}
+
+    StringRef getPassName() const override { return "M6502 Page Layout"; }
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.addRequired<MachineBlockFrequencyInfo>();
+      AU.addRequired<MachineLoopInfo>();
+      AU.addRequired<MachineOptimizationRemarkEmitterPass>();
+      AU.setPreservesAll();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    MachineFunctionProperties getRequiredProperties() const override {
+      return MachineFunctionProperties().set(
+          MachineFunctionProperties::Property::NoVRegs);
+    }
+
+  private:
+    const M6502InstrInfo *TII;
+    MachineFunction *MF;
+
+    /// The offset of each block from the start of the function, including
+    /// the alignment padding, and one past the end of the last block.
+    SmallVector<unsigned, 16> BlockOffsets;
+
+    void computeBlockOffsets();
+    unsigned getBlockSize(const MachineBasicBlock &MBB) const;
+    bool branchesInRange() const;
+    bool alignLoop(MachineLoop *L, const MachineBlockFrequencyInfo &MBFI);
+    void reportCrossings(const MachineLoopInfo &MLI,
+                         MachineOptimizationRemarkEmitter &ORE);
+  };
+
+} // end anonymous namespace
+
+char M6502PageLayout::ID = 0;
+
+unsigned M6502PageLayout::getBlockSize(const MachineBasicBlock &MBB) const {
+  unsigned Size = 0;
+  for (const MachineInstr &MI : MBB)
+    Size += TII->getInstSizeInBytes(MI);
+  return Size;
+}
+
+void M6502PageLayout::computeBlockOffsets() {
+  BlockOffsets.clear();
+  unsigned Offset = 0;
+  for (MachineBasicBlock &MBB : *MF) {
+    Offset = alignTo(Offset, 1u << MBB.getAlignment());
+    BlockOffsets.push_back(Offset);
+    Offset += getBlockSize(MBB);
+  }
+  BlockOffsets.push_back(Offset);
+}
+
+/// Return true if MI is a branch relative to the address following it.
+static bool isRelativeBranch(const MachineInstr &MI) {
+  return MI.isBranch() &&
+         (MI.getDesc().TSFlags & M6502II::FormMask) == M6502II::FrmRel;
+}
+
+/// Return true if every relative branch reaches its target at the current
+/// block offsets.
+bool M6502PageLayout::branchesInRange() const {
+  for (const MachineBasicBlock &MBB : *MF) {
+    unsigned Offset = BlockOffsets[MBB.getNumber()];
+    for (const MachineInstr &MI : MBB) {
+      Offset += TII->getInstSizeInBytes(MI);
+      if (!isRelativeBranch(MI))
+        continue;
+
+      unsigned Target = BlockOffsets[MI.getOperand(0).getMBB()->getNumber()];
+      if (!isInt<8>((int64_t)Target - (int64_t)Offset))
+        return false;
+    }
+  }
+  return true;
+}
+
+/// Align L so that it cannot straddle a page, if it runs often enough to pay
+/// for the padding.  Return true if the function or one of its blocks was
+/// given a larger alignment.
+bool M6502PageLayout::alignLoop(MachineLoop *L,
+                                const MachineBlockFrequencyInfo &MBFI) {
+  // Blocks are numbered in layout order.
+  unsigned First = ~0u, Last = 0;
+  for (MachineBasicBlock *MBB : L->blocks()) {
+    First = std::min(First, (unsigned)MBB->getNumber());
+    Last = std::max(Last, (unsigned)MBB->getNumber());
+  }
+
+  computeBlockOffsets();
+  unsigned Start = BlockOffsets[First];
+  unsigned Size = BlockOffsets[Last + 1] - Start;
+  if (Size == 0 || Size >= PageSize)
+    return false;
+
+  // The loop and the address following it fit in a window of 1 << WindowLog2
+  // bytes, and the start of the function is at least as aligned as such a
+  // window once the function alignment is raised.  Each alignment costs up to
+  // a window of padding, against a cycle saved per iteration.
+  unsigned WindowLog2 = Log2_32_Ceil(Size + 1);
+  uint64_t HeaderFreq = MBFI.getBlockFreq(L->getHeader()).getFrequency();
+  if (HeaderFreq < MBFI.getEntryFreq() * ((1u << WindowLog2) - 1))
+    return false;
+
+  bool Changed = false;
+  if (MF->getAlignment() < WindowLog2) {
+    MF->ensureAlignment(WindowLog2);
+    Changed = true;
+  }
+  unsigned KnownLog2 = std::min(MF->getAlignment(), PageSizeLog2);
+
+  ++NumLoopsAligned;
+  unsigned Known = 1u << KnownLog2;
+  if (Start % Known + Size < Known)
+    return Changed;
+
+  // The branches have already been relaxed, so the padding must not push
+  // one which jumps over it out of range.
+  MachineBasicBlock *Top = MF->getBlockNumbered(First);
+  unsigned OldAlign = Top->getAlignment();
+  Top->setAlignment(WindowLog2);
+  computeBlockOffsets();
+  if (!branchesInRange()) {
+    Top->setAlignment(OldAlign);
+    ++NumLoopsUnpadded;
+    return Changed;
+  }
+
+  DEBUG(dbgs() << "Page layout: moving loop at BB#" << First << " ("
+               << Size << " bytes) to a " << (1u << WindowLog2)
+               << " byte boundary\n");
+  ++NumLoopsPadded;
+  return true;
+}
+
+void M6502PageLayout::reportCrossings(const MachineLoopInfo &MLI,
+                                      MachineOptimizationRemarkEmitter &ORE) {
+  computeBlockOffsets();
+
+  // Offsets are only known modulo the alignment of the function.  A branch
+  // certainly stays within its page when the next instruction and the
+  // target are in the same aligned window.
+  unsigned KnownLog2 = std::min(MF->getAlignment(), PageSizeLog2);
+  bool Exact = KnownLog2 == PageSizeLog2;
+
+  for (MachineBasicBlock &MBB : *MF) {
+    // Only the branches which are executed repeatedly matter.
+    if (!MLI.getLoopFor(&MBB))
+      continue;
+
+    unsigned Offset = BlockOffsets[MBB.getNumber()];
+    for (MachineInstr &MI : MBB) {
+      Offset += TII->getInstSizeInBytes(MI);
+      if (!isRelativeBranch(MI))
+        continue;
+
+      MachineBasicBlock *Dest = MI.getOperand(0).getMBB();
+      unsigned Target = BlockOffsets[Dest->getNumber()];
+      if (Offset >> KnownLog2 == Target >> KnownLog2)
+        continue;
+
+      ++NumPageCrossings;
+      ORE.emit([&]() {
+        return MachineOptimizationRemarkAnalysis(DEBUG_TYPE, "PageCrossing",
+                                                 MI.getDebugLoc(), &MBB)
+               << "branch in " << ore::NV("Function", MF->getName())
+               << " from BB#" << ore::NV("Source", MBB.getNumber())
+               << " to BB#" << ore::NV("Target", Dest->getNumber())
+               << (Exact ? " crosses" : " may cross") << " a page";
+      });
+    }
+  }
+}
+
+bool M6502PageLayout::runOnMachineFunction(MachineFunction &F) {
+  MF = &F;
+  TII = static_cast<const M6502InstrInfo *>(
+      F.getSubtarget<M6502Subtarget>().getInstrInfo());
+
+  MF->RenumberBlocks();
+
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+  bool Changed = false;
+  if (PageAlignLoops && !skipFunction(*F.getFunction()) &&
+      !F.getFunction()->optForSize()) {
+    const MachineBlockFrequencyInfo &MBFI =
+        getAnalysis<MachineBlockFrequencyInfo>();
+    SmallVector<MachineLoop *, 8> Innermost;
+    SmallVector<MachineLoop *, 8> Worklist(MLI.begin(), MLI.end());
+    while (!Worklist.empty()) {
+      MachineLoop *L = Worklist.pop_back_val();
+      if (L->empty())
+        Innermost.push_back(L);
+      else
+        Worklist.append(L->begin(), L->end());
+    }
+
+    // Align the loops in layout order, so that the padding of a loop only
+    // moves the loops which have not been looked at yet.
+    std::sort(Innermost.begin(), Innermost.end(),
+              [](MachineLoop *A, MachineLoop *B) {
+                return A->getTopBlock()->getNumber() <
+                       B->getTopBlock()->getNumber();
+              });
+    for (MachineLoop *L : Innermost)
+      Changed |= alignLoop(L, MBFI);
+  }
+
+  reportCrossings(MLI,
+                  getAnalysis<MachineOptimizationRemarkEmitterPass>().getORE());
+  return Changed;
+}
+
+/// createM6502PageLayoutPass - Returns a pass that keeps innermost loops
+/// within a page.
+FunctionPass *llvm::createM6502PageLayoutPass() {
+  return new M6502PageLayout();
+}
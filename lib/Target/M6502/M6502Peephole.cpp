@@ -0,0 +1,1042 @@
+//===- M6502Peephole.cpp - Delete redundant loads, compares and flag ops --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Every pseudo instruction is expanded on its own, so each expansion loads
+// the CPU registers it needs from the zero page registers again, although
+// the previous one often left them holding the same values.  Most
+// instructions also set N and Z from their result, which makes a CMP #0 of a
+// value which was just loaded redundant, and a CLC or SEC is redundant when
+// the carry is known from a previous compare or branch.
+//
+// This pass numbers the values held by A, X, Y, the zero page registers and
+// each of the N, Z, C and V flags through every basic block, continuing
+// from the end of the predecessor of a block with a single one, where the
+// branch taken to the block may tell the carry.  The flags each instruction
+// reads and writes are given by the FlagsUsed and FlagsDefined fields of its
+// TSFlags.  A load, register transfer, compare, CLC or SEC is deleted when
+// every location it writes either holds the value it would be given already
+// or is not read before being written again, and so is a store to a zero
+// page register.  A load of a value held by another CPU register becomes a
+// register transfer, a load only there to set N and Z becomes a compare
+// with zero, and a zero page register operand holding a known constant
+// becomes an immediate.
+//
+// On the 65C02, a store of a register known to hold zero becomes an STZ, an
+// ADC or SBC adding one to A with a known carry, or an INC or DEC of a zero
+// page register just stored from A, becomes INC A or DEC A, and a load, ORA
+// or AND of a constant and store back to the same byte becomes TSB or TRB,
+// or SMB or RMB for a single bit of the zero page.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502InstrInfo.h"
+#include "M6502Subtarget.h"
+#include "MCTargetDesc/M6502BaseInfo.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/LivePhysRegs.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-peephole"
+
+STATISTIC(NumLoadsDeleted, "Number of redundant loads and transfers deleted");
+STATISTIC(NumComparesDeleted, "Number of redundant compares deleted");
+STATISTIC(NumCarryOpsDeleted, "Number of redundant CLC and SEC deleted");
+STATISTIC(NumStoresDeleted, "Number of redundant zero page stores deleted");
+STATISTIC(NumTransfers, "Number of loads turned into register transfers");
+STATISTIC(NumConstantsFolded, "Number of constant operands made immediate");
+STATISTIC(NumLoadCompares, "Number of loads turned into compares with zero");
+STATISTIC(NumStoresOfZero, "Number of stores of zero turned into STZ");
+STATISTIC(NumIncDecAcc, "Number of additions of one turned into INC/DEC A");
+STATISTIC(NumBitOps, "Number of bit updates turned into TSB, TRB, SMB, RMB");
+
+static cl::opt<bool>
+EnablePeephole("m6502-peephole", cl::Hidden, cl::init(true),
+               cl::desc("Delete redundant loads, compares and flag changes "
+                        "(default=on)"));
+
+namespace {
+
+  /// The locations whose values are tracked besides the zero page registers.
+  /// The flags are in the order of their bits in the FlagsUsed and
+  /// FlagsDefined masks.
+  enum Location { LocA, LocX, LocY, LocN, LocZ, LocC, LocV, NumLocations };
+
+  const unsigned AllLocations = (1u << NumLocations) - 1;
+
+  /// The value numbers held by the locations at some point.
+  struct ValueState {
+    unsigned Locs[NumLocations];
+    /// The values of the zero page byte registers known.
+    DenseMap<unsigned, unsigned> ZPRegs;
+  };
+
+  /// A location written by an instruction and the value it is given.  Loc
+  /// is NumLocations for the zero page register Reg.
+  struct Effect {
+    unsigned Loc;
+    unsigned Reg;
+    unsigned Value;
+  };
+
+  class M6502Peephole : public MachineFunctionPass {
+  public:
+    static char ID;
+
+    M6502Peephole() : MachineFunctionPass(ID) {}
+
+    StringRef getPassName() const override { return "M6502 Peephole"; }
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    MachineFunctionProperties getRequiredProperties() const override {
+      return MachineFunctionProperties().set(
+          MachineFunctionProperties::Property::NoVRegs);
+    }
+
+  private:
+    const M6502InstrInfo *TII;
+    const TargetRegisterInfo *TRI;
+    const MachineRegisterInfo *MRI;
+    bool HasCMOS, HasBitOps;
+
+    /// Value numbers start at 1, so that 0 is never a value.
+    unsigned NextValue;
+    DenseMap<int64_t, unsigned> ConstValues;
+    DenseMap<unsigned, int64_t> ValueConsts;
+    /// The value of the flags after comparing two values.
+    DenseMap<std::pair<unsigned, unsigned>, unsigned> CompareValues;
+
+    /// The CPU registers and flags live into each block, by block number.
+    std::vector<unsigned> LiveIns;
+    /// The state at the end of each block already optimized, by block
+    /// number.
+    std::vector<ValueState> ExitStates;
+    BitVector Visited;
+
+    unsigned getNewValue() { return NextValue++; }
+    unsigned getConstValue(int64_t Imm);
+    unsigned getZPValue(ValueState &State, unsigned Reg);
+    bool getOperandValue(const MachineOperand &MO, ValueState &State,
+                         unsigned &Value);
+    void resetState(ValueState &State);
+
+    void computeLiveIns(MachineFunction &MF);
+    void updateZPLiveIns(MachineFunction &MF);
+    unsigned getLiveOuts(const MachineBasicBlock &MBB) const;
+
+    void getEntryState(const MachineBasicBlock &MBB, ValueState &State);
+    bool getEffects(const MachineInstr &MI, ValueState &State,
+                    SmallVectorImpl<Effect> &Effects);
+    void clobber(const MachineInstr &MI, ValueState &State);
+    MachineInstr *foldConstant(MachineInstr &MI, const ValueState &State);
+    bool replaceByTransfer(MachineInstr &MI, const ValueState &State,
+                           unsigned Value);
+    bool replaceByCompare(MachineInstr &MI);
+    MachineInstr *useStoreZero(MachineInstr &MI, const ValueState &State);
+    MachineInstr *useIncDecAcc(MachineInstr &MI, const ValueState &State,
+                               unsigned LiveLocs);
+    MachineInstr *useIncDecAccForZP(MachineInstr &MI, ValueState &State,
+                                    unsigned LiveLocs, bool StoreDead,
+                                    const MachineInstr *Next);
+    bool useBitOps(MachineBasicBlock &MBB);
+    void clearKills(MachineFunction &MF, unsigned Reg);
+    bool optimizeBlock(MachineBasicBlock &MBB, ValueState &State);
+  };
+
+} // end anonymous namespace
+
+char M6502Peephole::ID = 0;
+
+/// Return true if the effect of MI on the CPU registers and flags is not
+/// described by its operands and TSFlags.
+static bool isOpaque(const MachineInstr &MI) {
+  return MI.isInlineAsm() ||
+         (MI.getDesc().TSFlags & M6502II::FormMask) == M6502II::Pseudo;
+}
+
+static bool isZPReg(unsigned Reg) {
+  return M6502::ZP8RegClass.contains(Reg) || M6502::ZP16RegClass.contains(Reg);
+}
+
+/// Return the CPU registers and flags read by MI.  A return reads the CPU
+/// registers holding the values returned, which are among its operands.
+static unsigned getUsedLocations(const MachineInstr &MI) {
+  if (isOpaque(MI))
+    return AllLocations;
+
+  unsigned Locs = M6502II::getFlagsUsed(MI.getDesc().TSFlags) << LocN;
+  if (MI.readsRegister(M6502::A))
+    Locs |= 1u << LocA;
+  if (MI.readsRegister(M6502::X))
+    Locs |= 1u << LocX;
+  if (MI.readsRegister(M6502::Y))
+    Locs |= 1u << LocY;
+  return Locs;
+}
+
+/// Return the CPU registers and flags written by MI.
+static unsigned getDefinedLocations(const MachineInstr &MI) {
+  if (isOpaque(MI))
+    return 0;
+
+  unsigned Locs = M6502II::getFlagsDefined(MI.getDesc().TSFlags) << LocN;
+  if (MI.definesRegister(M6502::A))
+    Locs |= 1u << LocA;
+  if (MI.definesRegister(M6502::X))
+    Locs |= 1u << LocX;
+  if (MI.definesRegister(M6502::Y))
+    Locs |= 1u << LocY;
+  return Locs;
+}
+
+/// Return true if MI may write to the zero page registers through an
+/// address which is not one of its register operands.
+static bool mayStoreToZPRegs(const MachineInstr &MI) {
+  if (!MI.mayStore())
+    return false;
+
+  unsigned Form = MI.getDesc().TSFlags & M6502II::FormMask;
+  if (Form != M6502II::FrmZP && Form != M6502II::FrmZPX &&
+      Form != M6502II::FrmZPY && Form != M6502II::FrmAbs &&
+      Form != M6502II::FrmAbsX && Form != M6502II::FrmAbsY)
+    return false;
+
+  const MachineOperand &Addr = MI.getOperand(0);
+  if (Addr.isImm())
+    return Addr.getImm() < 0x100;
+  return Addr.isReg() && (Form == M6502II::FrmZPX || Form == M6502II::FrmZPY);
+}
+
+/// Return the value of the carry flag on the edge from Pred to MBB, as told
+/// by the branches on the carry which are taken or not on the way, or -1 if
+/// it is not known.
+static int getEdgeCarry(const MachineBasicBlock &Pred,
+                        const MachineBasicBlock &MBB) {
+  int Carry = -1, EdgeCarry = -1;
+  unsigned NumEdges = 0;
+  bool FallsThrough = true;
+
+  for (const MachineInstr &MI : Pred.terminators()) {
+    if (MI.isBarrier())
+      FallsThrough = false;
+    if (!MI.isBranch())
+      continue;
+
+    int TakenCarry = -1;
+    if (MI.getOpcode() == M6502::BCC)
+      TakenCarry = 0;
+    else if (MI.getOpcode() == M6502::BCS)
+      TakenCarry = 1;
+
+    const MachineOperand &Target = MI.getOperand(0);
+    if (Target.isMBB() && Target.getMBB() == &MBB) {
+      ++NumEdges;
+      EdgeCarry = TakenCarry != -1 ? TakenCarry : Carry;
+    } else if (TakenCarry != -1) {
+      Carry = !TakenCarry;
+    }
+  }
+
+  if (FallsThrough && Pred.isLayoutSuccessor(&MBB)) {
+    ++NumEdges;
+    EdgeCarry = Carry;
+  }
+  return NumEdges == 1 ? EdgeCarry : -1;
+}
+
+unsigned M6502Peephole::getConstValue(int64_t Imm) {
+  unsigned &Value = ConstValues[Imm & 0xff];
+  if (!Value) {
+    Value = getNewValue();
+    ValueConsts[Value] = Imm & 0xff;
+  }
+  return Value;
+}
+
+/// Return the value of the zero page byte register Reg, giving it a new one
+/// if it is not known.
+unsigned M6502Peephole::getZPValue(ValueState &State, unsigned Reg) {
+  unsigned &Value = State.ZPRegs[Reg];
+  if (!Value)
+    Value = getNewValue();
+  return Value;
+}
+
+/// Set Value to the value of the immediate or zero page register operand MO.
+/// Return false for any other operand, including the constant address of a
+/// zero page instruction, as in LDA $10, which may hold anything.
+bool M6502Peephole::getOperandValue(const MachineOperand &MO,
+                                    ValueState &State, unsigned &Value) {
+  if (MO.isImm()) {
+    if ((MO.getParent()->getDesc().TSFlags & M6502II::FormMask) !=
+        M6502II::FrmImm)
+      return false;
+    Value = getConstValue(MO.getImm());
+    return true;
+  }
+  if (MO.isReg() && M6502::ZP8RegClass.contains(MO.getReg())) {
+    Value = getZPValue(State, MO.getReg());
+    return true;
+  }
+  return false;
+}
+
+void M6502Peephole::resetState(ValueState &State) {
+  for (unsigned &Value : State.Locs)
+    Value = getNewValue();
+  State.ZPRegs.clear();
+}
+
+unsigned M6502Peephole::getLiveOuts(const MachineBasicBlock &MBB) const {
+  if (MBB.succ_empty()) {
+    MachineBasicBlock::const_iterator I = MBB.getLastNonDebugInstr();
+    return I != MBB.end() && I->isReturn() ? 0 : AllLocations;
+  }
+
+  unsigned Locs = 0;
+  for (const MachineBasicBlock *Succ : MBB.successors())
+    Locs |= LiveIns[Succ->getNumber()];
+  return Locs;
+}
+
+/// Compute the CPU registers and flags live into each block.  They are
+/// never in the live in lists of the blocks, as they are reserved.
+void M6502Peephole::computeLiveIns(MachineFunction &MF) {
+  LiveIns.assign(MF.getNumBlockIDs(), 0);
+
+  bool Changed;
+  do {
+    Changed = false;
+    for (MachineBasicBlock &MBB : reverse(MF)) {
+      unsigned Locs = getLiveOuts(MBB);
+      for (const MachineInstr &MI : reverse(MBB)) {
+        if (MI.isDebugValue())
+          continue;
+        Locs = (Locs & ~getDefinedLocations(MI)) | getUsedLocations(MI);
+      }
+
+      unsigned &BlockLocs = LiveIns[MBB.getNumber()];
+      if ((BlockLocs | Locs) != BlockLocs) {
+        BlockLocs |= Locs;
+        Changed = true;
+      }
+    }
+  } while (Changed);
+}
+
+/// Recompute the zero page registers live into each block, as a load
+/// deleted or turned into a transfer may have been the last read of one in
+/// its block, which makes the stores to it in the predecessors dead.
+void M6502Peephole::updateZPLiveIns(MachineFunction &MF) {
+  bool Changed;
+  do {
+    Changed = false;
+    for (MachineBasicBlock &MBB : reverse(MF)) {
+      LivePhysRegs LiveRegs(*TRI);
+      llvm::computeLiveIns(LiveRegs, MBB);
+      SmallVector<unsigned, 8> Old;
+      for (const MachineBasicBlock::RegisterMaskPair &LI : MBB.liveins())
+        Old.push_back(LI.PhysReg);
+
+      MBB.clearLiveIns();
+      addLiveIns(MBB, LiveRegs);
+      MBB.sortUniqueLiveIns();
+      SmallVector<unsigned, 8> New;
+      for (const MachineBasicBlock::RegisterMaskPair &LI : MBB.liveins())
+        New.push_back(LI.PhysReg);
+      if (Old != New)
+        Changed = true;
+    }
+  } while (Changed);
+}
+
+/// Set State to the values at the start of MBB.  They are those at the end
+/// of its predecessor when it has a single one which has been optimized
+/// already, as far as the zero page registers live into MBB are concerned.
+void M6502Peephole::getEntryState(const MachineBasicBlock &MBB,
+                                  ValueState &State) {
+  resetState(State);
+  if (MBB.pred_size() != 1 || MBB.isEHPad() || MBB.hasAddressTaken())
+    return;
+
+  const MachineBasicBlock *Pred = *MBB.pred_begin();
+  if (Pred == &MBB || !Visited.test(Pred->getNumber()))
+    return;
+
+  const ValueState &Exit = ExitStates[Pred->getNumber()];
+  std::copy(std::begin(Exit.Locs), std::end(Exit.Locs), State.Locs);
+  for (const MachineBasicBlock::RegisterMaskPair &LI : MBB.liveins())
+    for (MCSubRegIterator SR(LI.PhysReg, TRI, true); SR.isValid(); ++SR) {
+      auto I = Exit.ZPRegs.find(*SR);
+      if (I != Exit.ZPRegs.end())
+        State.ZPRegs[*SR] = I->second;
+    }
+
+  int Carry = getEdgeCarry(*Pred, MBB);
+  if (Carry != -1)
+    State.Locs[LocC] = getConstValue(Carry);
+}
+
+/// Fill Effects with the locations written by MI and their new values, if
+/// MI is one of the instructions which may be deleted.
+bool M6502Peephole::getEffects(const MachineInstr &MI, ValueState &State,
+                               SmallVectorImpl<Effect> &Effects) {
+  unsigned Opc = MI.getOpcode();
+  unsigned Value;
+
+  switch (Opc) {
+  default:
+    return false;
+
+  case M6502::LDAimm:
+  case M6502::LDXimm:
+  case M6502::LDYimm:
+  case M6502::LDAzp:
+  case M6502::LDXzp:
+  case M6502::LDYzp: {
+    if (!getOperandValue(MI.getOperand(0), State, Value))
+      return false;
+    unsigned Loc = LocA;
+    if (Opc == M6502::LDXimm || Opc == M6502::LDXzp)
+      Loc = LocX;
+    else if (Opc == M6502::LDYimm || Opc == M6502::LDYzp)
+      Loc = LocY;
+    Effects.push_back({Loc, 0, Value});
+    break;
+  }
+
+  case M6502::TAX:
+  case M6502::TAY:
+  case M6502::TXA:
+  case M6502::TYA:
+    Value = State.Locs[Opc == M6502::TXA ? LocX
+                       : Opc == M6502::TYA ? LocY : LocA];
+    Effects.push_back({Opc == M6502::TAX ? LocX
+                       : Opc == M6502::TAY ? LocY : LocA, 0, Value});
+    break;
+
+  case M6502::CMPimm:
+  case M6502::CPXimm:
+  case M6502::CPYimm:
+  case M6502::CMPzp:
+  case M6502::CPXzp:
+  case M6502::CPYzp: {
+    unsigned Operand;
+    if (!getOperandValue(MI.getOperand(0), State, Operand))
+      return false;
+    unsigned Src = State.Locs[LocA];
+    if (Opc == M6502::CPXimm || Opc == M6502::CPXzp)
+      Src = State.Locs[LocX];
+    else if (Opc == M6502::CPYimm || Opc == M6502::CPYzp)
+      Src = State.Locs[LocY];
+
+    // Comparing with zero sets N and Z as loading the register did, and
+    // always sets the carry.
+    if (Operand == getConstValue(0)) {
+      Effects.push_back({LocN, 0, Src});
+      Effects.push_back({LocZ, 0, Src});
+      Effects.push_back({LocC, 0, getConstValue(1)});
+      return true;
+    }
+
+    unsigned &Flags = CompareValues[std::make_pair(Src, Operand)];
+    if (!Flags)
+      Flags = getNewValue();
+    Effects.push_back({LocN, 0, Flags});
+    Effects.push_back({LocZ, 0, Flags});
+    Effects.push_back({LocC, 0, Flags});
+    return true;
+  }
+
+  case M6502::CLC:
+  case M6502::SEC:
+    Effects.push_back({LocC, 0, getConstValue(Opc == M6502::SEC)});
+    return true;
+
+  case M6502::STAzp:
+  case M6502::STXzp:
+  case M6502::STYzp: {
+    const MachineOperand &Addr = MI.getOperand(0);
+    if (!Addr.isReg() || !M6502::ZP8RegClass.contains(Addr.getReg()))
+      return false;
+    unsigned Loc = Opc == M6502::STXzp ? LocX
+                   : Opc == M6502::STYzp ? LocY : LocA;
+    Effects.push_back({NumLocations, Addr.getReg(), State.Locs[Loc]});
+    return true;
+  }
+
+  case M6502::STZzp: {
+    const MachineOperand &Addr = MI.getOperand(0);
+    if (!Addr.isReg() || !M6502::ZP8RegClass.contains(Addr.getReg()))
+      return false;
+    Effects.push_back({NumLocations, Addr.getReg(), getConstValue(0)});
+    return true;
+  }
+  }
+
+  // Loads and transfers set N and Z from the value.
+  Effects.push_back({LocN, 0, Value});
+  Effects.push_back({LocZ, 0, Value});
+  return true;
+}
+
+/// Give new values to the locations written by MI, which getEffects does
+/// not describe.  N and Z are given the value of the only register written,
+/// if there is one and they are set from it rather than from a 16-bit A.
+void M6502Peephole::clobber(const MachineInstr &MI, ValueState &State) {
+  if (isOpaque(MI)) {
+    resetState(State);
+    return;
+  }
+  if (mayStoreToZPRegs(MI))
+    State.ZPRegs.clear();
+
+  SmallVector<unsigned, 4> Defs;
+  for (const MachineOperand &MO : MI.operands()) {
+    if (MO.isRegMask()) {
+      SmallVector<unsigned, 8> Clobbered;
+      for (const auto &ZP : State.ZPRegs)
+        if (MO.clobbersPhysReg(ZP.first))
+          Clobbered.push_back(ZP.first);
+      for (unsigned Reg : Clobbered)
+        State.ZPRegs.erase(Reg);
+    } else if (MO.isReg() && MO.isDef()) {
+      Defs.push_back(MO.getReg());
+    }
+  }
+  // A read-modify-write instruction writes the register it addresses.
+  if (MI.mayStore() &&
+      (MI.getDesc().TSFlags & M6502II::FormMask) == M6502II::FrmZP &&
+      MI.getOperand(0).isReg())
+    Defs.push_back(MI.getOperand(0).getReg());
+
+  unsigned Result = 0, NumResults = 0;
+  for (unsigned I = 0, E = Defs.size(); I != E; ++I) {
+    unsigned Reg = Defs[I];
+    if (std::find(Defs.begin(), Defs.begin() + I, Reg) != Defs.begin() + I)
+      continue;
+
+    if (Reg == M6502::A || Reg == M6502::X || Reg == M6502::Y) {
+      Result = getNewValue();
+      State.Locs[Reg == M6502::A ? LocA : Reg == M6502::X ? LocX : LocY] =
+          Result;
+      ++NumResults;
+    } else if (isZPReg(Reg)) {
+      for (MCRegAliasIterator AI(Reg, TRI, true); AI.isValid(); ++AI)
+        State.ZPRegs.erase(*AI);
+      Result = getNewValue();
+      if (M6502::ZP8RegClass.contains(Reg))
+        State.ZPRegs[Reg] = Result;
+      else
+        ++NumResults;
+      ++NumResults;
+    }
+  }
+
+  if (M6502II::getAccWidth(MI.getDesc().TSFlags) == M6502II::Acc16)
+    NumResults = 0;
+
+  unsigned Flags = M6502II::getFlagsDefined(MI.getDesc().TSFlags);
+  for (unsigned Loc = LocN; Loc != NumLocations; ++Loc) {
+    if (!(Flags & (1u << (Loc - LocN))))
+      continue;
+    if ((Loc == LocN || Loc == LocZ) && NumResults == 1)
+      State.Locs[Loc] = Result;
+    else
+      State.Locs[Loc] = getNewValue();
+  }
+}
+
+/// Return the immediate form of the zero page instruction Opc, or 0 if it
+/// has none.
+static unsigned getImmOpcode(unsigned Opc) {
+  switch (Opc) {
+  case M6502::LDAzp: return M6502::LDAimm;
+  case M6502::LDXzp: return M6502::LDXimm;
+  case M6502::LDYzp: return M6502::LDYimm;
+  case M6502::ADCzp: return M6502::ADCimm;
+  case M6502::SBCzp: return M6502::SBCimm;
+  case M6502::ANDzp: return M6502::ANDimm;
+  case M6502::ORAzp: return M6502::ORAimm;
+  case M6502::EORzp: return M6502::EORimm;
+  case M6502::CMPzp: return M6502::CMPimm;
+  case M6502::CPXzp: return M6502::CPXimm;
+  case M6502::CPYzp: return M6502::CPYimm;
+  default: return 0;
+  }
+}
+
+/// Replace the zero page register operand of MI by an immediate when the
+/// register holds a known constant, which saves a cycle and often leaves the
+/// store of the constant to the register dead.
+MachineInstr *M6502Peephole::foldConstant(MachineInstr &MI,
+                                          const ValueState &State) {
+  unsigned NewOpc = getImmOpcode(MI.getOpcode());
+  if (!NewOpc || !MI.getOperand(0).isReg())
+    return nullptr;
+
+  auto Value = State.ZPRegs.find(MI.getOperand(0).getReg());
+  if (Value == State.ZPRegs.end())
+    return nullptr;
+  auto Const = ValueConsts.find(Value->second);
+  if (Const == ValueConsts.end())
+    return nullptr;
+
+  DEBUG(dbgs() << "Folding a constant into: " << MI);
+  MachineInstr *NewMI =
+      BuildMI(*MI.getParent(), MI, MI.getDebugLoc(), TII->get(NewOpc))
+          .addImm(Const->second);
+  MI.eraseFromParent();
+  ++NumConstantsFolded;
+  return NewMI;
+}
+
+/// Replace the load MI of Value by a transfer from a CPU register holding
+/// it, which is shorter and, for a zero page register, faster.
+bool M6502Peephole::replaceByTransfer(MachineInstr &MI,
+                                      const ValueState &State,
+                                      unsigned Value) {
+  unsigned NewOpc = 0;
+  switch (MI.getOpcode()) {
+  case M6502::LDAimm:
+  case M6502::LDAzp:
+    if (State.Locs[LocX] == Value)
+      NewOpc = M6502::TXA;
+    else if (State.Locs[LocY] == Value)
+      NewOpc = M6502::TYA;
+    break;
+  case M6502::LDXimm:
+  case M6502::LDXzp:
+    if (State.Locs[LocA] == Value)
+      NewOpc = M6502::TAX;
+    break;
+  case M6502::LDYimm:
+  case M6502::LDYzp:
+    if (State.Locs[LocA] == Value)
+      NewOpc = M6502::TAY;
+    break;
+  }
+  if (!NewOpc)
+    return false;
+
+  DEBUG(dbgs() << "Replacing by a transfer: " << MI);
+  BuildMI(*MI.getParent(), MI, MI.getDebugLoc(), TII->get(NewOpc));
+  MI.eraseFromParent();
+  ++NumTransfers;
+  return true;
+}
+
+/// Replace the load MI from a zero page register by a compare of the CPU
+/// register it loads with zero, which sets N and Z the same.
+bool M6502Peephole::replaceByCompare(MachineInstr &MI) {
+  unsigned NewOpc;
+  switch (MI.getOpcode()) {
+  case M6502::LDAzp:
+    NewOpc = M6502::CMPimm;
+    break;
+  case M6502::LDXzp:
+    NewOpc = M6502::CPXimm;
+    break;
+  case M6502::LDYzp:
+    NewOpc = M6502::CPYimm;
+    break;
+  default:
+    return false;
+  }
+
+  DEBUG(dbgs() << "Replacing by a compare: " << MI);
+  BuildMI(*MI.getParent(), MI, MI.getDebugLoc(), TII->get(NewOpc)).addImm(0);
+  MI.eraseFromParent();
+  ++NumLoadCompares;
+  return true;
+}
+
+/// Return the STZ with the addressing mode of the store Opc, or 0 if there
+/// is none.
+static unsigned getStoreZeroOpcode(unsigned Opc) {
+  switch (Opc) {
+  case M6502::STAzp:
+  case M6502::STXzp:
+  case M6502::STYzp: return M6502::STZzp;
+  case M6502::STAabs:
+  case M6502::STXabs:
+  case M6502::STYabs: return M6502::STZabs;
+  case M6502::STAzpx:
+  case M6502::STYzpx: return M6502::STZzpx;
+  case M6502::STAabsx: return M6502::STZabsx;
+  default: return 0;
+  }
+}
+
+/// Replace the store MI of a CPU register holding zero by an STZ, which
+/// often leaves the load of zero into the register dead.
+MachineInstr *M6502Peephole::useStoreZero(MachineInstr &MI,
+                                          const ValueState &State) {
+  unsigned Opc = MI.getOpcode();
+  unsigned NewOpc = getStoreZeroOpcode(Opc);
+  if (!NewOpc)
+    return nullptr;
+
+  unsigned Loc = (Opc == M6502::STXzp || Opc == M6502::STXabs) ? LocX
+                 : (Opc == M6502::STYzp || Opc == M6502::STYabs ||
+                    Opc == M6502::STYzpx) ? LocY : LocA;
+  if (State.Locs[Loc] != getConstValue(0))
+    return nullptr;
+
+  // The register stored is no longer read, but the zero page register
+  // written still is.
+  DEBUG(dbgs() << "Storing zero with STZ: " << MI);
+  MachineInstrBuilder MIB =
+      BuildMI(*MI.getParent(), MI, MI.getDebugLoc(), TII->get(NewOpc))
+          .add(MI.getOperand(0));
+  for (const MachineOperand &MO : MI.implicit_operands())
+    if (MO.isReg() && MO.isDef())
+      MIB.add(MO);
+  MIB.setMemRefs(MI.memoperands_begin(), MI.memoperands_end());
+  MI.eraseFromParent();
+  ++NumStoresOfZero;
+  return MIB;
+}
+
+/// Replace an ADC or SBC of an immediate by INC A or DEC A when, with the
+/// carry it is known to get, it adds one to A or subtracts one, and neither
+/// C nor V is read afterwards.  The CLC or SEC before it then often becomes
+/// dead.
+MachineInstr *M6502Peephole::useIncDecAcc(MachineInstr &MI,
+                                          const ValueState &State,
+                                          unsigned LiveLocs) {
+  unsigned Opc = MI.getOpcode();
+  if ((Opc != M6502::ADCimm && Opc != M6502::SBCimm) ||
+      !MI.getOperand(0).isImm() ||
+      (LiveLocs & ((1u << LocC) | (1u << LocV))))
+    return nullptr;
+
+  unsigned Carry;
+  if (State.Locs[LocC] == getConstValue(0))
+    Carry = 0;
+  else if (State.Locs[LocC] == getConstValue(1))
+    Carry = 1;
+  else
+    return nullptr;
+
+  // ADC adds the operand and the carry, SBC subtracts the operand and the
+  // borrow, which is the inverted carry.
+  uint64_t Imm = MI.getOperand(0).getImm() & 0xff;
+  uint64_t Delta = Opc == M6502::ADCimm ? Imm + Carry : 0 - (Imm + 1 - Carry);
+  unsigned NewOpc;
+  if ((Delta & 0xff) == 1)
+    NewOpc = M6502::INCacc;
+  else if ((Delta & 0xff) == 0xff)
+    NewOpc = M6502::DECacc;
+  else
+    return nullptr;
+
+  DEBUG(dbgs() << "Replacing by INC A or DEC A: " << MI);
+  MachineInstr *NewMI =
+      BuildMI(*MI.getParent(), MI, MI.getDebugLoc(), TII->get(NewOpc));
+  MI.eraseFromParent();
+  ++NumIncDecAcc;
+  return NewMI;
+}
+
+/// Replace an INC or DEC of a zero page register whose value A holds by INC A
+/// or DEC A and a store of A, when A is not read afterwards and the store is
+/// dead or the next instruction loads the result back into A.  The store is
+/// returned to be numbered with the new value of A, so that the load is
+/// deleted as redundant, and the store itself once the load is gone.
+MachineInstr *M6502Peephole::useIncDecAccForZP(MachineInstr &MI,
+                                               ValueState &State,
+                                               unsigned LiveLocs,
+                                               bool StoreDead,
+                                               const MachineInstr *Next) {
+  unsigned Opc = MI.getOpcode();
+  if ((Opc != M6502::INCzp && Opc != M6502::DECzp) ||
+      !MI.getOperand(0).isReg() || (LiveLocs & (1u << LocA)))
+    return nullptr;
+
+  unsigned Reg = MI.getOperand(0).getReg();
+  auto It = State.ZPRegs.find(Reg);
+  if (!M6502::ZP8RegClass.contains(Reg) || It == State.ZPRegs.end() ||
+      It->second != State.Locs[LocA])
+    return nullptr;
+
+  if (!StoreDead &&
+      !(Next && Next->getOpcode() == M6502::LDAzp &&
+        Next->getOperand(0).isReg() && Next->getOperand(0).getReg() == Reg))
+    return nullptr;
+
+  DEBUG(dbgs() << "Replacing by INC A or DEC A and a store: " << MI);
+  MachineBasicBlock &MBB = *MI.getParent();
+  const DebugLoc &DL = MI.getDebugLoc();
+  BuildMI(MBB, MI, DL,
+          TII->get(Opc == M6502::INCzp ? M6502::INCacc : M6502::DECacc));
+  MachineInstr *Store = BuildMI(MBB, MI, DL, TII->get(M6502::STAzp))
+                            .addReg(Reg, RegState::Undef)
+                            .addReg(Reg, RegState::ImplicitDefine);
+  MI.eraseFromParent();
+  ++NumIncDecAcc;
+
+  // N and Z are set from the new value of A, as they were from Reg.
+  unsigned Value = getNewValue();
+  State.Locs[LocA] = State.Locs[LocN] = State.Locs[LocZ] = Value;
+  return Store;
+}
+
+/// Return true if the address operands of two loads or stores are the same
+/// byte.
+static bool isSameAddr(const MachineOperand &A, const MachineOperand &B) {
+  if (A.isReg() || B.isReg())
+    return A.isReg() && B.isReg() && A.getReg() == B.getReg();
+  return A.isIdenticalTo(B);
+}
+
+/// Turn "lda m ; ora #k ; sta m" into "lda #k ; tsb m", and the same with
+/// AND into TRB, when A, N and Z are not read afterwards.  When m is in the
+/// zero page and k sets or clears a single bit, SMB or RMB does it alone.
+/// Accesses to memory which may be volatile are left alone.
+bool M6502Peephole::useBitOps(MachineBasicBlock &MBB) {
+  SmallVector<MachineInstr *, 32> Instrs;
+  SmallVector<unsigned, 32> LiveLocs;
+  unsigned Locs = getLiveOuts(MBB);
+  for (MachineInstr &MI : reverse(MBB)) {
+    if (MI.isDebugValue())
+      continue;
+    Instrs.push_back(&MI);
+    LiveLocs.push_back(Locs);
+    Locs = (Locs & ~getDefinedLocations(MI)) | getUsedLocations(MI);
+  }
+
+  const unsigned ResultLocs = (1u << LocA) | (1u << LocN) | (1u << LocZ);
+  bool Changed = false;
+  for (unsigned I = Instrs.size(); I > 2; --I) {
+    MachineInstr &Load = *Instrs[I - 1];
+    MachineInstr &Op = *Instrs[I - 2];
+    MachineInstr &Store = *Instrs[I - 3];
+    bool IsZP = Load.getOpcode() == M6502::LDAzp;
+    if ((!IsZP && Load.getOpcode() != M6502::LDAabs) ||
+        (Op.getOpcode() != M6502::ORAimm && Op.getOpcode() != M6502::ANDimm) ||
+        Store.getOpcode() != (IsZP ? M6502::STAzp : M6502::STAabs) ||
+        !Op.getOperand(0).isImm() || (LiveLocs[I - 3] & ResultLocs))
+      continue;
+
+    const MachineOperand &Addr = Load.getOperand(0);
+    if (!isSameAddr(Addr, Store.getOperand(0)) ||
+        (!Addr.isReg() &&
+         (Load.hasOrderedMemoryRef() || Store.hasOrderedMemoryRef())))
+      continue;
+
+    bool Set = Op.getOpcode() == M6502::ORAimm;
+    uint64_t Mask = Op.getOperand(0).getImm() & 0xff;
+    if (!Set)
+      Mask = ~Mask & 0xff;
+
+    DEBUG(dbgs() << "Updating bits in place: " << Load);
+    DebugLoc DL = Load.getDebugLoc();
+    MachineInstrBuilder MIB;
+    if (IsZP && HasBitOps && isPowerOf2_64(Mask)) {
+      static const unsigned SMB[] = {M6502::SMB0, M6502::SMB1, M6502::SMB2,
+                                     M6502::SMB3, M6502::SMB4, M6502::SMB5,
+                                     M6502::SMB6, M6502::SMB7};
+      static const unsigned RMB[] = {M6502::RMB0, M6502::RMB1, M6502::RMB2,
+                                     M6502::RMB3, M6502::RMB4, M6502::RMB5,
+                                     M6502::RMB6, M6502::RMB7};
+      unsigned Bit = Log2_64(Mask);
+      MIB = BuildMI(MBB, Load, DL, TII->get(Set ? SMB[Bit] : RMB[Bit]));
+    } else {
+      BuildMI(MBB, Load, DL, TII->get(M6502::LDAimm)).addImm(Mask);
+      unsigned Opc = Set ? (IsZP ? M6502::TSBzp : M6502::TSBabs)
+                         : (IsZP ? M6502::TRBzp : M6502::TRBabs);
+      MIB = BuildMI(MBB, Load, DL, TII->get(Opc));
+    }
+    if (Addr.isReg())
+      MIB.addReg(Addr.getReg()).addReg(Addr.getReg(), RegState::ImplicitDefine);
+    else
+      MIB.add(Addr).setMemRefs(Store.memoperands_begin(),
+                               Store.memoperands_end());
+
+    Load.eraseFromParent();
+    Op.eraseFromParent();
+    Store.eraseFromParent();
+    ++NumBitOps;
+    Changed = true;
+    I -= 2;
+  }
+  return Changed;
+}
+
+/// Clear the kill flags of Reg, which is now live for longer.
+void M6502Peephole::clearKills(MachineFunction &MF, unsigned Reg) {
+  for (MachineBasicBlock &MBB : MF)
+    for (MachineInstr &MI : MBB)
+      for (MCRegAliasIterator AI(Reg, TRI, true); AI.isValid(); ++AI)
+        MI.clearRegisterKills(*AI, TRI);
+}
+
+bool M6502Peephole::optimizeBlock(MachineBasicBlock &MBB, ValueState &State) {
+  // Find what is live after each instruction first.  Deleting instructions
+  // only ever makes fewer locations live.
+  SmallVector<MachineInstr *, 32> Instrs;
+  SmallVector<unsigned, 32> LiveLocs;
+  SmallVector<bool, 32> DeadStores;
+  LivePhysRegs LiveRegs(*TRI);
+  LiveRegs.addLiveOuts(MBB);
+  unsigned Locs = getLiveOuts(MBB);
+  for (MachineInstr &MI : reverse(MBB)) {
+    if (MI.isDebugValue())
+      continue;
+    bool Dead = false;
+    if (MI.mayStore() && MI.getNumOperands() && MI.getOperand(0).isReg()) {
+      unsigned Reg = MI.getOperand(0).getReg();
+      Dead = !LiveRegs.contains(Reg) && !MRI->isReserved(Reg);
+    }
+    Instrs.push_back(&MI);
+    LiveLocs.push_back(Locs);
+    DeadStores.push_back(Dead);
+    Locs = (Locs & ~getDefinedLocations(MI)) | getUsedLocations(MI);
+    LiveRegs.stepBackward(MI);
+  }
+
+  bool Changed = false;
+  SmallVector<Effect, 4> Effects;
+  for (unsigned I = Instrs.size(); I-- != 0;) {
+    MachineInstr *NewMI = foldConstant(*Instrs[I], State);
+    if (!NewMI && HasCMOS)
+      NewMI = useStoreZero(*Instrs[I], State);
+    if (!NewMI && HasCMOS)
+      NewMI = useIncDecAcc(*Instrs[I], State, LiveLocs[I]);
+    if (!NewMI && HasCMOS)
+      NewMI = useIncDecAccForZP(*Instrs[I], State, LiveLocs[I], DeadStores[I],
+                                I ? Instrs[I - 1] : nullptr);
+    MachineInstr &MI = NewMI ? *NewMI : *Instrs[I];
+    Changed |= NewMI != nullptr;
+    Effects.clear();
+    if (!getEffects(MI, State, Effects)) {
+      clobber(MI, State);
+      continue;
+    }
+
+    bool Redundant = true;
+    unsigned StoredReg = 0;
+    for (const Effect &E : Effects) {
+      if (E.Loc == NumLocations) {
+        auto It = State.ZPRegs.find(E.Reg);
+        if (It != State.ZPRegs.end() && It->second == E.Value)
+          StoredReg = E.Reg;
+        else if (!DeadStores[I])
+          Redundant = false;
+      } else if (State.Locs[E.Loc] != E.Value &&
+                 (LiveLocs[I] & (1u << E.Loc))) {
+        Redundant = false;
+      }
+    }
+
+    if (Redundant) {
+      DEBUG(dbgs() << "Deleting redundant: " << MI);
+      if (MI.mayStore())
+        ++NumStoresDeleted;
+      else if (MI.getOpcode() == M6502::CLC || MI.getOpcode() == M6502::SEC)
+        ++NumCarryOpsDeleted;
+      else if (Effects.back().Loc == LocC)
+        ++NumComparesDeleted;
+      else
+        ++NumLoadsDeleted;
+      if (StoredReg)
+        clearKills(*MBB.getParent(), StoredReg);
+      MI.eraseFromParent();
+      Changed = true;
+      continue;
+    }
+
+    // A load of the value its register holds which sets N and Z for a
+    // branch does so faster as a compare with zero, if the carry is dead.
+    bool Compare = Effects[0].Loc < LocN &&
+                   State.Locs[Effects[0].Loc] == Effects[0].Value &&
+                   !(LiveLocs[I] & (1u << LocC)) && replaceByCompare(MI);
+
+    for (const Effect &E : Effects) {
+      if (E.Loc == NumLocations)
+        State.ZPRegs[E.Reg] = E.Value;
+      else
+        State.Locs[E.Loc] = E.Value;
+    }
+    if (Compare) {
+      State.Locs[LocC] = getConstValue(1);
+      Changed = true;
+      continue;
+    }
+    if (Effects.back().Loc == LocZ &&
+        replaceByTransfer(MI, State, Effects[0].Value))
+      Changed = true;
+  }
+  return Changed;
+}
+
+bool M6502Peephole::runOnMachineFunction(MachineFunction &MF) {
+  if (!EnablePeephole || skipFunction(*MF.getFunction()))
+    return false;
+
+  TII = static_cast<const M6502InstrInfo *>(
+      MF.getSubtarget<M6502Subtarget>().getInstrInfo());
+  TRI = MF.getSubtarget().getRegisterInfo();
+  MRI = &MF.getRegInfo();
+  HasCMOS = MF.getSubtarget<M6502Subtarget>().hasCMOS();
+  HasBitOps = MF.getSubtarget<M6502Subtarget>().hasBitOps();
+  NextValue = 1;
+  ConstValues.clear();
+  ValueConsts.clear();
+  CompareValues.clear();
+
+  // Deleting an instruction may make the ones which fed it dead, so repeat
+  // until nothing changes.
+  bool Changed = false, Again;
+  do {
+    Again = false;
+    computeLiveIns(MF);
+    ExitStates.assign(MF.getNumBlockIDs(), ValueState());
+    Visited.clear();
+    Visited.resize(MF.getNumBlockIDs());
+
+    for (MachineBasicBlock &MBB : MF) {
+      ValueState &State = ExitStates[MBB.getNumber()];
+      getEntryState(MBB, State);
+      Again |= optimizeBlock(MBB, State);
+      Visited.set(MBB.getNumber());
+    }
+    if (Again)
+      updateZPLiveIns(MF);
+    Changed |= Again;
+  } while (Again);
+
+  // The read-modify-writes of the 65C02 replace the loads and stores they
+  // are made of, which the value numbering no longer needs to see.
+  if (HasCMOS)
+    for (MachineBasicBlock &MBB : MF)
+      Changed |= useBitOps(MBB);
+
+  return Changed;
+}
+
+/// createM6502PeepholePass - Returns a pass that deletes redundant loads,
+/// compares and flag changes after the pseudo instructions are expanded.
+FunctionPass *llvm::createM6502PeepholePass() { return new M6502Peephole(); }
@@ -1,4 +1,4 @@
-//===- M6502RegisterInfo.cpp - M6502 Register Information -------------------===//
+//===- M6502RegisterInfo.cpp - M6502 Register Information -----------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -40,49 +40,32 @@ using namespace llvm;
 #define GET_REGINFO_TARGET_DESC
 #include "M6502GenRegisterInfo.inc"
 
-M6502RegisterInfo::M6502RegisterInfo() : M6502GenRegisterInfo(M6502::RA) {}
+M6502RegisterInfo::M6502RegisterInfo() : M6502GenRegisterInfo(M6502::S) {}
 
-unsigned M6502RegisterInfo::getPICCallReg() { return M6502::T9; }
+// The option lives with the MC layer, which lays out the zero page of an
+// image around the register bank.
+unsigned M6502RegisterInfo::getNumZPRegs() { return getM6502NumZPRegs(); }
 
 const TargetRegisterClass *
 M6502RegisterInfo::getPointerRegClass(const MachineFunction &MF,
                                      unsigned Kind) const {
-  M6502ABIInfo ABI = MF.getSubtarget<M6502Subtarget>().getABI();
-  M6502PtrClass PtrClassKind = static_cast<M6502PtrClass>(Kind);
-
-  switch (PtrClassKind) {
-  case M6502PtrClass::Default:
-    return ABI.ArePtrs64bit() ? &M6502::GPR64RegClass : &M6502::GPR32RegClass;
-  case M6502PtrClass::GPR16MM:
-    return ABI.ArePtrs64bit() ? &M6502::GPRMM16_64RegClass
-                              : &M6502::GPRMM16RegClass;
-  case M6502PtrClass::StackPointer:
-    return ABI.ArePtrs64bit() ? &M6502::SP64RegClass : &M6502::SP32RegClass;
-  case M6502PtrClass::GlobalPointer:
-    return ABI.ArePtrs64bit() ? &M6502::GP64RegClass : &M6502::GP32RegClass;
-  }
-
-  llvm_unreachable("Unknown pointer kind");
+  return &M6502::ZP16RegClass;
 }
 
 unsigned
 M6502RegisterInfo::getRegPressureLimit(const TargetRegisterClass *RC,
                                       MachineFunction &MF) const {
+  const TargetFrameLowering *TFI = MF.getSubtarget().getFrameLowering();
+  // RS0-RS3 hold the stack and scratch pointers.
+  unsigned Bytes = getNumZPRegs() - 4 - (TFI->hasFP(MF) ? 2 : 0);
+
   switch (RC->getID()) {
   default:
     return 0;
-  case M6502::GPR32RegClassID:
-  case M6502::GPR64RegClassID:
-  case M6502::DSPRRegClassID: {
-    const TargetFrameLowering *TFI = MF.getSubtarget().getFrameLowering();
-    return 28 - TFI->hasFP(MF);
-  }
-  case M6502::FGR32RegClassID:
-    return 32;
-  case M6502::AFGR64RegClassID:
-    return 16;
-  case M6502::FGR64RegClassID:
-    return 32;
+  case M6502::ZP8RegClassID:
+    return Bytes;
+  case M6502::ZP16RegClassID:
+    return Bytes / 2;
   }
 }
 
@@ -93,173 +76,72 @@ M6502RegisterInfo::getRegPressureLimit(const TargetRegisterClass *RC,
 /// M6502 Callee Saved Registers
 const MCPhysReg *
 M6502RegisterInfo::getCalleeSavedRegs(const MachineFunction *MF) const {
-  const M6502Subtarget &Subtarget = MF->getSubtarget<M6502Subtarget>();
-  const Function *F = MF->getFunction();
-  if (F->hasFnAttribute("interrupt")) {
-    if (Subtarget.hasM650264())
-      return Subtarget.hasM650264r6() ? CSR_Interrupt_64R6_SaveList
-                                     : CSR_Interrupt_64_SaveList;
-    else
-      return Subtarget.hasM650232r6() ? CSR_Interrupt_32R6_SaveList
-                                     : CSR_Interrupt_32_SaveList;
-  }
-
-  if (Subtarget.isSingleFloat())
-    return CSR_SingleFloatOnly_SaveList;
-
-  if (Subtarget.isABI_N64())
-    return CSR_N64_SaveList;
-
-  if (Subtarget.isABI_N32())
-    return CSR_N32_SaveList;
-
-  if (Subtarget.isFP64bit())
-    return CSR_O32_FP64_SaveList;
-
-  if (Subtarget.isFPXX())
-    return CSR_O32_FPXX_SaveList;
-
-  return CSR_O32_SaveList;
+  if (MF->getFunction()->hasFnAttribute("interrupt"))
+    return CSR_M6502_Interrupt_SaveList;
+  return CSR_M6502_SaveList;
 }
 
 const uint32_t *
 M6502RegisterInfo::getCallPreservedMask(const MachineFunction &MF,
                                        CallingConv::ID) const {
-  const M6502Subtarget &Subtarget = MF.getSubtarget<M6502Subtarget>();
-  if (Subtarget.isSingleFloat())
-    return CSR_SingleFloatOnly_RegMask;
-
-  if (Subtarget.isABI_N64())
-    return CSR_N64_RegMask;
-
-  if (Subtarget.isABI_N32())
-    return CSR_N32_RegMask;
-
-  if (Subtarget.isFP64bit())
-    return CSR_O32_FP64_RegMask;
-
-  if (Subtarget.isFPXX())
-    return CSR_O32_FPXX_RegMask;
-
-  return CSR_O32_RegMask;
+  return CSR_M6502_RegMask;
 }
 
-const uint32_t *M6502RegisterInfo::getM650216RetHelperMask() {
-  return CSR_M650216RetHelper_RegMask;
+/// After the target independent hints, offer the registers the calls of the
+/// function clobber anyway, so that it changes as few others as it can.
+/// See M6502ZPColoring.cpp.
+void M6502RegisterInfo::getRegAllocationHints(
+    unsigned VirtReg, ArrayRef<MCPhysReg> Order,
+    SmallVectorImpl<MCPhysReg> &Hints, const MachineFunction &MF,
+    const VirtRegMap *VRM, const LiveRegMatrix *Matrix) const {
+  TargetRegisterInfo::getRegAllocationHints(VirtReg, Order, Hints, MF, VRM,
+                                            Matrix);
+
+  ArrayRef<MCPhysReg> Clobbered =
+      MF.getInfo<M6502FunctionInfo>()->getCallClobberedRegs();
+  for (MCPhysReg Reg : Order)
+    if (is_contained(Clobbered, Reg) && !is_contained(Hints, Reg))
+      Hints.push_back(Reg);
 }
 
 BitVector M6502RegisterInfo::
 getReservedRegs(const MachineFunction &MF) const {
-  static const MCPhysReg ReservedGPR32[] = {
-    M6502::ZERO, M6502::K0, M6502::K1, M6502::SP
-  };
-
-  static const MCPhysReg ReservedGPR64[] = {
-    M6502::ZERO_64, M6502::K0_64, M6502::K1_64, M6502::SP_64
+  static const MCPhysReg ReservedCPURegs[] = {
+    M6502::A, M6502::X, M6502::Y, M6502::P, M6502::S
   };
 
   BitVector Reserved(getNumRegs());
   const M6502Subtarget &Subtarget = MF.getSubtarget<M6502Subtarget>();
+  const M6502ABIInfo &ABI = Subtarget.getABI();
 
-  using RegIter = TargetRegisterClass::const_iterator;
-
-  for (unsigned I = 0; I < array_lengthof(ReservedGPR32); ++I)
-    Reserved.set(ReservedGPR32[I]);
-
-  // Reserve registers for the NaCl sandbox.
-  if (Subtarget.isTargetNaCl()) {
-    Reserved.set(M6502::T6);   // Reserved for control flow mask.
-    Reserved.set(M6502::T7);   // Reserved for memory access mask.
-    Reserved.set(M6502::T8);   // Reserved for thread pointer.
-  }
-
-  for (unsigned I = 0; I < array_lengthof(ReservedGPR64); ++I)
-    Reserved.set(ReservedGPR64[I]);
+  // The CPU registers are only used inside pseudo instruction expansions.
+  for (unsigned I = 0; I < array_lengthof(ReservedCPURegs); ++I)
+    Reserved.set(ReservedCPURegs[I]);
 
-  // For mno-abicalls, GP is a program invariant!
-  if (!Subtarget.isABICalls()) {
-    Reserved.set(M6502::GP);
-    Reserved.set(M6502::GP_64);
-  }
+  // Reserve the stack pointer and the scratch pointer.
+  for (unsigned Reg : {ABI.GetStackPtr(), ABI.GetScratchPtr()})
+    for (MCRegAliasIterator AI(Reg, this, true); AI.isValid(); ++AI)
+      Reserved.set(*AI);
 
-  if (Subtarget.isFP64bit()) {
-    // Reserve all registers in AFGR64.
-    for (RegIter Reg = M6502::AFGR64RegClass.begin(),
-         EReg = M6502::AFGR64RegClass.end(); Reg != EReg; ++Reg)
-      Reserved.set(*Reg);
-  } else {
-    // Reserve all registers in FGR64.
-    for (RegIter Reg = M6502::FGR64RegClass.begin(),
-         EReg = M6502::FGR64RegClass.end(); Reg != EReg; ++Reg)
-      Reserved.set(*Reg);
-  }
   // Reserve FP if this function should have a dedicated frame pointer register.
-  if (Subtarget.getFrameLowering()->hasFP(MF)) {
-    if (Subtarget.inM650216Mode())
-      Reserved.set(M6502::S0);
-    else {
-      Reserved.set(M6502::FP);
-      Reserved.set(M6502::FP_64);
-
-      // Reserve the base register if we need to both realign the stack and
-      // allocate variable-sized objects at runtime. This should test the
-      // same conditions as M6502FrameLowering::hasBP().
-      if (needsStackRealignment(MF) &&
-          MF.getFrameInfo().hasVarSizedObjects()) {
-        Reserved.set(M6502::S7);
-        Reserved.set(M6502::S7_64);
-      }
-    }
-  }
-
-  // Reserve hardware registers.
-  Reserved.set(M6502::HWR29);
-
-  // Reserve DSP control register.
-  Reserved.set(M6502::DSPPos);
-  Reserved.set(M6502::DSPSCount);
-  Reserved.set(M6502::DSPCarry);
-  Reserved.set(M6502::DSPEFI);
-  Reserved.set(M6502::DSPOutFlag);
-
-  // Reserve MSA control registers.
-  Reserved.set(M6502::MSAIR);
-  Reserved.set(M6502::MSACSR);
-  Reserved.set(M6502::MSAAccess);
-  Reserved.set(M6502::MSASave);
-  Reserved.set(M6502::MSAModify);
-  Reserved.set(M6502::MSARequest);
-  Reserved.set(M6502::MSAMap);
-  Reserved.set(M6502::MSAUnmap);
-
-  // Reserve RA if in m650216 mode.
-  if (Subtarget.inM650216Mode()) {
-    const M6502FunctionInfo *M6502FI = MF.getInfo<M6502FunctionInfo>();
-    Reserved.set(M6502::RA);
-    Reserved.set(M6502::RA_64);
-    Reserved.set(M6502::T0);
-    Reserved.set(M6502::T1);
-    if (MF.getFunction()->hasFnAttribute("saveS2") || M6502FI->hasSaveS2())
-      Reserved.set(M6502::S2);
-  }
-
-  // Reserve GP if small section is used.
-  if (Subtarget.useSmallSection()) {
-    Reserved.set(M6502::GP);
-    Reserved.set(M6502::GP_64);
-  }
-
-  if (Subtarget.isABI_O32() && !Subtarget.useOddSPReg()) {
-    for (const auto &Reg : M6502::OddSPRegClass)
-      Reserved.set(Reg);
-  }
+  if (Subtarget.getFrameLowering()->hasFP(MF))
+    for (MCRegAliasIterator AI(ABI.GetFramePtr(), this, true); AI.isValid();
+         ++AI)
+      Reserved.set(*AI);
+
+  // Reserve the part of the register bank the user kept for itself.
+  // The encoding of a zero page register is its offset in the bank.
+  for (unsigned Reg : M6502::ZP8RegClass)
+    if (getEncodingValue(Reg) >= getNumZPRegs())
+      for (MCRegAliasIterator AI(Reg, this, true); AI.isValid(); ++AI)
+        Reserved.set(*AI);
 
   return Reserved;
 }
 
 bool
 M6502RegisterInfo::requiresRegisterScavenging(const MachineFunction &MF) const {
-  return true;
+  return false;
 }
 
 bool
@@ -296,46 +178,13 @@ unsigned M6502RegisterInfo::
 getFrameRegister(const MachineFunction &MF) const {
   const M6502Subtarget &Subtarget = MF.getSubtarget<M6502Subtarget>();
   const TargetFrameLowering *TFI = Subtarget.getFrameLowering();
-  bool IsN64 =
-      static_cast<const M6502TargetMachine &>(MF.getTarget()).getABI().IsN64();
+  const M6502ABIInfo &ABI = Subtarget.getABI();
 
-  if (Subtarget.inM650216Mode())
-    return TFI->hasFP(MF) ? M6502::S0 : M6502::SP;
-  else
-    return TFI->hasFP(MF) ? (IsN64 ? M6502::FP_64 : M6502::FP) :
-                            (IsN64 ? M6502::SP_64 : M6502::SP);
+  return TFI->hasFP(MF) ? ABI.GetFramePtr() : ABI.GetStackPtr();
 }
 
 bool M6502RegisterInfo::canRealignStack(const MachineFunction &MF) const {
-  // Avoid realigning functions that explicitly do not want to be realigned.
-  // Normally, we should report an error when a function should be dynamically
-  // realigned but also has the attribute no-realign-stack. Unfortunately,
-  // with this attribute, MachineFrameInfo clamps each new object's alignment
-  // to that of the stack's alignment as specified by the ABI. As a result,
-  // the information of whether we have objects with larger alignment
-  // requirement than the stack's alignment is already lost at this point.
-  if (!TargetRegisterInfo::canRealignStack(MF))
-    return false;
-
-  const M6502Subtarget &Subtarget = MF.getSubtarget<M6502Subtarget>();
-  unsigned FP = Subtarget.isGP32bit() ? M6502::FP : M6502::FP_64;
-  unsigned BP = Subtarget.isGP32bit() ? M6502::S7 : M6502::S7_64;
-
-  // Support dynamic stack realignment only for targets with standard encoding.
-  if (!Subtarget.hasStandardEncoding())
-    return false;
-
-  // We can't perform dynamic stack realignment if we can't reserve the
-  // frame pointer register.
-  if (!MF.getRegInfo().canReserveReg(FP))
-    return false;
-
-  // We can realign the stack if we know the maximum call frame size and we
-  // don't have variable sized objects.
-  if (Subtarget.getFrameLowering()->hasReservedCallFrame(MF))
-    return true;
-
-  // We have to reserve the base pointer register in the presence of variable
-  // sized objects.
-  return MF.getRegInfo().canReserveReg(BP);
+  // The software stack is never realigned: nothing on the 6502 needs more
+  // than byte alignment.
+  return false;
 }
@@ -1,4 +1,4 @@
-//===- M6502RegisterInfo.h - M6502 Register Information Impl ------*- C++ -*-===//
+//===- M6502RegisterInfo.h - M6502 Register Information Impl ----*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -27,22 +27,10 @@ class TargetRegisterClass;
 
 class M6502RegisterInfo : public M6502GenRegisterInfo {
 public:
-  enum class M6502PtrClass {
-    /// The default register class for integer values.
-    Default = 0,
-    /// The subset of registers permitted in certain microM6502 instructions
-    /// such as lw16.
-    GPR16MM = 1,
-    /// The stack pointer only.
-    StackPointer = 2,
-    /// The global pointer only.
-    GlobalPointer = 3,
-  };
-
   M6502RegisterInfo();
 
-  /// Get PIC indirect call register
-  static unsigned getPICCallReg();
+  /// Number of zero page byte registers handed to the register allocator.
+  static unsigned getNumZPRegs();
 
   /// Code Generation virtual methods...
   const TargetRegisterClass *getPointerRegClass(const MachineFunction &MF,
@@ -53,10 +41,15 @@ public:
   const MCPhysReg *getCalleeSavedRegs(const MachineFunction *MF) const override;
   const uint32_t *getCallPreservedMask(const MachineFunction &MF,
                                        CallingConv::ID) const override;
-  static const uint32_t *getM650216RetHelperMask();
 
   BitVector getReservedRegs(const MachineFunction &MF) const override;
 
+  void getRegAllocationHints(unsigned VirtReg, ArrayRef<MCPhysReg> Order,
+                             SmallVectorImpl<MCPhysReg> &Hints,
+                             const MachineFunction &MF,
+                             const VirtRegMap *VRM,
+                             const LiveRegMatrix *Matrix) const override;
+
   bool requiresRegisterScavenging(const MachineFunction &MF) const override;
 
   bool trackLivenessAfterRegAlloc(const MachineFunction &MF) const override;
@@ -72,7 +65,7 @@ public:
   /// Debug information queries.
   unsigned getFrameRegister(const MachineFunction &MF) const override;
 
-  /// \brief Return GPR register class.
+  /// \brief Return the zero page register class holding values of Size bits.
   virtual const TargetRegisterClass *intRegClass(unsigned Size) const = 0;
 
 private:
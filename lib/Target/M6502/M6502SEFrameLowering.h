@@ -1,4 +1,4 @@
-//===- M6502SEFrameLowering.h - M650232/64 frame lowering ---------*- C++ -*-===//
+//===- M6502SEFrameLowering.h - M6502 frame lowering ------------*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -31,22 +31,15 @@ public:
   int getFrameIndexReference(const MachineFunction &MF, int FI,
                              unsigned &FrameReg) const override;
 
-  bool spillCalleeSavedRegisters(MachineBasicBlock &MBB,
-                                 MachineBasicBlock::iterator MI,
-                                 const std::vector<CalleeSavedInfo> &CSI,
-                                 const TargetRegisterInfo *TRI) const override;
-
   bool hasReservedCallFrame(const MachineFunction &MF) const override;
 
   void determineCalleeSaves(MachineFunction &MF, BitVector &SavedRegs,
                             RegScavenger *RS) const override;
-  unsigned ehDataReg(unsigned I) const;
 
-private:
-  void emitInterruptEpilogueStub(MachineFunction &MF,
-                                 MachineBasicBlock &MBB) const;
-  void emitInterruptPrologueStub(MachineFunction &MF,
-                                 MachineBasicBlock &MBB) const;
+  /// Move the frame to a fixed address when the function was found to be
+  /// static and nothing in its frame has to stay on the software stack.
+  void processFunctionBeforeFrameFinalized(MachineFunction &MF,
+                                           RegScavenger *RS) const override;
 };
 
 } // end namespace llvm
@@ -1,4 +1,4 @@
-//===-- M6502SEISelDAGToDAG.h - A Dag to Dag Inst Selector for M6502SE -----===//
+//===-- M6502SEISelDAGToDAG.h - A Dag to Dag Inst Selector for M6502SE ----===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -7,7 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// Subclass of M6502DAGToDAGISel specialized for m650232/64.
+// Subclass of M6502DAGToDAGISel specialized for the 6502 proper.
 //
 //===----------------------------------------------------------------------===//
 
@@ -25,119 +25,25 @@ public:
       : M6502DAGToDAGISel(TM, OL) {}
 
 private:
-
-  bool runOnMachineFunction(MachineFunction &MF) override;
-
-  void getAnalysisUsage(AnalysisUsage &AU) const override;
-
-  void addDSPCtrlRegOperands(bool IsDef, MachineInstr &MI,
-                             MachineFunction &MF);
-
-  unsigned getMSACtrlReg(const SDValue RegIdx) const;
-
-  bool replaceUsesWithZeroReg(MachineRegisterInfo *MRI, const MachineInstr&);
-
-  std::pair<SDNode *, SDNode *> selectMULT(SDNode *N, unsigned Opc,
-                                           const SDLoc &dl, EVT Ty, bool HasLo,
-                                           bool HasHi);
-
-  void selectAddE(SDNode *Node, const SDLoc &DL) const;
-
-  bool selectAddrFrameIndex(SDValue Addr, SDValue &Base, SDValue &Offset) const;
-  bool selectAddrFrameIndexOffset(SDValue Addr, SDValue &Base, SDValue &Offset,
-                                  unsigned OffsetBits,
-                                  unsigned ShiftAmount) const;
+  bool selectAddrFrameIndex(SDValue Addr, SDValue &Base,
+                            SDValue &Offset) const override;
 
   bool selectAddrRegImm(SDValue Addr, SDValue &Base,
                         SDValue &Offset) const override;
 
-  bool selectAddrDefault(SDValue Addr, SDValue &Base,
-                         SDValue &Offset) const override;
-
-  bool selectIntAddr(SDValue Addr, SDValue &Base,
-                     SDValue &Offset) const override;
-
-  bool selectAddrRegImm9(SDValue Addr, SDValue &Base,
-                         SDValue &Offset) const;
-
-  bool selectAddrRegImm11(SDValue Addr, SDValue &Base,
-                          SDValue &Offset) const;
+  bool selectAddrAbs(SDValue Addr, SDValue &Base) const override;
 
-  bool selectAddrRegImm12(SDValue Addr, SDValue &Base,
-                          SDValue &Offset) const;
+  bool selectAddrAbsIdx(SDValue Addr, SDValue &Base,
+                        SDValue &Index) const override;
 
-  bool selectAddrRegImm16(SDValue Addr, SDValue &Base,
-                          SDValue &Offset) const;
+  bool selectAddrRegIdx(SDValue Addr, SDValue &Base,
+                        SDValue &Index) const override;
 
-  bool selectIntAddr11MM(SDValue Addr, SDValue &Base,
-                         SDValue &Offset) const override;
-
-  bool selectIntAddr12MM(SDValue Addr, SDValue &Base,
-                         SDValue &Offset) const override;
-
-  bool selectIntAddr16MM(SDValue Addr, SDValue &Base,
-                         SDValue &Offset) const override;
-
-  bool selectIntAddrLSL2MM(SDValue Addr, SDValue &Base,
-                           SDValue &Offset) const override;
-
-  bool selectIntAddrSImm10(SDValue Addr, SDValue &Base,
-                           SDValue &Offset) const override;
-
-  bool selectIntAddrSImm10Lsl1(SDValue Addr, SDValue &Base,
-                               SDValue &Offset) const override;
-
-  bool selectIntAddrSImm10Lsl2(SDValue Addr, SDValue &Base,
-                               SDValue &Offset) const override;
-
-  bool selectIntAddrSImm10Lsl3(SDValue Addr, SDValue &Base,
-                               SDValue &Offset) const override;
-
-  /// \brief Select constant vector splats.
-  bool selectVSplat(SDNode *N, APInt &Imm,
-                    unsigned MinSizeInBits) const override;
-  /// \brief Select constant vector splats whose value fits in a given integer.
-  bool selectVSplatCommon(SDValue N, SDValue &Imm, bool Signed,
-                                  unsigned ImmBitSize) const;
-  /// \brief Select constant vector splats whose value fits in a uimm1.
-  bool selectVSplatUimm1(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value fits in a uimm2.
-  bool selectVSplatUimm2(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value fits in a uimm3.
-  bool selectVSplatUimm3(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value fits in a uimm4.
-  bool selectVSplatUimm4(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value fits in a uimm5.
-  bool selectVSplatUimm5(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value fits in a uimm6.
-  bool selectVSplatUimm6(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value fits in a uimm8.
-  bool selectVSplatUimm8(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value fits in a simm5.
-  bool selectVSplatSimm5(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value is a power of 2.
-  bool selectVSplatUimmPow2(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value is the inverse of a
-  /// power of 2.
-  bool selectVSplatUimmInvPow2(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value is a run of set bits
-  /// ending at the most significant bit
-  bool selectVSplatMaskL(SDValue N, SDValue &Imm) const override;
-  /// \brief Select constant vector splats whose value is a run of set bits
-  /// starting at bit zero.
-  bool selectVSplatMaskR(SDValue N, SDValue &Imm) const override;
+  /// Match a symbol or a constant address, plus Offset, as the operand of an
+  /// absolute addressing mode.
+  bool selectAbsOperand(SDValue Addr, int64_t Offset, SDValue &Base) const;
 
   bool trySelect(SDNode *Node) override;
-
-  void processFunctionAfterISel(MachineFunction &MF) override;
-
-  // Insert instructions to initialize the global base register in the
-  // first MBB of the function.
-  void initGlobalBaseReg(MachineFunction &MF);
-
-  bool SelectInlineAsmMemoryOperand(const SDValue &Op,
-                                    unsigned ConstraintID,
-                                    std::vector<SDValue> &OutOps) override;
 };
 
 FunctionPass *createM6502SEISelDag(M6502TargetMachine &TM,
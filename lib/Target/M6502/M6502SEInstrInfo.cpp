@@ -1,4 +1,4 @@
-//===-- M6502SEInstrInfo.cpp - M650232/64 Instruction Information -----------===//
+//===-- M6502SEInstrInfo.cpp - M6502 Instruction Information --------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -7,15 +7,15 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file contains the M650232/64 implementation of the TargetInstrInfo class.
+// This file contains the M6502 implementation of the TargetInstrInfo class.
 //
 //===----------------------------------------------------------------------===//
 
 #include "M6502SEInstrInfo.h"
-#include "InstPrinter/M6502InstPrinter.h"
-#include "M6502AnalyzeImmediate.h"
+#include "MCTargetDesc/M6502BaseInfo.h"
 #include "M6502MachineFunction.h"
 #include "M6502TargetMachine.h"
+#include "M6502TargetObjectFile.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
@@ -25,9 +25,43 @@
 
 using namespace llvm;
 
+/// Build a store to the zero page register Reg.  The register is an explicit
+/// address operand of the real instruction, so it is also marked as an
+/// implicit definition to keep the liveness after register allocation right.
+static void buildZPStore(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                         const DebugLoc &DL, const MCInstrDesc &MCID,
+                         unsigned Reg) {
+  BuildMI(MBB, I, DL, MCID).addReg(Reg, RegState::Undef)
+    .addReg(Reg, RegState::ImplicitDefine);
+}
+
+/// Build a read-modify-write instruction on the zero page register Reg.
+static void buildZPUpdate(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                          const DebugLoc &DL, const MCInstrDesc &MCID,
+                          unsigned Reg) {
+  BuildMI(MBB, I, DL, MCID).addReg(Reg)
+    .addReg(Reg, RegState::ImplicitDefine);
+}
+
+/// Return true if the CPU register Reg may be read at or after I before it
+/// is written again.  Pseudo instructions declare the CPU registers their
+/// expansion uses, so this only finds the incoming arguments passed in A, X
+/// and Y.
+static bool isRegReadAfter(const MachineBasicBlock &MBB,
+                           MachineBasicBlock::const_iterator I, unsigned Reg) {
+  for (MachineBasicBlock::const_iterator E = MBB.end(); I != E; ++I) {
+    if (I->readsRegister(Reg))
+      return true;
+    if (I->definesRegister(Reg))
+      return false;
+  }
+  return any_of(MBB.successors(), [Reg](const MachineBasicBlock *Succ) {
+    return Succ->isLiveIn(Reg);
+  });
+}
+
 M6502SEInstrInfo::M6502SEInstrInfo(const M6502Subtarget &STI)
-    : M6502InstrInfo(STI, STI.isPositionIndependent() ? M6502::B : M6502::J),
-      RI() {}
+    : M6502InstrInfo(STI, M6502::JMP), RI() {}
 
 const M6502RegisterInfo &M6502SEInstrInfo::getRegisterInfo() const {
   return RI;
@@ -42,8 +76,7 @@ unsigned M6502SEInstrInfo::isLoadFromStackSlot(const MachineInstr &MI,
                                               int &FrameIndex) const {
   unsigned Opc = MI.getOpcode();
 
-  if ((Opc == M6502::LW)   || (Opc == M6502::LD)   ||
-      (Opc == M6502::LWC1) || (Opc == M6502::LDC1) || (Opc == M6502::LDC164)) {
+  if ((Opc == M6502::LD8) || (Opc == M6502::LD16)) {
     if ((MI.getOperand(1).isFI()) &&  // is a stack slot
         (MI.getOperand(2).isImm()) && // the imm is zero
         (isZeroImm(MI.getOperand(2)))) {
@@ -64,8 +97,7 @@ unsigned M6502SEInstrInfo::isStoreToStackSlot(const MachineInstr &MI,
                                              int &FrameIndex) const {
   unsigned Opc = MI.getOpcode();
 
-  if ((Opc == M6502::SW)   || (Opc == M6502::SD)   ||
-      (Opc == M6502::SWC1) || (Opc == M6502::SDC1) || (Opc == M6502::SDC164)) {
+  if ((Opc == M6502::ST8) || (Opc == M6502::ST16)) {
     if ((MI.getOperand(1).isFI()) &&  // is a stack slot
         (MI.getOperand(2).isImm()) && // the imm is zero
         (isZeroImm(MI.getOperand(2)))) {
@@ -80,103 +112,99 @@ void M6502SEInstrInfo::copyPhysReg(MachineBasicBlock &MBB,
                                   MachineBasicBlock::iterator I,
                                   const DebugLoc &DL, unsigned DestReg,
                                   unsigned SrcReg, bool KillSrc) const {
-  unsigned Opc = 0, ZeroReg = 0;
-  bool isMicroM6502 = Subtarget.inMicroM6502Mode();
-
-  if (M6502::GPR32RegClass.contains(DestReg)) { // Copy to CPU Reg.
-    if (M6502::GPR32RegClass.contains(SrcReg)) {
-      if (isMicroM6502)
-        Opc = M6502::MOVE16_MM;
-      else
-        Opc = M6502::OR, ZeroReg = M6502::ZERO;
-    } else if (M6502::CCRRegClass.contains(SrcReg))
-      Opc = M6502::CFC1;
-    else if (M6502::FGR32RegClass.contains(SrcReg))
-      Opc = M6502::MFC1;
-    else if (M6502::HI32RegClass.contains(SrcReg)) {
-      Opc = isMicroM6502 ? M6502::MFHI16_MM : M6502::MFHI;
-      SrcReg = 0;
-    } else if (M6502::LO32RegClass.contains(SrcReg)) {
-      Opc = isMicroM6502 ? M6502::MFLO16_MM : M6502::MFLO;
-      SrcReg = 0;
-    } else if (M6502::HI32DSPRegClass.contains(SrcReg))
-      Opc = M6502::MFHI_DSP;
-    else if (M6502::LO32DSPRegClass.contains(SrcReg))
-      Opc = M6502::MFLO_DSP;
-    else if (M6502::DSPCCRegClass.contains(SrcReg)) {
-      BuildMI(MBB, I, DL, get(M6502::RDDSP), DestReg).addImm(1 << 4)
-        .addReg(SrcReg, RegState::Implicit | getKillRegState(KillSrc));
+  // Register pairs are copied one byte at a time, or at once through a
+  // 16-bit A on the 65816.
+  if (M6502::ZP16RegClass.contains(DestReg, SrcReg)) {
+    if (Subtarget.is65816() && !isRegReadAfter(MBB, I, M6502::A)) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzpW))
+        .addReg(SrcReg, getKillRegState(KillSrc));
+      buildZPStore(MBB, I, DL, get(M6502::STAzpW), DestReg);
       return;
     }
-    else if (M6502::MSACtrlRegClass.contains(SrcReg))
-      Opc = M6502::CFCMSA;
-  }
-  else if (M6502::GPR32RegClass.contains(SrcReg)) { // Copy from CPU Reg.
-    if (M6502::CCRRegClass.contains(DestReg))
-      Opc = M6502::CTC1;
-    else if (M6502::FGR32RegClass.contains(DestReg))
-      Opc = M6502::MTC1;
-    else if (M6502::HI32RegClass.contains(DestReg))
-      Opc = M6502::MTHI, DestReg = 0;
-    else if (M6502::LO32RegClass.contains(DestReg))
-      Opc = M6502::MTLO, DestReg = 0;
-    else if (M6502::HI32DSPRegClass.contains(DestReg))
-      Opc = M6502::MTHI_DSP;
-    else if (M6502::LO32DSPRegClass.contains(DestReg))
-      Opc = M6502::MTLO_DSP;
-    else if (M6502::DSPCCRegClass.contains(DestReg)) {
-      BuildMI(MBB, I, DL, get(M6502::WRDSP))
-        .addReg(SrcReg, getKillRegState(KillSrc)).addImm(1 << 4)
-        .addReg(DestReg, RegState::ImplicitDefine);
-      return;
-    } else if (M6502::MSACtrlRegClass.contains(DestReg)) {
-      BuildMI(MBB, I, DL, get(M6502::CTCMSA))
-          .addReg(DestReg)
+    copyPhysReg(MBB, I, DL, RI.getSubReg(DestReg, M6502::sub_lo),
+                RI.getSubReg(SrcReg, M6502::sub_lo), KillSrc);
+    copyPhysReg(MBB, I, DL, RI.getSubReg(DestReg, M6502::sub_hi),
+                RI.getSubReg(SrcReg, M6502::sub_hi), KillSrc);
+    return;
+  }
+
+  if (M6502::ZP8RegClass.contains(DestReg)) { // Copy to a zero page register.
+    unsigned Opc = 0;
+    if (M6502::ZP8RegClass.contains(SrcReg)) {
+      // The copy goes through A, unless A still holds an argument of the
+      // function.  Then it goes through a free index register, or A is saved
+      // on the hardware stack around it.
+      unsigned Via = 0;
+      for (unsigned Reg : {M6502::A, M6502::X, M6502::Y})
+        if (!isRegReadAfter(MBB, I, Reg)) {
+          Via = Reg;
+          break;
+        }
+
+      if (!Via) {
+        BuildMI(MBB, I, DL, get(M6502::PHA));
+        BuildMI(MBB, I, DL, get(M6502::LDAzp))
           .addReg(SrcReg, getKillRegState(KillSrc));
-      return;
+        buildZPStore(MBB, I, DL, get(M6502::STAzp), DestReg);
+        BuildMI(MBB, I, DL, get(M6502::PLA));
+        return;
+      }
+
+      unsigned LoadOpc = Via == M6502::X ? M6502::LDXzp
+                       : Via == M6502::Y ? M6502::LDYzp
+                                         : M6502::LDAzp;
+      BuildMI(MBB, I, DL, get(LoadOpc))
+        .addReg(SrcReg, getKillRegState(KillSrc));
+      SrcReg = Via;
+      KillSrc = true;
     }
-  }
-  else if (M6502::FGR32RegClass.contains(DestReg, SrcReg))
-    Opc = M6502::FMOV_S;
-  else if (M6502::AFGR64RegClass.contains(DestReg, SrcReg))
-    Opc = M6502::FMOV_D32;
-  else if (M6502::FGR64RegClass.contains(DestReg, SrcReg))
-    Opc = M6502::FMOV_D64;
-  else if (M6502::GPR64RegClass.contains(DestReg)) { // Copy to CPU64 Reg.
-    if (M6502::GPR64RegClass.contains(SrcReg))
-      Opc = M6502::OR64, ZeroReg = M6502::ZERO_64;
-    else if (M6502::HI64RegClass.contains(SrcReg))
-      Opc = M6502::MFHI64, SrcReg = 0;
-    else if (M6502::LO64RegClass.contains(SrcReg))
-      Opc = M6502::MFLO64, SrcReg = 0;
-    else if (M6502::FGR64RegClass.contains(SrcReg))
-      Opc = M6502::DMFC1;
-  }
-  else if (M6502::GPR64RegClass.contains(SrcReg)) { // Copy from CPU64 Reg.
-    if (M6502::HI64RegClass.contains(DestReg))
-      Opc = M6502::MTHI64, DestReg = 0;
-    else if (M6502::LO64RegClass.contains(DestReg))
-      Opc = M6502::MTLO64, DestReg = 0;
-    else if (M6502::FGR64RegClass.contains(DestReg))
-      Opc = M6502::DMTC1;
-  }
-  else if (M6502::MSA128BRegClass.contains(DestReg)) { // Copy to MSA reg
-    if (M6502::MSA128BRegClass.contains(SrcReg))
-      Opc = M6502::MOVE_V;
-  }
 
-  assert(Opc && "Cannot copy registers");
+    if (SrcReg == M6502::A)
+      Opc = M6502::STAzp;
+    else if (SrcReg == M6502::X)
+      Opc = M6502::STXzp;
+    else if (SrcReg == M6502::Y)
+      Opc = M6502::STYzp;
 
-  MachineInstrBuilder MIB = BuildMI(MBB, I, DL, get(Opc));
+    assert(Opc && "Cannot copy registers");
+    buildZPStore(MBB, I, DL, get(Opc), DestReg);
+    return;
+  }
 
-  if (DestReg)
-    MIB.addReg(DestReg, RegState::Define);
+  unsigned Opc = 0;
+  if (M6502::ZP8RegClass.contains(SrcReg)) { // Copy to a CPU register.
+    if (DestReg == M6502::A)
+      Opc = M6502::LDAzp;
+    else if (DestReg == M6502::X)
+      Opc = M6502::LDXzp;
+    else if (DestReg == M6502::Y)
+      Opc = M6502::LDYzp;
+
+    assert(Opc && "Cannot copy registers");
+    BuildMI(MBB, I, DL, get(Opc)).addReg(SrcReg, getKillRegState(KillSrc))
+      .addReg(DestReg, RegState::ImplicitDefine);
+    return;
+  }
 
-  if (SrcReg)
-    MIB.addReg(SrcReg, getKillRegState(KillSrc));
+  if (DestReg == M6502::A) {
+    if (SrcReg == M6502::X)
+      Opc = M6502::TXA;
+    else if (SrcReg == M6502::Y)
+      Opc = M6502::TYA;
+  } else if (SrcReg == M6502::A) {
+    if (DestReg == M6502::X)
+      Opc = M6502::TAX;
+    else if (DestReg == M6502::Y)
+      Opc = M6502::TAY;
+  } else if (M6502::IDXRegClass.contains(DestReg, SrcReg)) {
+    // There is no transfer between X and Y, go through A.
+    copyPhysReg(MBB, I, DL, M6502::A, SrcReg, KillSrc);
+    copyPhysReg(MBB, I, DL, DestReg, M6502::A, true);
+    return;
+  }
 
-  if (ZeroReg)
-    MIB.addReg(ZeroReg);
+  assert(Opc && "Cannot copy registers");
+  BuildMI(MBB, I, DL, get(Opc));
 }
 
 void M6502SEInstrInfo::
@@ -189,64 +217,10 @@ storeRegToStack(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
 
   unsigned Opc = 0;
 
-  if (M6502::GPR32RegClass.hasSubClassEq(RC))
-    Opc = M6502::SW;
-  else if (M6502::GPR64RegClass.hasSubClassEq(RC))
-    Opc = M6502::SD;
-  else if (M6502::ACC64RegClass.hasSubClassEq(RC))
-    Opc = M6502::STORE_ACC64;
-  else if (M6502::ACC64DSPRegClass.hasSubClassEq(RC))
-    Opc = M6502::STORE_ACC64DSP;
-  else if (M6502::ACC128RegClass.hasSubClassEq(RC))
-    Opc = M6502::STORE_ACC128;
-  else if (M6502::DSPCCRegClass.hasSubClassEq(RC))
-    Opc = M6502::STORE_CCOND_DSP;
-  else if (M6502::FGR32RegClass.hasSubClassEq(RC))
-    Opc = M6502::SWC1;
-  else if (M6502::AFGR64RegClass.hasSubClassEq(RC))
-    Opc = M6502::SDC1;
-  else if (M6502::FGR64RegClass.hasSubClassEq(RC))
-    Opc = M6502::SDC164;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v16i8))
-    Opc = M6502::ST_B;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v8i16) ||
-           TRI->isTypeLegalForClass(*RC, MVT::v8f16))
-    Opc = M6502::ST_H;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v4i32) ||
-           TRI->isTypeLegalForClass(*RC, MVT::v4f32))
-    Opc = M6502::ST_W;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v2i64) ||
-           TRI->isTypeLegalForClass(*RC, MVT::v2f64))
-    Opc = M6502::ST_D;
-  else if (M6502::LO32RegClass.hasSubClassEq(RC))
-    Opc = M6502::SW;
-  else if (M6502::LO64RegClass.hasSubClassEq(RC))
-    Opc = M6502::SD;
-  else if (M6502::HI32RegClass.hasSubClassEq(RC))
-    Opc = M6502::SW;
-  else if (M6502::HI64RegClass.hasSubClassEq(RC))
-    Opc = M6502::SD;
-  else if (M6502::DSPRRegClass.hasSubClassEq(RC))
-    Opc = M6502::SWDSP;
-
-  // Hi, Lo are normally caller save but they are callee save
-  // for interrupt handling.
-  const Function *Func = MBB.getParent()->getFunction();
-  if (Func->hasFnAttribute("interrupt")) {
-    if (M6502::HI32RegClass.hasSubClassEq(RC)) {
-      BuildMI(MBB, I, DL, get(M6502::MFHI), M6502::K0);
-      SrcReg = M6502::K0;
-    } else if (M6502::HI64RegClass.hasSubClassEq(RC)) {
-      BuildMI(MBB, I, DL, get(M6502::MFHI64), M6502::K0_64);
-      SrcReg = M6502::K0_64;
-    } else if (M6502::LO32RegClass.hasSubClassEq(RC)) {
-      BuildMI(MBB, I, DL, get(M6502::MFLO), M6502::K0);
-      SrcReg = M6502::K0;
-    } else if (M6502::LO64RegClass.hasSubClassEq(RC)) {
-      BuildMI(MBB, I, DL, get(M6502::MFLO64), M6502::K0_64);
-      SrcReg = M6502::K0_64;
-    }
-  }
+  if (M6502::ZP8RegClass.hasSubClassEq(RC))
+    Opc = M6502::ST8;
+  else if (M6502::ZP16RegClass.hasSubClassEq(RC))
+    Opc = M6502::ST16;
 
   assert(Opc && "Register class not handled!");
   BuildMI(MBB, I, DL, get(Opc)).addReg(SrcReg, getKillRegState(isKill))
@@ -262,203 +236,228 @@ loadRegFromStack(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
   MachineMemOperand *MMO = GetMemOperand(MBB, FI, MachineMemOperand::MOLoad);
   unsigned Opc = 0;
 
-  const Function *Func = MBB.getParent()->getFunction();
-  bool ReqIndirectLoad = Func->hasFnAttribute("interrupt") &&
-                         (DestReg == M6502::LO0 || DestReg == M6502::LO0_64 ||
-                          DestReg == M6502::HI0 || DestReg == M6502::HI0_64);
-
-  if (M6502::GPR32RegClass.hasSubClassEq(RC))
-    Opc = M6502::LW;
-  else if (M6502::GPR64RegClass.hasSubClassEq(RC))
-    Opc = M6502::LD;
-  else if (M6502::ACC64RegClass.hasSubClassEq(RC))
-    Opc = M6502::LOAD_ACC64;
-  else if (M6502::ACC64DSPRegClass.hasSubClassEq(RC))
-    Opc = M6502::LOAD_ACC64DSP;
-  else if (M6502::ACC128RegClass.hasSubClassEq(RC))
-    Opc = M6502::LOAD_ACC128;
-  else if (M6502::DSPCCRegClass.hasSubClassEq(RC))
-    Opc = M6502::LOAD_CCOND_DSP;
-  else if (M6502::FGR32RegClass.hasSubClassEq(RC))
-    Opc = M6502::LWC1;
-  else if (M6502::AFGR64RegClass.hasSubClassEq(RC))
-    Opc = M6502::LDC1;
-  else if (M6502::FGR64RegClass.hasSubClassEq(RC))
-    Opc = M6502::LDC164;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v16i8))
-    Opc = M6502::LD_B;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v8i16) ||
-           TRI->isTypeLegalForClass(*RC, MVT::v8f16))
-    Opc = M6502::LD_H;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v4i32) ||
-           TRI->isTypeLegalForClass(*RC, MVT::v4f32))
-    Opc = M6502::LD_W;
-  else if (TRI->isTypeLegalForClass(*RC, MVT::v2i64) ||
-           TRI->isTypeLegalForClass(*RC, MVT::v2f64))
-    Opc = M6502::LD_D;
-  else if (M6502::HI32RegClass.hasSubClassEq(RC))
-    Opc = M6502::LW;
-  else if (M6502::HI64RegClass.hasSubClassEq(RC))
-    Opc = M6502::LD;
-  else if (M6502::LO32RegClass.hasSubClassEq(RC))
-    Opc = M6502::LW;
-  else if (M6502::LO64RegClass.hasSubClassEq(RC))
-    Opc = M6502::LD;
-  else if (M6502::DSPRRegClass.hasSubClassEq(RC))
-    Opc = M6502::LWDSP;
+  if (M6502::ZP8RegClass.hasSubClassEq(RC))
+    Opc = M6502::LD8;
+  else if (M6502::ZP16RegClass.hasSubClassEq(RC))
+    Opc = M6502::LD16;
 
   assert(Opc && "Register class not handled!");
-
-  if (!ReqIndirectLoad)
-    BuildMI(MBB, I, DL, get(Opc), DestReg)
-        .addFrameIndex(FI)
-        .addImm(Offset)
-        .addMemOperand(MMO);
-  else {
-    // Load HI/LO through K0. Notably the DestReg is encoded into the
-    // instruction itself.
-    unsigned Reg = M6502::K0;
-    unsigned LdOp = M6502::MTLO;
-    if (DestReg == M6502::HI0)
-      LdOp = M6502::MTHI;
-
-    if (Subtarget.getABI().ArePtrs64bit()) {
-      Reg = M6502::K0_64;
-      if (DestReg == M6502::HI0_64)
-        LdOp = M6502::MTHI64;
-      else
-        LdOp = M6502::MTLO64;
-    }
-
-    BuildMI(MBB, I, DL, get(Opc), Reg)
-        .addFrameIndex(FI)
-        .addImm(Offset)
-        .addMemOperand(MMO);
-    BuildMI(MBB, I, DL, get(LdOp)).addReg(Reg);
-  }
+  BuildMI(MBB, I, DL, get(Opc), DestReg).addFrameIndex(FI).addImm(Offset)
+    .addMemOperand(MMO);
 }
 
 bool M6502SEInstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   MachineBasicBlock &MBB = *MI.getParent();
-  bool isMicroM6502 = Subtarget.inMicroM6502Mode();
-  unsigned Opc;
 
   switch (MI.getDesc().getOpcode()) {
   default:
     return false;
-  case M6502::RetRA:
-    expandRetRA(MBB, MI);
+  case M6502::LDimm8:
+  case M6502::LDimm16:
+    expandLoadImm(MBB, MI);
+    break;
+  case M6502::LDaddr16:
+    expandLoadAddr(MBB, MI);
+    break;
+  case M6502::LEA16:
+    adjustPtr(MBB, MI, MI.getDebugLoc(), MI.getOperand(0).getReg(),
+              MI.getOperand(1).getReg(), MI.getOperand(2).getImm());
+    break;
+  case M6502::LD8:
+    expandLoadStore(MBB, MI, false, false);
+    break;
+  case M6502::LD16:
+    expandLoadStore(MBB, MI, false, true);
+    break;
+  case M6502::ST8:
+    expandLoadStore(MBB, MI, true, false);
+    break;
+  case M6502::ST16:
+    expandLoadStore(MBB, MI, true, true);
+    break;
+  case M6502::LD8idx:
+    expandLoadStore(MBB, MI, false, false);
+    break;
+  case M6502::LD16idx:
+    expandLoadStore(MBB, MI, false, true);
     break;
-  case M6502::ERet:
-    expandERet(MBB, MI);
+  case M6502::ST8idx:
+    expandLoadStore(MBB, MI, true, false);
     break;
-  case M6502::PseudoMFHI:
-    Opc = isMicroM6502 ? M6502::MFHI16_MM : M6502::MFHI;
-    expandPseudoMFHiLo(MBB, MI, Opc);
+  case M6502::ST16idx:
+    expandLoadStore(MBB, MI, true, true);
     break;
-  case M6502::PseudoMFLO:
-    Opc = isMicroM6502 ? M6502::MFLO16_MM : M6502::MFLO;
-    expandPseudoMFHiLo(MBB, MI, Opc);
+  case M6502::LD8abs:
+    expandLoadStoreAbs(MBB, MI, false, false);
     break;
-  case M6502::PseudoMFHI64:
-    expandPseudoMFHiLo(MBB, MI, M6502::MFHI64);
+  case M6502::LD16abs:
+    expandLoadStoreAbs(MBB, MI, false, true);
     break;
-  case M6502::PseudoMFLO64:
-    expandPseudoMFHiLo(MBB, MI, M6502::MFLO64);
+  case M6502::ST8abs:
+    expandLoadStoreAbs(MBB, MI, true, false);
     break;
-  case M6502::PseudoMTLOHI:
-    expandPseudoMTLoHi(MBB, MI, M6502::MTLO, M6502::MTHI, false);
+  case M6502::ST16abs:
+    expandLoadStoreAbs(MBB, MI, true, true);
     break;
-  case M6502::PseudoMTLOHI64:
-    expandPseudoMTLoHi(MBB, MI, M6502::MTLO64, M6502::MTHI64, false);
+  case M6502::LD8absx:
+    expandLoadStoreAbs(MBB, MI, false, false);
     break;
-  case M6502::PseudoMTLOHI_DSP:
-    expandPseudoMTLoHi(MBB, MI, M6502::MTLO_DSP, M6502::MTHI_DSP, true);
+  case M6502::LD16absx:
+    expandLoadStoreAbs(MBB, MI, false, true);
     break;
-  case M6502::PseudoCVT_S_W:
-    expandCvtFPInt(MBB, MI, M6502::CVT_S_W, M6502::MTC1, false);
+  case M6502::ST8absx:
+    expandLoadStoreAbs(MBB, MI, true, false);
     break;
-  case M6502::PseudoCVT_D32_W:
-    expandCvtFPInt(MBB, MI, M6502::CVT_D32_W, M6502::MTC1, false);
+  case M6502::ST16absx:
+    expandLoadStoreAbs(MBB, MI, true, true);
     break;
-  case M6502::PseudoCVT_S_L:
-    expandCvtFPInt(MBB, MI, M6502::CVT_S_L, M6502::DMTC1, true);
+  case M6502::ADD8rr:
+  case M6502::ADD8ri:
+  case M6502::ADD16rr:
+  case M6502::ADD16ri:
+    expandArith(MBB, MI, M6502::ADCzp, M6502::ADCimm, M6502::CLC);
     break;
-  case M6502::PseudoCVT_D64_W:
-    expandCvtFPInt(MBB, MI, M6502::CVT_D64_W, M6502::MTC1, true);
+  case M6502::SUB8rr:
+  case M6502::SUB16rr:
+  case M6502::SUB16ri:
+    expandArith(MBB, MI, M6502::SBCzp, M6502::SBCimm, M6502::SEC);
     break;
-  case M6502::PseudoCVT_D64_L:
-    expandCvtFPInt(MBB, MI, M6502::CVT_D64_L, M6502::DMTC1, true);
+  case M6502::ADDE16rr:
+  case M6502::ADDE16ri:
+    expandArith(MBB, MI, M6502::ADCzp, M6502::ADCimm, 0);
     break;
-  case M6502::BuildPairF64:
-    expandBuildPairF64(MBB, MI, false);
+  case M6502::SUBE16rr:
+  case M6502::SUBE16ri:
+    expandArith(MBB, MI, M6502::SBCzp, M6502::SBCimm, 0);
     break;
-  case M6502::BuildPairF64_64:
-    expandBuildPairF64(MBB, MI, true);
+  case M6502::INC8:
+    buildZPUpdate(MBB, MI, MI.getDebugLoc(), get(M6502::INCzp),
+                  MI.getOperand(0).getReg());
     break;
-  case M6502::ExtractElementF64:
-    expandExtractElementF64(MBB, MI, false);
+  case M6502::DEC8:
+    buildZPUpdate(MBB, MI, MI.getDebugLoc(), get(M6502::DECzp),
+                  MI.getOperand(0).getReg());
     break;
-  case M6502::ExtractElementF64_64:
-    expandExtractElementF64(MBB, MI, true);
+  case M6502::AND8rr:
+  case M6502::AND8ri:
+  case M6502::AND16rr:
+  case M6502::AND16ri:
+    expandArith(MBB, MI, M6502::ANDzp, M6502::ANDimm, 0);
     break;
-  case M6502::M6502eh_return32:
-  case M6502::M6502eh_return64:
-    expandEhReturn(MBB, MI);
+  case M6502::OR8rr:
+  case M6502::OR8ri:
+  case M6502::OR16rr:
+  case M6502::OR16ri:
+    expandArith(MBB, MI, M6502::ORAzp, M6502::ORAimm, 0);
     break;
+  case M6502::XOR8rr:
+  case M6502::XOR8ri:
+  case M6502::XOR16rr:
+  case M6502::XOR16ri:
+    expandArith(MBB, MI, M6502::EORzp, M6502::EORimm, 0);
+    break;
+  case M6502::SHL8ri:
+  case M6502::SRL8ri:
+  case M6502::SRA8ri:
+    expandShift8(MBB, MI);
+    break;
+  case M6502::SHL16ri:
+  case M6502::SRL16ri:
+  case M6502::SRA16ri:
+    expandShift16(MBB, MI);
+    break;
+  case M6502::ZEXT16:
+  case M6502::SEXT16:
+    expandExtend(MBB, MI);
+    break;
+  case M6502::BR8rr:
+  case M6502::BR8ri:
+  case M6502::BR16rr:
+  case M6502::BR16ri:
+    expandBrCC(MBB, MI);
+    break;
+  case M6502::CALL:
+  case M6502::JSRind:
+    // The call itself stays.
+    expandCall(MBB, MI);
+    return true;
   }
 
   MBB.erase(MI);
   return true;
 }
 
+void M6502SEInstrInfo::expandCall(MachineBasicBlock &MBB,
+                                  MachineBasicBlock::iterator I) const {
+  static const unsigned ArgRegs[] = {M6502::A, M6502::X, M6502::Y};
+  static const unsigned LoadOpcs[] = {M6502::LDAzp, M6502::LDXzp,
+                                      M6502::LDYzp};
+  DebugLoc DL = I->getDebugLoc();
+
+  // The immediate has a bit for each of A, X and Y which gets an argument.
+  unsigned ArgMask = I->getOperand(1).getImm();
+  assert(ArgMask < (1u << array_lengthof(ArgRegs)) &&
+         "Unknown CPU register argument");
+  I->RemoveOperand(1);
+
+  // Instruction selection makes the call define the stack pointer for the
+  // ADJCALLSTACKUP glued to it, which is gone.  The callee gives the stack
+  // pointer back, and the register usage recorded for interprocedural
+  // register allocation must not make every caller look like it changes it.
+  unsigned SP = Subtarget.getABI().GetStackPtr();
+  for (unsigned Idx = I->getNumOperands(); Idx-- != 0;) {
+    const MachineOperand &MO = I->getOperand(Idx);
+    if (MO.isReg() && MO.isImplicit() && MO.isDef() && MO.getReg() == SP)
+      I->RemoveOperand(Idx);
+  }
+
+  for (unsigned Idx = 0; Idx != array_lengthof(ArgRegs); ++Idx) {
+    if (!(ArgMask & (1u << Idx)))
+      continue;
+    unsigned NumLeft = countPopulation(ArgMask >> Idx);
+    const MachineOperand &MO = I->getOperand(1);
+    unsigned Reg = MO.getReg();
+    bool Kill = MO.isKill();
+
+    // The same register may be passed in several CPU registers, and is only
+    // killed by its last load.
+    for (unsigned J = 2; J != NumLeft + 1; ++J) {
+      MachineOperand &Later = I->getOperand(J);
+      if (Later.getReg() == Reg) {
+        Later.setIsKill(Later.isKill() || Kill);
+        Kill = false;
+      }
+    }
+
+    BuildMI(MBB, I, DL, get(LoadOpcs[Idx])).addReg(Reg, getKillRegState(Kill));
+    I->RemoveOperand(1);
+    I->addOperand(MachineOperand::CreateReg(ArgRegs[Idx], false, true));
+  }
+
+  if (I->getOpcode() != M6502::CALL)
+    return;
+
+  // JSR is not variadic, so the zero page argument registers become implicit
+  // uses.
+  I->setDesc(get(M6502::JSR));
+  for (MachineOperand &MO : I->operands())
+    if (MO.isReg() && &MO != &I->getOperand(0))
+      MO.setImplicit();
+}
+
 /// getOppositeBranchOpc - Return the inverse of the specified
 /// opcode, e.g. turning BEQ to BNE.
 unsigned M6502SEInstrInfo::getOppositeBranchOpc(unsigned Opc) const {
   switch (Opc) {
   default:           llvm_unreachable("Illegal opcode!");
   case M6502::BEQ:    return M6502::BNE;
-  case M6502::BEQ_MM: return M6502::BNE_MM;
   case M6502::BNE:    return M6502::BEQ;
-  case M6502::BNE_MM: return M6502::BEQ_MM;
-  case M6502::BGTZ:   return M6502::BLEZ;
-  case M6502::BGEZ:   return M6502::BLTZ;
-  case M6502::BLTZ:   return M6502::BGEZ;
-  case M6502::BLEZ:   return M6502::BGTZ;
-  case M6502::BEQ64:  return M6502::BNE64;
-  case M6502::BNE64:  return M6502::BEQ64;
-  case M6502::BGTZ64: return M6502::BLEZ64;
-  case M6502::BGEZ64: return M6502::BLTZ64;
-  case M6502::BLTZ64: return M6502::BGEZ64;
-  case M6502::BLEZ64: return M6502::BGTZ64;
-  case M6502::BC1T:   return M6502::BC1F;
-  case M6502::BC1F:   return M6502::BC1T;
-  case M6502::BEQZC_MM: return M6502::BNEZC_MM;
-  case M6502::BNEZC_MM: return M6502::BEQZC_MM;
-  case M6502::BEQZC:  return M6502::BNEZC;
-  case M6502::BNEZC:  return M6502::BEQZC;
-  case M6502::BEQC:   return M6502::BNEC;
-  case M6502::BNEC:   return M6502::BEQC;
-  case M6502::BGTZC:  return M6502::BLEZC;
-  case M6502::BGEZC:  return M6502::BLTZC;
-  case M6502::BLTZC:  return M6502::BGEZC;
-  case M6502::BLEZC:  return M6502::BGTZC;
-  case M6502::BEQZC64:  return M6502::BNEZC64;
-  case M6502::BNEZC64:  return M6502::BEQZC64;
-  case M6502::BEQC64:   return M6502::BNEC64;
-  case M6502::BNEC64:   return M6502::BEQC64;
-  case M6502::BGEC64:   return M6502::BLTC64;
-  case M6502::BGEUC64:  return M6502::BLTUC64;
-  case M6502::BLTC64:   return M6502::BGEC64;
-  case M6502::BLTUC64:  return M6502::BGEUC64;
-  case M6502::BGTZC64:  return M6502::BLEZC64;
-  case M6502::BGEZC64:  return M6502::BLTZC64;
-  case M6502::BLTZC64:  return M6502::BGEZC64;
-  case M6502::BLEZC64:  return M6502::BGTZC64;
-  case M6502::BBIT0:  return M6502::BBIT1;
-  case M6502::BBIT1:  return M6502::BBIT0;
-  case M6502::BBIT032:  return M6502::BBIT132;
-  case M6502::BBIT132:  return M6502::BBIT032;
+  case M6502::BCC:    return M6502::BCS;
+  case M6502::BCS:    return M6502::BCC;
+  case M6502::BMI:    return M6502::BPL;
+  case M6502::BPL:    return M6502::BMI;
+  case M6502::BVS:    return M6502::BVC;
+  case M6502::BVC:    return M6502::BVS;
   }
 }
 
@@ -466,312 +465,633 @@ unsigned M6502SEInstrInfo::getOppositeBranchOpc(unsigned Opc) const {
 void M6502SEInstrInfo::adjustStackPtr(unsigned SP, int64_t Amount,
                                      MachineBasicBlock &MBB,
                                      MachineBasicBlock::iterator I) const {
-  M6502ABIInfo ABI = Subtarget.getABI();
   DebugLoc DL;
-  unsigned ADDiu = ABI.GetPtrAddiuOp();
 
   if (Amount == 0)
     return;
 
-  if (isInt<16>(Amount)) {
-    // addi sp, sp, amount
-    BuildMI(MBB, I, DL, get(ADDiu), SP).addReg(SP).addImm(Amount);
-  } else {
-    // For numbers which are not 16bit integers we synthesize Amount inline
-    // then add or subtract it from sp.
-    unsigned Opc = ABI.GetPtrAdduOp();
-    if (Amount < 0) {
-      Opc = ABI.GetPtrSubuOp();
-      Amount = -Amount;
-    }
-    unsigned Reg = loadImmediate(Amount, MBB, I, DL, nullptr);
-    BuildMI(MBB, I, DL, get(Opc), SP).addReg(SP).addReg(Reg, RegState::Kill);
-  }
-}
-
-/// This function generates the sequence of instructions needed to get the
-/// result of adding register REG and immediate IMM.
-unsigned M6502SEInstrInfo::loadImmediate(int64_t Imm, MachineBasicBlock &MBB,
-                                        MachineBasicBlock::iterator II,
-                                        const DebugLoc &DL,
-                                        unsigned *NewImm) const {
-  M6502AnalyzeImmediate AnalyzeImm;
-  const M6502Subtarget &STI = Subtarget;
-  MachineRegisterInfo &RegInfo = MBB.getParent()->getRegInfo();
-  unsigned Size = STI.isABI_N64() ? 64 : 32;
-  unsigned LUi = STI.isABI_N64() ? M6502::LUi64 : M6502::LUi;
-  unsigned ZEROReg = STI.isABI_N64() ? M6502::ZERO_64 : M6502::ZERO;
-  const TargetRegisterClass *RC = STI.isABI_N64() ?
-    &M6502::GPR64RegClass : &M6502::GPR32RegClass;
-  bool LastInstrIsADDiu = NewImm;
-
-  const M6502AnalyzeImmediate::InstSeq &Seq =
-    AnalyzeImm.Analyze(Imm, Size, LastInstrIsADDiu);
-  M6502AnalyzeImmediate::InstSeq::const_iterator Inst = Seq.begin();
-
-  assert(Seq.size() && (!LastInstrIsADDiu || (Seq.size() > 1)));
-
-  // The first instruction can be a LUi, which is different from other
-  // instructions (ADDiu, ORI and SLL) in that it does not have a register
-  // operand.
-  unsigned Reg = RegInfo.createVirtualRegister(RC);
-
-  if (Inst->Opc == LUi)
-    BuildMI(MBB, II, DL, get(LUi), Reg).addImm(SignExtend64<16>(Inst->ImmOpnd));
-  else
-    BuildMI(MBB, II, DL, get(Inst->Opc), Reg).addReg(ZEROReg)
-      .addImm(SignExtend64<16>(Inst->ImmOpnd));
-
-  // Build the remaining instructions in Seq.
-  for (++Inst; Inst != Seq.end() - LastInstrIsADDiu; ++Inst)
-    BuildMI(MBB, II, DL, get(Inst->Opc), Reg).addReg(Reg, RegState::Kill)
-      .addImm(SignExtend64<16>(Inst->ImmOpnd));
-
-  if (LastInstrIsADDiu)
-    *NewImm = Inst->ImmOpnd;
+  adjustPtr(MBB, I, DL, SP, SP, Amount);
+}
 
-  return Reg;
+void M6502SEInstrInfo::adjustPtr(MachineBasicBlock &MBB,
+                                MachineBasicBlock::iterator I,
+                                const DebugLoc &DL, unsigned DstReg,
+                                unsigned SrcReg, int64_t Amount) const {
+  assert(isInt<17>(Amount) && "Offset does not fit in the address space");
+
+  BuildMI(MBB, I, DL, get(M6502::CLC));
+  if (Subtarget.is65816()) {
+    BuildMI(MBB, I, DL, get(M6502::LDAzpW)).addReg(SrcReg);
+    BuildMI(MBB, I, DL, get(M6502::ADCimmW)).addImm(Amount & 0xffff);
+    buildZPStore(MBB, I, DL, get(M6502::STAzpW), DstReg);
+    return;
+  }
+  for (unsigned Idx : {M6502::sub_lo, M6502::sub_hi}) {
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(RI.getSubReg(SrcReg, Idx));
+    BuildMI(MBB, I, DL, get(M6502::ADCimm)).addImm(Amount & 0xff);
+    buildZPStore(MBB, I, DL, get(M6502::STAzp),
+                 RI.getSubReg(DstReg, Idx));
+    Amount >>= 8;
+  }
 }
 
 unsigned M6502SEInstrInfo::getAnalyzableBrOpc(unsigned Opc) const {
-  return (Opc == M6502::BEQ    || Opc == M6502::BEQ_MM || Opc == M6502::BNE    ||
-          Opc == M6502::BNE_MM || Opc == M6502::BGTZ   || Opc == M6502::BGEZ   ||
-          Opc == M6502::BLTZ   || Opc == M6502::BLEZ   || Opc == M6502::BEQ64  ||
-          Opc == M6502::BNE64  || Opc == M6502::BGTZ64 || Opc == M6502::BGEZ64 ||
-          Opc == M6502::BLTZ64 || Opc == M6502::BLEZ64 || Opc == M6502::BC1T   ||
-          Opc == M6502::BC1F   || Opc == M6502::B      || Opc == M6502::J      ||
-          Opc == M6502::BEQZC_MM || Opc == M6502::BNEZC_MM || Opc == M6502::BEQC ||
-          Opc == M6502::BNEC   || Opc == M6502::BLTC   || Opc == M6502::BGEC   ||
-          Opc == M6502::BLTUC  || Opc == M6502::BGEUC  || Opc == M6502::BGTZC  ||
-          Opc == M6502::BLEZC  || Opc == M6502::BGEZC  || Opc == M6502::BLTZC  ||
-          Opc == M6502::BEQZC  || Opc == M6502::BNEZC  || Opc == M6502::BEQZC64 ||
-          Opc == M6502::BNEZC64 || Opc == M6502::BEQC64 || Opc == M6502::BNEC64 ||
-          Opc == M6502::BGEC64 || Opc == M6502::BGEUC64 || Opc == M6502::BLTC64 ||
-          Opc == M6502::BLTUC64 || Opc == M6502::BGTZC64 ||
-          Opc == M6502::BGEZC64 || Opc == M6502::BLTZC64 ||
-          Opc == M6502::BLEZC64 || Opc == M6502::BC || Opc == M6502::BBIT0 ||
-          Opc == M6502::BBIT1 || Opc == M6502::BBIT032 ||
-          Opc == M6502::BBIT132) ? Opc : 0;
-}
-
-void M6502SEInstrInfo::expandRetRA(MachineBasicBlock &MBB,
-                                  MachineBasicBlock::iterator I) const {
+  return (Opc == M6502::BR8rr || Opc == M6502::BR8ri || Opc == M6502::BR16rr ||
+          Opc == M6502::BR16ri || Opc == M6502::BEQ  || Opc == M6502::BNE   ||
+          Opc == M6502::BCC   || Opc == M6502::BCS   || Opc == M6502::BMI   ||
+          Opc == M6502::BPL   || Opc == M6502::BVS   || Opc == M6502::BVC   ||
+          Opc == M6502::JMP) ? Opc : 0;
+}
 
-  MachineInstrBuilder MIB;
-  if (Subtarget.isGP64bit())
-    MIB = BuildMI(MBB, I, I->getDebugLoc(), get(M6502::PseudoReturn64))
-              .addReg(M6502::RA_64, RegState::Undef);
-  else
-    MIB = BuildMI(MBB, I, I->getDebugLoc(), get(M6502::PseudoReturn))
-              .addReg(M6502::RA, RegState::Undef);
+void M6502SEInstrInfo::expandLoadImm(MachineBasicBlock &MBB,
+                                    MachineBasicBlock::iterator I) const {
+  DebugLoc DL = I->getDebugLoc();
+  unsigned DstReg = I->getOperand(0).getReg();
+  uint64_t Imm = I->getOperand(1).getImm();
 
-  // Retain any imp-use flags.
-  for (auto & MO : I->operands()) {
-    if (MO.isImplicit())
-      MIB.add(MO);
+  if (I->getOpcode() == M6502::LDimm8) {
+    BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm(Imm & 0xff);
+    buildZPStore(MBB, I, DL, get(M6502::STAzp), DstReg);
+    return;
   }
+
+  if (Subtarget.is65816()) {
+    BuildMI(MBB, I, DL, get(M6502::LDAimmW)).addImm(Imm & 0xffff);
+    buildZPStore(MBB, I, DL, get(M6502::STAzpW), DstReg);
+    return;
+  }
+
+  // Both bytes are stored from A, so a repeated byte is only loaded once.
+  BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm(Imm & 0xff);
+  buildZPStore(MBB, I, DL, get(M6502::STAzp),
+               RI.getSubReg(DstReg, M6502::sub_lo));
+  if (((Imm >> 8) & 0xff) != (Imm & 0xff))
+    BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm((Imm >> 8) & 0xff);
+  buildZPStore(MBB, I, DL, get(M6502::STAzp),
+               RI.getSubReg(DstReg, M6502::sub_hi));
 }
 
-void M6502SEInstrInfo::expandERet(MachineBasicBlock &MBB,
-                                 MachineBasicBlock::iterator I) const {
-  BuildMI(MBB, I, I->getDebugLoc(), get(M6502::ERET));
+void M6502SEInstrInfo::expandLoadAddr(MachineBasicBlock &MBB,
+                                     MachineBasicBlock::iterator I) const {
+  DebugLoc DL = I->getDebugLoc();
+  unsigned DstReg = I->getOperand(0).getReg();
+  MachineOperand Lo = I->getOperand(1), Hi = I->getOperand(1);
+
+  // A 16-bit A takes the whole address as its immediate.
+  if (Subtarget.is65816()) {
+    BuildMI(MBB, I, DL, get(M6502::LDAimmW)).add(I->getOperand(1));
+    buildZPStore(MBB, I, DL, get(M6502::STAzpW), DstReg);
+    return;
+  }
+
+  Lo.setTargetFlags(M6502II::MO_ABS_LO);
+  Hi.setTargetFlags(M6502II::MO_ABS_HI);
+
+  BuildMI(MBB, I, DL, get(M6502::LDAimm)).add(Lo);
+  buildZPStore(MBB, I, DL, get(M6502::STAzp),
+               RI.getSubReg(DstReg, M6502::sub_lo));
+  BuildMI(MBB, I, DL, get(M6502::LDAimm)).add(Hi);
+  buildZPStore(MBB, I, DL, get(M6502::STAzp),
+               RI.getSubReg(DstReg, M6502::sub_hi));
 }
 
-std::pair<bool, bool>
-M6502SEInstrInfo::compareOpndSize(unsigned Opc,
-                                 const MachineFunction &MF) const {
-  const MCInstrDesc &Desc = get(Opc);
-  assert(Desc.NumOperands == 2 && "Unary instruction expected.");
-  const M6502RegisterInfo *RI = &getRegisterInfo();
-  unsigned DstRegSize = RI->getRegSizeInBits(*getRegClass(Desc, 0, RI, MF));
-  unsigned SrcRegSize = RI->getRegSizeInBits(*getRegClass(Desc, 1, RI, MF));
+// Loads and stores through a register pair use the (zp),Y addressing mode
+// with the offset, or the byte index register, in Y.
+void M6502SEInstrInfo::expandLoadStore(MachineBasicBlock &MBB,
+                                      MachineBasicBlock::iterator I,
+                                      bool IsStore, bool Is16) const {
+  DebugLoc DL = I->getDebugLoc();
+  unsigned Reg = I->getOperand(0).getReg();
+  unsigned BaseReg = I->getOperand(1).getReg();
+  const MachineOperand &Offset = I->getOperand(2);
+
+  // The 65C02 reads and writes a byte at the pointer itself with (zp).
+  if (!Is16 && Offset.isImm() && Offset.getImm() == 0 &&
+      Subtarget.hasCMOS()) {
+    if (IsStore) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(Reg);
+      BuildMI(MBB, I, DL, get(M6502::STAind)).addReg(BaseReg);
+    } else {
+      BuildMI(MBB, I, DL, get(M6502::LDAind)).addReg(BaseReg);
+      buildZPStore(MBB, I, DL, get(M6502::STAzp), Reg);
+    }
+    return;
+  }
+
+  if (Offset.isReg()) {
+    BuildMI(MBB, I, DL, get(M6502::LDYzp)).addReg(Offset.getReg());
+  } else {
+    assert(isUInt<8>(Offset.getImm() + Is16) && "Offset does not fit in Y");
+    BuildMI(MBB, I, DL, get(M6502::LDYimm)).addImm(Offset.getImm());
+  }
+
+  if (!Is16) {
+    if (IsStore) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(Reg);
+      BuildMI(MBB, I, DL, get(M6502::STAindy)).addReg(BaseReg);
+    } else {
+      BuildMI(MBB, I, DL, get(M6502::LDAindy)).addReg(BaseReg);
+      buildZPStore(MBB, I, DL, get(M6502::STAzp), Reg);
+    }
+    return;
+  }
 
-  return std::make_pair(DstRegSize > SrcRegSize, DstRegSize < SrcRegSize);
+  // A 16-bit A reads and writes the word at Y at once.
+  if (Subtarget.is65816()) {
+    if (IsStore) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzpW)).addReg(Reg);
+      BuildMI(MBB, I, DL, get(M6502::STAindyW)).addReg(BaseReg);
+    } else {
+      BuildMI(MBB, I, DL, get(M6502::LDAindyW)).addReg(BaseReg);
+      buildZPStore(MBB, I, DL, get(M6502::STAzpW), Reg);
+    }
+    return;
+  }
+
+  unsigned LoReg = RI.getSubReg(Reg, M6502::sub_lo);
+  unsigned HiReg = RI.getSubReg(Reg, M6502::sub_hi);
+
+  if (IsStore) {
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(LoReg);
+    BuildMI(MBB, I, DL, get(M6502::STAindy)).addReg(BaseReg);
+    BuildMI(MBB, I, DL, get(M6502::INY));
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(HiReg);
+    BuildMI(MBB, I, DL, get(M6502::STAindy)).addReg(BaseReg);
+    return;
+  }
+
+  // The destination may be the base register, so nothing is written back
+  // before both bytes have been read.
+  BuildMI(MBB, I, DL, get(M6502::LDAindy)).addReg(BaseReg);
+  BuildMI(MBB, I, DL, get(M6502::TAX));
+  BuildMI(MBB, I, DL, get(M6502::INY));
+  BuildMI(MBB, I, DL, get(M6502::LDAindy)).addReg(BaseReg);
+  buildZPStore(MBB, I, DL, get(M6502::STAzp), HiReg);
+  buildZPStore(MBB, I, DL, get(M6502::STXzp), LoReg);
 }
 
-void M6502SEInstrInfo::expandPseudoMFHiLo(MachineBasicBlock &MBB,
-                                         MachineBasicBlock::iterator I,
-                                         unsigned NewOpc) const {
-  BuildMI(MBB, I, I->getDebugLoc(), get(NewOpc), I->getOperand(0).getReg());
+/// Return the address of the byte following the one addressed by MO.
+static MachineOperand getNextByteAddr(const MachineOperand &MO) {
+  MachineOperand Next = MO;
+
+  if (MO.isImm())
+    Next.setImm(MO.getImm() + 1);
+  else
+    Next.setOffset(MO.getOffset() + 1);
+  return Next;
 }
 
-void M6502SEInstrInfo::expandPseudoMTLoHi(MachineBasicBlock &MBB,
-                                         MachineBasicBlock::iterator I,
-                                         unsigned LoOpc,
-                                         unsigned HiOpc,
-                                         bool HasExplicitDef) const {
-  // Expand
-  //  lo_hi pseudomtlohi $gpr0, $gpr1
-  // to these two instructions:
-  //  mtlo $gpr0
-  //  mthi $gpr1
+/// Return true if all Size bytes addressed by MO are in the zero page.  An
+/// indexed zero page access wraps around within the zero page, so the base
+/// of an IsIndexed access must be an object there rather than a constant
+/// below $100 plus an index which may reach past it.
+static bool isZeroPageAddr(const MachineOperand &MO, unsigned Size,
+                           bool IsIndexed) {
+  if (MO.isImm())
+    return !IsIndexed && MO.getImm() >= 0 && MO.getImm() + Size <= 0x100;
+
+  return MO.isGlobal() && M6502TargetObjectFile::IsGlobalInZeroPage(
+                              MO.getGlobal());
+}
 
+// Loads and stores from an absolute address use the absolute or zero page
+// addressing mode, indexed by X for the pseudos with a byte index register.
+void M6502SEInstrInfo::expandLoadStoreAbs(MachineBasicBlock &MBB,
+                                         MachineBasicBlock::iterator I,
+                                         bool IsStore, bool Is16) const {
   DebugLoc DL = I->getDebugLoc();
-  const MachineOperand &SrcLo = I->getOperand(1), &SrcHi = I->getOperand(2);
-  MachineInstrBuilder LoInst = BuildMI(MBB, I, DL, get(LoOpc));
-  MachineInstrBuilder HiInst = BuildMI(MBB, I, DL, get(HiOpc));
+  unsigned Reg = I->getOperand(0).getReg();
+  const MachineOperand &Addr = I->getOperand(1);
+  unsigned Regs[2] = {Reg, 0};
+  MachineOperand Addrs[2] = {Addr, Is16 ? getNextByteAddr(Addr) : Addr};
+  bool IsIndexed = I->getDesc().getNumOperands() == 3;
+  bool IsZP = isZeroPageAddr(Addr, Is16 ? 2 : 1, IsIndexed);
+  unsigned LoadOpc, StoreOpc;
+
+  if (IsIndexed) {
+    BuildMI(MBB, I, DL, get(M6502::LDXzp)).addReg(I->getOperand(2).getReg());
+    LoadOpc = IsZP ? M6502::LDAzpx : M6502::LDAabsx;
+    StoreOpc = IsZP ? M6502::STAzpx : M6502::STAabsx;
+  } else {
+    LoadOpc = IsZP ? M6502::LDAzp : M6502::LDAabs;
+    StoreOpc = IsZP ? M6502::STAzp : M6502::STAabs;
+  }
 
-  // Add lo/hi registers if the mtlo/hi instructions created have explicit
-  // def registers.
-  if (HasExplicitDef) {
-    unsigned DstReg = I->getOperand(0).getReg();
-    unsigned DstLo = getRegisterInfo().getSubReg(DstReg, M6502::sub_lo);
-    unsigned DstHi = getRegisterInfo().getSubReg(DstReg, M6502::sub_hi);
-    LoInst.addReg(DstLo, RegState::Define);
-    HiInst.addReg(DstHi, RegState::Define);
+  // Without an index, a 16-bit A accesses both bytes at once.
+  if (Is16 && !IsIndexed && Subtarget.is65816()) {
+    if (IsStore) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzpW)).addReg(Reg);
+      BuildMI(MBB, I, DL, get(IsZP ? M6502::STAzpW : M6502::STAabsW)).add(Addr)
+        .setMemRefs(I->memoperands_begin(), I->memoperands_end());
+    } else {
+      BuildMI(MBB, I, DL, get(IsZP ? M6502::LDAzpW : M6502::LDAabsW)).add(Addr)
+        .setMemRefs(I->memoperands_begin(), I->memoperands_end());
+      buildZPStore(MBB, I, DL, get(M6502::STAzpW), Reg);
+    }
+    return;
+  }
+
+  if (Is16) {
+    Regs[0] = RI.getSubReg(Reg, M6502::sub_lo);
+    Regs[1] = RI.getSubReg(Reg, M6502::sub_hi);
   }
 
-  LoInst.addReg(SrcLo.getReg(), getKillRegState(SrcLo.isKill()));
-  HiInst.addReg(SrcHi.getReg(), getKillRegState(SrcHi.isKill()));
+  // The memory accesses keep the memory operands of the pseudo, which tell
+  // the peephole optimizer whether they may be merged.
+  for (unsigned Idx = 0; Idx < (Is16 ? 2u : 1u); ++Idx) {
+    if (IsStore) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(Regs[Idx]);
+      BuildMI(MBB, I, DL, get(StoreOpc)).add(Addrs[Idx])
+        .setMemRefs(I->memoperands_begin(), I->memoperands_end());
+    } else {
+      BuildMI(MBB, I, DL, get(LoadOpc)).add(Addrs[Idx])
+        .setMemRefs(I->memoperands_begin(), I->memoperands_end());
+      buildZPStore(MBB, I, DL, get(M6502::STAzp), Regs[Idx]);
+    }
+  }
 }
 
-void M6502SEInstrInfo::expandCvtFPInt(MachineBasicBlock &MBB,
-                                     MachineBasicBlock::iterator I,
-                                     unsigned CvtOpc, unsigned MovOpc,
-                                     bool IsI64) const {
-  const MCInstrDesc &CvtDesc = get(CvtOpc), &MovDesc = get(MovOpc);
-  const MachineOperand &Dst = I->getOperand(0), &Src = I->getOperand(1);
-  unsigned DstReg = Dst.getReg(), SrcReg = Src.getReg(), TmpReg = DstReg;
-  unsigned KillSrc =  getKillRegState(Src.isKill());
+/// Return true if the logic operation OpcImm leaves a byte unchanged when
+/// its immediate operand is Byte.
+static bool isIdentityByte(unsigned OpcImm, uint64_t Byte) {
+  return (OpcImm == M6502::ANDimm && Byte == 0xff) ||
+         ((OpcImm == M6502::ORAimm || OpcImm == M6502::EORimm) && Byte == 0);
+}
+
+/// Return true if the logic operation OpcImm produces the same byte whatever
+/// its register operand is when its immediate operand is Byte.
+static bool isAbsorbingByte(unsigned OpcImm, uint64_t Byte) {
+  return (OpcImm == M6502::ANDimm && Byte == 0) ||
+         (OpcImm == M6502::ORAimm && Byte == 0xff);
+}
+
+/// Return the form of the accumulator instruction Opc which operates on a
+/// 16-bit A on the 65816.
+static unsigned getWideOpcode(unsigned Opc) {
+  switch (Opc) {
+  case M6502::ADCzp:  return M6502::ADCzpW;
+  case M6502::ADCimm: return M6502::ADCimmW;
+  case M6502::SBCzp:  return M6502::SBCzpW;
+  case M6502::SBCimm: return M6502::SBCimmW;
+  case M6502::ANDzp:  return M6502::ANDzpW;
+  case M6502::ANDimm: return M6502::ANDimmW;
+  case M6502::ORAzp:  return M6502::ORAzpW;
+  case M6502::ORAimm: return M6502::ORAimmW;
+  case M6502::EORzp:  return M6502::EORzpW;
+  case M6502::EORimm: return M6502::EORimmW;
+  case M6502::CMPzp:  return M6502::CMPzpW;
+  case M6502::CMPimm: return M6502::CMPimmW;
+  default: llvm_unreachable("No 16-bit form of the instruction");
+  }
+}
+
+void M6502SEInstrInfo::expandArith(MachineBasicBlock &MBB,
+                                  MachineBasicBlock::iterator I,
+                                  unsigned Opc, unsigned OpcImm,
+                                  unsigned FlagOpc) const {
   DebugLoc DL = I->getDebugLoc();
-  bool DstIsLarger, SrcIsLarger;
+  unsigned DstReg = I->getOperand(0).getReg();
+  unsigned SrcReg = I->getOperand(1).getReg();
+  const MachineOperand &Src2 = I->getOperand(2);
+  SmallVector<unsigned, 2> Dst, Src, Src2Regs;
+
+  if (M6502::ZP16RegClass.contains(DstReg)) {
+    // Low byte first so that the carry ripples into the high byte.
+    for (unsigned Idx : {M6502::sub_lo, M6502::sub_hi}) {
+      Dst.push_back(RI.getSubReg(DstReg, Idx));
+      Src.push_back(RI.getSubReg(SrcReg, Idx));
+      if (Src2.isReg())
+        Src2Regs.push_back(RI.getSubReg(Src2.getReg(), Idx));
+    }
+  } else {
+    Dst.push_back(DstReg);
+    Src.push_back(SrcReg);
+    if (Src2.isReg())
+      Src2Regs.push_back(Src2.getReg());
+  }
+
+  if (FlagOpc)
+    BuildMI(MBB, I, DL, get(FlagOpc));
+
+  // A 16-bit A on the 65816 operates on both bytes at once, unless a logic
+  // operation leaves one alone or makes it a constant, which is cheaper.
+  bool Wide = Dst.size() == 2 && Subtarget.is65816();
+  if (Wide && Src2.isImm())
+    for (unsigned B = 0; B != 2; ++B) {
+      uint64_t Byte = (Src2.getImm() >> (8 * B)) & 0xff;
+      if (isIdentityByte(OpcImm, Byte) || isAbsorbingByte(OpcImm, Byte))
+        Wide = false;
+    }
 
-  std::tie(DstIsLarger, SrcIsLarger) =
-      compareOpndSize(CvtOpc, *MBB.getParent());
+  if (Wide) {
+    BuildMI(MBB, I, DL, get(M6502::LDAzpW)).addReg(SrcReg);
+    if (Src2.isReg())
+      BuildMI(MBB, I, DL, get(getWideOpcode(Opc))).addReg(Src2.getReg());
+    else
+      BuildMI(MBB, I, DL, get(getWideOpcode(OpcImm)))
+        .addImm(Src2.getImm() & 0xffff);
+    buildZPStore(MBB, I, DL, get(M6502::STAzpW), DstReg);
+    return;
+  }
+
+  for (unsigned B = 0, E = Dst.size(); B != E; ++B) {
+    if (Src2.isReg()) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(Src[B]);
+      BuildMI(MBB, I, DL, get(Opc)).addReg(Src2Regs[B]);
+      buildZPStore(MBB, I, DL, get(M6502::STAzp), Dst[B]);
+      continue;
+    }
 
-  if (DstIsLarger)
-    TmpReg = getRegisterInfo().getSubReg(DstReg, M6502::sub_lo);
+    uint64_t Byte = (Src2.getImm() >> (8 * B)) & 0xff;
+
+    // Bytes a logic operation does not change are only copied, and bytes it
+    // forces to a constant are loaded directly.
+    if (isIdentityByte(OpcImm, Byte)) {
+      if (Dst[B] != Src[B])
+        copyPhysReg(MBB, I, DL, Dst[B], Src[B], false);
+      continue;
+    }
+
+    if (isAbsorbingByte(OpcImm, Byte))
+      BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm(Byte);
+    else {
+      BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(Src[B]);
+      BuildMI(MBB, I, DL, get(OpcImm)).addImm(Byte);
+    }
+    buildZPStore(MBB, I, DL, get(M6502::STAzp), Dst[B]);
+  }
+}
 
-  if (SrcIsLarger)
-    DstReg = getRegisterInfo().getSubReg(DstReg, M6502::sub_lo);
+/// Build the instructions shifting A right by one bit, either logically or
+/// arithmetically.  CMP #$80 copies the sign bit into the carry, which ROR
+/// then shifts back in.
+void M6502SEInstrInfo::buildShiftRightA(MachineBasicBlock &MBB,
+                                       MachineBasicBlock::iterator I,
+                                       const DebugLoc &DL,
+                                       bool IsArith) const {
+  if (!IsArith) {
+    BuildMI(MBB, I, DL, get(M6502::LSRacc));
+    return;
+  }
+  BuildMI(MBB, I, DL, get(M6502::CMPimm)).addImm(0x80);
+  BuildMI(MBB, I, DL, get(M6502::RORacc));
+}
 
-  BuildMI(MBB, I, DL, MovDesc, TmpReg).addReg(SrcReg, KillSrc);
-  BuildMI(MBB, I, DL, CvtDesc, DstReg).addReg(TmpReg, RegState::Kill);
+/// Build the instructions replacing A with 0xff if it is negative and with 0
+/// otherwise.
+void M6502SEInstrInfo::buildSignFillA(MachineBasicBlock &MBB,
+                                     MachineBasicBlock::iterator I,
+                                     const DebugLoc &DL) const {
+  BuildMI(MBB, I, DL, get(M6502::ASLacc));
+  BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm(0);
+  BuildMI(MBB, I, DL, get(M6502::ADCimm)).addImm(0xff);
+  BuildMI(MBB, I, DL, get(M6502::EORimm)).addImm(0xff);
 }
 
-void M6502SEInstrInfo::expandExtractElementF64(MachineBasicBlock &MBB,
-                                              MachineBasicBlock::iterator I,
-                                              bool FP64) const {
+void M6502SEInstrInfo::expandExtend(MachineBasicBlock &MBB,
+                                   MachineBasicBlock::iterator I) const {
+  DebugLoc DL = I->getDebugLoc();
   unsigned DstReg = I->getOperand(0).getReg();
   unsigned SrcReg = I->getOperand(1).getReg();
-  unsigned N = I->getOperand(2).getImm();
-  DebugLoc dl = I->getDebugLoc();
-
-  assert(N < 2 && "Invalid immediate");
-  unsigned SubIdx = N ? M6502::sub_hi : M6502::sub_lo;
-  unsigned SubReg = getRegisterInfo().getSubReg(SrcReg, SubIdx);
-
-  // FPXX on M6502-II or M650232r1 should have been handled with a spill/reload
-  // in M6502SEFrameLowering.cpp.
-  assert(!(Subtarget.isABI_FPXX() && !Subtarget.hasM650232r2()));
-
-  // FP64A (FP64 with nooddspreg) should have been handled with a spill/reload
-  // in M6502SEFrameLowering.cpp.
-  assert(!(Subtarget.isFP64bit() && !Subtarget.useOddSPReg()));
-
-  if (SubIdx == M6502::sub_hi && Subtarget.hasMTHC1()) {
-    // FIXME: Strictly speaking MFHC1 only reads the top 32-bits however, we
-    //        claim to read the whole 64-bits as part of a white lie used to
-    //        temporarily work around a widespread bug in the -mfp64 support.
-    //        The problem is that none of the 32-bit fpu ops mention the fact
-    //        that they clobber the upper 32-bits of the 64-bit FPR. Fixing that
-    //        requires a major overhaul of the FPU implementation which can't
-    //        be done right now due to time constraints.
-    //        MFHC1 is one of two instructions that are affected since they are
-    //        the only instructions that don't read the lower 32-bits.
-    //        We therefore pretend that it reads the bottom 32-bits to
-    //        artificially create a dependency and prevent the scheduler
-    //        changing the behaviour of the code.
-    BuildMI(MBB, I, dl, get(FP64 ? M6502::MFHC1_D64 : M6502::MFHC1_D32), DstReg)
-        .addReg(SrcReg);
-  } else
-    BuildMI(MBB, I, dl, get(M6502::MFC1), DstReg).addReg(SubReg);
-}
-
-void M6502SEInstrInfo::expandBuildPairF64(MachineBasicBlock &MBB,
-                                         MachineBasicBlock::iterator I,
-                                         bool FP64) const {
+  unsigned DstLo = RI.getSubReg(DstReg, M6502::sub_lo);
+  unsigned DstHi = RI.getSubReg(DstReg, M6502::sub_hi);
+
+  // The source may be the high byte of the destination, so the low byte is
+  // written first.
+  if (DstLo != SrcReg || I->getOpcode() == M6502::SEXT16)
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(SrcReg);
+  if (DstLo != SrcReg)
+    buildZPStore(MBB, I, DL, get(M6502::STAzp), DstLo);
+  if (I->getOpcode() == M6502::SEXT16)
+    buildSignFillA(MBB, I, DL);
+  else
+    BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm(0);
+  buildZPStore(MBB, I, DL, get(M6502::STAzp), DstHi);
+}
+
+void M6502SEInstrInfo::expandShift8(MachineBasicBlock &MBB,
+                                   MachineBasicBlock::iterator I) const {
+  DebugLoc DL = I->getDebugLoc();
+  unsigned Opc = I->getOpcode();
   unsigned DstReg = I->getOperand(0).getReg();
-  unsigned LoReg = I->getOperand(1).getReg(), HiReg = I->getOperand(2).getReg();
-  const MCInstrDesc& Mtc1Tdd = get(M6502::MTC1);
-  DebugLoc dl = I->getDebugLoc();
-  const TargetRegisterInfo &TRI = getRegisterInfo();
-
-  // When mthc1 is available, use:
-  //   mtc1 Lo, $fp
-  //   mthc1 Hi, $fp
-  //
-  // Otherwise, for O32 FPXX ABI:
-  //   spill + reload via ldc1
-  // This case is handled by the frame lowering code.
-  //
-  // Otherwise, for FP32:
-  //   mtc1 Lo, $fp
-  //   mtc1 Hi, $fp + 1
-  //
-  // The case where dmtc1 is available doesn't need to be handled here
-  // because it never creates a BuildPairF64 node.
-
-  // FPXX on M6502-II or M650232r1 should have been handled with a spill/reload
-  // in M6502SEFrameLowering.cpp.
-  assert(!(Subtarget.isABI_FPXX() && !Subtarget.hasM650232r2()));
-
-  // FP64A (FP64 with nooddspreg) should have been handled with a spill/reload
-  // in M6502SEFrameLowering.cpp.
-  assert(!(Subtarget.isFP64bit() && !Subtarget.useOddSPReg()));
-
-  BuildMI(MBB, I, dl, Mtc1Tdd, TRI.getSubReg(DstReg, M6502::sub_lo))
-    .addReg(LoReg);
-
-  if (Subtarget.hasMTHC1()) {
-    // FIXME: The .addReg(DstReg) is a white lie used to temporarily work
-    //        around a widespread bug in the -mfp64 support.
-    //        The problem is that none of the 32-bit fpu ops mention the fact
-    //        that they clobber the upper 32-bits of the 64-bit FPR. Fixing that
-    //        requires a major overhaul of the FPU implementation which can't
-    //        be done right now due to time constraints.
-    //        MTHC1 is one of two instructions that are affected since they are
-    //        the only instructions that don't read the lower 32-bits.
-    //        We therefore pretend that it reads the bottom 32-bits to
-    //        artificially create a dependency and prevent the scheduler
-    //        changing the behaviour of the code.
-    BuildMI(MBB, I, dl, get(FP64 ? M6502::MTHC1_D64 : M6502::MTHC1_D32), DstReg)
-        .addReg(DstReg)
-        .addReg(HiReg);
-  } else if (Subtarget.isABI_FPXX())
-    llvm_unreachable("BuildPairF64 not expanded in frame lowering code!");
+  unsigned SrcReg = I->getOperand(1).getReg();
+  int64_t Amt = I->getOperand(2).getImm();
+
+  // A single logical shift in place is one read-modify-write instruction.
+  if (Amt == 1 && DstReg == SrcReg && Opc != M6502::SRA8ri) {
+    buildZPUpdate(MBB, I, DL,
+                  get(Opc == M6502::SHL8ri ? M6502::ASLzp : M6502::LSRzp),
+                  DstReg);
+    return;
+  }
+
+  BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(SrcReg);
+  if (Opc == M6502::SRA8ri && Amt == 7)
+    buildSignFillA(MBB, I, DL);
   else
-    BuildMI(MBB, I, dl, Mtc1Tdd, TRI.getSubReg(DstReg, M6502::sub_hi))
-      .addReg(HiReg);
+    for (int64_t N = 0; N < Amt; ++N) {
+      if (Opc == M6502::SHL8ri)
+        BuildMI(MBB, I, DL, get(M6502::ASLacc));
+      else
+        buildShiftRightA(MBB, I, DL, Opc == M6502::SRA8ri);
+    }
+  buildZPStore(MBB, I, DL, get(M6502::STAzp), DstReg);
 }
 
-void M6502SEInstrInfo::expandEhReturn(MachineBasicBlock &MBB,
-                                     MachineBasicBlock::iterator I) const {
-  // This pseudo instruction is generated as part of the lowering of
-  // ISD::EH_RETURN. We convert it to a stack increment by OffsetReg, and
-  // indirect jump to TargetReg
-  M6502ABIInfo ABI = Subtarget.getABI();
-  unsigned ADDU = ABI.GetPtrAdduOp();
-  unsigned SP = Subtarget.isGP64bit() ? M6502::SP_64 : M6502::SP;
-  unsigned RA = Subtarget.isGP64bit() ? M6502::RA_64 : M6502::RA;
-  unsigned T9 = Subtarget.isGP64bit() ? M6502::T9_64 : M6502::T9;
-  unsigned ZERO = Subtarget.isGP64bit() ? M6502::ZERO_64 : M6502::ZERO;
-  unsigned OffsetReg = I->getOperand(0).getReg();
-  unsigned TargetReg = I->getOperand(1).getReg();
-
-  // addu $ra, $v0, $zero
-  // addu $sp, $sp, $v1
-  // jr   $ra (via RetRA)
-  const TargetMachine &TM = MBB.getParent()->getTarget();
-  if (TM.isPositionIndependent())
-    BuildMI(MBB, I, I->getDebugLoc(), get(ADDU), T9)
-        .addReg(TargetReg)
-        .addReg(ZERO);
-  BuildMI(MBB, I, I->getDebugLoc(), get(ADDU), RA)
-      .addReg(TargetReg)
-      .addReg(ZERO);
-  BuildMI(MBB, I, I->getDebugLoc(), get(ADDU), SP).addReg(SP).addReg(OffsetReg);
-  expandRetRA(MBB, I);
+void M6502SEInstrInfo::expandShift16(MachineBasicBlock &MBB,
+                                    MachineBasicBlock::iterator I) const {
+  DebugLoc DL = I->getDebugLoc();
+  unsigned Opc = I->getOpcode();
+  unsigned DstReg = I->getOperand(0).getReg();
+  unsigned SrcReg = I->getOperand(1).getReg();
+  bool KillSrc = I->getOperand(1).isKill();
+  int64_t Amt = I->getOperand(2).getImm();
+  unsigned DstLo = RI.getSubReg(DstReg, M6502::sub_lo);
+  unsigned DstHi = RI.getSubReg(DstReg, M6502::sub_hi);
+  unsigned SrcLo = RI.getSubReg(SrcReg, M6502::sub_lo);
+  unsigned SrcHi = RI.getSubReg(SrcReg, M6502::sub_hi);
+  bool IsArith = Opc == M6502::SRA16ri;
+
+  // Shifts by eight bits or more move one byte and shift it through A.  The
+  // pairs either overlap completely or not at all, so reading the byte of
+  // the source into A before writing the destination is enough.
+  if (Amt >= 8) {
+    Amt -= 8;
+    if (Opc == M6502::SHL16ri) {
+      BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(SrcLo);
+      for (int64_t N = 0; N < Amt; ++N)
+        BuildMI(MBB, I, DL, get(M6502::ASLacc));
+      buildZPStore(MBB, I, DL, get(M6502::STAzp), DstHi);
+      BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm(0);
+      buildZPStore(MBB, I, DL, get(M6502::STAzp), DstLo);
+      return;
+    }
+
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(SrcHi);
+    if (IsArith && Amt == 7)
+      buildSignFillA(MBB, I, DL);
+    else
+      for (int64_t N = 0; N < Amt; ++N)
+        buildShiftRightA(MBB, I, DL, IsArith);
+    buildZPStore(MBB, I, DL, get(M6502::STAzp), DstLo);
+    if (IsArith) {
+      if (Amt != 7)
+        BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(SrcHi);
+      buildSignFillA(MBB, I, DL);
+    } else
+      BuildMI(MBB, I, DL, get(M6502::LDAimm)).addImm(0);
+    buildZPStore(MBB, I, DL, get(M6502::STAzp), DstHi);
+    return;
+  }
+
+  // Shorter shifts work in place on the destination: the low byte is
+  // shifted in memory and the high byte in A, with the carry moving the bit
+  // crossing from one byte to the other.
+  if (DstReg != SrcReg)
+    copyPhysReg(MBB, I, DL, DstReg, SrcReg, KillSrc);
+
+  if (Amt == 1 && !IsArith) {
+    if (Opc == M6502::SHL16ri) {
+      buildZPUpdate(MBB, I, DL, get(M6502::ASLzp), DstLo);
+      buildZPUpdate(MBB, I, DL, get(M6502::ROLzp), DstHi);
+    } else {
+      buildZPUpdate(MBB, I, DL, get(M6502::LSRzp), DstHi);
+      buildZPUpdate(MBB, I, DL, get(M6502::RORzp), DstLo);
+    }
+    return;
+  }
+
+  BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(DstHi);
+  for (int64_t N = 0; N < Amt; ++N) {
+    if (Opc == M6502::SHL16ri) {
+      buildZPUpdate(MBB, I, DL, get(M6502::ASLzp), DstLo);
+      BuildMI(MBB, I, DL, get(M6502::ROLacc));
+    } else {
+      buildShiftRightA(MBB, I, DL, IsArith);
+      buildZPUpdate(MBB, I, DL, get(M6502::RORzp), DstLo);
+    }
+  }
+  buildZPStore(MBB, I, DL, get(M6502::STAzp), DstHi);
+}
+
+/// Return the flag branch taken when CMP sets the condition CC.
+static unsigned getBranchOpc(M6502CC::CondCode CC) {
+  switch (CC) {
+  default: llvm_unreachable("Invalid condition code!");
+  case M6502CC::COND_EQ: return M6502::BEQ;
+  case M6502CC::COND_NE: return M6502::BNE;
+  case M6502CC::COND_LT: return M6502::BCC;
+  case M6502CC::COND_GE: return M6502::BCS;
+  case M6502CC::COND_MI: return M6502::BMI;
+  case M6502CC::COND_PL: return M6502::BPL;
+  case M6502CC::COND_VS: return M6502::BVS;
+  case M6502CC::COND_VC: return M6502::BVC;
+  }
+}
+
+void M6502SEInstrInfo::expandBrCC(MachineBasicBlock &MBB,
+                                 MachineBasicBlock::iterator I) const {
+  DebugLoc DL = I->getDebugLoc();
+  unsigned LHS = I->getOperand(0).getReg();
+  const MachineOperand &RHS = I->getOperand(1);
+  auto CC = static_cast<M6502CC::CondCode>(I->getOperand(2).getImm());
+  bool IsTest = RHS.isImm() && RHS.getImm() == 0;
+
+  if (M6502::ZP16RegClass.contains(LHS))
+    expandCompare16(MBB, I, LHS, RHS, CC);
+  else {
+    // Loading a byte already sets N and Z, so comparing with zero for them
+    // is free.
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(LHS);
+    if (!IsTest || CC == M6502CC::COND_LT || CC == M6502CC::COND_GE ||
+        CC == M6502CC::COND_VS || CC == M6502CC::COND_VC) {
+      if (RHS.isReg())
+        BuildMI(MBB, I, DL, get(M6502::CMPzp)).addReg(RHS.getReg());
+      else
+        BuildMI(MBB, I, DL, get(M6502::CMPimm)).addImm(RHS.getImm() & 0xff);
+    }
+  }
+
+  BuildMI(MBB, I, DL, get(getBranchOpc(CC))).add(I->getOperand(3));
+}
+
+// Pairs are ordered with a CMP of the low bytes followed by an SBC of the
+// high bytes, which leaves the carry of the whole 16-bit subtraction.  The Z
+// flag only reflects the high byte though, so equality is tested by OR-ing
+// together the differences of both bytes, using the scratch pointer to hold
+// the low one.  A 16-bit A on the 65816 compares both bytes at once, which
+// leaves all of the flags right.
+void M6502SEInstrInfo::expandCompare16(MachineBasicBlock &MBB,
+                                      MachineBasicBlock::iterator I,
+                                      unsigned LHS, const MachineOperand &RHS,
+                                      M6502CC::CondCode CC) const {
+  DebugLoc DL = I->getDebugLoc();
+
+  if (Subtarget.is65816()) {
+    // Loading the word already sets Z for a test against zero.
+    BuildMI(MBB, I, DL, get(M6502::LDAzpW)).addReg(LHS);
+    if (RHS.isReg())
+      BuildMI(MBB, I, DL, get(M6502::CMPzpW)).addReg(RHS.getReg());
+    else if ((RHS.getImm() & 0xffff) || CC == M6502CC::COND_LT ||
+             CC == M6502CC::COND_GE)
+      BuildMI(MBB, I, DL, get(M6502::CMPimmW)).addImm(RHS.getImm() & 0xffff);
+    return;
+  }
+
+  unsigned LHSLo = RI.getSubReg(LHS, M6502::sub_lo);
+  unsigned LHSHi = RI.getSubReg(LHS, M6502::sub_hi);
+  unsigned RHSLo = 0, RHSHi = 0;
+  uint64_t ImmLo = 0, ImmHi = 0;
+
+  if (RHS.isReg()) {
+    RHSLo = RI.getSubReg(RHS.getReg(), M6502::sub_lo);
+    RHSHi = RI.getSubReg(RHS.getReg(), M6502::sub_hi);
+  } else {
+    ImmLo = RHS.getImm() & 0xff;
+    ImmHi = (RHS.getImm() >> 8) & 0xff;
+  }
+
+  if (CC == M6502CC::COND_LT || CC == M6502CC::COND_GE) {
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(LHSLo);
+    if (RHS.isReg())
+      BuildMI(MBB, I, DL, get(M6502::CMPzp)).addReg(RHSLo);
+    else
+      BuildMI(MBB, I, DL, get(M6502::CMPimm)).addImm(ImmLo);
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(LHSHi);
+    if (RHS.isReg())
+      BuildMI(MBB, I, DL, get(M6502::SBCzp)).addReg(RHSHi);
+    else
+      BuildMI(MBB, I, DL, get(M6502::SBCimm)).addImm(ImmHi);
+    return;
+  }
+
+  assert((CC == M6502CC::COND_EQ || CC == M6502CC::COND_NE) &&
+         "Unexpected 16-bit condition!");
+
+  // Comparing with a constant whose low byte is zero needs no scratch byte.
+  if (RHS.isImm() && ImmLo == 0) {
+    BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(LHSHi);
+    if (ImmHi)
+      BuildMI(MBB, I, DL, get(M6502::EORimm)).addImm(ImmHi);
+    BuildMI(MBB, I, DL, get(M6502::ORAzp)).addReg(LHSLo);
+    return;
+  }
+
+  unsigned Scratch =
+      RI.getSubReg(Subtarget.getABI().GetScratchPtr(), M6502::sub_lo);
+
+  BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(LHSLo);
+  if (RHS.isReg())
+    BuildMI(MBB, I, DL, get(M6502::EORzp)).addReg(RHSLo);
+  else
+    BuildMI(MBB, I, DL, get(M6502::EORimm)).addImm(ImmLo);
+  buildZPStore(MBB, I, DL, get(M6502::STAzp), Scratch);
+  BuildMI(MBB, I, DL, get(M6502::LDAzp)).addReg(LHSHi);
+  if (RHS.isReg())
+    BuildMI(MBB, I, DL, get(M6502::EORzp)).addReg(RHSHi);
+  else if (ImmHi)
+    BuildMI(MBB, I, DL, get(M6502::EORimm)).addImm(ImmHi);
+  BuildMI(MBB, I, DL, get(M6502::ORAzp)).addReg(Scratch);
 }
 
 const M6502InstrInfo *llvm::createM6502SEInstrInfo(const M6502Subtarget &STI) {
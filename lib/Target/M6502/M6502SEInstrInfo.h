@@ -1,4 +1,4 @@
-//===-- M6502SEInstrInfo.h - M650232/64 Instruction Information ---*- C++ -*-===//
+//===-- M6502SEInstrInfo.h - M6502 Instruction Information ------*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -7,13 +7,14 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file contains the M650232/64 implementation of the TargetInstrInfo class.
+// This file contains the M6502 implementation of the TargetInstrInfo class.
 //
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_LIB_TARGET_M6502_M6502SEINSTRINFO_H
 #define LLVM_LIB_TARGET_M6502_M6502SEINSTRINFO_H
 
+#include "MCTargetDesc/M6502BaseInfo.h"
 #include "M6502InstrInfo.h"
 #include "M6502SERegisterInfo.h"
 
@@ -69,49 +70,60 @@ public:
   void adjustStackPtr(unsigned SP, int64_t Amount, MachineBasicBlock &MBB,
                       MachineBasicBlock::iterator I) const override;
 
-  /// Emit a series of instructions to load an immediate. If NewImm is a
-  /// non-NULL parameter, the last instruction is not emitted, but instead
-  /// its immediate operand is returned in NewImm.
-  unsigned loadImmediate(int64_t Imm, MachineBasicBlock &MBB,
-                         MachineBasicBlock::iterator II, const DebugLoc &DL,
-                         unsigned *NewImm) const;
+  /// Emit the instructions setting the register pair DstReg to SrcReg plus
+  /// Amount.  The carry flag and A are clobbered.
+  void adjustPtr(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                 const DebugLoc &DL, unsigned DstReg, unsigned SrcReg,
+                 int64_t Amount) const;
 
 private:
   unsigned getAnalyzableBrOpc(unsigned Opc) const override;
 
-  void expandRetRA(MachineBasicBlock &MBB, MachineBasicBlock::iterator I) const;
-
-  void expandERet(MachineBasicBlock &MBB, MachineBasicBlock::iterator I) const;
-
-  std::pair<bool, bool> compareOpndSize(unsigned Opc,
-                                        const MachineFunction &MF) const;
-
-  void expandPseudoMFHiLo(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
-                          unsigned NewOpc) const;
-
-  void expandPseudoMTLoHi(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
-                          unsigned LoOpc, unsigned HiOpc,
-                          bool HasExplicitDef) const;
-
-  /// Expand pseudo Int-to-FP conversion instructions.
-  ///
-  /// For example, the following pseudo instruction
-  ///  PseudoCVT_D32_W D2, A5
-  /// gets expanded into these two instructions:
-  ///  MTC1 F4, A5
-  ///  CVT_D32_W D2, F4
-  ///
-  /// We do this expansion post-RA to avoid inserting a floating point copy
-  /// instruction between MTC1 and CVT_D32_W.
-  void expandCvtFPInt(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
-                      unsigned CvtOpc, unsigned MovOpc, bool IsI64) const;
-
-  void expandExtractElementF64(MachineBasicBlock &MBB,
-                               MachineBasicBlock::iterator I, bool FP64) const;
-  void expandBuildPairF64(MachineBasicBlock &MBB,
-                          MachineBasicBlock::iterator I, bool FP64) const;
-  void expandEhReturn(MachineBasicBlock &MBB,
+  void expandLoadImm(MachineBasicBlock &MBB,
+                     MachineBasicBlock::iterator I) const;
+
+  void expandLoadAddr(MachineBasicBlock &MBB,
                       MachineBasicBlock::iterator I) const;
+
+  void expandLoadStore(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                       bool IsStore, bool Is16) const;
+
+  void expandLoadStoreAbs(MachineBasicBlock &MBB,
+                          MachineBasicBlock::iterator I, bool IsStore,
+                          bool Is16) const;
+
+  /// Expand an arithmetic or logic pseudo into a byte wise sequence of Opc
+  /// (zero page form) or OpcImm (immediate form), preceded by FlagOpc when
+  /// the operation starts a carry chain.
+  void expandArith(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                   unsigned Opc, unsigned OpcImm, unsigned FlagOpc) const;
+
+  void buildShiftRightA(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                        const DebugLoc &DL, bool IsArith) const;
+
+  void buildSignFillA(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                      const DebugLoc &DL) const;
+
+  void expandExtend(MachineBasicBlock &MBB,
+                    MachineBasicBlock::iterator I) const;
+
+  void expandShift8(MachineBasicBlock &MBB,
+                    MachineBasicBlock::iterator I) const;
+
+  void expandShift16(MachineBasicBlock &MBB,
+                     MachineBasicBlock::iterator I) const;
+
+  void expandBrCC(MachineBasicBlock &MBB, MachineBasicBlock::iterator I) const;
+
+  /// Load the arguments of a call which are passed in A, X and Y from its
+  /// zero page register operands, and turn CALL into a JSR.
+  void expandCall(MachineBasicBlock &MBB, MachineBasicBlock::iterator I) const;
+
+  /// Set the flags for the condition CC of a comparison of the register
+  /// pair LHS with RHS.
+  void expandCompare16(MachineBasicBlock &MBB, MachineBasicBlock::iterator I,
+                       unsigned LHS, const MachineOperand &RHS,
+                       M6502CC::CondCode CC) const;
 };
 
 }
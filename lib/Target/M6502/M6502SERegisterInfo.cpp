@@ -1,4 +1,4 @@
-//===-- M6502SERegisterInfo.cpp - M650232/64 Register Information -== -------===//
+//===-- M6502SERegisterInfo.cpp - M650232/64 Register Information -== -----===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -43,104 +43,77 @@ M6502SERegisterInfo::M6502SERegisterInfo() : M6502RegisterInfo() {}
 
 bool M6502SERegisterInfo::
 requiresRegisterScavenging(const MachineFunction &MF) const {
-  return true;
+  // Large frame offsets are materialized in the reserved scratch pointer.
+  return false;
 }
 
 bool M6502SERegisterInfo::
 requiresFrameIndexScavenging(const MachineFunction &MF) const {
-  return true;
+  return false;
 }
 
 const TargetRegisterClass *
 M6502SERegisterInfo::intRegClass(unsigned Size) const {
-  if (Size == 4)
-    return &M6502::GPR32RegClass;
+  if (Size == 1)
+    return &M6502::ZP8RegClass;
 
-  assert(Size == 8);
-  return &M6502::GPR64RegClass;
+  assert(Size == 2);
+  return &M6502::ZP16RegClass;
 }
 
-/// Get the size of the offset supported by the given load/store/inline asm.
-/// The result includes the effects of any scale factors applied to the
-/// instruction immediate.
-static inline unsigned getLoadStoreOffsetSizeInBits(const unsigned Opcode,
-                                                    MachineOperand MO) {
+/// Return true if the offset of the memory operand of the given instruction
+/// has to fit in the Y index register.
+static inline bool isYIndexedOffset(const unsigned Opcode) {
   switch (Opcode) {
-  case M6502::LD_B:
-  case M6502::ST_B:
-    return 10;
-  case M6502::LD_H:
-  case M6502::ST_H:
-    return 10 + 1 /* scale factor */;
-  case M6502::LD_W:
-  case M6502::ST_W:
-    return 10 + 2 /* scale factor */;
-  case M6502::LD_D:
-  case M6502::ST_D:
-    return 10 + 3 /* scale factor */;
-  case M6502::LL:
-  case M6502::LL64:
-  case M6502::LLD:
-  case M6502::LLE:
-  case M6502::SC:
-  case M6502::SC64:
-  case M6502::SCD:
-  case M6502::SCE:
-    return 16;
-  case M6502::LLE_MM:
-  case M6502::LLE_MMR6:
-  case M6502::LL_MM:
-  case M6502::SCE_MM:
-  case M6502::SCE_MMR6:
-  case M6502::SC_MM:
-    return 12;
-  case M6502::LL64_R6:
-  case M6502::LL_R6:
-  case M6502::LLD_R6:
-  case M6502::SC64_R6:
-  case M6502::SCD_R6:
-  case M6502::SC_R6:
-    return 9;
-  case M6502::INLINEASM: {
-    unsigned ConstraintID = InlineAsm::getMemoryConstraintID(MO.getImm());
-    switch (ConstraintID) {
-    case InlineAsm::Constraint_ZC: {
-      const M6502Subtarget &Subtarget = MO.getParent()
-                                           ->getParent()
-                                           ->getParent()
-                                           ->getSubtarget<M6502Subtarget>();
-      if (Subtarget.inMicroM6502Mode())
-        return 12;
-
-      if (Subtarget.hasM650232r6())
-        return 9;
-
-      return 16;
-    }
-    default:
-      return 16;
-    }
-  }
+  case M6502::LD8:
+  case M6502::LD16:
+  case M6502::ST8:
+  case M6502::ST16:
+    return true;
   default:
-    return 16;
+    return false;
   }
 }
 
-/// Get the scale factor applied to the immediate in the given load/store.
-static inline unsigned getLoadStoreOffsetAlign(const unsigned Opcode) {
+/// Return the absolute addressing form of a pseudo instruction addressing
+/// the frame.
+static unsigned getStaticFrameOpcode(unsigned Opcode) {
   switch (Opcode) {
-  case M6502::LD_H:
-  case M6502::ST_H:
-    return 2;
-  case M6502::LD_W:
-  case M6502::ST_W:
-    return 4;
-  case M6502::LD_D:
-  case M6502::ST_D:
-    return 8;
+  case M6502::LD8:   return M6502::LD8abs;
+  case M6502::LD16:  return M6502::LD16abs;
+  case M6502::ST8:   return M6502::ST8abs;
+  case M6502::ST16:  return M6502::ST16abs;
+  case M6502::LEA16: return M6502::LDaddr16;
   default:
-    return 1;
+    llvm_unreachable("Unexpected frame index user");
+  }
+}
+
+/// Rewrite a frame access of a function whose frame has a fixed address
+/// into an access to the frame symbol plus Offset.
+static void eliminateStaticFI(MachineBasicBlock::iterator II, unsigned OpNo,
+                              int64_t Offset) {
+  MachineInstr &MI = *II;
+  MachineFunction &MF = *MI.getParent()->getParent();
+
+  if (MI.isDebugValue()) {
+    // The location is not described in terms of the frame symbol yet.
+    MI.getOperand(OpNo).ChangeToRegister(0, false);
+    return;
   }
+
+  const TargetInstrInfo &TII = *MF.getSubtarget().getInstrInfo();
+  MachineOperand Addr = MachineOperand::CreateMCSymbol(
+      MF.getInfo<M6502FunctionInfo>()->getStaticFrameSymbol());
+  Addr.setOffset(Offset);
+
+  assert(OpNo == 1 && "Frame index is not the address of the pseudo");
+  BuildMI(*MI.getParent(), II, MI.getDebugLoc(),
+          TII.get(getStaticFrameOpcode(MI.getOpcode())))
+      .add(MI.getOperand(0))
+      .add(Addr)
+      .setMemRefs(MI.memoperands_begin(), MI.memoperands_end());
+  MI.eraseFromParent();
 }
 
 void M6502SERegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
@@ -149,14 +122,11 @@ void M6502SERegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
                                      int64_t SPOffset) const {
   MachineInstr &MI = *II;
   MachineFunction &MF = *MI.getParent()->getParent();
-  MachineFrameInfo &MFI = MF.getFrameInfo();
-  M6502FunctionInfo *M6502FI = MF.getInfo<M6502FunctionInfo>();
 
   M6502ABIInfo ABI =
       static_cast<const M6502TargetMachine &>(MF.getTarget()).getABI();
-  const M6502RegisterInfo *RegInfo =
-    static_cast<const M6502RegisterInfo *>(MF.getSubtarget().getRegisterInfo());
 
+  MachineFrameInfo &MFI = MF.getFrameInfo();
   const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
   int MinCSFI = 0;
   int MaxCSFI = -1;
@@ -166,38 +136,16 @@ void M6502SERegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
     MaxCSFI = CSI[CSI.size() - 1].getFrameIdx();
   }
 
-  bool EhDataRegFI = M6502FI->isEhDataRegFI(FrameIndex);
-  bool IsISRRegFI = M6502FI->isISRRegFI(FrameIndex);
-  // The following stack frame objects are always referenced relative to $sp:
-  //  1. Outgoing arguments.
-  //  2. Pointer to dynamically allocated stack space.
-  //  3. Locations for callee-saved registers.
-  //  4. Locations for eh data registers.
-  //  5. Locations for ISR saved Coprocessor 0 registers 12 & 14.
-  // Everything else is referenced relative to whatever register
+  // The locations of callee-saved registers are always referenced relative
+  // to the stack pointer, since they are saved before the frame pointer is
+  // set up.  Everything else is referenced relative to whatever register
   // getFrameRegister() returns.
   unsigned FrameReg;
 
-  if ((FrameIndex >= MinCSFI && FrameIndex <= MaxCSFI) || EhDataRegFI ||
-      IsISRRegFI)
+  if (FrameIndex >= MinCSFI && FrameIndex <= MaxCSFI)
     FrameReg = ABI.GetStackPtr();
-  else if (RegInfo->needsStackRealignment(MF)) {
-    if (MFI.hasVarSizedObjects() && !MFI.isFixedObjectIndex(FrameIndex))
-      FrameReg = ABI.GetBasePtr();
-    else if (MFI.isFixedObjectIndex(FrameIndex))
-      FrameReg = getFrameRegister(MF);
-    else
-      FrameReg = ABI.GetStackPtr();
-  } else
+  else
     FrameReg = getFrameRegister(MF);
-
-  // Calculate final offset.
-  // - There is no need to change the offset if the frame object is one of the
-  //   following: an outgoing argument, pointer to a dynamically allocated
-  //   stack space or a $gp restore location,
-  // - If the frame object is any of the following, its offset must be adjusted
-  //   by adding the size of the stack:
-  //   incoming argument, callee-saved register location or local variable.
   bool IsKill = false;
   int64_t Offset;
 
@@ -206,53 +154,30 @@ void M6502SERegisterInfo::eliminateFI(MachineBasicBlock::iterator II,
 
   DEBUG(errs() << "Offset     : " << Offset << "\n" << "<--------->\n");
 
-  if (!MI.isDebugValue()) {
-    // Make sure Offset fits within the field available.
-    // For MSA instructions, this is a 10-bit signed immediate (scaled by
-    // element size), otherwise it is a 16-bit signed immediate.
-    unsigned OffsetBitSize =
-        getLoadStoreOffsetSizeInBits(MI.getOpcode(), MI.getOperand(OpNo - 1));
-    unsigned OffsetAlign = getLoadStoreOffsetAlign(MI.getOpcode());
-
-    if (OffsetBitSize < 16 && isInt<16>(Offset) &&
-        (!isIntN(OffsetBitSize, Offset) ||
-         OffsetToAlignment(Offset, OffsetAlign) != 0)) {
-      // If we have an offset that needs to fit into a signed n-bit immediate
-      // (where n < 16) and doesn't, but does fit into 16-bits then use an ADDiu
-      MachineBasicBlock &MBB = *MI.getParent();
-      DebugLoc DL = II->getDebugLoc();
-      const TargetRegisterClass *PtrRC =
-          ABI.ArePtrs64bit() ? &M6502::GPR64RegClass : &M6502::GPR32RegClass;
-      MachineRegisterInfo &RegInfo = MBB.getParent()->getRegInfo();
-      unsigned Reg = RegInfo.createVirtualRegister(PtrRC);
-      const M6502SEInstrInfo &TII =
-          *static_cast<const M6502SEInstrInfo *>(
-              MBB.getParent()->getSubtarget().getInstrInfo());
-      BuildMI(MBB, II, DL, TII.get(ABI.GetPtrAddiuOp()), Reg)
-          .addReg(FrameReg)
-          .addImm(Offset);
-
-      FrameReg = Reg;
-      Offset = 0;
-      IsKill = true;
-    } else if (!isInt<16>(Offset)) {
-      // Otherwise split the offset into 16-bit pieces and add it in multiple
-      // instructions.
-      MachineBasicBlock &MBB = *MI.getParent();
-      DebugLoc DL = II->getDebugLoc();
-      unsigned NewImm = 0;
-      const M6502SEInstrInfo &TII =
-          *static_cast<const M6502SEInstrInfo *>(
-              MBB.getParent()->getSubtarget().getInstrInfo());
-      unsigned Reg = TII.loadImmediate(Offset, MBB, II, DL,
-                                       OffsetBitSize == 16 ? &NewImm : nullptr);
-      BuildMI(MBB, II, DL, TII.get(ABI.GetPtrAdduOp()), Reg).addReg(FrameReg)
-        .addReg(Reg, RegState::Kill);
+  if (MF.getInfo<M6502FunctionInfo>()->hasStaticFrame()) {
+    eliminateStaticFI(II, OpNo, Offset);
+    return;
+  }
 
-      FrameReg = Reg;
-      Offset = SignExtend64<16>(NewImm);
-      IsKill = true;
-    }
+  if (!MI.isDebugValue() && isYIndexedOffset(MI.getOpcode()) &&
+      !isUInt<8>(Offset)) {
+    // The offset does not fit in Y: compute the address in the scratch
+    // pointer.  The carry may be live across a load or store, so it is saved
+    // on the hardware stack around the addition.
+    MachineBasicBlock &MBB = *MI.getParent();
+    DebugLoc DL = II->getDebugLoc();
+    const M6502SEInstrInfo &TII =
+        *static_cast<const M6502SEInstrInfo *>(
+            MBB.getParent()->getSubtarget().getInstrInfo());
+    unsigned Reg = ABI.GetScratchPtr();
+
+    BuildMI(MBB, II, DL, TII.get(M6502::PHP));
+    TII.adjustPtr(MBB, II, DL, Reg, FrameReg, Offset);
+    BuildMI(MBB, II, DL, TII.get(M6502::PLP));
+
+    FrameReg = Reg;
+    Offset = 0;
+    IsKill = true;
   }
 
   MI.getOperand(OpNo).ChangeToRegister(FrameReg, false, false, IsKill);
@@ -0,0 +1,58 @@
+//===-- M6502SelectionDAGInfo.cpp - M6502 SelectionDAG Info ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the M6502SelectionDAGInfo class.
+//
+// A copy or fill of a known size which is too long for the generic expansion
+// into loads and stores becomes a MemCpy or MemSet node, which the custom
+// inserter expands into byte loops indexed by X or Y.  A call to the runtime
+// library would cost more than the loop just to pass its three arguments.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502SelectionDAGInfo.h"
+#include "M6502ISelLowering.h"
+#include "llvm/CodeGen/SelectionDAG.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-selectiondag-info"
+
+/// Return the size of a copy or fill which can be expanded inline, or 0.
+static uint64_t getInlineSize(SDValue Size) {
+  auto *C = dyn_cast<ConstantSDNode>(Size);
+  if (!C || C->getZExtValue() > 0xffff)
+    return 0;
+  return C->getZExtValue();
+}
+
+SDValue M6502SelectionDAGInfo::EmitTargetCodeForMemcpy(
+    SelectionDAG &DAG, const SDLoc &dl, SDValue Chain, SDValue Dst, SDValue Src,
+    SDValue Size, unsigned Align, bool isVolatile, bool AlwaysInline,
+    MachinePointerInfo DstPtrInfo, MachinePointerInfo SrcPtrInfo) const {
+  uint64_t Bytes = getInlineSize(Size);
+  if (!Bytes)
+    return SDValue();
+
+  return DAG.getNode(M6502ISD::MemCpy, dl, MVT::Other, Chain, Dst, Src,
+                     DAG.getTargetConstant(Bytes, dl, MVT::i16));
+}
+
+SDValue M6502SelectionDAGInfo::EmitTargetCodeForMemset(
+    SelectionDAG &DAG, const SDLoc &dl, SDValue Chain, SDValue Dst, SDValue Val,
+    SDValue Size, unsigned Align, bool isVolatile,
+    MachinePointerInfo DstPtrInfo) const {
+  uint64_t Bytes = getInlineSize(Size);
+  if (!Bytes)
+    return SDValue();
+
+  return DAG.getNode(M6502ISD::MemSet, dl, MVT::Other, Chain, Dst,
+                     DAG.getZExtOrTrunc(Val, dl, MVT::i8),
+                     DAG.getTargetConstant(Bytes, dl, MVT::i16));
+}
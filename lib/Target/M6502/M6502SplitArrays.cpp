@@ -0,0 +1,275 @@
+//===- M6502SplitArrays.cpp - Split word arrays into byte arrays ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// An element of an array of words is found by doubling the index and adding
+// it to the address of the array, which takes a dozen instructions, whereas
+// an element of an array of at most 256 bytes is read with a single indexed
+// LDA.  This pass splits the arrays of at most 256 16 bit integers or
+// pointers whose address is only used to load and store whole elements into
+// an array of the low bytes and one of the high bytes, and makes each access
+// two byte accesses with the same index.
+//
+// Only arrays defined in this module, which no other module can see, are
+// split, and only when one access at least has a variable index.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-split-arrays"
+
+STATISTIC(NumArraysSplit, "Number of word arrays split into byte arrays");
+STATISTIC(NumAccessesSplit, "Number of word accesses split into bytes");
+
+static cl::opt<bool>
+SplitArrays("m6502-split-arrays", cl::Hidden, cl::init(true),
+            cl::desc("Split arrays of words into arrays of low and high "
+                     "bytes (default=on)"));
+
+namespace {
+
+  /// A load or store of an element of an array, and the index of the
+  /// element.
+  struct ElementAccess {
+    Instruction *I;
+    Value *Index;
+    bool InBounds;
+  };
+
+  class M6502SplitArrays : public ModulePass {
+  public:
+    static char ID;
+
+    M6502SplitArrays() : ModulePass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Split Word Arrays";
+    }
+
+    bool runOnModule(Module &M) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesCFG();
+      ModulePass::getAnalysisUsage(AU);
+    }
+
+  private:
+    bool collectAccesses(GlobalVariable &GV,
+                         SmallVectorImpl<ElementAccess> &Accesses);
+    Constant *splitInitializer(Constant *Init, bool High);
+    void splitAccess(const ElementAccess &Access, GlobalVariable *Lo,
+                     GlobalVariable *Hi);
+  };
+
+} // end anonymous namespace
+
+char M6502SplitArrays::ID = 0;
+
+/// Return true if I loads or stores a whole element of type EltTy at Ptr.
+static bool isElementAccess(const User *U, const Value *Ptr, Type *EltTy) {
+  if (auto *LI = dyn_cast<LoadInst>(U))
+    return LI->isSimple() && LI->getType() == EltTy;
+  if (auto *SI = dyn_cast<StoreInst>(U))
+    return SI->isSimple() && SI->getPointerOperand() == Ptr &&
+           SI->getValueOperand()->getType() == EltTy;
+  return false;
+}
+
+/// Fill Accesses with the loads and stores of the elements of GV, which must
+/// be the only uses of its address.  Return false if there are others.
+bool M6502SplitArrays::collectAccesses(
+    GlobalVariable &GV, SmallVectorImpl<ElementAccess> &Accesses) {
+  auto *ArrTy = cast<ArrayType>(GV.getValueType());
+  Type *EltTy = ArrTy->getElementType();
+
+  for (User *U : GV.users()) {
+    // &GV[0][Idx], as an instruction or a constant.
+    auto *GEP = dyn_cast<GEPOperator>(U);
+    if (!GEP || GEP->getPointerOperand() != &GV ||
+        GEP->getSourceElementType() != ArrTy || GEP->getNumIndices() != 2)
+      return false;
+    auto *First = dyn_cast<ConstantInt>(GEP->getOperand(1));
+    if (!First || !First->isZero())
+      return false;
+
+    for (User *GEPUser : GEP->users()) {
+      if (!isa<Instruction>(GEPUser) || !isElementAccess(GEPUser, GEP, EltTy))
+        return false;
+      Accesses.push_back({cast<Instruction>(GEPUser), GEP->getOperand(2),
+                          GEP->isInBounds()});
+    }
+  }
+  return true;
+}
+
+/// Return the array of the low or the high bytes of the elements of Init.
+Constant *M6502SplitArrays::splitInitializer(Constant *Init, bool High) {
+  auto *ArrTy = cast<ArrayType>(Init->getType());
+  LLVMContext &Ctx = Init->getContext();
+  Type *Int8Ty = Type::getInt8Ty(Ctx);
+  Type *Int16Ty = Type::getInt16Ty(Ctx);
+
+  SmallVector<Constant *, 256> Bytes;
+  for (unsigned Idx = 0, E = ArrTy->getNumElements(); Idx != E; ++Idx) {
+    Constant *Elt = Init->getAggregateElement(Idx);
+    if (isa<UndefValue>(Elt)) {
+      Bytes.push_back(UndefValue::get(Int8Ty));
+      continue;
+    }
+
+    // A pointer to a symbol is split by the assembler, with < and >.
+    if (Elt->getType()->isPointerTy())
+      Elt = ConstantExpr::getPtrToInt(Elt, Int16Ty);
+    if (High)
+      Elt = ConstantExpr::getLShr(Elt, ConstantInt::get(Int16Ty, 8));
+    Bytes.push_back(ConstantExpr::getTrunc(Elt, Int8Ty));
+  }
+  return ConstantArray::get(ArrayType::get(Int8Ty, Bytes.size()), Bytes);
+}
+
+/// Replace the element access by two accesses to the same element of Lo and
+/// Hi.
+void M6502SplitArrays::splitAccess(const ElementAccess &Access,
+                                   GlobalVariable *Lo, GlobalVariable *Hi) {
+  IRBuilder<> Builder(Access.I);
+  Type *Int8Ty = Builder.getInt8Ty();
+  Type *Int16Ty = Builder.getInt16Ty();
+
+  // An index out of bounds of an inbounds GEP gives an undefined pointer, so
+  // the index may be taken as a byte, which the indexed addressing modes can
+  // use.
+  Value *Index = Access.Index;
+  if (Access.InBounds && !isa<Constant>(Index) &&
+      Index->getType()->getPrimitiveSizeInBits() > 8) {
+    auto *ZExt = dyn_cast<ZExtInst>(Index);
+    if (!ZExt || ZExt->getSrcTy() != Int8Ty)
+      Index = Builder.CreateZExt(Builder.CreateTrunc(Index, Int8Ty), Int16Ty);
+  }
+
+  Value *Zero = Constant::getNullValue(Index->getType());
+  Value *LoPtr, *HiPtr;
+  if (Access.InBounds) {
+    LoPtr = Builder.CreateInBoundsGEP(Lo->getValueType(), Lo, {Zero, Index});
+    HiPtr = Builder.CreateInBoundsGEP(Hi->getValueType(), Hi, {Zero, Index});
+  } else {
+    LoPtr = Builder.CreateGEP(Lo->getValueType(), Lo, {Zero, Index});
+    HiPtr = Builder.CreateGEP(Hi->getValueType(), Hi, {Zero, Index});
+  }
+
+  if (auto *LI = dyn_cast<LoadInst>(Access.I)) {
+    Value *LoByte = Builder.CreateLoad(LoPtr, LI->getName() + ".lo");
+    Value *HiByte = Builder.CreateLoad(HiPtr, LI->getName() + ".hi");
+    Value *Word = Builder.CreateOr(
+        Builder.CreateZExt(LoByte, Int16Ty),
+        Builder.CreateShl(Builder.CreateZExt(HiByte, Int16Ty), 8));
+    if (LI->getType()->isPointerTy())
+      Word = Builder.CreateIntToPtr(Word, LI->getType());
+    Word->takeName(LI);
+    LI->replaceAllUsesWith(Word);
+  } else {
+    auto *SI = cast<StoreInst>(Access.I);
+    Value *Word = SI->getValueOperand();
+    if (Word->getType()->isPointerTy())
+      Word = Builder.CreatePtrToInt(Word, Int16Ty);
+    Builder.CreateStore(Builder.CreateTrunc(Word, Int8Ty), LoPtr);
+    Builder.CreateStore(
+        Builder.CreateTrunc(Builder.CreateLShr(Word, 8), Int8Ty), HiPtr);
+  }
+  Access.I->eraseFromParent();
+  ++NumAccessesSplit;
+}
+
+bool M6502SplitArrays::runOnModule(Module &M) {
+  if (skipModule(M) || !SplitArrays)
+    return false;
+
+  const DataLayout &DL = M.getDataLayout();
+  SmallVector<GlobalVariable *, 8> Worklist;
+  for (GlobalVariable &GV : M.globals())
+    Worklist.push_back(&GV);
+
+  bool Changed = false;
+  for (GlobalVariable *GV : Worklist) {
+    if (!GV->hasLocalLinkage() || !GV->hasDefinitiveInitializer() ||
+        GV->hasSection() || GV->isThreadLocal())
+      continue;
+
+    auto *ArrTy = dyn_cast<ArrayType>(GV->getValueType());
+    if (!ArrTy || ArrTy->getNumElements() == 0 ||
+        ArrTy->getNumElements() > 256)
+      continue;
+    Type *EltTy = ArrTy->getElementType();
+    if ((!EltTy->isIntegerTy(16) && !EltTy->isPointerTy()) ||
+        DL.getTypeAllocSize(EltTy) != 2)
+      continue;
+
+    GV->removeDeadConstantUsers();
+    SmallVector<ElementAccess, 16> Accesses;
+    if (!collectAccesses(*GV, Accesses) ||
+        none_of(Accesses, [](const ElementAccess &Access) {
+          return !isa<Constant>(Access.Index);
+        }))
+      continue;
+
+    DEBUG(dbgs() << "Splitting " << GV->getName() << " with "
+                 << Accesses.size() << " accesses\n");
+
+    Constant *Init = GV->getInitializer();
+    GlobalVariable *Halves[2];
+    for (unsigned High = 0; High != 2; ++High) {
+      Constant *HalfInit = splitInitializer(Init, High);
+      auto *Half = new GlobalVariable(
+          M, HalfInit->getType(), GV->isConstant(), GV->getLinkage(),
+          HalfInit, GV->getName() + (High ? ".hi" : ".lo"), GV);
+      Half->setUnnamedAddr(GV->getUnnamedAddr());
+      Halves[High] = Half;
+    }
+
+    for (const ElementAccess &Access : Accesses)
+      splitAccess(Access, Halves[0], Halves[1]);
+
+    // Only the GEPs of the accesses are left.
+    SmallVector<Instruction *, 16> DeadGEPs;
+    for (User *U : GV->users())
+      if (auto *GEP = dyn_cast<GetElementPtrInst>(U))
+        DeadGEPs.push_back(GEP);
+    for (Instruction *GEP : DeadGEPs)
+      GEP->eraseFromParent();
+    GV->removeDeadConstantUsers();
+    assert(GV->use_empty() && "Split array still used");
+    GV->eraseFromParent();
+
+    ++NumArraysSplit;
+    Changed = true;
+  }
+
+  return Changed;
+}
+
+/// createM6502SplitArraysPass - Returns a pass that splits arrays of words
+/// accessed with an index into arrays of low and high bytes.
+ModulePass *llvm::createM6502SplitArraysPass() {
+  return new M6502SplitArrays();
+}
@@ -0,0 +1,100 @@
+//===- M6502StaticFrame.cpp - Find functions with a static frame ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass marks the functions whose frame may live at a fixed address
+// instead of on the software stack.  A function which can never be active
+// twice at the same time needs a single copy of its frame, and the frames of
+// functions which are never active together can share memory.  The frame
+// lowering then addresses the locals of such a function absolutely, which
+// removes the stack pointer adjustments and the (zp),Y accesses, and the asm
+// printer overlays the frames once the whole module has been compiled.
+//
+// The module is taken to be the whole program: a function is static unless
+// it can reach itself through the calls in this module, as M6502CallGraph
+// sees them, or its address is taken.  Code outside the module may call such
+// a function back while the frames it would share memory with are in use.
+//
+// An interrupt handler starts a call chain of its own, which may begin in
+// the middle of any other.  A function reachable from a handler keeps a
+// static frame only if nothing outside the functions the handler reaches
+// calls it, and the asm printer keeps the frames of each handler apart from
+// all others.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502CallGraph.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-static-frame"
+
+STATISTIC(NumStaticFrames, "Number of functions given a static frame");
+
+namespace {
+
+  class M6502StaticFrame : public ModulePass {
+  public:
+    static char ID;
+
+    M6502StaticFrame() : ModulePass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Static Frame Analysis";
+    }
+
+    bool runOnModule(Module &M) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesAll();
+      ModulePass::getAnalysisUsage(AU);
+    }
+  };
+
+} // end anonymous namespace
+
+char M6502StaticFrame::ID = 0;
+
+bool M6502StaticFrame::runOnModule(Module &M) {
+  if (skipModule(M))
+    return false;
+
+  M6502CallGraph CG(M);
+
+  SmallPtrSet<Function *, 16> Shared;
+  CG.findSharedWithInterrupts(Shared);
+
+  bool Changed = false;
+  for (Function &F : M) {
+    // Variadic arguments are always passed on the stack.
+    if (F.isDeclaration() || F.isVarArg() || F.hasAddressTaken() ||
+        CG.isRecursive(&F) || Shared.count(&F))
+      continue;
+
+    DEBUG(dbgs() << "Static frame: " << F.getName() << "\n");
+    F.addFnAttr("m6502-static-frame");
+    ++NumStaticFrames;
+    Changed = true;
+  }
+
+  return Changed;
+}
+
+/// createM6502StaticFramePass - Returns a pass that marks the functions
+/// whose frame can be allocated statically.
+ModulePass *llvm::createM6502StaticFramePass() {
+  return new M6502StaticFrame();
+}
@@ -1,4 +1,4 @@
-//===- M6502TargetMachine.h - Define TargetMachine for M6502 ------*- C++ -*-===//
+//===- M6502TargetMachine.h - Define TargetMachine for M6502 ----*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -26,14 +26,11 @@
 namespace llvm {
 
 class M6502TargetMachine : public LLVMTargetMachine {
-  bool isLittle;
   std::unique_ptr<TargetLoweringObjectFile> TLOF;
   // Selected ABI
   M6502ABIInfo ABI;
   M6502Subtarget *Subtarget;
   M6502Subtarget DefaultSubtarget;
-  M6502Subtarget NoM650216Subtarget;
-  M6502Subtarget M650216Subtarget;
 
   mutable StringMap<std::unique_ptr<M6502Subtarget>> SubtargetMap;
 
@@ -41,7 +38,7 @@ public:
   M6502TargetMachine(const Target &T, const Triple &TT, StringRef CPU,
                     StringRef FS, const TargetOptions &Options,
                     Optional<Reloc::Model> RM, Optional<CodeModel::Model> CM,
-                    CodeGenOpt::Level OL, bool JIT, bool isLittle);
+                    CodeGenOpt::Level OL, bool JIT);
   ~M6502TargetMachine() override;
 
   TargetIRAnalysis getTargetIRAnalysis() override;
@@ -64,36 +61,15 @@ public:
     return TLOF.get();
   }
 
-  bool isLittleEndian() const { return isLittle; }
   const M6502ABIInfo &getABI() const { return ABI; }
 
   bool isMachineVerifierClean() const override {
     return false;
   }
-};
-
-/// M650232/64 big endian target machine.
-///
-class M6502ebTargetMachine : public M6502TargetMachine {
-  virtual void anchor();
 
-public:
-  M6502ebTargetMachine(const Target &T, const Triple &TT, StringRef CPU,
-                      StringRef FS, const TargetOptions &Options,
-                      Optional<Reloc::Model> RM, Optional<CodeModel::Model> CM,
-                      CodeGenOpt::Level OL, bool JIT);
-};
-
-/// M650232/64 little endian target machine.
-///
-class M6502elTargetMachine : public M6502TargetMachine {
-  virtual void anchor();
-
-public:
-  M6502elTargetMachine(const Target &T, const Triple &TT, StringRef CPU,
-                      StringRef FS, const TargetOptions &Options,
-                      Optional<Reloc::Model> RM, Optional<CodeModel::Model> CM,
-                      CodeGenOpt::Level OL, bool JIT);
+  // The register masks of calls describe what the callee really changes, so
+  // an interrupt handler saves no more than the code it runs overwrites.
+  bool useIPRA() const override { return true; }
 };
 
 } // end namespace llvm
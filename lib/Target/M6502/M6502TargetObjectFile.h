@@ -13,35 +13,32 @@
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 
 namespace llvm {
+class GlobalValue;
 class M6502TargetMachine;
   class M6502TargetObjectFile : public TargetLoweringObjectFileELF {
-    MCSection *SmallDataSection;
-    MCSection *SmallBSSSection;
+    MCSection *ZeroPageDataSection;
+    MCSection *ZeroPageBSSSection;
     const M6502TargetMachine *TM;
 
-    bool IsGlobalInSmallSection(const GlobalObject *GO, const TargetMachine &TM,
-                                SectionKind Kind) const;
-    bool IsGlobalInSmallSectionImpl(const GlobalObject *GO,
-                                    const TargetMachine &TM) const;
   public:
+    /// Name of the section which places a variable in the zero page.  Both
+    /// the zero page allocator and the section attribute in the source use
+    /// it; the variable is then emitted into .zp.data or .zp.bss.
+    static constexpr const char *ZeroPageSectionName = ".zp";
 
     void Initialize(MCContext &Ctx, const TargetMachine &TM) override;
 
-    /// Return true if this global address should be placed into small data/bss
-    /// section.
-    bool IsGlobalInSmallSection(const GlobalObject *GO,
-                                const TargetMachine &TM) const;
+    /// Return true if this global lives in the zero page, so its address
+    /// fits in a byte.  Declarations qualify when they carry the zero page
+    /// section as well.
+    static bool IsGlobalInZeroPage(const GlobalValue *GV);
 
-    MCSection *SelectSectionForGlobal(const GlobalObject *GO, SectionKind Kind,
-                                      const TargetMachine &TM) const override;
+    MCSection *getExplicitSectionGlobal(const GlobalObject *GO,
+                                        SectionKind Kind,
+                                        const TargetMachine &TM) const override;
 
-    /// Return true if this constant should be placed into small data section.
-    bool IsConstantInSmallSection(const DataLayout &DL, const Constant *CN,
-                                  const TargetMachine &TM) const;
+    MCSection *getZeroPageBSSSection() const { return ZeroPageBSSSection; }
 
-    MCSection *getSectionForConstant(const DataLayout &DL, SectionKind Kind,
-                                     const Constant *C,
-                                     unsigned &Align) const override;
     /// Describe a TLS variable address within debug info.
     const MCExpr *getDebugThreadLocalSymbol(const MCSymbol *Sym) const override;
   };
@@ -0,0 +1,217 @@
+//===-- M6502TargetTransformInfo.cpp - M6502 specific TTI -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502TargetTransformInfo.h"
+#include "M6502RegisterInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Support/Debug.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502tti"
+
+unsigned M6502TTIImpl::getNumBytes(Type *Ty) const {
+  std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, Ty);
+  return LT.first * std::max(1u, LT.second.getSizeInBits() / 8);
+}
+
+/// An immediate costs one LDA # for each of its bytes.
+int M6502TTIImpl::getIntImmCost(const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+  if (Imm == 0)
+    return TTI::TCC_Free;
+  return getNumBytes(Ty) * TTI::TCC_Basic;
+}
+
+/// Every instruction which takes a register also takes an immediate byte, as
+/// cheaply, so hoisting a constant into a register never pays.
+int M6502TTIImpl::getIntImmCost(unsigned Opcode, unsigned Idx,
+                                const APInt &Imm, Type *Ty) {
+  return TTI::TCC_Free;
+}
+
+int M6502TTIImpl::getIntImmCost(Intrinsic::ID IID, unsigned Idx,
+                                const APInt &Imm, Type *Ty) {
+  return TTI::TCC_Free;
+}
+
+/// The size of an operation, as used by the unroller, the inliner and
+/// SimplifyCFG, grows with the bytes of its type.  The amount of a shift is
+/// not known here, so it is assumed to be a constant.
+unsigned M6502TTIImpl::getOperationCost(unsigned Opcode, Type *Ty,
+                                        Type *OpTy) {
+  if (!Ty->isIntegerTy())
+    return BaseT::getOperationCost(Opcode, Ty, OpTy);
+
+  switch (Opcode) {
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+    return getNumBytes(Ty) * TTI::TCC_Basic;
+  case Instruction::Mul:
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::URem:
+  case Instruction::SRem:
+    return getArithmeticInstrCost(Opcode, Ty);
+  default:
+    return BaseT::getOperationCost(Opcode, Ty, OpTy);
+  }
+}
+
+void M6502TTIImpl::getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                                           TTI::UnrollingPreferences &UP) {
+  // A counted loop only costs a DEX and a BNE per iteration and code space is
+  // scarce, so only unroll the loops which get tiny once unrolled, where the
+  // indexed accesses become absolute ones.  Partial and runtime unrolling
+  // save little and need a remainder loop.
+  UP.Threshold = 32;
+  UP.OptSizeThreshold = 0;
+  UP.PartialThreshold = 0;
+  UP.PartialOptSizeThreshold = 0;
+  UP.FullUnrollMaxCount = 8;
+  UP.Partial = false;
+  UP.Runtime = false;
+}
+
+bool M6502TTIImpl::isLSRCostLess(TTI::LSRCost &C1, TTI::LSRCost &C2) {
+  // Every register is a zero page location, which costs little, but every
+  // 16 bit add costs half a dozen instructions, so count instructions first.
+  return std::tie(C1.Insns, C1.NumRegs, C1.AddRecCost, C1.NumIVMuls,
+                  C1.NumBaseAdds, C1.ScaleCost, C1.ImmCost, C1.SetupCost) <
+         std::tie(C2.Insns, C2.NumRegs, C2.AddRecCost, C2.NumIVMuls,
+                  C2.NumBaseAdds, C2.ScaleCost, C2.ImmCost, C2.SetupCost);
+}
+
+/// A short memcmp is expanded into a compare of each byte, which is a load
+/// and a CMP, rather than a call that sets up two pointers and a count.
+const TargetTransformInfo::MemCmpExpansionOptions *
+M6502TTIImpl::enableMemCmpExpansion(bool IsZeroCmp) const {
+  static const auto Options = []() {
+    TargetTransformInfo::MemCmpExpansionOptions Options;
+    Options.LoadSizes.push_back(1);
+    return Options;
+  }();
+  return &Options;
+}
+
+/// Values are mostly pointers and counters, held in zero page register pairs.
+/// Four bytes are the stack pointer and scratch pair.
+unsigned M6502TTIImpl::getNumberOfRegisters(bool Vector) {
+  if (Vector)
+    return 0;
+  return (M6502RegisterInfo::getNumZPRegs() - 4) / 2;
+}
+
+unsigned M6502TTIImpl::getArithmeticInstrCost(
+    unsigned Opcode, Type *Ty, TTI::OperandValueKind Opd1Info,
+    TTI::OperandValueKind Opd2Info, TTI::OperandValueProperties Opd1PropInfo,
+    TTI::OperandValueProperties Opd2PropInfo, ArrayRef<const Value *> Args) {
+  if (Ty->isVectorTy() || !Ty->isIntegerTy())
+    return BaseT::getArithmeticInstrCost(Opcode, Ty, Opd1Info, Opd2Info,
+                                         Opd1PropInfo, Opd2PropInfo, Args);
+
+  unsigned Bytes = getNumBytes(Ty);
+  const ConstantInt *Amount = nullptr;
+  if (Args.size() == 2)
+    Amount = dyn_cast<ConstantInt>(Args[1]);
+  // The cost model and the inliner pass the operands, not their properties.
+  bool PowerOf2 = Opd2PropInfo == TTI::OP_PowerOf2 ||
+                  (Amount && Amount->getValue().isPowerOf2());
+
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+  switch (ISD) {
+  default:
+    return Bytes;
+
+  case ISD::SHL:
+  case ISD::SRL:
+  case ISD::SRA: {
+    // A shift by a constant moves whole bytes and then shifts every byte
+    // once per remaining bit.  A variable shift is a loop of those.
+    if (!Amount)
+      return 4 * Bytes + 2;
+    unsigned Bits = Amount->getZExtValue() % 8;
+    return Bytes + Bits * Bytes;
+  }
+
+  case ISD::MUL:
+    // A multiplication by a power of two is a shift.
+    if (PowerOf2)
+      return Bytes + 2 * Bytes;
+    // Otherwise it is a shift and add loop in the runtime library, of one
+    // iteration per bit of the multiplier.
+    return 12 * Bytes * Bytes + 8;
+
+  case ISD::UDIV:
+  case ISD::UREM:
+    if (PowerOf2)
+      return Bytes + 2 * Bytes;
+    return 24 * Bytes * Bytes + 8;
+
+  case ISD::SDIV:
+  case ISD::SREM:
+    // Division is done on the magnitudes and the sign fixed up.
+    return 24 * Bytes * Bytes + 4 * Bytes + 8;
+  }
+}
+
+unsigned M6502TTIImpl::getCastInstrCost(unsigned Opcode, Type *Dst, Type *Src,
+                                        const Instruction *I) {
+  if (!Dst->isIntegerTy() || !Src->isIntegerTy())
+    return BaseT::getCastInstrCost(Opcode, Dst, Src, I);
+
+  unsigned DstBytes = getNumBytes(Dst);
+  unsigned SrcBytes = getNumBytes(Src);
+  switch (Opcode) {
+  case Instruction::Trunc:
+    // The low bytes are used as they are.
+    return TTI::TCC_Free;
+  case Instruction::ZExt:
+    // Every new byte is cleared.
+    return DstBytes > SrcBytes ? DstBytes - SrcBytes : 0;
+  case Instruction::SExt:
+    // The sign is tested once, then every new byte is set.
+    return DstBytes > SrcBytes ? DstBytes - SrcBytes + 2 : 2;
+  default:
+    return BaseT::getCastInstrCost(Opcode, Dst, Src, I);
+  }
+}
+
+unsigned M6502TTIImpl::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                          Type *CondTy,
+                                          const Instruction *I) {
+  if (ValTy->isVectorTy())
+    return BaseT::getCmpSelInstrCost(Opcode, ValTy, CondTy, I);
+
+  // A comparison looks at every byte, a select branches around the copy of
+  // one of its operands.
+  unsigned Bytes = getNumBytes(ValTy);
+  if (Opcode == Instruction::Select)
+    return Bytes + 2;
+  return Bytes;
+}
+
+unsigned M6502TTIImpl::getMemoryOpCost(unsigned Opcode, Type *Src,
+                                       unsigned Alignment,
+                                       unsigned AddressSpace,
+                                       const Instruction *I) {
+  if (Src->isVectorTy())
+    return BaseT::getMemoryOpCost(Opcode, Src, Alignment, AddressSpace, I);
+
+  // Bytes are loaded and stored one at a time, whatever the alignment.
+  return getNumBytes(Src);
+}
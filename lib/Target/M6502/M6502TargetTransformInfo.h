@@ -0,0 +1,102 @@
+//===-- M6502TargetTransformInfo.h - M6502 specific TTI ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file a TargetTransformInfo::Concept conforming object specific to the
+// M6502 target machine.  Every operation is done a byte at a time through the
+// accumulator, so the costs grow with the number of bytes of the type, and
+// multiplication, division and variable shifts are loops or library calls.
+// The unit of cost is roughly one byte sized ALU operation on a zero page
+// register, about 8 cycles.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M6502_M6502TARGETTRANSFORMINFO_H
+#define LLVM_LIB_TARGET_M6502_M6502TARGETTRANSFORMINFO_H
+
+#include "M6502.h"
+#include "M6502Subtarget.h"
+#include "M6502TargetMachine.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/BasicTTIImpl.h"
+#include "llvm/Target/TargetLowering.h"
+
+namespace llvm {
+
+class M6502TTIImpl : public BasicTTIImplBase<M6502TTIImpl> {
+  typedef BasicTTIImplBase<M6502TTIImpl> BaseT;
+  typedef TargetTransformInfo TTI;
+  friend BaseT;
+
+  const M6502Subtarget *ST;
+  const M6502TargetLowering *TLI;
+
+  const M6502Subtarget *getST() const { return ST; }
+  const M6502TargetLowering *getTLI() const { return TLI; }
+
+  /// Return the number of bytes Ty is legalized to.
+  unsigned getNumBytes(Type *Ty) const;
+
+public:
+  explicit M6502TTIImpl(const M6502TargetMachine *TM, const Function &F)
+      : BaseT(TM, F.getParent()->getDataLayout()), ST(TM->getSubtargetImpl(F)),
+        TLI(ST->getTargetLowering()) {}
+
+  /// \name Scalar TTI Implementations
+  /// @{
+
+  TTI::PopcntSupportKind getPopcntSupport(unsigned TyWidth) {
+    return TTI::PSK_Software;
+  }
+
+  int getIntImmCost(const APInt &Imm, Type *Ty);
+  int getIntImmCost(unsigned Opcode, unsigned Idx, const APInt &Imm, Type *Ty);
+  int getIntImmCost(Intrinsic::ID IID, unsigned Idx, const APInt &Imm,
+                    Type *Ty);
+
+  unsigned getOperationCost(unsigned Opcode, Type *Ty, Type *OpTy);
+
+  void getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                               TTI::UnrollingPreferences &UP);
+
+  bool isLSRCostLess(TTI::LSRCost &C1, TTI::LSRCost &C2);
+
+  const TTI::MemCmpExpansionOptions *enableMemCmpExpansion(
+      bool IsZeroCmp) const;
+
+  /// @}
+
+  /// \name Vector TTI Implementations
+  /// @{
+
+  unsigned getNumberOfRegisters(bool Vector);
+  unsigned getRegisterBitWidth(bool Vector) const { return Vector ? 0 : 16; }
+  unsigned getMaxInterleaveFactor(unsigned VF) { return 1; }
+  bool prefersVectorizedAddressing() { return false; }
+
+  unsigned getArithmeticInstrCost(
+      unsigned Opcode, Type *Ty,
+      TTI::OperandValueKind Opd1Info = TTI::OK_AnyValue,
+      TTI::OperandValueKind Opd2Info = TTI::OK_AnyValue,
+      TTI::OperandValueProperties Opd1PropInfo = TTI::OP_None,
+      TTI::OperandValueProperties Opd2PropInfo = TTI::OP_None,
+      ArrayRef<const Value *> Args = ArrayRef<const Value *>());
+  unsigned getCastInstrCost(unsigned Opcode, Type *Dst, Type *Src,
+                            const Instruction *I = nullptr);
+  unsigned getCmpSelInstrCost(unsigned Opcode, Type *ValTy, Type *CondTy,
+                              const Instruction *I = nullptr);
+  unsigned getMemoryOpCost(unsigned Opcode, Type *Src, unsigned Alignment,
+                           unsigned AddressSpace,
+                           const Instruction *I = nullptr);
+
+  /// @}
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M6502_M6502TARGETTRANSFORMINFO_H
@@ -0,0 +1,122 @@
+//===- M6502ZPColoring.cpp - Color zero page registers over the call graph ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Interprocedural register allocation compiles the callees of a function
+// before it and gives each call the register mask of what its callee really
+// changes.  A value live across a call then stays out of those registers,
+// but the allocator hands out the other values from the start of the
+// allocation order as well, so a function changes the registers its callees
+// change plus some of its own, and the sets grow along the call graph faster
+// than they need to.
+//
+// This pass records the zero page registers the calls of the function
+// change, and M6502RegisterInfo::getRegAllocationHints offers them first to
+// every value.  The values which do not live across a call reuse them, and
+// those which do go to the lowest registers none of the callees touches, so
+// the registers of each function lie just above those of its callees.  Leaf
+// and near-leaf functions end up in disjoint ranges, and their callers find
+// free caller-saved registers for the values they keep across the calls
+// instead of callee-saved ones to save and restore.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502MachineFunction.h"
+#include "M6502Subtarget.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-zp-coloring"
+
+STATISTIC(NumColored, "Number of functions whose calls clobber zero page "
+                      "registers");
+
+namespace {
+
+  class M6502ZPColoring : public MachineFunctionPass {
+  public:
+    static char ID;
+
+    M6502ZPColoring() : MachineFunctionPass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Zero Page Register Coloring";
+    }
+
+    bool runOnMachineFunction(MachineFunction &MF) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesAll();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+  };
+
+} // end anonymous namespace
+
+char M6502ZPColoring::ID = 0;
+
+/// Return true if a call with register mask Mask changes all of Reg.
+static bool clobbersAll(const TargetRegisterInfo *TRI, const uint32_t *Mask,
+                        unsigned Reg) {
+  for (MCSubRegIterator SR(Reg, TRI, true); SR.isValid(); ++SR)
+    if (!MachineOperand::clobbersPhysReg(Mask, *SR))
+      return false;
+  return true;
+}
+
+bool M6502ZPColoring::runOnMachineFunction(MachineFunction &MF) {
+  if (!MF.getTarget().Options.EnableIPRA)
+    return false;
+
+  const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+  SmallVector<const uint32_t *, 8> Masks;
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB)
+      if (MI.isCall())
+        for (const MachineOperand &MO : MI.operands())
+          if (MO.isRegMask())
+            Masks.push_back(MO.getRegMask());
+  if (Masks.empty())
+    return false;
+
+  SmallVector<MCPhysReg, 32> Clobbered;
+  for (const TargetRegisterClass *RC : {&M6502::ZP8RegClass,
+                                        &M6502::ZP16RegClass})
+    for (MCPhysReg Reg : *RC)
+      if (any_of(Masks, [&](const uint32_t *Mask) {
+            return clobbersAll(TRI, Mask, Reg);
+          }))
+        Clobbered.push_back(Reg);
+
+  DEBUG({
+    dbgs() << "Calls in " << MF.getName() << " clobber:";
+    for (MCPhysReg Reg : Clobbered)
+      dbgs() << ' ' << TRI->getName(Reg);
+    dbgs() << '\n';
+  });
+
+  MF.getInfo<M6502FunctionInfo>()->setCallClobberedRegs(Clobbered);
+  ++NumColored;
+  return false;
+}
+
+/// createM6502ZPColoringPass - Returns a pass that records the zero page
+/// registers the calls of a function clobber, for the register allocator
+/// to use first.
+FunctionPass *llvm::createM6502ZPColoringPass() {
+  return new M6502ZPColoring();
+}
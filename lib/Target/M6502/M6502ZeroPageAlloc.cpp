@@ -0,0 +1,278 @@
+//===- M6502ZeroPageAlloc.cpp - Place hot variables in the zero page ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass chooses the variables which live in the zero page.  A zero page
+// access is a byte shorter and a cycle faster than an absolute one, and
+// a variable taken off the soft stack saves far more, but the page is small
+// and shared with the register bank.
+//
+// Candidates are small zero initialized global variables defined in this
+// module and fixed size allocas of functions which cannot recurse, and which
+// an interrupt handler cannot enter while they are already active.  Such an
+// alloca has at most one live instance, so it can be turned into an internal
+// global.  Every load and store at a constant offset from a candidate is
+// weighted by the frequency of its block, scaled by the profile count of its
+// function when there is one and by the loop nest otherwise.  Candidates are
+// then taken greedily by weight per byte until the zero page budget is spent,
+// and are placed in the .zp section, which instruction selection addresses
+// with the zero page addressing modes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502.h"
+#include "M6502CallGraph.h"
+#include "M6502TargetObjectFile.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-zp-alloc"
+
+STATISTIC(NumZPGlobals, "Number of globals placed in the zero page");
+STATISTIC(NumZPAllocas, "Number of allocas placed in the zero page");
+STATISTIC(NumZPBytes, "Number of zero page bytes allocated");
+
+static cl::opt<unsigned>
+ZPBudget("m6502-zp-budget", cl::Hidden,
+         cl::desc("Zero page bytes available to variables (default=32)"),
+         cl::init(32));
+
+static cl::opt<unsigned>
+ZPThreshold("m6502-zp-threshold", cl::Hidden,
+            cl::desc("Largest variable placed in the zero page (default=8)"),
+            cl::init(8));
+
+namespace {
+
+  struct ZPCandidate {
+    GlobalVariable *GV = nullptr;
+    AllocaInst *AI = nullptr;
+    uint64_t Size = 0;
+    double Weight = 0;
+
+    Value *getValue() const {
+      return GV ? static_cast<Value *>(GV) : static_cast<Value *>(AI);
+    }
+  };
+
+  class M6502ZeroPageAlloc : public ModulePass {
+  public:
+    static char ID;
+
+    M6502ZeroPageAlloc() : ModulePass(ID) {}
+
+    StringRef getPassName() const override {
+      return "M6502 Zero Page Allocation";
+    }
+
+    bool runOnModule(Module &M) override;
+
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.addRequired<BlockFrequencyInfoWrapperPass>();
+      AU.setPreservesCFG();
+      ModulePass::getAnalysisUsage(AU);
+    }
+
+  private:
+    void collectCandidates(Module &M, SmallVectorImpl<ZPCandidate> &Cands);
+    void weighAccesses(Module &M, SmallVectorImpl<ZPCandidate> &Cands);
+    GlobalVariable *promoteAlloca(AllocaInst *AI);
+  };
+
+} // end anonymous namespace
+
+char M6502ZeroPageAlloc::ID = 0;
+
+/// Return true if the object of Size bytes is small enough to be worth a
+/// share of the zero page.
+static bool isZPSized(uint64_t Size) {
+  return Size > 0 && Size <= ZPThreshold;
+}
+
+void M6502ZeroPageAlloc::collectCandidates(Module &M,
+                                           SmallVectorImpl<ZPCandidate> &Cands) {
+  const DataLayout &DL = M.getDataLayout();
+
+  for (GlobalVariable &GV : M.globals()) {
+    // Only variables defined here, which no other definition can replace,
+    // and which are not in a section already.  Read only data stays with the
+    // code, and common symbols cannot be given a section.
+    if (GV.isDeclaration() || GV.hasSection() || GV.isThreadLocal() ||
+        GV.isConstant())
+      continue;
+    if (!GV.hasLocalLinkage() && !GV.hasExternalLinkage())
+      continue;
+    // The zero page is not part of a load image, so it can only hold
+    // variables starting out as zero, like .bss.
+    if (!GV.getInitializer()->isNullValue())
+      continue;
+
+    ZPCandidate C;
+    C.GV = &GV;
+    C.Size = DL.getTypeAllocSize(GV.getValueType());
+    if (isZPSized(C.Size))
+      Cands.push_back(C);
+  }
+
+  // An interrupt arriving in the middle of a function which the handler
+  // calls as well would overwrite its locals.
+  SmallPtrSet<Function *, 16> Shared;
+  M6502CallGraph(M).findSharedWithInterrupts(Shared);
+
+  for (Function &F : M) {
+    if (F.isDeclaration() || !F.doesNotRecurse() || Shared.count(&F))
+      continue;
+
+    for (Instruction &I : F.getEntryBlock()) {
+      auto *AI = dyn_cast<AllocaInst>(&I);
+      if (!AI || !AI->isStaticAlloca() || AI->isUsedWithInAlloca() ||
+          AI->isSwiftError())
+        continue;
+
+      ZPCandidate C;
+      C.AI = AI;
+      C.Size = DL.getTypeAllocSize(AI->getAllocatedType()) *
+               cast<ConstantInt>(AI->getArraySize())->getZExtValue();
+      if (isZPSized(C.Size))
+        Cands.push_back(C);
+    }
+  }
+}
+
+void M6502ZeroPageAlloc::weighAccesses(Module &M,
+                                       SmallVectorImpl<ZPCandidate> &Cands) {
+  DenseMap<const Value *, unsigned> CandIdx;
+  for (unsigned Idx = 0, E = Cands.size(); Idx != E; ++Idx)
+    CandIdx[Cands[Idx].getValue()] = Idx;
+
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+
+    BlockFrequencyInfo &BFI =
+        getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    double EntryFreq = BFI.getEntryFreq();
+    double Scale = 1;
+    if (auto Count = F.getEntryCount())
+      Scale = *Count;
+
+    for (BasicBlock &BB : F) {
+      double Freq = BFI.getBlockFreq(&BB).getFrequency() / EntryFreq * Scale;
+
+      for (Instruction &I : BB) {
+        // Only the accesses at a constant address benefit from the shorter
+        // addressing mode.
+        const Value *Ptr;
+        if (auto *LI = dyn_cast<LoadInst>(&I))
+          Ptr = LI->getPointerOperand();
+        else if (auto *SI = dyn_cast<StoreInst>(&I))
+          Ptr = SI->getPointerOperand();
+        else
+          continue;
+
+        auto It = CandIdx.find(Ptr->stripInBoundsConstantOffsets());
+        if (It != CandIdx.end())
+          Cands[It->second].Weight += Freq;
+      }
+    }
+  }
+}
+
+/// Replace AI with an internal global variable of the same type.
+GlobalVariable *M6502ZeroPageAlloc::promoteAlloca(AllocaInst *AI) {
+  Function *F = AI->getFunction();
+  Type *Ty = AI->getAllocatedType();
+  if (AI->isArrayAllocation())
+    Ty = ArrayType::get(
+        Ty, cast<ConstantInt>(AI->getArraySize())->getZExtValue());
+
+  auto *GV = new GlobalVariable(
+      *F->getParent(), Ty, false, GlobalValue::InternalLinkage,
+      Constant::getNullValue(Ty), F->getName() + "." + AI->getName());
+  GV->setAlignment(AI->getAlignment());
+
+  // The lifetime of the variable is the program now.
+  SmallVector<Instruction *, 4> Dead;
+  for (User *U : AI->users())
+    if (auto *II = dyn_cast<IntrinsicInst>(U))
+      if (II->getIntrinsicID() == Intrinsic::lifetime_start ||
+          II->getIntrinsicID() == Intrinsic::lifetime_end)
+        Dead.push_back(II);
+  for (Instruction *I : Dead)
+    I->eraseFromParent();
+
+  Constant *Addr = GV;
+  if (AI->getType() != GV->getType())
+    Addr = ConstantExpr::getBitCast(GV, AI->getType());
+  AI->replaceAllUsesWith(Addr);
+  AI->eraseFromParent();
+  return GV;
+}
+
+bool M6502ZeroPageAlloc::runOnModule(Module &M) {
+  if (skipModule(M) || !ZPBudget)
+    return false;
+
+  SmallVector<ZPCandidate, 32> Cands;
+  collectCandidates(M, Cands);
+  weighAccesses(M, Cands);
+
+  // Spend the budget on the most frequently accessed bytes first.
+  std::stable_sort(Cands.begin(), Cands.end(),
+                   [](const ZPCandidate &A, const ZPCandidate &B) {
+                     return A.Weight * B.Size > B.Weight * A.Size;
+                   });
+
+  unsigned Left = ZPBudget;
+  bool Changed = false;
+  for (ZPCandidate &C : Cands) {
+    if (C.Weight == 0 || C.Size > Left)
+      continue;
+
+    DEBUG(dbgs() << "Zero page: " << C.getValue()->getName() << " ("
+                 << C.Size << " bytes, weight " << C.Weight << ")\n");
+
+    GlobalVariable *GV = C.GV;
+    if (GV) {
+      ++NumZPGlobals;
+    } else {
+      GV = promoteAlloca(C.AI);
+      ++NumZPAllocas;
+    }
+
+    GV->setSection(M6502TargetObjectFile::ZeroPageSectionName);
+    Left -= C.Size;
+    NumZPBytes += C.Size;
+    Changed = true;
+  }
+
+  return Changed;
+}
+
+/// createM6502ZeroPageAllocPass - Returns a pass that places the most
+/// frequently accessed variables in the zero page.
+ModulePass *llvm::createM6502ZeroPageAllocPass() {
+  return new M6502ZeroPageAlloc();
+}
@@ -1,4 +1,4 @@
-//===---- M6502ABIInfo.h - Information about M6502 ABI's --------------------===//
+//===---- M6502ABIInfo.h - Information about M6502 ABI's ------------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -11,7 +11,6 @@
 #define LLVM_LIB_TARGET_M6502_MCTARGETDESC_M6502ABIINFO_H
 
 #include "llvm/ADT/Triple.h"
-#include "llvm/IR/CallingConv.h"
 #include "llvm/MC/MCRegisterInfo.h"
 
 namespace llvm {
@@ -23,7 +22,7 @@ class TargetRegisterClass;
 
 class M6502ABIInfo {
 public:
-  enum class ABI { Unknown, O32, N32, N64 };
+  enum class ABI { Unknown, Std };
 
 protected:
   ABI ThisABI;
@@ -32,27 +31,26 @@ public:
   M6502ABIInfo(ABI ThisABI) : ThisABI(ThisABI) {}
 
   static M6502ABIInfo Unknown() { return M6502ABIInfo(ABI::Unknown); }
-  static M6502ABIInfo O32() { return M6502ABIInfo(ABI::O32); }
-  static M6502ABIInfo N32() { return M6502ABIInfo(ABI::N32); }
-  static M6502ABIInfo N64() { return M6502ABIInfo(ABI::N64); }
+  static M6502ABIInfo Std() { return M6502ABIInfo(ABI::Std); }
   static M6502ABIInfo computeTargetABI(const Triple &TT, StringRef CPU,
                                       const MCTargetOptions &Options);
 
   bool IsKnown() const { return ThisABI != ABI::Unknown; }
-  bool IsO32() const { return ThisABI == ABI::O32; }
-  bool IsN32() const { return ThisABI == ABI::N32; }
-  bool IsN64() const { return ThisABI == ABI::N64; }
+  bool IsStd() const { return ThisABI == ABI::Std; }
   ABI GetEnumValue() const { return ThisABI; }
 
-  /// The registers to use for byval arguments.
-  ArrayRef<MCPhysReg> GetByValArgRegs() const;
+  /// The layout of data: 16-bit little endian pointers, byte alignment for
+  /// everything and bytes as the only native integer.
+  StringRef GetDataLayout() const;
 
-  /// The registers to use for the variable argument list.
-  ArrayRef<MCPhysReg> GetVarArgRegs() const;
+  /// The alignment of the software stack, in bytes.
+  unsigned GetStackAlignment() const { return 1; }
 
-  /// Obtain the size of the area allocated by the callee for arguments.
-  /// CallingConv::FastCall affects the value for O32.
-  unsigned GetCalleeAllocdArgSizeInBytes(CallingConv::ID CC) const;
+  /// The registers used to pass byte arguments.
+  ArrayRef<MCPhysReg> GetByteArgRegs() const;
+
+  /// The register pairs used to pass 16-bit arguments.
+  ArrayRef<MCPhysReg> GetPairArgRegs() const;
 
   /// Ordering of ABI's
   /// M6502GenSubtargetInfo.inc will use this to resolve conflicts when given
@@ -61,21 +59,12 @@ public:
     return ThisABI < Other.GetEnumValue();
   }
 
+  /// The zero page pair holding the software stack pointer.
   unsigned GetStackPtr() const;
+  /// The zero page pair used as frame pointer.
   unsigned GetFramePtr() const;
-  unsigned GetBasePtr() const;
-  unsigned GetGlobalPtr() const;
-  unsigned GetNullPtr() const;
-  unsigned GetZeroReg() const;
-  unsigned GetPtrAdduOp() const;
-  unsigned GetPtrAddiuOp() const;
-  unsigned GetPtrSubuOp() const;
-  unsigned GetPtrAndOp() const;
-  unsigned GetGPRMoveOp() const;
-  inline bool ArePtrs64bit() const { return IsN64(); }
-  inline bool AreGprs64bit() const { return IsN32() || IsN64(); }
-
-  unsigned GetEhDataReg(unsigned I) const;
+  /// The zero page pair reserved as a scratch pointer.
+  unsigned GetScratchPtr() const;
 };
 }
 
@@ -1,4 +1,4 @@
-//===-- M6502AsmBackend.cpp - M6502 Asm Backend  ----------------------------===//
+//===-- M6502AsmBackend.cpp - M6502 Asm Backend  --------------------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -13,6 +13,7 @@
 //
 
 #include "MCTargetDesc/M6502AsmBackend.h"
+#include "MCTargetDesc/M6502BaseInfo.h"
 #include "MCTargetDesc/M6502FixupKinds.h"
 #include "MCTargetDesc/M6502MCExpr.h"
 #include "MCTargetDesc/M6502MCTargetDesc.h"
@@ -23,9 +24,13 @@
 #include "llvm/MC/MCELFObjectWriter.h"
 #include "llvm/MC/MCFixupKindInfo.h"
 #include "llvm/MC/MCObjectWriter.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/MC/MCInst.h"
 #include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/MCTargetOptions.h"
 #include "llvm/MC/MCValue.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/MathExtras.h"
@@ -33,203 +38,72 @@
 
 using namespace llvm;
 
+/// Return the fixup kind of Fixup, where a byte of data may select a byte of
+/// an address, as in .byte >label.
+static unsigned getM6502FixupKind(const MCFixup &Fixup) {
+  if (Fixup.getKind() == FK_Data_1)
+    if (const auto *E = dyn_cast<M6502MCExpr>(Fixup.getValue()))
+      return E->getKind() == M6502MCExpr::MEK_HI ? M6502::fixup_M6502_HI8
+                                                 : M6502::fixup_M6502_LO8;
+  return Fixup.getKind();
+}
+
 // Prepare value for the target space for it
 static unsigned adjustFixupValue(const MCFixup &Fixup, uint64_t Value,
                                  MCContext &Ctx) {
-
-  unsigned Kind = Fixup.getKind();
-
-  // Add/subtract and shift
-  switch (Kind) {
+  switch (getM6502FixupKind(Fixup)) {
   default:
-    return 0;
-  case FK_Data_2:
-  case M6502::fixup_M6502_LO16:
-  case M6502::fixup_M6502_GPREL16:
-  case M6502::fixup_M6502_GPOFF_HI:
-  case M6502::fixup_M6502_GPOFF_LO:
-  case M6502::fixup_M6502_GOT_PAGE:
-  case M6502::fixup_M6502_GOT_OFST:
-  case M6502::fixup_M6502_GOT_DISP:
-  case M6502::fixup_M6502_GOT_LO16:
-  case M6502::fixup_M6502_CALL_LO16:
-  case M6502::fixup_MICROM6502_LO16:
-  case M6502::fixup_MICROM6502_GOT_PAGE:
-  case M6502::fixup_MICROM6502_GOT_OFST:
-  case M6502::fixup_MICROM6502_GOT_DISP:
-  case M6502::fixup_M6502_PCLO16:
-    Value &= 0xffff;
-    break;
-  case FK_DTPRel_4:
-  case FK_DTPRel_8:
-  case FK_TPRel_4:
-  case FK_TPRel_8:
-  case FK_GPRel_4:
-  case FK_Data_4:
-  case FK_Data_8:
-  case M6502::fixup_M6502_SUB:
-  case M6502::fixup_MICROM6502_SUB:
-    break;
-  case M6502::fixup_M6502_PC16:
-    // The displacement is then divided by 4 to give us an 18 bit
-    // address range. Forcing a signed division because Value can be negative.
-    Value = (int64_t)Value / 4;
-    // We now check if Value can be encoded as a 16-bit signed immediate.
-    if (!isInt<16>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC16 fixup");
-      return 0;
-    }
-    break;
-  case M6502::fixup_M6502_PC19_S2:
-  case M6502::fixup_MICROM6502_PC19_S2:
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t)Value / 4;
-    // We now check if Value can be encoded as a 19-bit signed immediate.
-    if (!isInt<19>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC19 fixup");
-      return 0;
-    }
-    break;
-  case M6502::fixup_M6502_26:
-    // So far we are only using this type for jumps.
-    // The displacement is then divided by 4 to give us an 28 bit
-    // address range.
-    Value >>= 2;
-    break;
-  case M6502::fixup_M6502_HI16:
-  case M6502::fixup_M6502_GOT:
-  case M6502::fixup_MICROM6502_GOT16:
-  case M6502::fixup_M6502_GOT_HI16:
-  case M6502::fixup_M6502_CALL_HI16:
-  case M6502::fixup_MICROM6502_HI16:
-  case M6502::fixup_M6502_PCHI16:
-    // Get the 2nd 16-bits. Also add 1 if bit 15 is 1.
-    Value = ((Value + 0x8000) >> 16) & 0xffff;
-    break;
-  case M6502::fixup_M6502_HIGHER:
-    // Get the 3rd 16-bits.
-    Value = ((Value + 0x80008000LL) >> 32) & 0xffff;
-    break;
-  case M6502::fixup_M6502_HIGHEST:
-    // Get the 4th 16-bits.
-    Value = ((Value + 0x800080008000LL) >> 48) & 0xffff;
-    break;
-  case M6502::fixup_MICROM6502_26_S1:
-    Value >>= 1;
-    break;
-  case M6502::fixup_MICROM6502_PC7_S1:
-    Value -= 4;
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t) Value / 2;
-    // We now check if Value can be encoded as a 7-bit signed immediate.
-    if (!isInt<7>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC7 fixup");
-      return 0;
-    }
+    llvm_unreachable("Unknown fixup kind!");
+  case FK_Data_1:
+  case M6502::fixup_M6502_LO8:
+    Value &= 0xff;
     break;
-  case M6502::fixup_MICROM6502_PC10_S1:
-    Value -= 2;
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t) Value / 2;
-    // We now check if Value can be encoded as a 10-bit signed immediate.
-    if (!isInt<10>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC10 fixup");
-      return 0;
-    }
+  case M6502::fixup_M6502_HI8:
+    Value = (Value >> 8) & 0xff;
     break;
-  case M6502::fixup_MICROM6502_PC16_S1:
-    Value -= 4;
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t)Value / 2;
-    // We now check if Value can be encoded as a 16-bit signed immediate.
-    if (!isInt<16>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC16 fixup");
-      return 0;
-    }
-    break;
-  case M6502::fixup_M6502_PC18_S3:
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t)Value / 8;
-    // We now check if Value can be encoded as a 18-bit signed immediate.
-    if (!isInt<18>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC18 fixup");
-      return 0;
-    }
-    break;
-  case M6502::fixup_MICROM6502_PC18_S3:
-    // Check alignment.
-    if ((Value & 7)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC18 fixup");
-    }
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t)Value / 8;
-    // We now check if Value can be encoded as a 18-bit signed immediate.
-    if (!isInt<18>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC18 fixup");
+  case M6502::fixup_M6502_ZP8:
+    if (!isUInt<8>(Value)) {
+      Ctx.reportError(Fixup.getLoc(), "out of range zero page fixup");
       return 0;
     }
     break;
-  case M6502::fixup_M6502_PC21_S2:
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t) Value / 4;
-    // We now check if Value can be encoded as a 21-bit signed immediate.
-    if (!isInt<21>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC21 fixup");
+  case FK_PCRel_1:
+  case M6502::fixup_M6502_PCREL8:
+    // Relative branches reach 128 bytes back and 127 forward.
+    if (!isInt<8>(Value)) {
+      Ctx.reportError(Fixup.getLoc(), "out of range branch fixup");
       return 0;
     }
+    Value &= 0xff;
     break;
-  case M6502::fixup_M6502_PC26_S2:
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t) Value / 4;
-    // We now check if Value can be encoded as a 26-bit signed immediate.
-    if (!isInt<26>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC26 fixup");
-      return 0;
-    }
-    break;
-  case M6502::fixup_MICROM6502_PC26_S1:
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t)Value / 2;
-    // We now check if Value can be encoded as a 26-bit signed immediate.
-    if (!isInt<26>(Value)) {
-      Ctx.reportFatalError(Fixup.getLoc(), "out of range PC26 fixup");
-      return 0;
-    }
+  case FK_Data_2:
+  case M6502::fixup_M6502_ABS16:
+    Value &= 0xffff;
     break;
-  case M6502::fixup_MICROM6502_PC21_S1:
-    // Forcing a signed division because Value can be negative.
-    Value = (int64_t)Value / 2;
-    // We now check if Value can be encoded as a 21-bit signed immediate.
-    if (!isInt<21>(Value)) {
-      Ctx.reportError(Fixup.getLoc(), "out of range PC21 fixup");
-      return 0;
-    }
+  case FK_Data_4:
+  case FK_Data_8:
     break;
   }
 
   return Value;
 }
 
+static cl::opt<M6502::ImageFormat>
+ImageFormat("m6502-image", cl::init(M6502::IF_ELF),
+            cl::desc("M6502: Kind of object file to write"),
+            cl::values(clEnumValN(M6502::IF_ELF, "elf",
+                                  "Relocatable ELF object (default)"),
+                       clEnumValN(M6502::IF_Raw, "raw", "Raw binary image"),
+                       clEnumValN(M6502::IF_PRG, "prg",
+                                  "C64 program with its load address"),
+                       clEnumValN(M6502::IF_INES, "ines",
+                                  "NES cartridge with an iNES header")));
+
 std::unique_ptr<MCObjectWriter>
 M6502AsmBackend::createObjectWriter(raw_pwrite_stream &OS) const {
-  return createM6502ELFObjectWriter(OS, TheTriple, IsN32);
-}
-
-// Little-endian fixup data byte ordering:
-//   m650232r2:   a | b | x | x
-//   microM6502:  x | x | a | b
-
-static bool needsMMLEByteOrder(unsigned Kind) {
-  return Kind != M6502::fixup_MICROM6502_PC10_S1 &&
-         Kind >= M6502::fixup_MICROM6502_26_S1 &&
-         Kind < M6502::LastTargetFixupKind;
-}
-
-// Calculate index for microM6502 specific little endian byte order
-static unsigned calculateMMLEIndex(unsigned i) {
-  assert(i <= 3 && "Index out of range!");
-
-  return (1 - i / 2) * 2 + i % 2;
+  if (ImageFormat != M6502::IF_ELF)
+    return createM6502ImageObjectWriter(OS, ImageFormat);
+  return createM6502ELFObjectWriter(OS, TheTriple);
 }
 
 /// ApplyFixup - Apply the \p Value for given \p Fixup into the provided
@@ -239,212 +113,40 @@ void M6502AsmBackend::applyFixup(const MCAssembler &Asm, const MCFixup &Fixup,
                                 const MCValue &Target,
                                 MutableArrayRef<char> Data, uint64_t Value,
                                 bool IsResolved) const {
-  MCFixupKind Kind = Fixup.getKind();
-  MCContext &Ctx = Asm.getContext();
-  Value = adjustFixupValue(Fixup, Value, Ctx);
-
+  Value = adjustFixupValue(Fixup, Value, Asm.getContext());
   if (!Value)
     return; // Doesn't change encoding.
 
-  // Where do we start in the object
+  // The operand bytes are little endian.
   unsigned Offset = Fixup.getOffset();
-  // Number of bytes we need to fixup
-  unsigned NumBytes = (getFixupKindInfo(Kind).TargetSize + 7) / 8;
-  // Used to point to big endian bytes
-  unsigned FullSize;
-
-  switch ((unsigned)Kind) {
-  case FK_Data_2:
-  case M6502::fixup_M6502_16:
-  case M6502::fixup_MICROM6502_PC10_S1:
-    FullSize = 2;
-    break;
-  case FK_Data_8:
-  case M6502::fixup_M6502_64:
-    FullSize = 8;
-    break;
-  case FK_Data_4:
-  default:
-    FullSize = 4;
-    break;
-  }
-
-  // Grab current value, if any, from bits.
-  uint64_t CurVal = 0;
-
-  bool microM6502LEByteOrder = needsMMLEByteOrder((unsigned) Kind);
-
-  for (unsigned i = 0; i != NumBytes; ++i) {
-    unsigned Idx = IsLittle ? (microM6502LEByteOrder ? calculateMMLEIndex(i)
-                                                    : i)
-                            : (FullSize - 1 - i);
-    CurVal |= (uint64_t)((uint8_t)Data[Offset + Idx]) << (i*8);
-  }
-
-  uint64_t Mask = ((uint64_t)(-1) >>
-                    (64 - getFixupKindInfo(Kind).TargetSize));
-  CurVal |= Value & Mask;
-
-  // Write out the fixed up bytes back to the code/data bits.
-  for (unsigned i = 0; i != NumBytes; ++i) {
-    unsigned Idx = IsLittle ? (microM6502LEByteOrder ? calculateMMLEIndex(i)
-                                                    : i)
-                            : (FullSize - 1 - i);
-    Data[Offset + Idx] = (uint8_t)((CurVal >> (i*8)) & 0xff);
-  }
+  unsigned NumBytes = getFixupKindInfo(Fixup.getKind()).TargetSize / 8;
+  assert(Offset + NumBytes <= Data.size() && "Invalid fixup offset!");
+  for (unsigned i = 0; i != NumBytes; ++i)
+    Data[Offset + i] |= uint8_t((Value >> (i * 8)) & 0xff);
 }
 
 Optional<MCFixupKind> M6502AsmBackend::getFixupKind(StringRef Name) const {
   return StringSwitch<Optional<MCFixupKind>>(Name)
-      .Case("R_M6502_NONE", (MCFixupKind)M6502::fixup_M6502_NONE)
-      .Case("R_M6502_32", FK_Data_4)
+      .Case("R_M6502_ZP8", (MCFixupKind)M6502::fixup_M6502_ZP8)
+      .Case("R_M6502_ABS16", (MCFixupKind)M6502::fixup_M6502_ABS16)
+      .Case("R_M6502_PCREL8", (MCFixupKind)M6502::fixup_M6502_PCREL8)
+      .Case("R_M6502_LO8", (MCFixupKind)M6502::fixup_M6502_LO8)
+      .Case("R_M6502_HI8", (MCFixupKind)M6502::fixup_M6502_HI8)
       .Default(MCAsmBackend::getFixupKind(Name));
 }
 
 const MCFixupKindInfo &M6502AsmBackend::
 getFixupKindInfo(MCFixupKind Kind) const {
-  const static MCFixupKindInfo LittleEndianInfos[M6502::NumTargetFixupKinds] = {
+  const static MCFixupKindInfo Infos[M6502::NumTargetFixupKinds] = {
     // This table *must* be in same the order of fixup_* kinds in
     // M6502FixupKinds.h.
     //
     // name                    offset  bits  flags
-    { "fixup_M6502_NONE",         0,      0,   0 },
-    { "fixup_M6502_16",           0,     16,   0 },
-    { "fixup_M6502_32",           0,     32,   0 },
-    { "fixup_M6502_REL32",        0,     32,   0 },
-    { "fixup_M6502_26",           0,     26,   0 },
-    { "fixup_M6502_HI16",         0,     16,   0 },
-    { "fixup_M6502_LO16",         0,     16,   0 },
-    { "fixup_M6502_GPREL16",      0,     16,   0 },
-    { "fixup_M6502_LITERAL",      0,     16,   0 },
-    { "fixup_M6502_GOT",          0,     16,   0 },
-    { "fixup_M6502_PC16",         0,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_CALL16",       0,     16,   0 },
-    { "fixup_M6502_GPREL32",      0,     32,   0 },
-    { "fixup_M6502_SHIFT5",       6,      5,   0 },
-    { "fixup_M6502_SHIFT6",       6,      5,   0 },
-    { "fixup_M6502_64",           0,     64,   0 },
-    { "fixup_M6502_TLSGD",        0,     16,   0 },
-    { "fixup_M6502_GOTTPREL",     0,     16,   0 },
-    { "fixup_M6502_TPREL_HI",     0,     16,   0 },
-    { "fixup_M6502_TPREL_LO",     0,     16,   0 },
-    { "fixup_M6502_TLSLDM",       0,     16,   0 },
-    { "fixup_M6502_DTPREL_HI",    0,     16,   0 },
-    { "fixup_M6502_DTPREL_LO",    0,     16,   0 },
-    { "fixup_M6502_Branch_PCRel", 0,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_GPOFF_HI",     0,     16,   0 },
-    { "fixup_M6502_GPOFF_LO",     0,     16,   0 },
-    { "fixup_M6502_GOT_PAGE",     0,     16,   0 },
-    { "fixup_M6502_GOT_OFST",     0,     16,   0 },
-    { "fixup_M6502_GOT_DISP",     0,     16,   0 },
-    { "fixup_M6502_HIGHER",       0,     16,   0 },
-    { "fixup_M6502_HIGHEST",      0,     16,   0 },
-    { "fixup_M6502_GOT_HI16",     0,     16,   0 },
-    { "fixup_M6502_GOT_LO16",     0,     16,   0 },
-    { "fixup_M6502_CALL_HI16",    0,     16,   0 },
-    { "fixup_M6502_CALL_LO16",    0,     16,   0 },
-    { "fixup_M6502_PC18_S3",      0,     18,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PC19_S2",      0,     19,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PC21_S2",      0,     21,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PC26_S2",      0,     26,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PCHI16",       0,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PCLO16",       0,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_26_S1",   0,     26,   0 },
-    { "fixup_MICROM6502_HI16",    0,     16,   0 },
-    { "fixup_MICROM6502_LO16",    0,     16,   0 },
-    { "fixup_MICROM6502_GOT16",   0,     16,   0 },
-    { "fixup_MICROM6502_PC7_S1",  0,      7,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC10_S1", 0,     10,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC16_S1", 0,     16,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC26_S1", 0,     26,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC19_S2", 0,     19,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC18_S3", 0,     18,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC21_S1", 0,     21,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_CALL16",  0,     16,   0 },
-    { "fixup_MICROM6502_GOT_DISP",        0,     16,   0 },
-    { "fixup_MICROM6502_GOT_PAGE",        0,     16,   0 },
-    { "fixup_MICROM6502_GOT_OFST",        0,     16,   0 },
-    { "fixup_MICROM6502_TLS_GD",          0,     16,   0 },
-    { "fixup_MICROM6502_TLS_LDM",         0,     16,   0 },
-    { "fixup_MICROM6502_TLS_DTPREL_HI16", 0,     16,   0 },
-    { "fixup_MICROM6502_TLS_DTPREL_LO16", 0,     16,   0 },
-    { "fixup_MICROM6502_GOTTPREL",        0,     16,   0 },
-    { "fixup_MICROM6502_TLS_TPREL_HI16",  0,     16,   0 },
-    { "fixup_MICROM6502_TLS_TPREL_LO16",  0,     16,   0 },
-    { "fixup_M6502_SUB",                  0,     64,   0 },
-    { "fixup_MICROM6502_SUB",             0,     64,   0 }
-  };
-
-  const static MCFixupKindInfo BigEndianInfos[M6502::NumTargetFixupKinds] = {
-    // This table *must* be in same the order of fixup_* kinds in
-    // M6502FixupKinds.h.
-    //
-    // name                    offset  bits  flags
-    { "fixup_M6502_NONE",         0,      0,   0 },
-    { "fixup_M6502_16",          16,     16,   0 },
-    { "fixup_M6502_32",           0,     32,   0 },
-    { "fixup_M6502_REL32",        0,     32,   0 },
-    { "fixup_M6502_26",           6,     26,   0 },
-    { "fixup_M6502_HI16",        16,     16,   0 },
-    { "fixup_M6502_LO16",        16,     16,   0 },
-    { "fixup_M6502_GPREL16",     16,     16,   0 },
-    { "fixup_M6502_LITERAL",     16,     16,   0 },
-    { "fixup_M6502_GOT",         16,     16,   0 },
-    { "fixup_M6502_PC16",        16,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_CALL16",      16,     16,   0 },
-    { "fixup_M6502_GPREL32",      0,     32,   0 },
-    { "fixup_M6502_SHIFT5",      21,      5,   0 },
-    { "fixup_M6502_SHIFT6",      21,      5,   0 },
-    { "fixup_M6502_64",           0,     64,   0 },
-    { "fixup_M6502_TLSGD",       16,     16,   0 },
-    { "fixup_M6502_GOTTPREL",    16,     16,   0 },
-    { "fixup_M6502_TPREL_HI",    16,     16,   0 },
-    { "fixup_M6502_TPREL_LO",    16,     16,   0 },
-    { "fixup_M6502_TLSLDM",      16,     16,   0 },
-    { "fixup_M6502_DTPREL_HI",   16,     16,   0 },
-    { "fixup_M6502_DTPREL_LO",   16,     16,   0 },
-    { "fixup_M6502_Branch_PCRel",16,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_GPOFF_HI",    16,     16,   0 },
-    { "fixup_M6502_GPOFF_LO",    16,     16,   0 },
-    { "fixup_M6502_GOT_PAGE",    16,     16,   0 },
-    { "fixup_M6502_GOT_OFST",    16,     16,   0 },
-    { "fixup_M6502_GOT_DISP",    16,     16,   0 },
-    { "fixup_M6502_HIGHER",      16,     16,   0 },
-    { "fixup_M6502_HIGHEST",     16,     16,   0 },
-    { "fixup_M6502_GOT_HI16",    16,     16,   0 },
-    { "fixup_M6502_GOT_LO16",    16,     16,   0 },
-    { "fixup_M6502_CALL_HI16",   16,     16,   0 },
-    { "fixup_M6502_CALL_LO16",   16,     16,   0 },
-    { "fixup_M6502_PC18_S3",     14,     18,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PC19_S2",     13,     19,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PC21_S2",     11,     21,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PC26_S2",      6,     26,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PCHI16",      16,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_M6502_PCLO16",      16,     16,  MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_26_S1",   6,     26,   0 },
-    { "fixup_MICROM6502_HI16",   16,     16,   0 },
-    { "fixup_MICROM6502_LO16",   16,     16,   0 },
-    { "fixup_MICROM6502_GOT16",  16,     16,   0 },
-    { "fixup_MICROM6502_PC7_S1",  9,      7,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC10_S1", 6,     10,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC16_S1",16,     16,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC26_S1", 6,     26,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC19_S2",13,     19,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC18_S3",14,     18,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_PC21_S1",11,     21,   MCFixupKindInfo::FKF_IsPCRel },
-    { "fixup_MICROM6502_CALL16", 16,     16,   0 },
-    { "fixup_MICROM6502_GOT_DISP",        16,     16,   0 },
-    { "fixup_MICROM6502_GOT_PAGE",        16,     16,   0 },
-    { "fixup_MICROM6502_GOT_OFST",        16,     16,   0 },
-    { "fixup_MICROM6502_TLS_GD",          16,     16,   0 },
-    { "fixup_MICROM6502_TLS_LDM",         16,     16,   0 },
-    { "fixup_MICROM6502_TLS_DTPREL_HI16", 16,     16,   0 },
-    { "fixup_MICROM6502_TLS_DTPREL_LO16", 16,     16,   0 },
-    { "fixup_MICROM6502_GOTTPREL",        16,     16,   0 },
-    { "fixup_MICROM6502_TLS_TPREL_HI16",  16,     16,   0 },
-    { "fixup_MICROM6502_TLS_TPREL_LO16",  16,     16,   0 },
-    { "fixup_M6502_SUB",                   0,     64,   0 },
-    { "fixup_MICROM6502_SUB",              0,     64,   0 }
+    { "fixup_M6502_ZP8",          0,      8,   0 },
+    { "fixup_M6502_ABS16",        0,     16,   0 },
+    { "fixup_M6502_PCREL8",       0,      8,  MCFixupKindInfo::FKF_IsPCRel },
+    { "fixup_M6502_LO8",          0,      8,   0 },
+    { "fixup_M6502_HI8",          0,      8,   0 }
   };
 
   if (Kind < FirstTargetFixupKind)
@@ -453,9 +155,56 @@ getFixupKindInfo(MCFixupKind Kind) const {
   assert(unsigned(Kind - FirstTargetFixupKind) < getNumFixupKinds() &&
           "Invalid kind!");
 
-  if (IsLittle)
-    return LittleEndianInfos[Kind - FirstTargetFixupKind];
-  return BigEndianInfos[Kind - FirstTargetFixupKind];
+  return Infos[Kind - FirstTargetFixupKind];
+}
+
+bool M6502AsmBackend::mayNeedRelaxation(const MCInst &Inst) const {
+  return Inst.getFlags() & M6502II::MCIF_ZeroPage;
+}
+
+/// Return true if the zero page section holds symbols defined in Sec, so that
+/// the linker places them below $100.
+static bool isZeroPageSection(const MCSection &Sec) {
+  StringRef Name = cast<MCSectionELF>(Sec).getSectionName();
+  return Name == ".zp" || Name.startswith(".zp.");
+}
+
+bool M6502AsmBackend::fixupNeedsRelaxationAdvanced(
+    const MCFixup &Fixup, bool Resolved, uint64_t Value,
+    const MCRelaxableFragment *DF, const MCAsmLayout &Layout) const {
+  // An indexed access through a constant base may reach past the zero page
+  // whatever the base is.
+  bool IsIndexed = DF->getInst().getFlags() & M6502II::MCIF_Indexed;
+  if (Resolved)
+    return IsIndexed || !isUInt<8>(Value);
+
+  // An address in a zero page section of this object is known to fit, and is
+  // left to a zero page relocation.
+  MCValue Target;
+  if (!Fixup.getValue()->evaluateAsRelocatable(Target, &Layout, &Fixup) ||
+      !Target.getSymA() || Target.getSymB())
+    return true;
+
+  const MCSymbol &Sym = Target.getSymA()->getSymbol();
+  return !Sym.isInSection() || !isZeroPageSection(Sym.getSection()) ||
+         !isUInt<8>(Target.getConstant());
+}
+
+bool M6502AsmBackend::fixupNeedsRelaxation(const MCFixup &Fixup,
+                                           uint64_t Value,
+                                           const MCRelaxableFragment *DF,
+                                           const MCAsmLayout &Layout) const {
+  return !isUInt<8>(Value);
+}
+
+void M6502AsmBackend::relaxInstruction(const MCInst &Inst,
+                                       const MCSubtargetInfo &STI,
+                                       MCInst &Res) const {
+  int AbsOpcode = M6502::getAbsoluteOpcode(Inst.getOpcode());
+  assert(AbsOpcode >= 0 && "Relaxing an instruction without absolute form");
+  Res = Inst;
+  Res.setOpcode(AbsOpcode);
+  Res.setFlags(0);
 }
 
 /// WriteNopData - Write an (optimal) nop sequence of Count bytes
@@ -464,14 +213,10 @@ getFixupKindInfo(MCFixupKind Kind) const {
 ///
 /// \return - True on success.
 bool M6502AsmBackend::writeNopData(uint64_t Count, MCObjectWriter *OW) const {
-  // Check for a less than instruction size number of bytes
-  // FIXME: 16 bit instructions are not handled yet here.
-  // We shouldn't be using a hard coded number for instruction size.
-
-  // If the count is not 4-byte aligned, we must be writing data into the text
-  // section (otherwise we have unaligned instructions, and thus have far
-  // bigger problems), so just write zeros instead.
-  OW->WriteZeros(Count);
+  // NOP is a single byte, so any padding can be executed.  Zeros would be
+  // BRKs.
+  for (uint64_t i = 0; i != Count; ++i)
+    OW->write8(0xEA);
   return true;
 }
 
@@ -479,5 +224,5 @@ MCAsmBackend *llvm::createM6502AsmBackend(const Target &T,
                                          const MCRegisterInfo &MRI,
                                          const Triple &TT, StringRef CPU,
                                          const MCTargetOptions &Options) {
-  return new M6502AsmBackend(T, MRI, TT, CPU, Options.ABIName == "n32");
+  return new M6502AsmBackend(T, MRI, TT, CPU);
 }
@@ -29,13 +29,11 @@ class Target;
 
 class M6502AsmBackend : public MCAsmBackend {
   Triple TheTriple;
-  bool IsLittle; // Big or little endian
-  bool IsN32;
 
 public:
   M6502AsmBackend(const Target &T, const MCRegisterInfo &MRI, const Triple &TT,
-                 StringRef CPU, bool N32)
-      : TheTriple(TT), IsLittle(TT.isLittleEndian()), IsN32(N32) {}
+                 StringRef CPU)
+      : TheTriple(TT) {}
 
   std::unique_ptr<MCObjectWriter>
   createObjectWriter(raw_pwrite_stream &OS) const override;
@@ -55,31 +53,31 @@ public:
   /// @{
 
   /// MayNeedRelaxation - Check whether the given instruction may need
-  /// relaxation.
+  /// relaxation.  Only the zero page instructions standing for absolute ones
+  /// do, see M6502ELFStreamer.
   ///
   /// \param Inst - The instruction to test.
-  bool mayNeedRelaxation(const MCInst &Inst) const override {
-    return false;
-  }
+  bool mayNeedRelaxation(const MCInst &Inst) const override;
 
-  /// fixupNeedsRelaxation - Target specific predicate for whether a given
-  /// fixup requires the associated instruction to be relaxed.
-   bool fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
-                             const MCRelaxableFragment *DF,
-                             const MCAsmLayout &Layout) const override {
-    // FIXME.
-    llvm_unreachable("RelaxInstruction() unimplemented");
-    return false;
-  }
+  /// fixupNeedsRelaxationAdvanced - Return true unless the address is known
+  /// to fit in a byte: it resolves to one, or it lies in a zero page section.
+  bool fixupNeedsRelaxationAdvanced(const MCFixup &Fixup, bool Resolved,
+                                    uint64_t Value,
+                                    const MCRelaxableFragment *DF,
+                                    const MCAsmLayout &Layout) const override;
+
+  bool fixupNeedsRelaxation(const MCFixup &Fixup, uint64_t Value,
+                            const MCRelaxableFragment *DF,
+                            const MCAsmLayout &Layout) const override;
 
   /// RelaxInstruction - Relax the instruction in the given fragment
-  /// to the next wider instruction.
+  /// to the next wider instruction, the absolute form.
   ///
   /// \param Inst - The instruction to relax, which may be the same
   /// as the output.
   /// \param [out] Res On return, the relaxed instruction.
   void relaxInstruction(const MCInst &Inst, const MCSubtargetInfo &STI,
-                        MCInst &Res) const override {}
+                        MCInst &Res) const override;
 
   /// @}
 
@@ -1,4 +1,4 @@
-//===-- M6502BaseInfo.h - Top level definitions for M6502 MC ------*- C++ -*-===//
+//===-- M6502BaseInfo.h - Top level definitions for M6502 MC ----*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -33,69 +33,20 @@ namespace M6502II {
 
     MO_NO_FLAG,
 
-    /// MO_GOT - Represents the offset into the global offset table at which
-    /// the address the relocation entry symbol resides during execution.
-    MO_GOT,
-
-    /// MO_GOT_CALL - Represents the offset into the global offset table at
-    /// which the address of a call site relocation entry symbol resides
-    /// during execution. This is different from the above since this flag
-    /// can only be present in call instructions.
-    MO_GOT_CALL,
-
-    /// MO_GPREL - Represents the offset from the current gp value to be used
-    /// for the relocatable object file being produced.
-    MO_GPREL,
-
-    /// MO_ABS_HI/LO - Represents the hi or low part of an absolute symbol
+    /// MO_ABS_HI/LO - Represents the hi or low byte of an absolute symbol
     /// address.
-    MO_ABS_HI,
     MO_ABS_LO,
+    MO_ABS_HI,
 
-    /// MO_TLSGD - Represents the offset into the global offset table at which
-    // the module ID and TSL block offset reside during execution (General
-    // Dynamic TLS).
-    MO_TLSGD,
-
-    /// MO_TLSLDM - Represents the offset into the global offset table at which
-    // the module ID and TSL block offset reside during execution (Local
-    // Dynamic TLS).
-    MO_TLSLDM,
-    MO_DTPREL_HI,
-    MO_DTPREL_LO,
-
-    /// MO_GOTTPREL - Represents the offset from the thread pointer (Initial
-    // Exec TLS).
-    MO_GOTTPREL,
-
-    /// MO_TPREL_HI/LO - Represents the hi and low part of the offset from
-    // the thread pointer (Local Exec TLS).
-    MO_TPREL_HI,
-    MO_TPREL_LO,
-
-    // N32/64 Flags.
-    MO_GPOFF_HI,
-    MO_GPOFF_LO,
-    MO_GOT_DISP,
-    MO_GOT_PAGE,
-    MO_GOT_OFST,
-
-    /// MO_HIGHER/HIGHEST - Represents the highest or higher half word of a
-    /// 64-bit symbol address.
-    MO_HIGHER,
-    MO_HIGHEST,
-
-    /// MO_GOT_HI16/LO16, MO_CALL_HI16/LO16 - Relocations used for large GOTs.
-    MO_GOT_HI16,
-    MO_GOT_LO16,
-    MO_CALL_HI16,
-    MO_CALL_LO16
+    /// MO_JT_HI - Represents the table of the high bytes of the addresses in
+    /// a jump table, which follows the table of the low bytes.
+    MO_JT_HI
   };
 
   enum {
     //===------------------------------------------------------------------===//
-    // Instruction encodings.  These are the standard/most common forms for
-    // M6502 instructions.
+    // Instruction encodings.  The format of an instruction is its addressing
+    // mode; it must be kept in sync with M6502InstrFormats.td.
     //
 
     // Pseudo - This represents an instruction that is a pseudo instruction
@@ -103,31 +54,130 @@ namespace M6502II {
     // it, but tolerated for intermediate implementation stages.
     Pseudo   = 0,
 
-    /// FrmR - This form is for instructions of the format R.
-    FrmR  = 1,
-    /// FrmI - This form is for instructions of the format I.
-    FrmI  = 2,
-    /// FrmJ - This form is for instructions of the format J.
-    FrmJ  = 3,
-    /// FrmFR - This form is for instructions of the format FR.
-    FrmFR = 4,
-    /// FrmFI - This form is for instructions of the format FI.
-    FrmFI = 5,
-    /// FrmOther - This form is for instructions that have no specific format.
-    FrmOther = 6,
-
-    FormMask = 15,
-    /// IsCTI - Instruction is a Control Transfer Instruction.
-    IsCTI = 1 << 4,
-    /// HasForbiddenSlot - Instruction has a forbidden slot.
-    HasForbiddenSlot = 1 << 5,
-    /// IsPCRelativeLoad - A Load instruction with implicit source register
-    ///                    ($pc) with explicit offset and destination register
-    IsPCRelativeLoad = 1 << 6,
-    /// HasFCCRegOperand - Instruction uses an $fcc<x> register.
-    HasFCCRegOperand = 1 << 7
+    /// FrmImpl - Implied or accumulator operand, no operand byte.
+    FrmImpl  = 1,
+    /// FrmImm - #imm.
+    FrmImm   = 2,
+    /// FrmZP, FrmZPX, FrmZPY - Zero page, optionally indexed.
+    FrmZP    = 3,
+    FrmZPX   = 4,
+    FrmZPY   = 5,
+    /// FrmAbs, FrmAbsX, FrmAbsY - Absolute, optionally indexed.
+    FrmAbs   = 6,
+    FrmAbsX  = 7,
+    FrmAbsY  = 8,
+    /// FrmInd - (abs), only used by JMP.
+    FrmInd   = 9,
+    /// FrmIndX - (zp,x).
+    FrmIndX  = 10,
+    /// FrmIndY - (zp),y.
+    FrmIndY  = 11,
+    /// FrmRel - PC relative branch.
+    FrmRel   = 12,
+    /// FrmIndZP - (zp), 65C02 only.
+    FrmIndZP = 13,
+    /// FrmZPRel - Zero page address and PC relative branch of BBR and BBS.
+    FrmZPRel = 14,
+
+    FormMask = 31,
 
+    //===------------------------------------------------------------------===//
+    // M6502 Specific flags.
+
+    /// PageCross - The instruction takes one more cycle when its indexed
+    /// effective address, or the target of the taken branch, lies in another
+    /// page than the base address or the next instruction.  The scheduling
+    /// models count the cycles without this penalty.
+    PageCross = 1 << 5,
+
+    /// FlagsUsedShift, FlagsDefinedShift - The position of the masks of the
+    /// status flags the instruction reads and writes.
+    FlagsUsedShift = 6,
+    FlagsDefinedShift = 10,
+
+    /// AccWidth - The width of the accumulator and memory the instruction
+    /// needs on the 65816, given by its M flag.  Instructions which neither
+    /// touch A nor operate on memory through it work with either.
+    AccWidthShift = 14,
+    AccWidthMask = 3 << AccWidthShift,
+    AccAny = 0 << AccWidthShift,
+    Acc8 = 1 << AccWidthShift,
+    Acc16 = 2 << AccWidthShift
   };
+
+  /// Status flags, as used in the masks of the flags an instruction reads
+  /// and writes.
+  enum {
+    FlagN = 1 << 0,
+    FlagZ = 1 << 1,
+    FlagC = 1 << 2,
+    FlagV = 1 << 3,
+    FlagsNZ = FlagN | FlagZ,
+    FlagsAll = FlagN | FlagZ | FlagC | FlagV
+  };
+
+  /// Return the status flags read by the instruction with the TSFlags.
+  inline unsigned getFlagsUsed(uint64_t TSFlags) {
+    return (TSFlags >> FlagsUsedShift) & FlagsAll;
+  }
+
+  /// Return the status flags written by the instruction with the TSFlags.
+  inline unsigned getFlagsDefined(uint64_t TSFlags) {
+    return (TSFlags >> FlagsDefinedShift) & FlagsAll;
+  }
+
+  /// Return the accumulator width needed by the instruction with the TSFlags,
+  /// one of AccAny, Acc8 and Acc16.
+  inline unsigned getAccWidth(uint64_t TSFlags) {
+    return TSFlags & AccWidthMask;
+  }
+
+  /// MCInst flags.
+  enum {
+    /// MCIF_ZeroPage - The instruction was given the zero page form of an
+    /// absolute instruction by the object streamer, and the assembler grows
+    /// it back unless its address turns out to fit in a byte.
+    MCIF_ZeroPage = 1,
+    /// MCIF_Indexed - The zero page form is indexed, and so it is only kept
+    /// for an object in a zero page section.
+    MCIF_Indexed = 2
+  };
+}
+
+/// M6502CC - Condition codes of the compare and branch pseudo instructions.
+/// Each one maps to a single branch on the flags set by CMP.
+namespace M6502CC {
+  enum CondCode {
+    COND_EQ, // Z set
+    COND_NE, // Z clear
+    COND_LT, // C clear: unsigned lower
+    COND_GE, // C set: unsigned higher or same
+    COND_MI, // N set
+    COND_PL, // N clear
+    COND_VS, // V set
+    COND_VC, // V clear
+    COND_INVALID
+  };
+
+  inline static CondCode getOppositeCondition(CondCode CC) {
+    // The conditions come in pairs which only differ by the low bit.
+    assert(CC < COND_INVALID && "Invalid condition code!");
+    return static_cast<CondCode>(CC ^ 1);
+  }
+
+  inline static const char *getCondCodeName(CondCode CC) {
+    switch (CC) {
+    case COND_EQ: return "eq";
+    case COND_NE: return "ne";
+    case COND_LT: return "lt";
+    case COND_GE: return "ge";
+    case COND_MI: return "mi";
+    case COND_PL: return "pl";
+    case COND_VS: return "vs";
+    case COND_VC: return "vc";
+    default: llvm_unreachable("Invalid condition code!");
+    }
+  }
 }
 }
 
@@ -1,4 +1,4 @@
-//===-------- M6502ELFStreamer.cpp - ELF Object Output ---------------------===//
+//===-------- M6502ELFStreamer.cpp - ELF Object Output --------------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -8,16 +8,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "M6502ELFStreamer.h"
-#include "M6502OptionRecord.h"
-#include "M6502TargetStreamer.h"
-#include "llvm/BinaryFormat/ELF.h"
+#include "MCTargetDesc/M6502BaseInfo.h"
+#include "MCTargetDesc/M6502MCTargetDesc.h"
 #include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCAssembler.h"
 #include "llvm/MC/MCCodeEmitter.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCInst.h"
-#include "llvm/MC/MCSymbolELF.h"
-#include "llvm/Support/Casting.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/Support/MathExtras.h"
 
 using namespace llvm;
 
@@ -25,59 +25,40 @@ M6502ELFStreamer::M6502ELFStreamer(MCContext &Context,
                                  std::unique_ptr<MCAsmBackend> MAB,
                                  raw_pwrite_stream &OS,
                                  std::unique_ptr<MCCodeEmitter> Emitter)
-    : MCELFStreamer(Context, std::move(MAB), OS, std::move(Emitter)) {
-  RegInfoRecord = new M6502RegInfoRecord(this, Context);
-  M6502OptionRecords.push_back(
-      std::unique_ptr<M6502RegInfoRecord>(RegInfoRecord));
+    : MCELFStreamer(Context, std::move(MAB), OS, std::move(Emitter)) {}
+
+void M6502ELFStreamer::InitSections(bool NoExecStack) {
+  MCContext &Ctx = getContext();
+  SwitchSection(Ctx.getObjectFileInfo()->getTextSection());
+  if (NoExecStack)
+    SwitchSection(Ctx.getAsmInfo()->getNonexecutableStackSection(Ctx));
 }
 
 void M6502ELFStreamer::EmitInstruction(const MCInst &Inst,
-                                      const MCSubtargetInfo &STI, bool) {
-  MCELFStreamer::EmitInstruction(Inst, STI);
-
-  MCContext &Context = getContext();
-  const MCRegisterInfo *MCRegInfo = Context.getRegisterInfo();
-
-  for (unsigned OpIndex = 0; OpIndex < Inst.getNumOperands(); ++OpIndex) {
-    const MCOperand &Op = Inst.getOperand(OpIndex);
-
-    if (!Op.isReg())
-      continue;
-
-    unsigned Reg = Op.getReg();
-    RegInfoRecord->SetPhysRegUsed(Reg, MCRegInfo);
+                                      const MCSubtargetInfo &STI,
+                                      bool PrintSchedInfo) {
+  int ZPOpcode = M6502::getZeroPageOpcode(Inst.getOpcode());
+  if (ZPOpcode < 0) {
+    MCELFStreamer::EmitInstruction(Inst, STI, PrintSchedInfo);
+    return;
   }
 
-  createPendingLabelRelocs();
-}
-
-void M6502ELFStreamer::createPendingLabelRelocs() {
-  M6502TargetELFStreamer *ELFTargetStreamer =
-      static_cast<M6502TargetELFStreamer *>(getTargetStreamer());
-
-  Labels.clear();
-}
-
-void M6502ELFStreamer::EmitLabel(MCSymbol *Symbol, SMLoc Loc) {
-  MCELFStreamer::EmitLabel(Symbol);
-  Labels.push_back(Symbol);
-}
-
-void M6502ELFStreamer::SwitchSection(MCSection *Section,
-                                    const MCExpr *Subsection) {
-  MCELFStreamer::SwitchSection(Section, Subsection);
-  Labels.clear();
-}
-
-void M6502ELFStreamer::EmitValueImpl(const MCExpr *Value, unsigned Size,
-                                    SMLoc Loc) {
-  MCELFStreamer::EmitValueImpl(Value, Size, Loc);
-  Labels.clear();
-}
+  // A constant address is known to fit or not.  Otherwise the instruction
+  // starts small and grows during relaxation.  A constant base plus an index
+  // may reach past the zero page, so it keeps the absolute form.
+  const MCOperand &Addr = Inst.getOperand(0);
+  bool IsIndexed = M6502::getIndexedZeroPageOpcode(Inst.getOpcode()) >= 0;
+  MCInst ZPInst(Inst);
+  ZPInst.setOpcode(ZPOpcode);
+  if (Addr.isExpr())
+    ZPInst.setFlags(M6502II::MCIF_ZeroPage |
+                    (IsIndexed ? M6502II::MCIF_Indexed : 0));
+  else if (IsIndexed || !Addr.isImm() || !isUInt<8>(Addr.getImm())) {
+    MCELFStreamer::EmitInstruction(Inst, STI, PrintSchedInfo);
+    return;
+  }
 
-void M6502ELFStreamer::EmitM6502OptionRecords() {
-  for (const auto &I : M6502OptionRecords)
-    I->EmitM6502OptionRecord();
+  MCELFStreamer::EmitInstruction(ZPInst, STI, PrintSchedInfo);
 }
 
 MCELFStreamer *llvm::createM6502ELFStreamer(
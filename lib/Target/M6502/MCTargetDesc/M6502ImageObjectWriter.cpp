@@ -0,0 +1,470 @@
+//===- M6502ImageObjectWriter.cpp - M6502 load image writer ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements an object writer which links the module into a flat
+// load image instead of writing a relocatable ELF object:
+//
+//   raw  - the bytes of the loaded regions,
+//   prg  - a C64 program: the load address followed by the bytes of the one
+//          loaded region,
+//   ines - an iNES cartridge: a 16 byte header, the first loaded region as
+//          PRG ROM and the second one, if any, as CHR ROM.
+//
+// The sections are given addresses with a memory map (see M6502MemoryMap.h),
+// from -m6502-memory-map or a default one for the format, and every fixup
+// left to a relocation is resolved against them.  A symbol which is not
+// defined in the module is an error.  The addresses of the symbols can be
+// written to a symbol file, one "$<address> <name>" per line, for the
+// simulator and debuggers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCTargetDesc/M6502MCTargetDesc.h"
+#include "MCTargetDesc/M6502MemoryMap.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCAsmLayout.h"
+#include "llvm/MC/MCAssembler.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCFixup.h"
+#include "llvm/MC/MCFixupKindInfo.h"
+#include "llvm/MC/MCObjectWriter.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/MC/MCSymbolELF.h"
+#include "llvm/MC/MCValue.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "m6502-image-writer"
+
+static cl::opt<std::string>
+MemoryMapFile("m6502-memory-map", cl::value_desc("filename"),
+              cl::desc("M6502: Memory map placing the sections of an image"));
+
+static cl::opt<std::string>
+SymbolFile("m6502-image-symbols", cl::value_desc("filename"),
+           cl::desc("M6502: Write the addresses of the symbols of an image"));
+
+static cl::opt<unsigned>
+INESMapper("m6502-ines-mapper", cl::init(0),
+           cl::desc("M6502: Mapper number of an iNES image (default=0)"));
+
+static cl::opt<bool>
+INESVertical("m6502-ines-vertical-mirroring", cl::init(false),
+             cl::desc("M6502: Vertical nametable mirroring in an iNES image"));
+
+namespace {
+
+const uint64_t INESPRGBankSize = 16384;
+const uint64_t INESCHRBankSize = 8192;
+
+class M6502ImageObjectWriter : public MCObjectWriter {
+  M6502::ImageFormat Format;
+  M6502MemoryMap Map;
+
+  /// The address of each allocated section.
+  DenseMap<const MCSection *, uint64_t> Addresses;
+
+  /// The sections of each region of the map.
+  std::vector<SmallVector<const MCSection *, 8>> RegionSections;
+
+  bool loadMemoryMap(MCContext &Ctx);
+  bool getSymbolAddress(MCContext &Ctx, const MCAsmLayout &Layout,
+                        const MCFixup &Fixup, const MCSymbol &Sym,
+                        uint64_t &Address) const;
+  void writeRegion(MCAssembler &Asm, const MCAsmLayout &Layout, unsigned Idx,
+                   std::vector<uint8_t> &Bytes);
+  void writeSymbolFile(MCAssembler &Asm, const MCAsmLayout &Layout);
+
+public:
+  M6502ImageObjectWriter(raw_pwrite_stream &OS, M6502::ImageFormat Format)
+      : MCObjectWriter(OS, /*IsLittleEndian=*/true), Format(Format) {}
+
+  ~M6502ImageObjectWriter() override = default;
+
+  void executePostLayoutBinding(MCAssembler &Asm,
+                                const MCAsmLayout &Layout) override;
+  void recordRelocation(MCAssembler &Asm, const MCAsmLayout &Layout,
+                        const MCFragment *Fragment, const MCFixup &Fixup,
+                        MCValue Target, uint64_t &FixedValue) override;
+  void writeObject(MCAssembler &Asm, const MCAsmLayout &Layout) override;
+};
+
+} // end anonymous namespace
+
+/// Return the memory map used when none is given.  The zero page sections
+/// take the larger of the free ranges below and above the register bank,
+/// which is as large as -m6502-zp-regs makes it, and stay clear of $00-$01,
+/// the I/O port of the 6510.
+static std::string getDefaultMemoryMap(M6502::ImageFormat Format) {
+  unsigned RegBase = getM6502ZPRegBase();
+  unsigned RegEnd = RegBase + getM6502NumZPRegs();
+  bool Below = RegBase > 2 && RegBase - 2 >= 0x100 - RegEnd;
+  unsigned ZPStart = Below ? 2 : RegEnd;
+  unsigned ZPEnd = Below ? RegBase - 1 : 0xff;
+
+  std::string Text;
+  raw_string_ostream OS(Text);
+  OS << "MEMORY zp $" << utohexstr(ZPStart) << " $" << utohexstr(ZPEnd)
+     << " NOLOAD\n";
+
+  switch (Format) {
+  case M6502::IF_ELF:
+    llvm_unreachable("An ELF object has no memory map");
+  case M6502::IF_Raw:
+    OS << "MEMORY ram $0200 $FFFF\n";
+    break;
+  case M6502::IF_PRG:
+    // The BASIC area of the C64.
+    OS << "MEMORY ram $0801 $9FFF\n";
+    break;
+  case M6502::IF_INES:
+    OS << "MEMORY ram $0200 $07FF NOLOAD\n"
+       << "MEMORY prg $8000 $FFFF ROM FILL $FF\n"
+       << "MEMORY chr $0000 $1FFF ROM\n"
+       << "PLACE .bss .bss.* IN ram\n"
+       << "PLACE .chr .chr.* IN chr\n"
+       << "PLACE .vectors IN prg AT $FFFA\n";
+    break;
+  }
+
+  OS << "PLACE .zp .zp.* IN zp\n"
+     << "PLACE .text .text.* IN "
+     << (Format == M6502::IF_INES ? "prg" : "ram") << "\n"
+     << "PLACE * IN " << (Format == M6502::IF_INES ? "prg" : "ram") << "\n";
+  return OS.str();
+}
+
+bool M6502ImageObjectWriter::loadMemoryMap(MCContext &Ctx) {
+  std::string Text;
+  if (MemoryMapFile.empty())
+    Text = getDefaultMemoryMap(Format);
+  else {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
+        MemoryBuffer::getFile(MemoryMapFile);
+    if (!Buf) {
+      Ctx.reportError(SMLoc(), "cannot read memory map '" + MemoryMapFile +
+                                   "': " + Buf.getError().message());
+      return false;
+    }
+    Text = (*Buf)->getBuffer();
+  }
+
+  Expected<M6502MemoryMap> Parsed = M6502MemoryMap::parse(Text);
+  if (!Parsed) {
+    Ctx.reportError(SMLoc(), toString(Parsed.takeError()));
+    return false;
+  }
+  Map = std::move(*Parsed);
+  return true;
+}
+
+/// Give an address to every allocated section.  The sections of a region
+/// follow one another from its start, and the ones placed at an address go
+/// there.
+void M6502ImageObjectWriter::executePostLayoutBinding(
+    MCAssembler &Asm, const MCAsmLayout &Layout) {
+  MCContext &Ctx = Asm.getContext();
+  if (!loadMemoryMap(Ctx))
+    return;
+
+  ArrayRef<M6502MemoryRegion> Regions = Map.regions();
+  typedef std::pair<const M6502Placement *, const MCSection *> PlacedSection;
+  std::vector<SmallVector<PlacedSection, 8>> Placed(Regions.size());
+  for (const MCSection &Sec : Asm) {
+    const auto &ELFSec = cast<MCSectionELF>(Sec);
+    if (!(ELFSec.getFlags() & ELF::SHF_ALLOC))
+      continue;
+
+    const M6502Placement *P = Map.findPlacement(ELFSec.getSectionName());
+    if (!P) {
+      Ctx.reportError(SMLoc(), "section " + ELFSec.getSectionName() +
+                                   " is not placed by the memory map");
+      continue;
+    }
+    // Nothing copies the initial values of a section to RAM, so a variable
+    // placed in ROM would keep them whatever the program stores.
+    if ((ELFSec.getFlags() & ELF::SHF_WRITE) && !Sec.isVirtualSection() &&
+        Map.regions()[P->Region].ReadOnly)
+      Ctx.reportError(SMLoc(), "writable section " +
+                                   ELFSec.getSectionName() +
+                                   " is initialized in ROM region " +
+                                   Map.regions()[P->Region].Name);
+    Placed[P->Region].push_back({P, &Sec});
+  }
+
+  struct Range {
+    uint64_t Start, End;
+    const MCSection *Sec;
+  };
+
+  RegionSections.assign(Regions.size(), {});
+  for (unsigned Idx = 0; Idx < Regions.size(); ++Idx) {
+    const M6502MemoryRegion &Region = Regions[Idx];
+    std::stable_sort(Placed[Idx].begin(), Placed[Idx].end(),
+                     [&](const PlacedSection &A, const PlacedSection &B) {
+                       return Map.getPlacementIndex(*A.first) <
+                              Map.getPlacementIndex(*B.first);
+                     });
+
+    SmallVector<Range, 8> Ranges;
+    uint64_t Next = Region.Start;
+    DenseMap<const M6502Placement *, uint64_t> NextAt;
+    for (const PlacedSection &Entry : Placed[Idx]) {
+      const M6502Placement *P = Entry.first;
+      const MCSection *Sec = Entry.second;
+      uint64_t &Cursor = P->At ? NextAt.insert({P, *P->At}).first->second
+                               : Next;
+      uint64_t Size = Layout.getSectionAddressSize(Sec);
+
+      Cursor = alignTo(Cursor, Sec->getAlignment());
+      Addresses[Sec] = Cursor;
+      Ranges.push_back({Cursor, Cursor + Size, Sec});
+      RegionSections[Idx].push_back(Sec);
+      Cursor += Size;
+
+      if (Cursor > Region.End + 1)
+        Ctx.reportError(SMLoc(), "section " +
+                                     cast<MCSectionELF>(Sec)->getSectionName() +
+                                     " overflows region " + Region.Name +
+                                     " by " + Twine(Cursor - Region.End - 1) +
+                                     " bytes");
+    }
+
+    std::sort(Ranges.begin(), Ranges.end(),
+              [](const Range &A, const Range &B) { return A.Start < B.Start; });
+    for (unsigned i = 1; i < Ranges.size(); ++i)
+      if (Ranges[i].Start < Ranges[i - 1].End)
+        Ctx.reportError(
+            SMLoc(), "sections " +
+                         cast<MCSectionELF>(Ranges[i - 1].Sec)
+                             ->getSectionName() +
+                         " and " +
+                         cast<MCSectionELF>(Ranges[i].Sec)->getSectionName() +
+                         " overlap in region " + Region.Name);
+  }
+}
+
+bool M6502ImageObjectWriter::getSymbolAddress(MCContext &Ctx,
+                                              const MCAsmLayout &Layout,
+                                              const MCFixup &Fixup,
+                                              const MCSymbol &Sym,
+                                              uint64_t &Address) const {
+  if (Sym.isUndefined()) {
+    Ctx.reportError(Fixup.getLoc(),
+                    "undefined symbol '" + Sym.getName() + "' in image");
+    return false;
+  }
+  if (!Layout.getSymbolOffset(Sym, Address)) {
+    Ctx.reportError(Fixup.getLoc(), "cannot evaluate symbol '" +
+                                        Sym.getName() + "'");
+    return false;
+  }
+  if (Sym.isInSection())
+    Address += Addresses.lookup(&Sym.getSection());
+  return true;
+}
+
+/// Every fixup left to a relocation is resolved here, now that the sections
+/// have an address.  The backend applies the value as for any other fixup.
+void M6502ImageObjectWriter::recordRelocation(MCAssembler &Asm,
+                                              const MCAsmLayout &Layout,
+                                              const MCFragment *Fragment,
+                                              const MCFixup &Fixup,
+                                              MCValue Target,
+                                              uint64_t &FixedValue) {
+  MCContext &Ctx = Asm.getContext();
+  uint64_t Value = Target.getConstant();
+  uint64_t Address;
+
+  if (const MCSymbolRefExpr *A = Target.getSymA()) {
+    if (!getSymbolAddress(Ctx, Layout, Fixup, A->getSymbol(), Address))
+      return;
+    Value += Address;
+  }
+  if (const MCSymbolRefExpr *B = Target.getSymB()) {
+    if (!getSymbolAddress(Ctx, Layout, Fixup, B->getSymbol(), Address))
+      return;
+    Value -= Address;
+  }
+
+  bool IsPCRel = Asm.getBackend().getFixupKindInfo(Fixup.getKind()).Flags &
+                 MCFixupKindInfo::FKF_IsPCRel;
+  if (IsPCRel)
+    Value -= Addresses.lookup(Fragment->getParent()) +
+             Layout.getFragmentOffset(Fragment) + Fixup.getOffset();
+
+  FixedValue = Value;
+}
+
+/// Fill Bytes with the contents of the region Idx, up to the end of its last
+/// initialized section.
+void M6502ImageObjectWriter::writeRegion(MCAssembler &Asm,
+                                         const MCAsmLayout &Layout,
+                                         unsigned Idx,
+                                         std::vector<uint8_t> &Bytes) {
+  const M6502MemoryRegion &Region = Map.regions()[Idx];
+  raw_pwrite_stream &OS = getStream();
+
+  for (const MCSection *Sec : RegionSections[Idx]) {
+    if (Sec->isVirtualSection())
+      continue;
+
+    SmallString<256> Data;
+    raw_svector_ostream SecOS(Data);
+    setStream(SecOS);
+    Asm.writeSectionData(Sec, Layout);
+    setStream(OS);
+
+    uint64_t Offset = Addresses.lookup(Sec) - Region.Start;
+    if (Bytes.size() < Offset + Data.size())
+      Bytes.resize(Offset + Data.size(), Region.Fill);
+    std::copy(Data.begin(), Data.end(), Bytes.begin() + Offset);
+  }
+}
+
+/// Write the address of every named symbol of the image, sorted by address.
+void M6502ImageObjectWriter::writeSymbolFile(MCAssembler &Asm,
+                                             const MCAsmLayout &Layout) {
+  std::vector<std::pair<uint64_t, StringRef>> Symbols;
+  for (const MCSymbol &Sym : Asm.symbols()) {
+    if (Sym.isTemporary() || !Sym.isInSection() || Sym.getName().empty() ||
+        cast<MCSymbolELF>(Sym).getType() == ELF::STT_SECTION)
+      continue;
+    auto Address = Addresses.find(&Sym.getSection());
+    uint64_t Offset;
+    if (Address == Addresses.end() || !Layout.getSymbolOffset(Sym, Offset))
+      continue;
+    Symbols.push_back({Address->second + Offset, Sym.getName()});
+  }
+  std::sort(Symbols.begin(), Symbols.end());
+
+  std::error_code EC;
+  raw_fd_ostream OS(SymbolFile, EC, sys::fs::F_Text);
+  if (EC) {
+    Asm.getContext().reportError(SMLoc(), "cannot write symbol file '" +
+                                              SymbolFile + "': " +
+                                              EC.message());
+    return;
+  }
+  for (const auto &Sym : Symbols)
+    OS << "$" << format_hex_no_prefix(Sym.first, 4, /*Upper=*/true) << " "
+       << Sym.second << "\n";
+}
+
+void M6502ImageObjectWriter::writeObject(MCAssembler &Asm,
+                                         const MCAsmLayout &Layout) {
+  MCContext &Ctx = Asm.getContext();
+  if (Ctx.hadError())
+    return;
+
+  if (!SymbolFile.empty())
+    writeSymbolFile(Asm, Layout);
+
+  ArrayRef<M6502MemoryRegion> Regions = Map.regions();
+  SmallVector<unsigned, 4> Loaded;
+  for (unsigned Idx = 0; Idx < Regions.size(); ++Idx)
+    if (Regions[Idx].Load)
+      Loaded.push_back(Idx);
+
+  std::vector<std::vector<uint8_t>> Images(Loaded.size());
+  for (unsigned i = 0; i < Loaded.size(); ++i)
+    writeRegion(Asm, Layout, Loaded[i], Images[i]);
+
+  // Nothing initializes the regions which are not loaded, so only zeros can
+  // be assumed there, as for .bss.
+  for (unsigned Idx = 0; Idx < Regions.size(); ++Idx) {
+    if (Regions[Idx].Load)
+      continue;
+    std::vector<uint8_t> Bytes;
+    writeRegion(Asm, Layout, Idx, Bytes);
+    if (any_of(Bytes, [](uint8_t B) { return B != 0; }))
+      Ctx.reportError(SMLoc(), "initialized data in region " +
+                                   Regions[Idx].Name + ", which is not loaded");
+  }
+
+  switch (Format) {
+  case M6502::IF_ELF:
+    llvm_unreachable("An ELF object is not an image");
+
+  case M6502::IF_Raw:
+    for (const std::vector<uint8_t> &Bytes : Images)
+      writeBytes(StringRef((const char *)Bytes.data(), Bytes.size()));
+    break;
+
+  case M6502::IF_PRG: {
+    if (Loaded.size() != 1) {
+      Ctx.reportError(SMLoc(), "a PRG image must have one loaded region");
+      return;
+    }
+    writeLE16(Regions[Loaded[0]].Start);
+    writeBytes(StringRef((const char *)Images[0].data(), Images[0].size()));
+    break;
+  }
+
+  case M6502::IF_INES: {
+    if (Loaded.empty() || Loaded.size() > 2) {
+      Ctx.reportError(SMLoc(), "an iNES image must have a PRG ROM region and "
+                               "an optional CHR ROM region");
+      return;
+    }
+
+    // The ROMs fill their regions.  An empty CHR ROM region means that the
+    // cartridge has CHR RAM instead.
+    const M6502MemoryRegion &PRG = Regions[Loaded[0]];
+    uint64_t PRGSize = PRG.getSize();
+    uint64_t CHRSize = 0;
+    if (Loaded.size() > 1 && !Images[1].empty())
+      CHRSize = Regions[Loaded[1]].getSize();
+    if (PRGSize % INESPRGBankSize || CHRSize % INESCHRBankSize) {
+      Ctx.reportError(SMLoc(), "iNES ROM regions must be a multiple of 16K "
+                               "(PRG) and 8K (CHR) bytes");
+      return;
+    }
+    if (INESMapper > 0xff) {
+      Ctx.reportError(SMLoc(), "iNES mapper number out of range");
+      return;
+    }
+
+    writeBytes("NES\x1a");
+    write8(PRGSize / INESPRGBankSize);
+    write8(CHRSize / INESCHRBankSize);
+    write8(((INESMapper & 0x0f) << 4) | (INESVertical ? 1 : 0));
+    write8(INESMapper & 0xf0);
+    WriteZeros(8);
+
+    Images[0].resize(PRGSize, PRG.Fill);
+    writeBytes(StringRef((const char *)Images[0].data(), PRGSize));
+    if (CHRSize) {
+      Images[1].resize(CHRSize, Regions[Loaded[1]].Fill);
+      writeBytes(StringRef((const char *)Images[1].data(), CHRSize));
+    }
+    break;
+  }
+  }
+}
+
+std::unique_ptr<MCObjectWriter>
+llvm::createM6502ImageObjectWriter(raw_pwrite_stream &OS,
+                                   M6502::ImageFormat Format) {
+  return llvm::make_unique<M6502ImageObjectWriter>(OS, Format);
+}
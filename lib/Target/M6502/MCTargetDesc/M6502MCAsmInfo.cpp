@@ -1,4 +1,4 @@
-//===-- M6502MCAsmInfo.cpp - M6502 Asm Properties ---------------------------===//
+//===-- M6502MCAsmInfo.cpp - M6502 Asm Properties -------------------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -19,26 +19,25 @@ using namespace llvm;
 void M6502MCAsmInfo::anchor() { }
 
 M6502MCAsmInfo::M6502MCAsmInfo(const Triple &TheTriple) {
-  IsLittleEndian = TheTriple.isLittleEndian();
+  IsLittleEndian = true;
 
-  PrivateGlobalPrefix = "$";
-  PrivateLabelPrefix = "$";
+  // Pointers and return addresses are two bytes wide.
+  CodePointerSize = CalleeSaveStackSlotSize = 2;
+
+  // An opcode byte followed by at most two operand bytes.
+  MaxInstLength = 3;
+
+  // '$' starts a hexadecimal number in most 6502 assemblers.
+  PrivateGlobalPrefix = ".L";
+  PrivateLabelPrefix = ".L";
 
   AlignmentIsInBytes          = false;
   Data16bitsDirective         = "\t.2byte\t";
   Data32bitsDirective         = "\t.4byte\t";
   Data64bitsDirective         = "\t.8byte\t";
-  CommentString               = "#";
+  CommentString               = ";";
   ZeroDirective               = "\t.space\t";
-  GPRel32Directive            = "\t.gpword\t";
-  GPRel64Directive            = "\t.gpdword\t";
-  DTPRel32Directive           = "\t.dtprelword\t";
-  DTPRel64Directive           = "\t.dtpreldword\t";
-  TPRel32Directive            = "\t.tprelword\t";
-  TPRel64Directive            = "\t.tpreldword\t";
   UseAssignmentForEHBegin = true;
   SupportsDebugInformation = true;
-  ExceptionsType = ExceptionHandling::DwarfCFI;
-  DwarfRegNumForCFI = true;
-  HasMipsExpressions = true;
+  ExceptionsType = ExceptionHandling::None;
 }
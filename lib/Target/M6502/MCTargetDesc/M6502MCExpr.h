@@ -1,4 +1,4 @@
-//===- M6502MCExpr.h - M6502 specific MC expression classes -------*- C++ -*-===//
+//===- M6502MCExpr.h - M6502 specific MC expression classes -----*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -20,31 +20,8 @@ class M6502MCExpr : public MCTargetExpr {
 public:
   enum M6502ExprKind {
     MEK_None,
-    MEK_CALL_HI16,
-    MEK_CALL_LO16,
-    MEK_DTPREL_HI,
-    MEK_DTPREL_LO,
-    MEK_GOT,
-    MEK_GOTTPREL,
-    MEK_GOT_CALL,
-    MEK_GOT_DISP,
-    MEK_GOT_HI16,
-    MEK_GOT_LO16,
-    MEK_GOT_OFST,
-    MEK_GOT_PAGE,
-    MEK_GPREL,
-    MEK_HI,
-    MEK_HIGHER,
-    MEK_HIGHEST,
-    MEK_LO,
-    MEK_NEG,
-    MEK_PCREL_HI16,
-    MEK_PCREL_LO16,
-    MEK_TLSGD,
-    MEK_TLSLDM,
-    MEK_TPREL_HI,
-    MEK_TPREL_LO,
-    MEK_Special,
+    MEK_HI, // >expr, bits 15-8 of the value.
+    MEK_LO  // <expr, bits 7-0 of the value.
   };
 
 private:
@@ -57,8 +34,6 @@ private:
 public:
   static const M6502MCExpr *create(M6502ExprKind Kind, const MCExpr *Expr,
                                   MCContext &Ctx);
-  static const M6502MCExpr *createGpOff(M6502ExprKind Kind, const MCExpr *Expr,
-                                       MCContext &Ctx);
 
   /// Get the kind of this expression.
   M6502ExprKind getKind() const { return Kind; }
@@ -75,17 +50,12 @@ public:
     return getSubExpr()->findAssociatedFragment();
   }
 
-  void fixELFSymbolsInTLSFixups(MCAssembler &Asm) const override;
+  // There is no TLS on the 6502.
+  void fixELFSymbolsInTLSFixups(MCAssembler &Asm) const override {}
 
   static bool classof(const MCExpr *E) {
     return E->getKind() == MCExpr::Target;
   }
-
-  bool isGpOff(M6502ExprKind &Kind) const;
-  bool isGpOff() const {
-    M6502ExprKind Kind;
-    return isGpOff(Kind);
-  }
 };
 
 } // end namespace llvm
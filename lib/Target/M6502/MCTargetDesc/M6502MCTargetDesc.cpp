@@ -1,4 +1,4 @@
-//===-- M6502MCTargetDesc.cpp - M6502 Target Descriptions -------------------===//
+//===-- M6502MCTargetDesc.cpp - M6502 Target Descriptions -----------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -16,7 +16,6 @@
 #include "M6502AsmBackend.h"
 #include "M6502ELFStreamer.h"
 #include "M6502MCAsmInfo.h"
-#include "M6502MCNaCl.h"
 #include "M6502TargetStreamer.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/MC/MCCodeEmitter.h"
@@ -27,6 +26,7 @@
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/MachineLocation.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -36,12 +36,44 @@ using namespace llvm;
 #define GET_INSTRINFO_MC_DESC
 #include "M6502GenInstrInfo.inc"
 
+#define GET_INSTRMAP_INFO
+#include "M6502GenInstrInfo.inc"
+#undef GET_INSTRMAP_INFO
+
 #define GET_SUBTARGETINFO_MC_DESC
 #include "M6502GenSubtargetInfo.inc"
 
 #define GET_REGINFO_MC_DESC
 #include "M6502GenRegisterInfo.inc"
 
+// Address of the zero page register bank.  The default leaves the low half of
+// the zero page, where most systems keep their own variables, alone.
+static cl::opt<unsigned>
+ZPRegBase("m6502-zp-reg-base", cl::Hidden, cl::init(0x80),
+          cl::desc("M6502: Zero page address of the register bank"));
+
+// The number of zero page byte registers available to the register
+// allocator.  Registers past this limit are reserved, which leaves the rest of
+// the zero page to the program.  RS0-RS15 hold the stack and scratch pointers
+// and the arguments, and RS16-RS17 the frame pointer, so they always exist.
+static cl::opt<unsigned>
+NumZPRegs("m6502-zp-regs", cl::Hidden, cl::init(32),
+          cl::desc("M6502: Number of zero page bytes used as registers "
+                   "(18-32, default=32)"));
+
+unsigned llvm::getM6502NumZPRegs() {
+  if (NumZPRegs < 18 || NumZPRegs > 32)
+    report_fatal_error("-m6502-zp-regs must be between 18 and 32", false);
+  return NumZPRegs;
+}
+
+unsigned llvm::getM6502ZPRegBase() {
+  if (ZPRegBase > 0x100 - getM6502NumZPRegs())
+    report_fatal_error("-m6502-zp-reg-base leaves no room for the registers",
+                       false);
+  return ZPRegBase;
+}
+
 static MCInstrInfo *createM6502MCInstrInfo() {
   MCInstrInfo *X = new MCInstrInfo();
   InitM6502MCInstrInfo(X);
@@ -50,7 +82,7 @@ static MCInstrInfo *createM6502MCInstrInfo() {
 
 static MCRegisterInfo *createM6502MCRegisterInfo(const Triple &TT) {
   MCRegisterInfo *X = new MCRegisterInfo();
-  InitM6502MCRegisterInfo(X, M6502::RA);
+  InitM6502MCRegisterInfo(X, M6502::S);
   return X;
 }
 
@@ -63,7 +95,8 @@ static MCAsmInfo *createM6502MCAsmInfo(const MCRegisterInfo &MRI,
                                       const Triple &TT) {
   MCAsmInfo *MAI = new M6502MCAsmInfo(TT);
 
-  unsigned SP = MRI.getDwarfRegNum(M6502::SP, true);
+  // Frames live on the software stack.
+  unsigned SP = MRI.getDwarfRegNum(M6502::RC0, true);
   MCCFIInstruction Inst = MCCFIInstruction::createDefCfa(nullptr, SP, 0);
   MAI->addInitialFrameState(Inst);
 
@@ -83,13 +116,8 @@ static MCStreamer *createMCStreamer(const Triple &T, MCContext &Context,
                                     raw_pwrite_stream &OS,
                                     std::unique_ptr<MCCodeEmitter> &&Emitter,
                                     bool RelaxAll) {
-  MCStreamer *S;
-  if (!T.isOSNaCl())
-    S = createM6502ELFStreamer(Context, std::move(MAB), OS, std::move(Emitter),
-                              RelaxAll);
-  else
-    llvm_unreachable("");
-  return S;
+  return createM6502ELFStreamer(Context, std::move(MAB), OS,
+                                std::move(Emitter), RelaxAll);
 }
 
 static MCTargetStreamer *createM6502AsmTargetStreamer(MCStreamer &S,
@@ -121,13 +149,12 @@ public:
       return false;
     switch (Info->get(Inst.getOpcode()).OpInfo[NumOps - 1].OperandType) {
     case MCOI::OPERAND_UNKNOWN:
-    case MCOI::OPERAND_IMMEDIATE:
-      // jal, bal ...
+      // jmp, jsr
       Target = Inst.getOperand(NumOps - 1).getImm();
       return true;
     case MCOI::OPERAND_PCREL:
-      // b, j, beq ...
-      Target = Addr + Inst.getOperand(NumOps - 1).getImm();
+      // beq, bne ...
+      Target = Addr + Size + Inst.getOperand(NumOps - 1).getImm();
       return true;
     default:
       return false;
@@ -178,5 +205,5 @@ extern "C" void LLVMInitializeM6502TargetMC() {
 
   // Register the MC Code Emitter
   for (Target *T : {&getTheM6502Target()})
-    TargetRegistry::RegisterMCCodeEmitter(*T, createM6502MCCodeEmitterEB);
+    TargetRegistry::RegisterMCCodeEmitter(*T, createM6502MCCodeEmitter);
 }
@@ -1,4 +1,4 @@
-//===-- M6502MCTargetDesc.h - M6502 Target Descriptions -----------*- C++ -*-===//
+//===-- M6502MCTargetDesc.h - M6502 Target Descriptions ---------*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -34,23 +34,49 @@ class raw_ostream;
 class raw_pwrite_stream;
 
 Target &getTheM6502Target();
-Target &getTheM6502elTarget();
-Target &getTheM650264Target();
-Target &getTheM650264elTarget();
 
-MCCodeEmitter *createM6502MCCodeEmitterEB(const MCInstrInfo &MCII,
-                                         const MCRegisterInfo &MRI,
-                                         MCContext &Ctx);
-MCCodeEmitter *createM6502MCCodeEmitterEL(const MCInstrInfo &MCII,
-                                         const MCRegisterInfo &MRI,
-                                         MCContext &Ctx);
+MCCodeEmitter *createM6502MCCodeEmitter(const MCInstrInfo &MCII,
+                                        const MCRegisterInfo &MRI,
+                                        MCContext &Ctx);
 
 MCAsmBackend *createM6502AsmBackend(const Target &T, const MCRegisterInfo &MRI,
                                    const Triple &TT, StringRef CPU,
                                    const MCTargetOptions &Options);
 
 std::unique_ptr<MCObjectWriter>
-createM6502ELFObjectWriter(raw_pwrite_stream &OS, const Triple &TT, bool IsN32);
+createM6502ELFObjectWriter(raw_pwrite_stream &OS, const Triple &TT);
+
+namespace M6502 {
+/// The kind of file written for an object, set with -m6502-image.
+enum ImageFormat {
+  IF_ELF,  // Relocatable ELF object.
+  IF_Raw,  // Bytes of the loaded regions.
+  IF_PRG,  // C64 program with its load address.
+  IF_INES  // NES cartridge with an iNES header.
+};
+} // End M6502 namespace
+
+std::unique_ptr<MCObjectWriter>
+createM6502ImageObjectWriter(raw_pwrite_stream &OS, M6502::ImageFormat Format);
+
+/// Zero page address of the register bank, set with -m6502-zp-reg-base.  A
+/// zero page register lives at this address plus its encoding.
+unsigned getM6502ZPRegBase();
+
+/// Number of zero page bytes in the register bank, set with -m6502-zp-regs.
+unsigned getM6502NumZPRegs();
+
+namespace M6502 {
+/// Return the zero page form of the absolute instruction Opcode, or -1 if it
+/// has none.
+int getZeroPageOpcode(uint16_t Opcode);
+/// Return the zero page form of the indexed absolute instruction Opcode, or
+/// -1 if it is not indexed or has none.
+int getIndexedZeroPageOpcode(uint16_t Opcode);
+/// Return the absolute form of the zero page instruction Opcode, or -1 if it
+/// has none.
+int getAbsoluteOpcode(uint16_t Opcode);
+} // End M6502 namespace
 
 } // End llvm namespace
 
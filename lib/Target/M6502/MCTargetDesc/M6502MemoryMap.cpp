@@ -0,0 +1,123 @@
+//===- M6502MemoryMap.cpp - Placement of sections in memory ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502MemoryMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Twine.h"
+
+using namespace llvm;
+
+static Error makeError(unsigned Line, const Twine &Msg) {
+  return make_error<StringError>("memory map line " + Twine(Line) + ": " + Msg,
+                                 inconvertibleErrorCode());
+}
+
+/// Parse a C style or $hex number.
+static bool parseNumber(StringRef Str, uint64_t &Value) {
+  if (Str.consume_front("$"))
+    return !Str.getAsInteger(16, Value);
+  return !Str.getAsInteger(0, Value);
+}
+
+Expected<M6502MemoryMap> M6502MemoryMap::parse(StringRef Text) {
+  M6502MemoryMap Map;
+  SmallVector<StringRef, 16> Lines;
+  Text.split(Lines, '\n');
+
+  for (unsigned LineNo = 1; LineNo <= Lines.size(); ++LineNo) {
+    StringRef Line = Lines[LineNo - 1];
+    Line = Line.take_until([](char C) { return C == '#' || C == ';'; });
+
+    SmallVector<StringRef, 8> Words;
+    SplitString(Line, Words);
+    if (Words.empty())
+      continue;
+
+    if (Words[0] == "MEMORY") {
+      if (Words.size() < 4)
+        return makeError(LineNo, "expected MEMORY <region> <start> <end>");
+
+      M6502MemoryRegion Region;
+      Region.Name = Words[1];
+      if (!parseNumber(Words[2], Region.Start) ||
+          !parseNumber(Words[3], Region.End) || Region.End < Region.Start ||
+          Region.End > 0xffff)
+        return makeError(LineNo, "invalid range of region " + Region.Name);
+
+      for (unsigned i = 4; i < Words.size(); ++i) {
+        uint64_t Fill;
+        if (Words[i] == "NOLOAD")
+          Region.Load = false;
+        else if (Words[i] == "ROM")
+          Region.ReadOnly = true;
+        else if (Words[i] == "FILL" && i + 1 < Words.size() &&
+                 parseNumber(Words[i + 1], Fill) && Fill <= 0xff)
+          Region.Fill = Fill, ++i;
+        else
+          return makeError(LineNo, "unexpected '" + Words[i] + "'");
+      }
+
+      if (any_of(Map.Regions, [&](const M6502MemoryRegion &R) {
+            return R.Name == Region.Name;
+          }))
+        return makeError(LineNo, "region " + Region.Name + " redefined");
+      Map.Regions.push_back(std::move(Region));
+      continue;
+    }
+
+    if (Words[0] == "PLACE") {
+      auto In = find(Words, "IN");
+      if (In == Words.begin() + 1 || In == Words.end() ||
+          In + 1 == Words.end())
+        return makeError(LineNo, "expected PLACE <pattern>... IN <region>");
+
+      M6502Placement Placement;
+      for (auto I = Words.begin() + 1; I != In; ++I) {
+        Expected<GlobPattern> Pattern = GlobPattern::create(*I);
+        if (!Pattern)
+          return Pattern.takeError();
+        Placement.Patterns.push_back(std::move(*Pattern));
+      }
+
+      auto Region = find_if(Map.Regions, [&](const M6502MemoryRegion &R) {
+        return R.Name == In[1];
+      });
+      if (Region == Map.Regions.end())
+        return makeError(LineNo, "unknown region " + In[1]);
+      Placement.Region = Region - Map.Regions.begin();
+
+      auto Rest = In + 2;
+      if (Rest != Words.end()) {
+        uint64_t At;
+        if (*Rest != "AT" || Rest + 2 != Words.end() ||
+            !parseNumber(Rest[1], At))
+          return makeError(LineNo, "expected AT <address>");
+        if (At < Region->Start || At > Region->End)
+          return makeError(LineNo, "address outside of region " + In[1]);
+        Placement.At = At;
+      }
+
+      Map.Placements.push_back(std::move(Placement));
+      continue;
+    }
+
+    return makeError(LineNo, "unknown command '" + Words[0] + "'");
+  }
+
+  return std::move(Map);
+}
+
+const M6502Placement *M6502MemoryMap::findPlacement(StringRef Name) const {
+  for (const M6502Placement &P : Placements)
+    if (any_of(P.Patterns,
+               [&](const GlobPattern &G) { return G.match(Name); }))
+      return &P;
+  return nullptr;
+}
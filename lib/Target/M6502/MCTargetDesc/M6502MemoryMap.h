@@ -0,0 +1,78 @@
+//===- M6502MemoryMap.h - Placement of sections in memory -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A memory map tells the image writer where the sections go.  It is read from
+// a small linker script like text, one command per line:
+//
+//   MEMORY <region> <start> <end> [NOLOAD] [ROM] [FILL <byte>]
+//   PLACE <pattern>... IN <region> [AT <address>]
+//
+// A region is a range of addresses, which is part of the image unless it is
+// NOLOAD.  Writable sections with initial contents cannot go to a ROM region,
+// since the program could not change them there.  A section goes to the region of the first PLACE with a glob
+// pattern matching its name.  The sections of a region follow one another
+// from its start, in the order of the PLACE commands and then of the object,
+// except the ones placed AT a fixed address.  Numbers are C style or $hex,
+// and comments start with '#' or ';'.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M6502_MCTARGETDESC_M6502MEMORYMAP_H
+#define LLVM_LIB_TARGET_M6502_MCTARGETDESC_M6502MEMORYMAP_H
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/GlobPattern.h"
+#include <cstdint>
+#include <string>
+
+namespace llvm {
+
+struct M6502MemoryRegion {
+  std::string Name;
+  uint64_t Start;
+  uint64_t End; // Last address of the region.
+  bool Load = true;
+  bool ReadOnly = false;
+  uint8_t Fill = 0;
+
+  uint64_t getSize() const { return End - Start + 1; }
+};
+
+struct M6502Placement {
+  SmallVector<GlobPattern, 2> Patterns;
+  unsigned Region;
+  Optional<uint64_t> At;
+};
+
+class M6502MemoryMap {
+  SmallVector<M6502MemoryRegion, 4> Regions;
+  SmallVector<M6502Placement, 8> Placements;
+
+public:
+  /// Parse the text of a memory map.
+  static Expected<M6502MemoryMap> parse(StringRef Text);
+
+  ArrayRef<M6502MemoryRegion> regions() const { return Regions; }
+
+  /// Return the first placement of the section called Name, or null if the
+  /// map does not place it.
+  const M6502Placement *findPlacement(StringRef Name) const;
+
+  /// Return the index of the placement P.
+  unsigned getPlacementIndex(const M6502Placement &P) const {
+    return &P - Placements.begin();
+  }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M6502_MCTARGETDESC_M6502MEMORYMAP_H
@@ -1,57 +1,141 @@
 	.text
-	.abicalls
-	.option	pic0
-	.section	.mdebug.abi32,"",@progbits
-	.nan	legacy
+rs4 = 132
+rs5 = 133
+rs6 = 134
+rs7 = 135
+rs8 = 136
+rs9 = 137
+rs10 = 138
+rs11 = 139
+rs12 = 140
+rs13 = 141
+rs14 = 142
+rs15 = 143
+rs16 = 144
+rs17 = 145
+rs18 = 146
+rs19 = 147
+rs20 = 148
+rs21 = 149
+rs22 = 150
+rs23 = 151
+rs24 = 152
+rs25 = 153
+rs26 = 154
+rs27 = 155
+rs28 = 156
+rs29 = 157
+rs30 = 158
+rs31 = 159
+rs0 = 128
+rs1 = 129
+rs2 = 130
+rs3 = 131
+rc2 = 132
+rc3 = 134
+rc4 = 136
+rc5 = 138
+rc6 = 140
+rc7 = 142
+rc8 = 144
+rc9 = 146
+rc10 = 148
+rc11 = 150
+rc12 = 152
+rc13 = 154
+rc14 = 156
+rc15 = 158
+rc0 = 128
+rc1 = 130
 	.file	"main.c"
-	.text
-	.globl	main                    # -- Begin function main
-	.p2align	2
+	.globl	main                    ; -- Begin function main
 	.type	main,@function
-	.set	nomicrom6502
-	.set	nom650216
-	.ent	main
-main:                                   # @main
-	.frame	$fp,16,$ra
-	.mask 	0x40000000,-4
-	.fmask	0x00000000,0
-	.set	noreorder
-	.set	nomacro
-	.set	noat
-# BB#0:                                 # %entry
-	addiu	$sp, $sp, -16
-	sw	$fp, 12($sp)            # 4-byte Folded Spill
-	move	 $fp, $sp
-	addiu	$1, $zero, 0
-	sb	$zero, 9($fp)
-	sb	$zero, 8($fp)
-	sb	$zero, 4($fp)
-	addiu	$1, $zero, 5
-	sb	$1, 5($fp)
-	lbu	$1, 4($fp)
-	sll	$1, $1, 8
-	lbu	$2, 5($fp)
-	or	$1, $1, $2
-	addiu	$1, $1, 1
-	srl	$2, $1, 8
-	sb	$2, 4($fp)
-	sb	$1, 5($fp)
-	lbu	$1, 4($fp)
-	sll	$1, $1, 8
-	lbu	$2, 5($fp)
-	or	$2, $1, $2
-	move	 $sp, $fp
-	lw	$fp, 12($sp)            # 4-byte Folded Reload
-	jr	$ra
-	addiu	$sp, $sp, 16
-	.set	at
-	.set	macro
-	.set	reorder
-	.end	main
-$func_end0:
-	.size	main, ($func_end0)-main
-                                        # -- End function
+main:                                   ; @main
+; BB#0:                                 ; %entry
+	clc
+	lda	rs0
+	adc	#248
+	sta	rs0
+	lda	rs1
+	adc	#255
+	sta	rs1
+	ldy	#7
+	lda	rs16
+	sta	(rc0),y
+	ldy	#6
+	lda	rs17
+	sta	(rc0),y
+	lda	rs0
+	sta	rs16
+	lda	rs1
+	sta	rs17
+	lda	#0
+	sta	rs4
+	sta	rs5
+	ldy	#4
+	lda	rs4
+	sta	(rc8),y
+	iny
+	lda	rs5
+	sta	(rc8),y
+	lda	#5
+	sta	rs4
+	lda	#0
+	sta	rs5
+	ldy	#2
+	lda	rs4
+	sta	(rc8),y
+	iny
+	lda	rs5
+	sta	(rc8),y
+	ldy	#2
+	lda	(rc8),y
+	tax
+	iny
+	lda	(rc8),y
+	sta	rs5
+	stx	rs4
+	clc
+	lda	rs4
+	adc	#1
+	sta	rs4
+	lda	rs5
+	adc	#0
+	sta	rs5
+	ldy	#2
+	lda	rs4
+	sta	(rc8),y
+	iny
+	lda	rs5
+	sta	(rc8),y
+	ldy	#2
+	lda	(rc8),y
+	tax
+	iny
+	lda	(rc8),y
+	sta	rs9
+	stx	rs8
+	lda	rs16
+	sta	rs0
+	lda	rs17
+	sta	rs1
+	ldy	#6
+	lda	(rc0),y
+	sta	rs17
+	ldy	#7
+	lda	(rc0),y
+	sta	rs16
+	clc
+	lda	rs0
+	adc	#8
+	sta	rs0
+	lda	rs1
+	adc	#0
+	sta	rs1
+	rts
+.Lfunc_end0:
+	.size	main, .Lfunc_end0-main
+                                        ; -- End function
 
 	.ident	"clang version 6.0.0 (https://github.com/llvm-mirror/clang.git 5a52b9e6b0480ced82bf0bccbddd0f1d7804752d) (https://github.com/igor-laevsky/llvm-simple-backend.git 5a6d255e6e32ebedb1d132c060a68873f3157a76)"
 	.section	".note.GNU-stack","",@progbits
-	.text
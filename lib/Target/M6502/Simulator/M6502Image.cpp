@@ -0,0 +1,141 @@
+//===- M6502Image.cpp - Loading of 6502 images ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502Image.h"
+#include "M6502Simulator.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Twine.h"
+
+using namespace llvm;
+
+static Error makeError(const Twine &Msg) {
+  return make_error<StringError>(Msg, inconvertibleErrorCode());
+}
+
+static ArrayRef<uint8_t> toBytes(StringRef Data) {
+  return ArrayRef<uint8_t>((const uint8_t *)Data.data(), Data.size());
+}
+
+Expected<M6502ImageEntry> llvm::loadM6502RawImage(M6502Memory &Mem,
+                                                  StringRef Data,
+                                                  uint16_t Address) {
+  if (Data.empty())
+    return makeError("empty image");
+  if (!Mem.load(Address, toBytes(Data)))
+    return makeError("image does not fit in memory");
+
+  M6502ImageEntry Entry;
+  Entry.Entry = Address;
+  Entry.Start = Address;
+  Entry.End = Address + Data.size() - 1;
+  return Entry;
+}
+
+Expected<M6502ImageEntry> llvm::loadM6502PRGImage(M6502Memory &Mem,
+                                                  StringRef Data) {
+  if (Data.size() < 3)
+    return makeError("truncated PRG header");
+  uint16_t Address = uint8_t(Data[0]) | uint8_t(Data[1]) << 8;
+  return loadM6502RawImage(Mem, Data.drop_front(2), Address);
+}
+
+Expected<M6502ImageEntry> llvm::loadM6502INESImage(M6502Memory &Mem,
+                                                   StringRef Data) {
+  const uint64_t HeaderSize = 16;
+  if (Data.size() < HeaderSize || !Data.startswith("NES\x1a"))
+    return makeError("not an iNES image");
+
+  uint64_t PRGSize = uint8_t(Data[4]) * 16384;
+  unsigned Mapper = (uint8_t(Data[6]) >> 4) | (uint8_t(Data[7]) & 0xf0);
+  bool HasTrainer = Data[6] & 0x04;
+  if (Mapper != 0)
+    return makeError("unsupported iNES mapper " + Twine(Mapper));
+  if (PRGSize != 16384 && PRGSize != 32768)
+    return makeError("NROM needs 16K or 32K of PRG ROM");
+
+  uint64_t Offset = HeaderSize + (HasTrainer ? 512 : 0);
+  if (Data.size() < Offset + PRGSize)
+    return makeError("truncated PRG ROM");
+  StringRef PRG = Data.substr(Offset, PRGSize);
+
+  Mem.load(0x8000, toBytes(PRG));
+  if (PRGSize == 16384)
+    Mem.load(0xc000, toBytes(PRG));
+  Mem.setReadOnly(0x8000, 0xffff);
+
+  Mem.mapIO(0x0800, 0x1fff,
+            [&Mem](uint16_t Addr) { return Mem.peek(Addr & 0x07ff); },
+            [&Mem](uint16_t Addr, uint8_t Value) {
+              Mem.poke(Addr & 0x07ff, Value);
+            });
+  Mem.mapIO(0x2000, 0x401f,
+            [](uint16_t Addr) -> uint8_t {
+              return Addr < 0x4000 && (Addr & 7) == 2 ? 0x80 : 0;
+            },
+            [](uint16_t, uint8_t) {});
+
+  M6502ImageEntry Entry;
+  Entry.Start = 0x8000;
+  Entry.End = 0xffff;
+  return Entry;
+}
+
+Expected<M6502SymbolTable> M6502SymbolTable::parse(StringRef Text) {
+  M6502SymbolTable Table;
+  SmallVector<StringRef, 64> Lines;
+  Text.split(Lines, '\n');
+
+  for (unsigned LineNo = 1; LineNo <= Lines.size(); ++LineNo) {
+    SmallVector<StringRef, 2> Words;
+    SplitString(Lines[LineNo - 1], Words);
+    if (Words.empty())
+      continue;
+
+    Optional<uint16_t> Address;
+    if (Words.size() == 2)
+      Address = parseM6502Address(Words[0], nullptr);
+    if (!Address)
+      return makeError("symbol file line " + Twine(LineNo) +
+                       ": expected <address> <name>");
+
+    Table.Addresses[Words[1]] = *Address;
+    Table.Names.insert({*Address, Words[1]});
+  }
+  return std::move(Table);
+}
+
+Optional<uint16_t> M6502SymbolTable::lookup(StringRef Name) const {
+  auto I = Addresses.find(Name);
+  if (I == Addresses.end())
+    return None;
+  return I->second;
+}
+
+StringRef M6502SymbolTable::getName(uint16_t Address) const {
+  auto I = Names.find(Address);
+  if (I == Names.end())
+    return StringRef();
+  return I->second;
+}
+
+Optional<uint16_t> llvm::parseM6502Address(StringRef Str,
+                                           const M6502SymbolTable *Symbols) {
+  uint64_t Value;
+  if (Str.startswith("$")) {
+    if (Str.drop_front().getAsInteger(16, Value) || Value > 0xffff)
+      return None;
+    return uint16_t(Value);
+  }
+  if (!Str.getAsInteger(0, Value))
+    return Value > 0xffff ? None : Optional<uint16_t>(Value);
+  if (Symbols)
+    return Symbols->lookup(Str);
+  return None;
+}
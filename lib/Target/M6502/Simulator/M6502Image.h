@@ -0,0 +1,74 @@
+//===- M6502Image.h - Loading of 6502 images --------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Loading of the raw, PRG and iNES images written by llc with -m6502-image,
+// and of the symbol files written with -m6502-image-symbols, into the memory
+// of the simulator.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M6502_SIMULATOR_M6502IMAGE_H
+#define LLVM_LIB_TARGET_M6502_SIMULATOR_M6502IMAGE_H
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace llvm {
+
+class M6502Memory;
+
+/// Where a loaded image starts.
+struct M6502ImageEntry {
+  /// The address called to start the image, or None to start it from the
+  /// reset vector.
+  Optional<uint16_t> Entry;
+  /// The first and last addresses loaded.
+  uint16_t Start = 0, End = 0;
+};
+
+/// Load a raw image at Address.
+Expected<M6502ImageEntry> loadM6502RawImage(M6502Memory &Mem, StringRef Data,
+                                            uint16_t Address);
+
+/// Load a C64 program at the address of its header.
+Expected<M6502ImageEntry> loadM6502PRGImage(M6502Memory &Mem, StringRef Data);
+
+/// Load an NROM iNES cartridge.  The PRG ROM is read only and a 16K ROM is
+/// mirrored at $C000.  The RAM is mirrored up to $1FFF.  The PPU and APU
+/// registers read as zero, except for the PPU status which always reports a
+/// vertical blank, and ignore the writes.
+Expected<M6502ImageEntry> loadM6502INESImage(M6502Memory &Mem, StringRef Data);
+
+/// The symbols of an image: one "$<address> <name>" per line.
+class M6502SymbolTable {
+  StringMap<uint16_t> Addresses;
+  std::map<uint16_t, std::string> Names;
+
+public:
+  static Expected<M6502SymbolTable> parse(StringRef Text);
+
+  Optional<uint16_t> lookup(StringRef Name) const;
+
+  /// Return the name of the symbol at Address, or an empty string.
+  StringRef getName(uint16_t Address) const;
+};
+
+/// Parse an address: a C style or $hex number, or the name of a symbol if
+/// Symbols is not null.
+Optional<uint16_t> parseM6502Address(StringRef Str,
+                                     const M6502SymbolTable *Symbols);
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M6502_SIMULATOR_M6502IMAGE_H
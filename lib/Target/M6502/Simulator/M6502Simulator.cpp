@@ -0,0 +1,814 @@
+//===- M6502Simulator.cpp - 6502 instruction set simulator ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502Simulator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+//===----------------------------------------------------------------------===//
+// M6502Memory
+//===----------------------------------------------------------------------===//
+
+const M6502Memory::IORange *M6502Memory::findIO(uint16_t Addr) const {
+  for (const IORange &R : reverse(IORanges))
+    if (Addr >= R.Start && Addr <= R.End)
+      return &R;
+  return nullptr;
+}
+
+uint8_t M6502Memory::read(uint16_t Addr) {
+  if (IOPages[Addr >> 8])
+    if (const IORange *R = findIO(Addr))
+      if (R->Read)
+        return R->Read(Addr);
+  return Bytes[Addr];
+}
+
+void M6502Memory::write(uint16_t Addr, uint8_t Value) {
+  if (IOPages[Addr >> 8])
+    if (const IORange *R = findIO(Addr))
+      if (R->Write) {
+        R->Write(Addr, Value);
+        return;
+      }
+  if (!ReadOnlyPages[Addr >> 8])
+    Bytes[Addr] = Value;
+}
+
+bool M6502Memory::load(uint16_t Addr, ArrayRef<uint8_t> Data) {
+  if (Addr + Data.size() > Bytes.size())
+    return false;
+  std::copy(Data.begin(), Data.end(), Bytes.begin() + Addr);
+  return true;
+}
+
+void M6502Memory::setReadOnly(uint16_t Start, uint16_t End) {
+  for (unsigned Page = Start >> 8; Page <= unsigned(End >> 8); ++Page)
+    ReadOnlyPages.set(Page);
+}
+
+void M6502Memory::mapIO(uint16_t Start, uint16_t End, ReadHandler Read,
+                        WriteHandler Write) {
+  IORanges.push_back({Start, End, std::move(Read), std::move(Write)});
+  for (unsigned Page = Start >> 8; Page <= unsigned(End >> 8); ++Page)
+    IOPages.set(Page);
+}
+
+//===----------------------------------------------------------------------===//
+// Opcode tables
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+enum Mnemonic : uint8_t {
+  ILL, ADC, AND, ASL, BBR, BBS, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRA, BRK,
+  BVC, BVS, CLC, CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX,
+  INY, JMP, JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PHX, PHY, PLA, PLP,
+  PLX, PLY, RMB, ROL, ROR, RTI, RTS, SBC, SEC, SED, SEI, SMB, STA, STP, STX,
+  STY, STZ, TAX, TAY, TRB, TSB, TSX, TXA, TXS, TYA, WAI
+};
+
+const char *const MnemonicNames[] = {
+  "???", "adc", "and", "asl", "bbr", "bbs", "bcc", "bcs", "beq", "bit", "bmi",
+  "bne", "bpl", "bra", "brk", "bvc", "bvs", "clc", "cld", "cli", "clv", "cmp",
+  "cpx", "cpy", "dec", "dex", "dey", "eor", "inc", "inx", "iny", "jmp", "jsr",
+  "lda", "ldx", "ldy", "lsr", "nop", "ora", "pha", "php", "phx", "phy", "pla",
+  "plp", "plx", "ply", "rmb", "rol", "ror", "rti", "rts", "sbc", "sec", "sed",
+  "sei", "smb", "sta", "stp", "stx", "sty", "stz", "tax", "tay", "trb", "tsb",
+  "tsx", "txa", "txs", "tya", "wai"
+};
+
+enum AddrMode : uint8_t {
+  Imp,     // rts
+  Acc,     // asl a
+  Imm,     // lda #$12
+  ZP,      // lda $12
+  ZPX,     // lda $12,x
+  ZPY,     // ldx $12,y
+  Abs,     // lda $1234
+  AbsX,    // lda $1234,x
+  AbsY,    // lda $1234,y
+  Ind,     // jmp ($1234)
+  AbsXInd, // jmp ($1234,x)
+  IZX,     // lda ($12,x)
+  IZY,     // lda ($12),y
+  IZP,     // lda ($12)
+  Rel,     // bne label
+  ZPRel    // bbr0 $12,label
+};
+
+struct OpcodeInfo {
+  Mnemonic Op;
+  AddrMode Mode;
+  uint8_t Cycles;
+};
+
+struct OpcodeTable {
+  OpcodeInfo Info[256];
+
+  void set(uint8_t Opcode, Mnemonic Op, AddrMode Mode, uint8_t Cycles) {
+    Info[Opcode] = {Op, Mode, Cycles};
+  }
+
+  explicit OpcodeTable(bool CMOS);
+};
+
+} // end anonymous namespace
+
+OpcodeTable::OpcodeTable(bool CMOS) {
+  for (OpcodeInfo &I : Info)
+    I = {ILL, Imp, 2};
+
+  // The ALU instructions share the same addressing modes.
+  const Mnemonic ALUOps[] = {ORA, AND, EOR, ADC, STA, LDA, CMP, SBC};
+  for (unsigned i = 0; i < array_lengthof(ALUOps); ++i) {
+    Mnemonic Op = ALUOps[i];
+    uint8_t Base = i << 5;
+    bool IsStore = Op == STA;
+    set(Base | 0x01, Op, IZX, 6);
+    set(Base | 0x05, Op, ZP, 3);
+    if (!IsStore)
+      set(Base | 0x09, Op, Imm, 2);
+    set(Base | 0x0d, Op, Abs, 4);
+    set(Base | 0x11, Op, IZY, IsStore ? 6 : 5);
+    set(Base | 0x15, Op, ZPX, 4);
+    set(Base | 0x19, Op, AbsY, IsStore ? 5 : 4);
+    set(Base | 0x1d, Op, AbsX, IsStore ? 5 : 4);
+    if (CMOS)
+      set(Base | 0x12, Op, IZP, 5);
+  }
+
+  // So do the read-modify-write instructions.
+  const Mnemonic RMWOps[] = {ASL, ROL, LSR, ROR, ILL, ILL, DEC, INC};
+  for (unsigned i = 0; i < array_lengthof(RMWOps); ++i) {
+    Mnemonic Op = RMWOps[i];
+    if (Op == ILL)
+      continue;
+    uint8_t Base = i << 5;
+    bool IsShift = Op != DEC && Op != INC;
+    set(Base | 0x06, Op, ZP, 5);
+    set(Base | 0x0e, Op, Abs, 6);
+    set(Base | 0x16, Op, ZPX, 6);
+    // The 65C02 only spends the seventh cycle of a shift on a page crossing.
+    set(Base | 0x1e, Op, AbsX, IsShift && CMOS ? 6 : 7);
+    if (IsShift)
+      set(Base | 0x0a, Op, Acc, 2);
+  }
+
+  set(0xa2, LDX, Imm, 2); set(0xa6, LDX, ZP, 3);  set(0xb6, LDX, ZPY, 4);
+  set(0xae, LDX, Abs, 4); set(0xbe, LDX, AbsY, 4);
+  set(0xa0, LDY, Imm, 2); set(0xa4, LDY, ZP, 3);  set(0xb4, LDY, ZPX, 4);
+  set(0xac, LDY, Abs, 4); set(0xbc, LDY, AbsX, 4);
+  set(0x86, STX, ZP, 3);  set(0x96, STX, ZPY, 4); set(0x8e, STX, Abs, 4);
+  set(0x84, STY, ZP, 3);  set(0x94, STY, ZPX, 4); set(0x8c, STY, Abs, 4);
+  set(0xe0, CPX, Imm, 2); set(0xe4, CPX, ZP, 3);  set(0xec, CPX, Abs, 4);
+  set(0xc0, CPY, Imm, 2); set(0xc4, CPY, ZP, 3);  set(0xcc, CPY, Abs, 4);
+  set(0x24, BIT, ZP, 3);  set(0x2c, BIT, Abs, 4);
+
+  set(0x10, BPL, Rel, 2); set(0x30, BMI, Rel, 2);
+  set(0x50, BVC, Rel, 2); set(0x70, BVS, Rel, 2);
+  set(0x90, BCC, Rel, 2); set(0xb0, BCS, Rel, 2);
+  set(0xd0, BNE, Rel, 2); set(0xf0, BEQ, Rel, 2);
+
+  set(0x00, BRK, Imp, 7); set(0x20, JSR, Abs, 6);
+  set(0x40, RTI, Imp, 6); set(0x60, RTS, Imp, 6);
+  set(0x4c, JMP, Abs, 3); set(0x6c, JMP, Ind, CMOS ? 6 : 5);
+  set(0x08, PHP, Imp, 3); set(0x28, PLP, Imp, 4);
+  set(0x48, PHA, Imp, 3); set(0x68, PLA, Imp, 4);
+
+  set(0x18, CLC, Imp, 2); set(0x38, SEC, Imp, 2);
+  set(0x58, CLI, Imp, 2); set(0x78, SEI, Imp, 2);
+  set(0xb8, CLV, Imp, 2); set(0xd8, CLD, Imp, 2);
+  set(0xf8, SED, Imp, 2); set(0xaa, TAX, Imp, 2);
+  set(0x8a, TXA, Imp, 2); set(0xa8, TAY, Imp, 2);
+  set(0x98, TYA, Imp, 2); set(0xba, TSX, Imp, 2);
+  set(0x9a, TXS, Imp, 2); set(0xe8, INX, Imp, 2);
+  set(0xc8, INY, Imp, 2); set(0xca, DEX, Imp, 2);
+  set(0x88, DEY, Imp, 2); set(0xea, NOP, Imp, 2);
+
+  if (!CMOS)
+    return;
+
+  set(0x89, BIT, Imm, 2); set(0x34, BIT, ZPX, 4); set(0x3c, BIT, AbsX, 4);
+  set(0x1a, INC, Acc, 2); set(0x3a, DEC, Acc, 2);
+  set(0x7c, JMP, AbsXInd, 6);
+  set(0x80, BRA, Rel, 2);
+  set(0x5a, PHY, Imp, 3); set(0x7a, PLY, Imp, 4);
+  set(0xda, PHX, Imp, 3); set(0xfa, PLX, Imp, 4);
+  set(0x64, STZ, ZP, 3);  set(0x74, STZ, ZPX, 4);
+  set(0x9c, STZ, Abs, 4); set(0x9e, STZ, AbsX, 5);
+  set(0x14, TRB, ZP, 5);  set(0x1c, TRB, Abs, 6);
+  set(0x04, TSB, ZP, 5);  set(0x0c, TSB, Abs, 6);
+  set(0xcb, WAI, Imp, 3); set(0xdb, STP, Imp, 3);
+  for (unsigned Bit = 0; Bit < 8; ++Bit) {
+    set(0x07 | Bit << 4, RMB, ZP, 5);
+    set(0x87 | Bit << 4, SMB, ZP, 5);
+    set(0x0f | Bit << 4, BBR, ZPRel, 5);
+    set(0x8f | Bit << 4, BBS, ZPRel, 5);
+  }
+
+  // The unused opcodes are NOPs of various sizes, which do not access memory.
+  for (uint8_t Opcode : {0x02, 0x22, 0x42, 0x62, 0x82, 0xc2, 0xe2})
+    set(Opcode, NOP, Imm, 2);
+  set(0x44, NOP, ZP, 3);
+  set(0x54, NOP, ZPX, 4); set(0xd4, NOP, ZPX, 4); set(0xf4, NOP, ZPX, 4);
+  set(0x5c, NOP, Abs, 8); set(0xdc, NOP, Abs, 4); set(0xfc, NOP, Abs, 4);
+  for (OpcodeInfo &I : Info)
+    if (I.Op == ILL)
+      I = {NOP, Imp, 1};
+}
+
+static const OpcodeTable &getOpcodeTable(bool CMOS) {
+  static const OpcodeTable NMOSTable(false);
+  static const OpcodeTable CMOSTable(true);
+  return CMOS ? CMOSTable : NMOSTable;
+}
+
+/// Return true if Op takes an extra cycle when its indexed address crosses a
+/// page.
+static bool hasPageCrossingPenalty(Mnemonic Op, AddrMode Mode, bool CMOS) {
+  switch (Op) {
+  case ADC: case AND: case BIT: case CMP: case EOR: case LDA: case LDX:
+  case LDY: case ORA: case SBC:
+    return true;
+  case ASL: case LSR: case ROL: case ROR:
+    return CMOS && Mode == AbsX;
+  default:
+    return false;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// M6502Simulator
+//===----------------------------------------------------------------------===//
+
+uint16_t M6502Simulator::fetch16() {
+  uint16_t Lo = fetch8();
+  return Lo | fetch8() << 8;
+}
+
+uint16_t M6502Simulator::read16(uint16_t Addr) {
+  uint16_t Lo = Mem.read(Addr);
+  return Lo | Mem.read(Addr + 1) << 8;
+}
+
+/// Read a pointer in the zero page, which wraps around from $FF to $00.
+uint16_t M6502Simulator::readZP16(uint8_t Addr) {
+  uint16_t Lo = Mem.read(Addr);
+  return Lo | Mem.read(uint8_t(Addr + 1)) << 8;
+}
+
+void M6502Simulator::enterFunction(uint16_t Address, unsigned StackTop) {
+  auto Inserted = ProfileIndex.insert({Address, Profiles.size()});
+  if (Inserted.second) {
+    Profiles.emplace_back();
+    Profiles.back().Address = Address;
+    Active.push_back(0);
+  }
+  unsigned Idx = Inserted.first->second;
+  ++Profiles[Idx].Calls;
+  ++Active[Idx];
+  Frames.push_back({Idx, StackTop, Cycles});
+}
+
+/// Pop the frames of the functions which returned, now that S is back above
+/// their return address.
+void M6502Simulator::leaveFunctions() {
+  while (!Frames.empty() && S >= Frames.back().StackTop) {
+    const Frame &F = Frames.back();
+    if (--Active[F.Function] == 0)
+      Profiles[F.Function].TotalCycles += Cycles - F.EntryCycles;
+    Frames.pop_back();
+    if (Frames.empty())
+      Stop = Returned;
+  }
+}
+
+void M6502Simulator::interrupt(uint16_t Vector, bool IsBreak) {
+  unsigned StackTop = S;
+  push(PC >> 8);
+  push(PC & 0xff);
+  push(P | FlagU | (IsBreak ? FlagB : 0));
+  P |= FlagI;
+  if (isCMOS())
+    P &= ~FlagD;
+  PC = read16(Vector);
+  enterFunction(PC, StackTop);
+}
+
+void M6502Simulator::reset() {
+  S = 0xfd;
+  P = FlagU | FlagI;
+  PC = read16(0xfffc);
+  Cycles += 7;
+  Stop = Running;
+  Waiting = false;
+  Frames.clear();
+  std::fill(Active.begin(), Active.end(), 0);
+  enterFunction(PC, 0x100);
+}
+
+void M6502Simulator::call(uint16_t Address) {
+  unsigned StackTop = S;
+  uint16_t Return = PC - 1;
+  push(Return >> 8);
+  push(Return & 0xff);
+  PC = Address;
+  Stop = Running;
+  enterFunction(Address, StackTop);
+}
+
+void M6502Simulator::adc(uint8_t Value) {
+  unsigned Carry = P & FlagC;
+  unsigned Sum = A + Value + Carry;
+  bool Overflow = ~(A ^ Value) & (A ^ Sum) & 0x80;
+
+  if (!(P & FlagD) || Kind == RP2A03) {
+    setFlag(FlagC, Sum > 0xff);
+    setFlag(FlagV, Overflow);
+    A = Sum;
+    setNZ(A);
+    return;
+  }
+
+  // Decimal mode.  The NMOS 6502 sets N and V from the sum of the high
+  // digits before it is adjusted, and Z from the binary sum.  The 65C02
+  // takes a cycle more to set N and Z from the result.
+  unsigned Lo = (A & 0x0f) + (Value & 0x0f) + Carry;
+  if (Lo >= 0x0a)
+    Lo = ((Lo + 0x06) & 0x0f) + 0x10;
+  unsigned Result = (A & 0xf0) + (Value & 0xf0) + Lo;
+  int Signed = int(int8_t(A & 0xf0)) + int(int8_t(Value & 0xf0)) + int(Lo);
+  setFlag(FlagV, Signed < -128 || Signed > 127);
+  bool Negative = Result & 0x80;
+  if (Result >= 0xa0)
+    Result += 0x60;
+  setFlag(FlagC, Result >= 0x100);
+
+  if (isCMOS()) {
+    A = Result;
+    setNZ(A);
+    ++Cycles;
+  } else {
+    A = Result;
+    setFlag(FlagZ, (Sum & 0xff) == 0);
+    setFlag(FlagN, Negative);
+  }
+}
+
+void M6502Simulator::sbc(uint8_t Value) {
+  unsigned Borrow = ~P & FlagC;
+  unsigned Diff = A - Value - Borrow;
+  bool Overflow = (A ^ Value) & (A ^ Diff) & 0x80;
+  setFlag(FlagC, Diff < 0x100);
+  setFlag(FlagV, Overflow);
+
+  if (!(P & FlagD) || Kind == RP2A03) {
+    A = Diff;
+    setNZ(A);
+    return;
+  }
+
+  // Decimal mode.  The NMOS 6502 sets all the flags from the binary
+  // difference, the 65C02 sets N and Z from the result.
+  int Lo = int(A & 0x0f) - int(Value & 0x0f) - int(Borrow);
+  int Result;
+  if (isCMOS()) {
+    Result = int(A) - int(Value) - int(Borrow);
+    if (Result < 0)
+      Result -= 0x60;
+    if (Lo < 0)
+      Result -= 0x06;
+    A = Result;
+    setNZ(A);
+    ++Cycles;
+  } else {
+    if (Lo < 0)
+      Lo = ((Lo - 0x06) & 0x0f) - 0x10;
+    Result = int(A & 0xf0) - int(Value & 0xf0) + Lo;
+    if (Result < 0)
+      Result -= 0x60;
+    A = Result;
+    setNZ(Diff);
+  }
+}
+
+void M6502Simulator::compare(uint8_t Reg, uint8_t Value) {
+  setFlag(FlagC, Reg >= Value);
+  setNZ(Reg - Value);
+}
+
+/// Take a branch if Taken, a cycle more, and another one to a different page.
+void M6502Simulator::branch(bool Taken, int8_t Offset) {
+  if (!Taken)
+    return;
+  uint16_t Target = PC + Offset;
+  Cycles += (Target ^ PC) & 0xff00 ? 2 : 1;
+  PC = Target;
+}
+
+void M6502Simulator::traceInstruction(uint16_t Addr) {
+  const OpcodeInfo &Info = getOpcodeTable(isCMOS()).Info[Mem.peek(Addr)];
+  uint8_t B1 = Mem.peek(Addr + 1);
+  uint16_t W = B1 | Mem.peek(Addr + 2) << 8;
+
+  std::string Text = MnemonicNames[Info.Op];
+  if (Info.Op == RMB || Info.Op == SMB || Info.Op == BBR || Info.Op == BBS)
+    Text += char('0' + (Mem.peek(Addr) >> 4 & 7));
+  raw_string_ostream OS(Text);
+  switch (Info.Mode) {
+  case Imp: break;
+  case Acc: OS << " a"; break;
+  case Imm: OS << " #$" << format_hex_no_prefix(B1, 2); break;
+  case ZP: OS << " $" << format_hex_no_prefix(B1, 2); break;
+  case ZPX: OS << " $" << format_hex_no_prefix(B1, 2) << ",x"; break;
+  case ZPY: OS << " $" << format_hex_no_prefix(B1, 2) << ",y"; break;
+  case Abs: OS << " $" << format_hex_no_prefix(W, 4); break;
+  case AbsX: OS << " $" << format_hex_no_prefix(W, 4) << ",x"; break;
+  case AbsY: OS << " $" << format_hex_no_prefix(W, 4) << ",y"; break;
+  case Ind: OS << " ($" << format_hex_no_prefix(W, 4) << ")"; break;
+  case AbsXInd: OS << " ($" << format_hex_no_prefix(W, 4) << ",x)"; break;
+  case IZX: OS << " ($" << format_hex_no_prefix(B1, 2) << ",x)"; break;
+  case IZY: OS << " ($" << format_hex_no_prefix(B1, 2) << "),y"; break;
+  case IZP: OS << " ($" << format_hex_no_prefix(B1, 2) << ")"; break;
+  case Rel:
+    OS << " $" << format_hex_no_prefix(uint16_t(Addr + 2 + int8_t(B1)), 4);
+    break;
+  case ZPRel:
+    OS << " $" << format_hex_no_prefix(B1, 2) << ",$"
+       << format_hex_no_prefix(
+              uint16_t(Addr + 3 + int8_t(Mem.peek(Addr + 2))), 4);
+    break;
+  }
+  OS.flush();
+
+  *Trace << format_hex_no_prefix(Addr, 4) << "  " << left_justify(Text, 16)
+         << "A=" << format_hex_no_prefix(A, 2)
+         << " X=" << format_hex_no_prefix(X, 2)
+         << " Y=" << format_hex_no_prefix(Y, 2)
+         << " S=" << format_hex_no_prefix(S, 2)
+         << " P=" << format_hex_no_prefix(P, 2) << " CYC=" << Cycles << "\n";
+}
+
+void M6502Simulator::step() {
+  if (Frames.empty())
+    enterFunction(PC, 0x100);
+
+  unsigned Function = Frames.back().Function;
+  uint64_t Start = Cycles;
+
+  while (IRQPeriod && Cycles >= NextIRQ) {
+    PendingIRQ = true;
+    NextIRQ += IRQPeriod;
+  }
+  while (NMIPeriod && Cycles >= NextNMI) {
+    PendingNMI = true;
+    NextNMI += NMIPeriod;
+  }
+
+  // WAI waits for any interrupt, even a masked one.
+  if (Waiting) {
+    if (PendingNMI || PendingIRQ) {
+      Waiting = false;
+    } else if (IRQPeriod || NMIPeriod) {
+      uint64_t Next = std::min(IRQPeriod ? NextIRQ : UINT64_MAX,
+                               NMIPeriod ? NextNMI : UINT64_MAX);
+      Profiles[Function].SelfCycles += Next - Cycles;
+      Cycles = Next;
+      return;
+    } else {
+      Stop = Stopped;
+      return;
+    }
+  }
+
+  if (PendingNMI || (PendingIRQ && !(P & FlagI))) {
+    bool IsNMI = PendingNMI;
+    (IsNMI ? PendingNMI : PendingIRQ) = false;
+    Cycles += 7;
+    Profiles[Function].SelfCycles += 7;
+    interrupt(IsNMI ? 0xfffa : 0xfffe, /*IsBreak=*/false);
+    return;
+  }
+
+  if (Trace)
+    traceInstruction(PC);
+
+  uint16_t InstAddr = PC;
+  uint8_t Opcode = fetch8();
+  const OpcodeInfo &Info = getOpcodeTable(isCMOS()).Info[Opcode];
+  if (Info.Op == ILL) {
+    PC = InstAddr;
+    Stop = IllegalOpcode;
+    return;
+  }
+
+  ++Instructions;
+  Cycles += Info.Cycles;
+
+  uint16_t EA = 0;
+  int8_t Offset = 0;
+  bool Crossed = false;
+  switch (Info.Mode) {
+  case Imp:
+  case Acc:
+    break;
+  case Imm:
+    EA = PC++;
+    break;
+  case ZP:
+    EA = fetch8();
+    break;
+  case ZPX:
+    EA = uint8_t(fetch8() + X);
+    break;
+  case ZPY:
+    EA = uint8_t(fetch8() + Y);
+    break;
+  case Abs:
+    EA = fetch16();
+    break;
+  case AbsX:
+  case AbsY: {
+    uint16_t Base = fetch16();
+    EA = Base + (Info.Mode == AbsX ? X : Y);
+    Crossed = (Base ^ EA) & 0xff00;
+    break;
+  }
+  case Ind: {
+    // The NMOS 6502 does not carry into the high byte of the pointer.
+    uint16_t Ptr = fetch16();
+    if (isCMOS())
+      EA = read16(Ptr);
+    else
+      EA = Mem.read(Ptr) |
+           Mem.read((Ptr & 0xff00) | ((Ptr + 1) & 0x00ff)) << 8;
+    break;
+  }
+  case AbsXInd:
+    EA = read16(fetch16() + X);
+    break;
+  case IZX:
+    EA = readZP16(fetch8() + X);
+    break;
+  case IZY: {
+    uint16_t Base = readZP16(fetch8());
+    EA = Base + Y;
+    Crossed = (Base ^ EA) & 0xff00;
+    break;
+  }
+  case IZP:
+    EA = readZP16(fetch8());
+    break;
+  case Rel:
+    Offset = fetch8();
+    break;
+  case ZPRel:
+    EA = fetch8();
+    Offset = fetch8();
+    break;
+  }
+
+  if (Crossed && hasPageCrossingPenalty(Info.Op, Info.Mode, isCMOS()))
+    ++Cycles;
+
+  auto Load = [&]() { return Info.Mode == Acc ? A : Mem.read(EA); };
+  auto Store = [&](uint8_t Value) {
+    if (Info.Mode == Acc)
+      A = Value;
+    else
+      Mem.write(EA, Value);
+  };
+  unsigned Bit = Opcode >> 4 & 7;
+
+  switch (Info.Op) {
+  case ILL:
+    llvm_unreachable("Illegal opcodes stop the simulation");
+
+  case ADC: adc(Load()); break;
+  case SBC: sbc(Load()); break;
+  case AND: A &= Load(); setNZ(A); break;
+  case ORA: A |= Load(); setNZ(A); break;
+  case EOR: A ^= Load(); setNZ(A); break;
+  case CMP: compare(A, Load()); break;
+  case CPX: compare(X, Load()); break;
+  case CPY: compare(Y, Load()); break;
+
+  case BIT: {
+    uint8_t Value = Load();
+    setFlag(FlagZ, !(A & Value));
+    if (Info.Mode != Imm)
+      P = (P & ~(FlagN | FlagV)) | (Value & (FlagN | FlagV));
+    break;
+  }
+
+  case ASL: {
+    uint8_t Value = Load();
+    setFlag(FlagC, Value & 0x80);
+    Value <<= 1;
+    setNZ(Value);
+    Store(Value);
+    break;
+  }
+  case LSR: {
+    uint8_t Value = Load();
+    setFlag(FlagC, Value & 0x01);
+    Value >>= 1;
+    setNZ(Value);
+    Store(Value);
+    break;
+  }
+  case ROL: {
+    uint8_t Value = Load();
+    uint8_t Carry = P & FlagC;
+    setFlag(FlagC, Value & 0x80);
+    Value = Value << 1 | Carry;
+    setNZ(Value);
+    Store(Value);
+    break;
+  }
+  case ROR: {
+    uint8_t Value = Load();
+    uint8_t Carry = P & FlagC;
+    setFlag(FlagC, Value & 0x01);
+    Value = Value >> 1 | Carry << 7;
+    setNZ(Value);
+    Store(Value);
+    break;
+  }
+  case INC: {
+    uint8_t Value = Load() + 1;
+    setNZ(Value);
+    Store(Value);
+    break;
+  }
+  case DEC: {
+    uint8_t Value = Load() - 1;
+    setNZ(Value);
+    Store(Value);
+    break;
+  }
+  case TRB: {
+    uint8_t Value = Load();
+    setFlag(FlagZ, !(A & Value));
+    Store(Value & ~A);
+    break;
+  }
+  case TSB: {
+    uint8_t Value = Load();
+    setFlag(FlagZ, !(A & Value));
+    Store(Value | A);
+    break;
+  }
+  case RMB: Store(Load() & ~(1 << Bit)); break;
+  case SMB: Store(Load() | 1 << Bit); break;
+
+  case LDA: A = Load(); setNZ(A); break;
+  case LDX: X = Load(); setNZ(X); break;
+  case LDY: Y = Load(); setNZ(Y); break;
+  case STA: Store(A); break;
+  case STX: Store(X); break;
+  case STY: Store(Y); break;
+  case STZ: Store(0); break;
+
+  case INX: setNZ(++X); break;
+  case INY: setNZ(++Y); break;
+  case DEX: setNZ(--X); break;
+  case DEY: setNZ(--Y); break;
+  case TAX: X = A; setNZ(X); break;
+  case TAY: Y = A; setNZ(Y); break;
+  case TXA: A = X; setNZ(A); break;
+  case TYA: A = Y; setNZ(A); break;
+  case TSX: X = S; setNZ(X); break;
+  case TXS: S = X; break;
+
+  case CLC: P &= ~FlagC; break;
+  case SEC: P |= FlagC; break;
+  case CLI: P &= ~FlagI; break;
+  case SEI: P |= FlagI; break;
+  case CLV: P &= ~FlagV; break;
+  case CLD: P &= ~FlagD; break;
+  case SED: P |= FlagD; break;
+
+  case PHA: push(A); break;
+  case PHX: push(X); break;
+  case PHY: push(Y); break;
+  case PHP: push(P | FlagB | FlagU); break;
+  case PLA: A = pull(); setNZ(A); break;
+  case PLX: X = pull(); setNZ(X); break;
+  case PLY: Y = pull(); setNZ(Y); break;
+  case PLP: P = (pull() & ~FlagB) | FlagU; break;
+
+  case BPL: branch(!(P & FlagN), Offset); break;
+  case BMI: branch(P & FlagN, Offset); break;
+  case BVC: branch(!(P & FlagV), Offset); break;
+  case BVS: branch(P & FlagV, Offset); break;
+  case BCC: branch(!(P & FlagC), Offset); break;
+  case BCS: branch(P & FlagC, Offset); break;
+  case BNE: branch(!(P & FlagZ), Offset); break;
+  case BEQ: branch(P & FlagZ, Offset); break;
+  case BRA: branch(true, Offset); break;
+  case BBR: branch(!(Load() & 1 << Bit), Offset); break;
+  case BBS: branch(Load() & 1 << Bit, Offset); break;
+
+  case JMP:
+    PC = EA;
+    break;
+  case JSR: {
+    unsigned StackTop = S;
+    uint16_t Return = PC - 1;
+    push(Return >> 8);
+    push(Return & 0xff);
+    PC = EA;
+    Profiles[Function].SelfCycles += Cycles - Start;
+    enterFunction(EA, StackTop);
+    return;
+  }
+  case RTS: {
+    uint16_t Lo = pull();
+    PC = (Lo | pull() << 8) + 1;
+    Profiles[Function].SelfCycles += Cycles - Start;
+    leaveFunctions();
+    return;
+  }
+  case RTI: {
+    P = (pull() & ~FlagB) | FlagU;
+    uint16_t Lo = pull();
+    PC = Lo | pull() << 8;
+    Profiles[Function].SelfCycles += Cycles - Start;
+    leaveFunctions();
+    return;
+  }
+  case BRK:
+    if (StopOnBreak) {
+      --Instructions;
+      Cycles = Start;
+      PC = InstAddr;
+      Stop = Break;
+      return;
+    }
+    // The byte following BRK is skipped.
+    ++PC;
+    Profiles[Function].SelfCycles += Cycles - Start;
+    interrupt(0xfffe, /*IsBreak=*/true);
+    return;
+
+  case NOP:
+    break;
+  case WAI:
+    Waiting = true;
+    break;
+  case STP:
+    Stop = Stopped;
+    break;
+  }
+
+  Profiles[Function].SelfCycles += Cycles - Start;
+}
+
+M6502Simulator::StopReason M6502Simulator::run(uint64_t MaxCycles) {
+  while (Stop == Running) {
+    if (MaxCycles && Cycles >= MaxCycles) {
+      Stop = CycleLimit;
+      break;
+    }
+    step();
+  }
+  return Stop;
+}
+
+std::vector<M6502Simulator::FunctionProfile>
+M6502Simulator::getProfile() const {
+  std::vector<FunctionProfile> Result = Profiles;
+  std::vector<bool> Counted(Profiles.size());
+  for (const Frame &F : Frames)
+    if (!Counted[F.Function]) {
+      Result[F.Function].TotalCycles += Cycles - F.EntryCycles;
+      Counted[F.Function] = true;
+    }
+  return Result;
+}
+
+StringRef M6502Simulator::getStopReasonName(StopReason Reason) {
+  switch (Reason) {
+  case Running: return "running";
+  case Returned: return "returned";
+  case Break: return "brk";
+  case Stopped: return "stopped";
+  case Exited: return "exited";
+  case IllegalOpcode: return "illegal opcode";
+  case CycleLimit: return "cycle limit";
+  }
+  llvm_unreachable("Unknown stop reason");
+}
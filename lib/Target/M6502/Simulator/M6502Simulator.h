@@ -0,0 +1,242 @@
+//===- M6502Simulator.h - 6502 instruction set simulator --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A deterministic simulator of the NMOS 6502, the 2A03 and the WDC 65C02,
+// which runs the images written by llc and counts the cycles they take.
+//
+// Instructions take the cycles of the data sheets, including the extra cycle
+// of a taken branch, of a page crossing and of decimal arithmetic on the
+// 65C02.  The bus is not simulated cycle by cycle: the dummy reads and writes
+// of the 6502 do not happen, so an I/O register is only accessed by the
+// instruction operand.  The undocumented opcodes of the NMOS parts stop the
+// simulation; the unused opcodes of the 65C02 are NOPs.
+//
+// The simulator follows the calls made with JSR and interrupts to count the
+// calls and cycles of every function.  A function returns when the stack
+// pointer gets back above the return address pushed by its call, so code
+// pushing an address and jumping to it with RTS is not mistaken for a return.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_M6502_SIMULATOR_M6502SIMULATOR_H
+#define LLVM_LIB_TARGET_M6502_SIMULATOR_M6502SIMULATOR_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace llvm {
+
+class raw_ostream;
+
+/// The 64K address space of the processor.  Ranges of addresses can be read
+/// only, like a ROM, or mapped to handlers simulating I/O registers.
+class M6502Memory {
+public:
+  typedef std::function<uint8_t(uint16_t)> ReadHandler;
+  typedef std::function<void(uint16_t, uint8_t)> WriteHandler;
+
+private:
+  struct IORange {
+    uint16_t Start, End;
+    ReadHandler Read;
+    WriteHandler Write;
+  };
+
+  std::vector<uint8_t> Bytes;
+  std::bitset<256> ReadOnlyPages;
+  std::bitset<256> IOPages;
+  SmallVector<IORange, 4> IORanges;
+
+  const IORange *findIO(uint16_t Addr) const;
+
+public:
+  M6502Memory() : Bytes(0x10000, 0) {}
+
+  /// Read or write a byte as the processor does, through the I/O handlers.
+  uint8_t read(uint16_t Addr);
+  void write(uint16_t Addr, uint8_t Value);
+
+  /// Read or write the memory behind the I/O handlers and read only pages.
+  uint8_t peek(uint16_t Addr) const { return Bytes[Addr]; }
+  void poke(uint16_t Addr, uint8_t Value) { Bytes[Addr] = Value; }
+
+  /// Copy Data to memory at Addr.  Return false if it runs past $FFFF.
+  bool load(uint16_t Addr, ArrayRef<uint8_t> Data);
+
+  /// Ignore the writes to the pages holding Start..End.
+  void setReadOnly(uint16_t Start, uint16_t End);
+
+  /// Send the accesses to Start..End to Read and Write.  A null handler
+  /// leaves the accesses of its kind to the memory.  The ranges mapped last
+  /// take precedence.
+  void mapIO(uint16_t Start, uint16_t End, ReadHandler Read,
+             WriteHandler Write);
+};
+
+class M6502Simulator {
+public:
+  enum CPUKind {
+    NMOS,   // The original 6502.
+    RP2A03, // The 6502 of the NES, without decimal mode.
+    WDC65C02
+  };
+
+  enum StopReason {
+    Running,
+    Returned,      // The function started with call() returned.
+    Break,         // BRK, when stopping on it.
+    Stopped,       // STP, or WAI without an interrupt to wait for.
+    Exited,        // requestExit() was called, by an I/O handler.
+    IllegalOpcode, // An opcode which is not simulated.
+    CycleLimit
+  };
+
+  enum Flags : uint8_t {
+    FlagC = 0x01,
+    FlagZ = 0x02,
+    FlagI = 0x04,
+    FlagD = 0x08,
+    FlagB = 0x10,
+    FlagU = 0x20,
+    FlagV = 0x40,
+    FlagN = 0x80
+  };
+
+  struct FunctionProfile {
+    uint16_t Address = 0;
+    uint64_t Calls = 0;
+    /// The cycles of the instructions of the function itself.
+    uint64_t SelfCycles = 0;
+    /// The cycles from the entry to the return of the function, including
+    /// the functions it calls.  Recursive calls are counted once.
+    uint64_t TotalCycles = 0;
+  };
+
+  uint16_t PC = 0;
+  uint8_t A = 0, X = 0, Y = 0, S = 0xfd, P = FlagU | FlagI;
+
+private:
+  struct Frame {
+    unsigned Function; // Index in Profiles.
+    unsigned StackTop; // S before the call, 0x100 when there is no caller.
+    uint64_t EntryCycles;
+  };
+
+  CPUKind Kind;
+  M6502Memory &Mem;
+  uint64_t Cycles = 0;
+  uint64_t Instructions = 0;
+  StopReason Stop = Running;
+  uint8_t ExitCode = 0;
+  bool StopOnBreak = true;
+  bool PendingIRQ = false;
+  bool PendingNMI = false;
+  bool Waiting = false;
+  uint64_t IRQPeriod = 0, NextIRQ = 0;
+  uint64_t NMIPeriod = 0, NextNMI = 0;
+  raw_ostream *Trace = nullptr;
+
+  std::vector<FunctionProfile> Profiles;
+  DenseMap<uint16_t, unsigned> ProfileIndex;
+  SmallVector<Frame, 32> Frames;
+  // How many times each function is on the call stack.
+  std::vector<unsigned> Active;
+
+  bool isCMOS() const { return Kind == WDC65C02; }
+
+  uint8_t fetch8() { return Mem.read(PC++); }
+  uint16_t fetch16();
+  uint16_t read16(uint16_t Addr);
+  uint16_t readZP16(uint8_t Addr);
+  void push(uint8_t Value) { Mem.write(0x100 | S--, Value); }
+  uint8_t pull() { return Mem.read(0x100 | ++S); }
+  void setFlag(uint8_t Flag, bool Value) {
+    P = Value ? P | Flag : P & ~Flag;
+  }
+  void setNZ(uint8_t Value) {
+    setFlag(FlagZ, Value == 0);
+    setFlag(FlagN, Value & 0x80);
+  }
+
+  void enterFunction(uint16_t Address, unsigned StackTop);
+  void leaveFunctions();
+  void interrupt(uint16_t Vector, bool IsBreak);
+  void adc(uint8_t Value);
+  void sbc(uint8_t Value);
+  void compare(uint8_t Reg, uint8_t Value);
+  void branch(bool Taken, int8_t Offset);
+  void traceInstruction(uint16_t Addr);
+
+public:
+  M6502Simulator(CPUKind Kind, M6502Memory &Mem) : Kind(Kind), Mem(Mem) {}
+
+  CPUKind getKind() const { return Kind; }
+  M6502Memory &getMemory() { return Mem; }
+  uint64_t getCycles() const { return Cycles; }
+  uint64_t getInstructions() const { return Instructions; }
+  StopReason getStopReason() const { return Stop; }
+  uint8_t getExitCode() const { return ExitCode; }
+
+  /// Stop on BRK instead of taking the interrupt.  The default.
+  void setStopOnBreak(bool Value) { StopOnBreak = Value; }
+
+  /// Print every instruction with the registers before it to OS.
+  void setTrace(raw_ostream *OS) { Trace = OS; }
+
+  /// Start from the reset vector, as the processor does on power up.
+  void reset();
+
+  /// Call the function at Address as a JSR from outside of the program
+  /// would, so that the simulation stops when it returns.
+  void call(uint16_t Address);
+
+  /// Request an interrupt, taken before the next instruction.
+  void irq() { PendingIRQ = true; }
+  void nmi() { PendingNMI = true; }
+
+  /// Request an interrupt every Period cycles, like a timer or the vertical
+  /// blank of a video chip would.  A period of zero disables it.
+  void setIRQPeriod(uint64_t Period) {
+    IRQPeriod = Period;
+    NextIRQ = Cycles + Period;
+  }
+  void setNMIPeriod(uint64_t Period) {
+    NMIPeriod = Period;
+    NextNMI = Cycles + Period;
+  }
+
+  /// Stop the simulation after the current instruction.
+  void requestExit(uint8_t Code) {
+    Stop = Exited;
+    ExitCode = Code;
+  }
+
+  /// Execute one instruction, or take a pending interrupt.
+  void step();
+
+  /// Execute instructions until the simulation stops or MaxCycles is
+  /// reached.  A limit of zero is no limit.
+  StopReason run(uint64_t MaxCycles = 0);
+
+  /// The profile of every function called so far, in order of first call.
+  /// The functions which have not returned yet are counted up to now.
+  std::vector<FunctionProfile> getProfile() const;
+
+  static StringRef getStopReasonName(StopReason Reason);
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_M6502_SIMULATOR_M6502SIMULATOR_H
@@ -0,0 +1,96 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=m6502 | FileCheck %s
+
+target triple = "m6502"
+
+; Each byte of an add or a logical operation is one instruction.  A shift
+; by a constant moves whole bytes and shifts each byte once per remaining
+; bit, a variable shift is a loop.  Multiplication and division go to the
+; runtime library unless the constant is a power of two.
+
+; CHECK-LABEL: function 'arith'
+; CHECK: cost of 1 for instruction: %add8 = add i8 %a8, %a8
+; CHECK: cost of 2 for instruction: %add16 = add i16 %a16, %a16
+; CHECK: cost of 4 for instruction: %add32 = add i32 %a32, %a32
+; CHECK: cost of 4 for instruction: %and32 = and i32 %a32, %a32
+; CHECK: cost of 4 for instruction: %shl8 = shl i8 %a8, 3
+; CHECK: cost of 2 for instruction: %shl16 = shl i16 %a16, 8
+; CHECK: cost of 4 for instruction: %shl16b = shl i16 %a16, 9
+; CHECK: cost of 18 for instruction: %shl32v = shl i32 %a32, %a32
+; CHECK: cost of 20 for instruction: %mul8 = mul i8 %a8, %a8
+; CHECK: cost of 56 for instruction: %mul16 = mul i16 %a16, %a16
+; CHECK: cost of 200 for instruction: %mul32 = mul i32 %a32, %a32
+; CHECK: cost of 6 for instruction: %mul16p = mul i16 %a16, 4
+; CHECK: cost of 104 for instruction: %udiv16 = udiv i16 %a16, %a16
+; CHECK: cost of 6 for instruction: %udiv16p = udiv i16 %a16, 8
+; CHECK: cost of 112 for instruction: %sdiv16 = sdiv i16 %a16, %a16
+define void @arith(i8 %a8, i16 %a16, i32 %a32) {
+  %add8 = add i8 %a8, %a8
+  %add16 = add i16 %a16, %a16
+  %add32 = add i32 %a32, %a32
+  %and32 = and i32 %a32, %a32
+  %shl8 = shl i8 %a8, 3
+  %shl16 = shl i16 %a16, 8
+  %shl16b = shl i16 %a16, 9
+  %shl32v = shl i32 %a32, %a32
+  %mul8 = mul i8 %a8, %a8
+  %mul16 = mul i16 %a16, %a16
+  %mul32 = mul i32 %a32, %a32
+  %mul16p = mul i16 %a16, 4
+  %udiv16 = udiv i16 %a16, %a16
+  %udiv16p = udiv i16 %a16, 8
+  %sdiv16 = sdiv i16 %a16, %a16
+  ret void
+}
+
+; A truncation is free, an extension clears or sets the new bytes.
+
+; CHECK-LABEL: function 'casts'
+; CHECK: cost of 0 for instruction: %t = trunc i32 %a32 to i8
+; CHECK: cost of 1 for instruction: %z16 = zext i8 %a8 to i16
+; CHECK: cost of 3 for instruction: %z32 = zext i8 %a8 to i32
+; CHECK: cost of 3 for instruction: %s16 = sext i8 %a8 to i16
+; CHECK: cost of 4 for instruction: %s32 = sext i16 %a16 to i32
+define void @casts(i8 %a8, i16 %a16, i32 %a32) {
+  %t = trunc i32 %a32 to i8
+  %z16 = zext i8 %a8 to i16
+  %z32 = zext i8 %a8 to i32
+  %s16 = sext i8 %a8 to i16
+  %s32 = sext i16 %a16 to i32
+  ret void
+}
+
+; A comparison looks at every byte, a select branches around a copy.
+
+; CHECK-LABEL: function 'cmpsel'
+; CHECK: cost of 1 for instruction: %c8 = icmp eq i8 %a8, %a8
+; CHECK: cost of 2 for instruction: %c16 = icmp ult i16 %a16, %a16
+; CHECK: cost of 4 for instruction: %c32 = icmp slt i32 %a32, %a32
+; CHECK: cost of 3 for instruction: %s8 = select i1 %c, i8 %a8, i8 %a8
+; CHECK: cost of 4 for instruction: %s16 = select i1 %c, i16 %a16, i16 %a16
+define void @cmpsel(i8 %a8, i16 %a16, i32 %a32, i1 %c) {
+  %c8 = icmp eq i8 %a8, %a8
+  %c16 = icmp ult i16 %a16, %a16
+  %c32 = icmp slt i32 %a32, %a32
+  %s8 = select i1 %c, i8 %a8, i8 %a8
+  %s16 = select i1 %c, i16 %a16, i16 %a16
+  ret void
+}
+
+; Every byte is loaded and stored on its own, whatever the alignment.
+
+; CHECK-LABEL: function 'memory'
+; CHECK: cost of 1 for instruction: %l8 = load i8, i8* %p8
+; CHECK: cost of 2 for instruction: %l16 = load i16, i16* %p16, align 1
+; CHECK: cost of 4 for instruction: %l32 = load i32, i32* %p32, align 1
+; CHECK: cost of 1 for instruction: store i8 %l8, i8* %p8
+; CHECK: cost of 2 for instruction: store i16 %l16, i16* %p16, align 1
+; CHECK: cost of 4 for instruction: store i32 %l32, i32* %p32, align 1
+define void @memory(i8* %p8, i16* %p16, i32* %p32) {
+  %l8 = load i8, i8* %p8
+  %l16 = load i16, i16* %p16, align 1
+  %l32 = load i32, i32* %p32, align 1
+  store i8 %l8, i8* %p8
+  store i16 %l16, i16* %p16, align 1
+  store i32 %l32, i32* %p32, align 1
+  ret void
+}
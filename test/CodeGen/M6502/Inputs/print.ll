@@ -0,0 +1,48 @@
+; Output helpers for the tests which run their code in llvm-m6502-sim with
+; -io-putchar='$FFF0'.
+
+target triple = "m6502"
+
+@digits = constant [16 x i8] c"0123456789ABCDEF"
+
+define void @putchar(i8 %c) noinline {
+  store volatile i8 %c, i8* inttoptr (i16 65520 to i8*)
+  ret void
+}
+
+define void @put8(i8 %v) noinline {
+  %h = lshr i8 %v, 4
+  %hi = zext i8 %h to i16
+  %ph = getelementptr [16 x i8], [16 x i8]* @digits, i16 0, i16 %hi
+  %ch = load i8, i8* %ph
+  call void @putchar(i8 %ch)
+  %l = and i8 %v, 15
+  %li = zext i8 %l to i16
+  %pl = getelementptr [16 x i8], [16 x i8]* @digits, i16 0, i16 %li
+  %cl = load i8, i8* %pl
+  call void @putchar(i8 %cl)
+  ret void
+}
+
+define void @put16(i16 %v) noinline {
+  %h = lshr i16 %v, 8
+  %h8 = trunc i16 %h to i8
+  call void @put8(i8 %h8)
+  %l8 = trunc i16 %v to i8
+  call void @put8(i8 %l8)
+  ret void
+}
+
+define void @put32(i32 %v) noinline {
+  %h = lshr i32 %v, 16
+  %h16 = trunc i32 %h to i16
+  call void @put16(i16 %h16)
+  %l16 = trunc i32 %v to i16
+  call void @put16(i16 %l16)
+  ret void
+}
+
+define void @newline() noinline {
+  call void @putchar(i8 10)
+  ret void
+}
@@ -0,0 +1,170 @@
+; RUN: llc -mtriple=m6502 -mcpu=65816 -O2 -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+; RUN: llc -mtriple=m6502 -mcpu=65816 -O2 -verify-machineinstrs \
+; RUN:   -show-mc-encoding < %s | FileCheck %s --check-prefix=ENC
+
+; On the 65816, word operations run with a 16-bit accumulator between
+; REP #$20 and SEP #$20.  A is 8 bits wide at calls, returns and the entry
+; of a function, and the switches are placed as rarely as the CFG allows.
+; The .a16 and .a8 directives tell the assembler the size of immediates.
+
+target triple = "m6502"
+
+declare void @ext()
+
+; CHECK-LABEL: add16:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: clc
+; CHECK-NEXT: rep #32
+; CHECK-NEXT: .a16
+; CHECK-NEXT: lda rc4
+; CHECK-NEXT: adc rc5
+; CHECK-NEXT: sta rc4
+; CHECK-NEXT: sep #32
+; CHECK-NEXT: .a8
+; CHECK-NEXT: rts
+define i16 @add16(i16 %a, i16 %b) {
+  %r = add i16 %a, %b
+  ret i16 %r
+}
+
+; A is switched back to 8 bits around a call.  A wide immediate takes two
+; bytes, and a byte immediate under SEP one.
+; CHECK-LABEL: callwide:
+; CHECK: rep #32
+; CHECK: adc rc5
+; CHECK-NEXT: sta rc8
+; CHECK-NEXT: sep #32
+; CHECK-NEXT: .a8
+; CHECK-NEXT: jsr ext
+; CHECK-NEXT: clc
+; CHECK-NEXT: rep #32
+; CHECK-NEXT: .a16
+; CHECK-NEXT: lda rc8
+; CHECK-NEXT: adc #4660
+; CHECK: adc #2
+; CHECK-NEXT: sta rc0
+; CHECK-NEXT: sep #32
+; CHECK-NEXT: .a8
+; CHECK-NEXT: rts
+; ENC-LABEL: callwide:
+; ENC: rep #32 ; encoding: [0xc2,0x20]
+; ENC: adc #4660 ; encoding: [0x69,0x34,0x12]
+; ENC: sep #32 ; encoding: [0xe2,0x20]
+; ENC: ldy #1 ; encoding: [0xa0,0x01]
+define i16 @callwide(i16 %a, i16 %b) {
+  %s = add i16 %a, %b
+  call void @ext()
+  %r = add i16 %s, 4660
+  ret i16 %r
+}
+
+; The join needs 16 bits first.  The byte wide path switches at its end,
+; since the join is its only successor, and the word wide path on its own.
+; The join then needs no switch.
+; CHECK-LABEL: join:
+; CHECK: cmp #0
+; CHECK-NEXT: beq [[T:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: ; BB#1:
+; CHECK-NOT: rep
+; CHECK: stz rs5
+; CHECK-NEXT: rep #32
+; CHECK-NEXT: .a16
+; CHECK-NEXT: bra [[J:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: [[T]]:
+; CHECK-NEXT: clc
+; CHECK-NEXT: rep #32
+; CHECK-NEXT: lda rc4
+; CHECK: [[J]]:
+; CHECK-NOT: rep
+; CHECK-NOT: sep
+; CHECK: sbc rc2
+; CHECK-NEXT: sta rc4
+; CHECK-NEXT: sep #32
+; CHECK-NEXT: .a8
+; CHECK-NEXT: rts
+; ENC-LABEL: join:
+; ENC: cmp #0 ; encoding: [0xc9,0x00]
+define i16 @join(i8 %c, i16 %a, i16 %b) {
+entry:
+  %z = icmp eq i8 %c, 0
+  br i1 %z, label %t, label %f
+t:
+  %x = add i16 %a, %b
+  br label %j
+f:
+  %c2 = mul i8 %c, 3
+  %y = zext i8 %c2 to i16
+  br label %j
+j:
+  %p = phi i16 [ %x, %t ], [ %y, %f ]
+  %q = xor i16 %p, %a
+  %r = add i16 %q, %b
+  %s = sub i16 %r, %p
+  ret i16 %s
+}
+
+; A loop which is 16 bits throughout switches once in its preheader, and
+; back at the return.
+; CHECK-LABEL: countdown:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: rep #32
+; CHECK-NEXT: .a16
+; CHECK-NEXT: lda #0
+; CHECK-NEXT: sta rc2
+; CHECK-NEXT: [[LOOP:.LBB[0-9]+_[0-9]+]]:
+; CHECK-NOT: rep
+; CHECK-NOT: sep
+; CHECK: adc #65535
+; CHECK-NOT: rep
+; CHECK-NOT: sep
+; CHECK: bne [[LOOP]]
+; CHECK-NEXT: ; BB#2:
+; CHECK-NEXT: lda rc2
+; CHECK-NEXT: sta rc4
+; CHECK-NEXT: sep #32
+; CHECK-NEXT: .a8
+; CHECK-NEXT: rts
+; ENC-LABEL: countdown:
+; ENC: lda #0 ; encoding: [0xa9,0x00,0x00]
+; ENC: adc #65535 ; encoding: [0x69,0xff,0xff]
+define i16 @countdown(i16 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i16 [ %n, %entry ], [ %i.next, %loop ]
+  %s = phi i16 [ 0, %entry ], [ %s.next, %loop ]
+  %s.next = add i16 %s, %i
+  %i.next = sub i16 %i, 1
+  %more = icmp ne i16 %i.next, 0
+  br i1 %more, label %loop, label %done
+done:
+  ret i16 %s.next
+}
+
+; A loop mixing both widths switches inside it.
+; CHECK-LABEL: sum:
+; CHECK: [[LOOP:.LBB[0-9]+_[0-9]+]]:
+; CHECK: rol rs11
+; CHECK-NEXT: clc
+; CHECK-NEXT: rep #32
+; CHECK: sep #32
+; CHECK-NEXT: .a8
+; CHECK-NEXT: inc rs7
+; CHECK: bcc [[LOOP]]
+define i16 @sum(i16* %p, i8 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i8 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i16 [ 0, %entry ], [ %s.next, %loop ]
+  %idx = zext i8 %i to i16
+  %q = getelementptr inbounds i16, i16* %p, i16 %idx
+  %v = load i16, i16* %q
+  %s.next = add i16 %s, %v
+  %i.next = add i8 %i, 1
+  %more = icmp ult i8 %i.next, %n
+  br i1 %more, label %loop, label %done
+done:
+  ret i16 %s.next
+}
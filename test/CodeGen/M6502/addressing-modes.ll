@@ -0,0 +1,114 @@
+; RUN: llc -mtriple=m6502 -O2 -show-mc-encoding < %s | FileCheck %s
+; RUN: llvm-link %s %S/Inputs/print.ll -o %t.bc
+; RUN: llc -O2 -filetype=obj -m6502-image=raw -m6502-image-symbols=%t.sym \
+; RUN:   %t.bc -o %t.bin
+; RUN: llvm-m6502-sim -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   | FileCheck %s --check-prefix=SIM
+
+; An array indexed with a byte is accessed with abs,X, and a pointer indexed
+; with a byte with (zp),Y.  Only an object in the zero page takes zp,X: an
+; indexed zero page access wraps around within the zero page, so a constant
+; base below $100 still takes abs,X.
+
+target triple = "m6502"
+
+@arr = global [200 x i8] zeroinitializer
+@zarr = global [4 x i8] zeroinitializer, section ".zp"
+
+; CHECK-LABEL: absx:
+; CHECK: tax
+; CHECK-NEXT: lda arr,x ; encoding: [0xbd,A,A]
+define i8 @absx(i8 %i) noinline {
+  %x = zext i8 %i to i16
+  %p = getelementptr [200 x i8], [200 x i8]* @arr, i16 0, i16 %x
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: absx_offset:
+; CHECK: sta arr+5,x ; encoding: [0x9d,A,A]
+define void @absx_offset(i8 %i) noinline {
+  %x = zext i8 %i to i16
+  %j = add nuw i16 %x, 5
+  %p = getelementptr [200 x i8], [200 x i8]* @arr, i16 0, i16 %j
+  store i8 7, i8* %p
+  ret void
+}
+
+; A word masked to a byte indexes as well.
+
+; CHECK-LABEL: masked:
+; CHECK: lda rs8
+; CHECK-NEXT: and #7
+; CHECK-NEXT: tax
+; CHECK-NEXT: lda arr,x ; encoding: [0xbd,A,A]
+define i8 @masked(i16 %i) noinline {
+  %m = and i16 %i, 7
+  %p = getelementptr [200 x i8], [200 x i8]* @arr, i16 0, i16 %m
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: zpx:
+; CHECK: tax
+; CHECK-NEXT: lda zarr,x ; encoding: [0xb5,A]
+define i8 @zpx(i8 %i) noinline {
+  %x = zext i8 %i to i16
+  %p = getelementptr [4 x i8], [4 x i8]* @zarr, i16 0, i16 %x
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: constbase:
+; CHECK: tax
+; CHECK-NEXT: lda $80,x ; encoding: [0xbd,0x80,0x00]
+define i8 @constbase(i8 %i) noinline {
+  %x = zext i8 %i to i16
+  %p = getelementptr i8, i8* inttoptr (i16 128 to i8*), i16 %x
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: indy:
+; CHECK: tay
+; CHECK-NEXT: lda (rc4),y ; encoding: [0xb1,0x88]
+define i8 @indy(i8* %p, i8 %i) noinline {
+  %x = zext i8 %i to i16
+  %q = getelementptr i8, i8* %p, i16 %x
+  %v = load i8, i8* %q
+  ret i8 %v
+}
+
+; $80 + $90 reads $0110, not $0010.
+
+; SIM: 5A
+; SIM-NEXT: 07
+; SIM-NEXT: 07
+; SIM-NEXT: 33
+; SIM-NEXT: 5A
+declare void @put8(i8)
+declare void @newline()
+
+define i8 @main() {
+  store volatile i8 u0x5A, i8* inttoptr (i16 u0x110 to i8*)
+  store volatile i8 u0xA5, i8* inttoptr (i16 u0x10 to i8*)
+  %c = call i8 @constbase(i8 u0x90)
+  call void @put8(i8 %c)
+  call void @newline()
+  call void @absx_offset(i8 u0xC2)
+  %a = call i8 @absx(i8 u0xC7)
+  call void @put8(i8 %a)
+  call void @newline()
+  call void @absx_offset(i8 0)
+  %m = call i8 @masked(i16 u0x1235)
+  call void @put8(i8 %m)
+  call void @newline()
+  store i8 u0x33, i8* getelementptr ([4 x i8], [4 x i8]* @zarr, i16 0, i16 3)
+  %z = call i8 @zpx(i8 3)
+  call void @put8(i8 %z)
+  call void @newline()
+  %y = call i8 @indy(i8* inttoptr (i16 u0x100 to i8*), i8 u0x10)
+  call void @put8(i8 %y)
+  call void @newline()
+  ret i8 0
+}
@@ -0,0 +1,76 @@
+; RUN: llc -mtriple=m6502 -O2 -m6502-zp-budget=0 -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+
+; Pointers are two bytes and nothing is aligned beyond a byte, so globals,
+; structure fields and stack objects are packed.
+
+target triple = "m6502"
+
+%rec = type { i8, i16, i32, i8* }
+
+@flag = global i8 1
+@word = global i16 2
+@long = global i32 3
+@rec = global %rec { i8 4, i16 5, i32 6, i8* @flag }
+@ptrs = global [2 x i8*] [i8* @flag, i8* null]
+@size = global i16 ptrtoint (%rec* getelementptr (%rec, %rec* null, i16 1) to i16)
+@off = global i16 ptrtoint (i32* getelementptr (%rec, %rec* null, i16 0, i32 2) to i16)
+
+declare void @use(i8*, i16*, i32*)
+
+; The three objects take 7 bytes of the soft stack, at offsets 6, 4 and 0,
+; and the stack pointer is not realigned.
+
+; CHECK-LABEL: frame:
+; CHECK: clc
+; CHECK-NEXT: lda rs0
+; CHECK-NEXT: adc #249
+; CHECK-NEXT: sta rs0
+; CHECK-NEXT: lda rs1
+; CHECK-NEXT: adc #255
+; CHECK-NEXT: sta rs1
+; CHECK-NOT: and
+; CHECK: adc #6
+; CHECK: adc #4
+; CHECK: adc #0
+; CHECK: jsr use
+; CHECK-NEXT: clc
+; CHECK-NEXT: lda rs0
+; CHECK-NEXT: adc #7
+; CHECK-NEXT: sta rs0
+define void @frame() {
+  %b = alloca i8
+  %w = alloca i16
+  %l = alloca i32
+  call void @use(i8* %b, i16* %w, i32* %l)
+  ret void
+}
+
+; CHECK-NOT: .p2align
+; CHECK-LABEL: flag:
+; CHECK-NEXT: .byte 1
+; CHECK-NEXT: .size flag, 1
+; CHECK-NOT: .p2align
+; CHECK-LABEL: word:
+; CHECK-NEXT: .2byte 2
+; CHECK-NEXT: .size word, 2
+; CHECK-NOT: .p2align
+; CHECK-LABEL: long:
+; CHECK-NEXT: .4byte 3
+; CHECK-NEXT: .size long, 4
+; CHECK-NOT: .p2align
+; CHECK-LABEL: rec:
+; CHECK-NEXT: .byte 4
+; CHECK-NEXT: .2byte 5
+; CHECK-NEXT: .4byte 6
+; CHECK-NEXT: .2byte flag
+; CHECK-NEXT: .size rec, 9
+; CHECK-NOT: .p2align
+; CHECK-LABEL: ptrs:
+; CHECK-NEXT: .2byte flag
+; CHECK-NEXT: .2byte 0
+; CHECK-NEXT: .size ptrs, 4
+; CHECK-LABEL: size:
+; CHECK-NEXT: .2byte 0+9
+; CHECK-LABEL: off:
+; CHECK-NEXT: .2byte 0+3
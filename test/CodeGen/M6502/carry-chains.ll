@@ -0,0 +1,174 @@
+; RUN: llc -mtriple=m6502 -O2 < %s | FileCheck %s
+; RUN: llvm-link %s %S/Inputs/print.ll -o %t.bc
+; RUN: llc -O2 -filetype=obj -m6502-image=raw -m6502-image-symbols=%t.sym \
+; RUN:   %t.bc -o %t.bin
+; RUN: llvm-m6502-sim -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   | FileCheck %s --check-prefix=SIM
+
+; i16 and i32 are expanded into byte operations chained through the carry.
+
+target triple = "m6502"
+
+; CHECK-LABEL: add16:
+; CHECK: clc
+; CHECK-NEXT: lda rs8
+; CHECK-NEXT: adc rs10
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: lda rs9
+; CHECK-NEXT: adc rs11
+; CHECK-NEXT: sta rs9
+; CHECK-NEXT: rts
+define i16 @add16(i16 %a, i16 %b) noinline {
+  %r = add i16 %a, %b
+  ret i16 %r
+}
+
+; CHECK-LABEL: sub32:
+; CHECK: sec
+; CHECK-NEXT: lda rs8
+; CHECK-NEXT: sbc rs12
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: lda rs9
+; CHECK-NEXT: sbc rs13
+; CHECK-NEXT: sta rs9
+; CHECK-NEXT: lda rs10
+; CHECK-NEXT: sbc rs14
+; CHECK-NEXT: sta rs10
+; CHECK-NEXT: lda rs11
+; CHECK-NEXT: sbc rs15
+; CHECK-NEXT: sta rs11
+; CHECK-NEXT: rts
+define i32 @sub32(i32 %a, i32 %b) noinline {
+  %r = sub i32 %a, %b
+  ret i32 %r
+}
+
+; CHECK-LABEL: shl16:
+; CHECK: lda rs9
+; CHECK-NEXT: asl rs8
+; CHECK-NEXT: rol a
+; CHECK-NEXT: asl rs8
+; CHECK-NEXT: rol a
+; CHECK-NEXT: asl rs8
+; CHECK-NEXT: rol a
+; CHECK-NEXT: sta rs9
+define i16 @shl16(i16 %a) noinline {
+  %r = shl i16 %a, 3
+  ret i16 %r
+}
+
+; CHECK-LABEL: lshr16:
+; CHECK: lsr rs9
+; CHECK-NEXT: ror rs8
+; CHECK-NEXT: rts
+define i16 @lshr16(i16 %a) noinline {
+  %r = lshr i16 %a, 1
+  ret i16 %r
+}
+
+; The sign goes into the carry with CMP #$80.
+
+; CHECK-LABEL: ashr16:
+; CHECK: lda rs9
+; CHECK-NEXT: cmp #128
+; CHECK-NEXT: ror a
+; CHECK-NEXT: ror rs8
+; CHECK-NEXT: cmp #128
+; CHECK-NEXT: ror a
+; CHECK-NEXT: ror rs8
+; CHECK-NEXT: sta rs9
+define i16 @ashr16(i16 %a) noinline {
+  %r = ashr i16 %a, 2
+  ret i16 %r
+}
+
+; An ordered compare subtracts the high bytes after comparing the low ones.
+
+; CHECK-LABEL: ult16:
+; CHECK: cmp rs10
+; CHECK-NEXT: lda rs5
+; CHECK-NEXT: sbc rs11
+; CHECK-NEXT: bcc
+define i8 @ult16(i16 %a, i16 %b) noinline {
+  %c = icmp ult i16 %a, %b
+  %r = zext i1 %c to i8
+  ret i8 %r
+}
+
+; A signed compare flips the sign bits first.
+
+; CHECK-LABEL: slt16:
+; CHECK: eor #128
+; CHECK: eor #128
+; CHECK: cmp rs4
+; CHECK-NEXT: lda rs7
+; CHECK-NEXT: sbc rs5
+; CHECK-NEXT: bcc
+define i8 @slt16(i16 %a, i16 %b) noinline {
+  %c = icmp slt i16 %a, %b
+  %r = zext i1 %c to i8
+  ret i8 %r
+}
+
+; CHECK-LABEL: eq16:
+; CHECK: eor rs10
+; CHECK-NEXT: sta rs2
+; CHECK-NEXT: lda rs5
+; CHECK-NEXT: eor rs11
+; CHECK-NEXT: ora rs2
+; CHECK-NEXT: beq
+define i8 @eq16(i16 %a, i16 %b) noinline {
+  %c = icmp eq i16 %a, %b
+  %r = zext i1 %c to i8
+  ret i8 %r
+}
+
+; The carry and the borrow cross the byte boundaries, and the compares are
+; decided by the low bytes when the high bytes are equal.
+
+; SIM: 1300
+; SIM-NEXT: 0000FFFF
+; SIM-NEXT: 91A0
+; SIM-NEXT: 4000
+; SIM-NEXT: E001
+; SIM-NEXT: 00010100
+; SIM-NEXT: 010000
+declare void @put8(i8)
+declare void @put16(i16)
+declare void @put32(i32)
+declare void @newline()
+
+define i8 @main() {
+  %a = call i16 @add16(i16 u0x12FF, i16 1)
+  call void @put16(i16 %a)
+  call void @newline()
+  %s = call i32 @sub32(i32 u0x10000, i32 1)
+  call void @put32(i32 %s)
+  call void @newline()
+  %sl = call i16 @shl16(i16 u0x1234)
+  call void @put16(i16 %sl)
+  call void @newline()
+  %lr = call i16 @lshr16(i16 u0x8001)
+  call void @put16(i16 %lr)
+  call void @newline()
+  %ar = call i16 @ashr16(i16 u0x8004)
+  call void @put16(i16 %ar)
+  call void @newline()
+  %u0 = call i8 @ult16(i16 u0x100, i16 u0xFF)
+  call void @put8(i8 %u0)
+  %u1 = call i8 @ult16(i16 u0xFF, i16 u0x100)
+  call void @put8(i8 %u1)
+  %s0 = call i8 @slt16(i16 u0xFFFF, i16 1)
+  call void @put8(i8 %s0)
+  %s1 = call i8 @slt16(i16 1, i16 u0xFFFF)
+  call void @put8(i8 %s1)
+  call void @newline()
+  %e0 = call i8 @eq16(i16 u0x1234, i16 u0x1234)
+  call void @put8(i8 %e0)
+  %e1 = call i8 @eq16(i16 u0x1234, i16 u0x1235)
+  call void @put8(i8 %e1)
+  %e2 = call i8 @eq16(i16 u0x1234, i16 u0x1334)
+  call void @put8(i8 %e2)
+  call void @newline()
+  ret i8 0
+}
@@ -0,0 +1,214 @@
+; RUN: llc -mtriple=m6502 -mcpu=65c02 -O2 < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,CMOS,NOBITS
+; RUN: llc -mtriple=m6502 -mcpu=w65c02 -O2 < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,CMOS,BITOPS
+; RUN: llc -mtriple=m6502 -mcpu=6502 -O2 < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,NMOS
+; RUN: llvm-link %s %S/Inputs/print.ll -o %t.bc
+; RUN: llc -mcpu=w65c02 -O2 -filetype=obj -m6502-image=raw \
+; RUN:   -m6502-image-symbols=%t.sym %t.bc -o %t.bin
+; RUN: llvm-m6502-sim -cpu=65c02 -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   | FileCheck %s --check-prefix=SIM
+; RUN: llc -mcpu=6502 -O2 -filetype=obj -m6502-image=raw \
+; RUN:   -m6502-image-symbols=%t.nmos.sym %t.bc -o %t.nmos.bin
+; RUN: llvm-m6502-sim -cpu=6502 -symbols %t.nmos.sym -io-putchar='$FFF0' \
+; RUN:   %t.nmos.bin | FileCheck %s --check-prefix=SIM
+
+; The 65C02 instructions are used when the processor has them, and give the
+; same results as the 6502 code.
+
+target triple = "m6502"
+
+@g = global i8 0
+@v = global i8 0
+@flags = global i8 0
+@zflags = global i8 0, section ".zp"
+
+; CHECK-LABEL: clear:
+; CMOS: stz g
+; NMOS: lda #0
+; NMOS-NEXT: sta g
+define void @clear() noinline {
+  store i8 0, i8* @g
+  ret void
+}
+
+; CHECK-LABEL: deref:
+; CMOS: lda (rc4)
+; NMOS: ldy #0
+; NMOS-NEXT: lda (rc4),y
+define i8 @deref(i8* %p) noinline {
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: incp:
+; CMOS: inc a
+; CMOS-NEXT: sta (rc4)
+; CMOS-NEXT: rts
+; NMOS: sta rs4
+; NMOS-NEXT: inc rs4
+define void @incp(i8* %p, i8 %a) noinline {
+  %r = add i8 %a, 1
+  store i8 %r, i8* %p
+  ret void
+}
+
+; CHECK-LABEL: decp:
+; CMOS: dec a
+; CMOS-NEXT: sta (rc4)
+; CMOS-NEXT: rts
+; NMOS: sta rs4
+; NMOS-NEXT: dec rs4
+define void @decp(i8* %p, i8 %a) noinline {
+  %r = add i8 %a, -1
+  store i8 %r, i8* %p
+  ret void
+}
+
+; CHECK-LABEL: setbits:
+; CMOS: lda #12
+; CMOS-NEXT: tsb flags
+; NMOS: lda flags
+; NMOS-NEXT: ora #12
+; NMOS-NEXT: sta flags
+define void @setbits() noinline {
+  %v = load i8, i8* @flags
+  %r = or i8 %v, 12
+  store i8 %r, i8* @flags
+  ret void
+}
+
+; CHECK-LABEL: clearbits:
+; CMOS: lda #12
+; CMOS-NEXT: trb flags
+; NMOS: lda flags
+; NMOS-NEXT: and #243
+; NMOS-NEXT: sta flags
+define void @clearbits() noinline {
+  %v = load i8, i8* @flags
+  %r = and i8 %v, -13
+  store i8 %r, i8* @flags
+  ret void
+}
+
+; A single bit of the zero page takes SMB or RMB where they exist.
+
+; CHECK-LABEL: setbit:
+; NOBITS: lda #64
+; NOBITS-NEXT: tsb zflags
+; BITOPS: smb6 zflags
+; NMOS: ora #64
+define void @setbit() noinline {
+  %v = load i8, i8* @zflags
+  %r = or i8 %v, 64
+  store i8 %r, i8* @zflags
+  ret void
+}
+
+; CHECK-LABEL: clearbit:
+; NOBITS: lda #64
+; NOBITS-NEXT: trb zflags
+; BITOPS: rmb6 zflags
+; NMOS: and #191
+define void @clearbit() noinline {
+  %v = load i8, i8* @zflags
+  %r = and i8 %v, -65
+  store i8 %r, i8* @zflags
+  ret void
+}
+
+; CHECK-LABEL: pick:
+; CMOS: bra .LBB
+; NMOS: jmp .LBB
+define i8 @pick(i8 %a, i8 %b) noinline {
+entry:
+  %c = icmp ult i8 %a, %b
+  br i1 %c, label %then, label %else
+then:
+  store volatile i8 1, i8* @g
+  br label %join
+else:
+  store volatile i8 2, i8* @g
+  br label %join
+join:
+  %r = phi i8 [ %a, %then ], [ %b, %else ]
+  store volatile i8 %r, i8* @g
+  %v = load volatile i8, i8* @g
+  ret i8 %v
+}
+
+define void @ext() noinline {
+  store volatile i8 0, i8* @v
+  ret void
+}
+
+; Y is saved with PHY while the callee-saved registers are spilled.
+
+; CHECK-LABEL: keep:
+; CMOS: pha
+; CMOS-NEXT: phy
+; CMOS: ply
+; CMOS-NEXT: pla
+; NMOS: pha
+; NMOS-NEXT: tya
+; NMOS-NEXT: pha
+; NMOS: pla
+; NMOS-NEXT: tay
+; NMOS-NEXT: pla
+define void @keep(i8 %a, i8 %b, i8 %c, void ()* %f) noinline {
+  call void %f()
+  store volatile i8 %c, i8* @g
+  store volatile i8 %a, i8* @g
+  ret void
+}
+
+; SIM: 00
+; SIM-NEXT: 424242
+; SIM-NEXT: FDF1C181
+; SIM-NEXT: 030811
+
+declare void @put8(i8)
+declare void @newline()
+
+define i8 @main() {
+  store volatile i8 u0x55, i8* @g
+  call void @clear()
+  %g = load volatile i8, i8* @g
+  call void @put8(i8 %g)
+  call void @newline()
+  store volatile i8 u0x42, i8* @v
+  %d = call i8 @deref(i8* @v)
+  call void @put8(i8 %d)
+  call void @incp(i8* @v, i8 u0x41)
+  %i = load volatile i8, i8* @v
+  call void @put8(i8 %i)
+  call void @decp(i8* @v, i8 u0x43)
+  %j = load volatile i8, i8* @v
+  call void @put8(i8 %j)
+  call void @newline()
+  store volatile i8 u0xF1, i8* @flags
+  call void @setbits()
+  %f1 = load volatile i8, i8* @flags
+  call void @put8(i8 %f1)
+  call void @clearbits()
+  %f2 = load volatile i8, i8* @flags
+  call void @put8(i8 %f2)
+  store volatile i8 u0x81, i8* @zflags
+  call void @setbit()
+  %z1 = load volatile i8, i8* @zflags
+  call void @put8(i8 %z1)
+  call void @clearbit()
+  %z2 = load volatile i8, i8* @zflags
+  call void @put8(i8 %z2)
+  call void @newline()
+  %p1 = call i8 @pick(i8 3, i8 9)
+  call void @put8(i8 %p1)
+  %p2 = call i8 @pick(i8 9, i8 8)
+  call void @put8(i8 %p2)
+  call void @keep(i8 u0x11, i8 u0x22, i8 u0x33, void ()* @ext)
+  %k = load volatile i8, i8* @g
+  call void @put8(i8 %k)
+  call void @newline()
+  ret i8 0
+}
@@ -0,0 +1,187 @@
+; RUN: llc -mtriple=m6502 -O2 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llvm-link %s %S/Inputs/print.ll -o %t.bc
+; RUN: llc -O2 -filetype=obj -m6502-image=raw -m6502-image-symbols=%t.sym \
+; RUN:   %t.bc -o %t.bin
+; RUN: llvm-m6502-sim -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   | FileCheck %s --check-prefix=SIM
+
+; fastcc skips A, X and Y and fills the argument block RS8-RS15 and then
+; RS4-RS7.  The C convention passes the first three bytes in A, X and Y.
+
+@g8 = global i8 0
+@g16 = global i16 0
+
+; CHECK-LABEL: fast:
+; CHECK: lda rs8
+; CHECK-NEXT: sta g8
+; CHECK-NEXT: lda rs9
+; CHECK-NEXT: sta g8
+; CHECK-NEXT: lda rs10
+; CHECK-NEXT: sta g16
+; CHECK-NEXT: lda rs11
+; CHECK-NEXT: sta g16+1
+; CHECK-NEXT: lda rs12
+; CHECK-NEXT: sta g8
+define fastcc void @fast(i8 %a, i8 %b, i16 %c, i8 %d) noinline {
+  store volatile i8 %a, i8* @g8
+  store volatile i8 %b, i8* @g8
+  store volatile i16 %c, i16* @g16
+  store volatile i8 %d, i8* @g8
+  ret void
+}
+
+; CHECK-LABEL: ccc:
+; CHECK: sta g8
+; CHECK-NEXT: txa
+; CHECK-NEXT: sta g8
+; CHECK-NEXT: lda rs8
+; CHECK-NEXT: sta g16
+; CHECK-NEXT: lda rs9
+; CHECK-NEXT: sta g16+1
+; CHECK-NEXT: tya
+; CHECK-NEXT: sta g8
+define void @ccc(i8 %a, i8 %b, i16 %c, i8 %d) noinline {
+  store volatile i8 %a, i8* @g8
+  store volatile i8 %b, i8* @g8
+  store volatile i16 %c, i16* @g16
+  store volatile i8 %d, i8* @g8
+  ret void
+}
+
+; CHECK-LABEL: caller:
+; CHECK-DAG: sta rs8
+; CHECK-DAG: sta rs9
+; CHECK-DAG: sta rs10
+; CHECK-DAG: sta rs11
+; CHECK-DAG: sta rs12
+; CHECK: jsr fast
+; CHECK-DAG: lda #1
+; CHECK-DAG: ldx #2
+; CHECK-DAG: ldy #5
+; CHECK: jsr ccc
+define void @caller() {
+  call fastcc void @fast(i8 1, i8 2, i16 772, i8 5)
+  call void @ccc(i8 1, i8 2, i16 772, i8 5)
+  ret void
+}
+
+; The bytes after RS15 go to RS4-RS7.
+
+; CHECK-LABEL: many:
+; CHECK: lda rs15
+; CHECK: lda rs4
+; CHECK: lda rs5
+define fastcc void @many(i8 %a0, i8 %a1, i8 %a2, i8 %a3, i8 %a4, i8 %a5,
+                         i8 %a6, i8 %a7, i8 %a8, i8 %a9) noinline {
+  store volatile i8 %a7, i8* @g8
+  store volatile i8 %a8, i8* @g8
+  store volatile i8 %a9, i8* @g8
+  ret void
+}
+
+; The pairs after RC7 go to RC2 and RC3.
+
+; CHECK-LABEL: wide:
+; CHECK: sta (rc2),y
+define fastcc void @wide(i16 %a0, i16 %a1, i16 %a2, i16 %a3, i16 %a4) noinline {
+  %p = inttoptr i16 %a4 to i8*
+  store volatile i8 0, i8* %p
+  ret void
+}
+
+; A fastcc function whose callers are all known gets the byte it uses as the
+; index of a global in X, and the one it uses as the index of a pointer in
+; Y.  The other arguments keep the fastcc registers.
+
+@table = global [16 x i8] c"\00\10\20\30\40\50\60\70\80\90\A0\B0\C0\D0\E0\F0"
+
+; A function which other modules may call keeps the fixed registers.
+; CHECK-LABEL: visible:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: ldx rs8
+; CHECK-NEXT: lda table,x
+define fastcc i8 @visible(i8 %i) noinline {
+  %z = zext i8 %i to i16
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* @table, i16 0, i16 %z
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: lookup:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: lda table,x
+; CHECK-NEXT: clc
+; CHECK-NEXT: adc rs8
+define internal fastcc i8 @lookup(i8 %k, i8 %i) noinline {
+  %z = zext i8 %i to i16
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* @table, i16 0, i16 %z
+  %v = load i8, i8* %p
+  %r = add i8 %v, %k
+  ret i8 %r
+}
+
+; CHECK-LABEL: both:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: lda (rc4),y
+; CHECK: lda table,x
+define internal fastcc i8 @both(i8* %q, i8 %i, i8 %j) noinline {
+  %zi = zext i8 %i to i16
+  %zj = zext i8 %j to i16
+  %p = getelementptr inbounds i8, i8* %q, i16 %zj
+  %a = load i8, i8* %p
+  %t = getelementptr inbounds [16 x i8], [16 x i8]* @table, i16 0, i16 %zi
+  %b = load i8, i8* %t
+  %r = xor i8 %a, %b
+  ret i8 %r
+}
+
+; CHECK-LABEL: poke:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: lda rs10
+; CHECK-NEXT: sta (rc4),y
+; CHECK-NEXT: rts
+define internal fastcc void @poke(i8* %q, i8 %i, i8 %v) noinline {
+  %z = zext i8 %i to i16
+  %p = getelementptr inbounds i8, i8* %q, i16 %z
+  store i8 %v, i8* %p
+  ret void
+}
+
+declare void @put8(i8)
+declare void @newline()
+
+; CHECK-LABEL: main:
+; CHECK: sta rs8
+; CHECK: tax
+; CHECK-NEXT: jsr lookup
+; CHECK: ldx #3
+; CHECK-NEXT: ldy #6
+; CHECK-NEXT: jsr both
+; CHECK: ldy #3
+; CHECK-NEXT: jsr poke
+; CHECK: jsr visible
+; CHECK: ldx rs4
+; CHECK-NEXT: ldy #4
+; CHECK-NEXT: jsr both
+
+; SIM: 51
+; SIM-NEXT: 50
+; SIM-NEXT: 51
+; SIM-NEXT: 10
+define void @main() {
+  %a = call fastcc i8 @lookup(i8 1, i8 5)
+  call void @put8(i8 %a)
+  call void @newline()
+  %b = call fastcc i8 @both(i8* getelementptr inbounds ([16 x i8], [16 x i8]* @table, i16 0, i16 0), i8 3, i8 6)
+  call void @put8(i8 %b)
+  call void @newline()
+  call fastcc void @poke(i8* getelementptr inbounds ([16 x i8], [16 x i8]* @table, i16 0, i16 0), i8 3, i8 %a)
+  %c = call fastcc i8 @visible(i8 3)
+  call void @put8(i8 %c)
+  call void @newline()
+  %c3 = lshr i8 %c, 4
+  %d = call fastcc i8 @both(i8* getelementptr inbounds ([16 x i8], [16 x i8]* @table, i16 0, i16 0), i8 %c3, i8 4)
+  call void @put8(i8 %d)
+  call void @newline()
+  ret void
+}
@@ -0,0 +1,56 @@
+; RUN: llc -mtriple=m6502 -O2 -m6502-zp-budget=0 -filetype=obj \
+; RUN:   -m6502-image=ines -m6502-image-symbols=%t.sym %s -o %t.nes
+; RUN: od -A x -t x1 -v %t.nes | FileCheck %s
+; RUN: FileCheck %s --check-prefix=SYM < %t.sym
+; RUN: llvm-m6502-sim -symbols %t.sym -entry=reset -dump=count:1 %t.nes \
+; RUN:   | FileCheck %s --check-prefix=SIM
+; RUN: sed -e 's/^@count = global i8 0/@count = global i8 5/' %s > %t.ll
+; RUN: not llc -mtriple=m6502 -O2 -m6502-zp-budget=0 -filetype=obj \
+; RUN:   -m6502-image=ines %t.ll -o %t.data.nes 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=DATA
+
+; The default memory map of an iNES image puts the code at the start of a
+; 32K PRG ROM filled with $FF, the vectors at $FFFA and the variables in the
+; RAM of the console, which is not part of the image.
+
+; The header gives two 16K PRG ROM banks, no CHR ROM and mapper 0.
+; CHECK: 000000 4e 45 53 1a 02 00 00 00 00 00 00 00 00 00 00 00
+; CHECK-NEXT: 000010 {{([0-9a-f]{2} )+}}ff
+; CHECK: 000ff0 ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff
+
+; The vectors are the last 6 bytes: NMI and IRQ go to $8000, reset to $8001.
+; CHECK: 008000 ff ff ff ff ff ff ff ff ff ff 00 80 01 80 00 80
+; CHECK-NEXT: 008010
+; CHECK-NOT: {{.}}
+
+; SYM: $0200 count
+; SYM: $8000 nmi
+; SYM: $8001 reset
+; SYM: $FFFA vectors
+
+; count is read and written in RAM.
+; SIM: 0200: 01
+
+; A variable with an initial value would be in ROM, where it could never
+; change.
+; DATA: writable section .data is initialized in ROM region prg
+
+target triple = "m6502"
+
+@count = global i8 0
+
+define void @nmi() "interrupt" {
+  ret void
+}
+
+define void @reset() {
+  %c = load volatile i8, i8* @count
+  %n = add i8 %c, 1
+  store volatile i8 %n, i8* @count
+  ret void
+}
+
+@vectors = constant [3 x i16] [i16 ptrtoint (void ()* @nmi to i16),
+                               i16 ptrtoint (void ()* @reset to i16),
+                               i16 ptrtoint (void ()* @nmi to i16)],
+                   section ".vectors"
@@ -0,0 +1,29 @@
+; RUN: llc -mtriple=m6502 -O2 -m6502-zp-budget=0 -filetype=obj \
+; RUN:   -m6502-image=prg -m6502-image-symbols=%t.sym %s -o %t.prg
+; RUN: od -A x -t x1 -v %t.prg | FileCheck %s
+; RUN: FileCheck %s --check-prefix=SYM < %t.sym
+; RUN: llvm-m6502-sim -symbols %t.sym -dump=count:1 %t.prg \
+; RUN:   | FileCheck %s --check-prefix=SIM
+
+; A C64 program is the load address, $0801, followed by the code and then the
+; data, which is in RAM and keeps what the program stores.
+
+; CHECK: 000000 01 08 ad 0e 08 {{([0-9a-f]{2} )+}}60 05
+; CHECK-NEXT: 000010
+; CHECK-NOT: {{.}}
+
+; SYM: $0801 main
+; SYM-NEXT: $080E count
+
+; SIM: {{.*}}: 06
+
+target triple = "m6502"
+
+@count = global i8 5
+
+define void @main() {
+  %c = load volatile i8, i8* @count
+  %n = add i8 %c, 1
+  store volatile i8 %n, i8* @count
+  ret void
+}
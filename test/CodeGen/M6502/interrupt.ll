@@ -0,0 +1,146 @@
+; RUN: llc -mtriple=m6502 -mcpu=6502 -O2 < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,NMOS
+; RUN: llc -mtriple=m6502 -mcpu=65c02 -O2 < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,CMOS
+; RUN: llvm-link %s %S/Inputs/print.ll -o %t.bc
+; RUN: llc -mcpu=6502 -O2 -filetype=obj -m6502-image=ines \
+; RUN:   -m6502-image-symbols=%t.sym %t.bc -o %t.nes
+; RUN: llvm-m6502-sim -cpu=6502 -entry=main -symbols %t.sym \
+; RUN:   -io-putchar='$FFF0' %t.nes | FileCheck %s --check-prefix=QUIET
+; RUN: llvm-m6502-sim -cpu=6502 -entry=main -nmi-period=1000 -symbols %t.sym \
+; RUN:   -io-putchar='$FFF0' %t.nes | FileCheck %s --check-prefix=NMI
+
+; An interrupt handler saves the CPU and zero page registers it writes,
+; including those written by the functions it calls, and returns with RTI.
+
+target triple = "m6502"
+
+@ticks = global i16 0
+@hits = global [8 x i8] zeroinitializer
+
+define void @count(i8 %i) noinline {
+  %j = and i8 %i, 7
+  %x = zext i8 %j to i16
+  %p = getelementptr [8 x i8], [8 x i8]* @hits, i16 0, i16 %x
+  %h = load volatile i8, i8* %p
+  %h1 = add i8 %h, 1
+  store volatile i8 %h1, i8* %p
+  ret void
+}
+
+; count writes X and rs5, and nmi itself A and rs4-rs7.  Y is left alone.
+; The 6502 may be interrupted in decimal mode.
+
+; CHECK-LABEL: nmi:
+; CHECK: pha
+; NMOS-NEXT: txa
+; NMOS-NEXT: pha
+; CMOS-NEXT: phx
+; CHECK-NEXT: lda rs4
+; CHECK-NEXT: pha
+; CHECK-NEXT: lda rs5
+; CHECK-NEXT: pha
+; CHECK-NEXT: lda rs6
+; CHECK-NEXT: pha
+; CHECK-NEXT: lda rs7
+; CHECK-NEXT: pha
+; NMOS-NEXT: cld
+; CMOS-NOT: cld
+; CHECK: jsr count
+; CHECK-NEXT: pla
+; CHECK-NEXT: sta rs7
+; CHECK-NEXT: pla
+; CHECK-NEXT: sta rs6
+; CHECK-NEXT: pla
+; CHECK-NEXT: sta rs5
+; CHECK-NEXT: pla
+; CHECK-NEXT: sta rs4
+; NMOS-NEXT: pla
+; NMOS-NEXT: tax
+; CMOS-NEXT: plx
+; CHECK-NEXT: pla
+; CHECK-NEXT: rti
+define void @nmi() #0 {
+  %t = load volatile i16, i16* @ticks
+  %n = add i16 %t, 1
+  store volatile i16 %n, i16* @ticks
+  %i = trunc i16 %t to i8
+  call void @count(i8 %i)
+  ret void
+}
+
+; CHECK-LABEL: irq:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: rti
+define void @irq() #0 {
+  ret void
+}
+
+; A naked handler only gets its RTI.
+
+; CHECK-LABEL: fast:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: rti
+define void @fast() #1 {
+  ret void
+}
+
+@vectors = constant [3 x i16] [i16 ptrtoint (void ()* @nmi to i16),
+                               i16 ptrtoint (i8 ()* @main to i16),
+                               i16 ptrtoint (void ()* @irq to i16)],
+                   section ".vectors"
+
+declare void @put8(i8)
+declare void @put16(i16)
+declare void @newline()
+
+; main sums 1000 words while the NMIs count in ticks and in hits, and then
+; checks that the counts agree.
+
+; QUIET: 95EC
+; QUIET-NEXT: 0001
+; NMI: 95EC
+; NMI-NEXT: 0101
+define i8 @main() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i16 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i16 [ 0, %entry ], [ %s.next, %loop ]
+  %x = xor i16 %i, u0x5A5A
+  %s.next = add i16 %s, %x
+  %i.next = add i16 %i, 1
+  %done = icmp eq i16 %i.next, 1000
+  br i1 %done, label %exit, label %loop
+
+exit:
+  call void @put16(i16 %s.next)
+  call void @newline()
+  br label %sum
+
+sum:
+  %k = phi i16 [ 0, %exit ], [ %k.next, %sum ]
+  %h = phi i8 [ 0, %exit ], [ %h.next, %sum ]
+  %p = getelementptr [8 x i8], [8 x i8]* @hits, i16 0, i16 %k
+  %v = load volatile i8, i8* %p
+  %h.next = add i8 %h, %v
+  %k.next = add i16 %k, 1
+  %end = icmp eq i16 %k.next, 8
+  br i1 %end, label %done.sum, label %sum
+
+done.sum:
+  %t = load volatile i16, i16* @ticks
+  %t8 = trunc i16 %t to i8
+  %any = icmp ne i8 %t8, 0
+  %b1 = zext i1 %any to i8
+  call void @put8(i8 %b1)
+  %same = icmp eq i8 %h.next, %t8
+  %b2 = zext i1 %same to i8
+  call void @put8(i8 %b2)
+  call void @newline()
+  ret i8 0
+}
+
+attributes #0 = { "interrupt" }
+attributes #1 = { "interrupt" naked }
@@ -0,0 +1,312 @@
+; RUN: llc -mtriple=m6502 -O2 -verify-machineinstrs < %s | FileCheck %s
+
+; A jump table holds the low bytes of the addresses of its blocks followed by
+; their high bytes, each indexed by X, and the dispatch jumps through the
+; pair they are loaded into.  The index is only checked against the size of
+; the table, and not stored anywhere else.  A table has from 8 to 256
+; entries, each part aligned to the power of two above the number of entries.
+
+target triple = "m6502"
+
+@out = global i8 0
+
+; CHECK-LABEL: eight:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: cmp #8
+; CHECK-NEXT: bcs .LBB0_10
+; CHECK-NEXT: .LBB0_1:
+; CHECK-NEXT: tax
+; CHECK-NEXT: lda .LJTI0_0+8,x
+; CHECK-NEXT: sta rs7
+; CHECK-NEXT: lda .LJTI0_0,x
+; CHECK-NEXT: sta rs6
+; CHECK-NEXT: jmp (rc3)
+; CHECK: .p2align 3
+; CHECK-NEXT: .LJTI0_0:
+; CHECK-NEXT: .byte <.LBB0_2
+; CHECK-NEXT: .byte <.LBB0_3
+; CHECK-NEXT: .byte <.LBB0_4
+; CHECK-NEXT: .byte <.LBB0_5
+; CHECK-NEXT: .byte <.LBB0_6
+; CHECK-NEXT: .byte <.LBB0_7
+; CHECK-NEXT: .byte <.LBB0_8
+; CHECK-NEXT: .byte <.LBB0_9
+; CHECK-NEXT: .p2align 3
+; CHECK-NEXT: .byte >.LBB0_2
+; CHECK-NEXT: .byte >.LBB0_3
+; CHECK-NEXT: .byte >.LBB0_4
+; CHECK-NEXT: .byte >.LBB0_5
+; CHECK-NEXT: .byte >.LBB0_6
+; CHECK-NEXT: .byte >.LBB0_7
+; CHECK-NEXT: .byte >.LBB0_8
+; CHECK-NEXT: .byte >.LBB0_9
+define void @eight(i8 %x) {
+entry:
+  switch i8 %x, label %def [
+    i8 0, label %d0 i8 1, label %d1 i8 2, label %d2 i8 3, label %d3
+    i8 4, label %d4 i8 5, label %d5 i8 6, label %d6 i8 7, label %d7
+  ]
+d0:
+  store volatile i8 0, i8* @out
+  ret void
+d1:
+  store volatile i8 1, i8* @out
+  ret void
+d2:
+  store volatile i8 2, i8* @out
+  ret void
+d3:
+  store volatile i8 3, i8* @out
+  ret void
+d4:
+  store volatile i8 4, i8* @out
+  ret void
+d5:
+  store volatile i8 5, i8* @out
+  ret void
+d6:
+  store volatile i8 6, i8* @out
+  ret void
+d7:
+  store volatile i8 7, i8* @out
+  ret void
+def:
+  ret void
+}
+
+; Seven cases are compared one by one.
+
+; CHECK-LABEL: seven:
+; CHECK-NOT: jmp (
+; CHECK-NOT: .LJTI1_0
+; CHECK: -- End function
+define void @seven(i8 %x) {
+entry:
+  switch i8 %x, label %def [
+    i8 0, label %d0 i8 1, label %d1 i8 2, label %d2 i8 3, label %d3
+    i8 4, label %d4 i8 5, label %d5 i8 6, label %d6
+  ]
+d0:
+  store volatile i8 0, i8* @out
+  ret void
+d1:
+  store volatile i8 1, i8* @out
+  ret void
+d2:
+  store volatile i8 2, i8* @out
+  ret void
+d3:
+  store volatile i8 3, i8* @out
+  ret void
+d4:
+  store volatile i8 4, i8* @out
+  ret void
+d5:
+  store volatile i8 5, i8* @out
+  ret void
+d6:
+  store volatile i8 6, i8* @out
+  ret void
+def:
+  ret void
+}
+
+; A table of 256 entries fills a page with each part.
+
+; CHECK-LABEL: full:
+; CHECK: ldx rs8
+; CHECK-NEXT: lda .LJTI2_0+256,x
+; CHECK-NEXT: sta rs5
+; CHECK-NEXT: lda .LJTI2_0,x
+; CHECK-NEXT: sta rs4
+; CHECK-NEXT: jmp (rc2)
+; CHECK: .p2align 8
+; CHECK-NEXT: .LJTI2_0:
+; CHECK-NEXT: .byte <.LBB2_2
+; CHECK-NEXT: .byte <.LBB2_7
+; CHECK: .p2align 8
+; CHECK-NEXT: .byte >.LBB2_2
+; CHECK-NEXT: .byte >.LBB2_7
+define void @full(i16 %x) {
+entry:
+  switch i16 %x, label %def [
+    i16 0, label %d0 i16 1, label %d1 i16 2, label %d2 i16 3, label %d3
+    i16 4, label %d4 i16 5, label %d0 i16 6, label %d1 i16 7, label %d2
+    i16 8, label %d3 i16 9, label %d4 i16 10, label %d0 i16 11, label %d1
+    i16 12, label %d2 i16 13, label %d3 i16 14, label %d4 i16 15, label %d0
+    i16 16, label %d1 i16 17, label %d2 i16 18, label %d3 i16 19, label %d4
+    i16 20, label %d0 i16 21, label %d1 i16 22, label %d2 i16 23, label %d3
+    i16 24, label %d4 i16 25, label %d0 i16 26, label %d1 i16 27, label %d2
+    i16 28, label %d3 i16 29, label %d4 i16 30, label %d0 i16 31, label %d1
+    i16 32, label %d2 i16 33, label %d3 i16 34, label %d4 i16 35, label %d0
+    i16 36, label %d1 i16 37, label %d2 i16 38, label %d3 i16 39, label %d4
+    i16 40, label %d0 i16 41, label %d1 i16 42, label %d2 i16 43, label %d3
+    i16 44, label %d4 i16 45, label %d0 i16 46, label %d1 i16 47, label %d2
+    i16 48, label %d3 i16 49, label %d4 i16 50, label %d0 i16 51, label %d1
+    i16 52, label %d2 i16 53, label %d3 i16 54, label %d4 i16 55, label %d0
+    i16 56, label %d1 i16 57, label %d2 i16 58, label %d3 i16 59, label %d4
+    i16 60, label %d0 i16 61, label %d1 i16 62, label %d2 i16 63, label %d3
+    i16 64, label %d4 i16 65, label %d0 i16 66, label %d1 i16 67, label %d2
+    i16 68, label %d3 i16 69, label %d4 i16 70, label %d0 i16 71, label %d1
+    i16 72, label %d2 i16 73, label %d3 i16 74, label %d4 i16 75, label %d0
+    i16 76, label %d1 i16 77, label %d2 i16 78, label %d3 i16 79, label %d4
+    i16 80, label %d0 i16 81, label %d1 i16 82, label %d2 i16 83, label %d3
+    i16 84, label %d4 i16 85, label %d0 i16 86, label %d1 i16 87, label %d2
+    i16 88, label %d3 i16 89, label %d4 i16 90, label %d0 i16 91, label %d1
+    i16 92, label %d2 i16 93, label %d3 i16 94, label %d4 i16 95, label %d0
+    i16 96, label %d1 i16 97, label %d2 i16 98, label %d3 i16 99, label %d4
+    i16 100, label %d0 i16 101, label %d1 i16 102, label %d2 i16 103, label %d3
+    i16 104, label %d4 i16 105, label %d0 i16 106, label %d1 i16 107, label %d2
+    i16 108, label %d3 i16 109, label %d4 i16 110, label %d0 i16 111, label %d1
+    i16 112, label %d2 i16 113, label %d3 i16 114, label %d4 i16 115, label %d0
+    i16 116, label %d1 i16 117, label %d2 i16 118, label %d3 i16 119, label %d4
+    i16 120, label %d0 i16 121, label %d1 i16 122, label %d2 i16 123, label %d3
+    i16 124, label %d4 i16 125, label %d0 i16 126, label %d1 i16 127, label %d2
+    i16 128, label %d3 i16 129, label %d4 i16 130, label %d0 i16 131, label %d1
+    i16 132, label %d2 i16 133, label %d3 i16 134, label %d4 i16 135, label %d0
+    i16 136, label %d1 i16 137, label %d2 i16 138, label %d3 i16 139, label %d4
+    i16 140, label %d0 i16 141, label %d1 i16 142, label %d2 i16 143, label %d3
+    i16 144, label %d4 i16 145, label %d0 i16 146, label %d1 i16 147, label %d2
+    i16 148, label %d3 i16 149, label %d4 i16 150, label %d0 i16 151, label %d1
+    i16 152, label %d2 i16 153, label %d3 i16 154, label %d4 i16 155, label %d0
+    i16 156, label %d1 i16 157, label %d2 i16 158, label %d3 i16 159, label %d4
+    i16 160, label %d0 i16 161, label %d1 i16 162, label %d2 i16 163, label %d3
+    i16 164, label %d4 i16 165, label %d0 i16 166, label %d1 i16 167, label %d2
+    i16 168, label %d3 i16 169, label %d4 i16 170, label %d0 i16 171, label %d1
+    i16 172, label %d2 i16 173, label %d3 i16 174, label %d4 i16 175, label %d0
+    i16 176, label %d1 i16 177, label %d2 i16 178, label %d3 i16 179, label %d4
+    i16 180, label %d0 i16 181, label %d1 i16 182, label %d2 i16 183, label %d3
+    i16 184, label %d4 i16 185, label %d0 i16 186, label %d1 i16 187, label %d2
+    i16 188, label %d3 i16 189, label %d4 i16 190, label %d0 i16 191, label %d1
+    i16 192, label %d2 i16 193, label %d3 i16 194, label %d4 i16 195, label %d0
+    i16 196, label %d1 i16 197, label %d2 i16 198, label %d3 i16 199, label %d4
+    i16 200, label %d0 i16 201, label %d1 i16 202, label %d2 i16 203, label %d3
+    i16 204, label %d4 i16 205, label %d0 i16 206, label %d1 i16 207, label %d2
+    i16 208, label %d3 i16 209, label %d4 i16 210, label %d0 i16 211, label %d1
+    i16 212, label %d2 i16 213, label %d3 i16 214, label %d4 i16 215, label %d0
+    i16 216, label %d1 i16 217, label %d2 i16 218, label %d3 i16 219, label %d4
+    i16 220, label %d0 i16 221, label %d1 i16 222, label %d2 i16 223, label %d3
+    i16 224, label %d4 i16 225, label %d0 i16 226, label %d1 i16 227, label %d2
+    i16 228, label %d3 i16 229, label %d4 i16 230, label %d0 i16 231, label %d1
+    i16 232, label %d2 i16 233, label %d3 i16 234, label %d4 i16 235, label %d0
+    i16 236, label %d1 i16 237, label %d2 i16 238, label %d3 i16 239, label %d4
+    i16 240, label %d0 i16 241, label %d1 i16 242, label %d2 i16 243, label %d3
+    i16 244, label %d4 i16 245, label %d0 i16 246, label %d1 i16 247, label %d2
+    i16 248, label %d3 i16 249, label %d4 i16 250, label %d0 i16 251, label %d1
+    i16 252, label %d2 i16 253, label %d3 i16 254, label %d4 i16 255, label %d0
+  ]
+d0:
+  store volatile i8 0, i8* @out
+  ret void
+d1:
+  store volatile i8 1, i8* @out
+  ret void
+d2:
+  store volatile i8 2, i8* @out
+  ret void
+d3:
+  store volatile i8 3, i8* @out
+  ret void
+d4:
+  store volatile i8 4, i8* @out
+  ret void
+def:
+  ret void
+}
+
+; A 257th case is tested apart from the table.
+
+; CHECK-LABEL: over:
+; CHECK: lda .LJTI3_0+256,x
+; CHECK: jmp (rc3)
+; CHECK-NOT: .LJTI3_1
+; CHECK: .LJTI3_0:
+; CHECK-NOT: .LJTI3_1
+; CHECK: -- End function
+define void @over(i16 %x) {
+entry:
+  switch i16 %x, label %def [
+    i16 0, label %d0 i16 1, label %d1 i16 2, label %d2 i16 3, label %d3
+    i16 4, label %d4 i16 5, label %d0 i16 6, label %d1 i16 7, label %d2
+    i16 8, label %d3 i16 9, label %d4 i16 10, label %d0 i16 11, label %d1
+    i16 12, label %d2 i16 13, label %d3 i16 14, label %d4 i16 15, label %d0
+    i16 16, label %d1 i16 17, label %d2 i16 18, label %d3 i16 19, label %d4
+    i16 20, label %d0 i16 21, label %d1 i16 22, label %d2 i16 23, label %d3
+    i16 24, label %d4 i16 25, label %d0 i16 26, label %d1 i16 27, label %d2
+    i16 28, label %d3 i16 29, label %d4 i16 30, label %d0 i16 31, label %d1
+    i16 32, label %d2 i16 33, label %d3 i16 34, label %d4 i16 35, label %d0
+    i16 36, label %d1 i16 37, label %d2 i16 38, label %d3 i16 39, label %d4
+    i16 40, label %d0 i16 41, label %d1 i16 42, label %d2 i16 43, label %d3
+    i16 44, label %d4 i16 45, label %d0 i16 46, label %d1 i16 47, label %d2
+    i16 48, label %d3 i16 49, label %d4 i16 50, label %d0 i16 51, label %d1
+    i16 52, label %d2 i16 53, label %d3 i16 54, label %d4 i16 55, label %d0
+    i16 56, label %d1 i16 57, label %d2 i16 58, label %d3 i16 59, label %d4
+    i16 60, label %d0 i16 61, label %d1 i16 62, label %d2 i16 63, label %d3
+    i16 64, label %d4 i16 65, label %d0 i16 66, label %d1 i16 67, label %d2
+    i16 68, label %d3 i16 69, label %d4 i16 70, label %d0 i16 71, label %d1
+    i16 72, label %d2 i16 73, label %d3 i16 74, label %d4 i16 75, label %d0
+    i16 76, label %d1 i16 77, label %d2 i16 78, label %d3 i16 79, label %d4
+    i16 80, label %d0 i16 81, label %d1 i16 82, label %d2 i16 83, label %d3
+    i16 84, label %d4 i16 85, label %d0 i16 86, label %d1 i16 87, label %d2
+    i16 88, label %d3 i16 89, label %d4 i16 90, label %d0 i16 91, label %d1
+    i16 92, label %d2 i16 93, label %d3 i16 94, label %d4 i16 95, label %d0
+    i16 96, label %d1 i16 97, label %d2 i16 98, label %d3 i16 99, label %d4
+    i16 100, label %d0 i16 101, label %d1 i16 102, label %d2 i16 103, label %d3
+    i16 104, label %d4 i16 105, label %d0 i16 106, label %d1 i16 107, label %d2
+    i16 108, label %d3 i16 109, label %d4 i16 110, label %d0 i16 111, label %d1
+    i16 112, label %d2 i16 113, label %d3 i16 114, label %d4 i16 115, label %d0
+    i16 116, label %d1 i16 117, label %d2 i16 118, label %d3 i16 119, label %d4
+    i16 120, label %d0 i16 121, label %d1 i16 122, label %d2 i16 123, label %d3
+    i16 124, label %d4 i16 125, label %d0 i16 126, label %d1 i16 127, label %d2
+    i16 128, label %d3 i16 129, label %d4 i16 130, label %d0 i16 131, label %d1
+    i16 132, label %d2 i16 133, label %d3 i16 134, label %d4 i16 135, label %d0
+    i16 136, label %d1 i16 137, label %d2 i16 138, label %d3 i16 139, label %d4
+    i16 140, label %d0 i16 141, label %d1 i16 142, label %d2 i16 143, label %d3
+    i16 144, label %d4 i16 145, label %d0 i16 146, label %d1 i16 147, label %d2
+    i16 148, label %d3 i16 149, label %d4 i16 150, label %d0 i16 151, label %d1
+    i16 152, label %d2 i16 153, label %d3 i16 154, label %d4 i16 155, label %d0
+    i16 156, label %d1 i16 157, label %d2 i16 158, label %d3 i16 159, label %d4
+    i16 160, label %d0 i16 161, label %d1 i16 162, label %d2 i16 163, label %d3
+    i16 164, label %d4 i16 165, label %d0 i16 166, label %d1 i16 167, label %d2
+    i16 168, label %d3 i16 169, label %d4 i16 170, label %d0 i16 171, label %d1
+    i16 172, label %d2 i16 173, label %d3 i16 174, label %d4 i16 175, label %d0
+    i16 176, label %d1 i16 177, label %d2 i16 178, label %d3 i16 179, label %d4
+    i16 180, label %d0 i16 181, label %d1 i16 182, label %d2 i16 183, label %d3
+    i16 184, label %d4 i16 185, label %d0 i16 186, label %d1 i16 187, label %d2
+    i16 188, label %d3 i16 189, label %d4 i16 190, label %d0 i16 191, label %d1
+    i16 192, label %d2 i16 193, label %d3 i16 194, label %d4 i16 195, label %d0
+    i16 196, label %d1 i16 197, label %d2 i16 198, label %d3 i16 199, label %d4
+    i16 200, label %d0 i16 201, label %d1 i16 202, label %d2 i16 203, label %d3
+    i16 204, label %d4 i16 205, label %d0 i16 206, label %d1 i16 207, label %d2
+    i16 208, label %d3 i16 209, label %d4 i16 210, label %d0 i16 211, label %d1
+    i16 212, label %d2 i16 213, label %d3 i16 214, label %d4 i16 215, label %d0
+    i16 216, label %d1 i16 217, label %d2 i16 218, label %d3 i16 219, label %d4
+    i16 220, label %d0 i16 221, label %d1 i16 222, label %d2 i16 223, label %d3
+    i16 224, label %d4 i16 225, label %d0 i16 226, label %d1 i16 227, label %d2
+    i16 228, label %d3 i16 229, label %d4 i16 230, label %d0 i16 231, label %d1
+    i16 232, label %d2 i16 233, label %d3 i16 234, label %d4 i16 235, label %d0
+    i16 236, label %d1 i16 237, label %d2 i16 238, label %d3 i16 239, label %d4
+    i16 240, label %d0 i16 241, label %d1 i16 242, label %d2 i16 243, label %d3
+    i16 244, label %d4 i16 245, label %d0 i16 246, label %d1 i16 247, label %d2
+    i16 248, label %d3 i16 249, label %d4 i16 250, label %d0 i16 251, label %d1
+    i16 252, label %d2 i16 253, label %d3 i16 254, label %d4 i16 255, label %d0
+    i16 256, label %d1
+  ]
+d0:
+  store volatile i8 0, i8* @out
+  ret void
+d1:
+  store volatile i8 1, i8* @out
+  ret void
+d2:
+  store volatile i8 2, i8* @out
+  ret void
+d3:
+  store volatile i8 3, i8* @out
+  ret void
+d4:
+  store volatile i8 4, i8* @out
+  ret void
+def:
+  ret void
+}
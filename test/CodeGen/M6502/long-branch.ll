@@ -0,0 +1,283 @@
+; RUN: llc -mtriple=m6502 -mcpu=6502 -O0 -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s --check-prefix=SWAP
+; RUN: llc -mtriple=m6502 -mcpu=6502 -O2 -enable-tail-merge=false \
+; RUN:   -verify-machineinstrs < %s | FileCheck %s --check-prefixes=CHECK,NMOS
+; RUN: llc -mtriple=m6502 -mcpu=65c02 -O2 -enable-tail-merge=false \
+; RUN:   -verify-machineinstrs < %s | FileCheck %s --check-prefixes=CHECK,CMOS
+
+; A branch can only reach 127 bytes ahead, and each function below has a
+; block of 40 stores, of 5 bytes each, between a branch and its target.
+
+target triple = "m6502"
+
+@out = global i8 0
+@in = global i8 0
+
+; At -O0 every block ends with a JMP to its false target, so the loop ends
+; with a BEQ across other and a JMP back to the loop.  The two swap.
+
+; SWAP-LABEL: swap:
+; SWAP: .LBB0_1: ; %loop
+; SWAP: lda in
+; SWAP: bne .LBB0_1
+; SWAP-NEXT: jmp .LBB0_3
+; SWAP-NEXT: .LBB0_2: ; %other
+; SWAP: .LBB0_3: ; %done
+define void @swap(i1 %x) {
+entry:
+  br i1 %x, label %loop, label %other
+loop:
+  %v = load volatile i8, i8* @in
+  %c = icmp eq i8 %v, 0
+  br i1 %c, label %done, label %loop
+other:
+  store volatile i8 0, i8* @out
+  store volatile i8 1, i8* @out
+  store volatile i8 2, i8* @out
+  store volatile i8 3, i8* @out
+  store volatile i8 4, i8* @out
+  store volatile i8 5, i8* @out
+  store volatile i8 6, i8* @out
+  store volatile i8 7, i8* @out
+  store volatile i8 8, i8* @out
+  store volatile i8 9, i8* @out
+  store volatile i8 10, i8* @out
+  store volatile i8 11, i8* @out
+  store volatile i8 12, i8* @out
+  store volatile i8 13, i8* @out
+  store volatile i8 14, i8* @out
+  store volatile i8 15, i8* @out
+  store volatile i8 16, i8* @out
+  store volatile i8 17, i8* @out
+  store volatile i8 18, i8* @out
+  store volatile i8 19, i8* @out
+  store volatile i8 20, i8* @out
+  store volatile i8 21, i8* @out
+  store volatile i8 22, i8* @out
+  store volatile i8 23, i8* @out
+  store volatile i8 24, i8* @out
+  store volatile i8 25, i8* @out
+  store volatile i8 26, i8* @out
+  store volatile i8 27, i8* @out
+  store volatile i8 28, i8* @out
+  store volatile i8 29, i8* @out
+  store volatile i8 30, i8* @out
+  store volatile i8 31, i8* @out
+  store volatile i8 32, i8* @out
+  store volatile i8 33, i8* @out
+  store volatile i8 34, i8* @out
+  store volatile i8 35, i8* @out
+  store volatile i8 36, i8* @out
+  store volatile i8 37, i8* @out
+  store volatile i8 38, i8* @out
+  store volatile i8 39, i8* @out
+  ret void
+done:
+  store volatile i8 1, i8* @out
+  ret void
+}
+
+; rare is laid out last, after big, and only entry branches to it, so it
+; moves up to follow small, which does not fall through.
+
+; CHECK-LABEL: move:
+; CHECK: beq .LBB1_3
+; CHECK: bne .LBB1_4
+; CHECK-NEXT: ; BB#2: ; %small
+; CHECK: rts
+; CHECK-NEXT: .LBB1_3: ; %rare
+; CHECK: rts
+; CHECK-NEXT: .LBB1_4: ; %big
+define void @move(i8 %x) {
+entry:
+  %c = icmp eq i8 %x, 0
+  br i1 %c, label %rare, label %next, !prof !0
+next:
+  %d = icmp eq i8 %x, 1
+  br i1 %d, label %small, label %big, !prof !1
+small:
+  store volatile i8 2, i8* @out
+  ret void
+big:
+  store volatile i8 50, i8* @out
+  store volatile i8 51, i8* @out
+  store volatile i8 52, i8* @out
+  store volatile i8 53, i8* @out
+  store volatile i8 54, i8* @out
+  store volatile i8 55, i8* @out
+  store volatile i8 56, i8* @out
+  store volatile i8 57, i8* @out
+  store volatile i8 58, i8* @out
+  store volatile i8 59, i8* @out
+  store volatile i8 60, i8* @out
+  store volatile i8 61, i8* @out
+  store volatile i8 62, i8* @out
+  store volatile i8 63, i8* @out
+  store volatile i8 64, i8* @out
+  store volatile i8 65, i8* @out
+  store volatile i8 66, i8* @out
+  store volatile i8 67, i8* @out
+  store volatile i8 68, i8* @out
+  store volatile i8 69, i8* @out
+  store volatile i8 70, i8* @out
+  store volatile i8 71, i8* @out
+  store volatile i8 72, i8* @out
+  store volatile i8 73, i8* @out
+  store volatile i8 74, i8* @out
+  store volatile i8 75, i8* @out
+  store volatile i8 76, i8* @out
+  store volatile i8 77, i8* @out
+  store volatile i8 78, i8* @out
+  store volatile i8 79, i8* @out
+  store volatile i8 80, i8* @out
+  store volatile i8 81, i8* @out
+  store volatile i8 82, i8* @out
+  store volatile i8 83, i8* @out
+  store volatile i8 84, i8* @out
+  store volatile i8 85, i8* @out
+  store volatile i8 86, i8* @out
+  store volatile i8 87, i8* @out
+  store volatile i8 88, i8* @out
+  store volatile i8 89, i8* @out
+  ret void
+rare:
+  store volatile i8 3, i8* @out
+  ret void
+}
+
+; exit is also reached from body, so the branch to it is inverted to skip a
+; JMP, which stays a JMP on the 65C02.
+
+; CHECK-LABEL: invert:
+; CHECK: cmp #0
+; CHECK-NEXT: bne .LBB2_1
+; CHECK-NEXT: jmp .LBB2_2
+; CHECK-NEXT: .LBB2_1: ; %body
+; CHECK: .LBB2_2: ; %exit
+define void @invert(i8 %x) {
+entry:
+  %c = icmp eq i8 %x, 0
+  br i1 %c, label %exit, label %body
+body:
+  store volatile i8 100, i8* @out
+  store volatile i8 101, i8* @out
+  store volatile i8 102, i8* @out
+  store volatile i8 103, i8* @out
+  store volatile i8 104, i8* @out
+  store volatile i8 105, i8* @out
+  store volatile i8 106, i8* @out
+  store volatile i8 107, i8* @out
+  store volatile i8 108, i8* @out
+  store volatile i8 109, i8* @out
+  store volatile i8 110, i8* @out
+  store volatile i8 111, i8* @out
+  store volatile i8 112, i8* @out
+  store volatile i8 113, i8* @out
+  store volatile i8 114, i8* @out
+  store volatile i8 115, i8* @out
+  store volatile i8 116, i8* @out
+  store volatile i8 117, i8* @out
+  store volatile i8 118, i8* @out
+  store volatile i8 119, i8* @out
+  store volatile i8 120, i8* @out
+  store volatile i8 121, i8* @out
+  store volatile i8 122, i8* @out
+  store volatile i8 123, i8* @out
+  store volatile i8 124, i8* @out
+  store volatile i8 125, i8* @out
+  store volatile i8 126, i8* @out
+  store volatile i8 127, i8* @out
+  store volatile i8 128, i8* @out
+  store volatile i8 129, i8* @out
+  store volatile i8 130, i8* @out
+  store volatile i8 131, i8* @out
+  store volatile i8 132, i8* @out
+  store volatile i8 133, i8* @out
+  store volatile i8 134, i8* @out
+  store volatile i8 135, i8* @out
+  store volatile i8 136, i8* @out
+  store volatile i8 137, i8* @out
+  store volatile i8 138, i8* @out
+  store volatile i8 139, i8* @out
+  br label %exit
+exit:
+  store volatile i8 4, i8* @out
+  ret void
+}
+
+; On the 65C02 a JMP in range becomes a BRA, but not one across e.
+
+; CHECK-LABEL: jumps:
+; CHECK: ; BB#1: ; %b
+; CHECK: sta out
+; NMOS-NEXT: jmp .LBB3_3
+; CMOS-NEXT: bra .LBB3_3
+; CHECK: ; BB#4: ; %near
+; CHECK: sta out
+; CHECK-NEXT: jmp .LBB3_6
+; CHECK-NEXT: .LBB3_5: ; %e
+define void @jumps(i8 %x) {
+entry:
+  %c = icmp eq i8 %x, 0
+  br i1 %c, label %a, label %b
+a:
+  store volatile i8 5, i8* @out
+  br label %join
+b:
+  store volatile i8 6, i8* @out
+  br label %join
+join:
+  %d = icmp eq i8 %x, 1
+  br i1 %d, label %near, label %e
+near:
+  store volatile i8 7, i8* @out
+  br label %end
+e:
+  store volatile i8 150, i8* @out
+  store volatile i8 151, i8* @out
+  store volatile i8 152, i8* @out
+  store volatile i8 153, i8* @out
+  store volatile i8 154, i8* @out
+  store volatile i8 155, i8* @out
+  store volatile i8 156, i8* @out
+  store volatile i8 157, i8* @out
+  store volatile i8 158, i8* @out
+  store volatile i8 159, i8* @out
+  store volatile i8 160, i8* @out
+  store volatile i8 161, i8* @out
+  store volatile i8 162, i8* @out
+  store volatile i8 163, i8* @out
+  store volatile i8 164, i8* @out
+  store volatile i8 165, i8* @out
+  store volatile i8 166, i8* @out
+  store volatile i8 167, i8* @out
+  store volatile i8 168, i8* @out
+  store volatile i8 169, i8* @out
+  store volatile i8 170, i8* @out
+  store volatile i8 171, i8* @out
+  store volatile i8 172, i8* @out
+  store volatile i8 173, i8* @out
+  store volatile i8 174, i8* @out
+  store volatile i8 175, i8* @out
+  store volatile i8 176, i8* @out
+  store volatile i8 177, i8* @out
+  store volatile i8 178, i8* @out
+  store volatile i8 179, i8* @out
+  store volatile i8 180, i8* @out
+  store volatile i8 181, i8* @out
+  store volatile i8 182, i8* @out
+  store volatile i8 183, i8* @out
+  store volatile i8 184, i8* @out
+  store volatile i8 185, i8* @out
+  store volatile i8 186, i8* @out
+  store volatile i8 187, i8* @out
+  store volatile i8 188, i8* @out
+  store volatile i8 189, i8* @out
+  br label %end
+end:
+  store volatile i8 8, i8* @out
+  ret void
+}
+
+!0 = !{!"branch_weights", i32 1, i32 1000}
+!1 = !{!"branch_weights", i32 1000, i32 10}
@@ -0,0 +1,87 @@
+; RUN: llc -mtriple=m6502 -O2 -verify-machineinstrs < %s | FileCheck %s
+
+; The counter of a loop which only indexes with it stays in X.
+
+@a = global [100 x i8] zeroinitializer
+@b = global [100 x i8] zeroinitializer
+
+; CHECK-LABEL: add:
+; CHECK: lda #99
+; CHECK-NEXT: tax
+; CHECK-NEXT: .LBB0_1:
+; CHECK-NOT: ldx
+; CHECK-NOT: rs4
+; CHECK: sta a,x
+; CHECK-NEXT: dex
+; CHECK-NEXT: bne .LBB0_1
+define void @add() {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i8 [ 99, %entry ], [ %n.next, %loop ]
+  %i = zext i8 %n to i16
+  %pa = getelementptr [100 x i8], [100 x i8]* @a, i16 0, i16 %i
+  %pb = getelementptr [100 x i8], [100 x i8]* @b, i16 0, i16 %i
+  %va = load i8, i8* %pa
+  %vb = load i8, i8* %pb
+  %s = add i8 %va, %vb
+  store i8 %s, i8* %pa
+  %n.next = add i8 %n, -1
+  %c = icmp eq i8 %n.next, 0
+  br i1 %c, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; A loop indexing with both X and Y counts down with both.
+
+; CHECK-LABEL: copy:
+; CHECK: tax
+; CHECK-NEXT: tay
+; CHECK: lda (rc4),y
+; CHECK-NEXT: sta a,x
+; CHECK-NEXT: dex
+; CHECK-NEXT: dey
+; CHECK-NEXT: bne
+define void @copy(i8* %p) {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i8 [ 99, %entry ], [ %n.next, %loop ]
+  %i = zext i8 %n to i16
+  %pa = getelementptr [100 x i8], [100 x i8]* @a, i16 0, i16 %i
+  %pp = getelementptr i8, i8* %p, i16 %i
+  %v = load i8, i8* %pp
+  store i8 %v, i8* %pa
+  %n.next = add i8 %n, -1
+  %c = icmp eq i8 %n.next, 0
+  br i1 %c, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; The counter is added to the sum, so it stays in the zero page.
+
+; CHECK-LABEL: sum:
+; CHECK: adc rs4
+; CHECK: dec rs4
+; CHECK-NEXT: bne
+define i8 @sum() {
+entry:
+  br label %loop
+
+loop:
+  %n = phi i8 [ 99, %entry ], [ %n.next, %loop ]
+  %s = phi i8 [ 0, %entry ], [ %s.next, %loop ]
+  %s.next = add i8 %s, %n
+  %n.next = add i8 %n, -1
+  %c = icmp eq i8 %n.next, 0
+  br i1 %c, label %exit, label %loop
+
+exit:
+  ret i8 %s.next
+}
@@ -0,0 +1,136 @@
+; RUN: llc -mtriple=m6502 -O2 -m6502-zp-budget=0 -show-mc-encoding < %s \
+; RUN:   | FileCheck %s
+; RUN: llc -mtriple=m6502 -O2 -m6502-zp-budget=0 -filetype=obj < %s -o %t.o
+; RUN: llvm-readobj -r -s -sd %t.o | FileCheck %s --check-prefix=OBJ
+; RUN: not llc -mtriple=m6502 -O2 -m6502-zp-budget=0 -skip-m6502-long-branch \
+; RUN:   -filetype=obj < %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=RANGE
+
+; The fixups of each kind, and the zero page form an absolute address gets
+; in the object when its symbol is known to be in the zero page.
+
+target triple = "m6502"
+
+@zpvar = global i8 0, section ".zp"
+@other = global i8 0, section ".zp.other"
+@absvar = global i8 0
+@ext = external global i8
+@ptr = global i8* null
+
+; The instruction selector only uses the zero page form for the sections it
+; places there itself, so other is accessed as an absolute address.
+
+; CHECK-LABEL: fixups:
+; CHECK: lda #<absvar ; encoding: [0xa9,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: <absvar, kind: fixup_M6502_LO8
+; CHECK: lda #>absvar ; encoding: [0xa9,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: >absvar, kind: fixup_M6502_HI8
+; CHECK: lda zpvar ; encoding: [0xa5,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: zpvar, kind: fixup_M6502_ZP8
+; CHECK: sta ptr ; encoding: [0x8d,A,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: ptr, kind: fixup_M6502_ABS16
+; CHECK: sta ptr+1 ; encoding: [0x8d,A,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: ptr+1, kind: fixup_M6502_ABS16
+; CHECK: sta absvar ; encoding: [0x8d,A,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: absvar, kind: fixup_M6502_ABS16
+; CHECK: lda ext ; encoding: [0xad,A,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: ext, kind: fixup_M6502_ABS16
+; CHECK: sta zpvar ; encoding: [0x85,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: zpvar, kind: fixup_M6502_ZP8
+; CHECK: lda other ; encoding: [0xad,A,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: other, kind: fixup_M6502_ABS16
+; CHECK: beq .LBB0_2 ; encoding: [0xf0,A]
+; CHECK-NEXT: ; fixup A - offset: 1, value: .LBB0_2-1, kind: fixup_M6502_PCREL8
+; CHECK: .LBB0_2: ; %done
+; CHECK-NEXT: rts ; encoding: [0x60]
+
+; In the object other is relaxed down to "lda other" in two bytes with a
+; zero page relocation, while absvar, ptr and ext keep three.  The BEQ at
+; $22 is resolved to the RTS at $29.
+
+; OBJ: Name: .text
+; OBJ: SectionData (
+; OBJ-NEXT: 0000: A9008584 A9008585 A5008586 A5848D00
+; OBJ-NEXT: 0010: 00A5858D 0000A586 8D0000AD 00008500
+; OBJ-NEXT: 0020: A500F005 A9018D00 0060
+; OBJ: Relocations [
+; OBJ-NEXT: Section ({{[0-9]+}}) .rela.text
+; OBJ-NEXT: 0x1 R_M6502_LO8 absvar 0x0
+; OBJ-NEXT: 0x5 R_M6502_HI8 absvar 0x0
+; OBJ-NEXT: 0x9 R_M6502_ZP8 zpvar 0x0
+; OBJ-NEXT: 0xF R_M6502_ABS16 ptr 0x0
+; OBJ-NEXT: 0x14 R_M6502_ABS16 ptr 0x1
+; OBJ-NEXT: 0x19 R_M6502_ABS16 absvar 0x0
+; OBJ-NEXT: 0x1C R_M6502_ABS16 ext 0x0
+; OBJ-NEXT: 0x1F R_M6502_ZP8 zpvar 0x0
+; OBJ-NEXT: 0x21 R_M6502_ZP8 other 0x0
+; OBJ-NEXT: 0x27 R_M6502_ABS16 absvar 0x0
+define void @fixups() {
+entry:
+  %a = load volatile i8, i8* @zpvar
+  store volatile i8* @absvar, i8** @ptr
+  store volatile i8 %a, i8* @absvar
+  %b = load volatile i8, i8* @ext
+  store volatile i8 %b, i8* @zpvar
+  %o = load volatile i8, i8* @other
+  %c = icmp eq i8 %o, 0
+  br i1 %c, label %done, label %more
+more:
+  store volatile i8 1, i8* @absvar
+  br label %done
+done:
+  ret void
+}
+
+; Without the long branch pass the BEQ over 40 stores of 5 bytes each is out
+; of range, which the assembler reports instead of wrapping the offset.
+
+; RANGE: LLVM ERROR: out of range branch fixup
+define void @far(i8 %x) {
+entry:
+  %c = icmp eq i8 %x, 0
+  br i1 %c, label %done, label %more
+more:
+  store volatile i8 0, i8* @absvar
+  store volatile i8 1, i8* @absvar
+  store volatile i8 2, i8* @absvar
+  store volatile i8 3, i8* @absvar
+  store volatile i8 4, i8* @absvar
+  store volatile i8 5, i8* @absvar
+  store volatile i8 6, i8* @absvar
+  store volatile i8 7, i8* @absvar
+  store volatile i8 8, i8* @absvar
+  store volatile i8 9, i8* @absvar
+  store volatile i8 10, i8* @absvar
+  store volatile i8 11, i8* @absvar
+  store volatile i8 12, i8* @absvar
+  store volatile i8 13, i8* @absvar
+  store volatile i8 14, i8* @absvar
+  store volatile i8 15, i8* @absvar
+  store volatile i8 16, i8* @absvar
+  store volatile i8 17, i8* @absvar
+  store volatile i8 18, i8* @absvar
+  store volatile i8 19, i8* @absvar
+  store volatile i8 20, i8* @absvar
+  store volatile i8 21, i8* @absvar
+  store volatile i8 22, i8* @absvar
+  store volatile i8 23, i8* @absvar
+  store volatile i8 24, i8* @absvar
+  store volatile i8 25, i8* @absvar
+  store volatile i8 26, i8* @absvar
+  store volatile i8 27, i8* @absvar
+  store volatile i8 28, i8* @absvar
+  store volatile i8 29, i8* @absvar
+  store volatile i8 30, i8* @absvar
+  store volatile i8 31, i8* @absvar
+  store volatile i8 32, i8* @absvar
+  store volatile i8 33, i8* @absvar
+  store volatile i8 34, i8* @absvar
+  store volatile i8 35, i8* @absvar
+  store volatile i8 36, i8* @absvar
+  store volatile i8 37, i8* @absvar
+  store volatile i8 38, i8* @absvar
+  store volatile i8 39, i8* @absvar
+  br label %done
+done:
+  ret void
+}
@@ -0,0 +1,219 @@
+; RUN: llc -mtriple=m6502 -O2 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llvm-link %s %S/Inputs/print.ll -o %t.bc
+; RUN: llc -O2 -filetype=obj -m6502-image=raw -m6502-image-symbols=%t.sym \
+; RUN:   %t.bc -o %t.bin
+; RUN: llvm-m6502-sim -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   | FileCheck %s --check-prefix=SIM
+
+; memcpy and memset of a known size are expanded inline by the MEMCPY and
+; MEMSET pseudos: byte by byte up to 8 bytes (2 when optimizing for size),
+; whole pages by a loop counting an index up until it wraps, and the rest
+; by a loop counting down to 0.  Constant addresses are indexed by X, and
+; pointers by Y.
+
+target triple = "m6502"
+
+@src = global [1100 x i8] zeroinitializer
+@dst = global [1100 x i8] zeroinitializer
+
+declare void @llvm.memcpy.p0i8.p0i8.i16(i8*, i8*, i16, i32, i1)
+declare void @llvm.memset.p0i8.i16(i8*, i8, i16, i32, i1)
+
+; CHECK-LABEL: copy8_abs:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: lda src
+; CHECK-NEXT: sta dst
+; CHECK-NEXT: lda src+1
+; CHECK-NEXT: sta dst+1
+; CHECK: lda src+7
+; CHECK-NEXT: sta dst+7
+; CHECK-NEXT: rts
+define void @copy8_abs() noinline {
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* getelementptr inbounds ([1100 x i8], [1100 x i8]* @dst, i16 0, i16 0), i8* getelementptr inbounds ([1100 x i8], [1100 x i8]* @src, i16 0, i16 0), i16 8, i32 1, i1 false)
+  ret void
+}
+
+; CHECK-LABEL: copy9_abs:
+; CHECK-NOT: src+8
+; CHECK: lda src-1,x
+; CHECK-NEXT: sta dst-1,x
+; CHECK-NEXT: dex
+; CHECK-NEXT: bne
+define void @copy9_abs() noinline {
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* getelementptr inbounds ([1100 x i8], [1100 x i8]* @dst, i16 0, i16 0), i8* getelementptr inbounds ([1100 x i8], [1100 x i8]* @src, i16 0, i16 0), i16 9, i32 1, i1 false)
+  ret void
+}
+
+; CHECK-LABEL: set3_ptr:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: ldy #0
+; CHECK-NEXT: sta (rc4),y
+; CHECK-NEXT: ldy #1
+; CHECK-NEXT: sta (rc4),y
+; CHECK-NEXT: ldy #2
+; CHECK-NEXT: sta (rc4),y
+; CHECK-NEXT: rts
+define void @set3_ptr(i8* %d, i8 %v) noinline {
+  call void @llvm.memset.p0i8.i16(i8* %d, i8 %v, i16 3, i32 1, i1 false)
+  ret void
+}
+
+; CHECK-LABEL: copy2_optsize:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: ldy #0
+; CHECK-NEXT: lda (rc5),y
+; CHECK-NEXT: sta (rc4),y
+; CHECK-NEXT: ldy #1
+; CHECK-NEXT: lda (rc5),y
+; CHECK-NEXT: sta (rc4),y
+; CHECK-NEXT: rts
+define void @copy2_optsize(i8* %d, i8* %s) noinline optsize {
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* %d, i8* %s, i16 2, i32 1, i1 false)
+  ret void
+}
+
+; Three bytes are a loop when optimizing for size, through pointers to the
+; byte before each block.
+; CHECK-LABEL: copy3_optsize:
+; CHECK: sbc #1
+; CHECK: sbc #1
+; CHECK: lda #3
+; CHECK: [[LOOP:.LBB[0-9]+_[0-9]+]]:
+; CHECK: lda (rc{{[0-9]+}}),y
+; CHECK-NEXT: sta (rc{{[0-9]+}}),y
+; CHECK-NEXT: dey
+; CHECK-NEXT: bne [[LOOP]]
+; CHECK-NEXT: ; BB#
+; CHECK-NEXT: rts
+define void @copy3_optsize(i8* %d, i8* %s) noinline optsize {
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* %d, i8* %s, i16 3, i32 1, i1 false)
+  ret void
+}
+
+; A page and the rest of a constant address.  The page loop counts up from
+; 0 until the index wraps, and the rest loop counts down from 44.
+; CHECK-LABEL: set300_abs:
+; CHECK: [[PAGE:.LBB[0-9]+_[0-9]+]]:
+; CHECK: sta dst,x
+; CHECK: inc
+; CHECK-NEXT: bne [[PAGE]]
+; CHECK: [[REST:.LBB[0-9]+_[0-9]+]]:
+; CHECK: sta dst+255,x
+; CHECK: dec
+; CHECK-NEXT: bne [[REST]]
+define void @set300_abs(i8 %v) noinline {
+  call void @llvm.memset.p0i8.i16(i8* getelementptr inbounds ([1100 x i8], [1100 x i8]* @dst, i16 0, i16 0), i8 %v, i16 300, i32 1, i1 false)
+  ret void
+}
+
+; Up to four pages of a constant address share one loop.
+; CHECK-LABEL: set1024_abs:
+; CHECK: [[PAGE:.LBB[0-9]+_[0-9]+]]:
+; CHECK: sta dst,x
+; CHECK-NEXT: sta dst+256,x
+; CHECK-NEXT: sta dst+512,x
+; CHECK-NEXT: sta dst+768,x
+; CHECK: bne [[PAGE]]
+; CHECK-NOT: dst
+; CHECK: rts
+define void @set1024_abs(i8 %v) noinline {
+  call void @llvm.memset.p0i8.i16(i8* getelementptr inbounds ([1100 x i8], [1100 x i8]* @dst, i16 0, i16 0), i8 %v, i16 1024, i32 1, i1 false)
+  ret void
+}
+
+; Pages through pointers are copied with (zp),Y by an inner loop, and an
+; outer loop moves the pointers to the next page.
+; CHECK-LABEL: copy600_ptr:
+; CHECK: [[OUTER:.LBB[0-9]+_[0-9]+]]:
+; CHECK: [[INNER:.LBB[0-9]+_[0-9]+]]:
+; CHECK: ldy
+; CHECK-NEXT: lda (rc5),y
+; CHECK-NEXT: sta (rc4),y
+; CHECK: bne [[INNER]]
+; CHECK: adc #1
+; CHECK: adc #1
+; CHECK: dec
+; CHECK-NEXT: bne [[OUTER]]
+; CHECK: [[REST:.LBB[0-9]+_[0-9]+]]:
+; CHECK: lda (rc{{[0-9]+}}),y
+; CHECK-NEXT: sta (rc{{[0-9]+}}),y
+; CHECK: bne [[REST]]
+define void @copy600_ptr(i8* %d, i8* %s) noinline {
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* %d, i8* %s, i16 600, i32 1, i1 false)
+  ret void
+}
+
+declare void @put16(i16)
+declare void @newline()
+
+; Hash n bytes from p, rotating the hash left by one bit before adding each.
+define i16 @hash(i8* %p, i16 %n) noinline {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i16 [ 0, %entry ], [ %i.next, %loop ]
+  %h = phi i16 [ 0, %entry ], [ %h.next, %loop ]
+  %q = getelementptr inbounds i8, i8* %p, i16 %i
+  %b = load i8, i8* %q
+  %b16 = zext i8 %b to i16
+  %hl = shl i16 %h, 1
+  %hr = lshr i16 %h, 15
+  %rot = or i16 %hl, %hr
+  %h.next = add i16 %rot, %b16
+  %i.next = add i16 %i, 1
+  %more = icmp ult i16 %i.next, %n
+  br i1 %more, label %loop, label %done
+
+done:
+  ret i16 %h.next
+}
+
+define void @print_dst() noinline {
+  %h = call i16 @hash(i8* getelementptr inbounds ([1100 x i8], [1100 x i8]* @dst, i16 0, i16 0), i16 1100)
+  call void @put16(i16 %h)
+  call void @newline()
+  ret void
+}
+
+; src[i] = 3 * i + 1, and then each expansion writes a part of dst.
+; SIM: 7B99
+; SIM-NEXT: 05FF
+; SIM-NEXT: AF74
+; SIM-NEXT: F41C
+define void @main() {
+entry:
+  br label %init
+
+init:
+  %i = phi i16 [ 0, %entry ], [ %i.next, %init ]
+  %v = phi i8 [ 1, %entry ], [ %v.next, %init ]
+  %p = getelementptr inbounds [1100 x i8], [1100 x i8]* @src, i16 0, i16 %i
+  store i8 %v, i8* %p
+  %v.next = add i8 %v, 3
+  %i.next = add i16 %i, 1
+  %more = icmp ult i16 %i.next, 1100
+  br i1 %more, label %init, label %run
+
+run:
+  %d5 = getelementptr inbounds [1100 x i8], [1100 x i8]* @dst, i16 0, i16 5
+  %s7 = getelementptr inbounds [1100 x i8], [1100 x i8]* @src, i16 0, i16 7
+  call void @copy600_ptr(i8* %d5, i8* %s7)
+  call void @print_dst()
+  call void @set1024_abs(i8 17)
+  call void @print_dst()
+  call void @set300_abs(i8 165)
+  call void @print_dst()
+  call void @copy9_abs()
+  call void @copy8_abs()
+  %d20 = getelementptr inbounds [1100 x i8], [1100 x i8]* @dst, i16 0, i16 20
+  call void @set3_ptr(i8* %d20, i8 60)
+  %d30 = getelementptr inbounds [1100 x i8], [1100 x i8]* @dst, i16 0, i16 30
+  %s100 = getelementptr inbounds [1100 x i8], [1100 x i8]* @src, i16 0, i16 100
+  call void @copy3_optsize(i8* %d30, i8* %s100)
+  %d40 = getelementptr inbounds [1100 x i8], [1100 x i8]* @dst, i16 0, i16 40
+  %s200 = getelementptr inbounds [1100 x i8], [1100 x i8]* @src, i16 0, i16 200
+  call void @copy2_optsize(i8* %d40, i8* %s200)
+  call void @print_dst()
+  ret void
+}
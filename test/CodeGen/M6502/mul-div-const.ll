@@ -0,0 +1,184 @@
+; RUN: llc -mtriple=m6502 -O2 < %s | FileCheck %s
+; RUN: llvm-link %s %S/Inputs/print.ll -o %t.bc
+; RUN: llc -O2 -filetype=obj -m6502-image=raw -m6502-image-symbols=%t.sym \
+; RUN:   %t.bc -o %t.bin
+; RUN: llvm-m6502-sim -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   | FileCheck %s --check-prefix=SIM
+
+; Multiplies by a constant become shifts and adds, and divides of bytes by a
+; constant a multiply by a reciprocal, so none of them calls the runtime
+; library.
+
+target triple = "m6502"
+
+; CHECK-LABEL: mul10:
+; CHECK: sta rs4
+; CHECK-NEXT: asl a
+; CHECK-NEXT: asl a
+; CHECK-NEXT: clc
+; CHECK-NEXT: adc rs4
+; CHECK-NEXT: asl a
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: rts
+define i8 @mul10(i8 %a) noinline {
+  %r = mul i8 %a, 10
+  ret i8 %r
+}
+
+; CHECK-LABEL: mul40_16:
+; CHECK-NOT: jsr
+; CHECK: rts
+define i16 @mul40_16(i16 %a) noinline {
+  %r = mul i16 %a, 40
+  ret i16 %r
+}
+
+; CHECK-LABEL: udiv3:
+; CHECK-NOT: jsr
+; CHECK: rts
+define i8 @udiv3(i8 %a) noinline {
+  %r = udiv i8 %a, 3
+  ret i8 %r
+}
+
+; The reciprocal of 7 needs nine bits.
+
+; CHECK-LABEL: udiv7:
+; CHECK-NOT: jsr
+; CHECK: rts
+define i8 @udiv7(i8 %a) noinline {
+  %r = udiv i8 %a, 7
+  ret i8 %r
+}
+
+; CHECK-LABEL: udiv8:
+; CHECK: lsr a
+; CHECK-NEXT: lsr a
+; CHECK-NEXT: lsr a
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: rts
+define i8 @udiv8(i8 %a) noinline {
+  %r = udiv i8 %a, 8
+  ret i8 %r
+}
+
+; CHECK-LABEL: sdiv4:
+; CHECK-NOT: jsr
+; CHECK: rts
+define i8 @sdiv4(i8 %a) noinline {
+  %r = sdiv i8 %a, 4
+  ret i8 %r
+}
+
+; CHECK-LABEL: urem10:
+; CHECK-NOT: jsr
+; CHECK: rts
+define i8 @urem10(i8 %a) noinline {
+  %r = urem i8 %a, 10
+  ret i8 %r
+}
+
+; main compares every byte against repeated addition and subtraction and
+; prints the number of differences.
+
+; SIM: 00
+; SIM-NEXT: C0D0
+declare void @put8(i8)
+declare void @put16(i16)
+declare void @newline()
+
+; Reference results by repeated addition and subtraction.
+
+define i8 @refmul(i8 %a, i8 %b) noinline {
+entry:
+  br label %loop
+loop:
+  %n = phi i8 [ %b, %entry ], [ %n.next, %body ]
+  %s = phi i8 [ 0, %entry ], [ %s.next, %body ]
+  %done = icmp eq i8 %n, 0
+  br i1 %done, label %exit, label %body
+body:
+  %s.next = add i8 %s, %a
+  %n.next = add i8 %n, -1
+  br label %loop
+exit:
+  ret i8 %s
+}
+
+@rem = global i8 0
+
+define i8 @refudiv(i8 %a, i8 %d) noinline {
+entry:
+  br label %loop
+loop:
+  %r = phi i8 [ %a, %entry ], [ %r.next, %body ]
+  %q = phi i8 [ 0, %entry ], [ %q.next, %body ]
+  %lt = icmp ult i8 %r, %d
+  br i1 %lt, label %exit, label %body
+body:
+  %r.next = sub i8 %r, %d
+  %q.next = add i8 %q, 1
+  br label %loop
+exit:
+  store i8 %r, i8* @rem
+  ret i8 %q
+}
+
+define i8 @refsdiv(i8 %a, i8 %d) noinline {
+  %neg = icmp slt i8 %a, 0
+  %na = sub i8 0, %a
+  %abs = select i1 %neg, i8 %na, i8 %a
+  %q = call i8 @refudiv(i8 %abs, i8 %d)
+  %nq = sub i8 0, %q
+  %r = select i1 %neg, i8 %nq, i8 %q
+  ret i8 %r
+}
+
+define i8 @main() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i8 [ 0, %entry ], [ %i.next, %next ]
+  %e = phi i8 [ 0, %entry ], [ %e5, %next ]
+  %m = call i8 @mul10(i8 %i)
+  %rm = call i8 @refmul(i8 %i, i8 10)
+  %c1 = icmp ne i8 %m, %rm
+  %z1 = zext i1 %c1 to i8
+  %e1 = add i8 %e, %z1
+  %d3 = call i8 @udiv3(i8 %i)
+  %rd3 = call i8 @refudiv(i8 %i, i8 3)
+  %c2 = icmp ne i8 %d3, %rd3
+  %z2 = zext i1 %c2 to i8
+  %e2 = add i8 %e1, %z2
+  %d7 = call i8 @udiv7(i8 %i)
+  %rd7 = call i8 @refudiv(i8 %i, i8 7)
+  %c3 = icmp ne i8 %d7, %rd7
+  %z3 = zext i1 %c3 to i8
+  %e3 = add i8 %e2, %z3
+  %r10 = call i8 @urem10(i8 %i)
+  %q10 = call i8 @refudiv(i8 %i, i8 10)
+  %rr10 = load i8, i8* @rem
+  %c4 = icmp ne i8 %r10, %rr10
+  %z4 = zext i1 %c4 to i8
+  %e4 = add i8 %e3, %z4
+  %s4 = call i8 @sdiv4(i8 %i)
+  %rs4 = call i8 @refsdiv(i8 %i, i8 4)
+  %c5 = icmp ne i8 %s4, %rs4
+  %z5 = zext i1 %c5 to i8
+  %e5 = add i8 %e4, %z5
+  br label %next
+
+next:
+  %i.next = add i8 %i, 1
+  %done = icmp eq i8 %i.next, 0
+  br i1 %done, label %exit, label %loop
+
+exit:
+  call void @put8(i8 %e5)
+  call void @newline()
+  %w = call i16 @mul40_16(i16 1234)
+  call void @put16(i16 %w)
+  call void @newline()
+  ret i8 0
+}
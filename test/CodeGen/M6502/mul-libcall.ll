@@ -0,0 +1,19 @@
+; RUN: llc -mtriple=m6502 -O2 < %s | FileCheck %s
+
+; A multiply of two variables calls the runtime library.
+
+target triple = "m6502"
+
+; CHECK-LABEL: mul8:
+; CHECK: jsr __mulqi3
+define i8 @mul8(i8 %a, i8 %b) {
+  %r = mul i8 %a, %b
+  ret i8 %r
+}
+
+; CHECK-LABEL: mul16:
+; CHECK: jsr __mulhi3
+define i16 @mul16(i16 %a, i16 %b) {
+  %r = mul i16 %a, %b
+  ret i16 %r
+}
@@ -0,0 +1,106 @@
+; RUN: llc -mtriple=m6502 -O2 -verify-machineinstrs < %s | FileCheck %s
+; RUN: sed -e 's/external global \[8 x i8\]/global [8 x i8] zeroinitializer/' %s \
+; RUN:   | llc -mtriple=m6502 -O2 -filetype=obj -m6502-image=raw \
+; RUN:       -m6502-image-symbols=%t.sym -o %t.bin
+; RUN: FileCheck %s --check-prefix=SYM < %t.sym
+
+; A hot innermost loop is moved to a boundary which keeps it within a page,
+; and so is a table read through an index, but only where it would cross a
+; page otherwise.  Neither is padded when optimizing for size.
+
+target triple = "m6502"
+
+@first = constant [10 x i8] c"0123456789"
+@fits = constant [5 x i8] c"abcde"
+@crosses = constant [8 x i8] c"ABCDEFGH"
+@fixed = constant [4 x i8] c"wxyz"
+@small = constant [8 x i8] c"zyxwvuts"
+@external = external global [8 x i8]
+
+define i8 @read(i8 %i) {
+  %x = zext i8 %i to i16
+  %p1 = getelementptr [10 x i8], [10 x i8]* @first, i16 0, i16 %x
+  %v1 = load i8, i8* %p1
+  %p2 = getelementptr [5 x i8], [5 x i8]* @fits, i16 0, i16 %x
+  %v2 = load i8, i8* %p2
+  %p3 = getelementptr [8 x i8], [8 x i8]* @crosses, i16 0, i16 %x
+  %v3 = load i8, i8* %p3
+  %p4 = getelementptr [4 x i8], [4 x i8]* @fixed, i16 0, i16 2
+  %v4 = load i8, i8* %p4
+  %s1 = add i8 %v1, %v2
+  %s2 = add i8 %s1, %v3
+  %s3 = add i8 %s2, %v4
+  %p5 = getelementptr [8 x i8], [8 x i8]* @external, i16 0, i16 %x
+  %v5 = load i8, i8* %p5
+  %s4 = add i8 %s3, %v5
+  ret i8 %s4
+}
+
+define i8 @readsmall(i8 %i) optsize {
+  %x = zext i8 %i to i16
+  %p = getelementptr [8 x i8], [8 x i8]* @small, i16 0, i16 %x
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; CHECK-LABEL: .globl clear
+; CHECK-NEXT: .p2align 4
+; CHECK: clear:
+; CHECK: .p2align 4
+; CHECK-NEXT: .LBB2_1:
+; CHECK: bne .LBB2_1
+define void @clear(i8* %p) {
+entry:
+  br label %loop
+loop:
+  %i = phi i8 [ 0, %entry ], [ %i.next, %loop ]
+  %x = zext i8 %i to i16
+  %q = getelementptr i8, i8* %p, i16 %x
+  store volatile i8 0, i8* %q
+  %i.next = add i8 %i, 1
+  %done = icmp eq i8 %i.next, 200
+  br i1 %done, label %exit, label %loop
+exit:
+  ret void
+}
+
+; CHECK-LABEL: .globl clearsmall
+; CHECK-NOT: .p2align
+; CHECK: bne .LBB3_1
+define void @clearsmall(i8* %p) optsize {
+entry:
+  br label %loop
+loop:
+  %i = phi i8 [ 0, %entry ], [ %i.next, %loop ]
+  %x = zext i8 %i to i16
+  %q = getelementptr i8, i8* %p, i16 %x
+  store volatile i8 0, i8* %q
+  %i.next = add i8 %i, 1
+  %done = icmp eq i8 %i.next, 200
+  br i1 %done, label %exit, label %loop
+exit:
+  ret void
+}
+
+; first starts the section, whose alignment is not known yet.  fits then
+; stays within the 16 bytes from first, while crosses would not.  fixed is
+; only read at a constant index, and small only by a function optimized for
+; size.
+
+; CHECK-LABEL: .section .rodata
+; CHECK-NEXT: .p2align 4
+; CHECK: first:
+; CHECK-NOT: .p2align
+; CHECK: fits:
+; CHECK: .p2align 3
+; CHECK-NEXT: .type crosses
+; CHECK-NOT: .p2align
+; CHECK: fixed:
+; CHECK-NOT: .p2align
+; CHECK: small:
+
+; SYM: $0280 first
+; SYM-NEXT: $028A fits
+; SYM-NEXT: $0290 crosses
+; SYM-NEXT: $0298 fixed
+; SYM-NEXT: $029C small
@@ -0,0 +1,133 @@
+; RUN: llc -mtriple=m6502 -mcpu=6502 -O2 -m6502-zp-budget=0 \
+; RUN:   -verify-machineinstrs < %s | FileCheck %s
+
+; Each pseudo instruction expansion stores its result to a zero page
+; register and loads its operands again, which the peephole pass deletes
+; when the CPU registers and flags already hold what they would load.
+
+target triple = "m6502"
+
+@g = global i8 0
+@h = global i8 0
+@t = global [8 x i8] zeroinitializer
+
+; The AND already set Z for the BEQ, and STA leaves the flags alone, so the
+; reload of the result is deleted with the store to RS4.
+
+; CHECK-LABEL: andzero:
+; CHECK: and #3
+; CHECK-NEXT: sta g
+; CHECK-NEXT: beq .LBB0_2
+define void @andzero(i8 %x) {
+entry:
+  %a = and i8 %x, 3
+  store volatile i8 %a, i8* @g
+  %c = icmp eq i8 %a, 0
+  br i1 %c, label %zero, label %done
+zero:
+  store volatile i8 1, i8* @h
+  br label %done
+done:
+  ret void
+}
+
+; The result is loaded into A for the store anyway, and the BMI uses the N
+; that load sets instead of loading it again.
+
+; CHECK-LABEL: neg:
+; CHECK: sta rs4
+; CHECK-NEXT: dec rs4
+; CHECK-NEXT: lda rs4
+; CHECK-NEXT: sta g
+; CHECK-NEXT: bmi .LBB1_2
+define void @neg(i8 %x) {
+entry:
+  %a = sub i8 %x, 1
+  store volatile i8 %a, i8* @g
+  %c = icmp slt i8 %a, 0
+  br i1 %c, label %zero, label %done
+zero:
+  store volatile i8 1, i8* @h
+  br label %done
+done:
+  ret void
+}
+
+; The BCS not taken leaves the carry clear for the ADC, and A still holds x.
+
+; CHECK-LABEL: carry:
+; CHECK: stx rs4
+; CHECK-NEXT: cmp rs4
+; CHECK-NEXT: bcs .LBB2_2
+; CHECK-NEXT: ; BB#1:
+; CHECK-NEXT: adc rs4
+; CHECK-NEXT: sta g
+; CHECK-NEXT: .LBB2_2:
+; CHECK-NEXT: rts
+define void @carry(i8 %x, i8 %y) {
+entry:
+  %c = icmp ult i8 %x, %y
+  br i1 %c, label %less, label %done
+less:
+  %s = add i8 %x, %y
+  store volatile i8 %s, i8* @g
+  br label %done
+done:
+  ret void
+}
+
+; A holds the sum for both stores, and the store of the sum to RS4 goes
+; too, as RTS only reads its operands.  In ret the store to RS8 stays, as
+; RTS reads the result there.
+
+; CHECK-LABEL: reload:
+; CHECK: clc
+; CHECK-NEXT: adc #3
+; CHECK-NEXT: sta g
+; CHECK-NEXT: sta h
+; CHECK-NEXT: rts
+define void @reload(i8 %x) {
+  %a = add i8 %x, 3
+  store volatile i8 %a, i8* @g
+  store volatile i8 %a, i8* @h
+  ret void
+}
+
+; CHECK-LABEL: ret:
+; CHECK: clc
+; CHECK-NEXT: adc #3
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: rts
+define i8 @ret(i8 %x) {
+  %a = add i8 %x, 3
+  ret i8 %a
+}
+
+; The load of the index from RS4 becomes a TAX.
+
+; CHECK-LABEL: index:
+; CHECK: tax
+; CHECK-NEXT: sta t,x
+; CHECK-NEXT: rts
+define void @index(i8 %i) {
+  %x = zext i8 %i to i16
+  %p = getelementptr [8 x i8], [8 x i8]* @t, i16 0, i16 %x
+  store volatile i8 %i, i8* %p
+  ret void
+}
+
+; The operand of LDA $10 is an address, not a constant to fold into the ADC.
+
+; CHECK-LABEL: absolute:
+; CHECK: sta rs4
+; CHECK-NEXT: lda $10
+; CHECK-NEXT: sta rs5
+; CHECK-NEXT: clc
+; CHECK-NEXT: lda rs4
+; CHECK-NEXT: adc rs5
+; CHECK-NEXT: sta rs8
+define i8 @absolute(i8 %x) {
+  %v = load volatile i8, i8* inttoptr (i16 16 to i8*)
+  %s = add i8 %x, %v
+  ret i8 %s
+}
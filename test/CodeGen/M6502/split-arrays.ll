@@ -0,0 +1,69 @@
+; RUN: llc -mtriple=m6502 -O2 -verify-machineinstrs < %s | FileCheck %s
+
+; An internal array of words read or written through a variable index is
+; split into an array of the low bytes and one of the high bytes, which abs,X
+; reaches with the index itself.  An array whose address is also used in a
+; constant initializer is left whole.
+
+target triple = "m6502"
+
+@words = internal global [4 x i16] [i16 4660, i16 22136, i16 -25924, i16 -8464]
+@kept = internal global [4 x i16] [i16 1, i16 2, i16 3, i16 4]
+@kept.ptr = global i16* getelementptr ([4 x i16], [4 x i16]* @kept, i16 0, i16 2)
+
+; CHECK-LABEL: get:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: tax
+; CHECK-NEXT: lda words.hi,x
+; CHECK-NEXT: sta rs9
+; CHECK-NEXT: lda words.lo,x
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: rts
+define i16 @get(i8 %i) {
+  %x = zext i8 %i to i16
+  %p = getelementptr inbounds [4 x i16], [4 x i16]* @words, i16 0, i16 %x
+  %v = load i16, i16* %p
+  ret i16 %v
+}
+
+; CHECK-LABEL: set:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: tax
+; CHECK-NEXT: lda rs8
+; CHECK-NEXT: sta words.lo,x
+; CHECK-NEXT: lda rs9
+; CHECK-NEXT: sta words.hi,x
+; CHECK-NEXT: rts
+define void @set(i8 %i, i16 %v) {
+  %x = zext i8 %i to i16
+  %p = getelementptr inbounds [4 x i16], [4 x i16]* @words, i16 0, i16 %x
+  store i16 %v, i16* %p
+  ret void
+}
+
+; The index of kept is doubled and added to its address.
+
+; CHECK-LABEL: getkept:
+; CHECK: asl rs4
+; CHECK-NEXT: rol rs5
+; CHECK: lda #<kept
+; CHECK: lda (rc2),y
+
+; CHECK: words.lo:
+; CHECK-NEXT: .ascii "4x\274\360"
+; CHECK: words.hi:
+; CHECK-NEXT: .ascii "\022V\232\336"
+; CHECK-NOT: words:
+; CHECK: kept:
+; CHECK-NEXT: .2byte 1
+; CHECK-NEXT: .2byte 2
+; CHECK-NEXT: .2byte 3
+; CHECK-NEXT: .2byte 4
+; CHECK: kept.ptr:
+; CHECK-NEXT: .2byte kept+4
+define i16 @getkept(i8 %i) {
+  %x = zext i8 %i to i16
+  %p = getelementptr inbounds [4 x i16], [4 x i16]* @kept, i16 0, i16 %x
+  %v = load i16, i16* %p
+  ret i16 %v
+}
@@ -0,0 +1,85 @@
+; RUN: llc -mtriple=m6502 -O2 -m6502-stack-budget=12 \
+; RUN:   -m6502-stack-report=%t.yaml %s -o /dev/null
+; RUN: FileCheck %s < %t.yaml
+; RUN: not llc -mtriple=m6502 -O2 -m6502-stack-budget=11 %s -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=OVER
+; RUN: sed -e 's/store volatile i8 1, i8\* @v/call void @mid()/' %s \
+; RUN:   | not llc -mtriple=m6502 -O2 -m6502-stack-budget=100 \
+; RUN:       -m6502-stack-report=%t.rec.yaml -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=RECURSIVE
+; RUN: FileCheck %s --check-prefix=RECURSIVE-REPORT < %t.rec.yaml
+
+; The worst-case depth of the hardware stack is that of the deepest entry
+; point plus that of every interrupt handler.  A JSR pushes 2 bytes, and an
+; interrupt 3.  A call to a function which is not in the module leaves the
+; depth incomplete.
+
+; CHECK: ---
+; CHECK-NEXT: functions:
+; CHECK-NEXT:   - name: "leaf"
+; CHECK-NEXT:     pushes: 0
+; CHECK-NEXT:     depth: 0
+; CHECK-NEXT:   - name: "mid"
+; CHECK-NEXT:     pushes: 0
+; CHECK-NEXT:     depth: 2
+; CHECK-NEXT:     incomplete: true
+; CHECK-NEXT:   - name: "main"
+; CHECK-NEXT:     pushes: 0
+; CHECK-NEXT:     depth: 4
+; CHECK-NEXT:     incomplete: true
+; CHECK-NEXT:   - name: "nmi"
+; CHECK-NEXT:     pushes: 1
+; CHECK-NEXT:     depth: 3
+; CHECK-NEXT: entry-points:
+; CHECK-NEXT:   - name: "main"
+; CHECK-NEXT:     depth: 6
+; CHECK-NEXT:     incomplete: true
+; CHECK-NEXT: interrupts:
+; CHECK-NEXT:   - name: "nmi"
+; CHECK-NEXT:     depth: 6
+; CHECK-NEXT: unknown-callees: [ "ext" ]
+; CHECK-NEXT: worst-case:
+; CHECK-NEXT:   depth: 12
+; CHECK-NEXT:   incomplete: true
+; CHECK-NEXT: budget: 12
+; CHECK-NEXT: ...
+
+; OVER: the hardware stack may grow to 12 bytes, over the budget of 11
+
+; Once leaf calls mid, the depth has no bound whatever the budget.  The
+; report is still written.
+
+; RECURSIVE: the depth of the hardware stack has no bound, as a function may call itself
+
+; RECURSIVE-REPORT: worst-case:
+; RECURSIVE-REPORT-NEXT: depth: 32
+; RECURSIVE-REPORT-NEXT: unbounded: true
+; RECURSIVE-REPORT-NEXT: incomplete: true
+; RECURSIVE-REPORT-NEXT: budget: 100
+
+target triple = "m6502"
+
+@v = global i8 0
+
+declare void @ext()
+
+define void @leaf() noinline {
+  store volatile i8 1, i8* @v
+  ret void
+}
+
+define void @mid() noinline {
+  call void @leaf()
+  call void @ext()
+  ret void
+}
+
+define void @main() {
+  call void @mid()
+  ret void
+}
+
+define void @nmi() "interrupt" {
+  call void @leaf()
+  ret void
+}
@@ -0,0 +1,111 @@
+; RUN: llc -mtriple=m6502 -O2 -m6502-static-frames -verify-machineinstrs \
+; RUN:   < %s | FileCheck %s
+
+; A function which can never be active twice gets its frame at a fixed
+; address.  The frames of first and second share memory, as neither calls
+; the other, while that of outer lies above that of first, which it calls.
+; rec calls itself and callback may be called back from outside the module,
+; so both keep their frames on the software stack.
+
+target triple = "m6502"
+
+declare void @use(i8*)
+
+; CHECK-LABEL: first:
+; CHECK-NEXT: ; BB#0:
+; CHECK-NEXT: lda #<.Lfirst.frame
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: lda #>.Lfirst.frame
+; CHECK-NEXT: sta rs9
+; CHECK-NEXT: jsr use
+; CHECK-NEXT: rts
+define void @first() noinline {
+  %buf = alloca [4 x i8]
+  %p = getelementptr [4 x i8], [4 x i8]* %buf, i16 0, i16 0
+  call void @use(i8* %p)
+  ret void
+}
+
+; CHECK-LABEL: second:
+; CHECK-NOT: rs0
+; CHECK: lda #<.Lsecond.frame
+; CHECK-NOT: rs0
+; CHECK: rts
+define void @second() noinline {
+  %buf = alloca [6 x i8]
+  %p = getelementptr [6 x i8], [6 x i8]* %buf, i16 0, i16 0
+  call void @use(i8* %p)
+  ret void
+}
+
+; CHECK-LABEL: outer:
+; CHECK-NOT: rs0
+; CHECK: lda #<.Louter.frame
+; CHECK-NOT: rs0
+; CHECK: rts
+define void @outer() noinline {
+  %buf = alloca [3 x i8]
+  %p = getelementptr [3 x i8], [3 x i8]* %buf, i16 0, i16 0
+  call void @use(i8* %p)
+  call void @first()
+  ret void
+}
+
+; CHECK-LABEL: rec:
+; CHECK: lda rs0
+; CHECK-NEXT: adc #253
+; CHECK-NEXT: sta rs0
+; CHECK: jsr rec
+; CHECK: lda rs0
+; CHECK-NEXT: adc #3
+; CHECK-NEXT: sta rs0
+define void @rec(i8 %n) noinline {
+  %buf = alloca [2 x i8]
+  %p = getelementptr [2 x i8], [2 x i8]* %buf, i16 0, i16 0
+  call void @use(i8* %p)
+  %z = icmp eq i8 %n, 0
+  br i1 %z, label %done, label %again
+again:
+  %m = sub i8 %n, 1
+  call void @rec(i8 %m)
+  br label %done
+done:
+  ret void
+}
+
+; CHECK-LABEL: callback:
+; CHECK: lda rs0
+; CHECK-NEXT: adc #254
+; CHECK-NEXT: sta rs0
+; CHECK: jsr use
+; CHECK: lda rs0
+; CHECK-NEXT: adc #2
+; CHECK-NEXT: sta rs0
+define void @callback() noinline {
+  %buf = alloca [2 x i8]
+  %p = getelementptr [2 x i8], [2 x i8]* %buf, i16 0, i16 0
+  call void @use(i8* %p)
+  ret void
+}
+
+declare void @register(void ()*)
+
+; The area holding the frames takes 7 bytes, the most of second alone and
+; of outer with first.
+
+; CHECK-LABEL: main:
+; CHECK: .section .zp.bss
+; CHECK-NEXT: .Lfirst.frame:
+; CHECK-NEXT: .Lsecond.frame:
+; CHECK-NEXT: .space 4
+; CHECK-NEXT: .Louter.frame:
+; CHECK-NEXT: .space 3
+; CHECK-NOT: .Lrec.frame
+; CHECK-NOT: .Lcallback.frame
+define void @main() {
+  call void @outer()
+  call void @second()
+  call void @rec(i8 3)
+  call void @register(void ()* @callback)
+  ret void
+}
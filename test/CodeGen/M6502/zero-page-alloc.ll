@@ -0,0 +1,18 @@
+; RUN: llc -mtriple=m6502 -O2 < %s | FileCheck %s
+
+; Only variables starting out as zero move to the zero page, which is not
+; part of a load image.
+
+; CHECK: .section .zp.data
+; CHECK-NEXT: .globl zero
+; CHECK: .data
+; CHECK-NEXT: .globl init
+
+@zero = global i8 0
+@init = global i8 5
+
+define void @f() {
+  %a = load volatile i8, i8* @zero
+  store volatile i8 %a, i8* @init
+  ret void
+}
@@ -0,0 +1,53 @@
+; RUN: llc -mtriple=m6502 -O2 < %s | FileCheck %s
+
+; The locals of a function which an interrupt handler calls as well stay on
+; the soft stack, since an interrupt arriving in the middle of the function
+; would overwrite them in the zero page.
+
+; CHECK-LABEL: shared:
+; CHECK: sta (rc0),y
+; CHECK-NEXT: lda (rc0),y
+
+; CHECK-LABEL: mainonly:
+; CHECK: sta mainonly.buf+1
+; CHECK-NEXT: lda mainonly.buf+1
+
+; CHECK: .section .zp.data
+; CHECK-NOT: shared.buf
+; CHECK: mainonly.buf:
+; CHECK-NOT: shared.buf
+
+target triple = "m6502"
+
+@out = global i8 0
+
+define void @shared(i8 %v) noinline norecurse {
+  %buf = alloca [4 x i8]
+  %p = getelementptr inbounds [4 x i8], [4 x i8]* %buf, i16 0, i16 1
+  store volatile i8 %v, i8* %p
+  %r = load volatile i8, i8* %p
+  store volatile i8 %r, i8* @out
+  ret void
+}
+
+define void @mainonly(i8 %v) noinline norecurse {
+  %buf = alloca [4 x i8]
+  %p = getelementptr inbounds [4 x i8], [4 x i8]* %buf, i16 0, i16 1
+  store volatile i8 %v, i8* %p
+  %r = load volatile i8, i8* %p
+  store volatile i8 %r, i8* @out
+  ret void
+}
+
+define void @handler() #0 {
+  call void @shared(i8 1)
+  ret void
+}
+
+define i8 @main() norecurse {
+  call void @shared(i8 2)
+  call void @mainonly(i8 3)
+  ret i8 0
+}
+
+attributes #0 = { "interrupt" }
@@ -0,0 +1,85 @@
+; RUN: llc -mtriple=m6502 -O2 -enable-ipra -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,COLOR
+; RUN: llc -mtriple=m6502 -O2 -enable-ipra -m6502-zp-coloring=false \
+; RUN:   -verify-machineinstrs < %s | FileCheck %s --check-prefixes=CHECK,PLAIN
+
+; With interprocedural register allocation each function takes first the
+; zero page registers its callees change, and keeps the values live across
+; its calls just above them.
+
+target triple = "m6502"
+
+@a = global i8 0
+@b = global i8 0
+@c = global i8 0
+
+; leaf only changes its argument and result register RS8.
+
+; CHECK-LABEL: leaf:
+; CHECK: clc
+; CHECK-NEXT: lda rs8
+; CHECK-NEXT: adc rs9
+; CHECK-NEXT: eor rs9
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: rts
+define internal fastcc i8 @leaf(i8 %x, i8 %y) noinline {
+  %s = add i8 %x, %y
+  %t = xor i8 %s, %y
+  ret i8 %t
+}
+
+; v lives across the call, in RS4 in both cases.  m does not, and reuses
+; RS8, which leaf changes anyway, instead of taking RS5.
+
+; CHECK-LABEL: caller:
+; CHECK: lda a
+; CHECK-NEXT: sta rs4
+; CHECK-NEXT: lda b
+; COLOR-NEXT: sta rs8
+; PLAIN-NEXT: sta rs5
+; CHECK-NEXT: lda c
+; CHECK-NEXT: sta rs9
+; COLOR-NEXT: lda rs8
+; PLAIN-NEXT: lda rs5
+; CHECK-NEXT: eor rs9
+; CHECK-NEXT: clc
+; COLOR-NEXT: adc rs8
+; PLAIN-NEXT: adc rs5
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: jsr leaf
+; CHECK-NEXT: clc
+; CHECK-NEXT: lda rs8
+; CHECK-NEXT: adc rs4
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: rts
+define i8 @caller() {
+  %v = load volatile i8, i8* @a
+  %m = load volatile i8, i8* @b
+  %k = load volatile i8, i8* @c
+  %n = xor i8 %m, %k
+  %o = add i8 %n, %m
+  %r1 = call fastcc i8 @leaf(i8 %o, i8 %k)
+  %s = add i8 %r1, %v
+  ret i8 %s
+}
+
+; caller changes RS4, RS8 and RS9, so the value top keeps across the call
+; goes to RS5, the first register above them.  Without the coloring caller
+; also changes RS5, and the value moves up to RS6.
+
+; CHECK-LABEL: top:
+; CHECK: lda a
+; COLOR-NEXT: sta rs5
+; PLAIN-NEXT: sta rs6
+; CHECK-NEXT: jsr caller
+; CHECK-NEXT: lda rs8
+; COLOR-NEXT: eor rs5
+; PLAIN-NEXT: eor rs6
+; CHECK-NEXT: sta rs8
+; CHECK-NEXT: rts
+define i8 @top() {
+  %v = load volatile i8, i8* @a
+  %r = call i8 @caller()
+  %s = xor i8 %r, %v
+  ret i8 %s
+}
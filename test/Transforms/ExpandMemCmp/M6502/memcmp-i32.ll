@@ -0,0 +1,16 @@
+; NOTE: Assertions have been autogenerated by utils/update_test_checks.py
+; RUN: opt -S -expandmemcmp -mtriple=m6502 -data-layout=e-m:e-p:16:8-i16:8-i32:8-i64:8-f32:8-f64:8-a:8-n8-S8 < %s | FileCheck %s
+
+; memcmp returns a 16-bit int on the 6502, so a declaration returning i32 is
+; not the library function and is left alone.
+
+declare i32 @memcmp(i8* nocapture, i8* nocapture, i16)
+
+define i32 @cmp2(i8* nocapture readonly %x, i8* nocapture readonly %y)  {
+; CHECK-LABEL: @cmp2(
+; CHECK-NEXT:    [[CALL:%.*]] = tail call i32 @memcmp(i8* [[X:%.*]], i8* [[Y:%.*]], i16 2)
+; CHECK-NEXT:    ret i32 [[CALL]]
+;
+  %call = tail call i32 @memcmp(i8* %x, i8* %y, i16 2)
+  ret i32 %call
+}
@@ -0,0 +1,94 @@
+; NOTE: Assertions have been autogenerated by utils/update_test_checks.py
+; RUN: opt -S -expandmemcmp -mtriple=m6502 -data-layout=e-m:e-p:16:8-i16:8-i32:8-i64:8-f32:8-f64:8-a:8-n8-S8 < %s | FileCheck %s
+
+; The 6502 loads a byte at a time and its C int has 16 bits.
+
+declare i16 @memcmp(i8* nocapture, i8* nocapture, i16)
+
+define i16 @cmp1(i8* nocapture readonly %x, i8* nocapture readonly %y)  {
+; CHECK-LABEL: @cmp1(
+; CHECK-NEXT:    [[TMP1:%.*]] = load i8, i8* [[X:%.*]]
+; CHECK-NEXT:    [[TMP2:%.*]] = load i8, i8* [[Y:%.*]]
+; CHECK-NEXT:    [[TMP3:%.*]] = zext i8 [[TMP1]] to i16
+; CHECK-NEXT:    [[TMP4:%.*]] = zext i8 [[TMP2]] to i16
+; CHECK-NEXT:    [[TMP5:%.*]] = sub i16 [[TMP3]], [[TMP4]]
+; CHECK-NEXT:    ret i16 [[TMP5]]
+;
+  %call = tail call i16 @memcmp(i8* %x, i8* %y, i16 1)
+  ret i16 %call
+}
+
+define i16 @cmp3(i8* nocapture readonly %x, i8* nocapture readonly %y)  {
+; CHECK-LABEL: @cmp3(
+; CHECK-NEXT:    br label [[LOADBB:%.*]]
+; CHECK:       loadbb:
+; CHECK-NEXT:    [[TMP1:%.*]] = load i8, i8* [[X:%.*]]
+; CHECK-NEXT:    [[TMP2:%.*]] = load i8, i8* [[Y:%.*]]
+; CHECK-NEXT:    [[TMP3:%.*]] = zext i8 [[TMP1]] to i16
+; CHECK-NEXT:    [[TMP4:%.*]] = zext i8 [[TMP2]] to i16
+; CHECK-NEXT:    [[TMP5:%.*]] = sub i16 [[TMP3]], [[TMP4]]
+; CHECK-NEXT:    [[TMP6:%.*]] = icmp ne i16 [[TMP5]], 0
+; CHECK-NEXT:    br i1 [[TMP6]], label [[ENDBLOCK:%.*]], label [[LOADBB1:%.*]]
+; CHECK:       loadbb1:
+; CHECK-NEXT:    [[TMP7:%.*]] = getelementptr i8, i8* [[X]], i8 1
+; CHECK-NEXT:    [[TMP8:%.*]] = getelementptr i8, i8* [[Y]], i8 1
+; CHECK-NEXT:    [[TMP9:%.*]] = load i8, i8* [[TMP7]]
+; CHECK-NEXT:    [[TMP10:%.*]] = load i8, i8* [[TMP8]]
+; CHECK-NEXT:    [[TMP11:%.*]] = zext i8 [[TMP9]] to i16
+; CHECK-NEXT:    [[TMP12:%.*]] = zext i8 [[TMP10]] to i16
+; CHECK-NEXT:    [[TMP13:%.*]] = sub i16 [[TMP11]], [[TMP12]]
+; CHECK-NEXT:    [[TMP14:%.*]] = icmp ne i16 [[TMP13]], 0
+; CHECK-NEXT:    br i1 [[TMP14]], label [[ENDBLOCK]], label [[LOADBB2:%.*]]
+; CHECK:       loadbb2:
+; CHECK-NEXT:    [[TMP15:%.*]] = getelementptr i8, i8* [[X]], i8 2
+; CHECK-NEXT:    [[TMP16:%.*]] = getelementptr i8, i8* [[Y]], i8 2
+; CHECK-NEXT:    [[TMP17:%.*]] = load i8, i8* [[TMP15]]
+; CHECK-NEXT:    [[TMP18:%.*]] = load i8, i8* [[TMP16]]
+; CHECK-NEXT:    [[TMP19:%.*]] = zext i8 [[TMP17]] to i16
+; CHECK-NEXT:    [[TMP20:%.*]] = zext i8 [[TMP18]] to i16
+; CHECK-NEXT:    [[TMP21:%.*]] = sub i16 [[TMP19]], [[TMP20]]
+; CHECK-NEXT:    br label [[ENDBLOCK]]
+; CHECK:       endblock:
+; CHECK-NEXT:    [[PHI_RES:%.*]] = phi i16 [ [[TMP5]], [[LOADBB]] ], [ [[TMP13]], [[LOADBB1]] ], [ [[TMP21]], [[LOADBB2]] ]
+; CHECK-NEXT:    ret i16 [[PHI_RES]]
+;
+  %call = tail call i16 @memcmp(i8* %x, i8* %y, i16 3)
+  ret i16 %call
+}
+
+define i1 @cmp_eq2(i8* nocapture readonly %x, i8* nocapture readonly %y)  {
+; CHECK-LABEL: @cmp_eq2(
+; CHECK-NEXT:    br label [[LOADBB:%.*]]
+; CHECK:       res_block:
+; CHECK-NEXT:    br label [[ENDBLOCK:%.*]]
+; CHECK:       loadbb:
+; CHECK-NEXT:    [[TMP1:%.*]] = load i8, i8* [[X:%.*]]
+; CHECK-NEXT:    [[TMP2:%.*]] = load i8, i8* [[Y:%.*]]
+; CHECK-NEXT:    [[TMP3:%.*]] = icmp ne i8 [[TMP1]], [[TMP2]]
+; CHECK-NEXT:    br i1 [[TMP3]], label [[RES_BLOCK:%.*]], label [[LOADBB1:%.*]]
+; CHECK:       loadbb1:
+; CHECK-NEXT:    [[TMP4:%.*]] = getelementptr i8, i8* [[X]], i8 1
+; CHECK-NEXT:    [[TMP5:%.*]] = getelementptr i8, i8* [[Y]], i8 1
+; CHECK-NEXT:    [[TMP6:%.*]] = load i8, i8* [[TMP4]]
+; CHECK-NEXT:    [[TMP7:%.*]] = load i8, i8* [[TMP5]]
+; CHECK-NEXT:    [[TMP8:%.*]] = icmp ne i8 [[TMP6]], [[TMP7]]
+; CHECK-NEXT:    br i1 [[TMP8]], label [[RES_BLOCK]], label [[ENDBLOCK]]
+; CHECK:       endblock:
+; CHECK-NEXT:    [[PHI_RES:%.*]] = phi i16 [ 0, [[LOADBB1]] ], [ 1, [[RES_BLOCK]] ]
+; CHECK-NEXT:    [[CMP:%.*]] = icmp eq i16 [[PHI_RES]], 0
+; CHECK-NEXT:    ret i1 [[CMP]]
+;
+  %call = tail call i16 @memcmp(i8* %x, i8* %y, i16 2)
+  %cmp = icmp eq i16 %call, 0
+  ret i1 %cmp
+}
+
+; More loads than the target allows.
+define i16 @cmp9(i8* nocapture readonly %x, i8* nocapture readonly %y)  {
+; CHECK-LABEL: @cmp9(
+; CHECK-NEXT:    [[CALL:%.*]] = tail call i16 @memcmp(i8* [[X:%.*]], i8* [[Y:%.*]], i16 9)
+; CHECK-NEXT:    ret i16 [[CALL]]
+;
+  %call = tail call i16 @memcmp(i8* %x, i8* %y, i16 9)
+  ret i16 %call
+}
@@ -0,0 +1,16 @@
+; NOTE: Assertions have been autogenerated by utils/update_test_checks.py
+; RUN: opt -S -expandmemcmp -mtriple=x86_64-unknown-unknown -data-layout=e-m:o-i64:64-f80:128-n8:16:32:64-S128 < %s | FileCheck %s
+
+; The C int of x86 has 32 bits, so a declaration returning i16 is not the
+; library function and is left alone.
+
+declare i16 @memcmp(i8* nocapture, i8* nocapture, i64)
+
+define i16 @cmp2(i8* nocapture readonly %x, i8* nocapture readonly %y)  {
+; CHECK-LABEL: @cmp2(
+; CHECK-NEXT:    [[CALL:%.*]] = tail call i16 @memcmp(i8* [[X:%.*]], i8* [[Y:%.*]], i64 2)
+; CHECK-NEXT:    ret i16 [[CALL]]
+;
+  %call = tail call i16 @memcmp(i8* %x, i8* %y, i64 2)
+  ret i16 %call
+}
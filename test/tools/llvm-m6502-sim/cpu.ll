@@ -0,0 +1,28 @@
+; RUN: llc -mtriple=m6502 -filetype=obj -m6502-image=raw \
+; RUN:   -m6502-image-symbols=%t.sym %s -o %t.bin
+; RUN: llvm-m6502-sim -cpu=65c02 -stats -dump='$0300:1' -symbols %t.sym \
+; RUN:   -entry=code %t.bin | FileCheck %s --check-prefix=CMOS
+; RUN: not llvm-m6502-sim -cpu=6502 -stats -dump='$0300:1' -symbols %t.sym \
+; RUN:   -entry=code %t.bin 2>&1 | FileCheck %s --check-prefix=NMOS
+
+; STZ only exists on the 65C02.  The 6502 stops at it with $55 in memory.
+;
+;         lda #$55        2
+;         sta $0300       4
+;         stz $0300       4
+;         lda $0300       4
+;         rts             6
+
+; CMOS: stop: returned
+; CMOS-NEXT: cycles: 20
+; CMOS-NEXT: instructions: 5
+; CMOS-NEXT: A=$00
+; CMOS: 0300: 00
+
+; NMOS: stop: illegal opcode
+; NMOS-NEXT: cycles: 6
+; NMOS-NEXT: instructions: 2
+; NMOS: 0300: 55
+; NMOS: error: illegal opcode at $205
+
+@code = constant [12 x i8] c"\A9\55\8D\00\03\9C\00\03\AD\00\03\60"
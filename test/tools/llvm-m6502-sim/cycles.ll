@@ -0,0 +1,23 @@
+; RUN: llc -mtriple=m6502 -filetype=obj -m6502-image=raw \
+; RUN:   -m6502-image-symbols=%t.sym %s -o %t.bin
+; RUN: llvm-m6502-sim -stats -symbols %t.sym -entry=code -io-putchar='$FFF0' \
+; RUN:   %t.bin | FileCheck %s
+
+; The code is given as bytes so that the instructions and their cycles do not
+; depend on the code generator.  The image is loaded at $0200:
+;
+;         ldx #3          2
+; loop:   lda msg,x       4 x 4
+;         sta $fff0       4 x 4
+;         dex             2 x 4
+;         bpl loop        3 x 3 + 2
+;         rts             6
+; msg:    .byte 10, 'C', 'B', 'A'
+
+; CHECK: ABC
+; CHECK-NEXT: stop: returned
+; CHECK-NEXT: cycles: 59
+; CHECK-NEXT: instructions: 18
+; CHECK-NEXT: A=$0A X=$FF Y=$00
+
+@code = constant [16 x i8] c"\A2\03\BD\0C\02\8D\F0\FF\CA\10\F7\60\0ACBA"
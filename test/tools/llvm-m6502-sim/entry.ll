@@ -0,0 +1,19 @@
+; RUN: llc -mtriple=m6502 -filetype=obj -m6502-image=ines \
+; RUN:   -m6502-image-symbols=%t.sym %s -o %t.nes
+; RUN: llvm-m6502-sim -stats -symbols %t.sym -entry=code \
+; RUN:   -io-putchar='$FFF0' %t.nes | FileCheck %s
+
+; An iNES image starts from the reset vector, unless -entry gives a
+; function to call instead.
+;
+;         lda #'N'
+;         sta $fff0
+;         lda #10
+;         sta $fff0
+;         rts
+
+; CHECK: N
+; CHECK-NEXT: stop: returned
+; CHECK-NEXT: cycles: 18
+
+@code = constant [11 x i8] c"\A9N\8D\F0\FF\A9\0A\8D\F0\FF\60"
@@ -0,0 +1,54 @@
+; RUN: llc -mtriple=m6502 -O0 -filetype=obj -m6502-image=raw \
+; RUN:   -m6502-image-symbols=%t.sym %s -o %t.bin
+; RUN: llvm-m6502-sim -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   -dump='$FEF0:16' | FileCheck %s
+; RUN: llvm-m6502-sim -symbols %t.sym -io-putchar='$FFF0' %t.bin \
+; RUN:   -stack-top='$4000' -dump='$3FF0:16' | FileCheck %s
+; RUN: llc -mtriple=m6502 -O0 -filetype=obj -m6502-image=ines \
+; RUN:   -m6502-image-symbols=%t.nes.sym %s -o %t.nes
+; RUN: llvm-m6502-sim -symbols %t.nes.sym -entry=main -io-putchar='$FFF0' \
+; RUN:   %t.nes -dump='$07F0:16' | FileCheck %s
+
+; The soft stack pointer, rc0, starts at the top of RAM, so the frame of
+; fill is just below it.  Starting from $0000 instead, the frame would wrap
+; around to $FFF0 and print as it is filled.
+
+; CHECK: PONMLKJIHGFEDCBA
+; CHECK-NEXT: {{.*}}: 41 42 43 44 45 46 47 48 49 4A 4B 4C 4D 4E 4F 50
+
+target triple = "m6502"
+
+define void @fill(i8 %n) noinline {
+entry:
+  %buf = alloca [16 x i8]
+  br label %store
+
+store:
+  %i = phi i8 [ 0, %entry ], [ %i.next, %store ]
+  %idx = zext i8 %i to i16
+  %p = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i16 0, i16 %idx
+  %c = add i8 %i, 65
+  store volatile i8 %c, i8* %p
+  %i.next = add i8 %i, 1
+  %more = icmp ult i8 %i.next, %n
+  br i1 %more, label %store, label %print
+
+print:
+  %j = phi i8 [ %n, %store ], [ %j.next, %print ]
+  %j.next = add i8 %j, -1
+  %jdx = zext i8 %j.next to i16
+  %q = getelementptr inbounds [16 x i8], [16 x i8]* %buf, i16 0, i16 %jdx
+  %d = load volatile i8, i8* %q
+  store volatile i8 %d, i8* inttoptr (i16 65520 to i8*)
+  %again = icmp ne i8 %j.next, 0
+  br i1 %again, label %print, label %done
+
+done:
+  store volatile i8 10, i8* inttoptr (i16 65520 to i8*)
+  ret void
+}
+
+define void @main() {
+  call void @fill(i8 16)
+  ret void
+}
@@ -0,0 +1,393 @@
+//===- llvm-m6502-sim.cpp - 6502 instruction set simulator ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This program runs a raw, PRG or iNES image written by llc on a simulated
+// 6502 or 65C02, and reports the cycles taken overall and by every function.
+//
+// A raw or PRG image is started by calling its entry, main when a symbol
+// file is given, and stops when the entry returns.  An iNES image starts
+// from the reset vector.  Either way the soft stack pointer starts at the
+// top of the RAM of the image, as a startup routine would set it.  Bytes can
+// be written to stdout and read from stdin through memory mapped I/O
+// registers, and the program can exit with a status by writing it to another
+// one.
+//
+//===----------------------------------------------------------------------===//
+
+#include "M6502Image.h"
+#include "M6502Simulator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+using namespace llvm;
+
+enum ImageFormat { Auto, Raw, PRG, INES };
+
+static cl::opt<std::string> InputFilename(cl::Positional, cl::Required,
+                                          cl::desc("<image>"));
+
+static cl::opt<ImageFormat> Format(
+    "format", cl::desc("Format of the image"), cl::init(Auto),
+    cl::values(clEnumValN(Auto, "auto",
+                          "From the extension: .prg, .nes or raw (default)"),
+               clEnumValN(Raw, "raw", "Raw bytes loaded at -load-address"),
+               clEnumValN(PRG, "prg", "C64 program"),
+               clEnumValN(INES, "ines", "NROM iNES cartridge")));
+
+static cl::opt<M6502Simulator::CPUKind> CPU(
+    "cpu", cl::desc("Processor to simulate"), cl::init(M6502Simulator::NMOS),
+    cl::values(clEnumValN(M6502Simulator::NMOS, "6502", "NMOS 6502 (default)"),
+               clEnumValN(M6502Simulator::RP2A03, "2a03",
+                          "NES 2A03, default for iNES images"),
+               clEnumValN(M6502Simulator::WDC65C02, "65c02", "WDC 65C02")));
+
+static cl::opt<std::string>
+    LoadAddress("load-address", cl::init("$0200"),
+                cl::desc("Address of a raw image (default=$0200)"));
+
+static cl::opt<std::string>
+    SymbolFile("symbols", cl::value_desc("filename"),
+               cl::desc("Symbol file written by llc -m6502-image-symbols"));
+
+static cl::opt<std::string>
+    Entry("entry", cl::desc("Address or symbol to call, instead of main or "
+                            "the start of the image"));
+
+static cl::opt<bool> Reset("reset",
+                           cl::desc("Start from the reset vector, the "
+                                    "default for iNES images"));
+
+static cl::opt<std::string>
+    StackTop("stack-top",
+             cl::desc("Initial soft stack pointer (default=$0800 for iNES "
+                      "images, $A000 for PRG and $FF00 for raw images)"));
+
+static cl::opt<std::string>
+    StackPointer("stack-pointer", cl::init("$80"),
+                 cl::desc("Zero page address of the soft stack pointer, "
+                          "rc0 (default=$80)"));
+
+static cl::opt<unsigned long long>
+    MaxCycles("max-cycles", cl::init(1000000000),
+              cl::desc("Stop after this many cycles, 0 for no limit"));
+
+static cl::opt<bool>
+    BreakInterrupt("brk-interrupt",
+                   cl::desc("Take the interrupt on BRK instead of stopping"));
+
+static cl::opt<unsigned long long>
+    IRQPeriod("irq-period", cl::init(0),
+              cl::desc("Request an IRQ every N cycles"));
+
+static cl::opt<unsigned long long>
+    NMIPeriod("nmi-period", cl::init(0),
+              cl::desc("Request an NMI every N cycles"));
+
+static cl::opt<std::string>
+    PutcharAddress("io-putchar",
+                   cl::desc("Address where a write outputs a byte to stdout"));
+
+static cl::opt<std::string>
+    GetcharAddress("io-getchar",
+                   cl::desc("Address where a read inputs a byte from stdin, "
+                            "$FF at the end"));
+
+static cl::opt<std::string>
+    ExitAddress("io-exit",
+                cl::desc("Address where a write exits with the byte as "
+                         "status"));
+
+static cl::opt<std::string> CyclesAddress(
+    "io-cycles",
+    cl::desc("Address of the 32-bit cycle counter, latched by reading its "
+             "low byte"));
+
+static cl::list<std::string>
+    Pokes("poke", cl::desc("Store a byte before the run, <address>=<value>"),
+          cl::ZeroOrMore);
+
+static cl::list<std::string>
+    Dumps("dump", cl::desc("Dump memory after the run, <address>:<length>"),
+          cl::ZeroOrMore);
+
+static cl::opt<bool> Stats("stats",
+                           cl::desc("Print the cycles, instructions and "
+                                    "registers after the run"));
+
+static cl::opt<bool> Profile("profile",
+                             cl::desc("Print the calls and cycles of every "
+                                      "function after the run"));
+
+static cl::opt<bool> Trace("trace",
+                           cl::desc("Print every instruction to stderr"));
+
+static StringRef ToolName;
+
+LLVM_ATTRIBUTE_NORETURN static void error(const Twine &Msg) {
+  errs() << ToolName << ": error: " << Msg << "\n";
+  exit(1);
+}
+
+static uint16_t getAddress(StringRef Option, StringRef Str,
+                           const M6502SymbolTable *Symbols) {
+  Optional<uint16_t> Address = parseM6502Address(Str, Symbols);
+  if (!Address)
+    error("invalid address '" + Str + "' for -" + Option);
+  return *Address;
+}
+
+static ImageFormat getFormat() {
+  if (Format != Auto)
+    return Format;
+  StringRef Ext = sys::path::extension(InputFilename);
+  if (Ext.equals_lower(".prg"))
+    return PRG;
+  if (Ext.equals_lower(".nes"))
+    return INES;
+  return Raw;
+}
+
+static Expected<M6502ImageEntry> loadImage(M6502Memory &Mem, StringRef Data,
+                                           ImageFormat ImgFormat,
+                                           const M6502SymbolTable *Symbols) {
+  switch (ImgFormat) {
+  case Auto:
+  case Raw:
+    return loadM6502RawImage(
+        Mem, Data, getAddress("load-address", LoadAddress, Symbols));
+  case PRG:
+    return loadM6502PRGImage(Mem, Data);
+  case INES:
+    return loadM6502INESImage(Mem, Data);
+  }
+  llvm_unreachable("Unknown image format");
+}
+
+/// Return the top of the soft stack, which is the end of the RAM the default
+/// memory map of llc gives the format.
+static uint16_t getStackTop(ImageFormat ImgFormat,
+                            const M6502SymbolTable *Symbols) {
+  if (!StackTop.empty())
+    return getAddress("stack-top", StackTop, Symbols);
+  switch (ImgFormat) {
+  case Auto:
+  case Raw:
+    // Leave the last page to the I/O registers and the vectors.
+    return 0xff00;
+  case PRG:
+    return 0xa000;
+  case INES:
+    return 0x0800;
+  }
+  llvm_unreachable("Unknown image format");
+}
+
+static void mapIOStubs(M6502Simulator &Sim, const M6502SymbolTable *Symbols) {
+  M6502Memory &Mem = Sim.getMemory();
+
+  if (!PutcharAddress.empty()) {
+    uint16_t Addr = getAddress("io-putchar", PutcharAddress, Symbols);
+    Mem.mapIO(Addr, Addr, nullptr,
+              [](uint16_t, uint8_t Value) { outs() << char(Value); });
+  }
+
+  if (!GetcharAddress.empty()) {
+    uint16_t Addr = getAddress("io-getchar", GetcharAddress, Symbols);
+    Mem.mapIO(Addr, Addr,
+              [](uint16_t) -> uint8_t {
+                outs().flush();
+                int C = getchar();
+                return C == EOF ? 0xff : C;
+              },
+              nullptr);
+  }
+
+  if (!ExitAddress.empty()) {
+    uint16_t Addr = getAddress("io-exit", ExitAddress, Symbols);
+    Mem.mapIO(Addr, Addr, nullptr, [&Sim](uint16_t, uint8_t Value) {
+      Sim.requestExit(Value);
+    });
+  }
+
+  if (!CyclesAddress.empty()) {
+    uint16_t Addr = getAddress("io-cycles", CyclesAddress, Symbols);
+    auto Latched = std::make_shared<uint32_t>(0);
+    Mem.mapIO(Addr, Addr + 3,
+              [&Sim, Addr, Latched](uint16_t A) -> uint8_t {
+                if (A == Addr)
+                  *Latched = Sim.getCycles();
+                return *Latched >> (8 * (A - Addr));
+              },
+              [](uint16_t, uint8_t) {});
+  }
+}
+
+static void printStats(const M6502Simulator &Sim) {
+  outs() << "stop: " << M6502Simulator::getStopReasonName(Sim.getStopReason())
+         << "\n"
+         << "cycles: " << Sim.getCycles() << "\n"
+         << "instructions: " << Sim.getInstructions() << "\n"
+         << "A=$" << format_hex_no_prefix(Sim.A, 2, true)
+         << " X=$" << format_hex_no_prefix(Sim.X, 2, true)
+         << " Y=$" << format_hex_no_prefix(Sim.Y, 2, true)
+         << " S=$" << format_hex_no_prefix(Sim.S, 2, true)
+         << " P=$" << format_hex_no_prefix(Sim.P, 2, true)
+         << " PC=$" << format_hex_no_prefix(Sim.PC, 4, true) << "\n";
+}
+
+/// Print the functions by decreasing total cycles.
+static void printProfile(const M6502Simulator &Sim,
+                         const M6502SymbolTable *Symbols) {
+  std::vector<M6502Simulator::FunctionProfile> Functions = Sim.getProfile();
+  std::stable_sort(Functions.begin(), Functions.end(),
+                   [](const M6502Simulator::FunctionProfile &A,
+                      const M6502Simulator::FunctionProfile &B) {
+                     return A.TotalCycles > B.TotalCycles;
+                   });
+
+  outs() << left_justify("function", 24) << right_justify("calls", 11)
+         << right_justify("self", 13) << right_justify("total", 13) << "\n";
+  for (const M6502Simulator::FunctionProfile &F : Functions) {
+    std::string Name;
+    if (Symbols)
+      Name = Symbols->getName(F.Address);
+    if (Name.empty())
+      Name = "$" + utohexstr(F.Address);
+    outs() << format("%-24s %10llu %12llu %12llu\n", Name.c_str(),
+                     (unsigned long long)F.Calls,
+                     (unsigned long long)F.SelfCycles,
+                     (unsigned long long)F.TotalCycles);
+  }
+}
+
+static void dumpMemory(const M6502Memory &Mem, uint16_t Start,
+                       unsigned Length) {
+  for (unsigned Offset = 0; Offset < Length; Offset += 16) {
+    outs() << format_hex_no_prefix(uint16_t(Start + Offset), 4, true) << ":";
+    for (unsigned i = Offset; i < std::min(Offset + 16, Length); ++i)
+      outs() << " " << format_hex_no_prefix(Mem.peek(Start + i), 2, true);
+    outs() << "\n";
+  }
+}
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram X(argc, argv);
+
+  llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
+  ToolName = argv[0];
+  cl::ParseCommandLineOptions(argc, argv, "6502 instruction set simulator\n");
+
+  std::unique_ptr<M6502SymbolTable> Symbols;
+  if (!SymbolFile.empty()) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
+        MemoryBuffer::getFile(SymbolFile);
+    if (!Buf)
+      error("cannot read '" + SymbolFile + "': " + Buf.getError().message());
+    Expected<M6502SymbolTable> Table = M6502SymbolTable::parse(
+        (*Buf)->getBuffer());
+    if (!Table)
+      error(toString(Table.takeError()));
+    Symbols = llvm::make_unique<M6502SymbolTable>(std::move(*Table));
+  }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buf =
+      MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (!Buf)
+    error("cannot read '" + InputFilename + "': " + Buf.getError().message());
+  StringRef Data = (*Buf)->getBuffer();
+
+  M6502Memory Mem;
+  ImageFormat ImgFormat = getFormat();
+  Expected<M6502ImageEntry> Image =
+      loadImage(Mem, Data, ImgFormat, Symbols.get());
+  if (!Image)
+    error(InputFilename + ": " + toString(Image.takeError()));
+
+  M6502Simulator::CPUKind Kind = CPU;
+  if (!CPU.getNumOccurrences() && ImgFormat == INES)
+    Kind = M6502Simulator::RP2A03;
+  M6502Simulator Sim(Kind, Mem);
+  Sim.setStopOnBreak(!BreakInterrupt);
+  if (Trace)
+    Sim.setTrace(&errs());
+  mapIOStubs(Sim, Symbols.get());
+
+  uint16_t SP = getAddress("stack-pointer", StackPointer, Symbols.get());
+  uint16_t Top = getStackTop(ImgFormat, Symbols.get());
+  Mem.poke(SP, Top & 0xff);
+  Mem.poke(SP + 1, Top >> 8);
+
+  for (StringRef Poke : Pokes) {
+    StringRef Addr, Value;
+    std::tie(Addr, Value) = Poke.split('=');
+    Optional<uint16_t> Byte = parseM6502Address(Value, nullptr);
+    if (!Byte || *Byte > 0xff)
+      error("invalid value '" + Value + "' for -poke");
+    Mem.poke(getAddress("poke", Addr, Symbols.get()), *Byte);
+  }
+
+  // An image without an entry, such as a cartridge, starts from the reset
+  // vector unless -entry says otherwise.
+  if (Reset || (!Image->Entry && Entry.empty())) {
+    Sim.reset();
+  } else if (!Entry.empty()) {
+    Sim.call(getAddress("entry", Entry, Symbols.get()));
+  } else {
+    uint16_t Start = *Image->Entry;
+    if (Symbols && Symbols->lookup("main"))
+      Start = *Symbols->lookup("main");
+    Sim.call(Start);
+  }
+
+  Sim.setIRQPeriod(IRQPeriod);
+  Sim.setNMIPeriod(NMIPeriod);
+  M6502Simulator::StopReason Reason = Sim.run(MaxCycles);
+  outs().flush();
+
+  if (Stats)
+    printStats(Sim);
+  if (Profile)
+    printProfile(Sim, Symbols.get());
+  for (StringRef Dump : Dumps) {
+    StringRef Addr, Length;
+    std::tie(Addr, Length) = Dump.split(':');
+    unsigned Len;
+    if (Length.getAsInteger(0, Len))
+      error("invalid length '" + Length + "' for -dump");
+    dumpMemory(Mem, getAddress("dump", Addr, Symbols.get()), Len);
+  }
+  outs().flush();
+
+  switch (Reason) {
+  case M6502Simulator::Returned:
+  case M6502Simulator::Stopped:
+    return 0;
+  case M6502Simulator::Exited:
+    return Sim.getExitCode();
+  default:
+    error(M6502Simulator::getStopReasonName(Reason) + " at $" +
+          utohexstr(Sim.PC));
+  }
+}